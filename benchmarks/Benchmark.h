@@ -0,0 +1,115 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Libraries
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class Benchmark
+/**
+ * This abstract class represents a performance benchmark. To create a benchmark,
+ * you simply need to create a class that inherits from the Benchmark class, override
+ * the run() method and use the measure() and report() methods.
+ */
+class Benchmark {
+
+    private :
+
+        // ---------- Attributes ---------- //
+
+        /// Name of the benchmark
+        std::string mName;
+
+        /// Output stream
+        std::ostream* mOutputStream;
+
+    protected :
+
+        // ---------- Methods ---------- //
+
+        /// Return the time (in milliseconds) needed to execute a function
+        template<typename Function>
+        double measure(Function function) const {
+
+            auto start = std::chrono::high_resolution_clock::now();
+            function();
+            auto end = std::chrono::high_resolution_clock::now();
+
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        /// Display the result of a measure
+        void report(const std::string& label, double timeMilliseconds) const {
+            *mOutputStream << "  " << std::left << std::setw(60) << label << std::right
+                           << std::fixed << std::setprecision(3) << std::setw(12)
+                           << timeMilliseconds << " ms" << std::endl;
+        }
+
+        /// Display a memory size
+        void reportMemory(const std::string& label, size_t sizeInBytes) const {
+            *mOutputStream << "  " << std::left << std::setw(60) << label << std::right
+                           << std::fixed << std::setprecision(3) << std::setw(12)
+                           << double(sizeInBytes) / 1024.0 << " KB" << std::endl;
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        Benchmark(const std::string& name, std::ostream* outputStream = &std::cout)
+            : mName(name), mOutputStream(outputStream) {
+
+        }
+
+        /// Destructor
+        virtual ~Benchmark() = default;
+
+        /// Deleted copy-constructor
+        Benchmark(const Benchmark& benchmark) = delete;
+
+        /// Deleted assignment operator
+        Benchmark& operator=(const Benchmark& benchmark) = delete;
+
+        /// Return the name of the benchmark
+        const std::string& getName() const {
+            return mName;
+        }
+
+        /// Run the benchmark
+        virtual void run()=0;
+};
+
+}
+
+#endif
@@ -0,0 +1,306 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_BROAD_PHASE_H
+#define BENCHMARK_BROAD_PHASE_H
+
+// Libraries
+#include "Benchmark.h"
+#include "reactphysics3d.h"
+#include <vector>
+#include <sstream>
+#include <cmath>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class ContactCounter
+/**
+ * Collision callback that counts the reported contacts
+ */
+class ContactCounter : public CollisionCallback {
+
+    public :
+
+        /// Number of reported contacts
+        uint nbContacts = 0;
+
+        /// Called for each reported contact
+        virtual void notifyContact(const CollisionCallbackInfo& collisionCallbackInfo) override {
+            nbContacts++;
+        }
+};
+
+// Class BenchmarkBroadPhase
+/**
+ * Benchmark of the broad-phase collision detection of a collision world with many
+ * bodies that move at each frame and of the simulation of larger versions of the
+ * cubes and height field scenes of the testbed application with each broad-phase
+ * algorithm
+ */
+class BenchmarkBroadPhase : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of bodies in the world
+        static const int NB_BODIES = 30000;
+
+        /// Number of simulated frames
+        static const int NB_FRAMES = 20;
+
+        /// Number of cubes along each horizontal axis and number of layers of cubes of the cubes scene
+        static const int NB_CUBES_PER_ROW = 20;
+        static const int NB_CUBES_LAYERS = 5;
+
+        /// Number of bodies of each shape type of the height field scene
+        static const int NB_BODIES_PER_SHAPE = 700;
+
+        /// Number of points along each axis of the height field
+        static const int NB_HEIGHT_FIELD_POINTS = 100;
+
+        /// Number of simulation steps of the scenes
+        static const int NB_STEPS = 120;
+
+        /// Number of boxes along each horizontal axis of the sleeping scene
+        static const int NB_SLEEPING_BOXES_PER_ROW = 60;
+
+        // ---------- Methods ---------- //
+
+        /// Return the position of a body at a given frame
+        static Vector3 getBodyPosition(int index, int frame) {
+            const int gridSize = 31;
+            const decimal offset = decimal(0.5) * std::sin(decimal(index + frame));
+            return Vector3(decimal(index % gridSize) * decimal(2.5) + offset,
+                           decimal((index / gridSize) % gridSize) * decimal(2.5) - offset,
+                           decimal(index / (gridSize * gridSize)) * decimal(2.5) + offset);
+        }
+
+        /// Return the time needed to compute the broad-phase of the moving bodies
+        double measureMovingBodies(const WorldSettings& settings) const {
+
+            CollisionWorld world(settings);
+            SphereShape sphereShape(decimal(1.0));
+
+            std::vector<CollisionBody*> bodies;
+            for (int i=0; i < NB_BODIES; i++) {
+                CollisionBody* body = world.createCollisionBody(Transform(getBodyPosition(i, 0), Quaternion::identity()));
+                body->addCollisionShape(&sphereShape, Transform::identity());
+                bodies.push_back(body);
+            }
+
+            ContactCounter counter;
+            world.testCollision(&counter);
+
+            return measure([&]() {
+                for (int f=1; f <= NB_FRAMES; f++) {
+                    for (int i=0; i < NB_BODIES; i++) {
+                        bodies[i]->setTransform(Transform(getBodyPosition(i, f), Quaternion::identity()));
+                    }
+                    world.testCollision(&counter);
+                }
+            });
+        }
+
+        /// Return the time needed to simulate the cubes falling on a floor
+        double measureCubesScene(const WorldSettings& settings) const {
+
+            DynamicsWorld world(Vector3(0, decimal(-9.81), 0), settings);
+            BoxShape boxShape(Vector3(1, 1, 1));
+            BoxShape floorShape(Vector3(50, decimal(0.5), 50));
+
+            RigidBody* floor = world.createRigidBody(Transform::identity());
+            floor->setType(BodyType::STATIC);
+            floor->addCollisionShape(&floorShape, Transform::identity(), decimal(100.0));
+
+            for (int y=0; y < NB_CUBES_LAYERS; y++) {
+                for (int x=0; x < NB_CUBES_PER_ROW; x++) {
+                    for (int z=0; z < NB_CUBES_PER_ROW; z++) {
+                        const Vector3 position(decimal(x - NB_CUBES_PER_ROW / 2) * decimal(2.3),
+                                               decimal(10) + decimal(y) * decimal(2.3),
+                                               decimal(z - NB_CUBES_PER_ROW / 2) * decimal(2.3) + decimal(0.1) * decimal(y));
+                        RigidBody* cube = world.createRigidBody(Transform(position, Quaternion::identity()));
+                        cube->addCollisionShape(&boxShape, Transform::identity(), decimal(1.0));
+                        cube->getMaterial().setBounciness(decimal(0.4));
+                    }
+                }
+            }
+
+            return measure([&]() {
+                for (int i=0; i < NB_STEPS; i++) {
+                    world.update(decimal(1.0) / decimal(60.0));
+                }
+            });
+        }
+
+        /// Return the time needed to simulate a few spheres rolling on a floor covered with sleeping boxes
+        double measureSleepingScene(const WorldSettings& settings) const {
+
+            DynamicsWorld world(Vector3(0, decimal(-9.81), 0), settings);
+            BoxShape boxShape(Vector3(1, 1, 1));
+            SphereShape sphereShape(decimal(1.0));
+            BoxShape floorShape(Vector3(100, decimal(0.5), 100));
+
+            RigidBody* floor = world.createRigidBody(Transform(Vector3(0, decimal(-0.5), 0), Quaternion::identity()));
+            floor->setType(BodyType::STATIC);
+            floor->addCollisionShape(&floorShape, Transform::identity(), decimal(100.0));
+
+            // Grid of boxes touching each other (every box overlaps with its neighbors in the broad-phase)
+            for (int x=0; x < NB_SLEEPING_BOXES_PER_ROW; x++) {
+                for (int z=0; z < NB_SLEEPING_BOXES_PER_ROW; z++) {
+                    const Vector3 position(decimal(x - NB_SLEEPING_BOXES_PER_ROW / 2) * decimal(2.05), decimal(1.0),
+                                           decimal(z - NB_SLEEPING_BOXES_PER_ROW / 2) * decimal(2.05));
+                    RigidBody* box = world.createRigidBody(Transform(position, Quaternion::identity()));
+                    box->addCollisionShape(&boxShape, Transform::identity(), decimal(1.0));
+                }
+            }
+
+            // Let the boxes fall asleep
+            for (int i=0; i < 2 * NB_STEPS; i++) {
+                world.update(decimal(1.0) / decimal(60.0));
+            }
+
+            // A few spheres rolling on top of the boxes
+            for (int i=0; i < 10; i++) {
+                RigidBody* sphere = world.createRigidBody(Transform(Vector3(decimal(i * 10 - 50), 4, 0), Quaternion::identity()));
+                sphere->addCollisionShape(&sphereShape, Transform::identity(), decimal(1.0));
+                sphere->setLinearVelocity(Vector3(0, 0, 5));
+            }
+
+            return measure([&]() {
+                for (int i=0; i < NB_STEPS; i++) {
+                    world.update(decimal(1.0) / decimal(60.0));
+                }
+            });
+        }
+
+        /// Return the time needed to simulate boxes, spheres and capsules falling on a height field
+        double measureHeightFieldScene(const WorldSettings& settings) const {
+
+            DynamicsWorld world(Vector3(0, decimal(-9.81), 0), settings);
+
+            // Create the height field
+            std::vector<float> heights(NB_HEIGHT_FIELD_POINTS * NB_HEIGHT_FIELD_POINTS);
+            for (int i=0; i < NB_HEIGHT_FIELD_POINTS; i++) {
+                for (int j=0; j < NB_HEIGHT_FIELD_POINTS; j++) {
+                    heights[j * NB_HEIGHT_FIELD_POINTS + i] = float(2.0 * std::sin(0.3 * i) * std::cos(0.2 * j));
+                }
+            }
+            HeightFieldShape heightFieldShape(NB_HEIGHT_FIELD_POINTS, NB_HEIGHT_FIELD_POINTS, decimal(-2.0), decimal(2.0),
+                                              &(heights[0]), HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE);
+
+            RigidBody* heightField = world.createRigidBody(Transform::identity());
+            heightField->setType(BodyType::STATIC);
+            heightField->addCollisionShape(&heightFieldShape, Transform::identity(), decimal(100.0));
+
+            // Create the falling bodies
+            BoxShape boxShape(Vector3(1, 1, 1));
+            SphereShape sphereShape(decimal(1.5));
+            CapsuleShape capsuleShape(decimal(1.0), decimal(1.0));
+            CollisionShape* shapes[3] = {&boxShape, &sphereShape, &capsuleShape};
+
+            const int nbBodiesPerRow = 30;
+            for (int i=0; i < 3 * NB_BODIES_PER_SHAPE; i++) {
+                const Vector3 position(decimal(i % nbBodiesPerRow - nbBodiesPerRow / 2) * decimal(3.2),
+                                       decimal(8) + decimal(i / (nbBodiesPerRow * nbBodiesPerRow)) * decimal(4),
+                                       decimal((i / nbBodiesPerRow) % nbBodiesPerRow - nbBodiesPerRow / 2) * decimal(3.2));
+                RigidBody* body = world.createRigidBody(Transform(position, Quaternion::identity()));
+                body->addCollisionShape(shapes[i % 3], Transform::identity(), decimal(1.0));
+            }
+
+            return measure([&]() {
+                for (int i=0; i < NB_STEPS; i++) {
+                    world.update(decimal(1.0) / decimal(60.0));
+                }
+            });
+        }
+
+        /// Return the name of a broad-phase algorithm
+        static std::string getBroadPhaseName(BroadPhaseType broadPhaseType) {
+            return broadPhaseType == BroadPhaseType::DYNAMIC_AABB_TREE ? "Dynamic AABB tree" : "Sweep-and-prune";
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkBroadPhase(const std::string& name) : Benchmark(name) {
+
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            std::stringstream bodiesText;
+            bodiesText << " (" << NB_BODIES << " moving bodies)";
+
+            for (uint nbThreads = 1; nbThreads <= 8; nbThreads *= 2) {
+
+                WorldSettings settings;
+                settings.nbBroadPhaseThreads = nbThreads;
+
+                std::stringstream name;
+                name << "Dynamic AABB tree with " << nbThreads << " thread" << (nbThreads > 1 ? "s" : "");
+                report(name.str() + bodiesText.str(), measureMovingBodies(settings));
+            }
+
+            WorldSettings sapSettings;
+            sapSettings.broadPhaseType = BroadPhaseType::SWEEP_AND_PRUNE;
+            report("Sweep-and-prune" + bodiesText.str(), measureMovingBodies(sapSettings));
+
+            WorldSettings refitSettings;
+            refitSettings.dynamicTreeUpdateMethod = DynamicTreeUpdateMethod::REFIT;
+            report("Dynamic AABB tree with refit" + bodiesText.str(), measureMovingBodies(refitSettings));
+
+            const BroadPhaseType broadPhaseTypes[2] = {BroadPhaseType::DYNAMIC_AABB_TREE, BroadPhaseType::SWEEP_AND_PRUNE};
+
+            std::stringstream cubesText;
+            cubesText << " (cubes scene, " << NB_CUBES_PER_ROW * NB_CUBES_PER_ROW * NB_CUBES_LAYERS << " cubes)";
+            for (int i=0; i < 2; i++) {
+                WorldSettings settings;
+                settings.broadPhaseType = broadPhaseTypes[i];
+                report(getBroadPhaseName(broadPhaseTypes[i]) + cubesText.str(), measureCubesScene(settings));
+            }
+            report("Dynamic AABB tree with refit" + cubesText.str(), measureCubesScene(refitSettings));
+
+            std::stringstream sleepingText;
+            sleepingText << " (sleeping scene, " << NB_SLEEPING_BOXES_PER_ROW * NB_SLEEPING_BOXES_PER_ROW << " boxes)";
+            report("Dynamic AABB tree" + sleepingText.str(), measureSleepingScene(WorldSettings()));
+
+            std::stringstream heightFieldText;
+            heightFieldText << " (height field scene, " << 3 * NB_BODIES_PER_SHAPE << " bodies)";
+            for (int i=0; i < 2; i++) {
+                WorldSettings settings;
+                settings.broadPhaseType = broadPhaseTypes[i];
+                report(getBroadPhaseName(broadPhaseTypes[i]) + heightFieldText.str(), measureHeightFieldScene(settings));
+            }
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_CONCAVE_MESH_SHAPE_H
+#define BENCHMARK_CONCAVE_MESH_SHAPE_H
+
+// Libraries
+#include "Benchmark.h"
+#include "reactphysics3d.h"
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class CountingTriangleCallback
+/**
+ * Triangle callback that counts the reported triangles
+ */
+class CountingTriangleCallback : public TriangleCallback {
+
+    public :
+
+        /// Number of reported triangles
+        uint nbTriangles = 0;
+
+        /// Report a triangle
+        virtual void testTriangle(const Vector3* trianglePoints, const Vector3* verticesNormals, uint shapeId) override {
+            nbTriangles++;
+        }
+};
+
+// Class BenchmarkConcaveMeshShape
+/**
+ * Benchmark of the creation and of the queries of concave mesh shapes of the city mesh
+ * of the testbed application with their own AABB tree and with a shared cooked BVH
+ */
+class BenchmarkConcaveMeshShape : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of shapes with different scalings
+        static const int NB_SHAPES = 8;
+
+        /// Number of AABB queries
+        static const int NB_QUERIES = 200000;
+
+        // ---------- Attributes ---------- //
+
+        /// Vertices of the mesh
+        std::vector<Vector3> mVertices;
+
+        /// Indices of the triangles of the mesh
+        std::vector<uint> mIndices;
+
+        // ---------- Methods ---------- //
+
+        /// Load the triangles of an OBJ mesh file
+        void loadMesh(const std::string& filename) {
+
+            std::ifstream file(filename.c_str());
+            std::string line;
+
+            while (std::getline(file, line)) {
+
+                std::istringstream lineStream(line);
+                std::string type;
+                lineStream >> type;
+
+                if (type == "v") {
+                    decimal x, y, z;
+                    lineStream >> x >> y >> z;
+                    mVertices.push_back(Vector3(x, y, z));
+                }
+                else if (type == "f") {
+
+                    // Triangulate the face as a fan (only the vertex indices are read)
+                    std::vector<uint> indices;
+                    std::string vertex;
+                    while (lineStream >> vertex) {
+                        indices.push_back(static_cast<uint>(std::atoi(vertex.c_str()) - 1));
+                    }
+                    for (size_t i=2; i < indices.size(); i++) {
+                        mIndices.push_back(indices[0]);
+                        mIndices.push_back(indices[i - 1]);
+                        mIndices.push_back(indices[i]);
+                    }
+                }
+            }
+        }
+
+        /// Return a pseudo-random number between zero and one
+        static decimal random(uint32& seed) {
+            seed = seed * 1664525u + 1013904223u;
+            return decimal(seed >> 8) / decimal(1 << 24);
+        }
+
+        /// Return the time needed to query a shape with small AABBs inside its bounds
+        static double measureQueries(const ConcaveMeshShape& shape, uint& nbTriangles) {
+
+            Vector3 min, max;
+            shape.getLocalBounds(min, max);
+            const Vector3 extent = max - min;
+
+            CountingTriangleCallback callback;
+            uint32 seed = 1357;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i=0; i < NB_QUERIES; i++) {
+                const Vector3 queryMin = min + Vector3(random(seed) * extent.x, random(seed) * extent.y, random(seed) * extent.z);
+                shape.testAllTriangles(callback, AABB(queryMin, queryMin + Vector3(2, 2, 2)));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            nbTriangles = callback.nbTriangles;
+
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkConcaveMeshShape(const std::string& name) : Benchmark(name) {
+            loadMesh(std::string(RP3D_BENCHMARKS_MESHES_FOLDER) + "city.obj");
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            if (mIndices.size() == 0) {
+                std::cout << "  The city.obj mesh cannot be loaded" << std::endl;
+                return;
+            }
+
+            TriangleVertexArray::VertexDataType vertexType = sizeof(decimal) == 4 ? TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE :
+                                                                                    TriangleVertexArray::VertexDataType::VERTEX_DOUBLE_TYPE;
+            TriangleVertexArray vertexArray(static_cast<uint>(mVertices.size()), &(mVertices[0]), sizeof(Vector3),
+                                            static_cast<uint>(mIndices.size() / 3), &(mIndices[0]), 3 * sizeof(uint),
+                                            vertexType, TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+            TriangleMesh triangleMesh;
+            triangleMesh.addSubpart(&vertexArray);
+
+            std::stringstream shapesText;
+            shapesText << " (city mesh, " << NB_SHAPES << " scaled shapes)";
+
+            std::stringstream queriesText;
+            queriesText << " (city mesh, " << NB_QUERIES << " AABB queries)";
+
+            // Shapes that build their own AABB tree
+            std::vector<ConcaveMeshShape*> shapes;
+            report("Shapes with their own tree" + shapesText.str(), measure([&]() {
+                for (int i=0; i < NB_SHAPES; i++) {
+                    shapes.push_back(new ConcaveMeshShape(&triangleMesh, Vector3(1, 1, 1) * decimal(i + 1)));
+                }
+            }));
+
+            // Cook the BVH once and save its serialized data
+            TriangleMeshBVH bvh(MemoryManager::getBaseAllocator());
+            report("Cooking of the BVH", measure([&]() {
+                bvh.build(triangleMesh);
+            }));
+            std::vector<uint32> serializedData(bvh.getSerializedSize() / sizeof(uint32) + 1);
+            std::memcpy(&(serializedData[0]), bvh.getSerializedData(), bvh.getSerializedSize());
+
+            // Shapes that share the loaded BVH
+            TriangleMeshBVH loadedBVH(MemoryManager::getBaseAllocator());
+            std::vector<ConcaveMeshShape*> cookedShapes;
+            report("Loaded BVH shared by the shapes" + shapesText.str(), measure([&]() {
+                loadedBVH.load(&(serializedData[0]), bvh.getSerializedSize());
+                for (int i=0; i < NB_SHAPES; i++) {
+                    cookedShapes.push_back(new ConcaveMeshShape(&triangleMesh, &loadedBVH, Vector3(1, 1, 1) * decimal(i + 1)));
+                }
+            }));
+
+            uint nbTriangles, nbCookedTriangles;
+            report("Shape with its own tree" + queriesText.str(), measureQueries(*shapes[0], nbTriangles));
+            report("Shape with the loaded BVH" + queriesText.str(), measureQueries(*cookedShapes[0], nbCookedTriangles));
+            assert(nbTriangles == nbCookedTriangles);
+
+            // Shape with the decoded and scaled triangles of the mesh in an array
+            uint nbPrecomputedTriangles;
+            shapes[0]->enablePrecomputedTriangles(true);
+            report("Precomputed triangles" + queriesText.str(), measureQueries(*shapes[0], nbPrecomputedTriangles));
+            assert(nbTriangles == nbPrecomputedTriangles);
+
+            // Shape with the quantized vertices and the short indices of the same mesh
+            TriangleVertexArray compressedVertexArray(static_cast<uint>(mVertices.size()), &(mVertices[0]), sizeof(Vector3),
+                                                      static_cast<uint>(mIndices.size() / 3), &(mIndices[0]), 3 * sizeof(uint),
+                                                      vertexType, TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+            reportMemory("Vertex array data (city mesh)", compressedVertexArray.getDataSize());
+            compressedVertexArray.compress();
+            reportMemory("Compressed vertex array data (city mesh)", compressedVertexArray.getDataSize());
+            TriangleMesh compressedTriangleMesh;
+            compressedTriangleMesh.addSubpart(&compressedVertexArray);
+            ConcaveMeshShape compressedShape(&compressedTriangleMesh, &loadedBVH);
+            uint nbCompressedTriangles;
+            report("Compressed mesh, loaded BVH" + queriesText.str(), measureQueries(compressedShape, nbCompressedTriangles));
+            assert(nbTriangles == nbCompressedTriangles);
+
+            for (int i=0; i < NB_SHAPES; i++) {
+                delete shapes[i];
+                delete cookedShapes[i];
+            }
+        }
+};
+
+}
+
+#endif
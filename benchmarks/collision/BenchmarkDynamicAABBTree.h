@@ -0,0 +1,161 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_DYNAMIC_AABB_TREE_H
+#define BENCHMARK_DYNAMIC_AABB_TREE_H
+
+// Libraries
+#include "Benchmark.h"
+#include "collision/broadphase/DynamicAABBTree.h"
+#include "memory/MemoryManager.h"
+#include <vector>
+#include <sstream>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class CountingOverlapCallback
+/**
+ * Overlap callback that counts the reported nodes
+ */
+class CountingOverlapCallback : public DynamicAABBTreeOverlapCallback {
+
+    public :
+
+        /// Number of reported nodes
+        uint nbOverlappingNodes = 0;
+
+        /// Called for each overlapping node
+        virtual void notifyOverlappingNode(int nodeId) override {
+            nbOverlappingNodes++;
+        }
+};
+
+// Class BenchmarkDynamicAABBTree
+/**
+ * Benchmark of the construction of a dynamic AABB tree with many objects by inserting
+ * the objects one by one and with the top-down SAH build and of the AABB queries in
+ * the resulting trees
+ */
+class BenchmarkDynamicAABBTree : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of objects in the tree
+        static const int NB_OBJECTS = 200000;
+
+        /// Number of AABB queries
+        static const int NB_QUERIES = 100000;
+
+        // ---------- Attributes ---------- //
+
+        /// AABBs of the objects
+        std::vector<AABB> mAABBs;
+
+        /// Data of the objects
+        std::vector<int32> mData;
+
+        // ---------- Methods ---------- //
+
+        /// Return a pseudo-random number between zero and one
+        static decimal random(uint32& seed) {
+            seed = seed * 1664525u + 1013904223u;
+            return decimal(seed >> 8) / decimal(1 << 24);
+        }
+
+        /// Return the time needed to query the tree with many small AABBs
+        double measureQueries(const DynamicAABBTree& tree) const {
+
+            CountingOverlapCallback callback;
+            uint32 seed = 4321;
+
+            return measure([&]() {
+                for (int i=0; i < NB_QUERIES; i++) {
+                    const Vector3 min(random(seed) * 500, random(seed) * 50, random(seed) * 500);
+                    tree.reportAllShapesOverlappingWithAABB(AABB(min, min + Vector3(3, 3, 3)), callback);
+                }
+            });
+        }
+
+        /// Return a text with the SAH cost of a tree
+        static std::string getCostText(const DynamicAABBTree& tree) {
+            std::stringstream text;
+            text << " (SAH cost " << tree.computeSAHCost() << ")";
+            return text.str();
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkDynamicAABBTree(const std::string& name) : Benchmark(name) {
+
+            // Objects of various sizes scattered in a level
+            uint32 seed = 1234;
+            for (int i=0; i < NB_OBJECTS; i++) {
+                const Vector3 min(random(seed) * 500, random(seed) * 50, random(seed) * 500);
+                const decimal size = decimal(0.2) + random(seed) * random(seed) * 4;
+                mAABBs.push_back(AABB(min, min + Vector3(size, size, size)));
+                mData.push_back(i);
+            }
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            std::stringstream objectsText;
+            objectsText << " (" << NB_OBJECTS << " objects)";
+
+            std::stringstream queriesText;
+            queriesText << " (" << NB_QUERIES << " queries)";
+
+            DynamicAABBTree insertedTree(MemoryManager::getBaseAllocator());
+            report("Insert the objects one by one" + objectsText.str(), measure([&]() {
+                for (int i=0; i < NB_OBJECTS; i++) {
+                    insertedTree.addObject(mAABBs[i], mData[i], mData[i]);
+                }
+            }));
+
+            DynamicAABBTree builtTree(MemoryManager::getBaseAllocator());
+            report("Build the tree with the binned SAH" + objectsText.str(), measure([&]() {
+                builtTree.buildTree(&(mAABBs[0]), &(mData[0]), &(mData[0]), NB_OBJECTS);
+            }));
+
+            report("Queries in the inserted tree" + getCostText(insertedTree), measureQueries(insertedTree));
+            report("Queries in the built tree" + getCostText(builtTree), measureQueries(builtTree));
+
+            report("Rebuild the inserted tree" + objectsText.str(), measure([&]() {
+                insertedTree.rebuild();
+            }));
+            report("Queries in the rebuilt tree" + getCostText(insertedTree), measureQueries(insertedTree));
+        }
+};
+
+}
+
+#endif
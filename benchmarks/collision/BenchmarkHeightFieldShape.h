@@ -0,0 +1,220 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_HEIGHT_FIELD_SHAPE_H
+#define BENCHMARK_HEIGHT_FIELD_SHAPE_H
+
+// Libraries
+#include "Benchmark.h"
+#include "reactphysics3d.h"
+#include <vector>
+#include <cmath>
+#include <sstream>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class HeightFieldCountingCallback
+/**
+ * Triangle callback that counts the reported triangles of a height field
+ */
+class HeightFieldCountingCallback : public TriangleCallback {
+
+    public :
+
+        /// Number of reported triangles
+        uint nbTriangles = 0;
+
+        /// Report a triangle
+        virtual void testTriangle(const Vector3* trianglePoints, const Vector3* verticesNormals, uint shapeId) override {
+            nbTriangles++;
+        }
+};
+
+// Class BenchmarkHeightFieldShape
+/**
+ * Benchmark of the raycasts of long line-of-sight rays across a large height field and of
+ * the AABB queries of shapes flying above it, without and with the min/max height hierarchy
+ */
+class BenchmarkHeightFieldShape : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of grid points along each side of the height field
+        static const int NB_POINTS_PER_SIDE = 1025;
+
+        /// Number of rays
+        static const int NB_RAYS = 5000;
+
+        /// Number of rays raycast against all the triangles in their AABB
+        static const int NB_SLOW_RAYS = 10;
+
+        /// Number of AABB queries
+        static const int NB_QUERIES = 20000;
+
+        /// Maximum height of the terrain
+        static constexpr float MAX_HEIGHT = 40.0f;
+
+        // ---------- Attributes ---------- //
+
+        /// Height values of the terrain
+        std::vector<float> mHeights;
+
+        // ---------- Methods ---------- //
+
+        /// Return a pseudo-random number between zero and one
+        static decimal random(uint32& seed) {
+            seed = seed * 1664525u + 1013904223u;
+            return decimal(seed >> 8) / decimal(1 << 24);
+        }
+
+        /// Return the time needed to query the terrain with the AABBs of shapes flying above it
+        static double measureQueries(const HeightFieldShape& shape, decimal halfSize, uint& nbTriangles) {
+
+            HeightFieldCountingCallback callback;
+            uint32 seed = 8642;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i=0; i < NB_QUERIES; i++) {
+                const Vector3 min((random(seed) * 2 - 1) * halfSize, decimal(MAX_HEIGHT) * (decimal(0.3) * random(seed) - decimal(0.1)),
+                                  (random(seed) * 2 - 1) * halfSize);
+                shape.testAllTriangles(callback, AABB(min, min + Vector3(12, 4, 12)));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            nbTriangles = callback.nbTriangles;
+
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        /// Return a long ray between two random points above two opposite sides of the terrain
+        static Ray createRay(uint32& seed, decimal halfSize) {
+            const decimal height1 = decimal(MAX_HEIGHT) * (decimal(0.25) + random(seed));
+            const decimal height2 = decimal(MAX_HEIGHT) * (decimal(0.25) + random(seed));
+            return Ray(Vector3(-halfSize, height1, (random(seed) * 2 - 1) * halfSize),
+                       Vector3(halfSize, height2, (random(seed) * 2 - 1) * halfSize));
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkHeightFieldShape(const std::string& name) : Benchmark(name) {
+
+            // Rolling hills
+            for (int j=0; j < NB_POINTS_PER_SIDE; j++) {
+                for (int i=0; i < NB_POINTS_PER_SIDE; i++) {
+                    const float x = float(i) * 0.02f;
+                    const float z = float(j) * 0.015f;
+                    mHeights.push_back(MAX_HEIGHT * 0.5f * (1.0f + 0.6f * std::sin(x) * std::cos(z) + 0.4f * std::sin(3.1f * x + z)));
+                }
+            }
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            CollisionWorld world;
+            HeightFieldShape shape(NB_POINTS_PER_SIDE, NB_POINTS_PER_SIDE, 0, MAX_HEIGHT, &(mHeights[0]),
+                                   HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE);
+            CollisionBody* body = world.createCollisionBody(Transform::identity());
+            ProxyShape* proxyShape = body->addCollisionShape(&shape, Transform::identity());
+            const decimal halfSize = decimal(NB_POINTS_PER_SIDE - 1) * decimal(0.5);
+
+            std::stringstream slowRaysText;
+            slowRaysText << " (" << NB_POINTS_PER_SIDE << "x" << NB_POINTS_PER_SIDE << " terrain, " << NB_SLOW_RAYS << " rays)";
+
+            std::stringstream raysText;
+            raysText << " (" << NB_POINTS_PER_SIDE << "x" << NB_POINTS_PER_SIDE << " terrain, " << NB_RAYS << " rays)";
+
+            // Raycast of all the triangles whose grid cells overlap the AABB of the ray
+            uint32 seed = 97531;
+            int nbSlowHits = 0;
+            report("Triangles in the ray AABB" + slowRaysText.str(), measure([&]() {
+                for (int i=0; i < NB_SLOW_RAYS; i++) {
+                    const Ray ray = createRay(seed, halfSize);
+                    RaycastInfo raycastInfo;
+                    TriangleOverlapCallback callback(ray, proxyShape, raycastInfo, shape, MemoryManager::getBaseAllocator());
+                    shape.testAllTriangles(callback, AABB(Vector3::min(ray.point1, ray.point2), Vector3::max(ray.point1, ray.point2)));
+                    if (callback.getIsHit()) nbSlowHits++;
+                }
+            }));
+
+            // Raycast of the shape that walks through the grid cells crossed by the ray
+            seed = 97531;
+            int nbHits = 0;
+            report("Grid walk raycast" + slowRaysText.str(), measure([&]() {
+                for (int i=0; i < NB_SLOW_RAYS; i++) {
+                    RaycastInfo raycastInfo;
+                    if (proxyShape->raycast(createRay(seed, halfSize), raycastInfo)) nbHits++;
+                }
+            }));
+            assert(nbHits == nbSlowHits);
+
+            const uint32 raysSeed = seed;
+            nbHits = 0;
+            report("Grid walk raycast" + raysText.str(), measure([&]() {
+                for (int i=0; i < NB_RAYS; i++) {
+                    RaycastInfo raycastInfo;
+                    if (proxyShape->raycast(createRay(seed, halfSize), raycastInfo)) nbHits++;
+                }
+            }));
+
+            std::stringstream queriesText;
+            queriesText << " (" << NB_POINTS_PER_SIDE << "x" << NB_POINTS_PER_SIDE << " terrain, " << NB_QUERIES << " AABBs)";
+
+            // AABB queries of the shapes above the terrain
+            uint nbTriangles;
+            report("AABB queries" + queriesText.str(), measureQueries(shape, halfSize, nbTriangles));
+
+            // Same queries and raycasts with the min/max height hierarchy
+            report("Computation of the min/max height hierarchy", measure([&]() {
+                shape.enableMinMaxHeightHierarchy(true);
+            }));
+
+            uint nbHierarchyTriangles;
+            report("Hierarchy AABB queries" + queriesText.str(), measureQueries(shape, halfSize, nbHierarchyTriangles));
+            assert(nbHierarchyTriangles <= nbTriangles);
+
+            seed = raysSeed;
+            int nbHierarchyHits = 0;
+            report("Hierarchy raycast" + raysText.str(), measure([&]() {
+                for (int i=0; i < NB_RAYS; i++) {
+                    RaycastInfo raycastInfo;
+                    if (proxyShape->raycast(createRay(seed, halfSize), raycastInfo)) nbHierarchyHits++;
+                }
+            }));
+            assert(nbHits == nbHierarchyHits);
+
+            world.destroyCollisionBody(body);
+        }
+};
+
+}
+
+#endif
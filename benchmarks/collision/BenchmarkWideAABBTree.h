@@ -0,0 +1,221 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_WIDE_AABB_TREE_H
+#define BENCHMARK_WIDE_AABB_TREE_H
+
+// Libraries
+#include "Benchmark.h"
+#include "collision/broadphase/DynamicAABBTree.h"
+#include "collision/broadphase/WideAABBTree.h"
+#include "memory/MemoryManager.h"
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class CountingTreeCallback
+/**
+ * Overlap and raycast callback that counts the reported leaves
+ */
+class CountingTreeCallback : public DynamicAABBTreeOverlapCallback, public DynamicAABBTreeRaycastCallback {
+
+    public :
+
+        /// Number of reported leaves
+        uint nbLeaves = 0;
+
+        /// Called for each overlapping leaf
+        virtual void notifyOverlappingNode(int nodeId) override {
+            nbLeaves++;
+        }
+
+        /// Called for each leaf hit by a ray (the ray is not clipped)
+        virtual decimal raycastBroadPhaseShape(int32 nodeId, const Ray& ray) override {
+            nbLeaves++;
+            return decimal(-1.0);
+        }
+};
+
+// Class BenchmarkWideAABBTree
+/**
+ * Benchmark of the AABB queries and of the raycasts in the triangle tree of the city
+ * mesh of the testbed application with the binary dynamic AABB tree and with the wide
+ * AABB tree built from it
+ */
+class BenchmarkWideAABBTree : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of AABB queries
+        static const int NB_QUERIES = 200000;
+
+        /// Number of raycasts
+        static const int NB_RAYCASTS = 200000;
+
+        // ---------- Attributes ---------- //
+
+        /// AABBs of the triangles of the mesh
+        std::vector<AABB> mTrianglesAABBs;
+
+        // ---------- Methods ---------- //
+
+        /// Load the AABBs of the triangles of an OBJ mesh file
+        void loadMesh(const std::string& filename) {
+
+            std::ifstream file(filename.c_str());
+            std::vector<Vector3> vertices;
+            std::string line;
+
+            while (std::getline(file, line)) {
+
+                std::istringstream lineStream(line);
+                std::string type;
+                lineStream >> type;
+
+                if (type == "v") {
+                    decimal x, y, z;
+                    lineStream >> x >> y >> z;
+                    vertices.push_back(Vector3(x, y, z));
+                }
+                else if (type == "f") {
+
+                    // Triangulate the face as a fan (only the vertex indices are read)
+                    std::vector<int> indices;
+                    std::string vertex;
+                    while (lineStream >> vertex) {
+                        indices.push_back(std::atoi(vertex.c_str()) - 1);
+                    }
+                    for (size_t i=2; i < indices.size(); i++) {
+                        const Vector3 points[3] = {vertices[indices[0]], vertices[indices[i - 1]], vertices[indices[i]]};
+                        mTrianglesAABBs.push_back(AABB::createAABBForTriangle(points));
+                    }
+                }
+            }
+        }
+
+        /// Return a pseudo-random number between zero and one
+        static decimal random(uint32& seed) {
+            seed = seed * 1664525u + 1013904223u;
+            return decimal(seed >> 8) / decimal(1 << 24);
+        }
+
+        /// Return a pseudo-random point inside an AABB
+        static Vector3 randomPoint(const AABB& aabb, uint32& seed) {
+            const Vector3 extent = aabb.getExtent();
+            return aabb.getMin() + Vector3(random(seed) * extent.x, random(seed) * extent.y, random(seed) * extent.z);
+        }
+
+        /// Return the time needed to query a tree with small AABBs inside the mesh
+        template<typename Tree>
+        double measureQueries(const Tree& tree, const AABB& meshAABB, uint& nbLeaves) const {
+
+            CountingTreeCallback callback;
+            uint32 seed = 1357;
+
+            const double time = measure([&]() {
+                for (int i=0; i < NB_QUERIES; i++) {
+                    const Vector3 min = randomPoint(meshAABB, seed);
+                    tree.reportAllShapesOverlappingWithAABB(AABB(min, min + Vector3(2, 2, 2)), callback);
+                }
+            });
+
+            nbLeaves = callback.nbLeaves;
+
+            return time;
+        }
+
+        /// Return the time needed to cast rays between two points of the mesh
+        template<typename Tree>
+        double measureRaycasts(const Tree& tree, const AABB& meshAABB, uint& nbLeaves) const {
+
+            CountingTreeCallback callback;
+            uint32 seed = 9753;
+
+            const double time = measure([&]() {
+                for (int i=0; i < NB_RAYCASTS; i++) {
+                    const Vector3 point1 = randomPoint(meshAABB, seed);
+                    const Vector3 point2 = randomPoint(meshAABB, seed);
+                    tree.raycast(Ray(point1, point2), callback);
+                }
+            });
+
+            nbLeaves = callback.nbLeaves;
+
+            return time;
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkWideAABBTree(const std::string& name) : Benchmark(name) {
+            loadMesh(std::string(RP3D_BENCHMARKS_MESHES_FOLDER) + "city.obj");
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            if (mTrianglesAABBs.size() == 0) {
+                std::cout << "  The city.obj mesh cannot be loaded" << std::endl;
+                return;
+            }
+
+            const int nbTriangles = static_cast<int>(mTrianglesAABBs.size());
+            std::vector<int32> data(nbTriangles, 0);
+
+            DynamicAABBTree tree(MemoryManager::getBaseAllocator());
+            tree.buildTree(&(mTrianglesAABBs[0]), &(data[0]), &(data[0]), nbTriangles);
+
+            WideAABBTree wideTree(MemoryManager::getBaseAllocator());
+            wideTree.build(tree);
+
+            const AABB meshAABB = tree.getRootAABB();
+
+            std::stringstream queriesText;
+            queriesText << " (city mesh, " << NB_QUERIES << " AABB queries)";
+
+            std::stringstream raycastsText;
+            raycastsText << " (city mesh, " << NB_RAYCASTS << " raycasts)";
+
+            uint nbLeaves, nbWideLeaves;
+            report("Binary tree" + queriesText.str(), measureQueries(tree, meshAABB, nbLeaves));
+            report("Wide tree" + queriesText.str(), measureQueries(wideTree, meshAABB, nbWideLeaves));
+            assert(nbLeaves == nbWideLeaves);
+
+            report("Binary tree" + raycastsText.str(), measureRaycasts(tree, meshAABB, nbLeaves));
+            report("Wide tree" + raycastsText.str(), measureRaycasts(wideTree, meshAABB, nbWideLeaves));
+            assert(nbLeaves == nbWideLeaves);
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_MAPS_H
+#define BENCHMARK_MAPS_H
+
+// Libraries
+#include "Benchmark.h"
+#include "containers/Map.h"
+#include "containers/FlatMap.h"
+#include "memory/DefaultPoolAllocator.h"
+#include "memory/MemoryManager.h"
+#include <vector>
+#include <sstream>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class BenchmarkMaps
+/**
+ * Benchmark of the node-based Map against the open-addressing FlatMap with keys
+ * that are pairs of broad-phase ids as the keys of the overlapping pairs map
+ */
+class BenchmarkMaps : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of frames of the simulated pairs update
+        static const int NB_FRAMES = 100;
+
+        // ---------- Attributes ---------- //
+
+        /// Sum of the values found in the maps (to avoid the removal of the lookups by the compiler)
+        uint64_t mChecksum;
+
+        // ---------- Methods ---------- //
+
+        /// Return a list of distinct keys
+        static std::vector<Pair<uint, uint>> createKeys(int nbKeys, uint seed) {
+
+            std::vector<Pair<uint, uint>> keys;
+            keys.reserve(nbKeys);
+
+            uint random = seed;
+            for (int i=0; i < nbKeys; i++) {
+                random = random * 1664525u + 1013904223u;
+
+                // The first id is unique and the second one is a random small id
+                keys.push_back(Pair<uint, uint>(static_cast<uint>(i), (random >> 16) % 10000));
+            }
+
+            return keys;
+        }
+
+        /// Benchmark a map type with a given number of keys
+        template<template<typename, typename> class MapType>
+        void benchmarkMap(const std::string& name, int nbKeys) {
+
+            DefaultPoolAllocator allocator(MemoryManager::getBaseAllocator());
+
+            const std::vector<Pair<uint, uint>> keys = createKeys(nbKeys, 1);
+            const std::vector<Pair<uint, uint>> missingKeys = createKeys(2 * nbKeys, 2);
+
+            MapType<Pair<uint, uint>, uint> map(allocator);
+
+            std::stringstream keysText;
+            keysText << " (" << nbKeys << " keys)";
+
+            report(name + " add" + keysText.str(), measure([&]() {
+                for (int i=0; i < nbKeys; i++) {
+                    map.add(Pair<Pair<uint, uint>, uint>(keys[i], static_cast<uint>(i)));
+                }
+            }));
+
+            report(name + " find existing keys" + keysText.str(), measure([&]() {
+                for (int i=0; i < nbKeys; i++) {
+                    mChecksum += map.find(keys[i])->second;
+                }
+            }));
+
+            report(name + " find missing keys" + keysText.str(), measure([&]() {
+                for (int i=nbKeys; i < 2 * nbKeys; i++) {
+                    mChecksum += map.containsKey(missingKeys[i]) ? 1 : 0;
+                }
+            }));
+
+            report(name + " iterate" + keysText.str(), measure([&]() {
+                for (int r=0; r < 10; r++) {
+                    for (auto it = map.begin(); it != map.end(); ++it) {
+                        mChecksum += it->second;
+                    }
+                }
+            }));
+
+            // Each frame, remove some old pairs during the iteration (as in the
+            // middle-phase) and add new pairs (as in the broad-phase)
+            report(name + " update pairs" + keysText.str(), measure([&]() {
+                int nextKey = 0;
+                for (int f=0; f < NB_FRAMES; f++) {
+                    for (auto it = map.begin(); it != map.end(); ) {
+                        if ((it->first.first + f) % 10 == 0) {
+                            it = map.remove(it);
+                        }
+                        else {
+                            ++it;
+                        }
+                    }
+                    for (int i=0; i < nbKeys / 10 && nextKey < 2 * nbKeys; i++, nextKey++) {
+                        if (!map.containsKey(missingKeys[nextKey])) {
+                            map.add(Pair<Pair<uint, uint>, uint>(missingKeys[nextKey], static_cast<uint>(i)));
+                        }
+                    }
+                    if (nextKey == 2 * nbKeys) nextKey = 0;
+                }
+            }));
+
+            report(name + " remove" + keysText.str(), measure([&]() {
+                for (int i=0; i < nbKeys; i++) {
+                    map.remove(keys[i]);
+                }
+                map.clear();
+            }));
+        }
+
+        /// Benchmark the slowest addition of a FlatMap whose size ramps up with and
+        /// without the incremental rehashing
+        void benchmarkLargestAddition(int nbKeys) {
+
+            DefaultPoolAllocator allocator(MemoryManager::getBaseAllocator());
+
+            const std::vector<Pair<uint, uint>> keys = createKeys(nbKeys, 1);
+
+            std::stringstream keysText;
+            keysText << " (" << nbKeys << " keys)";
+
+            for (int i=0; i < 2; i++) {
+
+                const bool isIncremental = i == 1;
+                FlatMap<Pair<uint, uint>, uint> map(allocator, 0, isIncremental);
+
+                double maxTime = 0.0;
+                double totalTime = 0.0;
+                for (int k=0; k < nbKeys; k++) {
+                    const double time = measure([&]() {
+                        map.add(Pair<Pair<uint, uint>, uint>(keys[k], static_cast<uint>(k)));
+                    });
+                    totalTime += time;
+                    if (time > maxTime) maxTime = time;
+                }
+
+                const std::string name = isIncremental ? "FlatMap incremental" : "FlatMap";
+                report(name + " add" + keysText.str(), totalTime);
+                report(name + " slowest add" + keysText.str(), maxTime);
+            }
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkMaps(const std::string& name) : Benchmark(name), mChecksum(0) {
+
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            for (int nbKeys = 1000; nbKeys <= 1000000; nbKeys *= 10) {
+                benchmarkMap<Map>("Map", nbKeys);
+                benchmarkMap<FlatMap>("FlatMap", nbKeys);
+            }
+
+            benchmarkLargestAddition(1000000);
+        }
+};
+
+}
+
+#endif
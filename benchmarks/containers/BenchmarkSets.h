@@ -0,0 +1,160 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_SETS_H
+#define BENCHMARK_SETS_H
+
+// Libraries
+#include "Benchmark.h"
+#include "containers/Set.h"
+#include "containers/FlatSet.h"
+#include "containers/DenseIntegerSet.h"
+#include "memory/DefaultPoolAllocator.h"
+#include "memory/MemoryManager.h"
+#include <vector>
+#include <sstream>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class BenchmarkSets
+/**
+ * Benchmark of the node-based Set against the open-addressing FlatSet and the
+ * DenseIntegerSet for the moved shapes of the broad-phase and for the pairs of
+ * bodies that cannot collide
+ */
+class BenchmarkSets : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of simulated frames
+        static const int NB_FRAMES = 100;
+
+        // ---------- Attributes ---------- //
+
+        /// Sum of the values found in the sets (to avoid the removal of the lookups by the compiler)
+        uint64_t mChecksum;
+
+        // ---------- Methods ---------- //
+
+        /// Return the broad-phase ids of the shapes that move during each frame
+        static std::vector<int> createMovedIds(int nbShapes) {
+
+            std::vector<int> ids;
+            ids.reserve(NB_FRAMES * nbShapes / 2);
+
+            uint random = 1;
+            for (int i=0; i < NB_FRAMES * nbShapes / 2; i++) {
+                random = random * 1664525u + 1013904223u;
+                ids.push_back(static_cast<int>((random >> 8) % nbShapes));
+            }
+
+            return ids;
+        }
+
+        /// Simulate the moved shapes of the broad-phase: each frame, about half of the
+        /// shapes are added into the set (some of them several times), then the set is
+        /// iterated and cleared
+        template<typename SetType>
+        double measureMovedShapes(SetType& set, const std::vector<int>& ids, int nbShapes) {
+
+            return measure([&]() {
+                const int nbIdsPerFrame = nbShapes / 2;
+                for (int f=0; f < NB_FRAMES; f++) {
+                    for (int i=f * nbIdsPerFrame; i < (f + 1) * nbIdsPerFrame; i++) {
+                        set.add(ids[i]);
+                    }
+                    for (auto it = set.begin(); it != set.end(); ++it) {
+                        mChecksum += *it;
+                    }
+                    set.clear();
+                }
+            });
+        }
+
+        /// Simulate the test of the pairs of bodies that cannot collide for each overlapping pair
+        template<template<typename> class SetType>
+        double measureNoCollisionPairs(int nbPairs) {
+
+            DefaultPoolAllocator allocator(MemoryManager::getBaseAllocator());
+            SetType<bodyindexpair> set(allocator);
+            for (int i=0; i < 100; i++) {
+                set.add(bodyindexpair(i, i + 1));
+            }
+
+            return measure([&]() {
+                for (int f=0; f < NB_FRAMES; f++) {
+                    for (int i=0; i < nbPairs; i++) {
+                        mChecksum += set.contains(bodyindexpair(i / 4, i / 4 + 1 + i % 4)) ? 1 : 0;
+                    }
+                }
+            });
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkSets(const std::string& name) : Benchmark(name), mChecksum(0) {
+
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            for (int nbShapes = 1000; nbShapes <= 100000; nbShapes *= 10) {
+
+                const std::vector<int> ids = createMovedIds(nbShapes);
+
+                DefaultPoolAllocator allocator(MemoryManager::getBaseAllocator());
+                Set<int> set(allocator);
+                FlatSet<int> flatSet(allocator);
+                DenseIntegerSet denseSet(allocator);
+
+                std::stringstream shapesText;
+                shapesText << " (" << nbShapes << " shapes)";
+
+                report("Set moved shapes" + shapesText.str(), measureMovedShapes(set, ids, nbShapes));
+                report("FlatSet moved shapes" + shapesText.str(), measureMovedShapes(flatSet, ids, nbShapes));
+                report("DenseIntegerSet moved shapes" + shapesText.str(), measureMovedShapes(denseSet, ids, nbShapes));
+            }
+
+            for (int nbPairs = 1000; nbPairs <= 100000; nbPairs *= 10) {
+
+                std::stringstream pairsText;
+                pairsText << " (" << nbPairs << " pairs)";
+
+                report("Set no collision pairs" + pairsText.str(), measureNoCollisionPairs<Set>(nbPairs));
+                report("FlatSet no collision pairs" + pairsText.str(), measureNoCollisionPairs<FlatSet>(nbPairs));
+            }
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "Benchmark.h"
+#include "memory/BenchmarkPoolAllocators.h"
+#include "memory/BenchmarkHugePageAllocator.h"
+#include "containers/BenchmarkMaps.h"
+#include "containers/BenchmarkSets.h"
+#include "collision/BenchmarkBroadPhase.h"
+#include "collision/BenchmarkDynamicAABBTree.h"
+#include "collision/BenchmarkWideAABBTree.h"
+#include "collision/BenchmarkConcaveMeshShape.h"
+#include "collision/BenchmarkHeightFieldShape.h"
+#include <vector>
+
+using namespace reactphysics3d;
+
+int main() {
+
+    std::vector<Benchmark*> benchmarks;
+
+    // ---------- Memory benchmarks ---------- //
+
+    benchmarks.push_back(new BenchmarkPoolAllocators("Pool allocators"));
+    benchmarks.push_back(new BenchmarkHugePageAllocator("Huge page allocator"));
+
+    // ---------- Containers benchmarks ---------- //
+
+    benchmarks.push_back(new BenchmarkMaps("Maps"));
+    benchmarks.push_back(new BenchmarkSets("Sets"));
+
+    // ---------- Collision detection benchmarks ---------- //
+
+    benchmarks.push_back(new BenchmarkBroadPhase("Broad-phase"));
+    benchmarks.push_back(new BenchmarkDynamicAABBTree("Dynamic AABB tree"));
+    benchmarks.push_back(new BenchmarkWideAABBTree("Wide AABB tree"));
+    benchmarks.push_back(new BenchmarkConcaveMeshShape("Concave mesh shape"));
+    benchmarks.push_back(new BenchmarkHeightFieldShape("Height field shape"));
+
+    // Run the benchmarks
+    for (Benchmark* benchmark : benchmarks) {
+
+        std::cout << benchmark->getName() << std::endl;
+        benchmark->run();
+        std::cout << std::endl;
+
+        delete benchmark;
+    }
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_HUGE_PAGE_ALLOCATOR_H
+#define BENCHMARK_HUGE_PAGE_ALLOCATOR_H
+
+// Libraries
+#include "Benchmark.h"
+#include "reactphysics3d.h"
+#include <vector>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class OverlapCounter
+/**
+ * Dynamic AABB tree overlap callback that counts the overlapping nodes
+ */
+class OverlapCounter : public DynamicAABBTreeOverlapCallback {
+
+    public :
+
+        /// Number of overlapping nodes
+        uint nbOverlaps = 0;
+
+        /// Called when a overlapping node has been found
+        virtual void notifyOverlappingNode(int nodeId) override {
+            nbOverlaps++;
+        }
+};
+
+// Class BenchmarkHugePageAllocator
+/**
+ * Benchmark of the HugePageAllocator against the DefaultAllocator as the base
+ * allocator of the broad-phase (dynamic AABB tree) and of a dynamics world
+ */
+class BenchmarkHugePageAllocator : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of proxies in the dynamic AABB tree
+        static const int NB_TREE_PROXIES = 100000;
+
+        /// Number of updates of the dynamic AABB tree
+        static const int NB_TREE_UPDATES = 3;
+
+        /// Number of bodies in the dynamics world
+        static const int NB_WORLD_BODIES = 10000;
+
+        /// Number of steps of the dynamics world
+        static const int NB_WORLD_STEPS = 60;
+
+        // ---------- Methods ---------- //
+
+        /// Return the AABB of a proxy of the tree at a given time
+        static AABB getProxyAABB(int index, int time) {
+            const int gridSize = 60;
+            const decimal offset = decimal(0.3) * std::sin(decimal(index + time));
+            const Vector3 center(decimal(index % gridSize) * decimal(1.5) + offset,
+                                 decimal((index / gridSize) % gridSize) * decimal(1.5),
+                                 decimal(index / (gridSize * gridSize)) * decimal(1.5));
+            return AABB(center - Vector3(1, 1, 1), center + Vector3(1, 1, 1));
+        }
+
+        /// Return the time needed to update and query a large dynamic AABB tree
+        double measureBroadPhase(MemoryAllocator& baseAllocator) const {
+
+            DefaultPoolAllocator poolAllocator(baseAllocator);
+            DynamicAABBTree tree(poolAllocator, decimal(0.1));
+
+            std::vector<int> nodes(NB_TREE_PROXIES);
+            for (int i=0; i < NB_TREE_PROXIES; i++) {
+                nodes[i] = tree.addObject(getProxyAABB(i, 0), nullptr);
+            }
+
+            OverlapCounter counter;
+            return measure([&]() {
+                for (int t=1; t <= NB_TREE_UPDATES; t++) {
+                    for (int i=0; i < NB_TREE_PROXIES; i++) {
+                        tree.updateObject(nodes[i], getProxyAABB(i, t), Vector3(0, 0, 0));
+                    }
+                    for (int i=0; i < NB_TREE_PROXIES; i++) {
+                        tree.reportAllShapesOverlappingWithAABB(tree.getFatAABB(nodes[i]), counter);
+                    }
+                }
+            });
+        }
+
+        /// Return the time needed to simulate a world with many bodies
+        double measureWorld(MemoryAllocator& baseAllocator) const {
+
+            WorldSettings settings;
+            settings.baseMemoryAllocator = &baseAllocator;
+            DynamicsWorld world(Vector3(0, decimal(-9.81), 0), settings);
+
+            BoxShape boxShape(Vector3(decimal(0.5), decimal(0.5), decimal(0.5)));
+            BoxShape floorShape(Vector3(1000, 1, 1000));
+
+            RigidBody* floor = world.createRigidBody(Transform(Vector3(0, -1, 0), Quaternion::identity()));
+            floor->setType(BodyType::STATIC);
+            floor->addCollisionShape(&floorShape, Transform::identity(), decimal(1.0));
+
+            const int gridSize = 50;
+            std::vector<RigidBody*> bodies;
+            for (int i=0; i < NB_WORLD_BODIES; i++) {
+                const Vector3 position(decimal(i % gridSize) * decimal(1.1), decimal(i / (gridSize * gridSize)) * decimal(1.1) + decimal(0.5),
+                                       decimal((i / gridSize) % gridSize) * decimal(1.1));
+                RigidBody* body = world.createRigidBody(Transform(position, Quaternion::identity()));
+                body->addCollisionShape(&boxShape, Transform::identity(), decimal(1.0));
+                bodies.push_back(body);
+            }
+
+            const double time = measure([&]() {
+                for (int s=0; s < NB_WORLD_STEPS; s++) {
+                    world.update(decimal(1.0) / decimal(60.0));
+                }
+            });
+
+            for (RigidBody* body : bodies) {
+                world.destroyRigidBody(body);
+            }
+            world.destroyRigidBody(floor);
+
+            return time;
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkHugePageAllocator(const std::string& name) : Benchmark(name) {
+
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            if (!HugePageAllocator::isHugePageSupported()) {
+                std::cout << "  Huge pages are not supported on this platform" << std::endl;
+            }
+
+            DefaultAllocator defaultAllocator;
+            HugePageAllocator hugePageAllocator;
+
+            report("Broad-phase (DefaultAllocator)", measureBroadPhase(defaultAllocator));
+            report("Broad-phase (HugePageAllocator)", measureBroadPhase(hugePageAllocator));
+            report("DynamicsWorld update (DefaultAllocator)", measureWorld(defaultAllocator));
+            report("DynamicsWorld update (HugePageAllocator)", measureWorld(hugePageAllocator));
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BENCHMARK_POOL_ALLOCATORS_H
+#define BENCHMARK_POOL_ALLOCATORS_H
+
+// Libraries
+#include "Benchmark.h"
+#include "memory/DefaultPoolAllocator.h"
+#include "memory/ThreadCachingPoolAllocator.h"
+#include "memory/MemoryManager.h"
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <sstream>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class LockedAllocator
+/**
+ * Memory allocator that protects a non thread-safe allocator with a global lock
+ */
+class LockedAllocator : public MemoryAllocator {
+
+    private :
+
+        /// Protected allocator
+        MemoryAllocator& mAllocator;
+
+        /// Global lock
+        std::mutex mMutex;
+
+    public :
+
+        /// Constructor
+        LockedAllocator(MemoryAllocator& allocator) : mAllocator(allocator) {}
+
+        /// Allocate memory of a given size (in bytes)
+        virtual void* allocate(size_t size) override {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mAllocator.allocate(size);
+        }
+
+        /// Release previously allocated memory.
+        virtual void release(void* pointer, size_t size) override {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mAllocator.release(pointer, size);
+        }
+};
+
+// Class BenchmarkPoolAllocators
+/**
+ * Benchmark of the DefaultPoolAllocator (protected by a global lock) against
+ * the ThreadCachingPoolAllocator when used concurrently by several threads
+ */
+class BenchmarkPoolAllocators : public Benchmark {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of allocation rounds per thread
+        static const int NB_ROUNDS = 200;
+
+        /// Number of allocations per round
+        static const int NB_ALLOCATIONS_PER_ROUND = 1000;
+
+        // ---------- Methods ---------- //
+
+        /// Allocate and release memory with an allocator (executed by each thread)
+        static void allocateAndRelease(MemoryAllocator& allocator, uint seed) {
+
+            const size_t sizes[] = {16, 24, 32, 48, 64, 96, 128, 256};
+            std::vector<std::pair<void*, size_t>> allocations(NB_ALLOCATIONS_PER_ROUND);
+
+            uint random = seed;
+            for (int r=0; r < NB_ROUNDS; r++) {
+
+                for (int i=0; i < NB_ALLOCATIONS_PER_ROUND; i++) {
+                    random = random * 1664525u + 1013904223u;
+                    const size_t size = sizes[(random >> 16) % 8];
+                    allocations[i] = std::make_pair(allocator.allocate(size), size);
+                }
+
+                // Release the memory in an interleaved order
+                for (int i=0; i < NB_ALLOCATIONS_PER_ROUND; i += 2) {
+                    allocator.release(allocations[i].first, allocations[i].second);
+                }
+                for (int i=1; i < NB_ALLOCATIONS_PER_ROUND; i += 2) {
+                    allocator.release(allocations[i].first, allocations[i].second);
+                }
+            }
+        }
+
+        /// Return the time needed by several threads to use an allocator concurrently
+        double measureAllocator(MemoryAllocator& allocator, uint nbThreads) const {
+
+            return measure([&allocator, nbThreads]() {
+
+                std::vector<std::thread> threads;
+                for (uint t=0; t < nbThreads; t++) {
+                    threads.push_back(std::thread(allocateAndRelease, std::ref(allocator), t + 1));
+                }
+                for (std::thread& thread : threads) {
+                    thread.join();
+                }
+            });
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        BenchmarkPoolAllocators(const std::string& name) : Benchmark(name) {
+
+        }
+
+        /// Run the benchmark
+        virtual void run() override {
+
+            for (uint nbThreads = 1; nbThreads <= 16; nbThreads *= 2) {
+
+                DefaultPoolAllocator defaultPoolAllocator(MemoryManager::getBaseAllocator());
+                LockedAllocator lockedAllocator(defaultPoolAllocator);
+                ThreadCachingPoolAllocator threadCachingAllocator(MemoryManager::getBaseAllocator());
+
+                std::stringstream threadsText;
+                threadsText << " (" << nbThreads << " threads)";
+
+                report("DefaultPoolAllocator with global lock" + threadsText.str(),
+                       measureAllocator(lockedAllocator, nbThreads));
+                report("ThreadCachingPoolAllocator" + threadsText.str(),
+                       measureAllocator(threadCachingAllocator, nbThreads));
+            }
+        }
+};
+
+}
+
+#endif
@@ -77,7 +77,7 @@ ProxyShape* CollisionBody::addCollisionShape(CollisionShape* collisionShape,
 
     // Create a new proxy collision shape to attach the collision shape to the body
     ProxyShape* proxyShape = new (mWorld.mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                      sizeof(ProxyShape))) ProxyShape(this, collisionShape,
+                                      sizeof(ProxyShape), MemoryManager::AllocationTag::Bodies)) ProxyShape(this, collisionShape,
                                                                       transform, decimal(1), mWorld.mMemoryManager);
 
 #ifdef IS_PROFILING_ACTIVE
@@ -146,7 +146,8 @@ void CollisionBody::removeCollisionShape(const ProxyShape* proxyShape) {
         }
 
         current->~ProxyShape();
-        mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, current, sizeof(ProxyShape));
+        mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, current, sizeof(ProxyShape),
+                                      MemoryManager::AllocationTag::Bodies);
         mNbCollisionShapes--;
         return;
     }
@@ -166,7 +167,8 @@ void CollisionBody::removeCollisionShape(const ProxyShape* proxyShape) {
             }
 
             elementToRemove->~ProxyShape();
-            mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, elementToRemove, sizeof(ProxyShape));
+            mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, elementToRemove, sizeof(ProxyShape),
+                                          MemoryManager::AllocationTag::Bodies);
             mNbCollisionShapes--;
             return;
         }
@@ -192,7 +194,8 @@ void CollisionBody::removeAllCollisionShapes() {
         }
 
         current->~ProxyShape();
-        mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, current, sizeof(ProxyShape));
+        mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, current, sizeof(ProxyShape),
+                                      MemoryManager::AllocationTag::Bodies);
 
         // Get the next element in the list
         current = nextElement;
@@ -211,7 +214,8 @@ void CollisionBody::resetContactManifoldsList() {
 
         // Delete the current element
         currentElement->~ContactManifoldListElement();
-        mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, currentElement, sizeof(ContactManifoldListElement));
+        mWorld.mMemoryManager.release(MemoryManager::AllocationType::Pool, currentElement, sizeof(ContactManifoldListElement),
+                                      MemoryManager::AllocationTag::ContactManifolds);
 
         currentElement = nextElement;
     }
@@ -289,6 +293,23 @@ void CollisionBody::setIsActive(bool isActive) {
              (mIsActive ? "true" : "false"));
 }
 
+// Set the variable to know whether or not the body is sleeping
+void CollisionBody::setIsSleeping(bool isSleeping) {
+
+    // The overlapping pairs of sleeping bodies are not active in the collision detection. When
+    // the body wakes up, its shapes are tested again in the broad-phase that reports its
+    // existing pairs so that they become active again (a static body never makes a pair active).
+    // Its inactive pairs that are not overlapping anymore are destroyed in the middle-phase.
+    if (mIsSleeping && !isSleeping && mType != BodyType::STATIC) {
+        askForBroadPhaseCollisionCheck();
+        for (ProxyShape* shape = mProxyCollisionShapes; shape != nullptr; shape = shape->mNext) {
+            mWorld.mCollisionDetection.askForInactivePairsCheck(shape);
+        }
+    }
+
+    Body::setIsSleeping(isSleeping);
+}
+
 // Ask the broad-phase to test again the collision shapes of the body for collision
 // (as if the body has moved).
 void CollisionBody::askForBroadPhaseCollisionCheck() const {
@@ -425,8 +446,28 @@ void CollisionBody::setTransform(const Transform& transform) {
  * @param type The type of the body (STATIC, KINEMATIC, DYNAMIC)
  */
 void CollisionBody::setType(BodyType type) {
+
+    const bool isStaticChanged = (mType == BodyType::STATIC) != (type == BodyType::STATIC);
+
     mType = type;
 
+    // The shapes of the static bodies are in a different tree of the broad-phase. Therefore,
+    // the proxy shapes are removed from the broad-phase and added again.
+    if (isStaticChanged && mIsActive) {
+
+        for (ProxyShape* shape = mProxyCollisionShapes; shape != nullptr; shape = shape->mNext) {
+
+            if (shape->getBroadPhaseId() != -1) {
+
+                mWorld.mCollisionDetection.removeProxyCollisionShape(shape);
+
+                AABB aabb;
+                shape->getCollisionShape()->computeAABB(aabb, mTransform * shape->mLocalToBodyTransform);
+                mWorld.mCollisionDetection.addProxyCollisionShape(shape, aabb);
+            }
+        }
+    }
+
     if (mType == BodyType::STATIC) {
 
         // Update the broad-phase state of the body
@@ -138,6 +138,9 @@ class CollisionBody : public Body {
         /// Set whether or not the body is active
         virtual void setIsActive(bool isActive) override;
 
+        /// Set the variable to know whether or not the body is sleeping
+        virtual void setIsSleeping(bool isSleeping) override;
+
         /// Return the current position and orientation
         const Transform& getTransform() const;
 
@@ -229,7 +229,7 @@ void RigidBody::removeJointFromJointsList(MemoryManager& memoryManager, const Jo
         mJointsList = elementToRemove->next;
         elementToRemove->~JointListElement();
         memoryManager.release(MemoryManager::AllocationType::Pool,
-                              elementToRemove, sizeof(JointListElement));
+                              elementToRemove, sizeof(JointListElement), MemoryManager::AllocationTag::Joints);
     }
     else {  // If the element to remove is not the first one in the list
         JointListElement* currentElement = mJointsList;
@@ -239,7 +239,7 @@ void RigidBody::removeJointFromJointsList(MemoryManager& memoryManager, const Jo
                 currentElement->next = elementToRemove->next;
                 elementToRemove->~JointListElement();
                 memoryManager.release(MemoryManager::AllocationType::Pool,
-                                      elementToRemove, sizeof(JointListElement));
+                                      elementToRemove, sizeof(JointListElement), MemoryManager::AllocationTag::Joints);
                 break;
             }
             currentElement = currentElement->next;
@@ -269,7 +269,7 @@ ProxyShape* RigidBody::addCollisionShape(CollisionShape* collisionShape,
 
     // Create a new proxy collision shape to attach the collision shape to the body
     ProxyShape* proxyShape = new (mWorld.mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                      sizeof(ProxyShape))) ProxyShape(this, collisionShape,
+                                      sizeof(ProxyShape), MemoryManager::AllocationTag::Bodies)) ProxyShape(this, collisionShape,
                                                                       transform, mass, mWorld.mMemoryManager);
 
 #ifdef IS_PROFILING_ACTIVE
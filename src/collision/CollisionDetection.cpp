@@ -49,10 +49,21 @@ using namespace std;
 
 
 // Constructor
-CollisionDetection::CollisionDetection(CollisionWorld* world, MemoryManager& memoryManager)
+CollisionDetection::CollisionDetection(CollisionWorld* world, MemoryManager& memoryManager, const WorldSettings& worldSettings)
                    : mMemoryManager(memoryManager), mWorld(world), mNarrowPhaseInfoList(nullptr),
-                     mOverlappingPairs(mMemoryManager.getPoolAllocator()), mBroadPhaseAlgorithm(*this),
-                     mNoCollisionPairs(mMemoryManager.getPoolAllocator()), mIsCollisionShapesAdded(false) {
+                     mOverlappingPairs(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::OverlappingPairs),
+                                       worldSettings.nbReservedOverlappingPairs, true),
+                     mActiveOverlappingPairs(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::OverlappingPairs),
+                                             worldSettings.nbReservedOverlappingPairs),
+                     mShapesWithInactivePairsToTest(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::OverlappingPairs)),
+                     mBroadPhaseAlgorithm(*this, worldSettings),
+                     mNoCollisionPairs(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::OverlappingPairs), 0, true), mIsCollisionShapesAdded(false),
+                     mNbCreatedPairs(0), mNbDestroyedPairs(0) {
+
+    // By default, the shapes of all the collision layers can collide with each other
+    for (uint i=0; i < NB_COLLISION_LAYERS; i++) {
+        mCollisionLayersMatrix[i] = ~uint64(0);
+    }
 
     // Set the default collision dispatch configuration
     setCollisionDispatch(&mDefaultCollisionDispatch);
@@ -91,6 +102,9 @@ void CollisionDetection::computeBroadPhase() {
 
     RP3D_PROFILE("CollisionDetection::computeBroadPhase()", mProfiler);
 
+    mNbCreatedPairs = 0;
+    mNbDestroyedPairs = 0;
+
     // If new collision shapes have been added to bodies
     if (mIsCollisionShapesAdded) {
 
@@ -106,17 +120,15 @@ void CollisionDetection::computeMiddlePhase() {
 
     RP3D_PROFILE("CollisionDetection::computeMiddlePhase()", mProfiler);
 
-    // For each possible collision pair of bodies
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
-    for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ) {
+    // Test the inactive pairs of the shapes that have moved or woken up (the pairs that
+    // become active are processed below)
+    updateInactiveOverlappingPairs();
 
-        OverlappingPair* pair = it->second;
+    // For each active collision pair of bodies (the pairs whose bodies are all sleeping
+    // or static are not processed)
+    for (uint i=0; i < mActiveOverlappingPairs.size(); ) {
 
-        // Make all the contact manifolds and contact points of the pair obsolete
-        pair->makeContactsObsolete();
-
-        // Make all the last frame collision info obsolete
-        pair->makeLastFrameCollisionInfosObsolete();
+        OverlappingPair* pair = mActiveOverlappingPairs[i];
 
         ProxyShape* shape1 = pair->getShape1();
         ProxyShape* shape2 = pair->getShape2();
@@ -125,78 +137,74 @@ void CollisionDetection::computeMiddlePhase() {
         assert(shape2->getBroadPhaseId() != -1);
         assert(shape1->getBroadPhaseId() != shape2->getBroadPhaseId());
 
-        // Check if the two shapes are still overlapping. Otherwise, we destroy the
-        // overlapping pair
-        if (!mBroadPhaseAlgorithm.testOverlappingShapes(shape1, shape2)) {
+        // Check if the two shapes are still overlapping and if the collision filtering still
+        // allows collision between them (it might have changed since the pair has been
+        // created). Otherwise, we destroy the overlapping pair
+        if (!mBroadPhaseAlgorithm.testOverlappingShapes(shape1, shape2) || !canCollide(shape1, shape2)) {
 
-            // Destroy the overlapping pair
-            it->second->~OverlappingPair();
-
-            mWorld->mMemoryManager.release(MemoryManager::AllocationType::Pool, it->second, sizeof(OverlappingPair));
-            it = mOverlappingPairs.remove(it);
+            // Destroy the overlapping pair (the last active pair is moved at index i)
+            mOverlappingPairs.remove(OverlappingPair::computeID(shape1, shape2));
+            destroyOverlappingPair(pair);
+            mNbDestroyedPairs++;
             continue;
         }
-        else {
-            ++it;
-        }
 
-        // Check if the collision filtering allows collision between the two shapes
-        if (((shape1->getCollideWithMaskBits() & shape2->getCollisionCategoryBits()) != 0 &&
-             (shape1->getCollisionCategoryBits() & shape2->getCollideWithMaskBits()) != 0)) {
+        // If the two bodies are sleeping or static, the pair is not active anymore. It
+        // becomes active again when one of its bodies wakes up.
+        if (!hasActiveBody(pair)) {
+            deactivateOverlappingPair(pair);
+            continue;
+        }
 
-            CollisionBody* const body1 = shape1->getBody();
-            CollisionBody* const body2 = shape2->getBody();
+        i++;
 
-            // Check that at least one body is awake and not static
-            bool isBody1Active = !body1->isSleeping() && body1->getType() != BodyType::STATIC;
-            bool isBody2Active = !body2->isSleeping() && body2->getType() != BodyType::STATIC;
-            if (!isBody1Active && !isBody2Active) continue;
+        // Make all the contact manifolds and contact points of the pair obsolete
+        pair->makeContactsObsolete();
 
-            // Check if the bodies are in the set of bodies that cannot collide between each other
-            bodyindexpair bodiesIndex = OverlappingPair::computeBodiesIndexPair(body1, body2);
-            if (mNoCollisionPairs.contains(bodiesIndex) > 0) continue;
+        // Make all the last frame collision info obsolete
+        pair->makeLastFrameCollisionInfosObsolete();
 
 			bool isShape1Convex = shape1->getCollisionShape()->isConvex();
 			bool isShape2Convex = shape2->getCollisionShape()->isConvex();
 
-            // If both shapes are convex
-            if (isShape1Convex && isShape2Convex) {
+        // If both shapes are convex
+        if (isShape1Convex && isShape2Convex) {
 
-                // No middle-phase is necessary, simply create a narrow phase info
-                // for the narrow-phase collision detection
-                NarrowPhaseInfo* firstNarrowPhaseInfo = mNarrowPhaseInfoList;
-                mNarrowPhaseInfoList = new (mMemoryManager.allocate(MemoryManager::AllocationType::Frame, sizeof(NarrowPhaseInfo)))
-                                       NarrowPhaseInfo(pair, shape1->getCollisionShape(),
-                                       shape2->getCollisionShape(), shape1->getLocalToWorldTransform(),
-                                       shape2->getLocalToWorldTransform(), mMemoryManager.getSingleFrameAllocator());
-                mNarrowPhaseInfoList->next = firstNarrowPhaseInfo;
+            // No middle-phase is necessary, simply create a narrow phase info
+            // for the narrow-phase collision detection
+            NarrowPhaseInfo* firstNarrowPhaseInfo = mNarrowPhaseInfoList;
+            mNarrowPhaseInfoList = new (mMemoryManager.allocate(MemoryManager::AllocationType::Frame, sizeof(NarrowPhaseInfo),
+                                                                           MemoryManager::AllocationTag::NarrowPhase))
+                                   NarrowPhaseInfo(pair, shape1->getCollisionShape(),
+                                   shape2->getCollisionShape(), shape1->getLocalToWorldTransform(),
+                                   shape2->getLocalToWorldTransform(), mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase));
+            mNarrowPhaseInfoList->next = firstNarrowPhaseInfo;
 
-            }
-            // Concave vs Convex algorithm
-            else if ((!isShape1Convex && isShape2Convex) || (!isShape2Convex && isShape1Convex)) {
+        }
+        // Concave vs Convex algorithm
+        else if ((!isShape1Convex && isShape2Convex) || (!isShape2Convex && isShape1Convex)) {
 
-                NarrowPhaseInfo* narrowPhaseInfo = nullptr;
-                computeConvexVsConcaveMiddlePhase(pair, mMemoryManager.getSingleFrameAllocator(), &narrowPhaseInfo);
+            NarrowPhaseInfo* narrowPhaseInfo = nullptr;
+            computeConvexVsConcaveMiddlePhase(pair, mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase), &narrowPhaseInfo);
 
-                // Add all the narrow-phase info object reported by the callback into the
-                // list of all the narrow-phase info object
-                while (narrowPhaseInfo != nullptr) {
-                    NarrowPhaseInfo* next = narrowPhaseInfo->next;
-                    narrowPhaseInfo->next = mNarrowPhaseInfoList;
-                    mNarrowPhaseInfoList = narrowPhaseInfo;
+            // Add all the narrow-phase info object reported by the callback into the
+            // list of all the narrow-phase info object
+            while (narrowPhaseInfo != nullptr) {
+                NarrowPhaseInfo* next = narrowPhaseInfo->next;
+                narrowPhaseInfo->next = mNarrowPhaseInfoList;
+                mNarrowPhaseInfoList = narrowPhaseInfo;
 
-                    narrowPhaseInfo = next;
-                }
+                narrowPhaseInfo = next;
             }
-            // Concave vs Concave shape
-            else {
-                // Not handled
-                continue;
-            }
-
-            // Remove the obsolete last frame collision infos
-            pair->clearObsoleteLastFrameCollisionInfos();
         }
+        // Concave vs Concave shape
+        else {
+            // Not handled
+            continue;
+        }
+
+        // Remove the obsolete last frame collision infos
+        pair->clearObsoleteLastFrameCollisionInfos();
     }
 }
 
@@ -272,7 +280,7 @@ void CollisionDetection::computeNarrowPhase() {
             // Use the narrow-phase collision detection algorithm to check
             // if there really is a collision. If a collision occurs, the
             // notifyContact() callback method will be called.
-            if (narrowPhaseAlgorithm->testCollision(currentNarrowPhaseInfo, true, mMemoryManager.getSingleFrameAllocator())) {
+            if (narrowPhaseAlgorithm->testCollision(currentNarrowPhaseInfo, true, mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase))) {
 
                 // Add the contact points as a potential contact manifold into the pair                
                 currentNarrowPhaseInfo->addContactPointsAsPotentialContactManifold();
@@ -294,7 +302,8 @@ void CollisionDetection::computeNarrowPhase() {
         narrowPhaseInfoToDelete->~NarrowPhaseInfo();
 
         // Release the allocated memory for the narrow phase info
-        mMemoryManager.release(MemoryManager::AllocationType::Frame, narrowPhaseInfoToDelete, sizeof(NarrowPhaseInfo));
+        mMemoryManager.release(MemoryManager::AllocationType::Frame, narrowPhaseInfoToDelete, sizeof(NarrowPhaseInfo),
+                               MemoryManager::AllocationTag::NarrowPhase);
     }
 
     // Convert the potential contact into actual contacts
@@ -315,36 +324,78 @@ void CollisionDetection::broadPhaseNotifyOverlappingPair(ProxyShape* shape1, Pro
     assert(shape2->getBroadPhaseId() != -1);
     assert(shape1->getBroadPhaseId() != shape2->getBroadPhaseId());
 
-    // Check if the collision filtering allows collision between the two shapes
-    if ((shape1->getCollideWithMaskBits() & shape2->getCollisionCategoryBits()) == 0 ||
-        (shape1->getCollisionCategoryBits() & shape2->getCollideWithMaskBits()) == 0) return;
+    // Check if the collision filtering allows collision between the two shapes (the
+    // filtered pairs are never created)
+    if (!canCollide(shape1, shape2)) return;
 
     // Compute the overlapping pair ID
     Pair<uint, uint> pairID = OverlappingPair::computeID(shape1, shape2);
 
     // Check if the overlapping pair already exists
-    if (mOverlappingPairs.containsKey(pairID)) return;
+    FlatMap<Pair<uint, uint>, OverlappingPair*>::Iterator it = mOverlappingPairs.find(pairID);
+    if (it != mOverlappingPairs.end()) {
+
+        // The pair of a body that has woken up is reported again by the broad-phase
+        if (it->second->mActivePairIndex == -1 && hasActiveBody(it->second)) {
+            activateOverlappingPair(it->second);
+        }
+
+        return;
+    }
 
     // Create the overlapping pair and add it into the set of overlapping pairs
-    OverlappingPair* newPair = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool, sizeof(OverlappingPair)))
-                              OverlappingPair(shape1, shape2, mMemoryManager.getPoolAllocator(),
-                                              mMemoryManager.getSingleFrameAllocator(), mWorld->mConfig);
+    OverlappingPair* newPair = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool, sizeof(OverlappingPair),
+                                                            MemoryManager::AllocationTag::OverlappingPairs))
+                              OverlappingPair(shape1, shape2, mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::ContactManifolds),
+                                              mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::ContactManifolds),
+                                              mWorld->mConfig);
     assert(newPair != nullptr);
 
     mOverlappingPairs.add(Pair<Pair<uint, uint>, OverlappingPair*>(pairID, newPair));
+    activateOverlappingPair(newPair);
+    mNbCreatedPairs++;
 
     // Wake up the two bodies
     shape1->getBody()->setIsSleeping(false);
     shape2->getBody()->setIsSleeping(false);
 }
 
+// Set whether the shapes of two collision layers can collide with each other
+/// The existing overlapping pairs of two layers that cannot collide anymore are
+/// destroyed in the next middle-phase. When two layers can collide again, their
+/// shapes are tested again in the broad-phase to find their overlapping pairs.
+void CollisionDetection::setAreCollisionLayersColliding(uint8 layer1, uint8 layer2, bool isColliding) {
+
+    assert(layer1 < NB_COLLISION_LAYERS && layer2 < NB_COLLISION_LAYERS);
+
+    if (areCollisionLayersColliding(layer1, layer2) == isColliding) return;
+
+    if (isColliding) {
+        mCollisionLayersMatrix[layer1] |= uint64(1) << layer2;
+        mCollisionLayersMatrix[layer2] |= uint64(1) << layer1;
+
+        // Ask for a broad-phase check of the shapes of the two layers
+        for (uint i=0; i < mWorld->mBodies.size(); i++) {
+            for (ProxyShape* shape = mWorld->mBodies[i]->mProxyCollisionShapes; shape != nullptr; shape = shape->mNext) {
+                if (shape->getCollisionLayer() == layer1 || shape->getCollisionLayer() == layer2) {
+                    askForBroadPhaseCollisionCheck(shape);
+                }
+            }
+        }
+    }
+    else {
+        mCollisionLayersMatrix[layer1] &= ~(uint64(1) << layer2);
+        mCollisionLayersMatrix[layer2] &= ~(uint64(1) << layer1);
+    }
+}
+
 // Remove a body from the collision detection
 void CollisionDetection::removeProxyCollisionShape(ProxyShape* proxyShape) {
 
     assert(proxyShape->getBroadPhaseId() != -1);
 
     // Remove all the overlapping pairs involving this proxy shape
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
+    FlatMap<Pair<uint, uint>, OverlappingPair*>::Iterator it;
     for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ) {
         if (it->second->getShape1()->getBroadPhaseId() == proxyShape->getBroadPhaseId()||
             it->second->getShape2()->getBroadPhaseId() == proxyShape->getBroadPhaseId()) {
@@ -352,8 +403,7 @@ void CollisionDetection::removeProxyCollisionShape(ProxyShape* proxyShape) {
             // TODO : Remove all the contact manifold of the overlapping pair from the contact manifolds list of the two bodies involved
 
             // Destroy the overlapping pair
-            it->second->~OverlappingPair();
-            mWorld->mMemoryManager.release(MemoryManager::AllocationType::Pool, it->second, sizeof(OverlappingPair));
+            destroyOverlappingPair(it->second);
             it = mOverlappingPairs.remove(it);
         }
         else {
@@ -361,21 +411,102 @@ void CollisionDetection::removeProxyCollisionShape(ProxyShape* proxyShape) {
         }
     }
 
+    // The broad-phase id of the shape can be used again by a new shape
+    mShapesWithInactivePairsToTest.remove(proxyShape->getBroadPhaseId());
+
     // Remove the body from the broad-phase
     mBroadPhaseAlgorithm.removeProxyCollisionShape(proxyShape);
 }
 
+// Test the inactive overlapping pairs of the shapes that have moved or woken up
+/// The inactive pairs are not processed by the middle-phase. Therefore, the inactive pairs of
+/// those shapes that are not overlapping anymore (or cannot collide anymore) are destroyed
+/// here and the ones with an awake body become active again. All the overlapping pairs are
+/// visited but only in the frames where such a shape exists.
+void CollisionDetection::updateInactiveOverlappingPairs() {
+
+    if (mShapesWithInactivePairsToTest.size() == 0) return;
+
+    FlatMap<Pair<uint, uint>, OverlappingPair*>::Iterator it;
+    for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ) {
+
+        OverlappingPair* pair = it->second;
+        ProxyShape* shape1 = pair->getShape1();
+        ProxyShape* shape2 = pair->getShape2();
+
+        if (pair->mActivePairIndex == -1 && (mShapesWithInactivePairsToTest.contains(shape1->getBroadPhaseId()) ||
+                                             mShapesWithInactivePairsToTest.contains(shape2->getBroadPhaseId()))) {
+
+            if (!mBroadPhaseAlgorithm.testOverlappingShapes(shape1, shape2) || !canCollide(shape1, shape2)) {
+
+                // Destroy the overlapping pair
+                destroyOverlappingPair(pair);
+                it = mOverlappingPairs.remove(it);
+                mNbDestroyedPairs++;
+                continue;
+            }
+
+            if (hasActiveBody(pair)) {
+                activateOverlappingPair(pair);
+            }
+        }
+
+        ++it;
+    }
+
+    mShapesWithInactivePairsToTest.clear();
+}
+
+// Add an overlapping pair to the list of active pairs
+void CollisionDetection::activateOverlappingPair(OverlappingPair* pair) {
+
+    assert(pair->mActivePairIndex == -1);
+
+    pair->mActivePairIndex = static_cast<int>(mActiveOverlappingPairs.size());
+    mActiveOverlappingPairs.add(pair);
+}
+
+// Remove an overlapping pair from the list of active pairs
+/// The contact manifolds of the pair are removed because the contacts of the sleeping
+/// bodies are not kept. The last active pair is moved at the index of the removed pair.
+void CollisionDetection::deactivateOverlappingPair(OverlappingPair* pair) {
+
+    assert(pair->mActivePairIndex >= 0 && pair->mActivePairIndex < static_cast<int>(mActiveOverlappingPairs.size()));
+    assert(mActiveOverlappingPairs[pair->mActivePairIndex] == pair);
+
+    pair->makeContactsObsolete();
+    pair->clearObsoleteManifoldsAndContactPoints();
+
+    OverlappingPair* lastPair = mActiveOverlappingPairs[mActiveOverlappingPairs.size() - 1];
+    mActiveOverlappingPairs[pair->mActivePairIndex] = lastPair;
+    lastPair->mActivePairIndex = pair->mActivePairIndex;
+    mActiveOverlappingPairs.removeAt(mActiveOverlappingPairs.size() - 1);
+
+    pair->mActivePairIndex = -1;
+}
+
+// Destroy an overlapping pair (that must be removed from the map of pairs by the caller)
+void CollisionDetection::destroyOverlappingPair(OverlappingPair* pair) {
+
+    if (pair->mActivePairIndex != -1) {
+        deactivateOverlappingPair(pair);
+    }
+
+    pair->~OverlappingPair();
+    mWorld->mMemoryManager.release(MemoryManager::AllocationType::Pool, pair, sizeof(OverlappingPair),
+                                   MemoryManager::AllocationTag::OverlappingPairs);
+}
+
 void CollisionDetection::addAllContactManifoldsToBodies() {
 
     RP3D_PROFILE("CollisionDetection::addAllContactManifoldsToBodies()", mProfiler);
 
-    // For each overlapping pairs in contact during the narrow-phase
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
-    for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ++it) {
+    // For each active overlapping pair (the other pairs do not have contacts)
+    for (uint i=0; i < mActiveOverlappingPairs.size(); i++) {
 
         // Add all the contact manifolds of the pair into the list of contact manifolds
         // of the two bodies involved in the contact
-        addContactManifoldToBody(it->second);
+        addContactManifoldToBody(mActiveOverlappingPairs[i]);
     }
 }
 
@@ -412,7 +543,8 @@ void CollisionDetection::addContactManifoldToBody(OverlappingPair* pair) {
         // Add the contact manifold at the beginning of the linked
         // list of contact manifolds of the first body
         ContactManifoldListElement* listElement1 = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                                                sizeof(ContactManifoldListElement)))
+                                                                                sizeof(ContactManifoldListElement),
+                                                                                MemoryManager::AllocationTag::ContactManifolds))
                                                       ContactManifoldListElement(contactManifold,
                                                                          body1->mContactManifoldsList);
         body1->mContactManifoldsList = listElement1;
@@ -420,7 +552,8 @@ void CollisionDetection::addContactManifoldToBody(OverlappingPair* pair) {
         // Add the contact manifold at the beginning of the linked
         // list of the contact manifolds of the second body
         ContactManifoldListElement* listElement2 = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                                                sizeof(ContactManifoldListElement)))
+                                                                                sizeof(ContactManifoldListElement),
+                                                                                MemoryManager::AllocationTag::ContactManifolds))
                                                       ContactManifoldListElement(contactManifold,
                                                                          body2->mContactManifoldsList);
         body2->mContactManifoldsList = listElement2;
@@ -434,12 +567,11 @@ void CollisionDetection::processAllPotentialContacts() {
 
     RP3D_PROFILE("CollisionDetection::processAllPotentialContacts()", mProfiler);
 
-    // For each overlapping pairs in contact during the narrow-phase
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
-    for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ++it) {
+    // For each active overlapping pair
+    for (uint i=0; i < mActiveOverlappingPairs.size(); i++) {
 
         // Process the potential contacts of the overlapping pair
-        processPotentialContacts(it->second);
+        processPotentialContacts(mActiveOverlappingPairs[i]);
     }
 }
 
@@ -473,14 +605,13 @@ void CollisionDetection::reportAllContacts() {
 
     RP3D_PROFILE("CollisionDetection::reportAllContacts()", mProfiler);
 
-    // For each overlapping pairs in contact during the narrow-phase
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
-    for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ++it) {
+    // For each active overlapping pair (the other pairs do not have contacts)
+    for (uint i=0; i < mActiveOverlappingPairs.size(); i++) {
 
         // If there is a user callback
-        if (mWorld->mEventListener != nullptr && it->second->hasContacts()) {
+        if (mWorld->mEventListener != nullptr && mActiveOverlappingPairs[i]->hasContacts()) {
 
-            CollisionCallback::CollisionCallbackInfo collisionInfo(it->second, mMemoryManager);
+            CollisionCallback::CollisionCallbackInfo collisionInfo(mActiveOverlappingPairs[i], mMemoryManager);
 
             // Trigger a callback event to report the new contact to the user
              mWorld->mEventListener->newContact(collisionInfo);
@@ -489,7 +620,7 @@ void CollisionDetection::reportAllContacts() {
 }
 
 // Compute the middle-phase collision detection between two proxy shapes
-NarrowPhaseInfo* CollisionDetection::computeMiddlePhaseForProxyShapes(OverlappingPair* pair) {
+NarrowPhaseInfo* CollisionDetection::computeMiddlePhaseForProxyShapes(OverlappingPair* pair, MemoryAllocator& allocator) {
 
     ProxyShape* shape1 = pair->getShape1();
     ProxyShape* shape2 = pair->getShape2();
@@ -508,10 +639,9 @@ NarrowPhaseInfo* CollisionDetection::computeMiddlePhaseForProxyShapes(Overlappin
 
         // No middle-phase is necessary, simply create a narrow phase info
         // for the narrow-phase collision detection
-        narrowPhaseInfo = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                       sizeof(NarrowPhaseInfo))) NarrowPhaseInfo(pair, shape1->getCollisionShape(),
+        narrowPhaseInfo = new (allocator.allocate(sizeof(NarrowPhaseInfo))) NarrowPhaseInfo(pair, shape1->getCollisionShape(),
                                        shape2->getCollisionShape(), shape1->getLocalToWorldTransform(),
-                                       shape2->getLocalToWorldTransform(), mMemoryManager.getPoolAllocator());
+                                       shape2->getLocalToWorldTransform(), allocator);
 
     }
     // Concave vs Convex algorithm
@@ -519,7 +649,7 @@ NarrowPhaseInfo* CollisionDetection::computeMiddlePhaseForProxyShapes(Overlappin
 
         // Run the middle-phase collision detection algorithm to find the triangles of the concave
         // shape we need to use during the narrow-phase collision detection
-        computeConvexVsConcaveMiddlePhase(pair, mMemoryManager.getPoolAllocator(), &narrowPhaseInfo);
+        computeConvexVsConcaveMiddlePhase(pair, allocator, &narrowPhaseInfo);
     }
 
     pair->clearObsoleteLastFrameCollisionInfos();
@@ -527,12 +657,23 @@ NarrowPhaseInfo* CollisionDetection::computeMiddlePhaseForProxyShapes(Overlappin
     return narrowPhaseInfo;
 }
 
+// Return the allocator used for the temporary memory of the collision queries
+/// The single frame allocator is used if it can be rolled back at the end of the
+/// query (see SingleFrameAllocatorScope). Otherwise, the pool allocator is used.
+MemoryAllocator& CollisionDetection::getQueryAllocator() {
+
+    SingleFrameAllocator& frameAllocator = mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase);
+    if (frameAllocator.isRollbackSupported()) return frameAllocator;
+
+    return mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::NarrowPhase);
+}
+
 // Report all the bodies that overlap with the aabb in parameter
 void CollisionDetection::testAABBOverlap(const AABB& aabb, OverlapCallback* overlapCallback,
                                          unsigned short categoryMaskBits) {
     assert(overlapCallback != nullptr);
 
-    Set<bodyindex> reportedBodies(mMemoryManager.getPoolAllocator());
+    FlatSet<bodyindex> reportedBodies(mMemoryManager.getPoolAllocator());
 
     // Ask the broad-phase to get all the overlapping shapes
     LinkedList<int> overlappingNodes(mMemoryManager.getPoolAllocator());
@@ -570,6 +711,10 @@ void CollisionDetection::testAABBOverlap(const AABB& aabb, OverlapCallback* over
 // Return true if two bodies overlap
 bool CollisionDetection::testOverlap(CollisionBody* body1, CollisionBody* body2) {
 
+    // The memory allocated for the query with the single frame allocator is released at the end of the query
+    SingleFrameAllocatorScope frameAllocatorScope(mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase));
+    MemoryAllocator& queryAllocator = getQueryAllocator();
+
     // For each proxy shape proxy shape of the first body
     ProxyShape* body1ProxyShape = body1->getProxyShapesList();
     while (body1ProxyShape != nullptr) {
@@ -586,11 +731,11 @@ bool CollisionDetection::testOverlap(CollisionBody* body1, CollisionBody* body2)
             if (aabb1.testCollision(aabb2)) {
 
                 // Create a temporary overlapping pair
-                OverlappingPair pair(body1ProxyShape, body2ProxyShape, mMemoryManager.getPoolAllocator(),
-                                     mMemoryManager.getPoolAllocator(), mWorld->mConfig);
+                OverlappingPair pair(body1ProxyShape, body2ProxyShape, queryAllocator,
+                                     queryAllocator, mWorld->mConfig);
 
                 // Compute the middle-phase collision detection between the two shapes
-                NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair);
+                NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair, queryAllocator);
 
                 bool isColliding = false;
 
@@ -612,7 +757,7 @@ bool CollisionDetection::testOverlap(CollisionBody* body1, CollisionBody* body2)
                             // Use the narrow-phase collision detection algorithm to check
                             // if there really is a collision. If a collision occurs, the
                             // notifyContact() callback method will be called.
-                            isColliding |= narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, false, mMemoryManager.getPoolAllocator());
+                            isColliding |= narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, false, queryAllocator);
                         }
                     }
 
@@ -623,7 +768,7 @@ bool CollisionDetection::testOverlap(CollisionBody* body1, CollisionBody* body2)
                     currentNarrowPhaseInfo->~NarrowPhaseInfo();
 
                     // Release the allocated memory
-                    mMemoryManager.release(MemoryManager::AllocationType::Pool, currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
+                    queryAllocator.release(currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
                 }
 
                 // Return if we have found a narrow-phase collision
@@ -648,7 +793,11 @@ void CollisionDetection::testOverlap(CollisionBody* body, OverlapCallback* overl
 
     assert(overlapCallback != nullptr);
 
-    Set<bodyindex> reportedBodies(mMemoryManager.getPoolAllocator());
+    // The memory allocated for the query with the single frame allocator is released at the end of the query
+    SingleFrameAllocatorScope frameAllocatorScope(mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase));
+    MemoryAllocator& queryAllocator = getQueryAllocator();
+
+    FlatSet<bodyindex> reportedBodies(mMemoryManager.getPoolAllocator());
 
     // For each proxy shape proxy shape of the body
     ProxyShape* bodyProxyShape = body->getProxyShapesList();
@@ -682,11 +831,11 @@ void CollisionDetection::testOverlap(CollisionBody* body, OverlapCallback* overl
                     if ((proxyShape->getCollisionCategoryBits() & categoryMaskBits) != 0) {
 
                         // Create a temporary overlapping pair
-                        OverlappingPair pair(bodyProxyShape, proxyShape, mMemoryManager.getPoolAllocator(),
-                                             mMemoryManager.getPoolAllocator(), mWorld->mConfig);
+                        OverlappingPair pair(bodyProxyShape, proxyShape, queryAllocator,
+                                             queryAllocator, mWorld->mConfig);
 
                         // Compute the middle-phase collision detection between the two shapes
-                        NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair);
+                        NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair, queryAllocator);
 
                         bool isColliding = false;
 
@@ -708,7 +857,7 @@ void CollisionDetection::testOverlap(CollisionBody* body, OverlapCallback* overl
                                     // Use the narrow-phase collision detection algorithm to check
                                     // if there really is a collision. If a collision occurs, the
                                     // notifyContact() callback method will be called.
-                                    isColliding |= narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, false, mMemoryManager.getPoolAllocator());
+                                    isColliding |= narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, false, queryAllocator);
                                 }
                             }
 
@@ -719,7 +868,7 @@ void CollisionDetection::testOverlap(CollisionBody* body, OverlapCallback* overl
                             currentNarrowPhaseInfo->~NarrowPhaseInfo();
 
                             // Release the allocated memory
-                            mMemoryManager.release(MemoryManager::AllocationType::Pool, currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
+                            queryAllocator.release(currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
                         }
 
                         // Return if we have found a narrow-phase collision
@@ -751,6 +900,10 @@ void CollisionDetection::testCollision(CollisionBody* body1, CollisionBody* body
 
     assert(collisionCallback != nullptr);
 
+    // The memory allocated for the query with the single frame allocator is released at the end of the query
+    SingleFrameAllocatorScope frameAllocatorScope(mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase));
+    MemoryAllocator& queryAllocator = getQueryAllocator();
+
     // For each proxy shape proxy shape of the first body
     ProxyShape* body1ProxyShape = body1->getProxyShapesList();
     while (body1ProxyShape != nullptr) {
@@ -767,11 +920,11 @@ void CollisionDetection::testCollision(CollisionBody* body1, CollisionBody* body
             if (aabb1.testCollision(aabb2)) {
 
                 // Create a temporary overlapping pair
-                OverlappingPair pair(body1ProxyShape, body2ProxyShape, mMemoryManager.getPoolAllocator(),
-                                     mMemoryManager.getPoolAllocator(), mWorld->mConfig);
+                OverlappingPair pair(body1ProxyShape, body2ProxyShape, queryAllocator,
+                                     queryAllocator, mWorld->mConfig);
 
                 // Compute the middle-phase collision detection between the two shapes
-                NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair);
+                NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair, queryAllocator);
 
                 // For each narrow-phase info object
                 while (narrowPhaseInfo != nullptr) {
@@ -788,7 +941,7 @@ void CollisionDetection::testCollision(CollisionBody* body1, CollisionBody* body
                         // Use the narrow-phase collision detection algorithm to check
                         // if there really is a collision. If a collision occurs, the
                         // notifyContact() callback method will be called.
-                        if (narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, true, mMemoryManager.getPoolAllocator())) {
+                        if (narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, true, queryAllocator)) {
 
                             // Add the contact points as a potential contact manifold into the pair
                             narrowPhaseInfo->addContactPointsAsPotentialContactManifold();
@@ -802,7 +955,7 @@ void CollisionDetection::testCollision(CollisionBody* body1, CollisionBody* body
                     currentNarrowPhaseInfo->~NarrowPhaseInfo();
 
                     // Release the allocated memory
-                    mMemoryManager.release(MemoryManager::AllocationType::Pool, currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
+                    queryAllocator.release(currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
                 }
 
                 // Process the potential contacts
@@ -830,6 +983,10 @@ void CollisionDetection::testCollision(CollisionBody* body, CollisionCallback* c
 
     assert(callback != nullptr);
 
+    // The memory allocated for the query with the single frame allocator is released at the end of the query
+    SingleFrameAllocatorScope frameAllocatorScope(mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase));
+    MemoryAllocator& queryAllocator = getQueryAllocator();
+
     // For each proxy shape proxy shape of the body
     ProxyShape* bodyProxyShape = body->getProxyShapesList();
     while (bodyProxyShape != nullptr) {
@@ -860,11 +1017,11 @@ void CollisionDetection::testCollision(CollisionBody* body, CollisionCallback* c
                     if ((proxyShape->getCollisionCategoryBits() & categoryMaskBits) != 0) {
 
                         // Create a temporary overlapping pair
-                        OverlappingPair pair(bodyProxyShape, proxyShape, mMemoryManager.getPoolAllocator(),
-                                             mMemoryManager.getPoolAllocator(), mWorld->mConfig);
+                        OverlappingPair pair(bodyProxyShape, proxyShape, queryAllocator,
+                                             queryAllocator, mWorld->mConfig);
 
                         // Compute the middle-phase collision detection between the two shapes
-                        NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair);
+                        NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair, queryAllocator);
 
                         // For each narrow-phase info object
                         while (narrowPhaseInfo != nullptr) {
@@ -881,7 +1038,7 @@ void CollisionDetection::testCollision(CollisionBody* body, CollisionCallback* c
                                 // Use the narrow-phase collision detection algorithm to check
                                 // if there really is a collision. If a collision occurs, the
                                 // notifyContact() callback method will be called.
-                                if (narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, true, mMemoryManager.getPoolAllocator())) {
+                                if (narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, true, queryAllocator)) {
 
                                     // Add the contact points as a potential contact manifold into the pair
                                     narrowPhaseInfo->addContactPointsAsPotentialContactManifold();
@@ -895,7 +1052,7 @@ void CollisionDetection::testCollision(CollisionBody* body, CollisionCallback* c
                             currentNarrowPhaseInfo->~NarrowPhaseInfo();
 
                             // Release the allocated memory
-                            mMemoryManager.release(MemoryManager::AllocationType::Pool, currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
+                            queryAllocator.release(currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
                         }
 
                         // Process the potential contacts
@@ -928,27 +1085,30 @@ void CollisionDetection::testCollision(CollisionCallback* callback) {
     // Compute the broad-phase collision detection
     computeBroadPhase();
 
+    MemoryAllocator& queryAllocator = getQueryAllocator();
+
     // For each possible collision pair of bodies
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
+    FlatMap<Pair<uint, uint>, OverlappingPair*>::Iterator it;
     for (it = mOverlappingPairs.begin(); it != mOverlappingPairs.end(); ++it) {
 
+        // The memory allocated for this pair with the single frame allocator is released at the end of the iteration
+        SingleFrameAllocatorScope frameAllocatorScope(mMemoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase));
+
         OverlappingPair* originalPair = it->second;
 
         // Create a new overlapping pair so that we do not work on the original one
-        OverlappingPair pair(originalPair->getShape1(), originalPair->getShape2(), mMemoryManager.getPoolAllocator(),
-                             mMemoryManager.getPoolAllocator(), mWorld->mConfig);
+        OverlappingPair pair(originalPair->getShape1(), originalPair->getShape2(), queryAllocator,
+                             queryAllocator, mWorld->mConfig);
 
         ProxyShape* shape1 = pair.getShape1();
         ProxyShape* shape2 = pair.getShape2();
 
         // Check if the collision filtering allows collision between the two shapes and
         // that the two shapes are still overlapping.
-        if (((shape1->getCollideWithMaskBits() & shape2->getCollisionCategoryBits()) != 0 &&
-             (shape1->getCollisionCategoryBits() & shape2->getCollideWithMaskBits()) != 0) &&
-             mBroadPhaseAlgorithm.testOverlappingShapes(shape1, shape2)) {
+        if (canCollide(shape1, shape2) && mBroadPhaseAlgorithm.testOverlappingShapes(shape1, shape2)) {
 
             // Compute the middle-phase collision detection between the two shapes
-            NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair);
+            NarrowPhaseInfo* narrowPhaseInfo = computeMiddlePhaseForProxyShapes(&pair, queryAllocator);
 
             // For each narrow-phase info object
             while (narrowPhaseInfo != nullptr) {
@@ -965,7 +1125,7 @@ void CollisionDetection::testCollision(CollisionCallback* callback) {
                     // Use the narrow-phase collision detection algorithm to check
                     // if there really is a collision. If a collision occurs, the
                     // notifyContact() callback method will be called.
-                    if (narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, true, mMemoryManager.getPoolAllocator())) {
+                    if (narrowPhaseAlgorithm->testCollision(narrowPhaseInfo, true, queryAllocator)) {
 
                         // Add the contact points as a potential contact manifold into the pair
                         narrowPhaseInfo->addContactPointsAsPotentialContactManifold();
@@ -979,7 +1139,7 @@ void CollisionDetection::testCollision(CollisionCallback* callback) {
                 currentNarrowPhaseInfo->~NarrowPhaseInfo();
 
                 // Release the allocated memory
-                mMemoryManager.release(MemoryManager::AllocationType::Pool, currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
+                queryAllocator.release(currentNarrowPhaseInfo, sizeof(NarrowPhaseInfo));
             }
 
             // Process the potential contacts
@@ -32,8 +32,8 @@
 #include "collision/shapes/CollisionShape.h"
 #include "engine/OverlappingPair.h"
 #include "collision/narrowphase/DefaultCollisionDispatch.h"
-#include "containers/Map.h"
-#include "containers/Set.h"
+#include "containers/FlatMap.h"
+#include "containers/FlatSet.h"
 
 /// ReactPhysics3D namespace
 namespace reactphysics3d {
@@ -79,18 +79,38 @@ class CollisionDetection {
         /// Pointer to the first narrow-phase info of the linked list
         NarrowPhaseInfo* mNarrowPhaseInfoList;
 
-        /// Broad-phase overlapping pairs
-        Map<Pair<uint, uint>, OverlappingPair*> mOverlappingPairs;
+        /// Broad-phase overlapping pairs (the map is rehashed incrementally when it grows)
+        FlatMap<Pair<uint, uint>, OverlappingPair*> mOverlappingPairs;
+
+        /// Active overlapping pairs (pairs with at least one awake and non-static body). Only
+        /// these pairs are processed in the middle-phase and the narrow-phase of each frame.
+        List<OverlappingPair*> mActiveOverlappingPairs;
+
+        /// Broad-phase ids of the shapes whose inactive overlapping pairs must be tested again
+        /// in the next middle-phase (shapes of sleeping or static bodies that have moved and
+        /// shapes of bodies that have woken up)
+        FlatSet<int> mShapesWithInactivePairsToTest;
 
         /// Broad-phase algorithm
         BroadPhaseAlgorithm mBroadPhaseAlgorithm;
 
-        /// Set of pair of bodies that cannot collide between each other
-        Set<bodyindexpair> mNoCollisionPairs;
+        /// Set of pair of bodies that cannot collide between each other (the set is rehashed
+        /// incrementally when it grows)
+        FlatSet<bodyindexpair> mNoCollisionPairs;
+
+        /// Collision layers matrix. The bit j of the mask of the layer i is set if
+        /// the shapes of the layers i and j can collide with each other.
+        uint64 mCollisionLayersMatrix[NB_COLLISION_LAYERS];
 
         /// True if some collision shapes have been added previously
         bool mIsCollisionShapesAdded;
 
+        /// Number of overlapping pairs created during the last step
+        uint mNbCreatedPairs;
+
+        /// Number of overlapping pairs destroyed in the middle-phase of the last step
+        uint mNbDestroyedPairs;
+
 #ifdef IS_PROFILING_ACTIVE
 
 		/// Pointer to the profiler
@@ -128,7 +148,10 @@ class CollisionDetection {
                                                NarrowPhaseInfo** firstNarrowPhaseInfo);
 
         /// Compute the middle-phase collision detection between two proxy shapes
-        NarrowPhaseInfo* computeMiddlePhaseForProxyShapes(OverlappingPair* pair);
+        NarrowPhaseInfo* computeMiddlePhaseForProxyShapes(OverlappingPair* pair, MemoryAllocator& allocator);
+
+        /// Return the allocator used for the temporary memory of the collision queries
+        MemoryAllocator& getQueryAllocator();
 
         /// Convert the potential contact into actual contacts
         void processAllPotentialContacts();
@@ -141,13 +164,28 @@ class CollisionDetection {
 
         /// Process the potential contacts where one collion is a concave shape
         void processSmoothMeshContacts(OverlappingPair* pair);
+
+        /// Return true if at least one body of an overlapping pair is awake and not static
+        static bool hasActiveBody(const OverlappingPair* pair);
+
+        /// Test the inactive overlapping pairs of the shapes that have moved or woken up
+        void updateInactiveOverlappingPairs();
+
+        /// Add an overlapping pair to the list of active pairs
+        void activateOverlappingPair(OverlappingPair* pair);
+
+        /// Remove an overlapping pair from the list of active pairs
+        void deactivateOverlappingPair(OverlappingPair* pair);
+
+        /// Destroy an overlapping pair (that must be removed from the map of pairs by the caller)
+        void destroyOverlappingPair(OverlappingPair* pair);
    
     public :
 
         // -------------------- Methods -------------------- //
 
         /// Constructor
-        CollisionDetection(CollisionWorld* world, MemoryManager& memoryManager);
+        CollisionDetection(CollisionWorld* world, MemoryManager& memoryManager, const WorldSettings& worldSettings);
 
         /// Destructor
         ~CollisionDetection() = default;
@@ -180,6 +218,21 @@ class CollisionDetection {
         /// Ask for a collision shape to be tested again during broad-phase.
         void askForBroadPhaseCollisionCheck(ProxyShape* shape);
 
+        /// Ask for the inactive overlapping pairs of a collision shape to be tested again in the middle-phase
+        void askForInactivePairsCheck(ProxyShape* shape);
+
+        /// Return true if the collision filtering allows collision between two shapes
+        bool canCollide(const ProxyShape* shape1, const ProxyShape* shape2) const;
+
+        /// Set whether the shapes of two collision layers can collide with each other
+        void setAreCollisionLayersColliding(uint8 layer1, uint8 layer2, bool isColliding);
+
+        /// Return true if the shapes of two collision layers can collide with each other
+        bool areCollisionLayersColliding(uint8 layer1, uint8 layer2) const;
+
+        /// Return the statistics of the broad-phase
+        BroadPhaseStatistics getBroadPhaseStatistics() const;
+
         /// Compute the collision detection
         void computeCollisionDetection();
 
@@ -269,6 +322,61 @@ inline void CollisionDetection::addNoCollisionPair(CollisionBody* body1,
 inline void CollisionDetection::removeNoCollisionPair(CollisionBody* body1,
                                                       CollisionBody* body2) {
     mNoCollisionPairs.remove(OverlappingPair::computeBodiesIndexPair(body1, body2));
+
+    // The pairs of the two bodies have been filtered out in the broad-phase and
+    // their shapes must be tested again to find them
+    body1->askForBroadPhaseCollisionCheck();
+    body2->askForBroadPhaseCollisionCheck();
+}
+
+// Return true if the collision filtering allows collision between two shapes
+/// The category bits, the collision layers and the pairs of bodies that cannot
+/// collide are tested in the broad-phase before an overlapping pair is created.
+inline bool CollisionDetection::canCollide(const ProxyShape* shape1, const ProxyShape* shape2) const {
+
+    // Check the collision category bits
+    if ((shape1->getCollideWithMaskBits() & shape2->getCollisionCategoryBits()) == 0 ||
+        (shape1->getCollisionCategoryBits() & shape2->getCollideWithMaskBits()) == 0) return false;
+
+    // Check the collision layers
+    if (!areCollisionLayersColliding(shape1->getCollisionLayer(), shape2->getCollisionLayer())) return false;
+
+    // Check if the bodies are in the set of bodies that cannot collide between each other
+    if (mNoCollisionPairs.size() > 0 &&
+        mNoCollisionPairs.contains(OverlappingPair::computeBodiesIndexPair(shape1->getBody(), shape2->getBody()))) {
+        return false;
+    }
+
+    return true;
+}
+
+// Return the statistics of the broad-phase
+/// The statistics of the trees are computed in a time proportional to their number of nodes
+inline BroadPhaseStatistics CollisionDetection::getBroadPhaseStatistics() const {
+
+    BroadPhaseStatistics statistics = mBroadPhaseAlgorithm.getStatistics();
+    statistics.nbCreatedPairs = mNbCreatedPairs;
+    statistics.nbDestroyedPairs = mNbDestroyedPairs;
+    statistics.nbOverlappingPairs = mOverlappingPairs.size();
+    statistics.nbActiveOverlappingPairs = mActiveOverlappingPairs.size();
+
+    return statistics;
+}
+
+// Return true if at least one body of an overlapping pair is awake and not static
+inline bool CollisionDetection::hasActiveBody(const OverlappingPair* pair) {
+
+    const CollisionBody* body1 = pair->getShape1()->getBody();
+    const CollisionBody* body2 = pair->getShape2()->getBody();
+
+    return (!body1->isSleeping() && body1->getType() != BodyType::STATIC) ||
+           (!body2->isSleeping() && body2->getType() != BodyType::STATIC);
+}
+
+// Return true if the shapes of two collision layers can collide with each other
+inline bool CollisionDetection::areCollisionLayersColliding(uint8 layer1, uint8 layer2) const {
+    assert(layer1 < NB_COLLISION_LAYERS && layer2 < NB_COLLISION_LAYERS);
+    return (mCollisionLayersMatrix[layer1] & (uint64(1) << layer2)) != 0;
 }
 
 // Ask for a collision shape to be tested again during broad-phase.
@@ -281,10 +389,28 @@ inline void CollisionDetection::askForBroadPhaseCollisionCheck(ProxyShape* shape
     }
 }
 
+// Ask for the inactive overlapping pairs of a collision shape to be tested again in the middle-phase
+/// The pairs that are not overlapping anymore are destroyed and the pairs with an awake
+/// body become active again.
+inline void CollisionDetection::askForInactivePairsCheck(ProxyShape* shape) {
+
+    if (shape->getBroadPhaseId() != -1) {
+        mShapesWithInactivePairsToTest.add(shape->getBroadPhaseId());
+    }
+}
+
 // Update a proxy collision shape (that has moved for instance)
 inline void CollisionDetection::updateProxyCollisionShape(ProxyShape* shape, const AABB& aabb,
                                                           const Vector3& displacement, bool forceReinsert) {
-    mBroadPhaseAlgorithm.updateProxyCollisionShape(shape, aabb, displacement);
+
+    const bool hasFatAABBChanged = mBroadPhaseAlgorithm.updateProxyCollisionShape(shape, aabb, displacement, forceReinsert);
+
+    // The pairs of a sleeping or static body are not active and are therefore not tested
+    // in the middle-phase. They must be tested again when the shape has moved.
+    const CollisionBody* body = shape->getBody();
+    if (hasFatAABBChanged && (body->isSleeping() || body->getType() == BodyType::STATIC)) {
+        askForInactivePairsCheck(shape);
+    }
 }
 
 // Return the corresponding narrow-phase algorithm
@@ -28,6 +28,7 @@
 
 // Libraries
 #include "mathematics/mathematics.h"
+#include "containers/SmallList.h"
 
 namespace reactphysics3d {
 
@@ -53,14 +54,20 @@ class HalfEdgeStructure {
 
         /// Face
         struct Face {
-            uint edgeIndex;             // Index of an half-edge of the face
-            List<uint> faceVertices;	// Index of the vertices of the face
+            uint edgeIndex;                     // Index of an half-edge of the face
+            SmallList<uint, 4> faceVertices;    // Index of the vertices of the face (up to four without allocation)
 
             /// Constructor
             Face(MemoryAllocator& allocator) : faceVertices(allocator) {}
 
             /// Constructor
-            Face(List<uint> vertices) : faceVertices(vertices) {}
+            Face(MemoryAllocator& allocator, const List<uint>& vertices)
+                : faceVertices(allocator, vertices.size()) {
+
+                for (uint i=0; i < vertices.size(); i++) {
+                    faceVertices.add(vertices[i]);
+                }
+            }
         };
 
         /// Vertex
@@ -103,7 +110,7 @@ class HalfEdgeStructure {
         uint addVertex(uint vertexPointIndex);
 
         /// Add a face
-        void addFace(List<uint> faceVertices);
+        void addFace(const List<uint>& faceVertices);
 
         /// Return the number of faces
         uint getNbFaces() const;
@@ -140,10 +147,10 @@ inline uint HalfEdgeStructure::addVertex(uint vertexPointIndex) {
  * @param faceVertices List of the vertices in a face (ordered in CCW order as seen from outside
  *                     the polyhedron
  */
-inline void HalfEdgeStructure::addFace(List<uint> faceVertices) {
+inline void HalfEdgeStructure::addFace(const List<uint>& faceVertices) {
 
     // Create a new face
-    Face face(faceVertices);
+    Face face(mAllocator, faceVertices);
     mFaces.add(face);
 }
 
@@ -40,7 +40,8 @@ using namespace reactphysics3d;
  */
 ProxyShape::ProxyShape(CollisionBody* body, CollisionShape* shape, const Transform& transform, decimal mass, MemoryManager& memoryManager)
            :mMemoryManager(memoryManager), mBody(body), mCollisionShape(shape), mLocalToBodyTransform(transform), mMass(mass),
-            mNext(nullptr), mBroadPhaseID(-1), mUserData(nullptr), mCollisionCategoryBits(0x0001), mCollideWithMaskBits(0xFFFF) {
+            mNext(nullptr), mBroadPhaseID(-1), mUserData(nullptr), mCollisionCategoryBits(0x0001), mCollideWithMaskBits(0xFFFF),
+            mCollisionLayer(0) {
 
 }
 
@@ -67,6 +68,10 @@ bool ProxyShape::testPointInside(const Vector3& worldPoint) {
 void ProxyShape::setCollisionCategoryBits(unsigned short collisionCategoryBits) {
     mCollisionCategoryBits = collisionCategoryBits;
 
+    // The overlapping pairs are filtered in the broad-phase. Therefore, the shape must be tested
+    // again in the broad-phase to find the pairs that were previously filtered out
+    mBody->askForBroadPhaseCollisionCheck();
+
     RP3D_LOG(mLogger, Logger::Level::Information, Logger::Category::ProxyShape,
              "ProxyShape " + std::to_string(mBroadPhaseID) + ": Set collisionCategoryBits=" +
              std::to_string(mCollisionCategoryBits));
@@ -79,11 +84,32 @@ void ProxyShape::setCollisionCategoryBits(unsigned short collisionCategoryBits)
 void ProxyShape::setCollideWithMaskBits(unsigned short collideWithMaskBits) {
     mCollideWithMaskBits = collideWithMaskBits;
 
+    // Test the shape again in the broad-phase to find the pairs that were previously filtered out
+    mBody->askForBroadPhaseCollisionCheck();
+
     RP3D_LOG(mLogger, Logger::Level::Information, Logger::Category::ProxyShape,
              "ProxyShape " + std::to_string(mBroadPhaseID) + ": Set collideWithMaskBits=" +
              std::to_string(mCollideWithMaskBits));
 }
 
+// Set the collision layer
+/**
+ * @param collisionLayer The collision layer of the proxy shape (in [0, NB_COLLISION_LAYERS - 1])
+ */
+void ProxyShape::setCollisionLayer(uint8 collisionLayer) {
+
+    assert(collisionLayer < NB_COLLISION_LAYERS);
+
+    mCollisionLayer = collisionLayer;
+
+    // Test the shape again in the broad-phase to find the pairs that were previously filtered out
+    mBody->askForBroadPhaseCollisionCheck();
+
+    RP3D_LOG(mLogger, Logger::Level::Information, Logger::Category::ProxyShape,
+             "ProxyShape " + std::to_string(mBroadPhaseID) + ": Set collisionLayer=" +
+             std::to_string(mCollisionLayer));
+}
+
 // Set the local to parent body transform
 void ProxyShape::setLocalToBodyTransform(const Transform& transform) {
 
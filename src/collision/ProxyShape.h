@@ -88,6 +88,11 @@ class ProxyShape {
         /// proxy shape will collide with every collision categories by default.
         unsigned short mCollideWithMaskBits;
 
+        /// Collision layer of the shape (in [0, NB_COLLISION_LAYERS - 1]). Two shapes can only
+        /// collide if their layers are colliding in the collision layers matrix of the world.
+        /// The layer is zero by default.
+        uint8 mCollisionLayer;
+
 #ifdef IS_PROFILING_ACTIVE
 
 		/// Pointer to the profiler
@@ -171,6 +176,12 @@ class ProxyShape {
         /// Set the collision category bits
         void setCollisionCategoryBits(unsigned short collisionCategoryBits);
 
+        /// Return the collision layer
+        uint8 getCollisionLayer() const;
+
+        /// Set the collision layer
+        void setCollisionLayer(uint8 collisionLayer);
+
         /// Return the next proxy shape in the linked list of proxy shapes
         ProxyShape* getNext();
 
@@ -318,6 +329,14 @@ inline unsigned short ProxyShape::getCollideWithMaskBits() const {
     return mCollideWithMaskBits;
 }
 
+// Return the collision layer
+/**
+ * @return The collision layer of the proxy shape
+ */
+inline uint8 ProxyShape::getCollisionLayer() const {
+    return mCollisionLayer;
+}
+
 // Return the broad-phase id
 inline int ProxyShape::getBroadPhaseId() const {
     return mBroadPhaseID;
@@ -25,7 +25,9 @@
 
 // Libraries
 #include "TriangleMesh.h"
+#include "TriangleVertexArray.h"
 #include "memory/MemoryManager.h"
+#include "mathematics/Vector3.h"
 
 using namespace reactphysics3d;
 
@@ -34,3 +36,35 @@ TriangleMesh::TriangleMesh()
              : mTriangleArrays(MemoryManager::getBaseAllocator()) {
 
 }
+
+// Compress all the sub-parts of the mesh relative to the AABB of the whole mesh
+/// Each sub-part is compressed with TriangleVertexArray::compress() using the AABB of the
+/// vertices of all the sub-parts as quantization bounds. Therefore, the vertices that are
+/// shared by several sub-parts are decoded at the same position in each of them and the
+/// mesh does not crack. The compression is lossy (see TriangleVertexArray::compress()) and
+/// the sub-parts that are already compressed are not modified.
+void TriangleMesh::compress() {
+
+    // Compute the AABB of the vertices of all the sub-parts
+    Vector3 minVertex(DECIMAL_LARGEST, DECIMAL_LARGEST, DECIMAL_LARGEST);
+    Vector3 maxVertex(-DECIMAL_LARGEST, -DECIMAL_LARGEST, -DECIMAL_LARGEST);
+    bool hasVertices = false;
+    for (uint i=0; i < mTriangleArrays.size(); i++) {
+        for (uint v=0; v < mTriangleArrays[i]->getNbVertices(); v++) {
+            Vector3 vertex;
+            mTriangleArrays[i]->getVertex(v, &vertex);
+            minVertex = Vector3::min(minVertex, vertex);
+            maxVertex = Vector3::max(maxVertex, vertex);
+            hasVertices = true;
+        }
+    }
+
+    if (!hasVertices) {
+        minVertex.setToZero();
+        maxVertex.setToZero();
+    }
+
+    for (uint i=0; i < mTriangleArrays.size(); i++) {
+        mTriangleArrays[i]->compress(minVertex, maxVertex);
+    }
+}
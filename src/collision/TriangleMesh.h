@@ -67,6 +67,9 @@ class TriangleMesh {
 
         /// Return the number of subparts of the mesh
         uint getNbSubparts() const;
+
+        /// Compress all the sub-parts of the mesh relative to the AABB of the whole mesh
+        void compress();
 };
 
 // Add a subpart of the mesh
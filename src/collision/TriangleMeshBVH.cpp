@@ -0,0 +1,507 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "TriangleMeshBVH.h"
+#include "TriangleMesh.h"
+#include "TriangleVertexArray.h"
+#include "collision/broadphase/DynamicAABBTree.h"
+#include "containers/Stack.h"
+#include "containers/List.h"
+#include "memory/MemoryAllocator.h"
+#include "mathematics/mathematics_functions.h"
+#include <cstring>
+#include <cstdint>
+
+using namespace reactphysics3d;
+
+// Node of the dynamic AABB tree to copy into the BVH
+struct TriangleMeshBVHBuildEntry {
+
+    /// ID of the node in the dynamic AABB tree
+    int32 treeNodeId;
+
+    /// Index of the parent node in the BVH if the node is a right child (-1 otherwise)
+    int32 rightChildParentIndex;
+
+    /// Constructor
+    TriangleMeshBVHBuildEntry() = default;
+
+    /// Constructor
+    TriangleMeshBVHBuildEntry(int32 nodeId, int32 parentIndex)
+        : treeNodeId(nodeId), rightChildParentIndex(parentIndex) {
+
+    }
+};
+
+// Test the AABB of a node against a ray with the slab test
+/// The ray is given by its origin, the inverse of its direction and its maximum fraction.
+/// The method returns true if the ray hits the AABB and writes the entry fraction of the
+/// ray into the AABB into "outMinFraction".
+static inline bool testNodeRay(const TriangleMeshBVHNode& node, const float* origin, const float* invDirection,
+                               float maxFraction, float& outMinFraction) {
+
+    float tMin = 0.0f;
+    float tMax = maxFraction;
+    for (int i=0; i < 3; i++) {
+        const float t1 = (node.aabbMin[i] - origin[i]) * invDirection[i];
+        const float t2 = (node.aabbMax[i] - origin[i]) * invDirection[i];
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+    }
+
+    outMinFraction = tMin;
+
+    return tMin <= tMax;
+}
+
+// Constructor
+TriangleMeshBVH::TriangleMeshBVH(MemoryAllocator& allocator)
+                : mAllocator(allocator), mData(nullptr), mDataSize(0), mIsDataOwned(false),
+                  mSubpartsNbTriangles(nullptr), mNodes(nullptr) {
+
+}
+
+// Destructor
+TriangleMeshBVH::~TriangleMeshBVH() {
+    releaseData();
+}
+
+// Release the data of the BVH
+void TriangleMeshBVH::releaseData() {
+
+    if (mIsDataOwned) {
+        mAllocator.release(const_cast<void*>(mData), mDataSize);
+    }
+
+    mData = nullptr;
+    mDataSize = 0;
+    mIsDataOwned = false;
+    mSubpartsNbTriangles = nullptr;
+    mNodes = nullptr;
+}
+
+// Build (cook) the BVH with all the triangles of a mesh
+/// The tree is built with the surface area heuristic from the AABBs of the triangles
+/// without the scaling of the shapes. This is expensive for a large mesh and it should
+/// be done offline: the result can be saved with getSerializedData() and used later
+/// with load(). If the tree is deeper than MAX_TREE_DEPTH (which only happens with a
+/// degenerate distribution of the triangles), the BVH is not valid after this call.
+void TriangleMeshBVH::build(const TriangleMesh& triangleMesh) {
+
+    releaseData();
+
+    // Compute the AABBs of all the triangles of the mesh
+    uint nbTriangles = 0;
+    for (uint subPart=0; subPart < triangleMesh.getNbSubparts(); subPart++) {
+        nbTriangles += triangleMesh.getSubpart(subPart)->getNbTriangles();
+    }
+
+    List<AABB> trianglesAABBs(mAllocator, nbTriangles);
+    List<int32> trianglesSubParts(mAllocator, nbTriangles);
+    List<int32> trianglesIndices(mAllocator, nbTriangles);
+
+    for (uint subPart=0; subPart < triangleMesh.getNbSubparts(); subPart++) {
+
+        TriangleVertexArray* triangleVertexArray = triangleMesh.getSubpart(subPart);
+
+        for (uint triangleIndex=0; triangleIndex < triangleVertexArray->getNbTriangles(); triangleIndex++) {
+
+            Vector3 trianglePoints[3];
+            triangleVertexArray->getTriangleVertices(triangleIndex, trianglePoints);
+
+            trianglesAABBs.add(AABB::createAABBForTriangle(trianglePoints));
+            trianglesSubParts.add(subPart);
+            trianglesIndices.add(triangleIndex);
+        }
+    }
+
+    // Allocate the header, the number of triangles of the sub-parts and the nodes in a single block
+    const uint nbSubparts = triangleMesh.getNbSubparts();
+    const uint nbNodes = nbTriangles > 0 ? 2 * nbTriangles - 1 : 0;
+    mDataSize = sizeof(TriangleMeshBVHHeader) + nbSubparts * sizeof(uint32) + nbNodes * sizeof(TriangleMeshBVHNode);
+    void* data = mAllocator.allocate(mDataSize);
+    assert(data != nullptr);
+    std::memset(data, 0, mDataSize);
+    mData = data;
+    mIsDataOwned = true;
+
+    TriangleMeshBVHHeader* header = static_cast<TriangleMeshBVHHeader*>(data);
+    header->magic = MAGIC_NUMBER;
+    header->version = VERSION;
+    header->nbNodes = nbNodes;
+    header->nbTriangles = nbTriangles;
+    header->nbSubparts = nbSubparts;
+
+    uint32* subpartsNbTriangles = reinterpret_cast<uint32*>(header + 1);
+    for (uint subPart=0; subPart < nbSubparts; subPart++) {
+        subpartsNbTriangles[subPart] = triangleMesh.getSubpart(subPart)->getNbTriangles();
+    }
+    mSubpartsNbTriangles = subpartsNbTriangles;
+
+    TriangleMeshBVHNode* nodes = reinterpret_cast<TriangleMeshBVHNode*>(subpartsNbTriangles + nbSubparts);
+    mNodes = nodes;
+
+    if (nbTriangles == 0) return;
+
+    // Build the tree with the SAH builder of the dynamic AABB tree
+    DynamicAABBTree tree(mAllocator);
+    tree.buildTree(&(trianglesAABBs[0]), &(trianglesSubParts[0]), &(trianglesIndices[0]),
+                   static_cast<int>(nbTriangles));
+
+    // The height of the root node is the maximum depth of a leaf
+    if (tree.mNodes[tree.mRootNodeID].height > MAX_TREE_DEPTH) {
+        releaseData();
+        return;
+    }
+
+    // Copy the nodes of the tree in depth-first order such that the left child of
+    // a node is stored right after it
+    uint nbCopiedNodes = 0;
+    Stack<TriangleMeshBVHBuildEntry, 64> stack(mAllocator);
+    stack.push(TriangleMeshBVHBuildEntry(tree.mRootNodeID, -1));
+
+    while (stack.getNbElements() > 0) {
+
+        const TriangleMeshBVHBuildEntry entry = stack.pop();
+        const TreeNode& treeNode = tree.mNodes[entry.treeNodeId];
+
+        const int32 nodeIndex = static_cast<int32>(nbCopiedNodes);
+        nbCopiedNodes++;
+        assert(nbCopiedNodes <= nbNodes);
+
+        if (entry.rightChildParentIndex != -1) {
+            nodes[entry.rightChildParentIndex].data[1] = nodeIndex;
+        }
+
+        TriangleMeshBVHNode& node = nodes[nodeIndex];
+        for (int i=0; i < 3; i++) {
+            node.aabbMin[i] = roundDownToFloat(treeNode.aabb.getMin()[i]);
+            node.aabbMax[i] = roundUpToFloat(treeNode.aabb.getMax()[i]);
+        }
+
+        if (treeNode.isLeaf()) {
+            node.data[0] = treeNode.dataInt[0];
+            node.data[1] = treeNode.dataInt[1];
+        }
+        else {
+            node.data[0] = -1;
+            stack.push(TriangleMeshBVHBuildEntry(treeNode.children[1], nodeIndex));
+            stack.push(TriangleMeshBVHBuildEntry(treeNode.children[0], -1));
+        }
+    }
+
+    assert(nbCopiedNodes == nbNodes);
+    assert(areNodesValid());
+}
+
+// Use the serialized data of a BVH without copying it
+/// The data must have been created with getSerializedData() on a machine with the same
+/// byte order, it must be aligned on four bytes and it must remain valid and unchanged
+/// while the BVH is used (it can be a read-only memory-mapped file for instance). The
+/// header and the size of the data are checked and every node is checked in a linear pass
+/// such that the queries never read outside of the data and never visit a node twice. The method returns false (and the
+/// BVH is not valid) if the data cannot be used.
+bool TriangleMeshBVH::load(const void* data, size_t size) {
+
+    releaseData();
+
+    if (data == nullptr || size < sizeof(TriangleMeshBVHHeader) ||
+        reinterpret_cast<std::uintptr_t>(data) % alignof(TriangleMeshBVHHeader) != 0) {
+        return false;
+    }
+
+    const TriangleMeshBVHHeader* header = static_cast<const TriangleMeshBVHHeader*>(data);
+    if (header->magic != MAGIC_NUMBER || header->version != VERSION) {
+        return false;
+    }
+
+    const size_t nbRequiredNodes = header->nbTriangles > 0 ? 2 * static_cast<size_t>(header->nbTriangles) - 1 : 0;
+    if (header->nbNodes != nbRequiredNodes ||
+        size != sizeof(TriangleMeshBVHHeader) + static_cast<size_t>(header->nbSubparts) * sizeof(uint32) +
+                static_cast<size_t>(header->nbNodes) * sizeof(TriangleMeshBVHNode)) {
+        return false;
+    }
+
+    // The total number of triangles of the sub-parts must be the number of triangles of the mesh
+    const uint32* subpartsNbTriangles = reinterpret_cast<const uint32*>(header + 1);
+    size_t nbTriangles = 0;
+    for (uint32 subPart=0; subPart < header->nbSubparts; subPart++) {
+        nbTriangles += subpartsNbTriangles[subPart];
+    }
+    if (nbTriangles != header->nbTriangles) {
+        return false;
+    }
+
+    mData = data;
+    mDataSize = size;
+    mIsDataOwned = false;
+    mSubpartsNbTriangles = subpartsNbTriangles;
+    mNodes = reinterpret_cast<const TriangleMeshBVHNode*>(subpartsNbTriangles + header->nbSubparts);
+
+    if (!areNodesValid()) {
+        releaseData();
+        return false;
+    }
+
+    return true;
+}
+
+// Return true if the nodes form a valid tree that only references existing triangles
+/// The nodes are visited in order while keeping the stack of the right children that
+/// have not been visited yet. The left child of an internal node must be the next node,
+/// the node after a leaf must be the last right child pushed on the stack and no leaf can
+/// be deeper than MAX_TREE_DEPTH (such that the stacks of the queries cannot overflow). A
+/// leaf must reference an existing triangle of an existing sub-part of the mesh.
+bool TriangleMeshBVH::areNodesValid() const {
+
+    const int32 nbNodes = static_cast<int32>(getNbNodes());
+    const int32 nbSubparts = static_cast<int32>(getNbSubparts());
+
+    // Right children that have not been visited yet with their depth
+    int32 rightChildren[MAX_TREE_DEPTH];
+    int rightChildrenDepths[MAX_TREE_DEPTH];
+    int nbRightChildren = 0;
+
+    int depth = 0;
+
+    for (int32 i=0; i < nbNodes; i++) {
+
+        const TriangleMeshBVHNode& node = mNodes[i];
+
+        if (node.isLeaf()) {
+
+            if (node.data[0] >= nbSubparts || node.data[1] < 0 ||
+                static_cast<uint32>(node.data[1]) >= mSubpartsNbTriangles[node.data[0]]) {
+                return false;
+            }
+
+            // The next node must be the last right child that has not been visited yet
+            if (nbRightChildren == 0) {
+                if (i + 1 != nbNodes) return false;
+            }
+            else {
+                nbRightChildren--;
+                if (rightChildren[nbRightChildren] != i + 1) return false;
+                depth = rightChildrenDepths[nbRightChildren];
+            }
+        }
+        else {
+
+            // The left child is the next node and the right child comes after it
+            if (node.data[0] != -1 || i + 1 >= nbNodes || node.data[1] <= i + 1 || node.data[1] >= nbNodes) {
+                return false;
+            }
+
+            // The children of the node must not be deeper than the maximum depth (there is
+            // at most one right child on the stack for each depth smaller than the one of
+            // the children)
+            if (depth >= MAX_TREE_DEPTH) return false;
+            assert(nbRightChildren < MAX_TREE_DEPTH);
+
+            depth++;
+            rightChildren[nbRightChildren] = node.data[1];
+            rightChildrenDepths[nbRightChildren] = depth;
+            nbRightChildren++;
+        }
+    }
+
+    assert(nbRightChildren == 0);
+
+    return true;
+}
+
+// Return true if the BVH has been built for a mesh with the same sub-parts and triangles
+/// The number of sub-parts of the mesh and the number of triangles of each sub-part must
+/// be the ones of the mesh used to build the BVH. The vertices of the mesh are not compared.
+bool TriangleMeshBVH::isBuiltForMesh(const TriangleMesh& triangleMesh) const {
+
+    if (!isValid() || getNbSubparts() != triangleMesh.getNbSubparts()) {
+        return false;
+    }
+
+    for (uint subPart=0; subPart < getNbSubparts(); subPart++) {
+        if (mSubpartsNbTriangles[subPart] != triangleMesh.getSubpart(subPart)->getNbTriangles()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Return the AABB of all the triangles of the mesh (in the space of the mesh)
+AABB TriangleMeshBVH::getBounds() const {
+
+    if (getNbNodes() == 0) {
+        return AABB(Vector3::zero(), Vector3::zero());
+    }
+
+    const TriangleMeshBVHNode& root = mNodes[0];
+    return AABB(Vector3(root.aabbMin[0], root.aabbMin[1], root.aabbMin[2]),
+                Vector3(root.aabbMax[0], root.aabbMax[1], root.aabbMax[2]));
+}
+
+// Report all the leaves overlapping with the AABB given in parameter
+/// The reported node indices can be given to getNodeDataInt() to get the triangles. The
+/// BVH is not modified and no memory is allocated by this method (the stack of the nodes to
+/// visit is bounded by the maximum depth of the tree). Therefore, it can be called
+/// concurrently by several threads.
+void TriangleMeshBVH::reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback) const {
+
+    if (getNbNodes() == 0) return;
+
+    const float aabbMin[3] = {roundDownToFloat(aabb.getMin().x), roundDownToFloat(aabb.getMin().y), roundDownToFloat(aabb.getMin().z)};
+    const float aabbMax[3] = {roundUpToFloat(aabb.getMax().x), roundUpToFloat(aabb.getMax().y), roundUpToFloat(aabb.getMax().z)};
+
+    // Stack of the nodes to visit (there is at most one right child for each depth)
+    int stack[MAX_TREE_DEPTH];
+    int nbStackNodes = 0;
+    stack[nbStackNodes++] = 0;
+
+    // While there are still nodes to visit
+    while (nbStackNodes > 0) {
+
+        int nodeIndex = stack[--nbStackNodes];
+
+        while (true) {
+
+            const TriangleMeshBVHNode& node = mNodes[nodeIndex];
+
+            // If the AABB of the node does not overlap the AABB in parameter
+            if (aabbMin[0] > node.aabbMax[0] || aabbMax[0] < node.aabbMin[0] ||
+                aabbMin[1] > node.aabbMax[1] || aabbMax[1] < node.aabbMin[1] ||
+                aabbMin[2] > node.aabbMax[2] || aabbMax[2] < node.aabbMin[2]) {
+                break;
+            }
+
+            if (node.isLeaf()) {
+                callback.notifyOverlappingNode(nodeIndex);
+                break;
+            }
+
+            // Visit the left child now and the right child later
+            assert(nbStackNodes < MAX_TREE_DEPTH);
+            stack[nbStackNodes++] = node.data[1];
+            nodeIndex++;
+        }
+    }
+}
+
+// Ray casting method
+/// The ray must be in the space of the mesh. The children nodes hit by the ray are visited
+/// from the closest one to the farthest one such that the ray is clipped as early as possible
+/// by the hits reported by the callback. Each node is tested against the ray once, before it
+/// is pushed on the stack. Like reportAllShapesOverlappingWithAABB(), this method does not
+/// allocate any memory and can be called concurrently by several threads.
+void TriangleMeshBVH::raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const {
+
+    if (getNbNodes() == 0) return;
+
+    // Origin and inverse direction of the ray for the slab tests
+    float origin[3];
+    float invDirection[3];
+    computeFloatRaySlabData(ray.point1, ray.point2, origin, invDirection);
+
+    decimal maxFraction = ray.maxFraction;
+
+    // Stack of the nodes to visit with their entry fraction (there is at most one node for
+    // each depth and the two children of the last visited node)
+    int stack[MAX_TREE_DEPTH + 1];
+    float stackFractions[MAX_TREE_DEPTH + 1];
+    int nbStackNodes = 0;
+
+    float rootFraction;
+    if (!testNodeRay(mNodes[0], origin, invDirection, computeFloatRayMaxFraction(maxFraction), rootFraction)) return;
+    stack[nbStackNodes] = 0;
+    stackFractions[nbStackNodes] = rootFraction;
+    nbStackNodes++;
+
+    while (nbStackNodes > 0) {
+
+        nbStackNodes--;
+        const int nodeIndex = stack[nbStackNodes];
+        const TriangleMeshBVHNode& node = mNodes[nodeIndex];
+
+        // Skip the node if the ray has been clipped before its entry fraction since it has
+        // been tested (with a small margin for the rounding errors)
+        const float maxFractionWithMargin = computeFloatRayMaxFraction(maxFraction);
+        if (stackFractions[nbStackNodes] > maxFractionWithMargin) continue;
+
+        if (node.isLeaf()) {
+
+            // Call the callback that will raycast again the triangle
+            const Ray rayTemp(ray.point1, ray.point2, maxFraction);
+            decimal hitFraction = callback.raycastBroadPhaseShape(nodeIndex, rayTemp);
+
+            // If the user returned a hitFraction of zero, it means that
+            // the raycasting should stop here
+            if (hitFraction == decimal(0.0)) {
+                return;
+            }
+
+            // If the user returned a positive fraction, we update the maxFraction value
+            if (hitFraction > decimal(0.0) && hitFraction < maxFraction) {
+                maxFraction = hitFraction;
+            }
+
+            // If the user returned a negative fraction, we continue
+            // the raycasting as if the triangle did not exist
+
+            continue;
+        }
+
+        // Visit the child with the closest entry fraction first
+        const int leftChild = nodeIndex + 1;
+        const int rightChild = node.data[1];
+        float leftFraction;
+        float rightFraction;
+        const bool isLeftHit = testNodeRay(mNodes[leftChild], origin, invDirection, maxFractionWithMargin, leftFraction);
+        const bool isRightHit = testNodeRay(mNodes[rightChild], origin, invDirection, maxFractionWithMargin, rightFraction);
+
+        assert(nbStackNodes + 2 <= MAX_TREE_DEPTH + 1);
+        if (isLeftHit && isRightHit) {
+            if (leftFraction <= rightFraction) {
+                stack[nbStackNodes] = rightChild;
+                stackFractions[nbStackNodes++] = rightFraction;
+                stack[nbStackNodes] = leftChild;
+                stackFractions[nbStackNodes++] = leftFraction;
+            }
+            else {
+                stack[nbStackNodes] = leftChild;
+                stackFractions[nbStackNodes++] = leftFraction;
+                stack[nbStackNodes] = rightChild;
+                stackFractions[nbStackNodes++] = rightFraction;
+            }
+        }
+        else if (isLeftHit) {
+            stack[nbStackNodes] = leftChild;
+            stackFractions[nbStackNodes++] = leftFraction;
+        }
+        else if (isRightHit) {
+            stack[nbStackNodes] = rightChild;
+            stackFractions[nbStackNodes++] = rightFraction;
+        }
+    }
+}
@@ -0,0 +1,272 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_TRIANGLE_MESH_BVH_H
+#define REACTPHYSICS3D_TRIANGLE_MESH_BVH_H
+
+// Libraries
+#include "configuration.h"
+#include "collision/shapes/AABB.h"
+#include <cstddef>
+
+/// Namespace ReactPhysics3D
+namespace reactphysics3d {
+
+// Declarations
+class TriangleMesh;
+class DynamicAABBTreeOverlapCallback;
+class DynamicAABBTreeRaycastCallback;
+class MemoryAllocator;
+
+// Structure TriangleMeshBVHNode
+/**
+ * This structure represents a node of a cooked triangle mesh BVH. The nodes are stored
+ * in depth-first order such that the left child of an internal node is the node that
+ * follows it. A node uses 32 bytes and has the same layout in memory and in the
+ * serialized data of the BVH.
+ */
+struct TriangleMeshBVHNode {
+
+    // -------------------- Attributes -------------------- //
+
+    /// Minimum coordinates of the AABB of the node
+    float aabbMin[3];
+
+    /// Maximum coordinates of the AABB of the node
+    float aabbMax[3];
+
+    /// For a leaf, the mesh sub-part and the index of the triangle in this sub-part. For
+    /// an internal node, -1 and the index of the right child node.
+    int32 data[2];
+
+    // -------------------- Methods -------------------- //
+
+    /// Return true if the node is a leaf of the tree
+    bool isLeaf() const;
+};
+
+// Structure TriangleMeshBVHHeader
+/**
+ * This structure is the header at the beginning of the serialized data of a cooked
+ * triangle mesh BVH. It is followed by the number of triangles of each sub-part of the
+ * mesh (one 32 bits integer per sub-part) and then by the nodes of the tree.
+ */
+struct TriangleMeshBVHHeader {
+
+    // -------------------- Attributes -------------------- //
+
+    /// Magic number to identify the data (also used to detect a different byte order)
+    uint32 magic;
+
+    /// Version of the format of the data
+    uint32 version;
+
+    /// Number of nodes of the tree
+    uint32 nbNodes;
+
+    /// Number of triangles of the mesh
+    uint32 nbTriangles;
+
+    /// Number of sub-parts of the mesh
+    uint32 nbSubparts;
+
+    /// Unused (the header has the size of a node)
+    uint32 padding[3];
+};
+
+// Class TriangleMeshBVH
+/**
+ * This class represents an immutable bounding volume hierarchy of the triangles of a
+ * triangle mesh that is cooked once and then used by one or several ConcaveMeshShape.
+ * The tree is built in the space of the mesh (without scaling) with the surface area
+ * heuristic and therefore, the shapes that use the same mesh with different scalings
+ * can share the same BVH. The whole BVH is a single block of compact data that can be
+ * saved into a file with getSerializedData() and getSerializedSize(). This data can be
+ * given back to the load() method (for instance from a read-only memory-mapped file)
+ * to use the BVH directly without building it again and without copying the data.
+ */
+class TriangleMeshBVH {
+
+    private:
+
+        // -------------------- Constants -------------------- //
+
+        /// Magic number at the beginning of the serialized data ("RP3B")
+        static const uint32 MAGIC_NUMBER = 0x42335052;
+
+        /// Version of the format of the serialized data
+        static const uint32 VERSION = 2;
+
+        /// Maximum depth of a leaf of the tree (the root node has depth zero). The queries
+        /// use a stack of this size on the call stack and do not allocate any memory.
+        static const int MAX_TREE_DEPTH = 64;
+
+        // -------------------- Attributes -------------------- //
+
+        /// Memory allocator
+        MemoryAllocator& mAllocator;
+
+        /// Data of the BVH (the header followed by the nodes)
+        const void* mData;
+
+        /// Size of the data in bytes
+        size_t mDataSize;
+
+        /// True if the data has been allocated by the BVH (false if the data has been loaded)
+        bool mIsDataOwned;
+
+        /// Number of triangles of each sub-part of the mesh of the BVH
+        const uint32* mSubpartsNbTriangles;
+
+        /// Nodes of the tree in depth-first order (the root node is the first one)
+        const TriangleMeshBVHNode* mNodes;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the header of the data
+        const TriangleMeshBVHHeader& getHeader() const;
+
+        /// Release the data of the BVH
+        void releaseData();
+
+        /// Return true if the nodes form a valid tree that only references existing triangles
+        bool areNodesValid() const;
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        TriangleMeshBVH(MemoryAllocator& allocator);
+
+        /// Destructor
+        ~TriangleMeshBVH();
+
+        /// Deleted copy-constructor
+        TriangleMeshBVH(const TriangleMeshBVH& bvh) = delete;
+
+        /// Deleted assignment operator
+        TriangleMeshBVH& operator=(const TriangleMeshBVH& bvh) = delete;
+
+        /// Build (cook) the BVH with all the triangles of a mesh
+        void build(const TriangleMesh& triangleMesh);
+
+        /// Use the serialized data of a BVH without copying it
+        bool load(const void* data, size_t size);
+
+        /// Return true if the BVH has been built or loaded
+        bool isValid() const;
+
+        /// Return a pointer to the serialized data of the BVH
+        const void* getSerializedData() const;
+
+        /// Return the size in bytes of the serialized data of the BVH
+        size_t getSerializedSize() const;
+
+        /// Return the number of nodes of the tree
+        uint getNbNodes() const;
+
+        /// Return the number of triangles of the mesh of the BVH
+        uint getNbTriangles() const;
+
+        /// Return the number of sub-parts of the mesh of the BVH
+        uint getNbSubparts() const;
+
+        /// Return the number of triangles of a sub-part of the mesh of the BVH
+        uint getNbSubpartTriangles(uint subPart) const;
+
+        /// Return true if the BVH has been built for a mesh with the same sub-parts and triangles
+        bool isBuiltForMesh(const TriangleMesh& triangleMesh) const;
+
+        /// Return the AABB of all the triangles of the mesh (in the space of the mesh)
+        AABB getBounds() const;
+
+        /// Return the mesh sub-part and the triangle index of a leaf node
+        const int32* getNodeDataInt(int nodeIndex) const;
+
+        /// Report all the leaves overlapping with the AABB given in parameter
+        void reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback) const;
+
+        /// Ray casting method
+        void raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const;
+};
+
+// Return true if the node is a leaf of the tree
+inline bool TriangleMeshBVHNode::isLeaf() const {
+    return data[0] >= 0;
+}
+
+// Return the header of the data
+inline const TriangleMeshBVHHeader& TriangleMeshBVH::getHeader() const {
+    assert(mData != nullptr);
+    return *static_cast<const TriangleMeshBVHHeader*>(mData);
+}
+
+// Return true if the BVH has been built or loaded
+inline bool TriangleMeshBVH::isValid() const {
+    return mData != nullptr;
+}
+
+// Return a pointer to the serialized data of the BVH
+inline const void* TriangleMeshBVH::getSerializedData() const {
+    return mData;
+}
+
+// Return the size in bytes of the serialized data of the BVH
+inline size_t TriangleMeshBVH::getSerializedSize() const {
+    return mDataSize;
+}
+
+// Return the number of nodes of the tree
+inline uint TriangleMeshBVH::getNbNodes() const {
+    return mData != nullptr ? getHeader().nbNodes : 0;
+}
+
+// Return the number of triangles of the mesh of the BVH
+inline uint TriangleMeshBVH::getNbTriangles() const {
+    return mData != nullptr ? getHeader().nbTriangles : 0;
+}
+
+// Return the number of sub-parts of the mesh of the BVH
+inline uint TriangleMeshBVH::getNbSubparts() const {
+    return mData != nullptr ? getHeader().nbSubparts : 0;
+}
+
+// Return the number of triangles of a sub-part of the mesh of the BVH
+inline uint TriangleMeshBVH::getNbSubpartTriangles(uint subPart) const {
+    assert(subPart < getNbSubparts());
+    return mSubpartsNbTriangles[subPart];
+}
+
+// Return the mesh sub-part and the triangle index of a leaf node
+inline const int32* TriangleMeshBVH::getNodeDataInt(int nodeIndex) const {
+    assert(nodeIndex >= 0 && static_cast<uint>(nodeIndex) < getNbNodes());
+    assert(mNodes[nodeIndex].isLeaf());
+    return mNodes[nodeIndex].data;
+}
+
+}
+
+#endif
@@ -27,6 +27,9 @@
 #include "TriangleVertexArray.h"
 #include "mathematics/Vector3.h"
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
 
 using namespace reactphysics3d;
 
@@ -63,6 +66,11 @@ TriangleVertexArray::TriangleVertexArray(uint nbVertices, const void* verticesSt
     mVertexNormaldDataType = NormalDataType::NORMAL_FLOAT_TYPE;
     mIndexDataType = indexDataType;
     mAreVerticesNormalsProvidedByUser = false;
+    mIsCompressed = false;
+    for (int i=0; i < 3; i++) {
+        mQuantizationOrigin[i] = decimal(0.0);
+        mQuantizationStep[i] = decimal(0.0);
+    }
 
     // Compute the vertices normals because they are not provided by the user
     computeVerticesNormals();
@@ -103,6 +111,11 @@ TriangleVertexArray::TriangleVertexArray(uint nbVertices, const void* verticesSt
     mVertexNormaldDataType = normalDataType;
     mIndexDataType = indexDataType;
     mAreVerticesNormalsProvidedByUser = true;
+    mIsCompressed = false;
+    for (int i=0; i < 3; i++) {
+        mQuantizationOrigin[i] = decimal(0.0);
+        mQuantizationStep[i] = decimal(0.0);
+    }
 
     assert(mVerticesNormalsStart != nullptr);
 }
@@ -110,8 +123,14 @@ TriangleVertexArray::TriangleVertexArray(uint nbVertices, const void* verticesSt
 // Destructor
 TriangleVertexArray::~TriangleVertexArray() {
 
+    // If the array has been compressed, release its compressed data
+    if (mIsCompressed) {
+        delete[] mVerticesStart;
+        delete[] mVerticesNormalsStart;
+        delete[] mIndicesStart;
+    }
     // If the vertices normals have not been provided by the user
-    if (!mAreVerticesNormalsProvidedByUser) {
+    else if (!mAreVerticesNormalsProvidedByUser) {
 
         // Release the allocated memory
         const void* verticesNormalPointer = static_cast<const void*>(mVerticesNormalsStart);
@@ -232,26 +251,7 @@ void TriangleVertexArray::getTriangleVertices(uint triangleIndex, Vector3* outTr
 
     // For each vertex of the triangle
     for (int k=0; k < 3; k++) {
-
-        const uchar* vertexPointerChar = mVerticesStart + verticesIndices[k] * mVerticesStride;
-        const void* vertexPointer = static_cast<const void*>(vertexPointerChar);
-
-        // Get the vertices components of the triangle
-        if (mVertexDataType == TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE) {
-            const float* vertices = static_cast<const float*>(vertexPointer);
-            outTriangleVertices[k][0] = decimal(vertices[0]);
-            outTriangleVertices[k][1] = decimal(vertices[1]);
-            outTriangleVertices[k][2] = decimal(vertices[2]);
-        }
-        else if (mVertexDataType == TriangleVertexArray::VertexDataType::VERTEX_DOUBLE_TYPE) {
-            const double* vertices = static_cast<const double*>(vertexPointer);
-            outTriangleVertices[k][0] = decimal(vertices[0]);
-            outTriangleVertices[k][1] = decimal(vertices[1]);
-            outTriangleVertices[k][2] = decimal(vertices[2]);
-        }
-        else {
-            assert(false);
-        }
+        decodeVertex(verticesIndices[k], outTriangleVertices[k]);
     }
 }
 
@@ -270,26 +270,7 @@ void TriangleVertexArray::getTriangleVerticesNormals(uint triangleIndex, Vector3
 
     // For each vertex of the triangle
     for (int k=0; k < 3; k++) {
-
-        const uchar* vertexNormalPointerChar = mVerticesNormalsStart + verticesIndices[k] * mVerticesNormalsStride;
-        const void* vertexNormalPointer = static_cast<const void*>(vertexNormalPointerChar);
-
-        // Get the normals from the array
-        if (mVertexNormaldDataType == TriangleVertexArray::NormalDataType::NORMAL_FLOAT_TYPE) {
-            const float* normal = static_cast<const float*>(vertexNormalPointer);
-            outTriangleVerticesNormals[k][0] = decimal(normal[0]);
-            outTriangleVerticesNormals[k][1] = decimal(normal[1]);
-            outTriangleVerticesNormals[k][2] = decimal(normal[2]);
-        }
-        else if (mVertexNormaldDataType == TriangleVertexArray::NormalDataType::NORMAL_DOUBLE_TYPE) {
-            const double* normal = static_cast<const double*>(vertexNormalPointer);
-            outTriangleVerticesNormals[k][0] = decimal(normal[0]);
-            outTriangleVerticesNormals[k][1] = decimal(normal[1]);
-            outTriangleVerticesNormals[k][2] = decimal(normal[2]);
-        }
-        else {
-            assert(false);
-        }
+        decodeNormal(verticesIndices[k], outTriangleVerticesNormals[k]);
     }
 }
 
@@ -302,53 +283,254 @@ void TriangleVertexArray::getVertex(uint vertexIndex, Vector3* outVertex) {
 
     assert(vertexIndex < mNbVertices);
 
+    decodeVertex(vertexIndex, *outVertex);
+}
+
+// Return a vertex normal of the array
+/**
+ * @param vertexIndex Index of a given vertex of the array
+ * @param[out] outNormal Pointer to the output vertex normal
+ */
+void TriangleVertexArray::getNormal(uint vertexIndex, Vector3* outNormal) {
+
+    assert(vertexIndex < mNbVertices);
+
+    decodeNormal(vertexIndex, *outNormal);
+}
+
+// Decode a vertex of the array
+void TriangleVertexArray::decodeVertex(uint vertexIndex, Vector3& outVertex) const {
+
     const uchar* vertexPointerChar = mVerticesStart + vertexIndex * mVerticesStride;
     const void* vertexPointer = static_cast<const void*>(vertexPointerChar);
 
-    // Get the vertices components of the triangle
+    // Get the vertex components
     if (mVertexDataType == TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE) {
-        const float* vertices = static_cast<const float*>(vertexPointer);
-        (*outVertex)[0] = decimal(vertices[0]);
-        (*outVertex)[1] = decimal(vertices[1]);
-        (*outVertex)[2] = decimal(vertices[2]);
+        const float* vertex = static_cast<const float*>(vertexPointer);
+        outVertex[0] = decimal(vertex[0]);
+        outVertex[1] = decimal(vertex[1]);
+        outVertex[2] = decimal(vertex[2]);
     }
     else if (mVertexDataType == TriangleVertexArray::VertexDataType::VERTEX_DOUBLE_TYPE) {
-        const double* vertices = static_cast<const double*>(vertexPointer);
-        (*outVertex)[0] = decimal(vertices[0]);
-        (*outVertex)[1] = decimal(vertices[1]);
-        (*outVertex)[2] = decimal(vertices[2]);
+        const double* vertex = static_cast<const double*>(vertexPointer);
+        outVertex[0] = decimal(vertex[0]);
+        outVertex[1] = decimal(vertex[1]);
+        outVertex[2] = decimal(vertex[2]);
+    }
+    else if (mVertexDataType == TriangleVertexArray::VertexDataType::VERTEX_QUANTIZED_SHORT_TYPE) {
+        const uint16* vertex = static_cast<const uint16*>(vertexPointer);
+        outVertex[0] = mQuantizationOrigin[0] + decimal(vertex[0]) * mQuantizationStep[0];
+        outVertex[1] = mQuantizationOrigin[1] + decimal(vertex[1]) * mQuantizationStep[1];
+        outVertex[2] = mQuantizationOrigin[2] + decimal(vertex[2]) * mQuantizationStep[2];
     }
     else {
         assert(false);
     }
 }
 
-// Return a vertex normal of the array
-/**
- * @param vertexIndex Index of a given vertex of the array
- * @param[out] outNormal Pointer to the output vertex normal
- */
-void TriangleVertexArray::getNormal(uint vertexIndex, Vector3* outNormal) {
-
-    assert(vertexIndex < mNbVertices);
+// Decode a vertex normal of the array
+void TriangleVertexArray::decodeNormal(uint vertexIndex, Vector3& outNormal) const {
 
     const uchar* vertexNormalPointerChar = mVerticesNormalsStart + vertexIndex * mVerticesNormalsStride;
     const void* vertexNormalPointer = static_cast<const void*>(vertexNormalPointerChar);
 
-    // Get the normals from the array
+    // Get the normal components
     if (mVertexNormaldDataType == TriangleVertexArray::NormalDataType::NORMAL_FLOAT_TYPE) {
         const float* normal = static_cast<const float*>(vertexNormalPointer);
-        (*outNormal)[0] = decimal(normal[0]);
-        (*outNormal)[1] = decimal(normal[1]);
-        (*outNormal)[2] = decimal(normal[2]);
+        outNormal[0] = decimal(normal[0]);
+        outNormal[1] = decimal(normal[1]);
+        outNormal[2] = decimal(normal[2]);
     }
     else if (mVertexNormaldDataType == TriangleVertexArray::NormalDataType::NORMAL_DOUBLE_TYPE) {
         const double* normal = static_cast<const double*>(vertexNormalPointer);
-        (*outNormal)[0] = decimal(normal[0]);
-        (*outNormal)[1] = decimal(normal[1]);
-        (*outNormal)[2] = decimal(normal[2]);
+        outNormal[0] = decimal(normal[0]);
+        outNormal[1] = decimal(normal[1]);
+        outNormal[2] = decimal(normal[2]);
+    }
+    else if (mVertexNormaldDataType == TriangleVertexArray::NormalDataType::NORMAL_OCTAHEDRAL_SHORT_TYPE) {
+
+        // Unfold the point of the octahedron and project it back onto the unit sphere
+        const int16* encodedNormal = static_cast<const int16*>(vertexNormalPointer);
+        decimal x = decimal(encodedNormal[0]) / decimal(INT16_MAX);
+        decimal y = decimal(encodedNormal[1]) / decimal(INT16_MAX);
+        const decimal z = decimal(1.0) - std::abs(x) - std::abs(y);
+        if (z < decimal(0.0)) {
+            const decimal foldedX = (decimal(1.0) - std::abs(y)) * (x >= decimal(0.0) ? decimal(1.0) : decimal(-1.0));
+            y = (decimal(1.0) - std::abs(x)) * (y >= decimal(0.0) ? decimal(1.0) : decimal(-1.0));
+            x = foldedX;
+        }
+        outNormal.setAllValues(x, y, z);
+        outNormal.normalize();
     }
     else {
         assert(false);
     }
 }
+
+// Replace the data of the array by a quantized copy of the data
+/// The vertices are quantized relative to the AABB of the vertices of the array (see the
+/// other compress() method). The vertices that are shared with another sub-part of the
+/// same mesh can therefore be decoded at a slightly different position in each sub-part
+/// and the sub-parts of a mesh should be compressed with TriangleMesh::compress() instead.
+void TriangleVertexArray::compress() {
+
+    if (mIsCompressed) return;
+
+    // Compute the AABB of the vertices
+    Vector3 minVertex(DECIMAL_LARGEST, DECIMAL_LARGEST, DECIMAL_LARGEST);
+    Vector3 maxVertex(-DECIMAL_LARGEST, -DECIMAL_LARGEST, -DECIMAL_LARGEST);
+    for (uint v=0; v < mNbVertices; v++) {
+        Vector3 vertex;
+        decodeVertex(v, vertex);
+        minVertex = Vector3::min(minVertex, vertex);
+        maxVertex = Vector3::max(maxVertex, vertex);
+    }
+
+    if (mNbVertices == 0) {
+        minVertex.setToZero();
+        maxVertex.setToZero();
+    }
+
+    compress(minVertex, maxVertex);
+}
+
+// Replace the data of the array by a copy of the data quantized in given bounds
+/// The vertices are quantized with 16 bits per coordinate relative to the given bounds
+/// (that must contain all the vertices of the array), the vertices normals are encoded
+/// with 16 bits per component using an octahedral mapping and the indices are stored
+/// with 16 bits if the array has at most 65536 vertices. The arrays compressed with the
+/// same bounds decode a given vertex at the same position. The data of the user (and
+/// the computed vertices normals) are not used anymore by the array after this call and
+/// can be released. The compression is lossy: the decoded vertices can move by half of
+/// the quantization step (see getQuantizationStep()) and the compression must therefore
+/// be done before the array is used to create a collision shape.
+/**
+ * @param minBounds Minimum coordinates of the bounds of the quantization
+ * @param maxBounds Maximum coordinates of the bounds of the quantization
+ */
+void TriangleVertexArray::compress(const Vector3& minBounds, const Vector3& maxBounds) {
+
+    if (mIsCompressed) return;
+
+    decimal quantizationOrigin[3];
+    decimal quantizationStep[3];
+    for (int i=0; i < 3; i++) {
+        assert(minBounds[i] <= maxBounds[i]);
+        quantizationOrigin[i] = minBounds[i];
+        quantizationStep[i] = (maxBounds[i] - minBounds[i]) / decimal(UINT16_MAX);
+    }
+
+    // Quantize the vertices
+    uchar* verticesData = new uchar[mNbVertices * 3 * sizeof(uint16)];
+    uint16* vertices = reinterpret_cast<uint16*>(verticesData);
+    for (uint v=0; v < mNbVertices; v++) {
+        Vector3 vertex;
+        decodeVertex(v, vertex);
+        for (int i=0; i < 3; i++) {
+            const decimal quantizedValue = quantizationStep[i] > decimal(0.0) ?
+                        std::round((vertex[i] - quantizationOrigin[i]) / quantizationStep[i]) : decimal(0.0);
+            vertices[v * 3 + i] = static_cast<uint16>(std::min(std::max(quantizedValue, decimal(0.0)), decimal(UINT16_MAX)));
+        }
+    }
+
+    // Encode the vertices normals on the octahedron folded into a square
+    uchar* normalsData = new uchar[mNbVertices * 2 * sizeof(int16)];
+    int16* normals = reinterpret_cast<int16*>(normalsData);
+    for (uint v=0; v < mNbVertices; v++) {
+        Vector3 normal;
+        decodeNormal(v, normal);
+        const decimal sumAbsComponents = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        decimal x = sumAbsComponents > decimal(0.0) ? normal.x / sumAbsComponents : decimal(0.0);
+        decimal y = sumAbsComponents > decimal(0.0) ? normal.y / sumAbsComponents : decimal(0.0);
+        if (normal.z < decimal(0.0)) {
+            const decimal foldedX = (decimal(1.0) - std::abs(y)) * (x >= decimal(0.0) ? decimal(1.0) : decimal(-1.0));
+            y = (decimal(1.0) - std::abs(x)) * (y >= decimal(0.0) ? decimal(1.0) : decimal(-1.0));
+            x = foldedX;
+        }
+        normals[v * 2] = static_cast<int16>(std::round(x * decimal(INT16_MAX)));
+        normals[v * 2 + 1] = static_cast<int16>(std::round(y * decimal(INT16_MAX)));
+    }
+
+    // Copy the indices with the smallest data type
+    const bool areIndicesShort = mNbVertices <= uint(UINT16_MAX) + 1;
+    const uint indexSize = areIndicesShort ? sizeof(ushort) : sizeof(uint);
+    uchar* indices = new uchar[mNbTriangles * 3 * indexSize];
+    for (uint t=0; t < mNbTriangles; t++) {
+        uint verticesIndices[3];
+        getTriangleVerticesIndices(t, verticesIndices);
+        for (int i=0; i < 3; i++) {
+            if (areIndicesShort) {
+                reinterpret_cast<ushort*>(indices)[t * 3 + i] = static_cast<ushort>(verticesIndices[i]);
+            }
+            else {
+                reinterpret_cast<uint*>(indices)[t * 3 + i] = verticesIndices[i];
+            }
+        }
+    }
+
+    // Release the computed vertices normals
+    if (!mAreVerticesNormalsProvidedByUser) {
+        const void* verticesNormalPointer = static_cast<const void*>(mVerticesNormalsStart);
+        delete[] static_cast<const float*>(verticesNormalPointer);
+    }
+
+    // Use the compressed data
+    mVerticesStart = verticesData;
+    mVerticesStride = 3 * sizeof(uint16);
+    mVertexDataType = VertexDataType::VERTEX_QUANTIZED_SHORT_TYPE;
+    mVerticesNormalsStart = normalsData;
+    mVerticesNormalsStride = 2 * sizeof(int16);
+    mVertexNormaldDataType = NormalDataType::NORMAL_OCTAHEDRAL_SHORT_TYPE;
+    mIndicesStart = indices;
+    mIndicesStride = 3 * indexSize;
+    mIndexDataType = areIndicesShort ? IndexDataType::INDEX_SHORT_TYPE : IndexDataType::INDEX_INTEGER_TYPE;
+    for (int i=0; i < 3; i++) {
+        mQuantizationOrigin[i] = quantizationOrigin[i];
+        mQuantizationStep[i] = quantizationStep[i];
+    }
+    mIsCompressed = true;
+}
+
+// Return the distance between two quantized values of the coordinates of a compressed array
+/**
+ * @return The quantization step along each axis (zero if the array is not compressed). The
+ *         decoded vertices are at most at half of this distance from the original vertices.
+ */
+Vector3 TriangleVertexArray::getQuantizationStep() const {
+    return Vector3(mQuantizationStep[0], mQuantizationStep[1], mQuantizationStep[2]);
+}
+
+// Return the coordinates of the quantized value zero of a compressed array
+/**
+ * @return The minimum coordinates of the bounds used to quantize the vertices (zero if
+ *         the array is not compressed)
+ */
+Vector3 TriangleVertexArray::getQuantizationOrigin() const {
+    return Vector3(mQuantizationOrigin[0], mQuantizationOrigin[1], mQuantizationOrigin[2]);
+}
+
+// Return the size in bytes of the vertices, normals and indices data of the array
+/**
+ * @return The number of bytes of the vertices coordinates, the vertices normals and the
+ *         indices of the triangles (without the padding of the strides)
+ */
+size_t TriangleVertexArray::getDataSize() const {
+
+    size_t vertexSize = 0;
+    switch (mVertexDataType) {
+        case VertexDataType::VERTEX_FLOAT_TYPE: vertexSize = 3 * sizeof(float); break;
+        case VertexDataType::VERTEX_DOUBLE_TYPE: vertexSize = 3 * sizeof(double); break;
+        case VertexDataType::VERTEX_QUANTIZED_SHORT_TYPE: vertexSize = 3 * sizeof(uint16); break;
+    }
+
+    size_t normalSize = 0;
+    switch (mVertexNormaldDataType) {
+        case NormalDataType::NORMAL_FLOAT_TYPE: normalSize = 3 * sizeof(float); break;
+        case NormalDataType::NORMAL_DOUBLE_TYPE: normalSize = 3 * sizeof(double); break;
+        case NormalDataType::NORMAL_OCTAHEDRAL_SHORT_TYPE: normalSize = 2 * sizeof(int16); break;
+    }
+
+    const size_t indexSize = mIndexDataType == IndexDataType::INDEX_INTEGER_TYPE ? sizeof(uint) : sizeof(ushort);
+
+    return mNbVertices * (vertexSize + normalSize) + static_cast<size_t>(mNbTriangles) * 3 * indexSize;
+}
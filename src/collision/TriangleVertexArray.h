@@ -28,6 +28,7 @@
 
 // Libraries
 #include "configuration.h"
+#include <cstddef>
 
 namespace reactphysics3d {
 
@@ -42,17 +43,23 @@ struct Vector3;
  * into the array. It only stores pointer to the data. The purpose is to allow
  * the user to share vertices data between the physics engine and the rendering
  * part. Therefore, make sure that the data pointed by a TriangleVertexArray
- * remains valid during the TriangleVertexArray life.
+ * remains valid during the TriangleVertexArray life. To save memory with large
+ * meshes, the array can also be compressed (see the compress() method). It then
+ * stores its own quantized copy of the data and does not use the data of the user
+ * anymore. The compression is lossy and the sub-parts of a mesh that share vertices
+ * should be compressed together with TriangleMesh::compress().
  */
 class TriangleVertexArray {
 
     public:
 
-        /// Data type for the vertices in the array
-        enum class VertexDataType {VERTEX_FLOAT_TYPE, VERTEX_DOUBLE_TYPE};
+        /// Data type for the vertices in the array (the quantized type is only
+        /// used by a compressed array)
+        enum class VertexDataType {VERTEX_FLOAT_TYPE, VERTEX_DOUBLE_TYPE, VERTEX_QUANTIZED_SHORT_TYPE};
 
-        /// Data type for the vertex normals in the array
-        enum class NormalDataType {NORMAL_FLOAT_TYPE, NORMAL_DOUBLE_TYPE};
+        /// Data type for the vertex normals in the array (the octahedral type is
+        /// only used by a compressed array)
+        enum class NormalDataType {NORMAL_FLOAT_TYPE, NORMAL_DOUBLE_TYPE, NORMAL_OCTAHEDRAL_SHORT_TYPE};
 
         /// Data type for the indices in the array
         enum class IndexDataType {INDEX_INTEGER_TYPE, INDEX_SHORT_TYPE};
@@ -99,11 +106,26 @@ class TriangleVertexArray {
         /// True if the vertices normals are provided by the user
         bool mAreVerticesNormalsProvidedByUser;
 
+        /// True if the array has been compressed
+        bool mIsCompressed;
+
+        /// Minimum coordinates of the vertices of a compressed array
+        decimal mQuantizationOrigin[3];
+
+        /// Distance between two quantized values of the coordinates of a compressed array
+        decimal mQuantizationStep[3];
+
         // -------------------- Methods -------------------- //
 
         /// Compute the vertices normals when they are not provided by the user
         void computeVerticesNormals();
 
+        /// Decode a vertex of the array
+        void decodeVertex(uint vertexIndex, Vector3& outVertex) const;
+
+        /// Decode a vertex normal of the array
+        void decodeNormal(uint vertexIndex, Vector3& outNormal) const;
+
     public:
 
         // -------------------- Methods -------------------- //
@@ -176,8 +198,34 @@ class TriangleVertexArray {
 
         /// Return a vertex normal of the array
         void getNormal(uint vertexIndex, Vector3* outNormal);
+
+        /// Replace the data of the array by a quantized copy of the data
+        void compress();
+
+        /// Replace the data of the array by a copy of the data quantized in given bounds
+        void compress(const Vector3& minBounds, const Vector3& maxBounds);
+
+        /// Return true if the array has been compressed
+        bool isCompressed() const;
+
+        /// Return the distance between two quantized values of the coordinates of a compressed array
+        Vector3 getQuantizationStep() const;
+
+        /// Return the coordinates of the quantized value zero of a compressed array
+        Vector3 getQuantizationOrigin() const;
+
+        /// Return the size in bytes of the vertices, normals and indices data of the array
+        size_t getDataSize() const;
 };
 
+// Return true if the array has been compressed
+/**
+ * @return True if the compress() method has been called
+ */
+inline bool TriangleVertexArray::isCompressed() const {
+    return mIsCompressed;
+}
+
 // Return the vertex data type
 /**
  * @return The data type of the vertices in the array
@@ -34,17 +34,45 @@
 using namespace reactphysics3d;
 
 // Constructor
-BroadPhaseAlgorithm::BroadPhaseAlgorithm(CollisionDetection& collisionDetection)
-                    :mDynamicAABBTree(collisionDetection.getMemoryManager().getPoolAllocator(), DYNAMIC_TREE_AABB_GAP),
-                     mMovedShapes(collisionDetection.getMemoryManager().getPoolAllocator()),
-                     mNbPotentialPairs(0), mNbAllocatedPotentialPairs(8),
-                     mCollisionDetection(collisionDetection) {
-
-    MemoryAllocator& poolAllocator = collisionDetection.getMemoryManager().getPoolAllocator();
+BroadPhaseAlgorithm::BroadPhaseAlgorithm(CollisionDetection& collisionDetection, const WorldSettings& worldSettings)
+                    :mBroadPhaseType(worldSettings.broadPhaseType),
+                     mDynamicAABBTree(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase), DYNAMIC_TREE_AABB_GAP),
+                     mStaticAABBTree(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase), DYNAMIC_TREE_AABB_GAP),
+                     mStaticWideAABBTree(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase)),
+                     mIsStaticWideTreeValid(false),
+                     mSweepAndPrune(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase), DYNAMIC_TREE_AABB_GAP),
+                     mMovedShapes(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase)),
+                     mMovedStaticShapes(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase)),
+                     mNbThreads(std::max(1u, std::min(worldSettings.nbBroadPhaseThreads, uint(MAX_NB_THREADS)))),
+                     mThreadPool(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase), mNbThreads - 1),
+                     mWorkerAllocators(nullptr),
+                     mTraversalTasks(collisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase)),
+                     mIsNodeMarked(nullptr), mTreeUpdateMethod(worldSettings.dynamicTreeUpdateMethod),
+                     mTreeRebuildCostRatio(worldSettings.dynamicTreeRebuildCostRatio),
+                     mNbFramesSinceTreeCostCheck(0), mNbReinsertedShapes(0), mCollisionDetection(collisionDetection) {
+
+    MemoryManager& memoryManager = collisionDetection.getMemoryManager();
+    MemoryAllocator& poolAllocator = memoryManager.getPoolAllocator(MemoryManager::AllocationTag::BroadPhase);
+
+    // Create the pool allocators of the worker threads. They allocate their memory with the
+    // base allocator of the world and their allocations are counted with the BroadPhase tag.
+    if (mNbThreads > 1) {
+        mWorkerAllocators = static_cast<MemoryManager::WorkerPoolAllocator*>(
+                    poolAllocator.allocate((mNbThreads - 1) * sizeof(MemoryManager::WorkerPoolAllocator)));
+        for (uint i=0; i < mNbThreads - 1; i++) {
+            new (mWorkerAllocators + i) MemoryManager::WorkerPoolAllocator(memoryManager, MemoryManager::AllocationTag::BroadPhase);
+        }
+    }
 
-    // Allocate memory for the array of potential overlapping pairs
-    mPotentialPairs = static_cast<BroadPhasePair*>(poolAllocator.allocate(mNbAllocatedPotentialPairs * sizeof(BroadPhasePair)));
-    assert(mPotentialPairs != nullptr);
+    // Create the arrays of overlapping pairs of the threads. The arrays of the worker
+    // threads use their worker pool allocator because they grow concurrently.
+    mThreadsOverlappingPairs = static_cast<List<BroadPhasePair>*>(poolAllocator.allocate(mNbThreads * sizeof(List<BroadPhasePair>)));
+    mThreadsStaticOverlappingPairs = static_cast<List<BroadPhasePair>*>(poolAllocator.allocate(mNbThreads * sizeof(List<BroadPhasePair>)));
+    for (uint i=0; i < mNbThreads; i++) {
+        MemoryAllocator& allocator = getThreadAllocator(i);
+        new (mThreadsOverlappingPairs + i) List<BroadPhasePair>(allocator);
+        new (mThreadsStaticOverlappingPairs + i) List<BroadPhasePair>(allocator);
+    }
 
 #ifdef IS_PROFILING_ACTIVE
 
@@ -58,10 +86,24 @@ BroadPhaseAlgorithm::BroadPhaseAlgorithm(CollisionDetection& collisionDetection)
 BroadPhaseAlgorithm::~BroadPhaseAlgorithm() {
 
     // Get the memory pool allocatory
-    MemoryAllocator& poolAllocator = mCollisionDetection.getMemoryManager().getPoolAllocator();
+    MemoryAllocator& poolAllocator = mCollisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase);
 
-    // Release the memory for the array of potential overlapping pairs
-    poolAllocator.release(mPotentialPairs, mNbAllocatedPotentialPairs * sizeof(BroadPhasePair));
+    // Release the memory for the arrays of overlapping pairs
+    for (uint i=0; i < mNbThreads; i++) {
+        mThreadsOverlappingPairs[i].~List<BroadPhasePair>();
+        mThreadsStaticOverlappingPairs[i].~List<BroadPhasePair>();
+    }
+    poolAllocator.release(mThreadsOverlappingPairs, mNbThreads * sizeof(List<BroadPhasePair>));
+    poolAllocator.release(mThreadsStaticOverlappingPairs, mNbThreads * sizeof(List<BroadPhasePair>));
+
+    // Release the pool allocators of the worker threads (their last releases are
+    // added into the statistics of the memory manager)
+    if (mNbThreads > 1) {
+        for (uint i=0; i < mNbThreads - 1; i++) {
+            mWorkerAllocators[i].~WorkerPoolAllocator();
+        }
+        poolAllocator.release(mWorkerAllocators, (mNbThreads - 1) * sizeof(MemoryManager::WorkerPoolAllocator));
+    }
 }
 
 // Return true if the two broad-phase collision shapes are overlapping
@@ -71,8 +113,8 @@ bool BroadPhaseAlgorithm::testOverlappingShapes(const ProxyShape* shape1,
     if (shape1->getBroadPhaseId() == -1 || shape2->getBroadPhaseId() == -1) return false;
 
     // Get the two AABBs of the collision shapes
-    const AABB& aabb1 = mDynamicAABBTree.getFatAABB(shape1->getBroadPhaseId());
-    const AABB& aabb2 = mDynamicAABBTree.getFatAABB(shape2->getBroadPhaseId());
+    const AABB& aabb1 = getFatAABB(shape1->getBroadPhaseId());
+    const AABB& aabb2 = getFatAABB(shape2->getBroadPhaseId());
 
     // Check if the two AABBs are overlapping
     return aabb1.testCollision(aabb2);
@@ -84,9 +126,29 @@ void BroadPhaseAlgorithm::raycast(const Ray& ray, RaycastTest& raycastTest,
 
     RP3D_PROFILE("BroadPhaseAlgorithm::raycast()", mProfiler);
 
-    BroadPhaseRaycastCallback broadPhaseRaycastCallback(mDynamicAABBTree, raycastWithCategoryMaskBits, raycastTest);
+    BroadPhaseRaycastCallback broadPhaseRaycastCallback(*this, raycastWithCategoryMaskBits, raycastTest);
 
-    mDynamicAABBTree.raycast(ray, broadPhaseRaycastCallback);
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        mSweepAndPrune.raycast(ray, broadPhaseRaycastCallback);
+    }
+    else {
+
+        mDynamicAABBTree.raycast(ray, broadPhaseRaycastCallback);
+
+        // Raycast against the static tree with the ray clipped by the hits in the dynamic tree
+        if (!broadPhaseRaycastCallback.isRaycastStopped()) {
+
+            const Ray clippedRay(ray.point1, ray.point2, std::min(ray.maxFraction, broadPhaseRaycastCallback.getSmallestHitFraction()));
+
+            broadPhaseRaycastCallback.setBroadPhaseIdFlag(STATIC_SHAPE_ID_FLAG);
+            if (mIsStaticWideTreeValid) {
+                mStaticWideAABBTree.raycast(clippedRay, broadPhaseRaycastCallback);
+            }
+            else {
+                mStaticAABBTree.raycast(clippedRay, broadPhaseRaycastCallback);
+            }
+        }
+    }
 }
 
 // Add a proxy collision shape into the broad-phase collision detection
@@ -94,8 +156,19 @@ void BroadPhaseAlgorithm::addProxyCollisionShape(ProxyShape* proxyShape, const A
 
     assert(proxyShape->getBroadPhaseId() == -1);
 
-    // Add the collision shape into the dynamic AABB tree and get its broad-phase ID
-    int nodeId = mDynamicAABBTree.addObject(aabb, proxyShape);
+    // Add the collision shape into the dynamic AABB tree (or the static tree or the
+    // sweep-and-prune structure) and get its broad-phase ID
+    int nodeId;
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        nodeId = mSweepAndPrune.addObject(aabb, proxyShape);
+    }
+    else if (proxyShape->getBody()->getType() == BodyType::STATIC) {
+        nodeId = mStaticAABBTree.addObject(aabb, proxyShape) | STATIC_SHAPE_ID_FLAG;
+        mIsStaticWideTreeValid = false;
+    }
+    else {
+        nodeId = mDynamicAABBTree.addObject(aabb, proxyShape);
+    }
 
     // Set the broad-phase ID of the proxy shape
     proxyShape->mBroadPhaseID = nodeId;
@@ -114,8 +187,17 @@ void BroadPhaseAlgorithm::removeProxyCollisionShape(ProxyShape* proxyShape) {
 
     proxyShape->mBroadPhaseID = -1;
 
-    // Remove the collision shape from the dynamic AABB tree
-    mDynamicAABBTree.removeObject(broadPhaseID);
+    // Remove the collision shape from the dynamic AABB tree (or the sweep-and-prune structure)
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        mSweepAndPrune.removeObject(broadPhaseID);
+    }
+    else if (isStaticShapeId(broadPhaseID)) {
+        mStaticAABBTree.removeObject(getTreeNodeId(broadPhaseID));
+        mIsStaticWideTreeValid = false;
+    }
+    else {
+        mDynamicAABBTree.removeObject(broadPhaseID);
+    }
 
     // Remove the collision shape into the array of shapes that have moved (or have been created)
     // during the last simulation step
@@ -123,7 +205,8 @@ void BroadPhaseAlgorithm::removeProxyCollisionShape(ProxyShape* proxyShape) {
 }
 
 // Notify the broad-phase that a collision shape has moved and need to be updated
-void BroadPhaseAlgorithm::updateProxyCollisionShape(ProxyShape* proxyShape, const AABB& aabb,
+/// This method returns true if the fat AABB of the collision shape has changed
+bool BroadPhaseAlgorithm::updateProxyCollisionShape(ProxyShape* proxyShape, const AABB& aabb,
                                                     const Vector3& displacement, bool forceReinsert) {
 
     int broadPhaseID = proxyShape->getBroadPhaseId();
@@ -131,16 +214,39 @@ void BroadPhaseAlgorithm::updateProxyCollisionShape(ProxyShape* proxyShape, cons
     assert(broadPhaseID >= 0);
 
     // Update the dynamic AABB tree according to the movement of the collision shape
-    bool hasBeenReInserted = mDynamicAABBTree.updateObject(broadPhaseID, aabb, displacement, forceReinsert);
+    bool hasBeenReInserted;
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        hasBeenReInserted = mSweepAndPrune.updateObject(broadPhaseID, aabb, displacement, forceReinsert);
+    }
+    else if (mTreeUpdateMethod == DynamicTreeUpdateMethod::REFIT) {
+        DynamicAABBTree& tree = isStaticShapeId(broadPhaseID) ? mStaticAABBTree : mDynamicAABBTree;
+        hasBeenReInserted = tree.refitObject(getTreeNodeId(broadPhaseID), aabb, displacement, forceReinsert);
+        if (hasBeenReInserted && isStaticShapeId(broadPhaseID)) {
+            mIsStaticWideTreeValid = false;
+        }
+    }
+    else if (isStaticShapeId(broadPhaseID)) {
+        hasBeenReInserted = mStaticAABBTree.updateObject(getTreeNodeId(broadPhaseID), aabb, displacement, forceReinsert);
+        if (hasBeenReInserted) {
+            mIsStaticWideTreeValid = false;
+        }
+    }
+    else {
+        hasBeenReInserted = mDynamicAABBTree.updateObject(broadPhaseID, aabb, displacement, forceReinsert);
+    }
 
     // If the collision shape has moved out of its fat AABB (and therefore has been reinserted
     // into the tree).
     if (hasBeenReInserted) {
 
+        mNbReinsertedShapes++;
+
         // Add the collision shape into the array of shapes that have moved (or have been created)
         // during the last simulation step
         addMovedCollisionShape(broadPhaseID);
     }
+
+    return hasBeenReInserted;
 }
 
 void BroadPhaseAlgorithm::reportAllShapesOverlappingWithAABB(const AABB& aabb,
@@ -148,144 +254,280 @@ void BroadPhaseAlgorithm::reportAllShapesOverlappingWithAABB(const AABB& aabb,
 
     AABBOverlapCallback callback(overlappingNodes);
 
-    // Ask the dynamic AABB tree to report all collision shapes that overlap with this AABB
-    mDynamicAABBTree.reportAllShapesOverlappingWithAABB(aabb, callback);
+    // Ask the dynamic AABB tree (or the sweep-and-prune structure) to report all collision
+    // shapes that overlap with this AABB
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        mSweepAndPrune.reportAllShapesOverlappingWithAABB(aabb, callback);
+    }
+    else {
+
+        mDynamicAABBTree.reportAllShapesOverlappingWithAABB(aabb, callback);
+
+        AABBOverlapCallback staticCallback(overlappingNodes, STATIC_SHAPE_ID_FLAG);
+        if (mIsStaticWideTreeValid) {
+            mStaticWideAABBTree.reportAllShapesOverlappingWithAABB(aabb, staticCallback);
+        }
+        else {
+            mStaticAABBTree.reportAllShapesOverlappingWithAABB(aabb, staticCallback);
+        }
+    }
 }
 
 // Compute all the overlapping pairs of collision shapes
 void BroadPhaseAlgorithm::computeOverlappingPairs(MemoryManager& memoryManager) {
 
-    // TODO : Try to see if we can allocate potential pairs in single frame allocator
+    // Start the statistics of a new step
+    mStatistics = BroadPhaseStatistics();
+    mStatistics.nbReinsertedShapes = mNbReinsertedShapes;
+    mNbReinsertedShapes = 0;
 
-    // Reset the potential overlapping pairs
-    mNbPotentialPairs = 0;
+    if (mBroadPhaseType == BroadPhaseType::DYNAMIC_AABB_TREE) {
 
-    LinkedList<int> overlappingNodes(memoryManager.getPoolAllocator());
+        // Refit the trees with the fat AABBs of the shapes that have moved
+        if (mTreeUpdateMethod == DynamicTreeUpdateMethod::REFIT) {
+            mDynamicAABBTree.refitTree();
+            mStaticAABBTree.refitTree();
+        }
 
-    // For all collision shapes that have moved (or have been created) during the
-    // last simulation step
-    for (auto it = mMovedShapes.begin(); it != mMovedShapes.end(); ++it) {
-        int shapeID = *it;
+        rebuildDegradedTrees();
+    }
+
+    mStatistics.nbMovedShapes = mMovedShapes.size() + mMovedStaticShapes.size();
+
+    if (mMovedShapes.size() == 0 && mMovedStaticShapes.size() == 0) return;
+
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+
+        // Sweep the sorted boxes to find the overlapping pairs with a moved shape
+        mThreadsOverlappingPairs[0].clear();
+        mThreadsStaticOverlappingPairs[0].clear();
+        OverlappingPairsCallback callback(mThreadsOverlappingPairs[0]);
+        mSweepAndPrune.reportOverlappingPairs(mMovedShapes, callback);
+
+        // Reset the array of collision shapes that have move (or have been created) during the
+        // last simulation step
+        mMovedShapes.clear();
+
+        // Report the overlapping pairs
+        notifyOverlappingPairs(1);
+    }
+    else {
+        computeTreeOverlappingPairs(memoryManager);
+    }
+}
+
+// Rebuild the trees whose SAH cost has grown too much since their last rebuild
+/// The SAH cost of the trees is only computed every few frames. The leaves keep their
+/// node IDs when a tree is rebuilt and therefore, the broad-phase IDs do not change.
+void BroadPhaseAlgorithm::rebuildDegradedTrees() {
+
+    // The refitted trees are always rebuilt when they have degraded too much
+    decimal maxCostRatio = mTreeRebuildCostRatio;
+    if (maxCostRatio <= decimal(0.0) && mTreeUpdateMethod == DynamicTreeUpdateMethod::REFIT) {
+        maxCostRatio = DYNAMIC_TREE_REFIT_REBUILD_COST_RATIO;
+    }
 
-        if (shapeID == -1) continue;
+    if (maxCostRatio <= decimal(0.0)) return;
 
-        AABBOverlapCallback callback(overlappingNodes);
+    mNbFramesSinceTreeCostCheck++;
+    if (mNbFramesSinceTreeCostCheck < NB_FRAMES_BETWEEN_TREE_COST_CHECKS) return;
+    mNbFramesSinceTreeCostCheck = 0;
 
-        // Get the AABB of the shape
-        const AABB& shapeAABB = mDynamicAABBTree.getFatAABB(shapeID);
+    RP3D_PROFILE("BroadPhaseAlgorithm::rebuildDegradedTrees()", mProfiler);
 
-        // Ask the dynamic AABB tree to report all collision shapes that overlap with
-        // this AABB. The method BroadPhase::notifiyOverlappingPair() will be called
-        // by the dynamic AABB tree for each potential overlapping pair.
-        mDynamicAABBTree.reportAllShapesOverlappingWithAABB(shapeAABB, callback);
+    if (mDynamicAABBTree.rebuildIfDegraded(maxCostRatio)) {
+        mStatistics.nbTreeRebuilds++;
+    }
+    if (mStaticAABBTree.rebuildIfDegraded(maxCostRatio)) {
+        mStatistics.nbTreeRebuilds++;
+        mIsStaticWideTreeValid = false;
+    }
+}
+
+// Compute the overlapping pairs of the moved shapes with the dynamic AABB tree
+/// The pairs of non-static shapes are found with a simultaneous traversal of the dynamic
+/// tree against itself. The static tree is then queried with each moved non-static shape
+/// and the dynamic tree is queried with each moved static shape.
+void BroadPhaseAlgorithm::computeTreeOverlappingPairs(MemoryManager& memoryManager) {
+
+    const uint nbMovedShapes = static_cast<uint>(mMovedShapes.size());
+
+    // Build the wide tree of the static shapes again if the static tree has changed
+    if (!mIsStaticWideTreeValid) {
+        mStaticWideAABBTree.build(mStaticAABBTree);
+        mIsStaticWideTreeValid = true;
+    }
+
+    SingleFrameAllocator& singleFrameAllocator = memoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::BroadPhase);
+    SingleFrameAllocatorScope frameAllocatorScope(singleFrameAllocator);
+
+    // Mark the nodes of the tree that have a moved shape (or a shape created) during
+    // the last simulation step in their subtree
+    const int nbNodes = mDynamicAABBTree.getNbAllocatedNodes();
+    mIsNodeMarked = static_cast<bool*>(singleFrameAllocator.allocate(nbNodes * sizeof(bool)));
+    std::fill(mIsNodeMarked, mIsNodeMarked + nbNodes, false);
+    for (uint i=0; i < nbMovedShapes; i++) {
+        const int shapeID = mMovedShapes[i];
+        mDynamicAABBTree.markLeafAndAncestors(shapeID, mIsNodeMarked);
+    }
+
+    // Number of threads used for the moved shapes of this frame
+    const uint nbThreads = std::max(1u, std::min(mNbThreads, nbMovedShapes / MIN_NB_MOVED_SHAPES_PER_THREAD));
+
+    // Split the traversal of the tree into independent tasks
+    mDynamicAABBTree.computeOverlappingPairsTasks(mIsNodeMarked, static_cast<int>(nbThreads * MIN_NB_TASKS_PER_THREAD),
+                                                  mTraversalTasks);
+
+    // Compute the overlapping pairs of each range of tasks concurrently with the
+    // worker threads of the pool (the first range is computed by this thread)
+    OverlappingPairsTask overlappingPairsTask(*this, nbThreads);
+    mThreadPool.run(overlappingPairsTask, nbThreads);
+
+    // Add the allocations of the worker threads into the statistics of the world
+    for (uint t=1; t < nbThreads; t++) {
+        mWorkerAllocators[t - 1].mergeStatistics();
+    }
+
+    // Find the overlapping pairs of the moved static shapes with the non-static shapes that
+    // have not moved (the pairs with a moved shape have already been found)
+    List<BroadPhasePair>& staticOverlappingPairs = mThreadsStaticOverlappingPairs[nbThreads - 1];
+    for (int i=0; i < mMovedStaticShapes.size(); i++) {
 
-        // Add the potential overlapping pairs
-        addOverlappingNodes(shapeID, overlappingNodes);
+        const int nodeId = mMovedStaticShapes[i];
 
-        // Remove all the elements of the linked list of overlapping nodes
-        overlappingNodes.reset();
+        StaticOverlappingPairsCallback callback(nodeId | STATIC_SHAPE_ID_FLAG, 0, mIsNodeMarked, staticOverlappingPairs);
+        mDynamicAABBTree.reportAllShapesOverlappingWithAABB(mStaticAABBTree.getFatAABB(nodeId), callback);
     }
 
-    // Reset the array of collision shapes that have move (or have been created) during the
+    // Reset the arrays of collision shapes that have move (or have been created) during the
     // last simulation step
     mMovedShapes.clear();
+    mMovedStaticShapes.clear();
 
-    // Sort the array of potential overlapping pairs in order to remove duplicate pairs
-    std::sort(mPotentialPairs, mPotentialPairs + mNbPotentialPairs, BroadPhasePair::smallerThan);
+    mIsNodeMarked = nullptr;
 
-    // Check all the potential overlapping pairs avoiding duplicates to report unique
-    // overlapping pairs
-    uint i=0;
-    while (i < mNbPotentialPairs) {
+    // Report the overlapping pairs
+    notifyOverlappingPairs(nbThreads);
+}
 
-        // Get a potential overlapping pair
-        BroadPhasePair* pair = mPotentialPairs + i;
-        i++;
+// Compute the overlapping pairs of a range of traversal tasks and of a range of moved shapes
+/// The traversal tasks and the moved shapes are split in nbThreads ranges of consecutive
+/// elements and this method computes the overlapping pairs of the ranges with index
+/// threadIndex. The pairs of the tasks are found in the dynamic tree and the pairs of the
+/// moved shapes with the static shapes are found in the static tree. The trees are only
+/// read and therefore, the ranges can be computed concurrently.
+void BroadPhaseAlgorithm::computeTasksOverlappingPairs(uint threadIndex, uint nbThreads) {
 
-        assert(pair->collisionShape1ID != pair->collisionShape2ID);
+    // Each thread uses its own allocator for the temporary memory of its traversals
+    MemoryAllocator& allocator = getThreadAllocator(threadIndex);
 
-        // Get the two collision shapes of the pair
-        ProxyShape* shape1 = static_cast<ProxyShape*>(mDynamicAABBTree.getNodeDataPointer(pair->collisionShape1ID));
-        ProxyShape* shape2 = static_cast<ProxyShape*>(mDynamicAABBTree.getNodeDataPointer(pair->collisionShape2ID));
+    List<BroadPhasePair>& overlappingPairs = mThreadsOverlappingPairs[threadIndex];
+    overlappingPairs.clear();
 
-        // If the two proxy collision shapes are from the same body, skip it
-        if (shape1->getBody()->getId() != shape2->getBody()->getId()) {
+    const uint nbTasks = static_cast<uint>(mTraversalTasks.size());
+    const uint startTaskIndex = static_cast<uint>(uint64(nbTasks) * threadIndex / nbThreads);
+    const uint endTaskIndex = static_cast<uint>(uint64(nbTasks) * (threadIndex + 1) / nbThreads);
 
-            // Notify the collision detection about the overlapping pair
-            mCollisionDetection.broadPhaseNotifyOverlappingPair(shape1, shape2);
-        }
+    OverlappingPairsCallback callback(overlappingPairs);
+
+    for (uint i=startTaskIndex; i < endTaskIndex; i++) {
+        mDynamicAABBTree.reportOverlappingPairs(mTraversalTasks[i], mIsNodeMarked, callback, allocator);
+    }
 
-        // Skip the duplicate overlapping pairs
-        while (i < mNbPotentialPairs) {
+    List<BroadPhasePair>& staticOverlappingPairs = mThreadsStaticOverlappingPairs[threadIndex];
+    staticOverlappingPairs.clear();
 
-            // Get the next pair
-            BroadPhasePair* nextPair = mPotentialPairs + i;
+    const uint nbMovedShapes = static_cast<uint>(mMovedShapes.size());
+    const uint startShapeIndex = static_cast<uint>(uint64(nbMovedShapes) * threadIndex / nbThreads);
+    const uint endShapeIndex = static_cast<uint>(uint64(nbMovedShapes) * (threadIndex + 1) / nbThreads);
 
-            // If the next pair is different from the previous one, we stop skipping pairs
-            if (nextPair->collisionShape1ID != pair->collisionShape1ID ||
-                nextPair->collisionShape2ID != pair->collisionShape2ID) {
-                break;
-            }
-            i++;
-        }
+    for (uint i=startShapeIndex; i < endShapeIndex; i++) {
+
+        const int shapeID = mMovedShapes[i];
+
+        StaticOverlappingPairsCallback staticCallback(shapeID, STATIC_SHAPE_ID_FLAG, nullptr, staticOverlappingPairs);
+        mStaticWideAABBTree.reportAllShapesOverlappingWithAABB(mDynamicAABBTree.getFatAABB(shapeID), staticCallback, allocator);
     }
+}
 
-    // If the number of potential overlapping pairs is less than the quarter of allocated
-    // number of overlapping pairs
-    if (mNbPotentialPairs < mNbAllocatedPotentialPairs / 4 && mNbPotentialPairs > 8) {
+// Return the memory allocator of a thread used to compute the overlapping pairs
+/// The first thread (the thread that updates the world) uses the pool allocator of the
+/// world and each worker thread uses its own worker pool allocator.
+MemoryAllocator& BroadPhaseAlgorithm::getThreadAllocator(uint threadIndex) {
 
-        MemoryAllocator& poolAllocator = mCollisionDetection.getMemoryManager().getPoolAllocator();
+    if (threadIndex == 0) {
+        return mCollisionDetection.getMemoryManager().getPoolAllocator(MemoryManager::AllocationTag::BroadPhase);
+    }
 
-        // Reduce the number of allocated potential overlapping pairs
-        BroadPhasePair* oldPairs = mPotentialPairs;
-        uint oldNbAllocatedPotentialPairs = mNbAllocatedPotentialPairs;
-        mNbAllocatedPotentialPairs /= 2;
-        mPotentialPairs = static_cast<BroadPhasePair*>(poolAllocator.allocate(mNbAllocatedPotentialPairs * sizeof(BroadPhasePair)));
-        assert(mPotentialPairs);
-        memcpy(mPotentialPairs, oldPairs, mNbPotentialPairs * sizeof(BroadPhasePair));
-        poolAllocator.release(oldPairs, oldNbAllocatedPotentialPairs * sizeof(BroadPhasePair));
+    return mWorkerAllocators[threadIndex - 1];
+}
+
+// Compute the overlapping pairs of the ranges of a given thread
+void OverlappingPairsTask::execute(uint taskIndex) {
+    mBroadPhaseAlgorithm.computeTasksOverlappingPairs(taskIndex, mNbThreads);
+}
+
+// Report the overlapping pairs found by the threads
+/// Each overlapping pair has been found exactly once. The pairs of non-static shapes are
+/// reported in the order of the tasks and then the pairs with a static shape in the order
+/// of the moved shapes. This order does not depend on the number of threads.
+void BroadPhaseAlgorithm::notifyOverlappingPairs(uint nbThreads) {
+
+    for (uint t=0; t < nbThreads; t++) {
+        notifyOverlappingPairs(mThreadsOverlappingPairs[t]);
+    }
+    for (uint t=0; t < nbThreads; t++) {
+        notifyOverlappingPairs(mThreadsStaticOverlappingPairs[t]);
     }
 }
 
-// Notify the broad-phase about a potential overlapping pair in the dynamic AABB tree
-void BroadPhaseAlgorithm::addOverlappingNodes(int referenceNodeId, const LinkedList<int>& overlappingNodes) {
+// Report the overlapping pairs of a list
+void BroadPhaseAlgorithm::notifyOverlappingPairs(const List<BroadPhasePair>& overlappingPairs) {
 
-    // For each overlapping node in the linked list
-    LinkedList<int>::ListElement* elem = overlappingNodes.getListHead();
-    while (elem != nullptr) {
+    mStatistics.nbPotentialPairs += overlappingPairs.size();
 
-        // If both the nodes are the same, we do not create store the overlapping pair
-        if (referenceNodeId != elem->data) {
+    for (uint i=0; i < overlappingPairs.size(); i++) {
 
-            // If we need to allocate more memory for the array of potential overlapping pairs
-            if (mNbPotentialPairs == mNbAllocatedPotentialPairs) {
+        const BroadPhasePair& pair = overlappingPairs[i];
 
-                MemoryAllocator& poolAllocator = mCollisionDetection.getMemoryManager().getPoolAllocator();
+        assert(pair.collisionShape1ID != pair.collisionShape2ID);
 
-                // Allocate more memory for the array of potential pairs
-                BroadPhasePair* oldPairs = mPotentialPairs;
-                uint oldNbAllocatedPotentialPairs = mNbAllocatedPotentialPairs;
-                mNbAllocatedPotentialPairs *= 2;
-                mPotentialPairs = static_cast<BroadPhasePair*>(poolAllocator.allocate(mNbAllocatedPotentialPairs * sizeof(BroadPhasePair)));
-                assert(mPotentialPairs);
-                memcpy(mPotentialPairs, oldPairs, mNbPotentialPairs * sizeof(BroadPhasePair));
-                poolAllocator.release(oldPairs, oldNbAllocatedPotentialPairs * sizeof(BroadPhasePair));
-            }
+        // Get the two collision shapes of the pair
+        ProxyShape* shape1 = getProxyShapeForBroadPhaseId(pair.collisionShape1ID);
+        ProxyShape* shape2 = getProxyShapeForBroadPhaseId(pair.collisionShape2ID);
 
-            // Add the new potential pair into the array of potential overlapping pairs
-            mPotentialPairs[mNbPotentialPairs].collisionShape1ID = std::min(referenceNodeId, elem->data);
-            mPotentialPairs[mNbPotentialPairs].collisionShape2ID = std::max(referenceNodeId, elem->data);
-            mNbPotentialPairs++;
+        // If the two proxy collision shapes are from the same body, skip it
+        if (shape1->getBody()->getId() != shape2->getBody()->getId()) {
+
+            // Notify the collision detection about the overlapping pair
+            mCollisionDetection.broadPhaseNotifyOverlappingPair(shape1, shape2);
         }
+    }
+}
 
-        elem = elem->next;
+// Return the statistics of the last step and of the trees
+/// The SAH cost of the trees is computed in a time proportional to their number of nodes.
+/// The statistics about the overlapping pairs of the collision detection are not set.
+BroadPhaseStatistics BroadPhaseAlgorithm::getStatistics() const {
+
+    BroadPhaseStatistics statistics = mStatistics;
+
+    if (mBroadPhaseType == BroadPhaseType::DYNAMIC_AABB_TREE) {
+        statistics.dynamicTreeHeight = mDynamicAABBTree.getHeight();
+        statistics.staticTreeHeight = mStaticAABBTree.getHeight();
+        statistics.dynamicTreeSAHCost = mDynamicAABBTree.computeSAHCost();
+        statistics.staticTreeSAHCost = mStaticAABBTree.computeSAHCost();
+        statistics.nbDynamicTreeNodes = mDynamicAABBTree.getNbNodes();
+        statistics.nbStaticTreeNodes = mStaticAABBTree.getNbNodes();
     }
+
+    return statistics;
 }
 
 // Called when a overlapping node has been found during the call to
 // DynamicAABBTree:reportAllShapesOverlappingWithAABB()
 void AABBOverlapCallback::notifyOverlappingNode(int nodeId) {
-    mOverlappingNodes.insert(nodeId);
+    mOverlappingNodes.insert(nodeId | mBroadPhaseIdFlag);
 }
 
 // Called for a broad-phase shape that has to be tested for raycast
@@ -294,7 +536,7 @@ decimal BroadPhaseRaycastCallback::raycastBroadPhaseShape(int32 nodeId, const Ra
     decimal hitFraction = decimal(-1.0);
 
     // Get the proxy shape from the node
-    ProxyShape* proxyShape = static_cast<ProxyShape*>(mDynamicAABBTree.getNodeDataPointer(nodeId));
+    ProxyShape* proxyShape = mBroadPhaseAlgorithm.getProxyShapeForBroadPhaseId(nodeId | mBroadPhaseIdFlag);
 
     // Check if the raycast filtering mask allows raycast against this shape
     if ((mRaycastWithCategoryMaskBits & proxyShape->getCollisionCategoryBits()) != 0) {
@@ -303,6 +545,14 @@ decimal BroadPhaseRaycastCallback::raycastBroadPhaseShape(int32 nodeId, const Ra
         // the proxy shape of this node because the ray is overlapping
         // with the shape in the broad-phase
         hitFraction = mRaycastTest.raycastAgainstShape(proxyShape, ray);
+
+        // Keep track of the clipping of the ray for the next trees
+        if (hitFraction == decimal(0.0)) {
+            mIsRaycastStopped = true;
+        }
+        else if (hitFraction > decimal(0.0) && hitFraction < mSmallestHitFraction) {
+            mSmallestHitFraction = hitFraction;
+        }
     }
 
     return hitFraction;
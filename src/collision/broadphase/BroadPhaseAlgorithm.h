@@ -28,8 +28,14 @@
 
 // Libraries
 #include "DynamicAABBTree.h"
+#include "SweepAndPrune.h"
+#include "WideAABBTree.h"
 #include "containers/LinkedList.h"
-#include "containers/Set.h"
+#include "containers/List.h"
+#include "containers/DenseIntegerSet.h"
+#include "utils/ThreadPool.h"
+#include "memory/MemoryManager.h"
+#include <algorithm>
 
 /// Namespace ReactPhysics3D
 namespace reactphysics3d {
@@ -72,9 +78,12 @@ class AABBOverlapCallback : public DynamicAABBTreeOverlapCallback {
 
         LinkedList<int>& mOverlappingNodes;
 
+        /// Flag added to the reported node IDs to get the broad-phase IDs
+        int mBroadPhaseIdFlag;
+
         // Constructor
-        AABBOverlapCallback(LinkedList<int>& overlappingNodes)
-             : mOverlappingNodes(overlappingNodes) {
+        AABBOverlapCallback(LinkedList<int>& overlappingNodes, int broadPhaseIdFlag = 0)
+             : mOverlappingNodes(overlappingNodes), mBroadPhaseIdFlag(broadPhaseIdFlag) {
 
         }
 
@@ -84,6 +93,96 @@ class AABBOverlapCallback : public DynamicAABBTreeOverlapCallback {
 
 };
 
+// Class OverlappingPairsCallback
+/**
+ * Callback that adds an overlapping pair into a list for each pair of
+ * overlapping leaves found by the traversal of the dynamic AABB tree.
+ */
+class OverlappingPairsCallback : public DynamicAABBTreeOverlapPairCallback {
+
+    private:
+
+        /// List where the overlapping pairs are added
+        List<BroadPhasePair>& mOverlappingPairs;
+
+    public:
+
+        // Constructor
+        OverlappingPairsCallback(List<BroadPhasePair>& overlappingPairs)
+             : mOverlappingPairs(overlappingPairs) {
+
+        }
+
+        // Called when a pair of overlapping leaves has been found during the call to
+        // DynamicAABBTree:reportOverlappingPairs()
+        virtual void notifyOverlappingPair(int nodeId1, int nodeId2) override;
+};
+
+// Class StaticOverlappingPairsCallback
+/**
+ * Callback that adds an overlapping pair into a list for each node of a dynamic
+ * AABB tree that overlaps with the AABB of a shape of the other tree (static
+ * shapes against the dynamic tree or dynamic shapes against the static tree).
+ */
+class StaticOverlappingPairsCallback : public DynamicAABBTreeOverlapCallback {
+
+    private:
+
+        /// Broad-phase ID of the shape whose AABB is tested
+        int mShapeId;
+
+        /// Flag added to the reported node IDs to get the broad-phase IDs
+        int mBroadPhaseIdFlag;
+
+        /// Flag for each node of the tree that is true if the pair with this node
+        /// has already been found (can be null)
+        const bool* mIsNodeSkipped;
+
+        /// List where the overlapping pairs are added
+        List<BroadPhasePair>& mOverlappingPairs;
+
+    public:
+
+        // Constructor
+        StaticOverlappingPairsCallback(int shapeId, int broadPhaseIdFlag, const bool* isNodeSkipped,
+                                       List<BroadPhasePair>& overlappingPairs)
+             : mShapeId(shapeId), mBroadPhaseIdFlag(broadPhaseIdFlag), mIsNodeSkipped(isNodeSkipped),
+               mOverlappingPairs(overlappingPairs) {
+
+        }
+
+        // Called when a overlapping node has been found during the call to
+        // DynamicAABBTree:reportAllShapesOverlappingWithAABB()
+        virtual void notifyOverlappingNode(int nodeId) override;
+};
+
+// Class OverlappingPairsTask
+/**
+ * Task executed by the threads of the broad-phase. Each thread computes the overlapping
+ * pairs of its range of traversal tasks and of its range of moved shapes.
+ */
+class OverlappingPairsTask : public ThreadPoolTask {
+
+    private:
+
+        /// Reference to the broad-phase algorithm
+        BroadPhaseAlgorithm& mBroadPhaseAlgorithm;
+
+        /// Number of threads that execute the task
+        uint mNbThreads;
+
+    public:
+
+        // Constructor
+        OverlappingPairsTask(BroadPhaseAlgorithm& broadPhaseAlgorithm, uint nbThreads)
+             : mBroadPhaseAlgorithm(broadPhaseAlgorithm), mNbThreads(nbThreads) {
+
+        }
+
+        // Compute the overlapping pairs of the ranges of a given thread
+        virtual void execute(uint taskIndex) override;
+};
+
 // Class BroadPhaseRaycastCallback
 /**
  * Callback called when the AABB of a leaf node is hit by a ray the
@@ -93,22 +192,47 @@ class BroadPhaseRaycastCallback : public DynamicAABBTreeRaycastCallback {
 
     private :
 
-        const DynamicAABBTree& mDynamicAABBTree;
+        const BroadPhaseAlgorithm& mBroadPhaseAlgorithm;
 
         unsigned short mRaycastWithCategoryMaskBits;
 
         RaycastTest& mRaycastTest;
 
+        /// Flag added to the reported node IDs to get the broad-phase IDs
+        int mBroadPhaseIdFlag;
+
+        /// Smallest positive hit fraction returned by the ray cast tests
+        decimal mSmallestHitFraction;
+
+        /// True if a ray cast test has asked to stop the ray casting
+        bool mIsRaycastStopped;
+
     public:
 
         // Constructor
-        BroadPhaseRaycastCallback(const DynamicAABBTree& dynamicAABBTree, unsigned short raycastWithCategoryMaskBits,
+        BroadPhaseRaycastCallback(const BroadPhaseAlgorithm& broadPhaseAlgorithm, unsigned short raycastWithCategoryMaskBits,
                                   RaycastTest& raycastTest)
-            : mDynamicAABBTree(dynamicAABBTree), mRaycastWithCategoryMaskBits(raycastWithCategoryMaskBits),
-              mRaycastTest(raycastTest) {
+            : mBroadPhaseAlgorithm(broadPhaseAlgorithm), mRaycastWithCategoryMaskBits(raycastWithCategoryMaskBits),
+              mRaycastTest(raycastTest), mBroadPhaseIdFlag(0), mSmallestHitFraction(DECIMAL_LARGEST),
+              mIsRaycastStopped(false) {
 
         }
 
+        // Set the flag added to the reported node IDs to get the broad-phase IDs
+        void setBroadPhaseIdFlag(int broadPhaseIdFlag) {
+            mBroadPhaseIdFlag = broadPhaseIdFlag;
+        }
+
+        // Return the smallest positive hit fraction returned by the ray cast tests
+        decimal getSmallestHitFraction() const {
+            return mSmallestHitFraction;
+        }
+
+        // Return true if a ray cast test has asked to stop the ray casting
+        bool isRaycastStopped() const {
+            return mIsRaycastStopped;
+        }
+
         // Destructor
         virtual ~BroadPhaseRaycastCallback() override = default;
 
@@ -117,36 +241,177 @@ class BroadPhaseRaycastCallback : public DynamicAABBTreeRaycastCallback {
 
 };
 
+// Structure BroadPhaseStatistics
+/**
+ * This structure contains statistics about the broad-phase collision detection of a world.
+ * The counters are about the last step: the shapes updated since the previous step and the
+ * pairs found, created and destroyed by the collision detection of the step. The statistics
+ * of the trees are computed when the statistics are requested. They can be used to tune the
+ * fat AABBs of the trees (DYNAMIC_TREE_AABB_GAP and DYNAMIC_TREE_AABB_LIN_GAP_MULTIPLIER)
+ * or to detect a degenerate tree.
+ */
+struct BroadPhaseStatistics {
+
+    /// Height of the tree of the non-static shapes (zero with the sweep-and-prune)
+    int dynamicTreeHeight = 0;
+
+    /// Height of the tree of the static shapes (zero with the sweep-and-prune)
+    int staticTreeHeight = 0;
+
+    /// SAH cost of the tree of the non-static shapes (zero with the sweep-and-prune)
+    decimal dynamicTreeSAHCost = decimal(0.0);
+
+    /// SAH cost of the tree of the static shapes (zero with the sweep-and-prune)
+    decimal staticTreeSAHCost = decimal(0.0);
+
+    /// Number of nodes of the tree of the non-static shapes (zero with the sweep-and-prune)
+    int nbDynamicTreeNodes = 0;
+
+    /// Number of nodes of the tree of the static shapes (zero with the sweep-and-prune)
+    int nbStaticTreeNodes = 0;
+
+    /// Number of shapes that have moved out of their fat AABB and have been reinserted into
+    /// the trees (refitted with DynamicTreeUpdateMethod::REFIT or updated in the sweep-and-prune)
+    uint nbReinsertedShapes = 0;
+
+    /// Number of trees that have been rebuilt because their SAH cost has grown too much
+    uint nbTreeRebuilds = 0;
+
+    /// Number of moved (or new) shapes whose overlapping pairs have been searched
+    uint nbMovedShapes = 0;
+
+    /// Number of overlapping pairs found by the broad-phase. Each pair is found once and there
+    /// are no duplicates to remove. Most of them are pairs that were already overlapping.
+    uint nbPotentialPairs = 0;
+
+    /// Number of new overlapping pairs (the potential pairs that were not already overlapping
+    /// and that have not been filtered out)
+    uint nbCreatedPairs = 0;
+
+    /// Number of overlapping pairs that have been destroyed because their shapes do not
+    /// overlap anymore (or cannot collide anymore)
+    uint nbDestroyedPairs = 0;
+
+    /// Number of overlapping pairs
+    uint nbOverlappingPairs = 0;
+
+    /// Number of active overlapping pairs (with at least one awake and non-static body)
+    uint nbActiveOverlappingPairs = 0;
+};
+
 // Class BroadPhaseAlgorithm
 /**
  * This class represents the broad-phase collision detection. The
  * goal of the broad-phase collision detection is to compute the pairs of proxy shapes
  * that have their AABBs overlapping. Only those pairs of bodies will be tested
  * later for collision during the narrow-phase collision detection. A dynamic AABB
- * tree data structure is used for fast broad-phase collision detection.
+ * tree data structure is used for fast broad-phase collision detection. A sweep-and-prune
+ * structure can be used instead (see WorldSettings::broadPhaseType) for worlds where most
+ * of the shapes move at each frame. With the dynamic AABB tree, the shapes of the static
+ * bodies are stored in a second tree. The moved shapes are tested against both trees
+ * but the pairs of static shapes are never tested. Because the static tree rarely changes,
+ * it is queried through a wide AABB tree (four children per node) that is rebuilt when the
+ * static tree has changed.
+ * The overlapping pairs with a shape that has moved are found with a single simultaneous
+ * traversal of the tree against itself that only descends into the subtrees that contain
+ * a moved shape. Each pair is found exactly once and therefore, the pairs do not need to
+ * be sorted to remove the duplicates. The traversal can be split into independent tasks
+ * across several threads and the pairs are always reported in the same order whatever
+ * the number of threads. The trees can be rebuilt periodically with the surface area
+ * heuristic when their quality has degraded (see WorldSettings::dynamicTreeRebuildCostRatio).
+ * Instead of reinserting the leaves of the shapes that have moved, the trees can also be
+ * refitted once per step (see WorldSettings::dynamicTreeUpdateMethod).
  */
 class BroadPhaseAlgorithm {
 
     protected :
 
+        // -------------------- Constants -------------------- //
+
+        /// Maximum number of threads used to compute the overlapping pairs
+        static const uint MAX_NB_THREADS = 64;
+
+        /// Minimum number of moved shapes for each thread used to compute the overlapping pairs
+        static const uint MIN_NB_MOVED_SHAPES_PER_THREAD = 256;
+
+        /// Minimum number of traversal tasks for each thread (to balance the work of the threads)
+        static const uint MIN_NB_TASKS_PER_THREAD = 8;
+
+        /// Flag of the broad-phase IDs of the shapes in the static tree (the broad-phase ID of
+        /// such a shape is the ID of its node in the static tree with this flag)
+        static const int STATIC_SHAPE_ID_FLAG = 1 << 30;
+
+        /// Number of calls to computeOverlappingPairs() between two checks of the SAH cost of the trees
+        static const uint NB_FRAMES_BETWEEN_TREE_COST_CHECKS = 64;
+
         // -------------------- Attributes -------------------- //
 
-        /// Dynamic AABB tree
+        /// Algorithm used by the broad-phase
+        BroadPhaseType mBroadPhaseType;
+
+        /// Dynamic AABB tree with the shapes of the non-static bodies
         DynamicAABBTree mDynamicAABBTree;
 
+        /// Dynamic AABB tree with the shapes of the static bodies
+        DynamicAABBTree mStaticAABBTree;
+
+        /// Wide AABB tree built from the tree of the static shapes to accelerate its queries
+        WideAABBTree mStaticWideAABBTree;
+
+        /// True if the wide tree of the static shapes is up to date with the static tree
+        bool mIsStaticWideTreeValid;
+
+        /// Sweep-and-prune structure (used instead of the dynamic AABB tree if the
+        /// broad-phase type is SWEEP_AND_PRUNE)
+        SweepAndPrune mSweepAndPrune;
+
         /// Set with the broad-phase IDs of all collision shapes that have moved (or have been
         /// created) during the last simulation step. Those are the shapes that need to be tested
         /// for overlapping in the next simulation step.
-        Set<int> mMovedShapes;
+        DenseIntegerSet mMovedShapes;
+
+        /// Set with the IDs of the nodes of the static tree whose shapes have moved (or have
+        /// been created) during the last simulation step
+        DenseIntegerSet mMovedStaticShapes;
 
-        /// Temporary array of potential overlapping pairs (with potential duplicates)
-        BroadPhasePair* mPotentialPairs;
+        /// Number of threads used to compute the overlapping pairs
+        uint mNbThreads;
 
-        /// Number of potential overlapping pairs
-        uint mNbPotentialPairs;
+        /// Worker threads used to compute the overlapping pairs (created once with the
+        /// broad-phase and waiting for the next frame between two frames)
+        ThreadPool mThreadPool;
 
-        /// Number of allocated elements for the array of potential overlapping pairs
-        uint mNbAllocatedPotentialPairs;
+        /// Pool allocators of the worker threads (one per worker thread)
+        MemoryManager::WorkerPoolAllocator* mWorkerAllocators;
+
+        /// Temporary arrays of overlapping pairs found by each thread
+        List<BroadPhasePair>* mThreadsOverlappingPairs;
+
+        /// Temporary arrays of overlapping pairs with a static shape found by each thread
+        List<BroadPhasePair>* mThreadsStaticOverlappingPairs;
+
+        /// Independent tasks of the traversal of the tree of the current frame
+        List<TreeNodePair> mTraversalTasks;
+
+        /// Flag for each node of the tree that is true if the subtree of the node
+        /// contains a moved shape (only valid during the current frame)
+        bool* mIsNodeMarked;
+
+        /// Method used to update the trees when a shape moves out of its fat AABB
+        DynamicTreeUpdateMethod mTreeUpdateMethod;
+
+        /// Maximum ratio between the SAH cost of a tree and its cost after its last rebuild
+        /// (zero if the trees are never rebuilt)
+        decimal mTreeRebuildCostRatio;
+
+        /// Number of calls to computeOverlappingPairs() since the last check of the SAH cost of the trees
+        uint mNbFramesSinceTreeCostCheck;
+
+        /// Statistics of the last step (without the statistics of the trees)
+        BroadPhaseStatistics mStatistics;
+
+        /// Number of shapes reinserted into the trees since the beginning of the last step
+        uint mNbReinsertedShapes;
 
         /// Reference to the collision detection object
         CollisionDetection& mCollisionDetection;
@@ -158,12 +423,38 @@ class BroadPhaseAlgorithm {
 
 #endif
 
+        // -------------------- Methods -------------------- //
+
+        /// Rebuild the trees whose SAH cost has grown too much since their last rebuild
+        void rebuildDegradedTrees();
+
+        /// Compute the overlapping pairs of the moved shapes with the dynamic AABB tree
+        void computeTreeOverlappingPairs(MemoryManager& memoryManager);
+
+        /// Compute the overlapping pairs of a range of traversal tasks and of a range of moved shapes
+        void computeTasksOverlappingPairs(uint threadIndex, uint nbThreads);
+
+        /// Return the memory allocator of a thread used to compute the overlapping pairs
+        MemoryAllocator& getThreadAllocator(uint threadIndex);
+
+        /// Report the overlapping pairs found by the threads
+        void notifyOverlappingPairs(uint nbThreads);
+
+        /// Report the overlapping pairs of a list
+        void notifyOverlappingPairs(const List<BroadPhasePair>& overlappingPairs);
+
+        /// Return true if a broad-phase ID is the ID of a shape of the static tree
+        static bool isStaticShapeId(int broadPhaseId);
+
+        /// Return the ID of the node of a shape in its tree
+        static int getTreeNodeId(int broadPhaseId);
+
     public :
 
         // -------------------- Methods -------------------- //
 
         /// Constructor
-        BroadPhaseAlgorithm(CollisionDetection& collisionDetection);
+        BroadPhaseAlgorithm(CollisionDetection& collisionDetection, const WorldSettings& worldSettings);
 
         /// Destructor
         ~BroadPhaseAlgorithm();
@@ -181,7 +472,7 @@ class BroadPhaseAlgorithm {
         void removeProxyCollisionShape(ProxyShape* proxyShape);
 
         /// Notify the broad-phase that a collision shape has moved and need to be updated
-        void updateProxyCollisionShape(ProxyShape* proxyShape, const AABB& aabb,
+        bool updateProxyCollisionShape(ProxyShape* proxyShape, const AABB& aabb,
                                        const Vector3& displacement, bool forceReinsert = false);
 
         /// Add a collision shape in the array of shapes that have moved in the last simulation step
@@ -192,9 +483,6 @@ class BroadPhaseAlgorithm {
         /// step and that need to be tested again for broad-phase overlapping.
         void removeMovedCollisionShape(int broadPhaseID);
 
-        /// Add potential overlapping pairs in the dynamic AABB tree
-        void addOverlappingNodes(int broadPhaseId1, const LinkedList<int>& overlappingNodes);
-
         /// Report all the shapes that are overlapping with a given AABB
         void reportAllShapesOverlappingWithAABB(const AABB& aabb, LinkedList<int>& overlappingNodes) const;
 
@@ -210,6 +498,12 @@ class BroadPhaseAlgorithm {
         /// Return the fat AABB of a given broad-phase shape
         const AABB& getFatAABB(int broadPhaseId) const;
 
+        /// Return the algorithm used by the broad-phase
+        BroadPhaseType getBroadPhaseType() const;
+
+        /// Return the statistics of the last step and of the trees
+        BroadPhaseStatistics getStatistics() const;
+
         /// Ray casting method
         void raycast(const Ray& ray, RaycastTest& raycastTest, unsigned short raycastWithCategoryMaskBits) const;
 
@@ -220,6 +514,9 @@ class BroadPhaseAlgorithm {
 
 #endif
 
+        // -------------------- Friendship -------------------- //
+
+        friend class OverlappingPairsTask;
 };
 
 // Method used to compare two pairs for sorting algorithm
@@ -232,17 +529,75 @@ inline bool BroadPhasePair::smallerThan(const BroadPhasePair& pair1, const Broad
     return false;
 }
 
+// Called when a pair of overlapping leaves has been found during the call to
+// DynamicAABBTree:reportOverlappingPairs()
+inline void OverlappingPairsCallback::notifyOverlappingPair(int nodeId1, int nodeId2) {
+
+    assert(nodeId1 != nodeId2);
+
+    BroadPhasePair pair;
+    pair.collisionShape1ID = std::min(nodeId1, nodeId2);
+    pair.collisionShape2ID = std::max(nodeId1, nodeId2);
+    mOverlappingPairs.add(pair);
+}
+
 // Return the fat AABB of a given broad-phase shape
 inline const AABB& BroadPhaseAlgorithm::getFatAABB(int broadPhaseId) const  {
+
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        return mSweepAndPrune.getFatAABB(broadPhaseId);
+    }
+
+    if (isStaticShapeId(broadPhaseId)) {
+        return mStaticAABBTree.getFatAABB(getTreeNodeId(broadPhaseId));
+    }
+
     return mDynamicAABBTree.getFatAABB(broadPhaseId);
 }
 
+// Return true if a broad-phase ID is the ID of a shape of the static tree
+inline bool BroadPhaseAlgorithm::isStaticShapeId(int broadPhaseId) {
+    assert(broadPhaseId >= 0);
+    return (broadPhaseId & STATIC_SHAPE_ID_FLAG) != 0;
+}
+
+// Return the ID of the node of a shape in its tree
+inline int BroadPhaseAlgorithm::getTreeNodeId(int broadPhaseId) {
+    assert(broadPhaseId >= 0);
+    return broadPhaseId & ~STATIC_SHAPE_ID_FLAG;
+}
+
+// Called when a overlapping node has been found during the call to
+// DynamicAABBTree:reportAllShapesOverlappingWithAABB()
+inline void StaticOverlappingPairsCallback::notifyOverlappingNode(int nodeId) {
+
+    // Skip the pairs that have already been found
+    if (mIsNodeSkipped != nullptr && mIsNodeSkipped[nodeId]) return;
+
+    const int shapeId = nodeId | mBroadPhaseIdFlag;
+
+    BroadPhasePair pair;
+    pair.collisionShape1ID = std::min(mShapeId, shapeId);
+    pair.collisionShape2ID = std::max(mShapeId, shapeId);
+    mOverlappingPairs.add(pair);
+}
+
+// Return the algorithm used by the broad-phase
+inline BroadPhaseType BroadPhaseAlgorithm::getBroadPhaseType() const {
+    return mBroadPhaseType;
+}
+
 // Add a collision shape in the array of shapes that have moved in the last simulation step
 // and that need to be tested again for broad-phase overlapping.
 inline void BroadPhaseAlgorithm::addMovedCollisionShape(int broadPhaseID) {
 
     // Store the broad-phase ID into the array of shapes that have moved
-    mMovedShapes.add(broadPhaseID);
+    if (mBroadPhaseType == BroadPhaseType::DYNAMIC_AABB_TREE && isStaticShapeId(broadPhaseID)) {
+        mMovedStaticShapes.add(getTreeNodeId(broadPhaseID));
+    }
+    else {
+        mMovedShapes.add(broadPhaseID);
+    }
 }
 
 // Remove a collision shape from the array of shapes that have moved in the last simulation step
@@ -250,11 +605,25 @@ inline void BroadPhaseAlgorithm::addMovedCollisionShape(int broadPhaseID) {
 inline void BroadPhaseAlgorithm::removeMovedCollisionShape(int broadPhaseID) {
 
     // Remove the broad-phase ID from the set
-    mMovedShapes.remove(broadPhaseID);
+    if (mBroadPhaseType == BroadPhaseType::DYNAMIC_AABB_TREE && isStaticShapeId(broadPhaseID)) {
+        mMovedStaticShapes.remove(getTreeNodeId(broadPhaseID));
+    }
+    else {
+        mMovedShapes.remove(broadPhaseID);
+    }
 }
 
 // Return the proxy shape corresponding to the broad-phase node id in parameter
 inline ProxyShape* BroadPhaseAlgorithm::getProxyShapeForBroadPhaseId(int broadPhaseId) const {
+
+    if (mBroadPhaseType == BroadPhaseType::SWEEP_AND_PRUNE) {
+        return static_cast<ProxyShape*>(mSweepAndPrune.getObjectDataPointer(broadPhaseId));
+    }
+
+    if (isStaticShapeId(broadPhaseId)) {
+        return static_cast<ProxyShape*>(mStaticAABBTree.getNodeDataPointer(getTreeNodeId(broadPhaseId)));
+    }
+
     return static_cast<ProxyShape*>(mDynamicAABBTree.getNodeDataPointer(broadPhaseId));
 }
 
@@ -264,6 +633,9 @@ inline ProxyShape* BroadPhaseAlgorithm::getProxyShapeForBroadPhaseId(int broadPh
 inline void BroadPhaseAlgorithm::setProfiler(Profiler* profiler) {
 	mProfiler = profiler;
 	mDynamicAABBTree.setProfiler(profiler);
+	mStaticAABBTree.setProfiler(profiler);
+	mStaticWideAABBTree.setProfiler(profiler);
+	mSweepAndPrune.setProfiler(profiler);
 }
 
 #endif
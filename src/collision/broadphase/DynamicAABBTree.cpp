@@ -28,6 +28,7 @@
 #include "BroadPhaseAlgorithm.h"
 #include "containers/Stack.h"
 #include "utils/Profiler.h"
+#include <algorithm>
 
 using namespace reactphysics3d;
 
@@ -36,7 +37,7 @@ const int TreeNode::NULL_TREE_NODE = -1;
 
 // Constructor
 DynamicAABBTree::DynamicAABBTree(MemoryAllocator& allocator, decimal extraAABBGap)
-                : mAllocator(allocator), mExtraAABBGap(extraAABBGap) {
+                : mAllocator(allocator), mExtraAABBGap(extraAABBGap), mRefitLeaves(allocator) {
 
     init();
 }
@@ -49,11 +50,15 @@ DynamicAABBTree::~DynamicAABBTree() {
 }
 
 // Initialize the tree
-void DynamicAABBTree::init() {
+void DynamicAABBTree::init(int nbAllocatedNodes) {
+
+    assert(nbAllocatedNodes > 0);
 
     mRootNodeID = TreeNode::NULL_TREE_NODE;
     mNbNodes = 0;
-    mNbAllocatedNodes = 8;
+    mNbAllocatedNodes = nbAllocatedNodes;
+    mBuildSAHCost = decimal(0.0);
+    mRefitLeaves.clear();
 
     // Allocate memory for the nodes of the tree
     mNodes = static_cast<TreeNode*>(mAllocator.allocate(mNbAllocatedNodes * sizeof(TreeNode)));
@@ -129,6 +134,19 @@ void DynamicAABBTree::releaseNode(int nodeID) {
     mNbNodes--;
 }
 
+// Link the free nodes in the list of free nodes in the order of their IDs
+/// The next allocated nodes then have increasing IDs.
+void DynamicAABBTree::sortFreeNodes() {
+
+    mFreeNodeID = TreeNode::NULL_TREE_NODE;
+    for (int i=mNbAllocatedNodes - 1; i >= 0; i--) {
+        if (mNodes[i].height == -1) {
+            mNodes[i].nextNodeID = mFreeNodeID;
+            mFreeNodeID = i;
+        }
+    }
+}
+
 // Internally add an object into the tree
 int DynamicAABBTree::addObjectInternal(const AABB& aabb) {
 
@@ -187,8 +205,22 @@ bool DynamicAABBTree::updateObject(int nodeID, const AABB& newAABB, const Vector
     // If the new AABB is outside the fat AABB, we remove the corresponding node
     removeLeafNode(nodeID);
 
+    // Compute the new fat AABB of the node
+    setLeafFatAABB(nodeID, newAABB, displacement);
+
+    // Reinsert the node into the tree
+    insertLeafNode(nodeID);
+
+    return true;
+}
+
+// Set the fat AABB of a leaf from the AABB of its object and its displacement
+/// The AABB is inflated with a constant gap and in direction of the linear motion
+/// of the object.
+void DynamicAABBTree::setLeafFatAABB(int nodeID, const AABB& aabb, const Vector3& displacement) {
+
     // Compute the fat AABB by inflating the AABB with a constant gap
-    mNodes[nodeID].aabb = newAABB;
+    mNodes[nodeID].aabb = aabb;
     const Vector3 gap(mExtraAABBGap, mExtraAABBGap, mExtraAABBGap);
     mNodes[nodeID].aabb.mMinCoordinates -= gap;
     mNodes[nodeID].aabb.mMaxCoordinates += gap;
@@ -213,14 +245,74 @@ bool DynamicAABBTree::updateObject(int nodeID, const AABB& newAABB, const Vector
       mNodes[nodeID].aabb.mMaxCoordinates.z += DYNAMIC_TREE_AABB_LIN_GAP_MULTIPLIER *displacement.z;
     }
 
-    assert(mNodes[nodeID].aabb.contains(newAABB));
+    assert(mNodes[nodeID].aabb.contains(aabb));
+}
 
-    // Reinsert the node into the tree
-    insertLeafNode(nodeID);
+// Update the fat AABB of an object that has moved without changing the structure of the tree
+/// If the new AABB of the object is still inside its fat AABB (and "forceRefit" is false), then
+/// nothing is done. Otherwise, the fat AABB of the leaf is computed like in updateObject() but the
+/// leaf keeps its place in the tree. The AABBs of its ancestors are only enlarged to contain the new
+/// fat AABB so that the tree stays valid for the queries. They are refitted tightly by the next call
+/// to refitTree(). The method returns true if the fat AABB of the object has changed.
+bool DynamicAABBTree::refitObject(int nodeID, const AABB& newAABB, const Vector3& displacement, bool forceRefit) {
+
+    RP3D_PROFILE("DynamicAABBTree::refitObject()", mProfiler);
+
+    assert(nodeID >= 0 && nodeID < mNbAllocatedNodes);
+    assert(mNodes[nodeID].isLeaf());
+
+    // If the new AABB is still inside the fat AABB of the node
+    if (!forceRefit && mNodes[nodeID].aabb.contains(newAABB)) {
+        return false;
+    }
+
+    setLeafFatAABB(nodeID, newAABB, displacement);
+
+    // Enlarge the ancestors that do not contain the new fat AABB
+    const AABB& fatAABB = mNodes[nodeID].aabb;
+    int currentNodeID = mNodes[nodeID].parentID;
+    while (currentNodeID != TreeNode::NULL_TREE_NODE && !mNodes[currentNodeID].aabb.contains(fatAABB)) {
+        mNodes[currentNodeID].aabb.mergeWithAABB(fatAABB);
+        currentNodeID = mNodes[currentNodeID].parentID;
+    }
+
+    mRefitLeaves.add(nodeID);
 
     return true;
 }
 
+// Refit the AABBs of the ancestors of the leaves changed with refitObject()
+/// The AABB of each ancestor of a changed leaf is computed again from its children, from the
+/// bottom up. The walk up from a leaf stops at the first ancestor whose AABB does not change.
+/// The structure of the tree is not modified and its quality can therefore degrade when the
+/// objects move a lot (see rebuildIfDegraded()).
+void DynamicAABBTree::refitTree() {
+
+    RP3D_PROFILE("DynamicAABBTree::refitTree()", mProfiler);
+
+    for (uint i=0; i < mRefitLeaves.size(); i++) {
+
+        // Skip the leaves that have been removed since they have been refitted
+        const int leafID = mRefitLeaves[i];
+        if (mNodes[leafID].height != 0) continue;
+
+        int currentNodeID = mNodes[leafID].parentID;
+        while (currentNodeID != TreeNode::NULL_TREE_NODE) {
+
+            TreeNode& node = mNodes[currentNodeID];
+            AABB aabb;
+            aabb.mergeTwoAABBs(mNodes[node.children[0]].aabb, mNodes[node.children[1]].aabb);
+
+            if (aabb.getMin() == node.aabb.getMin() && aabb.getMax() == node.aabb.getMax()) break;
+
+            node.aabb = aabb;
+            currentNodeID = node.parentID;
+        }
+    }
+
+    mRefitLeaves.clear();
+}
+
 // Insert a leaf node in the tree. The process of inserting a new leaf node
 // in the dynamic tree is described in the book "Introduction to Game Physics
 // with Box2D" by Ian Parberry.
@@ -593,12 +685,348 @@ int DynamicAABBTree::balanceSubTreeAtNode(int nodeID) {
     return nodeID;
 }
 
+// Build the tree with a batch of objects (where node data are two integers)
+/// All the objects previously in the tree are removed. The tree is built top-down with the
+/// binned surface area heuristic, which gives a better tree than inserting the objects one
+/// by one and is much faster for a large number of objects. If the "outNodeIds" array is not
+/// null, the ID of the leaf node of each object is written into it.
+void DynamicAABBTree::buildTree(const AABB* aabbs, const int32* data1, const int32* data2, int nbObjects,
+                                int* outNodeIds) {
+
+    int* nodeIds = outNodeIds != nullptr ? outNodeIds : static_cast<int*>(mAllocator.allocate(nbObjects * sizeof(int)));
+
+    buildTreeInternal(aabbs, nbObjects, nodeIds);
+
+    for (int i=0; i < nbObjects; i++) {
+        mNodes[nodeIds[i]].dataInt[0] = data1[i];
+        mNodes[nodeIds[i]].dataInt[1] = data2[i];
+    }
+
+    if (outNodeIds == nullptr) {
+        mAllocator.release(nodeIds, nbObjects * sizeof(int));
+    }
+}
+
+// Build the tree with a batch of objects (where node data are pointers)
+/// All the objects previously in the tree are removed. If the "outNodeIds" array is not
+/// null, the ID of the leaf node of each object is written into it.
+void DynamicAABBTree::buildTree(const AABB* aabbs, void* const* data, int nbObjects, int* outNodeIds) {
+
+    int* nodeIds = outNodeIds != nullptr ? outNodeIds : static_cast<int*>(mAllocator.allocate(nbObjects * sizeof(int)));
+
+    buildTreeInternal(aabbs, nbObjects, nodeIds);
+
+    for (int i=0; i < nbObjects; i++) {
+        mNodes[nodeIds[i]].dataPointer = data[i];
+    }
+
+    if (outNodeIds == nullptr) {
+        mAllocator.release(nodeIds, nbObjects * sizeof(int));
+    }
+}
+
+// Build the tree with a batch of leaves using the binned surface area heuristic
+/// The nodes of the tree are allocated in depth-first order.
+void DynamicAABBTree::buildTreeInternal(const AABB* aabbs, int nbObjects, int* outNodeIds) {
+
+    RP3D_PROFILE("DynamicAABBTree::buildTree()", mProfiler);
+
+    assert(nbObjects >= 0);
+
+    // Allocate all the nodes of the tree at once
+    mAllocator.release(mNodes, mNbAllocatedNodes * sizeof(TreeNode));
+    init(std::max(8, 2 * nbObjects - 1));
+
+    if (nbObjects == 0) return;
+
+    // Compute the fat AABBs of the leaves
+    AABB* fatAABBs = static_cast<AABB*>(mAllocator.allocate(nbObjects * sizeof(AABB)));
+    int* items = static_cast<int*>(mAllocator.allocate(nbObjects * sizeof(int)));
+    const Vector3 gap(mExtraAABBGap, mExtraAABBGap, mExtraAABBGap);
+    for (int i=0; i < nbObjects; i++) {
+        new (fatAABBs + i) AABB(aabbs[i].getMin() - gap, aabbs[i].getMax() + gap);
+        items[i] = i;
+        outNodeIds[i] = TreeNode::NULL_TREE_NODE;
+    }
+
+    mRootNodeID = buildSubTree(items, nbObjects, fatAABBs, outNodeIds);
+
+    mAllocator.release(items, nbObjects * sizeof(int));
+    mAllocator.release(fatAABBs, nbObjects * sizeof(AABB));
+
+    mBuildSAHCost = computeSAHCost();
+}
+
+// Rebuild the internal nodes of the tree using the binned surface area heuristic
+/// The leaves keep their node IDs (and their fat AABBs) because those IDs are stored by
+/// the users of the tree. The internal nodes are allocated in depth-first order using
+/// the smallest free node IDs.
+void DynamicAABBTree::rebuild() {
+
+    RP3D_PROFILE("DynamicAABBTree::rebuild()", mProfiler);
+
+    if (mRootNodeID == TreeNode::NULL_TREE_NODE || mNodes[mRootNodeID].isLeaf()) {
+        mBuildSAHCost = decimal(0.0);
+        return;
+    }
+
+    // Gather the leaves and release the internal nodes
+    const int nbLeaves = (mNbNodes + 1) / 2;
+    AABB* leavesAABBs = static_cast<AABB*>(mAllocator.allocate(nbLeaves * sizeof(AABB)));
+    int* leafNodeIds = static_cast<int*>(mAllocator.allocate(nbLeaves * sizeof(int)));
+    int* items = static_cast<int*>(mAllocator.allocate(nbLeaves * sizeof(int)));
+    int nbGatheredLeaves = 0;
+    for (int i=0; i < mNbAllocatedNodes; i++) {
+        if (mNodes[i].height == 0) {
+            assert(nbGatheredLeaves < nbLeaves);
+            new (leavesAABBs + nbGatheredLeaves) AABB(mNodes[i].aabb);
+            leafNodeIds[nbGatheredLeaves] = i;
+            items[nbGatheredLeaves] = nbGatheredLeaves;
+            nbGatheredLeaves++;
+        }
+        else if (mNodes[i].height > 0) {
+            releaseNode(i);
+        }
+    }
+    assert(nbGatheredLeaves == nbLeaves);
+    sortFreeNodes();
+
+    mRootNodeID = buildSubTree(items, nbLeaves, leavesAABBs, leafNodeIds);
+
+    // The AABBs of the internal nodes have been computed from the leaves
+    mRefitLeaves.clear();
+
+    mAllocator.release(items, nbLeaves * sizeof(int));
+    mAllocator.release(leafNodeIds, nbLeaves * sizeof(int));
+    mAllocator.release(leavesAABBs, nbLeaves * sizeof(AABB));
+
+    mBuildSAHCost = computeSAHCost();
+}
+
+// Rebuild the tree if its SAH cost has grown too much since its last build
+/// The tree is rebuilt if its current SAH cost is larger than "maxCostRatio" times its
+/// cost after its last build (a tree that has never been built is always rebuilt). The
+/// method returns true if the tree has been rebuilt.
+bool DynamicAABBTree::rebuildIfDegraded(decimal maxCostRatio) {
+
+    if (mRootNodeID == TreeNode::NULL_TREE_NODE || mNodes[mRootNodeID].isLeaf()) {
+        return false;
+    }
+
+    if (mBuildSAHCost > decimal(0.0) && computeSAHCost() <= maxCostRatio * mBuildSAHCost) {
+        return false;
+    }
+
+    rebuild();
+
+    return true;
+}
+
+// Return the surface area heuristic (SAH) cost of the tree
+/// This is the sum of the surface areas of the internal nodes divided by the surface
+/// area of the root node. It is proportional to the expected number of internal nodes
+/// visited by a query and can be compared between two trees with the same leaves.
+decimal DynamicAABBTree::computeSAHCost() const {
+
+    if (mRootNodeID == TreeNode::NULL_TREE_NODE || mNodes[mRootNodeID].isLeaf()) {
+        return decimal(0.0);
+    }
+
+    decimal sumAreas = decimal(0.0);
+    for (int i=0; i < mNbAllocatedNodes; i++) {
+        if (mNodes[i].height > 0) {
+            sumAreas += mNodes[i].aabb.getSurfaceArea();
+        }
+    }
+
+    const decimal rootArea = mNodes[mRootNodeID].aabb.getSurfaceArea();
+
+    return rootArea > decimal(0.0) ? sumAreas / rootArea : decimal(0.0);
+}
+
+// Build the subtree of a set of leaves using the binned surface area heuristic
+/// The items are indices in the arrays "itemsAABBs" and "leafNodeIds". If the leaf node ID
+/// of an item is NULL_TREE_NODE, a new leaf node is allocated for this item and its ID is
+/// written into the array. The nodes are allocated in depth-first order and the method
+/// returns the ID of the root node of the subtree.
+int DynamicAABBTree::buildSubTree(int* items, int nbItems, const AABB* itemsAABBs, int* leafNodeIds) {
+
+    assert(nbItems > 0);
+
+    // IDs of the internal nodes in the order of their allocation
+    List<int> internalNodes(mAllocator, nbItems - 1);
+
+    int rootNodeID = TreeNode::NULL_TREE_NODE;
+
+    Stack<TreeBuildTask, 64> stack(mAllocator);
+    stack.push(TreeBuildTask(0, nbItems, TreeNode::NULL_TREE_NODE, 0));
+
+    while (stack.getNbElements() > 0) {
+
+        const TreeBuildTask task = stack.pop();
+        const int nbTaskItems = task.endIndex - task.startIndex;
+        assert(nbTaskItems > 0);
+
+        int nodeID;
+
+        // If the range has a single leaf
+        if (nbTaskItems == 1) {
+
+            const int item = items[task.startIndex];
+            nodeID = leafNodeIds[item];
+            if (nodeID == TreeNode::NULL_TREE_NODE) {
+                nodeID = allocateNode();
+                mNodes[nodeID].aabb = itemsAABBs[item];
+                leafNodeIds[item] = nodeID;
+            }
+            assert(mNodes[nodeID].isLeaf());
+        }
+        else {
+
+            nodeID = allocateNode();
+            mNodes[nodeID].height = 1;
+            internalNodes.add(nodeID);
+
+            // Split the range and build the left subtree before the right one
+            const int nbLeftItems = partitionItems(items + task.startIndex, nbTaskItems, itemsAABBs);
+            const int splitIndex = task.startIndex + nbLeftItems;
+            stack.push(TreeBuildTask(splitIndex, task.endIndex, nodeID, 1));
+            stack.push(TreeBuildTask(task.startIndex, splitIndex, nodeID, 0));
+        }
+
+        mNodes[nodeID].parentID = task.parentID;
+        if (task.parentID != TreeNode::NULL_TREE_NODE) {
+            mNodes[task.parentID].children[task.childIndex] = nodeID;
+        }
+        else {
+            rootNodeID = nodeID;
+        }
+    }
+
+    // Compute the AABBs and heights of the internal nodes from the bottom up (the
+    // children of a node have been allocated after it)
+    for (int i=static_cast<int>(internalNodes.size()) - 1; i >= 0; i--) {
+
+        TreeNode& node = mNodes[internalNodes[i]];
+        const TreeNode& leftChild = mNodes[node.children[0]];
+        const TreeNode& rightChild = mNodes[node.children[1]];
+
+        node.aabb.mergeTwoAABBs(leftChild.aabb, rightChild.aabb);
+        node.height = std::max(leftChild.height, rightChild.height) + 1;
+    }
+
+    return rootNodeID;
+}
+
+// Partition a set of leaves in two sets using the binned surface area heuristic
+/// The centers of the AABBs of the items are projected into bins along the axis where they
+/// are the most spread out and the split between two bins with the smallest SAH cost is
+/// selected. The items are reordered such that the left set is first and the method returns
+/// the number of items of the left set (always between 1 and nbItems - 1).
+int DynamicAABBTree::partitionItems(int* items, int nbItems, const AABB* itemsAABBs) const {
+
+    assert(nbItems > 1);
+
+    // Compute the bounds of the centers of the AABBs
+    Vector3 minCenter(DECIMAL_LARGEST, DECIMAL_LARGEST, DECIMAL_LARGEST);
+    Vector3 maxCenter(-DECIMAL_LARGEST, -DECIMAL_LARGEST, -DECIMAL_LARGEST);
+    for (int i=0; i < nbItems; i++) {
+        const Vector3 center = itemsAABBs[items[i]].getCenter();
+        minCenter = Vector3::min(minCenter, center);
+        maxCenter = Vector3::max(maxCenter, center);
+    }
+
+    const int axis = (maxCenter - minCenter).getMaxAxis();
+    const decimal minAxis = minCenter[axis];
+    const decimal extent = maxCenter[axis] - minAxis;
+
+    // If all the centers are at the same position, split the set in the middle
+    if (extent <= MACHINE_EPSILON) {
+        return nbItems / 2;
+    }
+
+    const decimal binsPerUnit = decimal(NB_SAH_BINS) / extent;
+    auto computeBinIndex = [&](int item) {
+        const int index = static_cast<int>((itemsAABBs[item].getCenter()[axis] - minAxis) * binsPerUnit);
+        return std::min(std::max(index, 0), NB_SAH_BINS - 1);
+    };
+
+    // Compute the number of items and the bounds of each bin
+    int binsNbItems[NB_SAH_BINS] = {};
+    AABB binsAABBs[NB_SAH_BINS];
+    for (int i=0; i < nbItems; i++) {
+        const int bin = computeBinIndex(items[i]);
+        if (binsNbItems[bin] == 0) {
+            binsAABBs[bin] = itemsAABBs[items[i]];
+        }
+        else {
+            binsAABBs[bin].mergeWithAABB(itemsAABBs[items[i]]);
+        }
+        binsNbItems[bin]++;
+    }
+
+    // Compute the cost of the right sets for each split
+    decimal rightCosts[NB_SAH_BINS];
+    AABB rightAABB;
+    int rightNbItems = 0;
+    for (int b=NB_SAH_BINS - 1; b > 0; b--) {
+        if (binsNbItems[b] > 0) {
+            if (rightNbItems == 0) rightAABB = binsAABBs[b];
+            else rightAABB.mergeWithAABB(binsAABBs[b]);
+            rightNbItems += binsNbItems[b];
+        }
+        rightCosts[b] = rightNbItems > 0 ? rightAABB.getSurfaceArea() * rightNbItems : decimal(0.0);
+    }
+
+    // Find the split (after bin "bestBin") with the smallest cost
+    int bestBin = -1;
+    decimal bestCost = DECIMAL_LARGEST;
+    AABB leftAABB;
+    int leftNbItems = 0;
+    for (int b=0; b < NB_SAH_BINS - 1; b++) {
+        if (binsNbItems[b] > 0) {
+            if (leftNbItems == 0) leftAABB = binsAABBs[b];
+            else leftAABB.mergeWithAABB(binsAABBs[b]);
+            leftNbItems += binsNbItems[b];
+        }
+        if (leftNbItems == 0 || leftNbItems == nbItems) continue;
+        const decimal cost = leftAABB.getSurfaceArea() * leftNbItems + rightCosts[b + 1];
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestBin = b;
+        }
+    }
+
+    // If no split separates the items, split the set in the middle along the axis
+    if (bestBin == -1) {
+        std::nth_element(items, items + nbItems / 2, items + nbItems, [&](int item1, int item2) {
+            return itemsAABBs[item1].getCenter()[axis] < itemsAABBs[item2].getCenter()[axis];
+        });
+        return nbItems / 2;
+    }
+
+    int* middle = std::partition(items, items + nbItems, [&](int item) {
+        return computeBinIndex(item) <= bestBin;
+    });
+
+    return static_cast<int>(middle - items);
+}
+
 /// Report all shapes overlapping with the AABB given in parameter.
 void DynamicAABBTree::reportAllShapesOverlappingWithAABB(const AABB& aabb,
                                                          DynamicAABBTreeOverlapCallback& callback) const {
 
+    reportAllShapesOverlappingWithAABB(aabb, callback, mAllocator);
+}
+
+// Report all shapes overlapping with the AABB given in parameter using a given allocator.
+/// The tree is not modified by this method. Therefore, it can be called concurrently by
+/// several threads if each one uses a thread-safe allocator.
+void DynamicAABBTree::reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback,
+                                                         MemoryAllocator& allocator) const {
+
     // Create a stack with the nodes to visit
-    Stack<int, 64> stack(mAllocator);
+    Stack<int, 64> stack(allocator);
     stack.push(mRootNodeID);
 
     // While there are still nodes to visit
@@ -632,6 +1060,169 @@ void DynamicAABBTree::reportAllShapesOverlappingWithAABB(const AABB& aabb,
     }
 }
 
+// Mark a leaf and all its ancestors in an array of flags indexed by node ID
+/// The array must contain one flag per allocated node. The overlapping pairs of
+/// leaves are then only searched in the subtrees that contain a marked leaf.
+void DynamicAABBTree::markLeafAndAncestors(int leafId, bool* isNodeMarked) const {
+
+    assert(leafId >= 0 && leafId < mNbAllocatedNodes);
+    assert(mNodes[leafId].isLeaf());
+
+    // Stop at the first ancestor that is already marked (its own ancestors are marked too)
+    int nodeId = leafId;
+    while (nodeId != TreeNode::NULL_TREE_NODE && !isNodeMarked[nodeId]) {
+        isNodeMarked[nodeId] = true;
+        nodeId = mNodes[nodeId].parentID;
+    }
+}
+
+// Compute the pairs of child nodes to visit after a pair of nodes
+/// The child pairs are written into the array in parameter (that must have room for
+/// three pairs) and their number is returned. The pair in parameter must not be made
+/// of two different leaves.
+int DynamicAABBTree::expandNodePair(const TreeNodePair& nodePair, const bool* isNodeMarked,
+                                    TreeNodePair* childPairs) const {
+
+    int nbChildPairs = 0;
+
+    const TreeNode& node1 = mNodes[nodePair.nodeId1];
+    const TreeNode& node2 = mNodes[nodePair.nodeId2];
+
+    // If we search the pairs inside the subtree of a single node
+    if (nodePair.nodeId1 == nodePair.nodeId2) {
+
+        assert(!node1.isLeaf());
+
+        // Pairs inside the left subtree, inside the right subtree and between both subtrees
+        const TreeNodePair candidates[3] = {TreeNodePair(node1.children[0], node1.children[0]),
+                                            TreeNodePair(node1.children[1], node1.children[1]),
+                                            TreeNodePair(node1.children[0], node1.children[1])};
+        for (int i=0; i < 3; i++) {
+            if (isNodePairToVisit(candidates[i].nodeId1, candidates[i].nodeId2, isNodeMarked)) {
+                childPairs[nbChildPairs] = candidates[i];
+                nbChildPairs++;
+            }
+        }
+
+        return nbChildPairs;
+    }
+
+    assert(!node1.isLeaf() || !node2.isLeaf());
+
+    // Descend into the largest internal node
+    const bool isNode1Split = node2.isLeaf() || (!node1.isLeaf() && node1.aabb.getVolume() >= node2.aabb.getVolume());
+
+    for (int i=0; i < 2; i++) {
+
+        const int nodeId1 = isNode1Split ? node1.children[i] : nodePair.nodeId1;
+        const int nodeId2 = isNode1Split ? nodePair.nodeId2 : node2.children[i];
+
+        if (isNodePairToVisit(nodeId1, nodeId2, isNodeMarked)) {
+            childPairs[nbChildPairs] = TreeNodePair(nodeId1, nodeId2);
+            nbChildPairs++;
+        }
+    }
+
+    return nbChildPairs;
+}
+
+// Split the search of the overlapping pairs of leaves with a marked leaf into independent tasks
+/// The pairs of nodes to visit are expanded level by level until there are at least
+/// minNbTasks tasks (or no task can be expanded anymore). Each overlapping pair of leaves
+/// is found by exactly one task and the tasks can be processed concurrently with the
+/// reportOverlappingPairs() method. Reporting the pairs of the tasks in their order
+/// always gives the same sequence of pairs.
+void DynamicAABBTree::computeOverlappingPairsTasks(const bool* isNodeMarked, int minNbTasks,
+                                                   List<TreeNodePair>& tasks) const {
+
+    tasks.clear();
+
+    if (mRootNodeID == TreeNode::NULL_TREE_NODE ||
+        !isNodePairToVisit(mRootNodeID, mRootNodeID, isNodeMarked)) {
+        return;
+    }
+
+    tasks.add(TreeNodePair(mRootNodeID, mRootNodeID));
+
+    List<TreeNodePair> expandedTasks(mAllocator);
+    bool isExpanded = true;
+
+    while (isExpanded && static_cast<int>(tasks.size()) < minNbTasks) {
+
+        isExpanded = false;
+        expandedTasks.clear();
+
+        for (uint i=0; i < tasks.size(); i++) {
+
+            // A pair of two leaves is an overlapping pair and stays a task
+            if (tasks[i].nodeId1 != tasks[i].nodeId2 && mNodes[tasks[i].nodeId1].isLeaf() &&
+                mNodes[tasks[i].nodeId2].isLeaf()) {
+                expandedTasks.add(tasks[i]);
+                continue;
+            }
+
+            TreeNodePair childPairs[3];
+            const int nbChildPairs = expandNodePair(tasks[i], isNodeMarked, childPairs);
+
+            for (int c=0; c < nbChildPairs; c++) {
+                expandedTasks.add(childPairs[c]);
+            }
+
+            isExpanded |= nbChildPairs > 0;
+        }
+
+        tasks = expandedTasks;
+    }
+}
+
+// Report the overlapping pairs of leaves with a marked leaf of a task
+/// The tree is not modified by this method. Therefore, several tasks can be processed
+/// concurrently if each thread uses a thread-safe allocator.
+void DynamicAABBTree::reportOverlappingPairs(const TreeNodePair& task, const bool* isNodeMarked,
+                                             DynamicAABBTreeOverlapPairCallback& callback,
+                                             MemoryAllocator& allocator) const {
+
+    // Create a stack with the pairs of nodes to visit
+    Stack<TreeNodePair, 64> stack(allocator);
+    stack.push(task);
+
+    // While there are still pairs of nodes to visit
+    while (stack.getNbElements() > 0) {
+
+        const TreeNodePair nodePair = stack.pop();
+
+        // If the pair is made of two overlapping leaves
+        if (nodePair.nodeId1 != nodePair.nodeId2 && mNodes[nodePair.nodeId1].isLeaf() &&
+            mNodes[nodePair.nodeId2].isLeaf()) {
+
+            callback.notifyOverlappingPair(nodePair.nodeId1, nodePair.nodeId2);
+            continue;
+        }
+
+        TreeNodePair childPairs[3];
+        const int nbChildPairs = expandNodePair(nodePair, isNodeMarked, childPairs);
+
+        // Push the child pairs such that they are visited in their order
+        for (int c=nbChildPairs-1; c >= 0; c--) {
+            stack.push(childPairs[c]);
+        }
+    }
+}
+
+// Report all the overlapping pairs of leaves of the tree with a marked leaf
+/// Each pair is reported only once. A pair of leaves is reported if their fat AABBs overlap
+/// and if at least one of the two leaves has been marked with markLeafAndAncestors().
+void DynamicAABBTree::reportAllOverlappingPairs(const bool* isNodeMarked,
+                                                DynamicAABBTreeOverlapPairCallback& callback) const {
+
+    if (mRootNodeID == TreeNode::NULL_TREE_NODE ||
+        !isNodePairToVisit(mRootNodeID, mRootNodeID, isNodeMarked)) {
+        return;
+    }
+
+    reportOverlappingPairs(TreeNodePair(mRootNodeID, mRootNodeID), isNodeMarked, callback, mAllocator);
+}
+
 // Ray casting method
 void DynamicAABBTree::raycast(const Ray& ray, DynamicAABBTreeRaycastCallback &callback) const {
 
@@ -29,6 +29,7 @@
 // Libraries
 #include "configuration.h"
 #include "collision/shapes/AABB.h"
+#include "containers/List.h"
 
 /// Namespace ReactPhysics3D
 namespace reactphysics3d {
@@ -110,6 +111,84 @@ class DynamicAABBTreeOverlapCallback {
         virtual ~DynamicAABBTreeOverlapCallback() = default;
 };
 
+// Structure TreeNodePair
+/**
+ * This structure represents a pair of nodes of the tree that is visited during the
+ * search of the overlapping pairs of leaves of the tree. If the two nodes are the
+ * same node, the overlapping pairs of leaves inside the subtree of this node are
+ * searched. Otherwise, the overlapping pairs with a leaf of each subtree are searched.
+ */
+struct TreeNodePair {
+
+    // -------------------- Attributes -------------------- //
+
+    /// ID of the first node
+    int32 nodeId1;
+
+    /// ID of the second node
+    int32 nodeId2;
+
+    // -------------------- Methods -------------------- //
+
+    /// Constructor
+    TreeNodePair() = default;
+
+    /// Constructor
+    TreeNodePair(int32 id1, int32 id2) : nodeId1(id1), nodeId2(id2) {
+
+    }
+};
+
+// Structure TreeBuildTask
+/**
+ * This structure represents a range of leaves whose subtree has to be built during
+ * the top-down construction of the tree.
+ */
+struct TreeBuildTask {
+
+    // -------------------- Attributes -------------------- //
+
+    /// Index of the first leaf of the range in the array of leaves
+    int32 startIndex;
+
+    /// Index after the last leaf of the range in the array of leaves
+    int32 endIndex;
+
+    /// ID of the parent node of the subtree
+    int32 parentID;
+
+    /// Index of the subtree in the children of its parent node
+    int32 childIndex;
+
+    // -------------------- Methods -------------------- //
+
+    /// Constructor
+    TreeBuildTask() = default;
+
+    /// Constructor
+    TreeBuildTask(int32 start, int32 end, int32 parent, int32 child)
+        : startIndex(start), endIndex(end), parentID(parent), childIndex(child) {
+
+    }
+};
+
+// Class DynamicAABBTreeOverlapPairCallback
+/**
+ * Overlapping callback method that has to be used as parameter of the
+ * reportOverlappingPairs() method.
+ */
+class DynamicAABBTreeOverlapPairCallback {
+
+    public :
+
+        // Called when a pair of overlapping leaves has been found during the call to
+        // DynamicAABBTree:reportOverlappingPairs()
+        virtual void notifyOverlappingPair(int nodeId1, int nodeId2)=0;
+
+        // Destructor
+        virtual ~DynamicAABBTreeOverlapPairCallback() = default;
+};
+
 // Class DynamicAABBTreeRaycastCallback
 /**
  * Raycast callback in the Dynamic AABB Tree called when the AABB of a leaf
@@ -133,11 +212,21 @@ class DynamicAABBTreeRaycastCallback {
  * dynamic tree implementation in BulletPhysics. The following implementation is
  * based on the one from Erin Catto in Box2D as described in the book
  * "Introduction to Game Physics with Box2D" by Ian Parberry.
+ * The tree can also be built top-down from a batch of objects with the binned surface
+ * area heuristic (SAH) and rebuilt this way when its quality has degraded after many
+ * insertions and removals. A tree built this way has its nodes laid out in depth-first order.
+ * Instead of being removed and inserted again, a leaf that has moved can also keep its place
+ * in the tree (see refitObject()) and the AABBs of the internal nodes are then refitted.
  */
 class DynamicAABBTree {
 
     private:
 
+        // -------------------- Constants -------------------- //
+
+        /// Number of bins used to find the best split of a node when the tree is built
+        static const int NB_SAH_BINS = 16;
+
         // -------------------- Attributes -------------------- //
 
         /// Memory allocator
@@ -162,6 +251,13 @@ class DynamicAABBTree {
         /// without triggering a large modification of the tree which can be costly
         decimal mExtraAABBGap;
 
+        /// SAH cost of the tree after it has been built or rebuilt (zero if it has never been)
+        decimal mBuildSAHCost;
+
+        /// IDs of the leaves whose fat AABB has been changed with refitObject() since the
+        /// last call to refitTree() (it can contain IDs of nodes that have been released)
+        List<int> mRefitLeaves;
+
 #ifdef IS_PROFILING_ACTIVE
 
 		/// Pointer to the profiler
@@ -192,8 +288,29 @@ class DynamicAABBTree {
         /// Internally add an object into the tree
         int addObjectInternal(const AABB& aabb);
 
+        /// Set the fat AABB of a leaf from the AABB of its object and its displacement
+        void setLeafFatAABB(int nodeID, const AABB& aabb, const Vector3& displacement);
+
         /// Initialize the tree
-        void init();
+        void init(int nbAllocatedNodes = 8);
+
+        /// Link the free nodes in the list of free nodes in the order of their IDs
+        void sortFreeNodes();
+
+        /// Build the tree with a batch of leaves using the binned surface area heuristic
+        void buildTreeInternal(const AABB* aabbs, int nbObjects, int* outNodeIds);
+
+        /// Build the subtree of a set of leaves using the binned surface area heuristic
+        int buildSubTree(int* items, int nbItems, const AABB* itemsAABBs, int* leafNodeIds);
+
+        /// Partition a set of leaves in two sets using the binned surface area heuristic
+        int partitionItems(int* items, int nbItems, const AABB* itemsAABBs) const;
+
+        /// Return true if a pair of nodes can contain an overlapping pair of leaves with a marked leaf
+        bool isNodePairToVisit(int nodeId1, int nodeId2, const bool* isNodeMarked) const;
+
+        /// Compute the pairs of child nodes to visit after a pair of nodes
+        int expandNodePair(const TreeNodePair& nodePair, const bool* isNodeMarked, TreeNodePair* childPairs) const;
 
 #ifndef NDEBUG
 
@@ -221,12 +338,34 @@ class DynamicAABBTree {
         /// Add an object into the tree (where node data is a pointer)
         int addObject(const AABB& aabb, void* data);
 
+        /// Build the tree with a batch of objects (where node data are two integers)
+        void buildTree(const AABB* aabbs, const int32* data1, const int32* data2, int nbObjects,
+                       int* outNodeIds = nullptr);
+
+        /// Build the tree with a batch of objects (where node data are pointers)
+        void buildTree(const AABB* aabbs, void* const* data, int nbObjects, int* outNodeIds = nullptr);
+
+        /// Rebuild the internal nodes of the tree using the binned surface area heuristic
+        void rebuild();
+
+        /// Rebuild the tree if its SAH cost has grown too much since its last build
+        bool rebuildIfDegraded(decimal maxCostRatio);
+
+        /// Return the surface area heuristic (SAH) cost of the tree
+        decimal computeSAHCost() const;
+
         /// Remove an object from the tree
         void removeObject(int nodeID);
 
         /// Update the dynamic tree after an object has moved.
         bool updateObject(int nodeID, const AABB& newAABB, const Vector3& displacement, bool forceReinsert = false);
 
+        /// Update the fat AABB of an object that has moved without changing the structure of the tree
+        bool refitObject(int nodeID, const AABB& newAABB, const Vector3& displacement, bool forceRefit = false);
+
+        /// Refit the AABBs of the ancestors of the leaves changed with refitObject()
+        void refitTree();
+
         /// Return the fat AABB corresponding to a given node ID
         const AABB& getFatAABB(int nodeID) const;
 
@@ -240,12 +379,39 @@ class DynamicAABBTree {
         void reportAllShapesOverlappingWithAABB(const AABB& aabb,
                                                 DynamicAABBTreeOverlapCallback& callback) const;
 
+        /// Report all shapes overlapping with the AABB given in parameter using a given
+        /// allocator for the temporary memory of the query
+        void reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback,
+                                                MemoryAllocator& allocator) const;
+
+        /// Return the number of allocated nodes (all the node IDs are smaller than this number)
+        int getNbAllocatedNodes() const;
+
+        /// Mark a leaf and all its ancestors in an array of flags indexed by node ID
+        void markLeafAndAncestors(int leafId, bool* isNodeMarked) const;
+
+        /// Split the search of the overlapping pairs of leaves with a marked leaf into independent tasks
+        void computeOverlappingPairsTasks(const bool* isNodeMarked, int minNbTasks, List<TreeNodePair>& tasks) const;
+
+        /// Report the overlapping pairs of leaves with a marked leaf of a task
+        void reportOverlappingPairs(const TreeNodePair& task, const bool* isNodeMarked,
+                                    DynamicAABBTreeOverlapPairCallback& callback, MemoryAllocator& allocator) const;
+
+        /// Report all the overlapping pairs of leaves of the tree with a marked leaf
+        void reportAllOverlappingPairs(const bool* isNodeMarked, DynamicAABBTreeOverlapPairCallback& callback) const;
+
         /// Ray casting method
         void raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const;
 
         /// Compute the height of the tree
         int computeHeight();
 
+        /// Return the height of the tree
+        int getHeight() const;
+
+        /// Return the number of nodes of the tree
+        int getNbNodes() const;
+
         /// Return the root AABB of the tree
         AABB getRootAABB() const;
 
@@ -259,6 +425,10 @@ class DynamicAABBTree {
 
 #endif
 
+        // -------------------- Friendship -------------------- //
+
+        friend class WideAABBTree;
+        friend class TriangleMeshBVH;
 };
 
 // Return true if the node is a leaf of the tree
@@ -286,6 +456,32 @@ inline void* DynamicAABBTree::getNodeDataPointer(int nodeID) const {
     return mNodes[nodeID].dataPointer;
 }
 
+// Return the number of allocated nodes (all the node IDs are smaller than this number)
+inline int DynamicAABBTree::getNbAllocatedNodes() const {
+    return mNbAllocatedNodes;
+}
+
+// Return true if a pair of nodes can contain an overlapping pair of leaves with a marked leaf
+inline bool DynamicAABBTree::isNodePairToVisit(int nodeId1, int nodeId2, const bool* isNodeMarked) const {
+
+    if (nodeId1 == nodeId2) {
+        return isNodeMarked[nodeId1] && !mNodes[nodeId1].isLeaf();
+    }
+
+    return (isNodeMarked[nodeId1] || isNodeMarked[nodeId2]) && mNodes[nodeId1].aabb.testCollision(mNodes[nodeId2].aabb);
+}
+
+// Return the height of the tree
+/// This is the height stored in the root node (zero if the tree is empty or has a single leaf)
+inline int DynamicAABBTree::getHeight() const {
+    return mRootNodeID == TreeNode::NULL_TREE_NODE ? 0 : mNodes[mRootNodeID].height;
+}
+
+// Return the number of nodes of the tree (leaves and internal nodes)
+inline int DynamicAABBTree::getNbNodes() const {
+    return mNbNodes;
+}
+
 // Return the root AABB of the tree
 inline AABB DynamicAABBTree::getRootAABB() const {
     return getFatAABB(mRootNodeID);
@@ -0,0 +1,434 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "SweepAndPrune.h"
+#include "DynamicAABBTree.h"
+#include "containers/DenseIntegerSet.h"
+#include "collision/RaycastInfo.h"
+#include "utils/Profiler.h"
+#include <algorithm>
+
+using namespace reactphysics3d;
+
+// Constructor
+SweepAndPrune::SweepAndPrune(MemoryAllocator& allocator, decimal extraAABBGap)
+              : mBoxes(allocator), mObjects(allocator), mFreeObjectId(-1), mSweepAxis(0),
+                mIsSorted(true), mExtraAABBGap(extraAABBGap) {
+
+#ifdef IS_PROFILING_ACTIVE
+    mProfiler = nullptr;
+#endif
+
+}
+
+// Compute the fat AABB of an object from its AABB and its displacement
+/// The AABB is inflated with a constant gap and in direction of the linear motion
+/// of the object in the same way as in the dynamic AABB tree.
+AABB SweepAndPrune::computeFatAABB(const AABB& aabb, const Vector3& displacement) const {
+
+    const Vector3 gap(mExtraAABBGap, mExtraAABBGap, mExtraAABBGap);
+    Vector3 minCoordinates = aabb.getMin() - gap;
+    Vector3 maxCoordinates = aabb.getMax() + gap;
+
+    for (int axis=0; axis < 3; axis++) {
+        if (displacement[axis] < decimal(0.0)) {
+            minCoordinates[axis] += DYNAMIC_TREE_AABB_LIN_GAP_MULTIPLIER * displacement[axis];
+        }
+        else {
+            maxCoordinates[axis] += DYNAMIC_TREE_AABB_LIN_GAP_MULTIPLIER * displacement[axis];
+        }
+    }
+
+    return AABB(minCoordinates, maxCoordinates);
+}
+
+// Add an object and return its ID
+int SweepAndPrune::addObject(const AABB& aabb, void* data) {
+
+    // Get a free object ID (or create a new one)
+    int32 objectId;
+    if (mFreeObjectId != -1) {
+        objectId = mFreeObjectId;
+        mFreeObjectId = mObjects[objectId].index;
+    }
+    else {
+        objectId = static_cast<int32>(mObjects.size());
+        mObjects.add(SweepAndPruneObject());
+    }
+
+    SortedBox box;
+    box.aabb = computeFatAABB(aabb, Vector3::zero());
+    box.objectId = objectId;
+    box.isMoved = false;
+
+    box.maxCoordinatePrefix = box.aabb.getMax()[mSweepAxis];
+
+    // The array stays sorted if the new box is added after the last one along the sweep axis
+    if (mBoxes.size() > 0) {
+        const SortedBox& lastBox = mBoxes[static_cast<uint>(mBoxes.size() - 1)];
+        if (lastBox.aabb.getMin()[mSweepAxis] > box.aabb.getMin()[mSweepAxis]) {
+            mIsSorted = false;
+        }
+        box.maxCoordinatePrefix = std::max(box.maxCoordinatePrefix, lastBox.maxCoordinatePrefix);
+    }
+
+    mObjects[objectId].data = data;
+    mObjects[objectId].index = static_cast<int32>(mBoxes.size());
+    mObjects[objectId].isUsed = true;
+    mBoxes.add(box);
+
+    return objectId;
+}
+
+// Remove an object
+void SweepAndPrune::removeObject(int objectId) {
+
+    assert(objectId >= 0 && objectId < static_cast<int>(mObjects.size()));
+    assert(mObjects[objectId].isUsed);
+
+    // Remove the box of the object and shift the next boxes to keep the array sorted. The
+    // max coordinate prefixes of the next boxes are still upper bounds of their true values.
+    const uint index = static_cast<uint>(mObjects[objectId].index);
+    mBoxes.removeAt(index);
+    for (uint i=index; i < mBoxes.size(); i++) {
+        mObjects[mBoxes[i].objectId].index = static_cast<int32>(i);
+    }
+
+    // Add the object to the list of free objects
+    mObjects[objectId].data = nullptr;
+    mObjects[objectId].index = mFreeObjectId;
+    mObjects[objectId].isUsed = false;
+    mFreeObjectId = objectId;
+}
+
+// Update the fat AABB of an object after it has moved
+/// If the new AABB of the object is still inside its fat AABB, nothing is done and the method
+/// returns false. Otherwise, the fat AABB is recomputed and the method returns true. The array
+/// of boxes will be sorted again before the next search of the overlapping pairs.
+bool SweepAndPrune::updateObject(int objectId, const AABB& newAABB, const Vector3& displacement, bool forceReinsert) {
+
+    RP3D_PROFILE("SweepAndPrune::updateObject()", mProfiler);
+
+    assert(objectId >= 0 && objectId < static_cast<int>(mObjects.size()));
+    assert(mObjects[objectId].isUsed);
+
+    SortedBox& box = mBoxes[mObjects[objectId].index];
+
+    // If the new AABB is still inside the fat AABB of the object
+    if (!forceReinsert && box.aabb.contains(newAABB)) {
+        return false;
+    }
+
+    box.aabb = computeFatAABB(newAABB, displacement);
+    mIsSorted = false;
+
+    return true;
+}
+
+// Choose the sweep axis with the largest spread of the box centers
+/// The axis is only changed if its spread is significantly larger than the
+/// spread along the current axis to avoid sorting the whole array too often.
+void SweepAndPrune::updateSweepAxis() {
+
+    const uint nbBoxes = static_cast<uint>(mBoxes.size());
+    if (nbBoxes < 2) return;
+
+    Vector3 sum(0, 0, 0);
+    Vector3 sumSquares(0, 0, 0);
+    for (uint i=0; i < nbBoxes; i++) {
+        const Vector3 center = (mBoxes[i].aabb.getMin() + mBoxes[i].aabb.getMax()) * decimal(0.5);
+        sum += center;
+        sumSquares += Vector3(center.x * center.x, center.y * center.y, center.z * center.z);
+    }
+
+    const decimal invNbBoxes = decimal(1.0) / decimal(nbBoxes);
+    const Vector3 mean = sum * invNbBoxes;
+    const Vector3 variance = sumSquares * invNbBoxes - Vector3(mean.x * mean.x, mean.y * mean.y, mean.z * mean.z);
+
+    const int largestAxis = variance.getMaxAxis();
+    if (largestAxis != mSweepAxis && variance[largestAxis] > decimal(1.5) * variance[mSweepAxis]) {
+        mSweepAxis = largestAxis;
+        mIsSorted = false;
+    }
+}
+
+// Sort the array of boxes along the sweep axis
+/// Since the objects only move a little bit between two frames, the array is almost sorted
+/// and an insertion sort is used. If the insertion sort needs too many element shifts (after
+/// many objects have been added or after a change of the sweep axis), the array is sorted
+/// with a standard sort instead. Nothing is done if no fat AABB has changed since the last sort.
+void SweepAndPrune::sortBoxes() {
+
+    if (mIsSorted) return;
+
+    RP3D_PROFILE("SweepAndPrune::sortBoxes()", mProfiler);
+
+    updateSweepAxis();
+
+    const int axis = mSweepAxis;
+    const uint nbBoxes = static_cast<uint>(mBoxes.size());
+    const uint64 maxNbShifts = uint64(MAX_NB_INSERTION_SHIFTS_PER_OBJECT) * nbBoxes;
+    uint64 nbShifts = 0;
+
+    for (uint i=1; i < nbBoxes; i++) {
+
+        const SortedBox box = mBoxes[i];
+        const decimal minCoordinate = box.aabb.getMin()[axis];
+
+        uint j = i;
+        while (j > 0 && mBoxes[j - 1].aabb.getMin()[axis] > minCoordinate) {
+            mBoxes[j] = mBoxes[j - 1];
+            j--;
+        }
+        mBoxes[j] = box;
+
+        nbShifts += i - j;
+        if (nbShifts > maxNbShifts) {
+
+            SortedBox* boxes = &(mBoxes[0]);
+            std::sort(boxes, boxes + nbBoxes, [axis](const SortedBox& box1, const SortedBox& box2) {
+                return box1.aabb.getMin()[axis] < box2.aabb.getMin()[axis];
+            });
+
+            break;
+        }
+    }
+
+    // Update the indices of the boxes of the objects and the max coordinate prefixes
+    decimal maxCoordinatePrefix = -DECIMAL_LARGEST;
+    for (uint i=0; i < nbBoxes; i++) {
+        mObjects[mBoxes[i].objectId].index = static_cast<int32>(i);
+        maxCoordinatePrefix = std::max(maxCoordinatePrefix, mBoxes[i].aabb.getMax()[axis]);
+        mBoxes[i].maxCoordinatePrefix = maxCoordinatePrefix;
+    }
+
+    mIsSorted = true;
+}
+
+// Return the index of the first box that starts after a given coordinate along the sweep axis
+/// The array of boxes must be sorted. The number of boxes is returned if no box starts after
+/// the coordinate.
+uint SweepAndPrune::findFirstBoxStartingAfter(decimal coordinate) const {
+
+    assert(mIsSorted);
+
+    uint first = 0;
+    uint last = static_cast<uint>(mBoxes.size());
+    while (first < last) {
+        const uint middle = first + (last - first) / 2;
+        if (mBoxes[middle].aabb.getMin()[mSweepAxis] <= coordinate) {
+            first = middle + 1;
+        }
+        else {
+            last = middle;
+        }
+    }
+
+    return first;
+}
+
+// Report all the overlapping pairs of objects with at least one moved object
+/// The array of boxes is sorted first. Then, the whole array is swept if most of the objects
+/// have moved and only the boxes of the moved objects are swept otherwise. Each pair is
+/// reported once.
+void SweepAndPrune::reportOverlappingPairs(const DenseIntegerSet& movedObjects,
+                                           DynamicAABBTreeOverlapPairCallback& callback) {
+
+    RP3D_PROFILE("SweepAndPrune::reportOverlappingPairs()", mProfiler);
+
+    // Flag the boxes of the moved objects
+    for (int i=0; i < movedObjects.size(); i++) {
+        const int objectId = movedObjects[i];
+        mBoxes[mObjects[objectId].index].isMoved = true;
+    }
+
+    sortBoxes();
+
+    const uint nbMovedObjects = static_cast<uint>(movedObjects.size());
+    if (nbMovedObjects * FULL_SWEEP_MOVED_OBJECTS_RATIO > mBoxes.size()) {
+        reportAllOverlappingPairs(callback);
+    }
+    else {
+        reportMovedOverlappingPairs(movedObjects, callback);
+    }
+}
+
+// Report all the overlapping pairs by sweeping the whole array
+/// A single sweep along the sweep axis finds all the pairs of boxes that overlap. The pairs
+/// of objects that have not moved are skipped. The moved flags of the boxes are cleared.
+void SweepAndPrune::reportAllOverlappingPairs(DynamicAABBTreeOverlapPairCallback& callback) {
+
+    const int axis = mSweepAxis;
+    const int axis1 = (axis + 1) % 3;
+    const int axis2 = (axis + 2) % 3;
+    const uint nbBoxes = static_cast<uint>(mBoxes.size());
+
+    for (uint i=0; i < nbBoxes; i++) {
+
+        SortedBox& box1 = mBoxes[i];
+        const Vector3& min1 = box1.aabb.getMin();
+        const Vector3& max1 = box1.aabb.getMax();
+
+        // For each box that starts before the end of the current box along the sweep axis
+        for (uint j=i+1; j < nbBoxes && mBoxes[j].aabb.getMin()[axis] <= max1[axis]; j++) {
+
+            const SortedBox& box2 = mBoxes[j];
+
+            // The pairs of objects that have not moved have already been reported
+            if (!box1.isMoved && !box2.isMoved) continue;
+
+            const Vector3& min2 = box2.aabb.getMin();
+            const Vector3& max2 = box2.aabb.getMax();
+
+            if (max1[axis1] < min2[axis1] || max2[axis1] < min1[axis1] ||
+                max1[axis2] < min2[axis2] || max2[axis2] < min1[axis2]) continue;
+
+            callback.notifyOverlappingPair(box1.objectId, box2.objectId);
+        }
+
+        // The flag is not needed anymore for the next boxes
+        box1.isMoved = false;
+    }
+}
+
+// Report all the overlapping pairs by sweeping only the boxes of the moved objects
+/// For each moved box, the boxes after it are scanned until they start after its end and
+/// the boxes before it are scanned until the largest max coordinate before them is smaller
+/// than its start. A pair of two moved boxes is only reported by the scan of the first box
+/// of the pair in the array. The moved flags of the boxes are cleared.
+void SweepAndPrune::reportMovedOverlappingPairs(const DenseIntegerSet& movedObjects,
+                                                DynamicAABBTreeOverlapPairCallback& callback) {
+
+    const int axis = mSweepAxis;
+    const int axis1 = (axis + 1) % 3;
+    const int axis2 = (axis + 2) % 3;
+    const uint nbBoxes = static_cast<uint>(mBoxes.size());
+
+    for (int i=0; i < movedObjects.size(); i++) {
+
+        const uint index = static_cast<uint>(mObjects[movedObjects[i]].index);
+        const SortedBox& box1 = mBoxes[index];
+        const Vector3& min1 = box1.aabb.getMin();
+        const Vector3& max1 = box1.aabb.getMax();
+
+        // For each box after the current box that starts before its end along the sweep axis
+        for (uint j=index+1; j < nbBoxes && mBoxes[j].aabb.getMin()[axis] <= max1[axis]; j++) {
+
+            const Vector3& min2 = mBoxes[j].aabb.getMin();
+            const Vector3& max2 = mBoxes[j].aabb.getMax();
+
+            if (max1[axis1] < min2[axis1] || max2[axis1] < min1[axis1] ||
+                max1[axis2] < min2[axis2] || max2[axis2] < min1[axis2]) continue;
+
+            callback.notifyOverlappingPair(box1.objectId, mBoxes[j].objectId);
+        }
+
+        // For each box before the current box while a box before can end after its start
+        for (uint j=index; j > 0 && mBoxes[j - 1].maxCoordinatePrefix >= min1[axis]; j--) {
+
+            const SortedBox& box2 = mBoxes[j - 1];
+
+            // The pairs with a moved box before the current one are reported by this box
+            if (box2.isMoved) continue;
+
+            const Vector3& min2 = box2.aabb.getMin();
+            const Vector3& max2 = box2.aabb.getMax();
+
+            if (max2[axis] < min1[axis] ||
+                max1[axis1] < min2[axis1] || max2[axis1] < min1[axis1] ||
+                max1[axis2] < min2[axis2] || max2[axis2] < min1[axis2]) continue;
+
+            callback.notifyOverlappingPair(box2.objectId, box1.objectId);
+        }
+    }
+
+    for (int i=0; i < movedObjects.size(); i++) {
+        mBoxes[mObjects[movedObjects[i]].index].isMoved = false;
+    }
+}
+
+// Report all the objects overlapping with the AABB given in parameter
+void SweepAndPrune::reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback) const {
+
+    RP3D_PROFILE("SweepAndPrune::reportAllShapesOverlappingWithAABB()", mProfiler);
+
+    // If the array is sorted, only the boxes that start before the end of the AABB and that
+    // can end after its start are tested. Otherwise, all the boxes are tested.
+    uint endIndex = static_cast<uint>(mBoxes.size());
+    decimal minCoordinate = -DECIMAL_LARGEST;
+    if (mIsSorted) {
+        endIndex = findFirstBoxStartingAfter(aabb.getMax()[mSweepAxis]);
+        minCoordinate = aabb.getMin()[mSweepAxis];
+    }
+
+    for (uint i=endIndex; i > 0 && mBoxes[i - 1].maxCoordinatePrefix >= minCoordinate; i--) {
+
+        if (mBoxes[i - 1].aabb.testCollision(aabb)) {
+            callback.notifyOverlappingNode(mBoxes[i - 1].objectId);
+        }
+    }
+}
+
+// Ray casting method
+/// The ray is tested against the fat AABBs of the objects. If the array is sorted, only the
+/// boxes that overlap with the ray segment along the sweep axis are tested.
+void SweepAndPrune::raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const {
+
+    RP3D_PROFILE("SweepAndPrune::raycast()", mProfiler);
+
+    decimal maxFraction = ray.maxFraction;
+
+    uint endIndex = static_cast<uint>(mBoxes.size());
+    decimal minCoordinate = -DECIMAL_LARGEST;
+    if (mIsSorted) {
+        const decimal coordinate1 = ray.point1[mSweepAxis];
+        const decimal coordinate2 = ray.point1[mSweepAxis] + maxFraction * (ray.point2[mSweepAxis] - ray.point1[mSweepAxis]);
+        endIndex = findFirstBoxStartingAfter(std::max(coordinate1, coordinate2));
+        minCoordinate = std::min(coordinate1, coordinate2);
+    }
+
+    for (uint i=endIndex; i > 0 && mBoxes[i - 1].maxCoordinatePrefix >= minCoordinate; i--) {
+
+        Ray rayTemp(ray.point1, ray.point2, maxFraction);
+
+        // Test if the ray intersects with the AABB of the object
+        if (!mBoxes[i - 1].aabb.testRayIntersect(rayTemp)) continue;
+
+        // Call the callback that will raycast again the broad-phase shape
+        decimal hitFraction = callback.raycastBroadPhaseShape(mBoxes[i - 1].objectId, rayTemp);
+
+        // If the user returned a hitFraction of zero, it means that
+        // the raycasting should stop here
+        if (hitFraction == decimal(0.0)) {
+            return;
+        }
+
+        // If the user returned a positive fraction, we update the maxFraction value
+        if (hitFraction > decimal(0.0) && hitFraction < maxFraction) {
+            maxFraction = hitFraction;
+        }
+    }
+}
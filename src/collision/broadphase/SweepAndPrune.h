@@ -0,0 +1,262 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_SWEEP_AND_PRUNE_H
+#define REACTPHYSICS3D_SWEEP_AND_PRUNE_H
+
+// Libraries
+#include "configuration.h"
+#include "collision/shapes/AABB.h"
+#include "containers/List.h"
+
+/// Namespace ReactPhysics3D
+namespace reactphysics3d {
+
+// Declarations
+class DynamicAABBTreeOverlapCallback;
+class DynamicAABBTreeOverlapPairCallback;
+class DynamicAABBTreeRaycastCallback;
+class DenseIntegerSet;
+class MemoryAllocator;
+class Profiler;
+
+// Class SweepAndPrune
+/**
+ * This class implements a sweep-and-prune structure for the broad-phase collision
+ * detection. The fat AABBs of the objects are kept in a persistent array that is sorted
+ * along a sweep axis by the min coordinates of the boxes. Each box also stores the
+ * largest max coordinate of itself and of all the boxes before it in the array. Because
+ * the objects only move a little bit between two frames, the array stays almost sorted
+ * and is sorted again with an insertion sort when some fat AABBs have changed. Removing
+ * an object keeps the array sorted.
+ * When most of the objects have moved, the overlapping pairs are found with a single
+ * sweep over the whole array. Otherwise, only the boxes of the moved objects are swept:
+ * the boxes after a moved box are scanned until they start after its end and the boxes
+ * before it are scanned until the largest max coordinate stored in the array is before
+ * its start. A very large object (like a ground plane at the start of the array) makes
+ * these backward scans longer.
+ * The AABB queries and the ray casting use the same backward scan from the last box that
+ * starts before the end of the query. They are linear scans over all the boxes when the
+ * array is not sorted, that is when an object has been added or moved since the last
+ * computation of the overlapping pairs.
+ * The sweep axis is the axis with the largest spread of the centers of the objects.
+ */
+class SweepAndPrune {
+
+    private:
+
+        // -------------------- Constants -------------------- //
+
+        /// Maximum average number of element shifts per object of the insertion sort. Above
+        /// that number, the array is sorted with a standard sort instead.
+        static const uint MAX_NB_INSERTION_SHIFTS_PER_OBJECT = 8;
+
+        /// The whole array is swept to find the overlapping pairs if more than one object
+        /// out of this number has moved. Otherwise, only the boxes of the moved objects are swept.
+        static const uint FULL_SWEEP_MOVED_OBJECTS_RATIO = 4;
+
+        // -------------------- Internal Classes -------------------- //
+
+        // Structure SortedBox
+        /**
+         * Fat AABB of an object in the array sorted along the sweep axis
+         */
+        struct SortedBox {
+
+            public :
+
+                /// Fat AABB of the object
+                AABB aabb;
+
+                /// Largest max coordinate along the sweep axis of this box and of all the
+                /// boxes before it in the array (it can be larger after a removal)
+                decimal maxCoordinatePrefix;
+
+                /// ID of the object
+                int32 objectId;
+
+                /// True if the object has moved during the last frame
+                bool isMoved;
+        };
+
+        // Structure SweepAndPruneObject
+        /**
+         * Object of the sweep-and-prune structure
+         */
+        struct SweepAndPruneObject {
+
+            public :
+
+                /// Pointer to the data of the object
+                void* data;
+
+                /// Index of the box of the object in the sorted array (or
+                /// ID of the next free object if the object is free)
+                int32 index;
+
+                /// True if the object is in use
+                bool isUsed;
+        };
+
+        // -------------------- Attributes -------------------- //
+
+        /// Boxes of the objects sorted along the sweep axis
+        List<SortedBox> mBoxes;
+
+        /// Objects indexed by their ID
+        List<SweepAndPruneObject> mObjects;
+
+        /// ID of the first free object
+        int32 mFreeObjectId;
+
+        /// Index (0, 1 or 2) of the sweep axis
+        int mSweepAxis;
+
+        /// True if the array of boxes is sorted along the sweep axis
+        bool mIsSorted;
+
+        /// Extra AABB Gap used to allow the collision shape to move a little bit
+        /// without updating the structure
+        decimal mExtraAABBGap;
+
+#ifdef IS_PROFILING_ACTIVE
+
+        /// Pointer to the profiler
+        Profiler* mProfiler;
+
+#endif
+
+        // -------------------- Methods -------------------- //
+
+        /// Compute the fat AABB of an object from its AABB and its displacement
+        AABB computeFatAABB(const AABB& aabb, const Vector3& displacement) const;
+
+        /// Sort the array of boxes along the sweep axis
+        void sortBoxes();
+
+        /// Choose the sweep axis with the largest spread of the box centers
+        void updateSweepAxis();
+
+        /// Return the index of the first box that starts after a given coordinate along the sweep axis
+        uint findFirstBoxStartingAfter(decimal coordinate) const;
+
+        /// Report all the overlapping pairs by sweeping the whole array
+        void reportAllOverlappingPairs(DynamicAABBTreeOverlapPairCallback& callback);
+
+        /// Report all the overlapping pairs by sweeping only the boxes of the moved objects
+        void reportMovedOverlappingPairs(const DenseIntegerSet& movedObjects,
+                                         DynamicAABBTreeOverlapPairCallback& callback);
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        SweepAndPrune(MemoryAllocator& allocator, decimal extraAABBGap = decimal(0.0));
+
+        /// Destructor
+        ~SweepAndPrune() = default;
+
+        /// Deleted copy-constructor
+        SweepAndPrune(const SweepAndPrune& sweepAndPrune) = delete;
+
+        /// Deleted assignment operator
+        SweepAndPrune& operator=(const SweepAndPrune& sweepAndPrune) = delete;
+
+        /// Add an object and return its ID
+        int addObject(const AABB& aabb, void* data);
+
+        /// Remove an object
+        void removeObject(int objectId);
+
+        /// Update the fat AABB of an object after it has moved
+        bool updateObject(int objectId, const AABB& newAABB, const Vector3& displacement, bool forceReinsert = false);
+
+        /// Return the fat AABB of a given object
+        const AABB& getFatAABB(int objectId) const;
+
+        /// Return the data pointer of a given object
+        void* getObjectDataPointer(int objectId) const;
+
+        /// Return the number of objects
+        int getNbObjects() const;
+
+        /// Return the index of the sweep axis
+        int getSweepAxis() const;
+
+        /// Report all the objects overlapping with the AABB given in parameter
+        void reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback) const;
+
+        /// Report all the overlapping pairs of objects with at least one moved object
+        void reportOverlappingPairs(const DenseIntegerSet& movedObjects, DynamicAABBTreeOverlapPairCallback& callback);
+
+        /// Ray casting method
+        void raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const;
+
+#ifdef IS_PROFILING_ACTIVE
+
+        /// Set the profiler
+        void setProfiler(Profiler* profiler);
+
+#endif
+
+};
+
+// Return the fat AABB of a given object
+inline const AABB& SweepAndPrune::getFatAABB(int objectId) const {
+    assert(objectId >= 0 && objectId < static_cast<int>(mObjects.size()));
+    assert(mObjects[objectId].isUsed);
+    return mBoxes[mObjects[objectId].index].aabb;
+}
+
+// Return the data pointer of a given object
+inline void* SweepAndPrune::getObjectDataPointer(int objectId) const {
+    assert(objectId >= 0 && objectId < static_cast<int>(mObjects.size()));
+    assert(mObjects[objectId].isUsed);
+    return mObjects[objectId].data;
+}
+
+// Return the number of objects
+inline int SweepAndPrune::getNbObjects() const {
+    return static_cast<int>(mBoxes.size());
+}
+
+// Return the index of the sweep axis
+inline int SweepAndPrune::getSweepAxis() const {
+    return mSweepAxis;
+}
+
+#ifdef IS_PROFILING_ACTIVE
+
+// Set the profiler
+inline void SweepAndPrune::setProfiler(Profiler* profiler) {
+    mProfiler = profiler;
+}
+
+#endif
+
+}
+
+#endif
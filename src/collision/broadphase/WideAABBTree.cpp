@@ -0,0 +1,473 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "WideAABBTree.h"
+#include "DynamicAABBTree.h"
+#include "containers/Stack.h"
+#include "memory/MemoryAllocator.h"
+#include "utils/Profiler.h"
+#include "mathematics/mathematics_functions.h"
+#include <cfloat>
+
+// Use the SSE instructions to test the four children of a node at once when they are available
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define RP3D_WIDE_TREE_USE_SSE
+    #include <xmmintrin.h>
+#endif
+
+using namespace reactphysics3d;
+
+// Internal binary node of the dynamic AABB tree to convert into a node of the wide tree
+struct WideTreeBuildEntry {
+
+    /// ID of the internal node in the dynamic AABB tree
+    int32 binaryNodeId;
+
+    /// Index of the parent node in the wide tree (-1 for the root)
+    int32 parentIndex;
+
+    /// Slot of the node in the children of its parent
+    int32 slot;
+
+    /// Constructor
+    WideTreeBuildEntry() = default;
+
+    /// Constructor
+    WideTreeBuildEntry(int32 nodeId, int32 parent, int32 childSlot)
+        : binaryNodeId(nodeId), parentIndex(parent), slot(childSlot) {
+
+    }
+};
+
+// Return the index of the lowest bit set in a non-zero mask of children
+static inline int lowestBitIndex(int mask) {
+    assert(mask != 0);
+    int index = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+}
+
+// Test the AABBs of the four children of a node against an AABB
+/// The bit i of the returned mask is set if the AABB of the child i overlaps the AABB
+/// (with single precision coordinates) given in parameter.
+static inline int testChildrenOverlap(const WideTreeNode& node, const float* aabbMin, const float* aabbMax) {
+
+#ifdef RP3D_WIDE_TREE_USE_SSE
+
+    __m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_set1_ps(aabbMin[0]), _mm_loadu_ps(node.maxX)),
+                                _mm_cmpge_ps(_mm_set1_ps(aabbMax[0]), _mm_loadu_ps(node.minX)));
+    overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_set1_ps(aabbMin[1]), _mm_loadu_ps(node.maxY)));
+    overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_set1_ps(aabbMax[1]), _mm_loadu_ps(node.minY)));
+    overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_set1_ps(aabbMin[2]), _mm_loadu_ps(node.maxZ)));
+    overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_set1_ps(aabbMax[2]), _mm_loadu_ps(node.minZ)));
+
+    return _mm_movemask_ps(overlap);
+
+#else
+
+    int mask = 0;
+    for (int i=0; i < WideTreeNode::NB_CHILDREN; i++) {
+        if (aabbMin[0] <= node.maxX[i] && aabbMax[0] >= node.minX[i] &&
+            aabbMin[1] <= node.maxY[i] && aabbMax[1] >= node.minY[i] &&
+            aabbMin[2] <= node.maxZ[i] && aabbMax[2] >= node.minZ[i]) {
+            mask |= 1 << i;
+        }
+    }
+
+    return mask;
+
+#endif
+}
+
+// Test the AABBs of the four children of a node against a ray with the slab test
+/// The ray is given by its origin, the inverse of its direction and its maximum fraction.
+/// The bit i of the returned mask is set if the ray hits the AABB of the child i and the
+/// entry fractions of the ray into the AABBs are written into the "outMinFractions" array.
+static inline int testChildrenRay(const WideTreeNode& node, const float* origin, const float* invDirection,
+                                  float maxFraction, float* outMinFractions) {
+
+#ifdef RP3D_WIDE_TREE_USE_SSE
+
+    const __m128 originX = _mm_set1_ps(origin[0]);
+    const __m128 originY = _mm_set1_ps(origin[1]);
+    const __m128 originZ = _mm_set1_ps(origin[2]);
+    const __m128 invDirectionX = _mm_set1_ps(invDirection[0]);
+    const __m128 invDirectionY = _mm_set1_ps(invDirection[1]);
+    const __m128 invDirectionZ = _mm_set1_ps(invDirection[2]);
+
+    const __m128 t1X = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), originX), invDirectionX);
+    const __m128 t2X = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), originX), invDirectionX);
+    const __m128 t1Y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), originY), invDirectionY);
+    const __m128 t2Y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), originY), invDirectionY);
+    const __m128 t1Z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), originZ), invDirectionZ);
+    const __m128 t2Z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), originZ), invDirectionZ);
+
+    __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1X, t2X), _mm_min_ps(t1Y, t2Y)),
+                             _mm_max_ps(_mm_min_ps(t1Z, t2Z), _mm_setzero_ps()));
+    const __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1X, t2X), _mm_max_ps(t1Y, t2Y)),
+                                   _mm_min_ps(_mm_max_ps(t1Z, t2Z), _mm_set1_ps(maxFraction)));
+
+    _mm_storeu_ps(outMinFractions, tMin);
+
+    return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+
+#else
+
+    int mask = 0;
+    for (int i=0; i < WideTreeNode::NB_CHILDREN; i++) {
+
+        const float t1X = (node.minX[i] - origin[0]) * invDirection[0];
+        const float t2X = (node.maxX[i] - origin[0]) * invDirection[0];
+        const float t1Y = (node.minY[i] - origin[1]) * invDirection[1];
+        const float t2Y = (node.maxY[i] - origin[1]) * invDirection[1];
+        const float t1Z = (node.minZ[i] - origin[2]) * invDirection[2];
+        const float t2Z = (node.maxZ[i] - origin[2]) * invDirection[2];
+
+        const float tMin = std::max(std::max(std::min(t1X, t2X), std::min(t1Y, t2Y)),
+                                    std::max(std::min(t1Z, t2Z), 0.0f));
+        const float tMax = std::min(std::min(std::max(t1X, t2X), std::max(t1Y, t2Y)),
+                                    std::min(std::max(t1Z, t2Z), maxFraction));
+
+        outMinFractions[i] = tMin;
+        if (tMin <= tMax) {
+            mask |= 1 << i;
+        }
+    }
+
+    return mask;
+
+#endif
+}
+
+// Constructor
+WideAABBTree::WideAABBTree(MemoryAllocator& allocator)
+             : mAllocator(allocator), mTree(nullptr), mNodes(nullptr), mNbNodes(0), mNbAllocatedNodes(0) {
+
+#ifdef IS_PROFILING_ACTIVE
+
+    mProfiler = nullptr;
+
+#endif
+
+}
+
+// Destructor
+WideAABBTree::~WideAABBTree() {
+
+    if (mNodes != nullptr) {
+        mAllocator.release(mNodes, mNbAllocatedNodes * sizeof(WideTreeNode));
+    }
+}
+
+// Remove all the nodes of the tree
+void WideAABBTree::clear() {
+    mNbNodes = 0;
+    mTree = nullptr;
+}
+
+// Add a new node with empty slots and return its index
+int WideAABBTree::addNode() {
+
+    assert(mNbNodes < mNbAllocatedNodes);
+
+    WideTreeNode& node = mNodes[mNbNodes];
+
+    // The AABBs of the empty slots cannot overlap anything
+    for (int i=0; i < WideTreeNode::NB_CHILDREN; i++) {
+        node.minX[i] = FLT_MAX;
+        node.minY[i] = FLT_MAX;
+        node.minZ[i] = FLT_MAX;
+        node.maxX[i] = -FLT_MAX;
+        node.maxY[i] = -FLT_MAX;
+        node.maxZ[i] = -FLT_MAX;
+        node.children[i] = WideTreeNode::NULL_CHILD;
+    }
+
+    mNbNodes++;
+
+    return mNbNodes - 1;
+}
+
+// Set the AABB of a child of a node
+/// The coordinates are rounded outwards such that the AABB of the node always contains
+/// the AABB in parameter.
+void WideAABBTree::setChildAABB(int nodeIndex, int slot, const AABB& aabb) {
+
+    WideTreeNode& node = mNodes[nodeIndex];
+    node.minX[slot] = roundDownToFloat(aabb.getMin().x);
+    node.minY[slot] = roundDownToFloat(aabb.getMin().y);
+    node.minZ[slot] = roundDownToFloat(aabb.getMin().z);
+    node.maxX[slot] = roundUpToFloat(aabb.getMax().x);
+    node.maxY[slot] = roundUpToFloat(aabb.getMax().y);
+    node.maxZ[slot] = roundUpToFloat(aabb.getMax().z);
+}
+
+// Build the wide tree from a dynamic AABB tree
+/// The children of a node of the wide tree are found by expanding the internal node with
+/// the largest surface area among the children of a node of the binary tree until there are
+/// four children. The nodes are stored in depth-first order. The dynamic AABB tree must not
+/// be destroyed while the wide tree is used.
+void WideAABBTree::build(const DynamicAABBTree& tree) {
+
+    RP3D_PROFILE("WideAABBTree::build()", mProfiler);
+
+    clear();
+    mTree = &tree;
+
+    if (tree.mRootNodeID == TreeNode::NULL_TREE_NODE) return;
+
+    // There are at most as many nodes in the wide tree as internal nodes in the binary tree
+    const int nbRequiredNodes = std::max(1, (tree.mNbNodes - 1) / 2);
+    if (nbRequiredNodes > mNbAllocatedNodes) {
+        if (mNodes != nullptr) {
+            mAllocator.release(mNodes, mNbAllocatedNodes * sizeof(WideTreeNode));
+        }
+        mNbAllocatedNodes = nbRequiredNodes;
+        mNodes = static_cast<WideTreeNode*>(mAllocator.allocate(mNbAllocatedNodes * sizeof(WideTreeNode)));
+        assert(mNodes != nullptr);
+    }
+
+    const TreeNode* binaryNodes = tree.mNodes;
+
+    // If the binary tree has a single leaf
+    if (binaryNodes[tree.mRootNodeID].isLeaf()) {
+        const int rootIndex = addNode();
+        setChildAABB(rootIndex, 0, binaryNodes[tree.mRootNodeID].aabb);
+        mNodes[rootIndex].children[0] = WideTreeNode::encodeLeaf(tree.mRootNodeID);
+        return;
+    }
+
+    // Stack of the internal binary nodes with the index of the parent wide node and the slot in this parent
+    Stack<WideTreeBuildEntry, 64> stack(mAllocator);
+    stack.push(WideTreeBuildEntry(tree.mRootNodeID, -1, 0));
+
+    while (stack.getNbElements() > 0) {
+
+        const WideTreeBuildEntry entry = stack.pop();
+        const int binaryNodeId = entry.binaryNodeId;
+
+        const int nodeIndex = addNode();
+        if (entry.parentIndex != -1) {
+            mNodes[entry.parentIndex].children[entry.slot] = nodeIndex;
+        }
+
+        // Collapse the binary subtree into up to four children
+        int childrenIds[WideTreeNode::NB_CHILDREN];
+        childrenIds[0] = binaryNodes[binaryNodeId].children[0];
+        childrenIds[1] = binaryNodes[binaryNodeId].children[1];
+        int nbChildren = 2;
+        while (nbChildren < WideTreeNode::NB_CHILDREN) {
+
+            // Find the internal child with the largest surface area
+            int largestChild = -1;
+            decimal largestArea = decimal(-1.0);
+            for (int i=0; i < nbChildren; i++) {
+                const TreeNode& child = binaryNodes[childrenIds[i]];
+                if (!child.isLeaf() && child.aabb.getSurfaceArea() > largestArea) {
+                    largestArea = child.aabb.getSurfaceArea();
+                    largestChild = i;
+                }
+            }
+
+            if (largestChild == -1) break;
+
+            // Replace it with its two children
+            const int expandedNodeId = childrenIds[largestChild];
+            childrenIds[largestChild] = binaryNodes[expandedNodeId].children[0];
+            childrenIds[nbChildren] = binaryNodes[expandedNodeId].children[1];
+            nbChildren++;
+        }
+
+        for (int i=0; i < nbChildren; i++) {
+
+            const TreeNode& child = binaryNodes[childrenIds[i]];
+            setChildAABB(nodeIndex, i, child.aabb);
+            if (child.isLeaf()) {
+                mNodes[nodeIndex].children[i] = WideTreeNode::encodeLeaf(childrenIds[i]);
+            }
+        }
+
+        // Push the internal children such that the first one is built first
+        for (int i=nbChildren - 1; i >= 0; i--) {
+            if (!binaryNodes[childrenIds[i]].isLeaf()) {
+                stack.push(WideTreeBuildEntry(childrenIds[i], nodeIndex, i));
+            }
+        }
+    }
+
+    assert(mNbNodes <= mNbAllocatedNodes);
+}
+
+// Report all shapes overlapping with the AABB given in parameter.
+void WideAABBTree::reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback) const {
+    reportAllShapesOverlappingWithAABB(aabb, callback, mAllocator);
+}
+
+// Report all shapes overlapping with the AABB given in parameter using a given allocator.
+/// The reported node IDs are the IDs of the leaves in the dynamic AABB tree. The leaves are
+/// exactly tested with the AABBs of the dynamic AABB tree and therefore, the same leaves as with
+/// DynamicAABBTree::reportAllShapesOverlappingWithAABB() are reported (maybe in another order).
+/// The tree is not modified by this method and it can be called concurrently by several
+/// threads if each one uses a thread-safe allocator.
+void WideAABBTree::reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback,
+                                                      MemoryAllocator& allocator) const {
+
+    if (mNbNodes == 0) return;
+
+    const float aabbMin[3] = {roundDownToFloat(aabb.getMin().x), roundDownToFloat(aabb.getMin().y), roundDownToFloat(aabb.getMin().z)};
+    const float aabbMax[3] = {roundUpToFloat(aabb.getMax().x), roundUpToFloat(aabb.getMax().y), roundUpToFloat(aabb.getMax().z)};
+
+    // Create a stack with the nodes to visit
+    Stack<int, 64> stack(allocator);
+    stack.push(0);
+
+    // While there are still nodes to visit
+    while (stack.getNbElements() > 0) {
+
+        const WideTreeNode& node = mNodes[stack.pop()];
+
+        // Test the four children at once
+        int mask = testChildrenOverlap(node, aabbMin, aabbMax);
+
+        while (mask != 0) {
+
+            const int slot = lowestBitIndex(mask);
+            mask &= mask - 1;
+
+            const int32 child = node.children[slot];
+            if (child == WideTreeNode::NULL_CHILD) continue;
+
+            // If the child is a node, we need to visit it
+            if (child >= 0) {
+                stack.push(child);
+            }
+            else {  // If the child is a leaf
+
+                const int32 leafNodeId = WideTreeNode::decodeLeaf(child);
+
+                // Notify the overlapping leaf if its exact AABB overlaps
+                if (aabb.testCollision(mTree->getFatAABB(leafNodeId))) {
+                    callback.notifyOverlappingNode(leafNodeId);
+                }
+            }
+        }
+    }
+}
+
+// Ray casting method
+/// The children nodes hit by the ray are visited from the closest one to the farthest one
+/// such that the ray is clipped as early as possible by the hits reported by the callback.
+/// The leaves are tested exactly with the AABBs of the dynamic AABB tree before the callback
+/// is called, like in DynamicAABBTree::raycast().
+void WideAABBTree::raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const {
+
+    RP3D_PROFILE("WideAABBTree::raycast()", mProfiler);
+
+    if (mNbNodes == 0) return;
+
+    // Origin and inverse direction of the ray for the slab tests
+    float origin[3];
+    float invDirection[3];
+    computeFloatRaySlabData(ray.point1, ray.point2, origin, invDirection);
+
+    decimal maxFraction = ray.maxFraction;
+
+    Stack<int, 64> stack(mAllocator);
+    stack.push(0);
+
+    while (stack.getNbElements() > 0) {
+
+        const WideTreeNode& node = mNodes[stack.pop()];
+
+        // Test the ray against the four children at once (with a small margin for the rounding errors)
+        float minFractions[WideTreeNode::NB_CHILDREN];
+        int mask = testChildrenRay(node, origin, invDirection, computeFloatRayMaxFraction(maxFraction),
+                                   minFractions);
+
+        // Children nodes hit by the ray
+        int hitNodes[WideTreeNode::NB_CHILDREN];
+        float hitNodesFractions[WideTreeNode::NB_CHILDREN];
+        int nbHitNodes = 0;
+
+        while (mask != 0) {
+
+            const int slot = lowestBitIndex(mask);
+            mask &= mask - 1;
+
+            const int32 child = node.children[slot];
+
+            // The slab test does not reject the inverted AABBs of the empty slots
+            if (child == WideTreeNode::NULL_CHILD) continue;
+
+            if (child >= 0) {
+
+                // Insert the node such that the nodes are sorted by decreasing entry fractions
+                int i = nbHitNodes;
+                while (i > 0 && hitNodesFractions[i - 1] < minFractions[slot]) {
+                    hitNodes[i] = hitNodes[i - 1];
+                    hitNodesFractions[i] = hitNodesFractions[i - 1];
+                    i--;
+                }
+                hitNodes[i] = child;
+                hitNodesFractions[i] = minFractions[slot];
+                nbHitNodes++;
+            }
+            else {
+
+                const int32 leafNodeId = WideTreeNode::decodeLeaf(child);
+
+                // Test the ray exactly against the AABB of the leaf in the dynamic AABB tree
+                const Ray rayTemp(ray.point1, ray.point2, maxFraction);
+                if (!mTree->getFatAABB(leafNodeId).testRayIntersect(rayTemp)) continue;
+
+                // Call the callback that will raycast again the broad-phase shape
+                decimal hitFraction = callback.raycastBroadPhaseShape(leafNodeId, rayTemp);
+
+                // If the user returned a hitFraction of zero, it means that
+                // the raycasting should stop here
+                if (hitFraction == decimal(0.0)) {
+                    return;
+                }
+
+                // If the user returned a positive fraction, we update the maxFraction value
+                if (hitFraction > decimal(0.0) && hitFraction < maxFraction) {
+                    maxFraction = hitFraction;
+                }
+
+                // If the user returned a negative fraction, we continue
+                // the raycasting as if the proxy shape did not exist
+            }
+        }
+
+        // Push the hit nodes such that the closest one is visited first
+        for (int i=0; i < nbHitNodes; i++) {
+            stack.push(hitNodes[i]);
+        }
+    }
+}
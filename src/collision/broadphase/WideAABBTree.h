@@ -0,0 +1,206 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_WIDE_AABB_TREE_H
+#define REACTPHYSICS3D_WIDE_AABB_TREE_H
+
+// Libraries
+#include "configuration.h"
+#include "collision/shapes/AABB.h"
+
+/// Namespace ReactPhysics3D
+namespace reactphysics3d {
+
+// Declarations
+class DynamicAABBTree;
+class DynamicAABBTreeOverlapCallback;
+class DynamicAABBTreeRaycastCallback;
+class MemoryAllocator;
+class Profiler;
+
+// Structure WideTreeNode
+/**
+ * This structure represents a node of the wide AABB tree. A node has up to four
+ * children and stores the AABBs of its children as a structure of arrays (one
+ * array of four single precision values for each coordinate) so that the four
+ * AABBs can be tested at once with SIMD instructions.
+ */
+struct WideTreeNode {
+
+    // -------------------- Constants -------------------- //
+
+    /// Maximum number of children of a node
+    static const int NB_CHILDREN = 4;
+
+    /// Child of an empty slot of a node
+    static const int32 NULL_CHILD = -1;
+
+    // -------------------- Attributes -------------------- //
+
+    /// Minimum coordinates of the AABBs of the children
+    float minX[NB_CHILDREN];
+    float minY[NB_CHILDREN];
+    float minZ[NB_CHILDREN];
+
+    /// Maximum coordinates of the AABBs of the children
+    float maxX[NB_CHILDREN];
+    float maxY[NB_CHILDREN];
+    float maxZ[NB_CHILDREN];
+
+    /// Children of the node. A non-negative value is the index of a child node, NULL_CHILD
+    /// is an empty slot and a smaller value is a leaf (see encodeLeaf() and decodeLeaf())
+    int32 children[NB_CHILDREN];
+
+    // -------------------- Methods -------------------- //
+
+    /// Return the child value of a leaf of the dynamic AABB tree
+    static int32 encodeLeaf(int32 leafNodeId);
+
+    /// Return the ID of the leaf of the dynamic AABB tree of a child value
+    static int32 decodeLeaf(int32 child);
+};
+
+// Class WideAABBTree
+/**
+ * This class implements an immutable AABB tree with four children per node that is
+ * built from a dynamic AABB tree to accelerate its queries. Each level of the wide tree
+ * replaces two levels of the binary tree and the four AABBs of the children of a node
+ * are tested at once with SSE instructions (when they are available). The leaves of the
+ * wide tree are the leaves of the dynamic AABB tree and the queries report the IDs of
+ * those leaves, exactly like the queries of the dynamic AABB tree. The wide tree must be
+ * built again after the dynamic AABB tree has been modified. Therefore, it is used for
+ * trees that rarely change like the tree of the static shapes of the broad-phase or the
+ * triangle tree of a concave mesh.
+ */
+class WideAABBTree {
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        /// Memory allocator
+        MemoryAllocator& mAllocator;
+
+        /// Dynamic AABB tree from which the wide tree has been built
+        const DynamicAABBTree* mTree;
+
+        /// Nodes of the tree in depth-first order (the root node is the first one)
+        WideTreeNode* mNodes;
+
+        /// Number of nodes in the tree
+        int mNbNodes;
+
+        /// Number of allocated nodes
+        int mNbAllocatedNodes;
+
+#ifdef IS_PROFILING_ACTIVE
+
+        /// Pointer to the profiler
+        Profiler* mProfiler;
+
+#endif
+
+        // -------------------- Methods -------------------- //
+
+        /// Add a new node with empty slots and return its index
+        int addNode();
+
+        /// Set the AABB of a child of a node
+        void setChildAABB(int nodeIndex, int slot, const AABB& aabb);
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        WideAABBTree(MemoryAllocator& allocator);
+
+        /// Destructor
+        ~WideAABBTree();
+
+        /// Deleted copy-constructor
+        WideAABBTree(const WideAABBTree& tree) = delete;
+
+        /// Deleted assignment operator
+        WideAABBTree& operator=(const WideAABBTree& tree) = delete;
+
+        /// Build the wide tree from a dynamic AABB tree
+        void build(const DynamicAABBTree& tree);
+
+        /// Remove all the nodes of the tree
+        void clear();
+
+        /// Return the number of nodes of the tree
+        int getNbNodes() const;
+
+        /// Report all shapes overlapping with the AABB given in parameter.
+        void reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback) const;
+
+        /// Report all shapes overlapping with the AABB given in parameter using a given
+        /// allocator for the temporary memory of the query
+        void reportAllShapesOverlappingWithAABB(const AABB& aabb, DynamicAABBTreeOverlapCallback& callback,
+                                                MemoryAllocator& allocator) const;
+
+        /// Ray casting method
+        void raycast(const Ray& ray, DynamicAABBTreeRaycastCallback& callback) const;
+
+#ifdef IS_PROFILING_ACTIVE
+
+        /// Set the profiler
+        void setProfiler(Profiler* profiler);
+
+#endif
+
+};
+
+// Return the child value of a leaf of the dynamic AABB tree
+inline int32 WideTreeNode::encodeLeaf(int32 leafNodeId) {
+    assert(leafNodeId >= 0);
+    return -2 - leafNodeId;
+}
+
+// Return the ID of the leaf of the dynamic AABB tree of a child value
+inline int32 WideTreeNode::decodeLeaf(int32 child) {
+    assert(child < NULL_CHILD);
+    return -2 - child;
+}
+
+// Return the number of nodes of the tree
+inline int WideAABBTree::getNbNodes() const {
+    return mNbNodes;
+}
+
+#ifdef IS_PROFILING_ACTIVE
+
+// Set the profiler
+inline void WideAABBTree::setProfiler(Profiler* profiler) {
+    mProfiler = profiler;
+}
+
+#endif
+
+}
+
+#endif
@@ -94,6 +94,9 @@ class AABB {
         /// Return the volume of the AABB
         decimal getVolume() const;
 
+        /// Return the surface area of the AABB
+        decimal getSurfaceArea() const;
+
         /// Merge the AABB in parameter with the current one
         void mergeWithAABB(const AABB& aabb);
 
@@ -177,6 +180,12 @@ inline decimal AABB::getVolume() const {
     return (diff.x * diff.y * diff.z);
 }
 
+// Return the surface area of the AABB
+inline decimal AABB::getSurfaceArea() const {
+    const Vector3 diff = mMaxCoordinates - mMinCoordinates;
+    return decimal(2.0) * (diff.x * diff.y + diff.y * diff.z + diff.z * diff.x);
+}
+
 // Return true if the AABB of a triangle intersects the AABB
 inline bool AABB::testCollisionTriangleAABB(const Vector3* trianglePoints) const {
 
@@ -30,24 +30,132 @@
 #include "collision/TriangleMesh.h"
 #include "utils/Profiler.h"
 #include "collision/TriangleVertexArray.h"
+#include <cstdint>
 
 using namespace reactphysics3d;
 
 // Constructor
 ConcaveMeshShape::ConcaveMeshShape(TriangleMesh* triangleMesh, const Vector3& scaling)
                  : ConcaveShape(CollisionShapeName::TRIANGLE_MESH), mDynamicAABBTree(MemoryManager::getBaseAllocator()),
-                   mScaling(scaling) {
+                   mWideAABBTree(MemoryManager::getBaseAllocator()), mCookedBVH(nullptr), mScaling(scaling),
+                   mSubpartsFirstTriangle(MemoryManager::getBaseAllocator()), mPrecomputedTriangles(nullptr),
+                   mPrecomputedTrianglesMemory(nullptr), mPrecomputedTrianglesMemorySize(0) {
     mTriangleMesh = triangleMesh;
     mRaycastTestType = TriangleRaycastSide::FRONT;
 
+    initSubpartsFirstTriangle();
+
     // Insert all the triangles into the dynamic AABB tree
     initBVHTree();
 }
 
-// Insert all the triangles into the dynamic AABB tree
+// Constructor with a cooked BVH of the mesh
+/// The cooked BVH must have been built (or loaded) for the same triangle mesh and it must
+/// not be destroyed before the shape. Nothing is built by this constructor and the BVH
+/// can be shared by several shapes with different scalings. The components of the
+/// scaling must not be zero. If the BVH is not valid or if it has not been built for a mesh
+/// with the same sub-parts and number of triangles, it is not used and the shape builds its
+/// own AABB tree of the triangles instead (getCookedBVH() then returns null).
+ConcaveMeshShape::ConcaveMeshShape(TriangleMesh* triangleMesh, const TriangleMeshBVH* cookedBVH, const Vector3& scaling)
+                 : ConcaveShape(CollisionShapeName::TRIANGLE_MESH), mDynamicAABBTree(MemoryManager::getBaseAllocator()),
+                   mWideAABBTree(MemoryManager::getBaseAllocator()), mCookedBVH(cookedBVH), mScaling(scaling),
+                   mSubpartsFirstTriangle(MemoryManager::getBaseAllocator()), mPrecomputedTriangles(nullptr),
+                   mPrecomputedTrianglesMemory(nullptr), mPrecomputedTrianglesMemorySize(0) {
+    mTriangleMesh = triangleMesh;
+    mRaycastTestType = TriangleRaycastSide::FRONT;
+
+    initSubpartsFirstTriangle();
+
+    assert(mScaling.x != decimal(0.0) && mScaling.y != decimal(0.0) && mScaling.z != decimal(0.0));
+
+    // If the cooked BVH cannot be used with this mesh, we build the AABB tree of the shape
+    if (mCookedBVH == nullptr || !mCookedBVH->isBuiltForMesh(*mTriangleMesh)) {
+        mCookedBVH = nullptr;
+        initBVHTree();
+    }
+}
+
+// Destructor
+ConcaveMeshShape::~ConcaveMeshShape() {
+    enablePrecomputedTriangles(false);
+}
+
+// Compute the index of the first triangle of each sub-part of the mesh
+void ConcaveMeshShape::initSubpartsFirstTriangle() {
+
+    uint nbTriangles = 0;
+    for (uint subPart=0; subPart < mTriangleMesh->getNbSubparts(); subPart++) {
+        mSubpartsFirstTriangle.add(nbTriangles);
+        nbTriangles += mTriangleMesh->getSubpart(subPart)->getNbTriangles();
+    }
+}
+
+// Enable/disable the precomputed triangles of the shape
+/// When they are enabled, the vertices and the vertices normals of all the triangles of
+/// the mesh are decoded from the triangle vertex arrays and scaled once and stored in an
+/// array of the shape. The triangles reported by the tree are then read directly from this
+/// array. This makes the middle-phase and the raycasts faster at the cost of the memory
+/// of the array (six vectors and a shape ID per triangle). The triangle vertex arrays of
+/// the mesh must not be modified while the precomputed triangles are enabled.
+/**
+ * @param isEnabled True if the triangles of the mesh must be precomputed
+ */
+void ConcaveMeshShape::enablePrecomputedTriangles(bool isEnabled) {
+
+    if (isEnabled == (mPrecomputedTriangles != nullptr)) return;
+
+    MemoryAllocator& allocator = MemoryManager::getBaseAllocator();
+
+    if (!isEnabled) {
+        allocator.release(mPrecomputedTrianglesMemory, mPrecomputedTrianglesMemorySize);
+        mPrecomputedTriangles = nullptr;
+        mPrecomputedTrianglesMemory = nullptr;
+        mPrecomputedTrianglesMemorySize = 0;
+        return;
+    }
+
+    const uint nbSubparts = mTriangleMesh->getNbSubparts();
+    const uint nbTriangles = nbSubparts > 0 ? mSubpartsFirstTriangle[nbSubparts - 1] +
+                                              mTriangleMesh->getSubpart(nbSubparts - 1)->getNbTriangles() : 0;
+
+    // Allocate the array with some padding to align it on a cache line
+    const size_t cacheLineSize = 64;
+    mPrecomputedTrianglesMemorySize = std::max(nbTriangles, 1u) * sizeof(ConcaveMeshTriangle) + cacheLineSize;
+    mPrecomputedTrianglesMemory = allocator.allocate(mPrecomputedTrianglesMemorySize);
+    assert(mPrecomputedTrianglesMemory != nullptr);
+    const uintptr_t alignedAddress = (reinterpret_cast<uintptr_t>(mPrecomputedTrianglesMemory) + cacheLineSize - 1) /
+                                     cacheLineSize * cacheLineSize;
+    ConcaveMeshTriangle* triangles = reinterpret_cast<ConcaveMeshTriangle*>(alignedAddress);
+
+    // Decode and scale all the triangles of the mesh
+    for (uint subPart=0; subPart < nbSubparts; subPart++) {
+        for (uint triangleIndex=0; triangleIndex < mTriangleMesh->getSubpart(subPart)->getNbTriangles(); triangleIndex++) {
+
+            const uint shapeId = mSubpartsFirstTriangle[subPart] + triangleIndex;
+            ConcaveMeshTriangle* triangle = new (triangles + shapeId) ConcaveMeshTriangle();
+            getTriangleVertices(subPart, triangleIndex, triangle->vertices);
+            getTriangleVerticesNormals(subPart, triangleIndex, triangle->verticesNormals);
+            triangle->shapeId = shapeId;
+        }
+    }
+
+    mPrecomputedTriangles = triangles;
+}
+
+// Build the dynamic AABB tree with all the triangles of the mesh
+/// The tree is built top-down from all the triangles at once, which gives a better
+/// tree than inserting the triangles one by one.
 void ConcaveMeshShape::initBVHTree() {
 
-    // TODO : Try to randomly add the triangles into the tree to obtain a better tree
+    // Compute the total number of triangles
+    uint nbTriangles = 0;
+    for (uint subPart=0; subPart<mTriangleMesh->getNbSubparts(); subPart++) {
+        nbTriangles += mTriangleMesh->getSubpart(subPart)->getNbTriangles();
+    }
+
+    List<AABB> trianglesAABBs(MemoryManager::getBaseAllocator(), nbTriangles);
+    List<int32> trianglesSubParts(MemoryManager::getBaseAllocator(), nbTriangles);
+    List<int32> trianglesIndices(MemoryManager::getBaseAllocator(), nbTriangles);
 
     // For each sub-part of the mesh
     for (uint subPart=0; subPart<mTriangleMesh->getNbSubparts(); subPart++) {
@@ -75,12 +183,32 @@ void ConcaveMeshShape::initBVHTree() {
             trianglePoints[2].z *= mScaling.z;
 
             // Create the AABB for the triangle
-            AABB aabb = AABB::createAABBForTriangle(trianglePoints);
-
-            // Add the AABB with the index of the triangle into the dynamic AABB tree
-            mDynamicAABBTree.addObject(aabb, subPart, triangleIndex);
+            trianglesAABBs.add(AABB::createAABBForTriangle(trianglePoints));
+            trianglesSubParts.add(subPart);
+            trianglesIndices.add(triangleIndex);
         }
     }
+
+    if (nbTriangles == 0) return;
+
+    // Build the tree with the AABBs and the indices of the triangles
+    mDynamicAABBTree.buildTree(&(trianglesAABBs[0]), &(trianglesSubParts[0]), &(trianglesIndices[0]),
+                               static_cast<int>(nbTriangles));
+
+    // Build the wide tree used for the queries
+    mWideAABBTree.build(mDynamicAABBTree);
+}
+
+// Transform an AABB from the space of the shape into the space of the mesh
+/// This is used to query the cooked BVH that is built without the scaling of the shape.
+AABB ConcaveMeshShape::computeMeshSpaceAABB(const AABB& aabb) const {
+
+    const Vector3 inverseScaling(decimal(1.0) / mScaling.x, decimal(1.0) / mScaling.y, decimal(1.0) / mScaling.z);
+    const Vector3 min = aabb.getMin() * inverseScaling;
+    const Vector3 max = aabb.getMax() * inverseScaling;
+
+    // A negative scaling swaps the bounds
+    return AABB(Vector3::min(min, max), Vector3::max(min, max));
 }
 
 // Return the three vertices coordinates (in the array outTriangleVertices) of a triangle
@@ -141,11 +269,17 @@ uint ConcaveMeshShape::getNbTriangles(uint subPart) const
 // Use a callback method on all triangles of the concave shape inside a given AABB
 void ConcaveMeshShape::testAllTriangles(TriangleCallback& callback, const AABB& localAABB) const {
 
-    ConvexTriangleAABBOverlapCallback overlapCallback(callback, *this, mDynamicAABBTree);
+    ConvexTriangleAABBOverlapCallback overlapCallback(callback, *this);
 
-    // Ask the Dynamic AABB Tree to report all the triangles that are overlapping
+    // If the shape uses a cooked BVH, query it in the space of the mesh
+    if (mCookedBVH != nullptr) {
+        mCookedBVH->reportAllShapesOverlappingWithAABB(computeMeshSpaceAABB(localAABB), overlapCallback);
+        return;
+    }
+
+    // Ask the wide AABB Tree to report all the triangles that are overlapping
     // with the AABB of the convex shape.
-    mDynamicAABBTree.reportAllShapesOverlappingWithAABB(localAABB, overlapCallback);
+    mWideAABBTree.reportAllShapesOverlappingWithAABB(localAABB, overlapCallback);
 }
 
 // Raycast method with feedback information
@@ -156,7 +290,7 @@ bool ConcaveMeshShape::raycast(const Ray& ray, RaycastInfo& raycastInfo, ProxySh
     RP3D_PROFILE("ConcaveMeshShape::raycast()", mProfiler);
 
     // Create the callback object that will compute ray casting against triangles
-    ConcaveMeshRaycastCallback raycastCallback(mDynamicAABBTree, *this, proxyShape, raycastInfo, ray, allocator);
+    ConcaveMeshRaycastCallback raycastCallback(*this, proxyShape, raycastInfo, ray, allocator);
 
 #ifdef IS_PROFILING_ACTIVE
 
@@ -165,10 +299,19 @@ bool ConcaveMeshShape::raycast(const Ray& ray, RaycastInfo& raycastInfo, ProxySh
 
 #endif
 
-    // Ask the Dynamic AABB Tree to report all AABB nodes that are hit by the ray.
-    // The raycastCallback object will then compute ray casting against the triangles
-    // in the hit AABBs.
-    mDynamicAABBTree.raycast(ray, raycastCallback);
+    // Ask the wide AABB Tree (or the cooked BVH) to report all AABB nodes that are hit
+    // by the ray. The raycastCallback object will then compute ray casting against the
+    // triangles in the hit AABBs.
+    if (mCookedBVH != nullptr) {
+
+        // The fractions of the ray do not change in the space of the mesh
+        const Vector3 inverseScaling(decimal(1.0) / mScaling.x, decimal(1.0) / mScaling.y, decimal(1.0) / mScaling.z);
+        const Ray meshSpaceRay(ray.point1 * inverseScaling, ray.point2 * inverseScaling, ray.maxFraction);
+        mCookedBVH->raycast(meshSpaceRay, raycastCallback);
+    }
+    else {
+        mWideAABBTree.raycast(ray, raycastCallback);
+    }
 
     raycastCallback.raycastTriangles();
 
@@ -178,17 +321,9 @@ bool ConcaveMeshShape::raycast(const Ray& ray, RaycastInfo& raycastInfo, ProxySh
 // Compute the shape Id for a given triangle of the mesh
 uint ConcaveMeshShape::computeTriangleShapeId(uint subPart, uint triangleIndex) const {
 
-    uint shapeId = 0;
-
-    uint i=0;
-    while (i < subPart) {
-
-        shapeId += mTriangleMesh->getSubpart(i)->getNbTriangles();
+    assert(subPart < mSubpartsFirstTriangle.size());
 
-        i++;
-    }
-
-    return shapeId + triangleIndex;
+    return mSubpartsFirstTriangle[subPart] + triangleIndex;
 }
 
 // Collect all the AABB nodes that are hit by the ray in the Dynamic AABB Tree
@@ -209,18 +344,29 @@ void ConcaveMeshRaycastCallback::raycastTriangles() {
     for (it = mHitAABBNodes.begin(); it != mHitAABBNodes.end(); ++it) {
 
         // Get the node data (triangle index and mesh subpart index)
-        int32* data = mDynamicAABBTree.getNodeDataInt(*it);
+        const int32* data = mConcaveMeshShape.getNodeDataInt(*it);
 
-        // Get the triangle vertices for this node from the concave mesh shape
+        // Get the triangle vertices and the vertices normals for this node from the concave
+        // mesh shape (directly from its precomputed triangles if they are enabled)
         Vector3 trianglePoints[3];
-        mConcaveMeshShape.getTriangleVertices(data[0], data[1], trianglePoints);
-
-        // Get the vertices normals of the triangle
         Vector3 verticesNormals[3];
-        mConcaveMeshShape.getTriangleVerticesNormals(data[0], data[1], verticesNormals);
+        const Vector3* points = trianglePoints;
+        const Vector3* normals = verticesNormals;
+        uint shapeId;
+        if (mConcaveMeshShape.arePrecomputedTrianglesEnabled()) {
+            const ConcaveMeshTriangle& triangle = mConcaveMeshShape.getPrecomputedTriangle(data[0], data[1]);
+            points = triangle.vertices;
+            normals = triangle.verticesNormals;
+            shapeId = triangle.shapeId;
+        }
+        else {
+            mConcaveMeshShape.getTriangleVertices(data[0], data[1], trianglePoints);
+            mConcaveMeshShape.getTriangleVerticesNormals(data[0], data[1], verticesNormals);
+            shapeId = mConcaveMeshShape.computeTriangleShapeId(data[0], data[1]);
+        }
 
         // Create a triangle collision shape
-        TriangleShape triangleShape(trianglePoints, verticesNormals, mConcaveMeshShape.computeTriangleShapeId(data[0], data[1]), mAllocator);
+        TriangleShape triangleShape(points, normals, shapeId, mAllocator);
         triangleShape.setRaycastTestType(mConcaveMeshShape.getRaycastTestType());
 		
 #ifdef IS_PROFILING_ACTIVE
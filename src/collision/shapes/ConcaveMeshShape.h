@@ -29,6 +29,8 @@
 // Libraries
 #include "ConcaveShape.h"
 #include "collision/broadphase/DynamicAABBTree.h"
+#include "collision/broadphase/WideAABBTree.h"
+#include "collision/TriangleMeshBVH.h"
 #include "containers/List.h"
 
 namespace reactphysics3d {
@@ -39,6 +41,27 @@ class Profiler;
 class TriangleShape;
 class TriangleMesh;
 
+// Structure ConcaveMeshTriangle
+/**
+ * This structure represents a triangle of a concave mesh shape whose vertices have
+ * been decoded from the TriangleVertexArray of its mesh and scaled with the scaling of
+ * the shape. The shape can store an array of those triangles to avoid decoding them
+ * each time they are reported by its tree.
+ */
+struct alignas(16) ConcaveMeshTriangle {
+
+    // -------------------- Attributes -------------------- //
+
+    /// Vertices of the triangle (with the scaling of the shape)
+    Vector3 vertices[3];
+
+    /// Normals of the vertices of the triangle
+    Vector3 verticesNormals[3];
+
+    /// Shape ID of the triangle
+    uint shapeId;
+};
+
 // class ConvexTriangleAABBOverlapCallback
 class ConvexTriangleAABBOverlapCallback : public DynamicAABBTreeOverlapCallback {
 
@@ -49,15 +72,11 @@ class ConvexTriangleAABBOverlapCallback : public DynamicAABBTreeOverlapCallback
         // Reference to the concave mesh shape
         const ConcaveMeshShape& mConcaveMeshShape;
 
-        // Reference to the Dynamic AABB tree
-        const DynamicAABBTree& mDynamicAABBTree;
-
     public:
 
         // Constructor
-        ConvexTriangleAABBOverlapCallback(TriangleCallback& triangleCallback, const ConcaveMeshShape& concaveShape,
-                                          const DynamicAABBTree& dynamicAABBTree)
-          : mTriangleTestCallback(triangleCallback), mConcaveMeshShape(concaveShape), mDynamicAABBTree(dynamicAABBTree) {
+        ConvexTriangleAABBOverlapCallback(TriangleCallback& triangleCallback, const ConcaveMeshShape& concaveShape)
+          : mTriangleTestCallback(triangleCallback), mConcaveMeshShape(concaveShape) {
 
         }
 
@@ -73,7 +92,6 @@ class ConcaveMeshRaycastCallback : public DynamicAABBTreeRaycastCallback {
     private :
 
         List<int32> mHitAABBNodes;
-        const DynamicAABBTree& mDynamicAABBTree;
         const ConcaveMeshShape& mConcaveMeshShape;
         ProxyShape* mProxyShape;
         RaycastInfo& mRaycastInfo;
@@ -91,9 +109,9 @@ class ConcaveMeshRaycastCallback : public DynamicAABBTreeRaycastCallback {
     public:
 
         // Constructor
-        ConcaveMeshRaycastCallback(const DynamicAABBTree& dynamicAABBTree, const ConcaveMeshShape& concaveMeshShape,
-                                   ProxyShape* proxyShape, RaycastInfo& raycastInfo, const Ray& ray, MemoryAllocator& allocator)
-            : mHitAABBNodes(allocator), mDynamicAABBTree(dynamicAABBTree), mConcaveMeshShape(concaveMeshShape), mProxyShape(proxyShape),
+        ConcaveMeshRaycastCallback(const ConcaveMeshShape& concaveMeshShape, ProxyShape* proxyShape,
+                                   RaycastInfo& raycastInfo, const Ray& ray, MemoryAllocator& allocator)
+            : mHitAABBNodes(allocator), mConcaveMeshShape(concaveMeshShape), mProxyShape(proxyShape),
               mRaycastInfo(raycastInfo), mRay(ray), mIsHit(false), mAllocator(allocator) {
 
         }
@@ -123,7 +141,10 @@ class ConcaveMeshRaycastCallback : public DynamicAABBTreeRaycastCallback {
 /**
  * This class represents a static concave mesh shape. Note that collision detection
  * with a concave mesh shape can be very expensive. You should only use
- * this shape for a static mesh.
+ * this shape for a static mesh. By default, the shape builds its own AABB tree of
+ * the triangles. To avoid this cost, the shape can also use a TriangleMeshBVH that
+ * has been cooked (or loaded) before and that can be shared by the shapes that use
+ * the same mesh with different scalings.
  */
 class ConcaveMeshShape : public ConcaveShape {
 
@@ -137,6 +158,12 @@ class ConcaveMeshShape : public ConcaveShape {
         /// Dynamic AABB tree to accelerate collision with the triangles
         DynamicAABBTree mDynamicAABBTree;
 
+        /// Wide AABB tree built from the dynamic AABB tree to accelerate its queries
+        WideAABBTree mWideAABBTree;
+
+        /// Cooked BVH of the mesh used instead of the AABB trees of the shape (or null)
+        const TriangleMeshBVH* mCookedBVH;
+
         /// Array with computed vertices normals for each TriangleVertexArray of the triangle mesh (only
         /// if the user did not provide its own vertices normals)
         Vector3** mComputedVerticesNormals;
@@ -144,6 +171,19 @@ class ConcaveMeshShape : public ConcaveShape {
         /// Scaling
         const Vector3 mScaling;
 
+        /// Index of the first triangle of each sub-part of the mesh in the triangles of the mesh
+        List<uint> mSubpartsFirstTriangle;
+
+        /// Decoded and scaled triangles of the mesh in the order of their shape IDs (null if the
+        /// precomputed triangles are not enabled). The array is aligned on a cache line.
+        ConcaveMeshTriangle* mPrecomputedTriangles;
+
+        /// Memory allocated for the precomputed triangles (including the alignment padding)
+        void* mPrecomputedTrianglesMemory;
+
+        /// Size in bytes of the memory allocated for the precomputed triangles
+        size_t mPrecomputedTrianglesMemorySize;
+
         // -------------------- Methods -------------------- //
 
         /// Raycast method with feedback information
@@ -152,19 +192,38 @@ class ConcaveMeshShape : public ConcaveShape {
         /// Return the number of bytes used by the collision shape
         virtual size_t getSizeInBytes() const override;
 
-        /// Insert all the triangles into the dynamic AABB tree
+        /// Build the dynamic AABB tree with all the triangles of the mesh
         void initBVHTree();
 
         /// Compute the shape Id for a given triangle of the mesh
         uint computeTriangleShapeId(uint subPart, uint triangleIndex) const;
 
+        /// Return the mesh sub-part and the triangle index of a leaf reported by the tree
+        const int32* getNodeDataInt(int nodeId) const;
+
+        /// Transform an AABB from the space of the shape into the space of the mesh
+        AABB computeMeshSpaceAABB(const AABB& aabb) const;
+
+        /// Compute the index of the first triangle of each sub-part of the mesh
+        void initSubpartsFirstTriangle();
+
+        /// Return a precomputed triangle of the mesh
+        const ConcaveMeshTriangle& getPrecomputedTriangle(uint subPart, uint triangleIndex) const;
+
+        /// Report a triangle of the mesh to a triangle callback
+        void reportTriangle(uint subPart, uint triangleIndex, TriangleCallback& callback) const;
+
     public:
 
         /// Constructor
         ConcaveMeshShape(TriangleMesh* triangleMesh, const Vector3& scaling = Vector3(1, 1, 1));
 
+        /// Constructor with a cooked BVH of the mesh
+        ConcaveMeshShape(TriangleMesh* triangleMesh, const TriangleMeshBVH* cookedBVH,
+                         const Vector3& scaling = Vector3(1, 1, 1));
+
         /// Destructor
-        virtual ~ConcaveMeshShape() override = default;
+        virtual ~ConcaveMeshShape() override;
 
         /// Deleted copy-constructor
         ConcaveMeshShape(const ConcaveMeshShape& shape) = delete;
@@ -174,6 +233,15 @@ class ConcaveMeshShape : public ConcaveShape {
 
         /// Return the scaling vector
         const Vector3& getScaling() const;
+
+        /// Return the cooked BVH used by the shape (null if the shape has its own AABB tree)
+        const TriangleMeshBVH* getCookedBVH() const;
+
+        /// Enable/disable the precomputed triangles of the shape
+        void enablePrecomputedTriangles(bool isEnabled);
+
+        /// Return true if the precomputed triangles of the shape are enabled
+        bool arePrecomputedTrianglesEnabled() const;
 		
         /// Return the number of sub parts contained in this mesh
 		uint getNbSubparts() const;
@@ -216,8 +284,10 @@ class ConcaveMeshShape : public ConcaveShape {
 };
 
 // Return the number of bytes used by the collision shape
+/// The memory of the precomputed triangles (with the padding used to align them on a cache
+/// line) is included when they are enabled.
 inline size_t ConcaveMeshShape::getSizeInBytes() const {
-    return sizeof(ConcaveMeshShape);
+    return sizeof(ConcaveMeshShape) + mPrecomputedTrianglesMemorySize;
 }
 
 // Return the scaling vector
@@ -225,6 +295,50 @@ inline const Vector3& ConcaveMeshShape::getScaling() const {
     return mScaling;
 }
 
+// Return the cooked BVH used by the shape (null if the shape has its own AABB tree)
+inline const TriangleMeshBVH* ConcaveMeshShape::getCookedBVH() const {
+    return mCookedBVH;
+}
+
+// Return true if the precomputed triangles of the shape are enabled
+inline bool ConcaveMeshShape::arePrecomputedTrianglesEnabled() const {
+    return mPrecomputedTriangles != nullptr;
+}
+
+// Return a precomputed triangle of the mesh
+inline const ConcaveMeshTriangle& ConcaveMeshShape::getPrecomputedTriangle(uint subPart, uint triangleIndex) const {
+    assert(mPrecomputedTriangles != nullptr);
+    assert(subPart < mSubpartsFirstTriangle.size());
+    return mPrecomputedTriangles[mSubpartsFirstTriangle[subPart] + triangleIndex];
+}
+
+// Report a triangle of the mesh to a triangle callback
+inline void ConcaveMeshShape::reportTriangle(uint subPart, uint triangleIndex, TriangleCallback& callback) const {
+
+    // If the triangles are precomputed, the triangle is read directly from the array
+    if (mPrecomputedTriangles != nullptr) {
+        const ConcaveMeshTriangle& triangle = getPrecomputedTriangle(subPart, triangleIndex);
+        callback.testTriangle(triangle.vertices, triangle.verticesNormals, triangle.shapeId);
+        return;
+    }
+
+    // Get the triangle vertices for this node from the concave mesh shape
+    Vector3 trianglePoints[3];
+    getTriangleVertices(subPart, triangleIndex, trianglePoints);
+
+    // Get the vertices normals of the triangle
+    Vector3 verticesNormals[3];
+    getTriangleVerticesNormals(subPart, triangleIndex, verticesNormals);
+
+    // Call the callback to test narrow-phase collision with this triangle
+    callback.testTriangle(trianglePoints, verticesNormals, computeTriangleShapeId(subPart, triangleIndex));
+}
+
+// Return the mesh sub-part and the triangle index of a leaf reported by the tree
+inline const int32* ConcaveMeshShape::getNodeDataInt(int nodeId) const {
+    return mCookedBVH != nullptr ? mCookedBVH->getNodeDataInt(nodeId) : mDynamicAABBTree.getNodeDataInt(nodeId);
+}
+
 // Return the local bounds of the shape in x, y and z directions.
 // This method is used to compute the AABB of the box
 /**
@@ -234,6 +348,17 @@ inline const Vector3& ConcaveMeshShape::getScaling() const {
 inline void ConcaveMeshShape::getLocalBounds(Vector3& min, Vector3& max) const {
 
     // Get the AABB of the whole tree
+    if (mCookedBVH != nullptr) {
+
+        // The bounds of the cooked BVH are in the space of the mesh
+        const AABB meshAABB = mCookedBVH->getBounds();
+        const Vector3 scaledMin = meshAABB.getMin() * mScaling;
+        const Vector3 scaledMax = meshAABB.getMax() * mScaling;
+        min = Vector3::min(scaledMin, scaledMax);
+        max = Vector3::max(scaledMin, scaledMax);
+        return;
+    }
+
     AABB treeAABB = mDynamicAABBTree.getRootAABB();
 
     min = treeAABB.getMin();
@@ -262,18 +387,10 @@ inline void ConcaveMeshShape::computeLocalInertiaTensor(Matrix3x3& tensor, decim
 inline void ConvexTriangleAABBOverlapCallback::notifyOverlappingNode(int nodeId) {
 
     // Get the node data (triangle index and mesh subpart index)
-    int32* data = mDynamicAABBTree.getNodeDataInt(nodeId);
-
-    // Get the triangle vertices for this node from the concave mesh shape
-    Vector3 trianglePoints[3];
-    mConcaveMeshShape.getTriangleVertices(data[0], data[1], trianglePoints);
-
-    // Get the vertices normals of the triangle
-    Vector3 verticesNormals[3];
-    mConcaveMeshShape.getTriangleVerticesNormals(data[0], data[1], verticesNormals);
+    const int32* data = mConcaveMeshShape.getNodeDataInt(nodeId);
 
     // Call the callback to test narrow-phase collision with this triangle
-    mTriangleTestCallback.testTriangle(trianglePoints, verticesNormals, mConcaveMeshShape.computeTriangleShapeId(data[0], data[1]));
+    mConcaveMeshShape.reportTriangle(data[0], data[1], mTriangleTestCallback);
 }
 
 #ifdef IS_PROFILING_ACTIVE
@@ -284,6 +401,7 @@ inline void ConcaveMeshShape::setProfiler(Profiler* profiler) {
     CollisionShape::setProfiler(profiler);
 
     mDynamicAABBTree.setProfiler(profiler);
+    mWideAABBTree.setProfiler(profiler);
 }
 
 
@@ -26,7 +26,10 @@
 // Libraries
 #include "HeightFieldShape.h"
 #include "collision/RaycastInfo.h"
+#include "memory/MemoryManager.h"
 #include "utils/Profiler.h"
+#include <cmath>
+#include <algorithm>
 
 using namespace reactphysics3d;
 
@@ -47,7 +50,9 @@ HeightFieldShape::HeightFieldShape(int nbGridColumns, int nbGridRows, decimal mi
                  : ConcaveShape(CollisionShapeName::HEIGHTFIELD), mNbColumns(nbGridColumns), mNbRows(nbGridRows),
                    mWidth(nbGridColumns - 1), mLength(nbGridRows - 1), mMinHeight(minHeight),
                    mMaxHeight(maxHeight), mUpAxis(upAxis), mIntegerHeightScale(integerHeightScale),
-                   mHeightDataType(dataType), mScaling(scaling) {
+                   mHeightDataType(dataType), mScaling(scaling), mHierarchyTiles(nullptr),
+                   mHierarchyLevelsFirstTile(nullptr), mNbHierarchyLevels(0), mHierarchyMemory(nullptr),
+                   mHierarchyMemorySize(0) {
 
     assert(nbGridColumns >= 2);
     assert(nbGridRows >= 2);
@@ -76,6 +81,149 @@ HeightFieldShape::HeightFieldShape(int nbGridColumns, int nbGridRows, decimal mi
     }
 }
 
+// Destructor
+HeightFieldShape::~HeightFieldShape() {
+
+    // Release the memory of the min/max height hierarchy
+    enableMinMaxHeightHierarchy(false);
+}
+
+// Enable/disable the min/max height hierarchy of the height field
+/// The hierarchy is a quadtree of the minimum and maximum heights of square tiles of cells of
+/// the grid. When it is enabled, the middle-phase rejects the whole tiles whose height range does
+/// not overlap the AABB of the other shape and the raycasts skip the whole tiles that the ray
+/// crosses above or below their height range. This is useful for large height fields with
+/// shapes far above the terrain. The hierarchy uses about one eighth of the memory of the height
+/// values in single precision. The height values must not be modified while it is enabled.
+/**
+ * @param isEnabled True if the min/max height hierarchy must be computed
+ */
+void HeightFieldShape::enableMinMaxHeightHierarchy(bool isEnabled) {
+
+    if (isEnabled == (mHierarchyTiles != nullptr)) return;
+
+    MemoryAllocator& allocator = MemoryManager::getBaseAllocator();
+
+    if (!isEnabled) {
+        allocator.release(mHierarchyMemory, mHierarchyMemorySize);
+        mHierarchyTiles = nullptr;
+        mHierarchyLevelsFirstTile = nullptr;
+        mNbHierarchyLevels = 0;
+        mHierarchyMemory = nullptr;
+        mHierarchyMemorySize = 0;
+        return;
+    }
+
+    // Compute the number of levels of the hierarchy (the last level has a single tile)
+    int nbLevels = 1;
+    uint nbTiles = getNbHierarchyTilesI(0) * getNbHierarchyTilesJ(0);
+    while (getNbHierarchyTilesI(nbLevels - 1) > 1 || getNbHierarchyTilesJ(nbLevels - 1) > 1) {
+        nbTiles += getNbHierarchyTilesI(nbLevels) * getNbHierarchyTilesJ(nbLevels);
+        nbLevels++;
+    }
+
+    // Allocate the tiles and the index of the first tile of each level
+    mHierarchyMemorySize = nbTiles * sizeof(HeightFieldTile) + nbLevels * sizeof(uint);
+    mHierarchyMemory = allocator.allocate(mHierarchyMemorySize);
+    assert(mHierarchyMemory != nullptr);
+    mHierarchyTiles = static_cast<HeightFieldTile*>(mHierarchyMemory);
+    mHierarchyLevelsFirstTile = reinterpret_cast<uint*>(mHierarchyTiles + nbTiles);
+    mNbHierarchyLevels = nbLevels;
+
+    uint firstTile = 0;
+    for (int level = 0; level < nbLevels; level++) {
+        mHierarchyLevelsFirstTile[level] = firstTile;
+        firstTile += getNbHierarchyTilesI(level) * getNbHierarchyTilesJ(level);
+    }
+
+    // Compute the height range of the tiles of the first level from the height values
+    for (int tileJ = 0; tileJ < getNbHierarchyTilesJ(0); tileJ++) {
+        for (int tileI = 0; tileI < getNbHierarchyTilesI(0); tileI++) {
+
+            const int iStart = tileI * NB_CELLS_PER_HIERARCHY_TILE;
+            const int jStart = tileJ * NB_CELLS_PER_HIERARCHY_TILE;
+            const int iEnd = std::min(iStart + NB_CELLS_PER_HIERARCHY_TILE, mNbColumns - 1);
+            const int jEnd = std::min(jStart + NB_CELLS_PER_HIERARCHY_TILE, mNbRows - 1);
+
+            HeightFieldTile& tile = mHierarchyTiles[tileJ * getNbHierarchyTilesI(0) + tileI];
+            tile.minHeight = DECIMAL_LARGEST;
+            tile.maxHeight = -DECIMAL_LARGEST;
+            for (int j = jStart; j <= jEnd; j++) {
+                for (int i = iStart; i <= iEnd; i++) {
+                    const decimal height = getLocalHeightAt(i, j);
+                    tile.minHeight = std::min(tile.minHeight, height);
+                    tile.maxHeight = std::max(tile.maxHeight, height);
+                }
+            }
+        }
+    }
+
+    // Compute the height range of the tiles of the next levels from their four children tiles
+    for (int level = 1; level < nbLevels; level++) {
+        for (int tileJ = 0; tileJ < getNbHierarchyTilesJ(level); tileJ++) {
+            for (int tileI = 0; tileI < getNbHierarchyTilesI(level); tileI++) {
+
+                HeightFieldTile& tile = mHierarchyTiles[mHierarchyLevelsFirstTile[level] + tileJ * getNbHierarchyTilesI(level) + tileI];
+                tile.minHeight = DECIMAL_LARGEST;
+                tile.maxHeight = -DECIMAL_LARGEST;
+                for (int childJ = 2 * tileJ; childJ <= std::min(2 * tileJ + 1, getNbHierarchyTilesJ(level - 1) - 1); childJ++) {
+                    for (int childI = 2 * tileI; childI <= std::min(2 * tileI + 1, getNbHierarchyTilesI(level - 1) - 1); childI++) {
+                        const HeightFieldTile& child = getHierarchyTile(level - 1, childI, childJ);
+                        tile.minHeight = std::min(tile.minHeight, child.minHeight);
+                        tile.maxHeight = std::max(tile.maxHeight, child.maxHeight);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Return the local bounds of the triangles of a rectangular region of the grid
+/// The height range of the region is computed from the min/max height hierarchy if it is
+/// enabled and from the height values of the region otherwise.
+/**
+ * @param minColumn Index of the first column of grid points of the region
+ * @param minRow Index of the first row of grid points of the region
+ * @param maxColumn Index of the last column of grid points of the region
+ * @param maxRow Index of the last row of grid points of the region
+ * @param min The minimum bounds of the region in local-space coordinates
+ * @param max The maximum bounds of the region in local-space coordinates
+ */
+void HeightFieldShape::getRegionLocalBounds(int minColumn, int minRow, int maxColumn, int maxRow,
+                                            Vector3& min, Vector3& max) const {
+
+    assert(minColumn >= 0 && minColumn < maxColumn && maxColumn < mNbColumns);
+    assert(minRow >= 0 && minRow < maxRow && maxRow < mNbRows);
+
+    // Compute the height range of the cells of the region
+    decimal minHeight = DECIMAL_LARGEST;
+    decimal maxHeight = -DECIMAL_LARGEST;
+    if (mHierarchyTiles != nullptr) {
+        computeTileHeightRange(mNbHierarchyLevels - 1, 0, 0, minColumn, maxColumn - 1, minRow, maxRow - 1, minHeight, maxHeight);
+    }
+    else {
+        for (int j = minRow; j <= maxRow; j++) {
+            for (int i = minColumn; i <= maxColumn; i++) {
+                const decimal height = getLocalHeightAt(i, j);
+                minHeight = std::min(minHeight, height);
+                maxHeight = std::max(maxHeight, height);
+            }
+        }
+    }
+
+    const int iAxis = mUpAxis == 0 ? 1 : 0;
+    const int jAxis = mUpAxis == 2 ? 1 : 2;
+    min[iAxis] = -mWidth * decimal(0.5) + minColumn;
+    max[iAxis] = -mWidth * decimal(0.5) + maxColumn;
+    min[jAxis] = -mLength * decimal(0.5) + minRow;
+    max[jAxis] = -mLength * decimal(0.5) + maxRow;
+    min[mUpAxis] = minHeight;
+    max[mUpAxis] = maxHeight;
+
+    min = min * mScaling;
+    max = max * mScaling;
+}
+
 // Return the local bounds of the shape in x, y and z directions.
 // This method is used to compute the AABB of the box
 /**
@@ -130,57 +278,160 @@ void HeightFieldShape::testAllTriangles(TriangleCallback& callback, const AABB&
    assert(jMin >= 0 && jMin < mNbRows);
    assert(jMax >= 0 && jMax < mNbRows);
 
+   // If the min/max height hierarchy is enabled, we only report the triangles of the tiles
+   // and cells whose height range overlaps the height range of the AABB
+   if (mHierarchyTiles != nullptr) {
+
+       if (iMin < iMax && jMin < jMax) {
+           const decimal minHeight = std::min(aabb.getMin()[mUpAxis], aabb.getMax()[mUpAxis]);
+           const decimal maxHeight = std::max(aabb.getMin()[mUpAxis], aabb.getMax()[mUpAxis]);
+           testTileTriangles(callback, mNbHierarchyLevels - 1, 0, 0, iMin, iMax - 1, jMin, jMax - 1, minHeight, maxHeight);
+       }
+
+       return;
+   }
+
    // For each sub-grid points (except the last ones one each dimension)
    for (int i = iMin; i < iMax; i++) {
        for (int j = jMin; j < jMax; j++) {
 
-           // Compute the four point of the current quad
-           const Vector3 p1 = getVertexAt(i, j);
-           const Vector3 p2 = getVertexAt(i, j + 1);
-           const Vector3 p3 = getVertexAt(i + 1, j);
-           const Vector3 p4 = getVertexAt(i + 1, j + 1);
-
-           // Generate the first triangle for the current grid rectangle
-           Vector3 trianglePoints[3] = {p1, p2, p3};
-
-           // Compute the triangle normal
-           Vector3 triangle1Normal = (p2 - p1).cross(p3 - p1).getUnit();
-
-           // Use the triangle face normal as vertices normals (this is an aproximation. The correct
-           // solution would be to compute all the normals of the neighbor triangles and use their
-           // weighted average (with incident angle as weight) at the vertices. However, this solution
-           // seems too expensive (it requires to compute the normal of all neighbor triangles instead
-           // and compute the angle of incident edges with asin(). Maybe we could also precompute the
-           // vertices normal at the HeightFieldShape constructor but it will require extra memory to
-           // store them.
-           Vector3 verticesNormals1[3] = {triangle1Normal, triangle1Normal, triangle1Normal};
-
-           // Test collision against the first triangle
-           callback.testTriangle(trianglePoints, verticesNormals1, computeTriangleShapeId(i, j, 0));
-
-           // Generate the second triangle for the current grid rectangle
-           trianglePoints[0] = p3;
-           trianglePoints[1] = p2;
-           trianglePoints[2] = p4;
-
-           // Compute the triangle normal
-           Vector3 triangle2Normal = (p2 - p3).cross(p4 - p3).getUnit();
-
-           // Use the triangle face normal as vertices normals (this is an aproximation. The correct
-           // solution would be to compute all the normals of the neighbor triangles and use their
-           // weighted average (with incident angle as weight) at the vertices. However, this solution
-           // seems too expensive (it requires to compute the normal of all neighbor triangles instead
-           // and compute the angle of incident edges with asin(). Maybe we could also precompute the
-           // vertices normal at the HeightFieldShape constructor but it will require extra memory to
-           // store them.
-           Vector3 verticesNormals2[3] = {triangle2Normal, triangle2Normal, triangle2Normal};
-
-           // Test collision against the second triangle
-           callback.testTriangle(trianglePoints, verticesNormals2, computeTriangleShapeId(i, j, 1));
+           // Test collision against the two triangles of the current grid rectangle
+           reportCellTriangles(i, j, callback);
        }
    }
 }
 
+// Use a callback method on the two triangles of the grid cell with a given min (i,j) grid point
+void HeightFieldShape::reportCellTriangles(int i, int j, TriangleCallback& callback) const {
+
+    // Compute the four point of the current quad
+    const Vector3 p1 = getVertexAt(i, j);
+    const Vector3 p2 = getVertexAt(i, j + 1);
+    const Vector3 p3 = getVertexAt(i + 1, j);
+    const Vector3 p4 = getVertexAt(i + 1, j + 1);
+
+    // Generate the first triangle for the current grid rectangle
+    Vector3 trianglePoints[3] = {p1, p2, p3};
+
+    // Compute the triangle normal
+    Vector3 triangle1Normal = (p2 - p1).cross(p3 - p1).getUnit();
+
+    // Use the triangle face normal as vertices normals (this is an aproximation. The correct
+    // solution would be to compute all the normals of the neighbor triangles and use their
+    // weighted average (with incident angle as weight) at the vertices. However, this solution
+    // seems too expensive (it requires to compute the normal of all neighbor triangles instead
+    // and compute the angle of incident edges with asin(). Maybe we could also precompute the
+    // vertices normal at the HeightFieldShape constructor but it will require extra memory to
+    // store them.
+    Vector3 verticesNormals1[3] = {triangle1Normal, triangle1Normal, triangle1Normal};
+
+    // Test collision against the first triangle
+    callback.testTriangle(trianglePoints, verticesNormals1, computeTriangleShapeId(i, j, 0));
+
+    // Generate the second triangle for the current grid rectangle
+    trianglePoints[0] = p3;
+    trianglePoints[1] = p2;
+    trianglePoints[2] = p4;
+
+    // Compute the triangle normal
+    Vector3 triangle2Normal = (p2 - p3).cross(p4 - p3).getUnit();
+
+    // Use the triangle face normal as vertices normals (see above)
+    Vector3 verticesNormals2[3] = {triangle2Normal, triangle2Normal, triangle2Normal};
+
+    // Test collision against the second triangle
+    callback.testTriangle(trianglePoints, verticesNormals2, computeTriangleShapeId(i, j, 1));
+}
+
+// Use a callback method on the triangles of the cells of a tile of the min/max height hierarchy
+// that are inside a sub-grid of cells and whose height range overlaps a given height range
+void HeightFieldShape::testTileTriangles(TriangleCallback& callback, int level, int tileI, int tileJ, int iMin, int iMax,
+                                         int jMin, int jMax, decimal minHeight, decimal maxHeight) const {
+
+    // If the height range of the tile does not overlap the height range to test
+    const HeightFieldTile& tile = getHierarchyTile(level, tileI, tileJ);
+    if (tile.maxHeight < minHeight || tile.minHeight > maxHeight) return;
+
+    // If the tile is a tile of the first level, we test its cells
+    if (level == 0) {
+
+        const int cellIMin = std::max(iMin, tileI * NB_CELLS_PER_HIERARCHY_TILE);
+        const int cellIMax = std::min(iMax, tileI * NB_CELLS_PER_HIERARCHY_TILE + NB_CELLS_PER_HIERARCHY_TILE - 1);
+        const int cellJMin = std::max(jMin, tileJ * NB_CELLS_PER_HIERARCHY_TILE);
+        const int cellJMax = std::min(jMax, tileJ * NB_CELLS_PER_HIERARCHY_TILE + NB_CELLS_PER_HIERARCHY_TILE - 1);
+
+        for (int i = cellIMin; i <= cellIMax; i++) {
+            for (int j = cellJMin; j <= cellJMax; j++) {
+
+                // If the height range of the cell overlaps the height range to test
+                const decimal height1 = getLocalHeightAt(i, j);
+                const decimal height2 = getLocalHeightAt(i, j + 1);
+                const decimal height3 = getLocalHeightAt(i + 1, j);
+                const decimal height4 = getLocalHeightAt(i + 1, j + 1);
+                if (std::max(std::max(height1, height2), std::max(height3, height4)) >= minHeight &&
+                    std::min(std::min(height1, height2), std::min(height3, height4)) <= maxHeight) {
+
+                    reportCellTriangles(i, j, callback);
+                }
+            }
+        }
+
+        return;
+    }
+
+    // Test the children tiles that overlap the sub-grid
+    const int childTileSize = NB_CELLS_PER_HIERARCHY_TILE << (level - 1);
+    for (int childI = 2 * tileI; childI <= std::min(2 * tileI + 1, getNbHierarchyTilesI(level - 1) - 1); childI++) {
+        if (childI * childTileSize > iMax || (childI + 1) * childTileSize <= iMin) continue;
+        for (int childJ = 2 * tileJ; childJ <= std::min(2 * tileJ + 1, getNbHierarchyTilesJ(level - 1) - 1); childJ++) {
+            if (childJ * childTileSize > jMax || (childJ + 1) * childTileSize <= jMin) continue;
+            testTileTriangles(callback, level - 1, childI, childJ, iMin, iMax, jMin, jMax, minHeight, maxHeight);
+        }
+    }
+}
+
+// Compute the min/max heights of the cells of a tile of the min/max height hierarchy that are
+// inside a sub-grid of cells (the heights are merged into the minHeight and maxHeight values)
+void HeightFieldShape::computeTileHeightRange(int level, int tileI, int tileJ, int iMin, int iMax, int jMin, int jMax,
+                                              decimal& minHeight, decimal& maxHeight) const {
+
+    const int tileSize = NB_CELLS_PER_HIERARCHY_TILE << level;
+    const int tileCellIMin = tileI * tileSize;
+    const int tileCellJMin = tileJ * tileSize;
+    const int tileCellIMax = std::min(tileCellIMin + tileSize, mNbColumns - 1) - 1;
+    const int tileCellJMax = std::min(tileCellJMin + tileSize, mNbRows - 1) - 1;
+
+    // If the tile is inside the sub-grid, we use its height range
+    if (iMin <= tileCellIMin && tileCellIMax <= iMax && jMin <= tileCellJMin && tileCellJMax <= jMax) {
+        const HeightFieldTile& tile = getHierarchyTile(level, tileI, tileJ);
+        minHeight = std::min(minHeight, tile.minHeight);
+        maxHeight = std::max(maxHeight, tile.maxHeight);
+        return;
+    }
+
+    // If the tile is a tile of the first level, we use the heights of the grid points of its cells inside the sub-grid
+    if (level == 0) {
+        for (int j = std::max(jMin, tileCellJMin); j <= std::min(jMax, tileCellJMax) + 1; j++) {
+            for (int i = std::max(iMin, tileCellIMin); i <= std::min(iMax, tileCellIMax) + 1; i++) {
+                const decimal height = getLocalHeightAt(i, j);
+                minHeight = std::min(minHeight, height);
+                maxHeight = std::max(maxHeight, height);
+            }
+        }
+        return;
+    }
+
+    // Merge the height ranges of the children tiles that overlap the sub-grid
+    const int childTileSize = NB_CELLS_PER_HIERARCHY_TILE << (level - 1);
+    for (int childI = 2 * tileI; childI <= std::min(2 * tileI + 1, getNbHierarchyTilesI(level - 1) - 1); childI++) {
+        if (childI * childTileSize > iMax || (childI + 1) * childTileSize <= iMin) continue;
+        for (int childJ = 2 * tileJ; childJ <= std::min(2 * tileJ + 1, getNbHierarchyTilesJ(level - 1) - 1); childJ++) {
+            if (childJ * childTileSize > jMax || (childJ + 1) * childTileSize <= jMin) continue;
+            computeTileHeightRange(level - 1, childI, childJ, iMin, iMax, jMin, jMax, minHeight, maxHeight);
+        }
+    }
+}
+
 // Compute the min/max grid coords corresponding to the intersection of the AABB of the height field and
 // the AABB to collide
 void HeightFieldShape::computeMinMaxGridCoordinates(int* minCoords, int* maxCoords, const AABB& aabbToCollide) const {
@@ -213,12 +464,13 @@ void HeightFieldShape::computeMinMaxGridCoordinates(int* minCoords, int* maxCoor
 
 // Raycast method with feedback information
 /// Note that only the first triangle hit by the ray in the mesh will be returned, even if
-/// the ray hits many triangles.
+/// the ray hits many triangles. The cells of the grid crossed by the ray are visited from front
+/// to back with a 2D digital differential analyzer (DDA) walk and the triangles of a cell are only
+/// tested if the part of the ray inside the cell overlaps the height range of the cell. The walk
+/// stops at the first cell where a triangle is hit. When the min/max height hierarchy is enabled,
+/// the tiles of cells whose height range is not crossed by the ray are skipped at once.
 bool HeightFieldShape::raycast(const Ray& ray, RaycastInfo& raycastInfo, ProxyShape* proxyShape, MemoryAllocator& allocator) const {
 
-    // TODO : Implement raycasting without using an AABB for the ray
-    //        but using a dynamic AABB tree or octree instead
-
     RP3D_PROFILE("HeightFieldShape::raycast()", mProfiler);
 
     TriangleOverlapCallback triangleCallback(ray, proxyShape, raycastInfo, *this, allocator);
@@ -230,11 +482,162 @@ bool HeightFieldShape::raycast(const Ray& ray, RaycastInfo& raycastInfo, ProxySh
 
 #endif
 
-    // Compute the AABB for the ray
-    const Vector3 rayEnd = ray.point1 + ray.maxFraction * (ray.point2 - ray.point1);
-    const AABB rayAABB(Vector3::min(ray.point1, rayEnd), Vector3::max(ray.point1, rayEnd));
+    // Compute the ray in the non-scaled local-space where the cells of the grid have a unit size. Note
+    // that the ray fractions are the same in the scaled and non-scaled spaces.
+    const Vector3 inverseScaling(decimal(1.0) / mScaling.x, decimal(1.0) / mScaling.y, decimal(1.0) / mScaling.z);
+    const Vector3 point1 = ray.point1 * inverseScaling;
+    const Vector3 direction = (ray.point2 - ray.point1) * inverseScaling;
+
+    // Margin used to be robust to the rounding errors when the ray is clipped against the height field
+    const Vector3 aabbExtent = mAABB.getExtent();
+    const decimal margin = decimal(0.00001) * (decimal(1.0) + std::max(std::max(aabbExtent.x, aabbExtent.y), aabbExtent.z));
+
+    // Clip the ray against the AABB of the height field
+    const Vector3 aabbMin = mAABB.getMin() - Vector3(margin, margin, margin);
+    const Vector3 aabbMax = mAABB.getMax() + Vector3(margin, margin, margin);
+    decimal tMin = decimal(0.0);
+    decimal tMax = ray.maxFraction;
+    for (int axis = 0; axis < 3; axis++) {
+
+        if (std::abs(direction[axis]) < MACHINE_EPSILON) {
+            if (point1[axis] < aabbMin[axis] || point1[axis] > aabbMax[axis]) return false;
+        }
+        else {
+            const decimal inverseDirection = decimal(1.0) / direction[axis];
+            decimal t1 = (aabbMin[axis] - point1[axis]) * inverseDirection;
+            decimal t2 = (aabbMax[axis] - point1[axis]) * inverseDirection;
+            if (t1 > t2) std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) return false;
+        }
+    }
 
-    testAllTriangles(triangleCallback, rayAABB);
+    // Axes of the local-space along the columns (i) and the rows (j) of the grid
+    const int iAxis = mUpAxis == 0 ? 1 : 0;
+    const int jAxis = mUpAxis == 2 ? 1 : 2;
+
+    // Grid coordinates of the ray origin and direction
+    const decimal gridOriginI = point1[iAxis] + mWidth * decimal(0.5);
+    const decimal gridOriginJ = point1[jAxis] + mLength * decimal(0.5);
+    const decimal gridDirectionI = std::abs(direction[iAxis]) < MACHINE_EPSILON ? decimal(0.0) : direction[iAxis];
+    const decimal gridDirectionJ = std::abs(direction[jAxis]) < MACHINE_EPSILON ? decimal(0.0) : direction[jAxis];
+
+    // Cell of the grid where the ray enters the height field
+    int i = clamp(static_cast<int>(std::floor(gridOriginI + tMin * gridDirectionI)), 0, mNbColumns - 2);
+    int j = clamp(static_cast<int>(std::floor(gridOriginJ + tMin * gridDirectionJ)), 0, mNbRows - 2);
+
+    // Step between two cells and inverse of the direction along each grid axis
+    const int stepI = gridDirectionI < decimal(0.0) ? -1 : 1;
+    const int stepJ = gridDirectionJ < decimal(0.0) ? -1 : 1;
+    const decimal inverseDirectionI = gridDirectionI != decimal(0.0) ? decimal(1.0) / gridDirectionI : decimal(0.0);
+    const decimal inverseDirectionJ = gridDirectionJ != decimal(0.0) ? decimal(1.0) / gridDirectionJ : decimal(0.0);
+
+    // Walk through the cells crossed by the ray from front to back
+    decimal tCellEnter = tMin;
+    while (true) {
+
+        const decimal rayHeight1 = point1[mUpAxis] + tCellEnter * direction[mUpAxis];
+
+        // If the min/max height hierarchy is enabled, we look for the largest tile containing the current
+        // cell whose height range is not overlapped by the ray between the cell and the exit of the tile
+        if (mHierarchyTiles != nullptr) {
+
+            bool isTileSkipped = false;
+            decimal tSkippedTileExit = 0;
+            int nextCellI = i;
+            int nextCellJ = j;
+            for (int level = 0; level < mNbHierarchyLevels; level++) {
+
+                // Compute the grid lines at the boundaries of the tile containing the current cell
+                const int tileSize = NB_CELLS_PER_HIERARCHY_TILE << level;
+                const int tileI = i / tileSize;
+                const int tileJ = j / tileSize;
+                const int tileStartI = tileI * tileSize;
+                const int tileStartJ = tileJ * tileSize;
+                const int tileEndI = std::min(tileStartI + tileSize, mNbColumns - 1);
+                const int tileEndJ = std::min(tileStartJ + tileSize, mNbRows - 1);
+
+                // Compute the ray fraction where the ray exits the tile
+                const decimal tExitI = gridDirectionI != decimal(0.0) ?
+                                       ((stepI > 0 ? tileEndI : tileStartI) - gridOriginI) * inverseDirectionI : DECIMAL_LARGEST;
+                const decimal tExitJ = gridDirectionJ != decimal(0.0) ?
+                                       ((stepJ > 0 ? tileEndJ : tileStartJ) - gridOriginJ) * inverseDirectionJ : DECIMAL_LARGEST;
+                const decimal tTileExit = std::min(std::min(tExitI, tExitJ), tMax);
+
+                // If the ray overlaps the height range of the tile, it cannot be skipped
+                const decimal rayHeight2 = point1[mUpAxis] + tTileExit * direction[mUpAxis];
+                const HeightFieldTile& tile = getHierarchyTile(level, tileI, tileJ);
+                if (std::max(rayHeight1, rayHeight2) >= tile.minHeight - margin &&
+                    std::min(rayHeight1, rayHeight2) <= tile.maxHeight + margin) {
+                    break;
+                }
+
+                // Compute the first cell after the tile
+                isTileSkipped = true;
+                tSkippedTileExit = tTileExit;
+                if (tExitI < tExitJ) {
+                    nextCellI = stepI > 0 ? tileEndI : tileStartI - 1;
+                    nextCellJ = clamp(static_cast<int>(std::floor(gridOriginJ + tTileExit * gridDirectionJ)), tileStartJ, tileEndJ - 1);
+                }
+                else {
+                    nextCellI = clamp(static_cast<int>(std::floor(gridOriginI + tTileExit * gridDirectionI)), tileStartI, tileEndI - 1);
+                    nextCellJ = stepJ > 0 ? tileEndJ : tileStartJ - 1;
+                }
+            }
+
+            if (isTileSkipped) {
+
+                if (tSkippedTileExit >= tMax) break;
+
+                i = nextCellI;
+                j = nextCellJ;
+                if (i < 0 || i > mNbColumns - 2 || j < 0 || j > mNbRows - 2) break;
+                tCellEnter = tSkippedTileExit;
+                continue;
+            }
+        }
+
+        // Compute the ray fraction of the next cell boundary along each grid axis
+        const decimal nextI = gridDirectionI != decimal(0.0) ? (i + (stepI > 0 ? 1 : 0) - gridOriginI) * inverseDirectionI : DECIMAL_LARGEST;
+        const decimal nextJ = gridDirectionJ != decimal(0.0) ? (j + (stepJ > 0 ? 1 : 0) - gridOriginJ) * inverseDirectionJ : DECIMAL_LARGEST;
+        const decimal tCellExit = std::min(std::min(nextI, nextJ), tMax);
+
+        // Compute the height range of the part of the ray inside the cell
+        const decimal rayHeight2 = point1[mUpAxis] + tCellExit * direction[mUpAxis];
+
+        // Compute the height range of the cell
+        const decimal height1 = getLocalHeightAt(i, j);
+        const decimal height2 = getLocalHeightAt(i, j + 1);
+        const decimal height3 = getLocalHeightAt(i + 1, j);
+        const decimal height4 = getLocalHeightAt(i + 1, j + 1);
+        const decimal cellMinHeight = std::min(std::min(height1, height2), std::min(height3, height4));
+        const decimal cellMaxHeight = std::max(std::max(height1, height2), std::max(height3, height4));
+
+        // If the ray can hit the triangles of the cell
+        if (std::max(rayHeight1, rayHeight2) >= cellMinHeight - margin &&
+            std::min(rayHeight1, rayHeight2) <= cellMaxHeight + margin) {
+
+            reportCellTriangles(i, j, triangleCallback);
+
+            // The triangles of the next cells can only be hit further along the ray
+            if (triangleCallback.getIsHit()) break;
+        }
+
+        if (tCellExit >= tMax) break;
+
+        // Move to the next cell crossed by the ray
+        if (nextI < nextJ) {
+            i += stepI;
+            if (i < 0 || i > mNbColumns - 2) break;
+            tCellEnter = nextI;
+        }
+        else {
+            j += stepJ;
+            if (j < 0 || j > mNbRows - 2) break;
+            tCellEnter = nextJ;
+        }
+    }
 
     return triangleCallback.getIsHit();
 }
@@ -242,19 +645,16 @@ bool HeightFieldShape::raycast(const Ray& ray, RaycastInfo& raycastInfo, ProxySh
 // Return the vertex (local-coordinates) of the height field at a given (x,y) position
 Vector3 HeightFieldShape::getVertexAt(int x, int y) const {
 
-    // Get the height value
-    const decimal height = getHeightAt(x, y);
-
-    // Height values origin
-    const decimal heightOrigin = -(mMaxHeight - mMinHeight) * decimal(0.5) - mMinHeight;
+    // Get the height value in local-space
+    const decimal height = getLocalHeightAt(x, y);
 
     Vector3 vertex;
     switch (mUpAxis) {
-        case 0: vertex = Vector3(heightOrigin + height, -mWidth * decimal(0.5) + x, -mLength * decimal(0.5) + y);
+        case 0: vertex = Vector3(height, -mWidth * decimal(0.5) + x, -mLength * decimal(0.5) + y);
                 break;
-        case 1: vertex = Vector3(-mWidth * decimal(0.5) + x, heightOrigin + height, -mLength * decimal(0.5) + y);
+        case 1: vertex = Vector3(-mWidth * decimal(0.5) + x, height, -mLength * decimal(0.5) + y);
                 break;
-        case 2: vertex = Vector3(-mWidth * decimal(0.5) + x, -mLength * decimal(0.5) + y, heightOrigin + height);
+        case 2: vertex = Vector3(-mWidth * decimal(0.5) + x, -mLength * decimal(0.5) + y, height);
                 break;
         default: assert(false);
     }
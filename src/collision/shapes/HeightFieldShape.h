@@ -36,6 +36,23 @@ class HeightFieldShape;
 class Profiler;
 class TriangleShape;
 
+// Structure HeightFieldTile
+/**
+ * This structure represents the minimum and maximum heights of a square tile of cells
+ * of the grid of a height field. The tiles are stored in the min/max height hierarchy
+ * of the HeightFieldShape.
+ */
+struct HeightFieldTile {
+
+    // -------------------- Attributes -------------------- //
+
+    /// Minimum height of the vertices of the tile (in local-space without scaling)
+    decimal minHeight;
+
+    /// Maximum height of the vertices of the tile (in local-space without scaling)
+    decimal maxHeight;
+};
+
 // Class TriangleOverlapCallback
 /**
  * This class is used for testing AABB and triangle overlap for raycasting
@@ -107,6 +124,11 @@ class HeightFieldShape : public ConcaveShape {
 
     protected:
 
+        // -------------------- Constants -------------------- //
+
+        /// Number of cells along each side of a tile of the first level of the min/max height hierarchy
+        static const int NB_CELLS_PER_HIERARCHY_TILE = 4;
+
         // -------------------- Attributes -------------------- //
 
         /// Number of columns in the grid of the height field
@@ -145,6 +167,23 @@ class HeightFieldShape : public ConcaveShape {
         /// Scaling vector
         const Vector3 mScaling;
 
+        /// Tiles of all the levels of the min/max height hierarchy (null if the hierarchy is not
+        /// enabled). The tiles of a level cover twice as many cells along each side as the tiles
+        /// of the previous level and the last level has a single tile.
+        HeightFieldTile* mHierarchyTiles;
+
+        /// Index of the first tile of each level of the min/max height hierarchy
+        uint* mHierarchyLevelsFirstTile;
+
+        /// Number of levels of the min/max height hierarchy
+        int mNbHierarchyLevels;
+
+        /// Memory allocated for the min/max height hierarchy
+        void* mHierarchyMemory;
+
+        /// Size in bytes of the memory allocated for the min/max height hierarchy
+        size_t mHierarchyMemorySize;
+
         // -------------------- Methods -------------------- //
 
         /// Raycast method with feedback information
@@ -167,6 +206,29 @@ class HeightFieldShape : public ConcaveShape {
         /// Compute the min/max grid coords corresponding to the intersection of the AABB of the height field and the AABB to collide
         void computeMinMaxGridCoordinates(int* minCoords, int* maxCoords, const AABB& aabbToCollide) const;
 
+        /// Use a callback method on the two triangles of a cell of the grid
+        void reportCellTriangles(int i, int j, TriangleCallback& callback) const;
+
+        /// Return the height of a grid point in local-space without scaling
+        decimal getLocalHeightAt(int x, int y) const;
+
+        /// Return the number of tiles along the columns of a level of the min/max height hierarchy
+        int getNbHierarchyTilesI(int level) const;
+
+        /// Return the number of tiles along the rows of a level of the min/max height hierarchy
+        int getNbHierarchyTilesJ(int level) const;
+
+        /// Return a tile of the min/max height hierarchy
+        const HeightFieldTile& getHierarchyTile(int level, int tileI, int tileJ) const;
+
+        /// Use a callback method on the triangles of the cells of a tile inside a sub-grid and a height range
+        void testTileTriangles(TriangleCallback& callback, int level, int tileI, int tileJ, int iMin, int iMax,
+                               int jMin, int jMax, decimal minHeight, decimal maxHeight) const;
+
+        /// Compute the min/max heights of the cells of a tile inside a sub-grid
+        void computeTileHeightRange(int level, int tileI, int tileJ, int iMin, int iMax, int jMin, int jMax,
+                                    decimal& minHeight, decimal& maxHeight) const;
+
         /// Compute the shape Id for a given triangle
         uint computeTriangleShapeId(uint iIndex, uint jIndex, uint secondTriangleIncrement) const;
 
@@ -179,7 +241,7 @@ class HeightFieldShape : public ConcaveShape {
                          const Vector3& scaling = Vector3(1,1,1));
 
         /// Destructor
-        virtual ~HeightFieldShape() override = default;
+        virtual ~HeightFieldShape() override;
 
         /// Deleted copy-constructor
         HeightFieldShape(const HeightFieldShape& shape) = delete;
@@ -205,6 +267,15 @@ class HeightFieldShape : public ConcaveShape {
         /// Return the type of height value in the height field
         HeightDataType getHeightDataType() const;
 
+        /// Enable/disable the min/max height hierarchy of the height field
+        void enableMinMaxHeightHierarchy(bool isEnabled);
+
+        /// Return true if the min/max height hierarchy of the height field is enabled
+        bool isMinMaxHeightHierarchyEnabled() const;
+
+        /// Return the local bounds of the triangles of a rectangular region of the grid
+        void getRegionLocalBounds(int minColumn, int minRow, int maxColumn, int maxRow, Vector3& min, Vector3& max) const;
+
         /// Return the local bounds of the shape in x, y and z directions.
         virtual void getLocalBounds(Vector3& min, Vector3& max) const override;
 
@@ -243,6 +314,11 @@ inline HeightFieldShape::HeightDataType HeightFieldShape::getHeightDataType() co
     return mHeightDataType;
 }
 
+// Return true if the min/max height hierarchy of the height field is enabled
+inline bool HeightFieldShape::isMinMaxHeightHierarchyEnabled() const {
+    return mHierarchyTiles != nullptr;
+}
+
 // Return the number of bytes used by the collision shape
 inline size_t HeightFieldShape::getSizeInBytes() const {
     return sizeof(HeightFieldShape);
@@ -259,6 +335,30 @@ inline decimal HeightFieldShape::getHeightAt(int x, int y) const {
     }
 }
 
+// Return the height of a grid point in local-space without scaling
+inline decimal HeightFieldShape::getLocalHeightAt(int x, int y) const {
+    return getHeightAt(x, y) - (mMaxHeight - mMinHeight) * decimal(0.5) - mMinHeight;
+}
+
+// Return the number of tiles along the columns of a level of the min/max height hierarchy
+inline int HeightFieldShape::getNbHierarchyTilesI(int level) const {
+    return (mNbColumns - 2) / (NB_CELLS_PER_HIERARCHY_TILE << level) + 1;
+}
+
+// Return the number of tiles along the rows of a level of the min/max height hierarchy
+inline int HeightFieldShape::getNbHierarchyTilesJ(int level) const {
+    return (mNbRows - 2) / (NB_CELLS_PER_HIERARCHY_TILE << level) + 1;
+}
+
+// Return a tile of the min/max height hierarchy
+inline const HeightFieldTile& HeightFieldShape::getHierarchyTile(int level, int tileI, int tileJ) const {
+    assert(mHierarchyTiles != nullptr);
+    assert(level >= 0 && level < mNbHierarchyLevels);
+    assert(tileI >= 0 && tileI < getNbHierarchyTilesI(level));
+    assert(tileJ >= 0 && tileJ < getNbHierarchyTilesJ(level));
+    return mHierarchyTiles[mHierarchyLevelsFirstTile[level] + tileJ * getNbHierarchyTilesI(level) + tileI];
+}
+
 // Return the closest inside integer grid value of a given floating grid value
 inline int HeightFieldShape::computeIntegerGridValue(decimal value) const {
     return (value < decimal(0.0)) ? value - decimal(0.5) : value + decimal(0.5);
@@ -47,6 +47,10 @@
 /// Namespace reactphysics3d
 namespace reactphysics3d {
 
+// Declarations
+class MemoryAllocator;
+class SingleFrameAllocator;
+
 // ------------------- Type definitions ------------------- //
 
 using uint = unsigned int;
@@ -62,6 +66,8 @@ using int16 = std::int16_t;
 using uint16 = std::uint16_t;
 using int32 = std::int32_t;
 using uint32 = std::uint32_t;
+using int64 = std::int64_t;
+using uint64 = std::uint64_t;
 
 // ------------------- Enumerations ------------------- //
 
@@ -78,6 +84,26 @@ enum class JointsPositionCorrectionTechnique {BAUMGARTE_JOINTS, NON_LINEAR_GAUSS
 ///                 bodies momentum. This is the option used by default.
 enum class ContactsPositionCorrectionTechnique {BAUMGARTE_CONTACTS, SPLIT_IMPULSES};
 
+/// Algorithm used by the broad-phase collision detection
+/// DYNAMIC_AABB_TREE : Dynamic AABB tree. Only the shapes that have moved are tested. This
+///                     is the option used by default.
+/// SWEEP_AND_PRUNE : Persistent array of AABBs kept sorted along an axis. Only the shapes that
+///                   have moved are swept. It is meant for scenes of small objects where most
+///                   of the shapes move at each frame. The very large shapes (like a ground
+///                   plane) make the search of each moved shape longer and the ray casting and
+///                   the AABB queries test all the shapes after a shape has moved until the
+///                   next update of the overlapping pairs.
+enum class BroadPhaseType {DYNAMIC_AABB_TREE, SWEEP_AND_PRUNE};
+
+/// Method used to update the dynamic AABB trees of the broad-phase when a shape moves
+/// out of its fat AABB
+/// REINSERT : The leaf of the shape is removed and inserted again into the tree. This
+///            is the option used by default.
+/// REFIT : The fat AABB of the leaf is changed in place and the AABBs of its ancestors
+///         are refitted bottom-up once per step. The tree is rebuilt when its quality
+///         has degraded too much. It is faster when many shapes move slowly.
+enum class DynamicTreeUpdateMethod {REINSERT, REFIT};
+
 // ------------------- Constants ------------------- //
 
 /// Smallest decimal value (negative)
@@ -105,6 +131,14 @@ constexpr decimal DYNAMIC_TREE_AABB_GAP = decimal(0.1);
 /// followin constant with the linear velocity and the elapsed time between two frames.
 constexpr decimal DYNAMIC_TREE_AABB_LIN_GAP_MULTIPLIER = decimal(1.7);
 
+/// Maximum ratio between the SAH cost of a dynamic AABB tree updated with the REFIT
+/// method and its cost after its last rebuild when no ratio is given in the WorldSettings
+constexpr decimal DYNAMIC_TREE_REFIT_REBUILD_COST_RATIO = decimal(1.5);
+
+/// Number of collision layers of the proxy shapes. The collision layers matrix of a
+/// world stores one 64-bits mask per layer and a layer is therefore a value in [0, 63]
+constexpr uint NB_COLLISION_LAYERS = 64;
+
 /// Current version of ReactPhysics3D
 const std::string RP3D_VERSION = std::string("0.7.1");
 
@@ -165,6 +199,56 @@ struct WorldSettings {
     /// than the value bellow, the manifold are considered to be similar.
     decimal cosAngleSimilarContactManifold = decimal(0.95);
 
+    /// Base memory allocator used by the world. If it is null, the global base
+    /// allocator of the MemoryManager is used. Note that this allocator is called
+    /// during the update of the world and therefore must be thread-safe if it is
+    /// shared with other worlds that are updated on different threads.
+    MemoryAllocator* baseMemoryAllocator = nullptr;
+
+    /// Pool memory allocator used by the world. If it is null, the world creates
+    /// its own pool allocator.
+    MemoryAllocator* poolMemoryAllocator = nullptr;
+
+    /// Single frame memory allocator used by the world. If it is null, the world
+    /// creates its own single frame allocator.
+    SingleFrameAllocator* singleFrameMemoryAllocator = nullptr;
+
+    /// Number of frames between two automatic trims of the memory allocators of a
+    /// dynamics world. When the allocators are trimmed, their unused memory is returned
+    /// to the base allocator. If it is zero, the allocators are never trimmed automatically.
+    /// A pool allocator that is shared with other worlds (a ThreadCachingPoolAllocator for
+    /// instance) must not be trimmed while another world uses it on a different thread.
+    uint nbFramesBetweenMemoryTrims = 0;
+
+    /// Number of overlapping pairs for which memory is reserved when the world is created.
+    /// The map of overlapping pairs is rehashed incrementally when it grows but reserving
+    /// enough memory for a world whose number of pairs ramps up avoids any rehashing.
+    uint nbReservedOverlappingPairs = 0;
+
+    /// Number of threads used to compute the overlapping pairs of the broad-phase. If it is
+    /// larger than one, the tree queries of the shapes that have moved are split across worker
+    /// threads when there are enough moved shapes. The overlapping pairs are reported in the same
+    /// order whatever the number of threads. Each worker thread has its own pool allocator whose
+    /// memory is allocated with the base allocator of the world that must therefore be thread-safe.
+    uint nbBroadPhaseThreads = 1;
+
+    /// Algorithm used by the broad-phase collision detection. The sweep-and-prune broad-phase
+    /// always uses a single thread.
+    BroadPhaseType broadPhaseType = BroadPhaseType::DYNAMIC_AABB_TREE;
+
+    /// Maximum ratio between the current SAH cost of a dynamic AABB tree of the broad-phase and
+    /// its cost after its last rebuild. The cost of the trees is checked periodically and a tree
+    /// is rebuilt top-down with the surface area heuristic when its cost exceeds this ratio (a tree
+    /// that has never been rebuilt is rebuilt at the first check). If it is zero, the trees are
+    /// never rebuilt.
+    decimal dynamicTreeRebuildCostRatio = decimal(0.0);
+
+    /// Method used to update the dynamic AABB trees of the broad-phase when a shape moves out of
+    /// its fat AABB. With the REFIT method, the trees are always rebuilt when their SAH cost has
+    /// grown too much (with the DYNAMIC_TREE_REFIT_REBUILD_COST_RATIO ratio if the
+    /// dynamicTreeRebuildCostRatio setting is zero).
+    DynamicTreeUpdateMethod dynamicTreeUpdateMethod = DynamicTreeUpdateMethod::REINSERT;
+
     /// Return a string with the world settings
     std::string to_string() const {
 
@@ -185,6 +269,12 @@ struct WorldSettings {
         ss << "nbMaxContactManifoldsConvexShape=" << nbMaxContactManifoldsConvexShape << std::endl;
         ss << "nbMaxContactManifoldsConcaveShape=" << nbMaxContactManifoldsConcaveShape << std::endl;
         ss << "cosAngleSimilarContactManifold=" << cosAngleSimilarContactManifold << std::endl;
+        ss << "nbFramesBetweenMemoryTrims=" << nbFramesBetweenMemoryTrims << std::endl;
+        ss << "nbReservedOverlappingPairs=" << nbReservedOverlappingPairs << std::endl;
+        ss << "nbBroadPhaseThreads=" << nbBroadPhaseThreads << std::endl;
+        ss << "broadPhaseType=" << (broadPhaseType == BroadPhaseType::DYNAMIC_AABB_TREE ? "DYNAMIC_AABB_TREE" : "SWEEP_AND_PRUNE") << std::endl;
+        ss << "dynamicTreeRebuildCostRatio=" << dynamicTreeRebuildCostRatio << std::endl;
+        ss << "dynamicTreeUpdateMethod=" << (dynamicTreeUpdateMethod == DynamicTreeUpdateMethod::REINSERT ? "REINSERT" : "REFIT") << std::endl;
 
         return ss.str();
     }
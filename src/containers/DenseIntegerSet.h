@@ -0,0 +1,405 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_DENSE_INTEGER_SET_H
+#define REACTPHYSICS3D_DENSE_INTEGER_SET_H
+
+// Libraries
+#include "memory/MemoryAllocator.h"
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <iterator>
+
+
+namespace reactphysics3d {
+
+// Class DenseIntegerSet
+/**
+ * This class represents a set of small non-negative integers (the broad-phase ids for
+ * instance). A bit-set with one bit per possible integer is used to test if an integer
+ * is in the set. The integers of the set are also stored contiguously in an array so that
+ * the set can be iterated and cleared in a time proportional to its size (and not to the
+ * largest integer of the set). The position of each integer in that array is stored so that
+ * an integer can be removed in constant time by moving the last integer of the array at its
+ * place. Therefore, the order of iteration is the order of insertion until an integer is
+ * removed. The memory used by the set is proportional to the largest integer of the set.
+ */
+class DenseIntegerSet {
+
+    private:
+
+        // -------------------- Constants -------------------- //
+
+        /// Number of bits in a word of the bit-set
+        static const int NB_BITS_PER_WORD = 64;
+
+        /// Minimum number of values of the range of the set
+        static const int MIN_RANGE = 64;
+
+        // -------------------- Attributes -------------------- //
+
+        /// Number of integers in the set
+        int mNbElements;
+
+        /// The integers in the set are in the range [0, mRange)
+        int mRange;
+
+        /// Bit-set with a bit for each integer of the range
+        uint64_t* mBits;
+
+        /// Array with the integers of the set
+        int* mElements;
+
+        /// Index in the array of elements of each integer of the set
+        int* mPositions;
+
+        /// Memory allocator
+        MemoryAllocator& mAllocator;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the number of words of the bit-set for a given range
+        static int getNbWords(int range) {
+            return range / NB_BITS_PER_WORD;
+        }
+
+        /// Return true if a given integer of the range has its bit set
+        bool isBitSet(int value) const {
+            return (mBits[value / NB_BITS_PER_WORD] >> (value % NB_BITS_PER_WORD)) & 1;
+        }
+
+        /// Change the range of integers of the set
+        void setRange(int range) {
+
+            assert(range % NB_BITS_PER_WORD == 0);
+            assert(range >= mRange);
+
+            uint64_t* newBits = static_cast<uint64_t*>(mAllocator.allocate(getNbWords(range) * sizeof(uint64_t)));
+            int* newElements = static_cast<int*>(mAllocator.allocate(range * sizeof(int)));
+            int* newPositions = static_cast<int*>(mAllocator.allocate(range * sizeof(int)));
+
+            std::memset(newBits, 0, getNbWords(range) * sizeof(uint64_t));
+
+            if (mRange > 0) {
+
+                std::memcpy(newBits, mBits, getNbWords(mRange) * sizeof(uint64_t));
+                std::memcpy(newElements, mElements, mNbElements * sizeof(int));
+                std::memcpy(newPositions, mPositions, mRange * sizeof(int));
+
+                releaseMemory();
+            }
+
+            mRange = range;
+            mBits = newBits;
+            mElements = newElements;
+            mPositions = newPositions;
+        }
+
+        /// Release the memory of the arrays
+        void releaseMemory() {
+
+            mAllocator.release(mBits, getNbWords(mRange) * sizeof(uint64_t));
+            mAllocator.release(mElements, mRange * sizeof(int));
+            mAllocator.release(mPositions, mRange * sizeof(int));
+        }
+
+        /// Release the memory and reset the set
+        void reset() {
+
+            if (mRange > 0) {
+
+                releaseMemory();
+
+                mNbElements = 0;
+                mRange = 0;
+                mBits = nullptr;
+                mElements = nullptr;
+                mPositions = nullptr;
+            }
+        }
+
+    public:
+
+        /// Class Iterator
+        /**
+         * This class represents an iterator for the DenseIntegerSet
+         */
+        class Iterator {
+
+            private:
+
+                /// Array of the integers of the set
+                const int* mElements;
+
+                /// Index of the current element
+                int mCurrentIndex;
+
+                friend class DenseIntegerSet;
+
+            public:
+
+                // Iterator traits
+                using value_type = int;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const int*;
+                using reference = const int&;
+                using iterator_category = std::forward_iterator_tag;
+
+                /// Constructor
+                Iterator() = default;
+
+                /// Constructor
+                Iterator(const int* elements, int currentIndex)
+                     :mElements(elements), mCurrentIndex(currentIndex) {
+
+                }
+
+                /// Deferencable
+                reference operator*() const {
+                    return mElements[mCurrentIndex];
+                }
+
+                /// Deferencable
+                pointer operator->() const {
+                    return &(mElements[mCurrentIndex]);
+                }
+
+                /// Pre increment (++it)
+                Iterator& operator++() {
+                    mCurrentIndex++;
+                    return *this;
+                }
+
+                /// Post increment (it++)
+                Iterator operator++(int number) {
+                    Iterator tmp = *this;
+                    mCurrentIndex++;
+                    return tmp;
+                }
+
+                /// Equality operator (it == end())
+                bool operator==(const Iterator& iterator) const {
+                    return mCurrentIndex == iterator.mCurrentIndex && mElements == iterator.mElements;
+                }
+
+                /// Inequality operator (it != end())
+                bool operator!=(const Iterator& iterator) const {
+                    return !(*this == iterator);
+                }
+        };
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        DenseIntegerSet(MemoryAllocator& allocator, int range = 0)
+            : mNbElements(0), mRange(0), mBits(nullptr), mElements(nullptr), mPositions(nullptr),
+              mAllocator(allocator) {
+
+            if (range > 0) {
+                reserve(range);
+            }
+        }
+
+        /// Copy constructor
+        DenseIntegerSet(const DenseIntegerSet& set)
+            : mNbElements(0), mRange(0), mBits(nullptr), mElements(nullptr), mPositions(nullptr),
+              mAllocator(set.mAllocator) {
+
+            *this = set;
+        }
+
+        /// Destructor
+        ~DenseIntegerSet() {
+
+            reset();
+        }
+
+        /// Allocate memory for the integers in the range [0, range)
+        void reserve(int range) {
+
+            if (range <= mRange) return;
+
+            int newRange = mRange > 0 ? mRange : MIN_RANGE;
+            while (newRange < range) {
+                newRange *= 2;
+            }
+
+            setRange(newRange);
+        }
+
+        /// Return true if the set contains a given integer
+        bool contains(int value) const {
+            assert(value >= 0);
+            return value < mRange && isBitSet(value);
+        }
+
+        /// Add a non-negative integer into the set
+        void add(int value) {
+
+            assert(value >= 0);
+
+            if (value >= mRange) {
+                reserve(value + 1);
+            }
+            else if (isBitSet(value)) {
+                return;
+            }
+
+            mBits[value / NB_BITS_PER_WORD] |= uint64_t(1) << (value % NB_BITS_PER_WORD);
+            mElements[mNbElements] = value;
+            mPositions[value] = mNbElements;
+            mNbElements++;
+        }
+
+        /// Remove the element pointed by some iterator
+        /// This method returns an iterator pointing to the element that has
+        /// taken the place of the removed one (or to the end)
+        Iterator remove(const Iterator& it) {
+
+            assert(it.mElements == mElements);
+            assert(it.mCurrentIndex >= 0 && it.mCurrentIndex < mNbElements);
+
+            return remove(mElements[it.mCurrentIndex]);
+        }
+
+        /// Remove an integer from the set
+        /// This method returns an iterator pointing to the element that has
+        /// taken the place of the removed one (or to the end)
+        Iterator remove(int value) {
+
+            if (!contains(value)) {
+                return end();
+            }
+
+            mBits[value / NB_BITS_PER_WORD] &= ~(uint64_t(1) << (value % NB_BITS_PER_WORD));
+
+            // Move the last integer of the array at the place of the removed one
+            const int position = mPositions[value];
+            const int lastValue = mElements[mNbElements - 1];
+            mElements[position] = lastValue;
+            mPositions[lastValue] = position;
+            mNbElements--;
+
+            return Iterator(mElements, position);
+        }
+
+        /// Clear the set
+        void clear() {
+
+            // Only the bits of the integers in the set need to be reset
+            for (int i=0; i < mNbElements; i++) {
+                mBits[mElements[i] / NB_BITS_PER_WORD] = 0;
+            }
+
+            mNbElements = 0;
+        }
+
+        /// Return the number of elements in the set
+        int size() const {
+            return mNbElements;
+        }
+
+        /// Return the range of the integers that can be added without allocating memory
+        int capacity() const {
+            return mRange;
+        }
+
+        /// Return the integer at a given index (the integers are indexed in their order of insertion
+        /// except that the last integer takes the index of a removed one)
+        int operator[](int index) const {
+            assert(index >= 0 && index < mNbElements);
+            return mElements[index];
+        }
+
+        /// Try to find an integer of the set.
+        /// The method returns an iterator to the found integer or
+        /// an iterator pointing to the end if not found
+        Iterator find(int value) const {
+
+            if (!contains(value)) {
+                return end();
+            }
+
+            return Iterator(mElements, mPositions[value]);
+        }
+
+        /// Overloaded equality operator
+        bool operator==(const DenseIntegerSet& set) const {
+
+            if (size() != set.size()) return false;
+
+            for (int i=0; i < mNbElements; i++) {
+                if (!set.contains(mElements[i])) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// Overloaded not equal operator
+        bool operator!=(const DenseIntegerSet& set) const {
+
+            return !((*this) == set);
+        }
+
+        /// Overloaded assignment operator
+        DenseIntegerSet& operator=(const DenseIntegerSet& set) {
+
+            // Check for self assignment
+            if (this != &set) {
+
+                // Reset the set
+                reset();
+
+                if (set.mRange > 0) {
+
+                    setRange(set.mRange);
+
+                    std::memcpy(mBits, set.mBits, getNbWords(mRange) * sizeof(uint64_t));
+                    std::memcpy(mElements, set.mElements, set.mNbElements * sizeof(int));
+                    std::memcpy(mPositions, set.mPositions, mRange * sizeof(int));
+                    mNbElements = set.mNbElements;
+                }
+            }
+
+            return *this;
+        }
+
+        /// Return a begin iterator
+        Iterator begin() const {
+            return Iterator(mElements, 0);
+        }
+
+        /// Return a end iterator
+        Iterator end() const {
+            return Iterator(mElements, mNbElements);
+        }
+};
+
+}
+
+#endif
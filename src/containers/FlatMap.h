@@ -0,0 +1,918 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_FLAT_MAP_H
+#define REACTPHYSICS3D_FLAT_MAP_H
+
+// Libraries
+#include "memory/MemoryAllocator.h"
+#include "containers/Pair.h"
+#include "containers/containers_common.h"
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+
+
+namespace reactphysics3d {
+
+// Class FlatMap
+/**
+ * This class represents a generic associative map implemented with an open-addressing
+ * hash table. The key/value pairs are stored directly in the array of slots of the table
+ * (instead of being allocated separately as in the Map class) and a control byte is
+ * associated with each slot. The control byte of a used slot contains seven bits of the
+ * hash value of its key so that most of the slots that do not contain the searched key
+ * are skipped without reading their key. The slots are searched with linear probing by
+ * groups of consecutive control bytes that are matched at once (see ControlGroup).
+ * A removed element leaves a "deleted" control byte in its slot and therefore, removing
+ * an element does not move the other elements of the map. The iterators to the other
+ * elements stay valid after a removal. The iterators are invalidated when an element is
+ * added into the map.
+ * When the incremental rehashing is enabled, the table is not rehashed all at once when it
+ * grows. The elements are kept in the previous table and a bounded number of its slots is
+ * moved into the new table each time an element is added. This avoids the latency spike of
+ * a rehashing of a large map. The elements that have not been moved yet are still found
+ * and iterated.
+ */
+template<typename K, typename V>
+class FlatMap {
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        /// Number of slots of the table (zero or a power of two)
+        int mNbSlots;
+
+        /// Number of elements in the map
+        int mNbElements;
+
+        /// Number of elements that can still be added into empty slots before the table
+        /// has to be rehashed
+        int mGrowthLeft;
+
+        /// Array with the control byte of each slot. The control bytes of the first slots
+        /// are copied at the end of the array so that a group can be loaded at any slot.
+        int8_t* mControls;
+
+        /// Array with the slots that contain the key/value pairs
+        Pair<K, V>* mSlots;
+
+        /// Number of slots of the previous table during an incremental rehashing (zero otherwise)
+        int mOldNbSlots;
+
+        /// Number of elements that are still in the previous table
+        int mOldNbElements;
+
+        /// Index of the next slot of the previous table to move into the new table
+        int mOldNextSlot;
+
+        /// Array with the control bytes of the previous table
+        int8_t* mOldControls;
+
+        /// Array with the slots of the previous table
+        Pair<K, V>* mOldSlots;
+
+        /// True if the table is rehashed incrementally when it grows
+        bool mIsIncrementalRehashingEnabled;
+
+        /// Memory allocator
+        MemoryAllocator& mAllocator;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the hash value of a key
+        static size_t computeHash(const K& key) {
+            return hash_mix(std::hash<K>()(key));
+        }
+
+        /// Return the control byte of a used slot for a given hash value
+        static int8_t getControlFromHash(size_t hash) {
+            return static_cast<int8_t>(hash & 0x7F);
+        }
+
+        /// Return the first slot of the probe sequence of a given hash value in a table
+        static int getFirstSlot(size_t hash, int nbSlots) {
+            return static_cast<int>((hash >> 7) & static_cast<size_t>(nbSlots - 1));
+        }
+
+        /// Return true if the slot contains an element
+        static bool isUsed(int8_t control) {
+            return control >= 0;
+        }
+
+        /// Return the number of control bytes for a given number of slots
+        static int getNbControls(int nbSlots) {
+            return nbSlots + ControlGroup::SIZE;
+        }
+
+        /// Set the control byte of a slot of a table
+        static void setControl(int8_t* controls, int nbSlots, int slot, int8_t control) {
+
+            controls[slot] = control;
+
+            // Update the copy of the control byte at the end of the array
+            if (slot < ControlGroup::SIZE) {
+                controls[nbSlots + slot] = control;
+            }
+        }
+
+        /// Set the control byte of a slot
+        void setControl(int slot, int8_t control) {
+            setControl(mControls, mNbSlots, slot, control);
+        }
+
+        /// Allocate the arrays of a given number of slots
+        void allocate(int nbSlots) {
+
+            assert(nbSlots >= FlatTableGrowth::MIN_NB_SLOTS && (nbSlots & (nbSlots - 1)) == 0);
+
+            mNbSlots = nbSlots;
+            mControls = static_cast<int8_t*>(mAllocator.allocate(getNbControls(mNbSlots) * sizeof(int8_t)));
+            mSlots = static_cast<Pair<K, V>*>(mAllocator.allocate(mNbSlots * sizeof(Pair<K, V>)));
+            std::memset(mControls, ControlGroup::EMPTY, getNbControls(mNbSlots) * sizeof(int8_t));
+            mGrowthLeft = FlatTableGrowth::getMaxNbElements(mNbSlots) - mNbElements;
+        }
+
+        /// Return the index of the slot of a table containing a given key or -1 if there is no such key
+        static int findSlot(const int8_t* controls, const Pair<K, V>* slots, int nbSlots, const K& key, size_t hash) {
+
+            const int8_t control = getControlFromHash(hash);
+
+            for (int i = getFirstSlot(hash, nbSlots); ; i = (i + ControlGroup::SIZE) & (nbSlots - 1)) {
+
+                const ControlGroup group(controls + i);
+
+                // For each slot of the group that might contain the key
+                for (uint64_t mask = group.matchControl(control); mask != 0; mask = ControlGroup::removeFirst(mask)) {
+
+                    const int slot = (i + ControlGroup::getFirstIndex(mask)) & (nbSlots - 1);
+                    if (controls[slot] == control && slots[slot].first == key) {
+                        return slot;
+                    }
+                }
+
+                // The key is not in the table if the probing sequence reaches an empty slot
+                if (group.matchEmpty() != 0) {
+                    return -1;
+                }
+            }
+        }
+
+        /// Return the index of the slot containing a given key or -1 if there is no such key.
+        /// The key is searched in the current table and then in the previous table during
+        /// an incremental rehashing (in that case, isInOldTable is set to true if the key
+        /// is found in the previous table).
+        int findSlot(const K& key, bool& isInOldTable) const {
+
+            isInOldTable = false;
+
+            if (mNbElements == 0) return -1;
+
+            const size_t hash = computeHash(key);
+
+            const int slot = findSlot(mControls, mSlots, mNbSlots, key, hash);
+            if (slot != -1 || mOldNbElements == 0) {
+                return slot;
+            }
+
+            isInOldTable = true;
+            return findSlot(mOldControls, mOldSlots, mOldNbSlots, key, hash);
+        }
+
+        /// Return the index of the first slot that is not used in the probe sequence of a hash value
+        int findFreeSlot(size_t hash) const {
+
+            for (int i = getFirstSlot(hash, mNbSlots); ; i = (i + ControlGroup::SIZE) & (mNbSlots - 1)) {
+
+                const uint64_t freeMask = ControlGroup(mControls + i).matchFree();
+                if (freeMask != 0) {
+                    return (i + ControlGroup::getFirstIndex(freeMask)) & (mNbSlots - 1);
+                }
+            }
+        }
+
+        /// Release the arrays of a table
+        void releaseTable(int8_t* controls, Pair<K, V>* slots, int nbSlots) {
+            mAllocator.release(controls, getNbControls(nbSlots) * sizeof(int8_t));
+            mAllocator.release(slots, nbSlots * sizeof(Pair<K, V>));
+        }
+
+        /// Move the elements of some slots of the previous table into the current table
+        void moveOldSlots(int nbSlotsToMove) {
+
+            assert(isRehashing());
+
+            const int endSlot = std::min(mOldNextSlot + nbSlotsToMove, mOldNbSlots);
+
+            for (int i = mOldNextSlot; i < endSlot && mOldNbElements > 0; i++) {
+
+                if (isUsed(mOldControls[i])) {
+
+                    // Move the element into its new slot
+                    const size_t hash = computeHash(mOldSlots[i].first);
+                    const int slot = findFreeSlot(hash);
+
+                    // The room for the elements of the previous table is already
+                    // taken into account in the growth left of the current table
+                    if (mControls[slot] == ControlGroup::DELETED) {
+                        mGrowthLeft++;
+                    }
+
+                    new (static_cast<void*>(&mSlots[slot])) Pair<K, V>(mOldSlots[i]);
+                    setControl(slot, getControlFromHash(hash));
+                    mOldSlots[i].~Pair<K, V>();
+
+                    // The slot cannot become empty because it might be in the
+                    // probing sequence of an element still in the previous table
+                    setControl(mOldControls, mOldNbSlots, i, ControlGroup::DELETED);
+                    mOldNbElements--;
+                }
+            }
+
+            mOldNextSlot = endSlot;
+
+            // Release the previous table once all its elements have been moved
+            if (mOldNbElements == 0) {
+
+                releaseTable(mOldControls, mOldSlots, mOldNbSlots);
+
+                mOldNbSlots = 0;
+                mOldNextSlot = 0;
+                mOldControls = nullptr;
+                mOldSlots = nullptr;
+            }
+        }
+
+        /// Move all the remaining elements of the previous table into the current table
+        void completeRehashing() {
+
+            if (isRehashing()) {
+                moveOldSlots(mOldNbSlots);
+            }
+        }
+
+        /// Change the number of slots of the table and insert the elements again
+        void rehash(int nbSlots) {
+
+            completeRehashing();
+
+            int8_t* oldControls = mControls;
+            Pair<K, V>* oldSlots = mSlots;
+            const int oldNbSlots = mNbSlots;
+
+            allocate(nbSlots);
+
+            for (int i=0; i < oldNbSlots; i++) {
+
+                if (isUsed(oldControls[i])) {
+
+                    // Move the element into its new slot
+                    const size_t hash = computeHash(oldSlots[i].first);
+                    const int slot = findFreeSlot(hash);
+                    new (static_cast<void*>(&mSlots[slot])) Pair<K, V>(oldSlots[i]);
+                    setControl(slot, getControlFromHash(hash));
+                    oldSlots[i].~Pair<K, V>();
+                }
+            }
+
+            if (oldNbSlots > 0) {
+                releaseTable(oldControls, oldSlots, oldNbSlots);
+            }
+        }
+
+        /// Allocate a new table with a given number of slots and keep the current
+        /// one as the previous table whose elements are moved incrementally
+        void startIncrementalRehashing(int nbSlots) {
+
+            assert(!isRehashing());
+
+            mOldControls = mControls;
+            mOldSlots = mSlots;
+            mOldNbSlots = mNbSlots;
+            mOldNbElements = mNbElements;
+            mOldNextSlot = 0;
+
+            // The growth left of the new table takes into account all the elements
+            // of the previous table that will be moved into it
+            allocate(nbSlots);
+        }
+
+        /// Make sure that one more element can be added into an empty slot
+        void prepareGrowth() {
+
+            if (mGrowthLeft > 0) return;
+
+            if (mNbSlots == 0) {
+                rehash(FlatTableGrowth::MIN_NB_SLOTS);
+                return;
+            }
+
+            // If a previous incremental rehashing is still in progress, we complete it
+            // first because the current table might have some room afterwards
+            if (isRehashing()) {
+                completeRehashing();
+                if (mGrowthLeft > 0) return;
+            }
+
+            const int nbSlots = FlatTableGrowth::getGrownNbSlots(mNbSlots, mNbElements);
+
+            if (mIsIncrementalRehashingEnabled) {
+                startIncrementalRehashing(nbSlots);
+            }
+            else {
+                rehash(nbSlots);
+            }
+        }
+
+        /// Remove the element of a given used slot of the previous table
+        void removeOldSlot(int slot) {
+
+            assert(isUsed(mOldControls[slot]));
+
+            mOldSlots[slot].~Pair<K, V>();
+            mNbElements--;
+            mOldNbElements--;
+
+            // The element does not need some room in the current table anymore
+            mGrowthLeft++;
+
+            setControl(mOldControls, mOldNbSlots, slot, ControlGroup::DELETED);
+        }
+
+        /// Remove the element of a given used slot
+        void removeSlot(int slot) {
+
+            assert(isUsed(mControls[slot]));
+
+            mSlots[slot].~Pair<K, V>();
+            mNbElements--;
+
+            // If every group of control bytes that contains this slot also contains an empty
+            // slot, no probing sequence has gone past this slot and it can become empty again
+            const uint64_t emptyMaskBefore = ControlGroup(mControls + ((slot - ControlGroup::SIZE) & (mNbSlots - 1))).matchEmpty();
+            const uint64_t emptyMaskAfter = ControlGroup(mControls + slot).matchEmpty();
+            if (ControlGroup::getNbLeadingBytes(emptyMaskBefore) +
+                ControlGroup::getNbTrailingBytes(emptyMaskAfter) < ControlGroup::SIZE) {
+                setControl(slot, ControlGroup::EMPTY);
+                mGrowthLeft++;
+            }
+            else {
+                setControl(slot, ControlGroup::DELETED);
+            }
+        }
+
+        /// Destroy all the elements and release the memory
+        void reset() {
+
+            if (mNbSlots > 0) {
+
+                clear();
+
+                releaseTable(mControls, mSlots, mNbSlots);
+
+                mNbSlots = 0;
+                mGrowthLeft = 0;
+                mControls = nullptr;
+                mSlots = nullptr;
+            }
+        }
+
+        /// Copy the elements of another map with the same number of slots
+        void copySlots(const FlatMap<K, V>& map) {
+
+            assert(mNbSlots == map.mNbSlots);
+
+            // If the other map is rehashed incrementally, we insert its elements again
+            if (map.isRehashing()) {
+
+                for (auto it = map.begin(); it != map.end(); ++it) {
+
+                    const size_t hash = computeHash(it->first);
+                    const int slot = findFreeSlot(hash);
+                    new (static_cast<void*>(&mSlots[slot])) Pair<K, V>(*it);
+                    setControl(slot, getControlFromHash(hash));
+                    mNbElements++;
+                    mGrowthLeft--;
+                }
+
+                return;
+            }
+
+            std::memcpy(mControls, map.mControls, getNbControls(mNbSlots) * sizeof(int8_t));
+            for (int i=0; i < mNbSlots; i++) {
+                if (isUsed(mControls[i])) {
+                    new (static_cast<void*>(&mSlots[i])) Pair<K, V>(map.mSlots[i]);
+                }
+            }
+
+            mNbElements = map.mNbElements;
+            mGrowthLeft = map.mGrowthLeft;
+        }
+
+    public:
+
+        /// Class Iterator
+        /**
+         * This class represents an iterator for the FlatMap
+         */
+        class Iterator {
+
+            private:
+
+                /// Array of control bytes
+                const int8_t* mControls;
+
+                /// Array of slots
+                Pair<K, V>* mSlots;
+
+                /// Number of slots of the map
+                int mNbSlots;
+
+                /// Index of the current slot
+                int mCurrentSlot;
+
+                /// Index of the first slot of the group of control bytes of the current slot
+                int mGroupSlot;
+
+                /// Mask of the used slots of the current group that are after the current slot
+                uint64_t mUsedMask;
+
+                /// Array of control bytes of the table to iterate after the current one
+                /// (the previous table during an incremental rehashing or null)
+                const int8_t* mNextControls;
+
+                /// Array of slots of the table to iterate after the current one
+                Pair<K, V>* mNextSlots;
+
+                /// Number of slots of the table to iterate after the current one
+                int mNextNbSlots;
+
+                /// Advance the iterator
+                void advance() {
+
+                    // If we are trying to move past the end
+                    assert(mCurrentSlot < mNbSlots);
+
+                    // Find the next group that contains a used slot
+                    while (mUsedMask == 0) {
+
+                        mGroupSlot += ControlGroup::SIZE;
+                        if (mGroupSlot >= mNbSlots) {
+
+                            // If there is no other table to iterate
+                            if (mNextSlots == nullptr) {
+                                mCurrentSlot = mNbSlots;
+                                return;
+                            }
+
+                            // Continue with the first group of the next table
+                            mControls = mNextControls;
+                            mSlots = mNextSlots;
+                            mNbSlots = mNextNbSlots;
+                            mNextControls = nullptr;
+                            mNextSlots = nullptr;
+                            mNextNbSlots = 0;
+                            mGroupSlot = -ControlGroup::SIZE;
+                            continue;
+                        }
+
+                        mUsedMask = ControlGroup(mControls + mGroupSlot).matchUsed();
+                    }
+
+                    mCurrentSlot = mGroupSlot + ControlGroup::getFirstIndex(mUsedMask);
+                    mUsedMask = ControlGroup::removeFirst(mUsedMask);
+                }
+
+                friend class FlatMap<K, V>;
+
+            public:
+
+                // Iterator traits
+                using value_type = Pair<K,V>;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Pair<K, V>*;
+                using reference = Pair<K,V>&;
+                using iterator_category = std::forward_iterator_tag;
+
+                /// Constructor
+                Iterator() = default;
+
+                /// Constructor (the current slot is -1 for an iterator before the first slot)
+                Iterator(const int8_t* controls, Pair<K, V>* slots, int nbSlots, int currentSlot,
+                         const int8_t* nextControls = nullptr, Pair<K, V>* nextSlots = nullptr, int nextNbSlots = 0)
+                     :mControls(controls), mSlots(slots), mNbSlots(nbSlots), mCurrentSlot(currentSlot),
+                      mGroupSlot(currentSlot >= 0 ? currentSlot - currentSlot % ControlGroup::SIZE : -ControlGroup::SIZE),
+                      mUsedMask(0), mNextControls(nextControls), mNextSlots(nextSlots), mNextNbSlots(nextNbSlots) {
+
+                    // The groups of the iterator are aligned on the number of control bytes per
+                    // group and never contain the copies of the control bytes of the first slots
+                    if (currentSlot >= 0 && currentSlot < nbSlots) {
+                        const uint64_t usedMask = ControlGroup(mControls + mGroupSlot).matchUsed();
+                        mUsedMask = ControlGroup::removeUntil(usedMask, currentSlot - mGroupSlot);
+                    }
+                }
+
+                /// Deferencable
+                reference operator*() const {
+                    assert(mCurrentSlot >= 0 && mCurrentSlot < mNbSlots);
+                    assert(isUsed(mControls[mCurrentSlot]));
+                    return mSlots[mCurrentSlot];
+                }
+
+                /// Deferencable
+                pointer operator->() const {
+                    assert(mCurrentSlot >= 0 && mCurrentSlot < mNbSlots);
+                    assert(isUsed(mControls[mCurrentSlot]));
+                    return &(mSlots[mCurrentSlot]);
+                }
+
+                /// Post increment (it++)
+                Iterator& operator++() {
+                    advance();
+                    return *this;
+                }
+
+                /// Pre increment (++it)
+                Iterator operator++(int number) {
+                    Iterator tmp = *this;
+                    advance();
+                    return tmp;
+                }
+
+                /// Equality operator (it == end())
+                bool operator==(const Iterator& iterator) const {
+                    return mCurrentSlot == iterator.mCurrentSlot && mSlots == iterator.mSlots;
+                }
+
+                /// Inequality operator (it != end())
+                bool operator!=(const Iterator& iterator) const {
+                    return !(*this == iterator);
+                }
+        };
+
+    private:
+
+        /// Return an iterator to a used slot of the current or the previous table
+        Iterator getIterator(int slot, bool isInOldTable) const {
+
+            if (isInOldTable) {
+                return Iterator(mOldControls, mOldSlots, mOldNbSlots, slot);
+            }
+
+            return Iterator(mControls, mSlots, mNbSlots, slot, mOldControls, mOldSlots, mOldNbSlots);
+        }
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        FlatMap(MemoryAllocator& allocator, size_t capacity = 0, bool isIncrementalRehashingEnabled = false)
+            : mNbSlots(0), mNbElements(0), mGrowthLeft(0), mControls(nullptr), mSlots(nullptr),
+              mOldNbSlots(0), mOldNbElements(0), mOldNextSlot(0), mOldControls(nullptr), mOldSlots(nullptr),
+              mIsIncrementalRehashingEnabled(isIncrementalRehashingEnabled), mAllocator(allocator) {
+
+            if (capacity > 0) {
+                reserve(static_cast<int>(capacity));
+            }
+        }
+
+        /// Copy constructor
+        FlatMap(const FlatMap<K, V>& map)
+          :mNbSlots(0), mNbElements(0), mGrowthLeft(0), mControls(nullptr), mSlots(nullptr),
+           mOldNbSlots(0), mOldNbElements(0), mOldNextSlot(0), mOldControls(nullptr), mOldSlots(nullptr),
+           mIsIncrementalRehashingEnabled(map.mIsIncrementalRehashingEnabled), mAllocator(map.mAllocator) {
+
+            if (map.mNbSlots > 0) {
+                allocate(map.mNbSlots);
+                copySlots(map);
+            }
+        }
+
+        /// Destructor
+        ~FlatMap() {
+
+            reset();
+        }
+
+        /// Allocate memory for a given number of elements
+        void reserve(int capacity) {
+
+           completeRehashing();
+
+           if (capacity <= this->capacity()) return;
+
+           rehash(FlatTableGrowth::getReservedNbSlots(mNbSlots, capacity));
+        }
+
+        /// Enable or disable the incremental rehashing of the table when it grows
+        void setIsIncrementalRehashingEnabled(bool isEnabled) {
+
+            mIsIncrementalRehashingEnabled = isEnabled;
+
+            if (!isEnabled) {
+                completeRehashing();
+            }
+        }
+
+        /// Return true if the table is rehashed incrementally when it grows
+        bool isIncrementalRehashingEnabled() const {
+            return mIsIncrementalRehashingEnabled;
+        }
+
+        /// Return true if an incremental rehashing is in progress
+        bool isRehashing() const {
+            return mOldNbSlots > 0;
+        }
+
+        /// Return true if the map contains an item with the given key
+        bool containsKey(const K& key) const {
+            bool isInOldTable;
+            return findSlot(key, isInOldTable) != -1;
+        }
+
+        /// Add an element into the map
+        void add(const Pair<K,V>& keyValue, bool insertIfAlreadyPresent = false) {
+
+            // If there is already an item with the same key in the map
+            bool isInOldTable;
+            const int existingSlot = findSlot(keyValue.first, isInOldTable);
+            if (existingSlot != -1) {
+
+                if (insertIfAlreadyPresent) {
+
+                    Pair<K, V>* slots = isInOldTable ? mOldSlots : mSlots;
+
+                    // Destruct the previous key/value
+                    slots[existingSlot].~Pair<K, V>();
+
+                    // Copy construct the new key/value
+                    new (static_cast<void*>(&slots[existingSlot])) Pair<K,V>(keyValue);
+
+                    return;
+                }
+                else {
+                    throw std::runtime_error("The key and value pair already exists in the map");
+                }
+            }
+
+            if (mNbSlots == 0) {
+                prepareGrowth();
+            }
+
+            // Move some elements of the previous table if the table is rehashed incrementally
+            if (isRehashing()) {
+                moveOldSlots(FlatTableGrowth::NB_SLOTS_MOVED_PER_ADDITION);
+            }
+
+            const size_t hash = computeHash(keyValue.first);
+            int slot = findFreeSlot(hash);
+
+            // If the element is added into an empty slot (and not into a deleted one)
+            if (mControls[slot] == ControlGroup::EMPTY) {
+
+                // Rehash the table if it is too full
+                if (mGrowthLeft == 0) {
+                    prepareGrowth();
+                    slot = findFreeSlot(hash);
+                }
+
+                if (mControls[slot] == ControlGroup::EMPTY) {
+                    mGrowthLeft--;
+                }
+            }
+
+            new (static_cast<void*>(&mSlots[slot])) Pair<K,V>(keyValue);
+            setControl(slot, getControlFromHash(hash));
+            mNbElements++;
+        }
+
+        /// Remove the element pointed by some iterator
+        /// This method returns an iterator pointing to the element after
+        /// the one that has been removed
+        Iterator remove(const Iterator& it) {
+
+            assert(it.mSlots == mSlots || it.mSlots == mOldSlots);
+
+            if (it.mSlots == mSlots) {
+                removeSlot(it.mCurrentSlot);
+            }
+            else {
+                removeOldSlot(it.mCurrentSlot);
+            }
+
+            Iterator nextIt = it;
+            nextIt.advance();
+
+            return nextIt;
+        }
+
+        /// Remove the element from the map with a given key
+        /// This method returns an iterator pointing to the element after
+        /// the one that has been removed
+        Iterator remove(const K& key) {
+
+            bool isInOldTable;
+            const int slot = findSlot(key, isInOldTable);
+            if (slot == -1) {
+                return end();
+            }
+
+            Iterator nextIt = getIterator(slot, isInOldTable);
+
+            if (isInOldTable) {
+                removeOldSlot(slot);
+            }
+            else {
+                removeSlot(slot);
+            }
+
+            nextIt.advance();
+
+            return nextIt;
+        }
+
+        /// Clear the map
+        void clear() {
+
+            if (mNbElements > 0) {
+
+                for (int i=0; i < mNbSlots; i++) {
+                    if (isUsed(mControls[i])) {
+                        mSlots[i].~Pair<K, V>();
+                    }
+                }
+
+                mNbElements = 0;
+            }
+
+            // Destroy the elements of the previous table and release it
+            if (isRehashing()) {
+
+                for (int i=0; i < mOldNbSlots; i++) {
+                    if (isUsed(mOldControls[i])) {
+                        mOldSlots[i].~Pair<K, V>();
+                    }
+                }
+
+                releaseTable(mOldControls, mOldSlots, mOldNbSlots);
+
+                mOldNbSlots = 0;
+                mOldNbElements = 0;
+                mOldNextSlot = 0;
+                mOldControls = nullptr;
+                mOldSlots = nullptr;
+            }
+
+            if (mNbSlots > 0) {
+                std::memset(mControls, ControlGroup::EMPTY, getNbControls(mNbSlots) * sizeof(int8_t));
+                mGrowthLeft = FlatTableGrowth::getMaxNbElements(mNbSlots);
+            }
+
+            assert(size() == 0);
+        }
+
+        /// Return the number of elements in the map
+        int size() const {
+            return mNbElements;
+        }
+
+        /// Return the capacity of the map (number of elements that it can contain without growing)
+        int capacity() const {
+            return mNbSlots > 0 ? FlatTableGrowth::getMaxNbElements(mNbSlots) : 0;
+        }
+
+        /// Try to find an item of the map given a key.
+        /// The method returns an iterator to the found item or
+        /// an iterator pointing to the end if not found
+        Iterator find(const K& key) const {
+
+            bool isInOldTable;
+            const int slot = findSlot(key, isInOldTable);
+            if (slot == -1) {
+                return end();
+            }
+
+            return getIterator(slot, isInOldTable);
+        }
+
+        /// Overloaded index operator
+        V& operator[](const K& key) {
+
+            bool isInOldTable;
+            const int slot = findSlot(key, isInOldTable);
+            if (slot == -1) {
+                throw std::runtime_error("No item with given key has been found in the map");
+            }
+
+            return isInOldTable ? mOldSlots[slot].second : mSlots[slot].second;
+        }
+
+        /// Overloaded index operator
+        const V& operator[](const K& key) const {
+
+            bool isInOldTable;
+            const int slot = findSlot(key, isInOldTable);
+            if (slot == -1) {
+                throw std::runtime_error("No item with given key has been found in the map");
+            }
+
+            return isInOldTable ? mOldSlots[slot].second : mSlots[slot].second;
+        }
+
+        /// Overloaded equality operator
+        bool operator==(const FlatMap<K,V>& map) const {
+
+            if (size() != map.size()) return false;
+
+            for (auto it = begin(); it != end(); ++it) {
+                auto it2 = map.find(it->first);
+                if (it2 == map.end() || it2->second != it->second) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// Overloaded not equal operator
+        bool operator!=(const FlatMap<K,V>& map) const {
+
+            return !((*this) == map);
+        }
+
+        /// Overloaded assignment operator
+        FlatMap<K,V>& operator=(const FlatMap<K, V>& map) {
+
+            // Check for self assignment
+            if (this != &map) {
+
+                // Reset the map
+                reset();
+
+                if (map.mNbSlots > 0) {
+                    allocate(map.mNbSlots);
+                    copySlots(map);
+                }
+            }
+
+            return *this;
+        }
+
+        /// Return a begin iterator
+        Iterator begin() const {
+
+            // If the map is empty
+            if (size() == 0) {
+
+                // Return an iterator to the end
+                return end();
+            }
+
+            Iterator it(mControls, mSlots, mNbSlots, -1, mOldControls, mOldSlots, mOldNbSlots);
+            it.advance();
+
+            return it;
+        }
+
+        /// Return a end iterator
+        Iterator end() const {
+
+            // During an incremental rehashing, the previous table is iterated last
+            if (isRehashing()) {
+                return Iterator(mOldControls, mOldSlots, mOldNbSlots, mOldNbSlots);
+            }
+
+            return Iterator(mControls, mSlots, mNbSlots, mNbSlots);
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,874 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_FLAT_SET_H
+#define REACTPHYSICS3D_FLAT_SET_H
+
+// Libraries
+#include "memory/MemoryAllocator.h"
+#include "containers/containers_common.h"
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <functional>
+#include <algorithm>
+
+
+namespace reactphysics3d {
+
+// Class FlatSet
+/**
+ * This class represents a generic set implemented with an open-addressing hash table
+ * (see the FlatMap class). The values are stored directly in the array of slots of the
+ * table (instead of being allocated separately as in the Set class) and a control byte is
+ * associated with each slot. The control byte of a used slot contains seven bits of the
+ * hash value of its value so that most of the slots that do not contain the searched value
+ * are skipped without reading their value. The slots are searched with linear probing by
+ * groups of consecutive control bytes that are matched at once (see ControlGroup).
+ * A removed element leaves a "deleted" control byte in its slot and therefore, removing
+ * an element does not move the other elements of the set. The iterators to the other
+ * elements stay valid after a removal. The iterators are invalidated when an element is
+ * added into the set.
+ * The set grows like the FlatMap (see FlatTableGrowth) and it can also be rehashed
+ * incrementally. In that case, the elements are kept in the previous table when the set
+ * grows and a bounded number of its slots is moved into the new table each time an
+ * element is added.
+ */
+template<typename V>
+class FlatSet {
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        /// Number of slots of the table (zero or a power of two)
+        int mNbSlots;
+
+        /// Number of elements in the set
+        int mNbElements;
+
+        /// Number of elements that can still be added into empty slots before the table
+        /// has to be rehashed
+        int mGrowthLeft;
+
+        /// Array with the control byte of each slot. The control bytes of the first slots
+        /// are copied at the end of the array so that a group can be loaded at any slot.
+        int8_t* mControls;
+
+        /// Array with the slots that contain the values
+        V* mSlots;
+
+        /// Number of slots of the previous table during an incremental rehashing (zero otherwise)
+        int mOldNbSlots;
+
+        /// Number of elements that are still in the previous table
+        int mOldNbElements;
+
+        /// Index of the next slot of the previous table to move into the new table
+        int mOldNextSlot;
+
+        /// Array with the control bytes of the previous table
+        int8_t* mOldControls;
+
+        /// Array with the slots of the previous table
+        V* mOldSlots;
+
+        /// True if the table is rehashed incrementally when it grows
+        bool mIsIncrementalRehashingEnabled;
+
+        /// Memory allocator
+        MemoryAllocator& mAllocator;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the hash value of a value
+        static size_t computeHash(const V& value) {
+            return hash_mix(std::hash<V>()(value));
+        }
+
+        /// Return the control byte of a used slot for a given hash value
+        static int8_t getControlFromHash(size_t hash) {
+            return static_cast<int8_t>(hash & 0x7F);
+        }
+
+        /// Return the first slot of the probe sequence of a given hash value in a table
+        static int getFirstSlot(size_t hash, int nbSlots) {
+            return static_cast<int>((hash >> 7) & static_cast<size_t>(nbSlots - 1));
+        }
+
+        /// Return true if the slot contains an element
+        static bool isUsed(int8_t control) {
+            return control >= 0;
+        }
+
+        /// Return the number of control bytes for a given number of slots
+        static int getNbControls(int nbSlots) {
+            return nbSlots + ControlGroup::SIZE;
+        }
+
+        /// Set the control byte of a slot of a table
+        static void setControl(int8_t* controls, int nbSlots, int slot, int8_t control) {
+
+            controls[slot] = control;
+
+            // Update the copy of the control byte at the end of the array
+            if (slot < ControlGroup::SIZE) {
+                controls[nbSlots + slot] = control;
+            }
+        }
+
+        /// Set the control byte of a slot
+        void setControl(int slot, int8_t control) {
+            setControl(mControls, mNbSlots, slot, control);
+        }
+
+        /// Allocate the arrays of a given number of slots
+        void allocate(int nbSlots) {
+
+            assert(nbSlots >= FlatTableGrowth::MIN_NB_SLOTS && (nbSlots & (nbSlots - 1)) == 0);
+
+            mNbSlots = nbSlots;
+            mControls = static_cast<int8_t*>(mAllocator.allocate(getNbControls(mNbSlots) * sizeof(int8_t)));
+            mSlots = static_cast<V*>(mAllocator.allocate(mNbSlots * sizeof(V)));
+            std::memset(mControls, ControlGroup::EMPTY, getNbControls(mNbSlots) * sizeof(int8_t));
+            mGrowthLeft = FlatTableGrowth::getMaxNbElements(mNbSlots) - mNbElements;
+        }
+
+        /// Return the index of the slot of a table containing a given value or -1 if there is no such value
+        static int findSlot(const int8_t* controls, const V* slots, int nbSlots, const V& value, size_t hash) {
+
+            const int8_t control = getControlFromHash(hash);
+
+            for (int i = getFirstSlot(hash, nbSlots); ; i = (i + ControlGroup::SIZE) & (nbSlots - 1)) {
+
+                const ControlGroup group(controls + i);
+
+                // For each slot of the group that might contain the value
+                for (uint64_t mask = group.matchControl(control); mask != 0; mask = ControlGroup::removeFirst(mask)) {
+
+                    const int slot = (i + ControlGroup::getFirstIndex(mask)) & (nbSlots - 1);
+                    if (controls[slot] == control && slots[slot] == value) {
+                        return slot;
+                    }
+                }
+
+                // The value is not in the table if the probing sequence reaches an empty slot
+                if (group.matchEmpty() != 0) {
+                    return -1;
+                }
+            }
+        }
+
+        /// Return the index of the slot containing a given value or -1 if there is no such value.
+        /// The value is searched in the current table and then in the previous table during
+        /// an incremental rehashing (in that case, isInOldTable is set to true if the value
+        /// is found in the previous table).
+        int findSlot(const V& value, bool& isInOldTable) const {
+
+            isInOldTable = false;
+
+            if (mNbElements == 0) return -1;
+
+            const size_t hash = computeHash(value);
+
+            const int slot = findSlot(mControls, mSlots, mNbSlots, value, hash);
+            if (slot != -1 || mOldNbElements == 0) {
+                return slot;
+            }
+
+            isInOldTable = true;
+            return findSlot(mOldControls, mOldSlots, mOldNbSlots, value, hash);
+        }
+
+        /// Return the index of the first slot that is not used in the probe sequence of a hash value
+        int findFreeSlot(size_t hash) const {
+
+            for (int i = getFirstSlot(hash, mNbSlots); ; i = (i + ControlGroup::SIZE) & (mNbSlots - 1)) {
+
+                const uint64_t freeMask = ControlGroup(mControls + i).matchFree();
+                if (freeMask != 0) {
+                    return (i + ControlGroup::getFirstIndex(freeMask)) & (mNbSlots - 1);
+                }
+            }
+        }
+
+        /// Release the arrays of a table
+        void releaseTable(int8_t* controls, V* slots, int nbSlots) {
+            mAllocator.release(controls, getNbControls(nbSlots) * sizeof(int8_t));
+            mAllocator.release(slots, nbSlots * sizeof(V));
+        }
+
+        /// Move the elements of some slots of the previous table into the current table
+        void moveOldSlots(int nbSlotsToMove) {
+
+            assert(isRehashing());
+
+            const int endSlot = std::min(mOldNextSlot + nbSlotsToMove, mOldNbSlots);
+
+            for (int i = mOldNextSlot; i < endSlot && mOldNbElements > 0; i++) {
+
+                if (isUsed(mOldControls[i])) {
+
+                    // Move the element into its new slot
+                    const size_t hash = computeHash(mOldSlots[i]);
+                    const int slot = findFreeSlot(hash);
+
+                    // The room for the elements of the previous table is already
+                    // taken into account in the growth left of the current table
+                    if (mControls[slot] == ControlGroup::DELETED) {
+                        mGrowthLeft++;
+                    }
+
+                    new (static_cast<void*>(&mSlots[slot])) V(mOldSlots[i]);
+                    setControl(slot, getControlFromHash(hash));
+                    mOldSlots[i].~V();
+
+                    // The slot cannot become empty because it might be in the
+                    // probing sequence of an element still in the previous table
+                    setControl(mOldControls, mOldNbSlots, i, ControlGroup::DELETED);
+                    mOldNbElements--;
+                }
+            }
+
+            mOldNextSlot = endSlot;
+
+            // Release the previous table once all its elements have been moved
+            if (mOldNbElements == 0) {
+
+                releaseTable(mOldControls, mOldSlots, mOldNbSlots);
+
+                mOldNbSlots = 0;
+                mOldNextSlot = 0;
+                mOldControls = nullptr;
+                mOldSlots = nullptr;
+            }
+        }
+
+        /// Move all the remaining elements of the previous table into the current table
+        void completeRehashing() {
+
+            if (isRehashing()) {
+                moveOldSlots(mOldNbSlots);
+            }
+        }
+
+        /// Change the number of slots of the table and insert the elements again
+        void rehash(int nbSlots) {
+
+            completeRehashing();
+
+            int8_t* oldControls = mControls;
+            V* oldSlots = mSlots;
+            const int oldNbSlots = mNbSlots;
+
+            allocate(nbSlots);
+
+            for (int i=0; i < oldNbSlots; i++) {
+
+                if (isUsed(oldControls[i])) {
+
+                    // Move the element into its new slot
+                    const size_t hash = computeHash(oldSlots[i]);
+                    const int slot = findFreeSlot(hash);
+                    new (static_cast<void*>(&mSlots[slot])) V(oldSlots[i]);
+                    setControl(slot, getControlFromHash(hash));
+                    oldSlots[i].~V();
+                }
+            }
+
+            if (oldNbSlots > 0) {
+                releaseTable(oldControls, oldSlots, oldNbSlots);
+            }
+        }
+
+        /// Allocate a new table with a given number of slots and keep the current
+        /// one as the previous table whose elements are moved incrementally
+        void startIncrementalRehashing(int nbSlots) {
+
+            assert(!isRehashing());
+
+            mOldControls = mControls;
+            mOldSlots = mSlots;
+            mOldNbSlots = mNbSlots;
+            mOldNbElements = mNbElements;
+            mOldNextSlot = 0;
+
+            // The growth left of the new table takes into account all the elements
+            // of the previous table that will be moved into it
+            allocate(nbSlots);
+        }
+
+        /// Make sure that one more element can be added into an empty slot
+        void prepareGrowth() {
+
+            if (mGrowthLeft > 0) return;
+
+            if (mNbSlots == 0) {
+                rehash(FlatTableGrowth::MIN_NB_SLOTS);
+                return;
+            }
+
+            // If a previous incremental rehashing is still in progress, we complete it
+            // first because the current table might have some room afterwards
+            if (isRehashing()) {
+                completeRehashing();
+                if (mGrowthLeft > 0) return;
+            }
+
+            const int nbSlots = FlatTableGrowth::getGrownNbSlots(mNbSlots, mNbElements);
+
+            if (mIsIncrementalRehashingEnabled) {
+                startIncrementalRehashing(nbSlots);
+            }
+            else {
+                rehash(nbSlots);
+            }
+        }
+
+        /// Remove the element of a given used slot of the previous table
+        void removeOldSlot(int slot) {
+
+            assert(isUsed(mOldControls[slot]));
+
+            mOldSlots[slot].~V();
+            mNbElements--;
+            mOldNbElements--;
+
+            // The element does not need some room in the current table anymore
+            mGrowthLeft++;
+
+            setControl(mOldControls, mOldNbSlots, slot, ControlGroup::DELETED);
+        }
+
+        /// Remove the element of a given used slot
+        void removeSlot(int slot) {
+
+            assert(isUsed(mControls[slot]));
+
+            mSlots[slot].~V();
+            mNbElements--;
+
+            // If every group of control bytes that contains this slot also contains an empty
+            // slot, no probing sequence has gone past this slot and it can become empty again
+            const uint64_t emptyMaskBefore = ControlGroup(mControls + ((slot - ControlGroup::SIZE) & (mNbSlots - 1))).matchEmpty();
+            const uint64_t emptyMaskAfter = ControlGroup(mControls + slot).matchEmpty();
+            if (ControlGroup::getNbLeadingBytes(emptyMaskBefore) +
+                ControlGroup::getNbTrailingBytes(emptyMaskAfter) < ControlGroup::SIZE) {
+                setControl(slot, ControlGroup::EMPTY);
+                mGrowthLeft++;
+            }
+            else {
+                setControl(slot, ControlGroup::DELETED);
+            }
+        }
+
+        /// Destroy all the elements and release the memory
+        void reset() {
+
+            if (mNbSlots > 0) {
+
+                clear();
+
+                releaseTable(mControls, mSlots, mNbSlots);
+
+                mNbSlots = 0;
+                mGrowthLeft = 0;
+                mControls = nullptr;
+                mSlots = nullptr;
+            }
+        }
+
+        /// Copy the elements of another set with the same number of slots
+        void copySlots(const FlatSet<V>& set) {
+
+            assert(mNbSlots == set.mNbSlots);
+
+            // If the other set is rehashed incrementally, we insert its elements again
+            if (set.isRehashing()) {
+
+                for (auto it = set.begin(); it != set.end(); ++it) {
+
+                    const size_t hash = computeHash(*it);
+                    const int slot = findFreeSlot(hash);
+                    new (static_cast<void*>(&mSlots[slot])) V(*it);
+                    setControl(slot, getControlFromHash(hash));
+                    mNbElements++;
+                    mGrowthLeft--;
+                }
+
+                return;
+            }
+
+            std::memcpy(mControls, set.mControls, getNbControls(mNbSlots) * sizeof(int8_t));
+            for (int i=0; i < mNbSlots; i++) {
+                if (isUsed(mControls[i])) {
+                    new (static_cast<void*>(&mSlots[i])) V(set.mSlots[i]);
+                }
+            }
+
+            mNbElements = set.mNbElements;
+            mGrowthLeft = set.mGrowthLeft;
+        }
+
+    public:
+
+        /// Class Iterator
+        /**
+         * This class represents an iterator for the FlatSet
+         */
+        class Iterator {
+
+            private:
+
+                /// Array of control bytes
+                const int8_t* mControls;
+
+                /// Array of slots
+                V* mSlots;
+
+                /// Number of slots of the set
+                int mNbSlots;
+
+                /// Index of the current slot
+                int mCurrentSlot;
+
+                /// Index of the first slot of the group of control bytes of the current slot
+                int mGroupSlot;
+
+                /// Mask of the used slots of the current group that are after the current slot
+                uint64_t mUsedMask;
+
+                /// Array of control bytes of the table to iterate after the current one
+                /// (the previous table during an incremental rehashing or null)
+                const int8_t* mNextControls;
+
+                /// Array of slots of the table to iterate after the current one
+                V* mNextSlots;
+
+                /// Number of slots of the table to iterate after the current one
+                int mNextNbSlots;
+
+                /// Advance the iterator
+                void advance() {
+
+                    // If we are trying to move past the end
+                    assert(mCurrentSlot < mNbSlots);
+
+                    // Find the next group that contains a used slot
+                    while (mUsedMask == 0) {
+
+                        mGroupSlot += ControlGroup::SIZE;
+                        if (mGroupSlot >= mNbSlots) {
+
+                            // If there is no other table to iterate
+                            if (mNextSlots == nullptr) {
+                                mCurrentSlot = mNbSlots;
+                                return;
+                            }
+
+                            // Continue with the first group of the next table
+                            mControls = mNextControls;
+                            mSlots = mNextSlots;
+                            mNbSlots = mNextNbSlots;
+                            mNextControls = nullptr;
+                            mNextSlots = nullptr;
+                            mNextNbSlots = 0;
+                            mGroupSlot = -ControlGroup::SIZE;
+                            continue;
+                        }
+
+                        mUsedMask = ControlGroup(mControls + mGroupSlot).matchUsed();
+                    }
+
+                    mCurrentSlot = mGroupSlot + ControlGroup::getFirstIndex(mUsedMask);
+                    mUsedMask = ControlGroup::removeFirst(mUsedMask);
+                }
+
+                friend class FlatSet<V>;
+
+            public:
+
+                // Iterator traits
+                using value_type = V;
+                using difference_type = std::ptrdiff_t;
+                using pointer = V*;
+                using reference = V&;
+                using iterator_category = std::forward_iterator_tag;
+
+                /// Constructor
+                Iterator() = default;
+
+                /// Constructor (the current slot is -1 for an iterator before the first slot)
+                Iterator(const int8_t* controls, V* slots, int nbSlots, int currentSlot,
+                         const int8_t* nextControls = nullptr, V* nextSlots = nullptr, int nextNbSlots = 0)
+                     :mControls(controls), mSlots(slots), mNbSlots(nbSlots), mCurrentSlot(currentSlot),
+                      mGroupSlot(currentSlot >= 0 ? currentSlot - currentSlot % ControlGroup::SIZE : -ControlGroup::SIZE),
+                      mUsedMask(0), mNextControls(nextControls), mNextSlots(nextSlots), mNextNbSlots(nextNbSlots) {
+
+                    // The groups of the iterator are aligned on the number of control bytes per
+                    // group and never contain the copies of the control bytes of the first slots
+                    if (currentSlot >= 0 && currentSlot < nbSlots) {
+                        const uint64_t usedMask = ControlGroup(mControls + mGroupSlot).matchUsed();
+                        mUsedMask = ControlGroup::removeUntil(usedMask, currentSlot - mGroupSlot);
+                    }
+                }
+
+                /// Deferencable
+                reference operator*() const {
+                    assert(mCurrentSlot >= 0 && mCurrentSlot < mNbSlots);
+                    assert(isUsed(mControls[mCurrentSlot]));
+                    return mSlots[mCurrentSlot];
+                }
+
+                /// Deferencable
+                pointer operator->() const {
+                    assert(mCurrentSlot >= 0 && mCurrentSlot < mNbSlots);
+                    assert(isUsed(mControls[mCurrentSlot]));
+                    return &(mSlots[mCurrentSlot]);
+                }
+
+                /// Post increment (it++)
+                Iterator& operator++() {
+                    advance();
+                    return *this;
+                }
+
+                /// Pre increment (++it)
+                Iterator operator++(int number) {
+                    Iterator tmp = *this;
+                    advance();
+                    return tmp;
+                }
+
+                /// Equality operator (it == end())
+                bool operator==(const Iterator& iterator) const {
+                    return mCurrentSlot == iterator.mCurrentSlot && mSlots == iterator.mSlots;
+                }
+
+                /// Inequality operator (it != end())
+                bool operator!=(const Iterator& iterator) const {
+                    return !(*this == iterator);
+                }
+        };
+
+    private:
+
+        /// Return an iterator to a used slot of the current or the previous table
+        Iterator getIterator(int slot, bool isInOldTable) const {
+
+            if (isInOldTable) {
+                return Iterator(mOldControls, mOldSlots, mOldNbSlots, slot);
+            }
+
+            return Iterator(mControls, mSlots, mNbSlots, slot, mOldControls, mOldSlots, mOldNbSlots);
+        }
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        FlatSet(MemoryAllocator& allocator, size_t capacity = 0, bool isIncrementalRehashingEnabled = false)
+            : mNbSlots(0), mNbElements(0), mGrowthLeft(0), mControls(nullptr), mSlots(nullptr),
+              mOldNbSlots(0), mOldNbElements(0), mOldNextSlot(0), mOldControls(nullptr), mOldSlots(nullptr),
+              mIsIncrementalRehashingEnabled(isIncrementalRehashingEnabled), mAllocator(allocator) {
+
+            if (capacity > 0) {
+                reserve(static_cast<int>(capacity));
+            }
+        }
+
+        /// Copy constructor
+        FlatSet(const FlatSet<V>& set)
+          :mNbSlots(0), mNbElements(0), mGrowthLeft(0), mControls(nullptr), mSlots(nullptr),
+           mOldNbSlots(0), mOldNbElements(0), mOldNextSlot(0), mOldControls(nullptr), mOldSlots(nullptr),
+           mIsIncrementalRehashingEnabled(set.mIsIncrementalRehashingEnabled), mAllocator(set.mAllocator) {
+
+            if (set.mNbSlots > 0) {
+                allocate(set.mNbSlots);
+                copySlots(set);
+            }
+        }
+
+        /// Destructor
+        ~FlatSet() {
+
+            reset();
+        }
+
+        /// Allocate memory for a given number of elements
+        void reserve(int capacity) {
+
+           completeRehashing();
+
+           if (capacity <= this->capacity()) return;
+
+           rehash(FlatTableGrowth::getReservedNbSlots(mNbSlots, capacity));
+        }
+
+        /// Enable or disable the incremental rehashing of the table when it grows
+        void setIsIncrementalRehashingEnabled(bool isEnabled) {
+
+            mIsIncrementalRehashingEnabled = isEnabled;
+
+            if (!isEnabled) {
+                completeRehashing();
+            }
+        }
+
+        /// Return true if the table is rehashed incrementally when it grows
+        bool isIncrementalRehashingEnabled() const {
+            return mIsIncrementalRehashingEnabled;
+        }
+
+        /// Return true if an incremental rehashing is in progress
+        bool isRehashing() const {
+            return mOldNbSlots > 0;
+        }
+
+        /// Return true if the set contains a given value
+        bool contains(const V& value) const {
+            bool isInOldTable;
+            return findSlot(value, isInOldTable) != -1;
+        }
+
+        /// Add a value into the set
+        void add(const V& value) {
+
+            // If the value is already in the set
+            bool isInOldTable;
+            if (findSlot(value, isInOldTable) != -1) {
+                return;
+            }
+
+            if (mNbSlots == 0) {
+                prepareGrowth();
+            }
+
+            // Move some elements of the previous table if the table is rehashed incrementally
+            if (isRehashing()) {
+                moveOldSlots(FlatTableGrowth::NB_SLOTS_MOVED_PER_ADDITION);
+            }
+
+            const size_t hash = computeHash(value);
+            int slot = findFreeSlot(hash);
+
+            // If the element is added into an empty slot (and not into a deleted one)
+            if (mControls[slot] == ControlGroup::EMPTY) {
+
+                // Rehash the table if it is too full
+                if (mGrowthLeft == 0) {
+                    prepareGrowth();
+                    slot = findFreeSlot(hash);
+                }
+
+                if (mControls[slot] == ControlGroup::EMPTY) {
+                    mGrowthLeft--;
+                }
+            }
+
+            new (static_cast<void*>(&mSlots[slot])) V(value);
+            setControl(slot, getControlFromHash(hash));
+            mNbElements++;
+        }
+
+        /// Remove the element pointed by some iterator
+        /// This method returns an iterator pointing to the element after
+        /// the one that has been removed
+        Iterator remove(const Iterator& it) {
+
+            assert(it.mSlots == mSlots || it.mSlots == mOldSlots);
+
+            if (it.mSlots == mSlots) {
+                removeSlot(it.mCurrentSlot);
+            }
+            else {
+                removeOldSlot(it.mCurrentSlot);
+            }
+
+            Iterator nextIt = it;
+            nextIt.advance();
+
+            return nextIt;
+        }
+
+        /// Remove the element from the set with a given value
+        /// This method returns an iterator pointing to the element after
+        /// the one that has been removed
+        Iterator remove(const V& value) {
+
+            bool isInOldTable;
+            const int slot = findSlot(value, isInOldTable);
+            if (slot == -1) {
+                return end();
+            }
+
+            Iterator nextIt = getIterator(slot, isInOldTable);
+
+            if (isInOldTable) {
+                removeOldSlot(slot);
+            }
+            else {
+                removeSlot(slot);
+            }
+
+            nextIt.advance();
+
+            return nextIt;
+        }
+
+        /// Clear the set
+        void clear() {
+
+            if (mNbElements > 0) {
+
+                for (int i=0; i < mNbSlots; i++) {
+                    if (isUsed(mControls[i])) {
+                        mSlots[i].~V();
+                    }
+                }
+
+                mNbElements = 0;
+            }
+
+            // Destroy the elements of the previous table and release it
+            if (isRehashing()) {
+
+                for (int i=0; i < mOldNbSlots; i++) {
+                    if (isUsed(mOldControls[i])) {
+                        mOldSlots[i].~V();
+                    }
+                }
+
+                releaseTable(mOldControls, mOldSlots, mOldNbSlots);
+
+                mOldNbSlots = 0;
+                mOldNbElements = 0;
+                mOldNextSlot = 0;
+                mOldControls = nullptr;
+                mOldSlots = nullptr;
+            }
+
+            if (mNbSlots > 0) {
+                std::memset(mControls, ControlGroup::EMPTY, getNbControls(mNbSlots) * sizeof(int8_t));
+                mGrowthLeft = FlatTableGrowth::getMaxNbElements(mNbSlots);
+            }
+
+            assert(size() == 0);
+        }
+
+        /// Return the number of elements in the set
+        int size() const {
+            return mNbElements;
+        }
+
+        /// Return the capacity of the set (number of elements that it can contain without growing)
+        int capacity() const {
+            return mNbSlots > 0 ? FlatTableGrowth::getMaxNbElements(mNbSlots) : 0;
+        }
+
+        /// Try to find an item of the set given a value.
+        /// The method returns an iterator to the found item or
+        /// an iterator pointing to the end if not found
+        Iterator find(const V& value) const {
+
+            bool isInOldTable;
+            const int slot = findSlot(value, isInOldTable);
+            if (slot == -1) {
+                return end();
+            }
+
+            return getIterator(slot, isInOldTable);
+        }
+
+        /// Overloaded equality operator
+        bool operator==(const FlatSet<V>& set) const {
+
+            if (size() != set.size()) return false;
+
+            for (auto it = begin(); it != end(); ++it) {
+                if (!set.contains(*it)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// Overloaded not equal operator
+        bool operator!=(const FlatSet<V>& set) const {
+
+            return !((*this) == set);
+        }
+
+        /// Overloaded assignment operator
+        FlatSet<V>& operator=(const FlatSet<V>& set) {
+
+            // Check for self assignment
+            if (this != &set) {
+
+                // Reset the set
+                reset();
+
+                if (set.mNbSlots > 0) {
+                    allocate(set.mNbSlots);
+                    copySlots(set);
+                }
+            }
+
+            return *this;
+        }
+
+        /// Return a begin iterator
+        Iterator begin() const {
+
+            // If the set is empty
+            if (size() == 0) {
+
+                // Return an iterator to the end
+                return end();
+            }
+
+            Iterator it(mControls, mSlots, mNbSlots, -1, mOldControls, mOldSlots, mOldNbSlots);
+            it.advance();
+
+            return it;
+        }
+
+        /// Return a end iterator
+        Iterator end() const {
+
+            // During an incremental rehashing, the previous table is iterated last
+            if (isRehashing()) {
+                return Iterator(mOldControls, mOldSlots, mOldNbSlots, mOldNbSlots);
+            }
+
+            return Iterator(mControls, mSlots, mNbSlots, mNbSlots);
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,410 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_SMALL_LIST_H
+#define REACTPHYSICS3D_SMALL_LIST_H
+
+// Libraries
+#include "configuration.h"
+#include "memory/MemoryAllocator.h"
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace reactphysics3d {
+
+// Class SmallList
+/**
+ * This class represents a generic list with custom memory allocator that can store
+ * up to N elements inside the list object itself. The memory allocator is only used
+ * when more than N elements are added into the list. This list should be used for
+ * small temporary lists (on the stack for instance) to avoid memory allocations.
+ * The inline buffer is not referenced by a pointer and therefore, the memory of a
+ * list can be moved (as in List::removeAt()) without making it invalid.
+ */
+template<typename T, size_t N>
+class SmallList {
+
+    static_assert(N > 0, "The inline capacity of a SmallList must be positive");
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        /// Buffer for the first N elements of the list
+        alignas(T) unsigned char mInlineBuffer[N * sizeof(T)];
+
+        /// Buffer allocated with the memory allocator (only used if the capacity is larger than N)
+        void* mHeapBuffer;
+
+        /// Number of elements in the list
+        size_t mSize;
+
+        /// Number of allocated elements in the list
+        size_t mCapacity;
+
+        /// Memory allocator
+        MemoryAllocator& mAllocator;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return a pointer to the elements of the list
+        T* getBuffer() {
+            return mCapacity > N ? static_cast<T*>(mHeapBuffer) : reinterpret_cast<T*>(mInlineBuffer);
+        }
+
+        /// Return a pointer to the elements of the list
+        const T* getBuffer() const {
+            return mCapacity > N ? static_cast<const T*>(mHeapBuffer) : reinterpret_cast<const T*>(mInlineBuffer);
+        }
+
+    public:
+
+        /// Class Iterator
+        /**
+         * This class represents an iterator for the SmallList
+         */
+        class Iterator {
+
+            private:
+
+                size_t mCurrentIndex;
+                T* mBuffer;
+                size_t mSize;
+
+            public:
+
+                // Iterator traits
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = T*;
+                using reference = T&;
+                using iterator_category = std::bidirectional_iterator_tag;
+
+                /// Constructor
+                Iterator() = default;
+
+                /// Constructor
+                Iterator(T* buffer, size_t index, size_t size)
+                     :mCurrentIndex(index), mBuffer(buffer), mSize(size) {
+
+                }
+
+                /// Deferencable
+                reference operator*() const {
+                    assert(mCurrentIndex < mSize);
+                    return mBuffer[mCurrentIndex];
+                }
+
+                /// Deferencable
+                pointer operator->() const {
+                    assert(mCurrentIndex < mSize);
+                    return &(mBuffer[mCurrentIndex]);
+                }
+
+                /// Pre increment (++it)
+                Iterator& operator++() {
+                    assert(mCurrentIndex < mSize);
+                    mCurrentIndex++;
+                    return *this;
+                }
+
+                /// Post increment (it++)
+                Iterator operator++(int number) {
+                    assert(mCurrentIndex < mSize);
+                    Iterator tmp = *this;
+                    mCurrentIndex++;
+                    return tmp;
+                }
+
+                /// Pre decrement (--it)
+                Iterator& operator--() {
+                    assert(mCurrentIndex > 0);
+                    mCurrentIndex--;
+                    return *this;
+                }
+
+                /// Post decrement (it--)
+                Iterator operator--(int number) {
+                    assert(mCurrentIndex > 0);
+                    Iterator tmp = *this;
+                    mCurrentIndex--;
+                    return tmp;
+                }
+
+                /// Equality operator (it == end())
+                bool operator==(const Iterator& iterator) const {
+                    return mCurrentIndex == iterator.mCurrentIndex && mBuffer == iterator.mBuffer;
+                }
+
+                /// Inequality operator (it != end())
+                bool operator!=(const Iterator& iterator) const {
+                    return !(*this == iterator);
+                }
+
+                /// Frienship
+                friend class SmallList;
+        };
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        SmallList(MemoryAllocator& allocator, size_t capacity = 0)
+            : mHeapBuffer(nullptr), mSize(0), mCapacity(N), mAllocator(allocator) {
+
+            if (capacity > N) {
+
+                // Allocate memory
+                reserve(capacity);
+            }
+        }
+
+        /// Copy constructor
+        SmallList(const SmallList<T, N>& list)
+            : mHeapBuffer(nullptr), mSize(0), mCapacity(N), mAllocator(list.mAllocator) {
+
+            // Add all the elements of the list to the current one
+            addRange(list);
+        }
+
+        /// Destructor
+        ~SmallList() {
+
+            // Clear the list
+            clear();
+
+            // Release the memory allocated with the memory allocator
+            if (mCapacity > N) {
+                mAllocator.release(mHeapBuffer, mCapacity * sizeof(T));
+            }
+        }
+
+        /// Allocate memory for a given number of elements
+        void reserve(size_t capacity) {
+
+            if (capacity <= mCapacity) return;
+
+            // Allocate memory for the new array
+            void* newMemory = mAllocator.allocate(capacity * sizeof(T));
+
+            T* items = getBuffer();
+
+            if (mSize > 0) {
+
+                // Copy the elements to the new allocated memory location
+                std::uninitialized_copy(items, items + mSize, static_cast<T*>(newMemory));
+
+                // Destruct the previous items
+                for (size_t i=0; i<mSize; i++) {
+                    items[i].~T();
+                }
+            }
+
+            // Release the previously allocated memory
+            if (mCapacity > N) {
+                mAllocator.release(mHeapBuffer, mCapacity * sizeof(T));
+            }
+
+            mHeapBuffer = newMemory;
+            assert(mHeapBuffer != nullptr);
+
+            mCapacity = capacity;
+        }
+
+        /// Add an element into the list
+        void add(const T& element) {
+
+            // If we need to allocate more memory
+            if (mSize == mCapacity) {
+                reserve(mCapacity == 0 ? 1 : mCapacity * 2);
+            }
+
+            // Use the copy-constructor to construct the element
+            new (static_cast<void*>(getBuffer() + mSize)) T(element);
+
+            mSize++;
+        }
+
+        /// Try to find a given item of the list and return an iterator
+        /// pointing to that element if it exists in the list. Otherwise,
+        /// this method returns the end() iterator
+        Iterator find(const T& element) {
+
+            T* items = getBuffer();
+            for (size_t i=0; i<mSize; i++) {
+                if (element == items[i]) {
+                    return Iterator(items, i, mSize);
+                }
+            }
+
+            return end();
+        }
+
+        /// Look for an element in the list and remove it
+        Iterator remove(const T& element) {
+           return remove(find(element));
+        }
+
+        /// Remove an element from the list and return a iterator
+        /// pointing to the element after the removed one (or end() if none)
+        Iterator remove(const Iterator& it) {
+           assert(it.mBuffer == getBuffer());
+           return removeAt(it.mCurrentIndex);
+        }
+
+        /// Remove an element from the list at a given index and return an
+        /// iterator pointing to the element after the removed one (or end() if none)
+        Iterator removeAt(uint index) {
+
+          assert(index < mSize);
+
+          T* items = getBuffer();
+
+          // Call the destructor
+          items[index].~T();
+
+          mSize--;
+
+          if (index != mSize) {
+
+              // Move the elements to fill in the empty slot
+              char* dest = reinterpret_cast<char*>(items + index);
+              char* src = dest + sizeof(T);
+              std::memmove(static_cast<void*>(dest), static_cast<void*>(src), (mSize - index) * sizeof(T));
+          }
+
+          // Return an iterator pointing to the element after the removed one
+          return Iterator(items, index, mSize);
+        }
+
+        /// Append another list at the end of the current one
+        void addRange(const SmallList<T, N>& list) {
+
+            // If we need to allocate more memory
+            if (mSize + list.size() > mCapacity) {
+
+                // Allocate memory
+                reserve(mSize + list.size());
+            }
+
+            // Add the elements of the list to the current one
+            T* items = getBuffer();
+            for(size_t i=0; i<list.size(); i++) {
+
+                new (static_cast<void*>(items + mSize)) T(list[i]);
+                mSize++;
+            }
+        }
+
+        /// Clear the list
+        void clear() {
+
+            // Call the destructor of each element
+            T* items = getBuffer();
+            for (size_t i=0; i < mSize; i++) {
+                items[i].~T();
+            }
+
+            mSize = 0;
+        }
+
+        /// Return the number of elements in the list
+        size_t size() const {
+            return mSize;
+        }
+
+        /// Return the capacity of the list
+        size_t capacity() const {
+            return mCapacity;
+        }
+
+        /// Return true if the elements of the list are stored inside the list object
+        bool isInline() const {
+            return mCapacity <= N;
+        }
+
+        /// Overloaded index operator
+        T& operator[](const uint index) {
+           assert(index < mSize);
+           return getBuffer()[index];
+        }
+
+        /// Overloaded const index operator
+        const T& operator[](const uint index) const {
+           assert(index < mSize);
+           return getBuffer()[index];
+        }
+
+        /// Overloaded equality operator
+        bool operator==(const SmallList<T, N>& list) const {
+
+            if (mSize != list.mSize) return false;
+
+            const T* items = getBuffer();
+            for (size_t i=0; i < mSize; i++) {
+                if (items[i] != list[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// Overloaded not equal operator
+        bool operator!=(const SmallList<T, N>& list) const {
+
+            return !((*this) == list);
+        }
+
+        /// Overloaded assignment operator
+        SmallList<T, N>& operator=(const SmallList<T, N>& list) {
+
+            if (this != &list) {
+
+                // Clear all the elements
+                clear();
+
+                // Add all the elements of the list to the current one
+                addRange(list);
+            }
+
+            return *this;
+        }
+
+        /// Return a begin iterator
+        Iterator begin() const {
+            return Iterator(const_cast<T*>(getBuffer()), 0, mSize);
+        }
+
+        /// Return a end iterator
+        Iterator end() const {
+            return Iterator(const_cast<T*>(getBuffer()), mSize, mSize);
+        }
+};
+
+}
+
+#endif
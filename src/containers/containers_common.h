@@ -28,7 +28,10 @@
 
 // Libraries
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <cstring>
+#include <cassert>
 
 namespace reactphysics3d {
 
@@ -39,6 +42,191 @@ inline void hash_combine(std::size_t& seed, const T& v) {
     seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
 }
 
+/// This method is used to mix the bits of a hash value. It is used by the flat hash
+/// containers because many std::hash functions (for integers for instance) return the
+/// key itself and the low bits of the hash value are used to find the slot of an element.
+inline std::size_t hash_mix(std::size_t hash) {
+    uint64_t h = static_cast<uint64_t>(hash);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
+}
+
+// Class FlatTableGrowth
+/**
+ * This class contains the growth policy shared by the open-addressing hash tables (FlatMap
+ * and FlatSet): the minimum number of slots, the maximum load factor, the number of slots of
+ * a table when it grows and the number of slots moved from the previous table at each
+ * addition during an incremental rehashing.
+ */
+class FlatTableGrowth {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        /// Minimum number of slots of a table
+        static const int MIN_NB_SLOTS = 8;
+
+        /// Number of slots of the previous table that are moved into the new table each
+        /// time an element is added during an incremental rehashing. It has to be large
+        /// enough so that the rehashing is complete before the new table is full.
+        static const int NB_SLOTS_MOVED_PER_ADDITION = 16;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the maximum number of elements for a given number of slots. The maximum load
+        /// factor is 3/4 because the probing sequences would become too long with the small
+        /// groups of control bytes for a higher load factor.
+        static int getMaxNbElements(int nbSlots) {
+            return nbSlots - nbSlots / 4;
+        }
+
+        /// Return the number of slots of a full table when it grows. If enough slots are deleted
+        /// slots, the table only needs to be rehashed to turn them into empty slots.
+        static int getGrownNbSlots(int nbSlots, int nbElements) {
+
+            if (nbSlots == 0) return MIN_NB_SLOTS;
+
+            return (8 * nbElements <= 5 * nbSlots) ? nbSlots : nbSlots * 2;
+        }
+
+        /// Return the number of slots of a table with a given number of slots that has to
+        /// contain a given number of elements
+        static int getReservedNbSlots(int nbSlots, int capacity) {
+
+            nbSlots = nbSlots > 0 ? nbSlots : MIN_NB_SLOTS;
+            while (getMaxNbElements(nbSlots) < capacity) {
+                nbSlots *= 2;
+            }
+
+            return nbSlots;
+        }
+};
+
+// Class ControlGroup
+/**
+ * This class represents a group of consecutive control bytes of an open-addressing hash
+ * table (FlatMap or FlatSet). Each slot of the table has a control byte that is either EMPTY, DELETED
+ * or that contains seven bits of the hash value of the key stored in the slot. The bytes
+ * of a group are loaded into a single 64-bits word so that all the bytes of the group
+ * can be matched at once with a few bitwise operations. A match is returned as a mask
+ * with the highest bit of each matching byte set.
+ */
+class ControlGroup {
+
+    private:
+
+        // -------------------- Constants -------------------- //
+
+        /// Lowest bit of each byte of the group
+        static const uint64_t LOW_BITS = 0x0101010101010101ULL;
+
+        /// Highest bit of each byte of the group
+        static const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+        // -------------------- Attributes -------------------- //
+
+        /// Control bytes of the group (the first byte is in the lowest bits)
+        uint64_t mBytes;
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        /// Number of control bytes in a group
+        static const int SIZE = 8;
+
+        /// Control byte of an empty slot
+        static const int8_t EMPTY = -128;
+
+        /// Control byte of a slot whose element has been removed
+        static const int8_t DELETED = -2;
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor (load the control bytes starting at a given address)
+        explicit ControlGroup(const int8_t* controls) {
+            std::memcpy(&mBytes, controls, sizeof(uint64_t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            mBytes = __builtin_bswap64(mBytes);
+#endif
+        }
+
+        /// Return the mask of the bytes that are equal to a control byte of a used slot.
+        /// The mask might contain a few false positives but never misses a matching byte.
+        uint64_t matchControl(int8_t control) const {
+            const uint64_t bytes = mBytes ^ (LOW_BITS * static_cast<uint8_t>(control));
+            return (bytes - LOW_BITS) & ~bytes & HIGH_BITS;
+        }
+
+        /// Return the mask of the bytes of the empty slots
+        uint64_t matchEmpty() const {
+
+            // Only the EMPTY control byte has its highest bit set and its second lowest bit not set
+            return mBytes & (~mBytes << 6) & HIGH_BITS;
+        }
+
+        /// Return the mask of the bytes of the empty or deleted slots
+        uint64_t matchFree() const {
+            return mBytes & HIGH_BITS;
+        }
+
+        /// Return the mask of the bytes of the used slots
+        uint64_t matchUsed() const {
+            return ~mBytes & HIGH_BITS;
+        }
+
+        /// Return the index (in the group) of the first byte of a non-zero mask
+        static int getFirstIndex(uint64_t mask) {
+            return getNbTrailingBytes(mask);
+        }
+
+        /// Return the number of bytes before the first byte of a mask (SIZE if the mask is zero)
+        static int getNbTrailingBytes(uint64_t mask) {
+
+            if (mask == 0) return SIZE;
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(mask) >> 3;
+#else
+            int nbBytes = 0;
+            while ((mask & 0xFF) == 0) {
+                mask >>= 8;
+                nbBytes++;
+            }
+            return nbBytes;
+#endif
+        }
+
+        /// Return the number of bytes after the last byte of a mask (SIZE if the mask is zero)
+        static int getNbLeadingBytes(uint64_t mask) {
+
+            if (mask == 0) return SIZE;
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_clzll(mask) >> 3;
+#else
+            int nbBytes = 0;
+            while ((mask & 0xFF00000000000000ULL) == 0) {
+                mask <<= 8;
+                nbBytes++;
+            }
+            return nbBytes;
+#endif
+        }
+
+        /// Remove the bytes of a mask until a given index (included) in the group
+        static uint64_t removeUntil(uint64_t mask, int index) {
+            assert(index >= 0 && index < SIZE);
+            return mask & ((~uint64_t(0) << (index * 8)) << 8);
+        }
+
+        /// Remove the first byte of a non-zero mask
+        static uint64_t removeFirst(uint64_t mask) {
+            return mask & (mask - 1);
+        }
+};
+
 }
 
 #endif
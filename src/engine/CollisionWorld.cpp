@@ -37,8 +37,10 @@ uint CollisionWorld::mNbWorlds = 0;
 
 // Constructor
 CollisionWorld::CollisionWorld(const WorldSettings& worldSettings, Logger* logger, Profiler* profiler)
-               : mConfig(worldSettings), mCollisionDetection(this, mMemoryManager), mBodies(mMemoryManager.getPoolAllocator()), mCurrentBodyId(0),
-                 mFreeBodiesIds(mMemoryManager.getPoolAllocator()), mEventListener(nullptr), mName(worldSettings.worldName),
+               : mMemoryManager(worldSettings.baseMemoryAllocator, worldSettings.poolMemoryAllocator,
+                                worldSettings.singleFrameMemoryAllocator),
+                 mConfig(worldSettings), mCollisionDetection(this, mMemoryManager, mConfig), mBodies(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::Bodies)), mCurrentBodyId(0),
+                 mFreeBodiesIds(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::Bodies)), mEventListener(nullptr), mName(worldSettings.worldName),
                  mIsProfilerCreatedByUser(profiler != nullptr),
                  mIsLoggerCreatedByUser(logger != nullptr) {
 
@@ -146,7 +148,7 @@ CollisionBody* CollisionWorld::createCollisionBody(const Transform& transform) {
 
     // Create the collision body
     CollisionBody* collisionBody = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                        sizeof(CollisionBody)))
+                                        sizeof(CollisionBody), MemoryManager::AllocationTag::Bodies))
                                         CollisionBody(transform, *this, bodyID);
 
     assert(collisionBody != nullptr);
@@ -196,7 +198,8 @@ void CollisionWorld::destroyCollisionBody(CollisionBody* collisionBody) {
     mBodies.remove(collisionBody);
 
     // Free the object from the memory allocator
-    mMemoryManager.release(MemoryManager::AllocationType::Pool, collisionBody, sizeof(CollisionBody));
+    mMemoryManager.release(MemoryManager::AllocationType::Pool, collisionBody, sizeof(CollisionBody),
+                           MemoryManager::AllocationTag::Bodies);
 }
 
 // Return the next available body ID
@@ -185,6 +185,21 @@ class CollisionWorld {
         /// Return the name of the world
         const std::string& getName() const;
 
+        /// Return the memory manager of the world (to get its allocation statistics)
+        const MemoryManager& getMemoryManager() const;
+
+        /// Return the unused memory of the allocators of the world to the base allocator
+        size_t trimMemory();
+
+        /// Set whether the shapes of two collision layers can collide with each other
+        void setAreCollisionLayersColliding(uint8 layer1, uint8 layer2, bool isColliding);
+
+        /// Return true if the shapes of two collision layers can collide with each other
+        bool areCollisionLayersColliding(uint8 layer1, uint8 layer2) const;
+
+        /// Return the statistics of the broad-phase collision detection of the last step
+        BroadPhaseStatistics getBroadPhaseStatistics() const;
+
         // -------------------- Friendship -------------------- //
 
         friend class CollisionDetection;
@@ -263,6 +278,62 @@ inline const std::string& CollisionWorld::getName() const {
     return mName;
 }
 
+// Return the memory manager of the world
+/// This can be used to get the allocation statistics of the world
+/**
+ * @return A constant reference to the memory manager of the world
+ */
+inline const MemoryManager& CollisionWorld::getMemoryManager() const {
+    return mMemoryManager;
+}
+
+// Return the unused memory of the allocators of the world to the base allocator
+/// The pool allocator releases its memory blocks that do not contain any allocated
+/// memory and the single frame allocator releases the memory chunks that have not
+/// been used during the last frames. This can be called after a peak of memory
+/// usage (when many bodies have been destroyed for instance). Note that custom
+/// allocators might not release anything.
+/**
+ * @return The number of bytes that have been released
+ */
+inline size_t CollisionWorld::trimMemory() {
+    return mMemoryManager.trim();
+}
+
+// Set whether the shapes of two collision layers can collide with each other
+/// The collision layers can be used instead of (or together with) the collision
+/// category bits to filter the collisions. Two proxy shapes can only collide if
+/// their collision layers can collide. By default, all the layers can collide.
+/**
+ * @param layer1 The first collision layer (in [0, NB_COLLISION_LAYERS - 1])
+ * @param layer2 The second collision layer (in [0, NB_COLLISION_LAYERS - 1])
+ * @param isColliding True if the shapes of the two layers can collide with each other
+ */
+inline void CollisionWorld::setAreCollisionLayersColliding(uint8 layer1, uint8 layer2, bool isColliding) {
+    mCollisionDetection.setAreCollisionLayersColliding(layer1, layer2, isColliding);
+}
+
+// Return true if the shapes of two collision layers can collide with each other
+/**
+ * @param layer1 The first collision layer (in [0, NB_COLLISION_LAYERS - 1])
+ * @param layer2 The second collision layer (in [0, NB_COLLISION_LAYERS - 1])
+ * @return True if the shapes of the two layers can collide with each other
+ */
+inline bool CollisionWorld::areCollisionLayersColliding(uint8 layer1, uint8 layer2) const {
+    return mCollisionDetection.areCollisionLayersColliding(layer1, layer2);
+}
+
+// Return the statistics of the broad-phase collision detection of the last step
+/// The statistics are always available (they do not need a profiling build). The
+/// statistics of the trees (height, SAH cost and number of nodes) are computed when
+/// this method is called in a time proportional to the number of shapes.
+/**
+ * @return The statistics of the broad-phase of the last step
+ */
+inline BroadPhaseStatistics CollisionWorld::getBroadPhaseStatistics() const {
+    return mCollisionDetection.getBroadPhaseStatistics();
+}
+
 #ifdef IS_PROFILING_ACTIVE
 
 // Return a pointer to the profiler
@@ -82,11 +82,13 @@ void ContactSolver::init(Island** islands, uint nbIslands, decimal timeStep) {
 
     // TODO : Count exactly the number of constraints to allocate here
     mContactPoints = static_cast<ContactPointSolver*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                              sizeof(ContactPointSolver) * nbContactPoints));
+                                                                              sizeof(ContactPointSolver) * nbContactPoints,
+                                                                              MemoryManager::AllocationTag::Solver));
     assert(mContactPoints != nullptr);
 
     mContactConstraints = static_cast<ContactManifoldSolver*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                      sizeof(ContactManifoldSolver) * nbContactManifolds));
+                                                                                      sizeof(ContactManifoldSolver) * nbContactManifolds,
+                                                                                      MemoryManager::AllocationTag::Solver));
     assert(mContactConstraints != nullptr);
 
     // For each island of the world
@@ -51,8 +51,8 @@ DynamicsWorld::DynamicsWorld(const Vector3& gravity, const WorldSettings& worldS
                 mContactSolver(mMemoryManager, mConfig),
                 mNbVelocitySolverIterations(mConfig.defaultVelocitySolverNbIterations),
                 mNbPositionSolverIterations(mConfig.defaultPositionSolverNbIterations),
-                mIsSleepingEnabled(mConfig.isSleepingEnabled), mRigidBodies(mMemoryManager.getPoolAllocator()),
-                mJoints(mMemoryManager.getPoolAllocator()), mGravity(gravity), mTimeStep(decimal(1.0f / 60.0f)),
+                mIsSleepingEnabled(mConfig.isSleepingEnabled), mRigidBodies(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::Bodies)),
+                mJoints(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::Joints)), mGravity(gravity), mTimeStep(decimal(1.0f / 60.0f)),
                 mIsGravityEnabled(true), mConstrainedLinearVelocities(nullptr),
                 mConstrainedAngularVelocities(nullptr), mSplitLinearVelocities(nullptr),
                 mSplitAngularVelocities(nullptr), mConstrainedPositions(nullptr),
@@ -60,7 +60,8 @@ DynamicsWorld::DynamicsWorld(const Vector3& gravity, const WorldSettings& worldS
                 mSleepLinearVelocity(mConfig.defaultSleepLinearVelocity),
                 mSleepAngularVelocity(mConfig.defaultSleepAngularVelocity),
                 mTimeBeforeSleep(mConfig.defaultTimeBeforeSleep),
-                mFreeJointsIDs(mMemoryManager.getPoolAllocator()), mCurrentJointId(0) {
+                mFreeJointsIDs(mMemoryManager.getPoolAllocator(MemoryManager::AllocationTag::Joints)), mCurrentJointId(0),
+                mNbFramesSinceMemoryTrim(0) {
 
 #ifdef IS_PROFILING_ACTIVE
 
@@ -153,6 +154,16 @@ void DynamicsWorld::update(decimal timeStep) {
 
     // Reset the single frame memory allocator
     mMemoryManager.resetFrameAllocator();
+
+    // Return the unused memory of the allocators to the base allocator if necessary
+    if (mConfig.nbFramesBetweenMemoryTrims > 0) {
+
+        mNbFramesSinceMemoryTrim++;
+        if (mNbFramesSinceMemoryTrim >= mConfig.nbFramesBetweenMemoryTrims) {
+            mMemoryManager.trim();
+            mNbFramesSinceMemoryTrim = 0;
+        }
+    }
 }
 
 // Integrate position and orientation of the rigid bodies.
@@ -242,17 +253,23 @@ void DynamicsWorld::initVelocityArrays() {
     uint nbBodies = mRigidBodies.size();
 
     mSplitLinearVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                           nbBodies * sizeof(Vector3)));
+                                                                           nbBodies * sizeof(Vector3),
+                                                                           MemoryManager::AllocationTag::Solver));
     mSplitAngularVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                            nbBodies * sizeof(Vector3)));
+                                                                            nbBodies * sizeof(Vector3),
+                                                                            MemoryManager::AllocationTag::Solver));
     mConstrainedLinearVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                 nbBodies * sizeof(Vector3)));
+                                                                                 nbBodies * sizeof(Vector3),
+                                                                                 MemoryManager::AllocationTag::Solver));
     mConstrainedAngularVelocities = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                  nbBodies * sizeof(Vector3)));
+                                                                                  nbBodies * sizeof(Vector3),
+                                                                                  MemoryManager::AllocationTag::Solver));
     mConstrainedPositions = static_cast<Vector3*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                          nbBodies * sizeof(Vector3)));
+                                                                          nbBodies * sizeof(Vector3),
+                                                                          MemoryManager::AllocationTag::Solver));
     mConstrainedOrientations = static_cast<Quaternion*>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                nbBodies * sizeof(Quaternion)));
+                                                                                nbBodies * sizeof(Quaternion),
+                                                                                MemoryManager::AllocationTag::Solver));
     assert(mSplitLinearVelocities != nullptr);
     assert(mSplitAngularVelocities != nullptr);
     assert(mConstrainedLinearVelocities != nullptr);
@@ -425,7 +442,7 @@ RigidBody* DynamicsWorld::createRigidBody(const Transform& transform) {
 
     // Create the rigid body
     RigidBody* rigidBody = new (mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                        sizeof(RigidBody))) RigidBody(transform, *this, bodyID);
+                                                        sizeof(RigidBody), MemoryManager::AllocationTag::Bodies)) RigidBody(transform, *this, bodyID);
     assert(rigidBody != nullptr);
 
     // Add the rigid body to the physics world
@@ -479,7 +496,8 @@ void DynamicsWorld::destroyRigidBody(RigidBody* rigidBody) {
     mRigidBodies.remove(rigidBody);
 
     // Free the object from the memory allocator
-    mMemoryManager.release(MemoryManager::AllocationType::Pool, rigidBody, sizeof(RigidBody));
+    mMemoryManager.release(MemoryManager::AllocationType::Pool, rigidBody, sizeof(RigidBody),
+                           MemoryManager::AllocationTag::Bodies);
 }
 
 // Create a joint between two bodies in the world and return a pointer to the new joint
@@ -501,7 +519,7 @@ Joint* DynamicsWorld::createJoint(const JointInfo& jointInfo) {
         case JointType::BALLSOCKETJOINT:
         {
             void* allocatedMemory = mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                            sizeof(BallAndSocketJoint));
+                                                            sizeof(BallAndSocketJoint), MemoryManager::AllocationTag::Joints);
             const BallAndSocketJointInfo& info = static_cast<const BallAndSocketJointInfo&>(
                                                                                         jointInfo);
             newJoint = new (allocatedMemory) BallAndSocketJoint(jointId, info);
@@ -512,7 +530,7 @@ Joint* DynamicsWorld::createJoint(const JointInfo& jointInfo) {
         case JointType::SLIDERJOINT:
         {
             void* allocatedMemory = mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                            sizeof(SliderJoint));
+                                                            sizeof(SliderJoint), MemoryManager::AllocationTag::Joints);
             const SliderJointInfo& info = static_cast<const SliderJointInfo&>(jointInfo);
             newJoint = new (allocatedMemory) SliderJoint(jointId, info);
             break;
@@ -522,7 +540,7 @@ Joint* DynamicsWorld::createJoint(const JointInfo& jointInfo) {
         case JointType::HINGEJOINT:
         {
             void* allocatedMemory = mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                            sizeof(HingeJoint));
+                                                            sizeof(HingeJoint), MemoryManager::AllocationTag::Joints);
             const HingeJointInfo& info = static_cast<const HingeJointInfo&>(jointInfo);
             newJoint = new (allocatedMemory) HingeJoint(jointId, info);
             break;
@@ -532,7 +550,7 @@ Joint* DynamicsWorld::createJoint(const JointInfo& jointInfo) {
         case JointType::FIXEDJOINT:
         {
             void* allocatedMemory = mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                            sizeof(FixedJoint));
+                                                            sizeof(FixedJoint), MemoryManager::AllocationTag::Joints);
             const FixedJointInfo& info = static_cast<const FixedJointInfo&>(jointInfo);
             newJoint = new (allocatedMemory) FixedJoint(jointId, info);
             break;
@@ -608,7 +626,7 @@ void DynamicsWorld::destroyJoint(Joint* joint) {
     mFreeJointsIDs.add(joint->getId());
 
     // Release the allocated memory
-    mMemoryManager.release(MemoryManager::AllocationType::Pool, joint, nbBytes);
+    mMemoryManager.release(MemoryManager::AllocationType::Pool, joint, nbBytes, MemoryManager::AllocationTag::Joints);
 }
 
 // Add the joint to the list of joints of the two bodies involved in the joint
@@ -618,7 +636,7 @@ void DynamicsWorld::addJointToBody(Joint* joint) {
 
     // Add the joint at the beginning of the linked list of joints of the first body
     void* allocatedMemory1 = mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                     sizeof(JointListElement));
+                                                     sizeof(JointListElement), MemoryManager::AllocationTag::Joints);
     JointListElement* jointListElement1 = new (allocatedMemory1) JointListElement(joint,
                                                                      joint->mBody1->mJointsList);
     joint->mBody1->mJointsList = jointListElement1;
@@ -629,7 +647,7 @@ void DynamicsWorld::addJointToBody(Joint* joint) {
 
     // Add the joint at the beginning of the linked list of joints of the second body
     void* allocatedMemory2 = mMemoryManager.allocate(MemoryManager::AllocationType::Pool,
-                                                     sizeof(JointListElement));
+                                                     sizeof(JointListElement), MemoryManager::AllocationTag::Joints);
     JointListElement* jointListElement2 = new (allocatedMemory2) JointListElement(joint,
                                                                      joint->mBody2->mJointsList);
     joint->mBody2->mJointsList = jointListElement2;
@@ -672,7 +690,8 @@ void DynamicsWorld::computeIslands() {
     // Allocate and create the array of islands pointer. This memory is allocated
     // in the single frame allocator
     mIslands = static_cast<Island**>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                             sizeof(Island*) * nbBodies));
+                                                             sizeof(Island*) * nbBodies,
+                                                             MemoryManager::AllocationTag::Islands));
     mNbIslands = 0;
 
     int nbContactManifolds = 0;
@@ -689,7 +708,7 @@ void DynamicsWorld::computeIslands() {
     // Create a stack (using an array) for the rigid bodies to visit during the Depth First Search
     size_t nbBytesStack = sizeof(RigidBody*) * nbBodies;
     RigidBody** stackBodiesToVisit = static_cast<RigidBody**>(mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                                      nbBytesStack));
+                                                                                      nbBytesStack, MemoryManager::AllocationTag::Islands));
 
     // For each rigid body of the world
     for (List<RigidBody*>::Iterator it = mRigidBodies.begin(); it != mRigidBodies.end(); ++it) {
@@ -713,7 +732,7 @@ void DynamicsWorld::computeIslands() {
 
         // Create the new island
         void* allocatedMemoryIsland = mMemoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                              sizeof(Island));
+                                                              sizeof(Island), MemoryManager::AllocationTag::Islands);
         mIslands[mNbIslands] = new (allocatedMemoryIsland) Island(nbBodies, nbContactManifolds, mJoints.size(),
                                                                   mMemoryManager);
 
@@ -900,7 +919,7 @@ List<const ContactManifold*> DynamicsWorld::getContactsList() {
     List<const ContactManifold*> contactManifolds(mMemoryManager.getPoolAllocator());
 
     // For each currently overlapping pair of bodies
-    Map<Pair<uint, uint>, OverlappingPair*>::Iterator it;
+    FlatMap<Pair<uint, uint>, OverlappingPair*>::Iterator it;
     for (it = mCollisionDetection.mOverlappingPairs.begin();
          it != mCollisionDetection.mOverlappingPairs.end(); ++it) {
 
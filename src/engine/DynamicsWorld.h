@@ -125,6 +125,9 @@ class DynamicsWorld : public CollisionWorld {
         /// Current joint id
         uint mCurrentJointId;
 
+        /// Number of frames since the last automatic trim of the memory allocators
+        uint mNbFramesSinceMemoryTrim;
+
         // -------------------- Methods -------------------- //
 
         /// Integrate the positions and orientations of rigid bodies.
@@ -36,11 +36,14 @@ Island::Island(uint nbMaxBodies, uint nbMaxContactManifolds, uint nbMaxJoints, M
 
     // Allocate memory for the arrays on the single frame allocator
     mBodies = static_cast<RigidBody**>(memoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                              sizeof(RigidBody*) * nbMaxBodies));
+                                                              sizeof(RigidBody*) * nbMaxBodies,
+                                                              MemoryManager::AllocationTag::Islands));
     mContactManifolds = static_cast<ContactManifold**>(memoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                                              sizeof(ContactManifold*) * nbMaxContactManifolds));
+                                                                              sizeof(ContactManifold*) * nbMaxContactManifolds,
+                                                                              MemoryManager::AllocationTag::Islands));
     mJoints = static_cast<Joint**>(memoryManager.allocate(MemoryManager::AllocationType::Frame,
-                                                          sizeof(Joint*) * nbMaxJoints));
+                                                          sizeof(Joint*) * nbMaxJoints,
+                                                          MemoryManager::AllocationTag::Islands));
 }
 
 // Destructor
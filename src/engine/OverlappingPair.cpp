@@ -39,7 +39,7 @@ OverlappingPair::OverlappingPair(ProxyShape* shape1, ProxyShape* shape2,
                                  const WorldSettings& worldSettings)
                 : mContactManifoldSet(shape1, shape2, persistentMemoryAllocator, worldSettings), mPotentialContactManifolds(nullptr),
                   mPersistentAllocator(persistentMemoryAllocator), mTempMemoryAllocator(temporaryMemoryAllocator),
-                  mLastFrameCollisionInfos(mPersistentAllocator), mWorldSettings(worldSettings) {
+                  mLastFrameCollisionInfos(mPersistentAllocator), mWorldSettings(worldSettings), mActivePairIndex(-1) {
     
 }         
 
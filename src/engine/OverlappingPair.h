@@ -29,7 +29,7 @@
 // Libraries
 #include "collision/ContactManifoldSet.h"
 #include "collision/ProxyShape.h"
-#include "containers/Map.h"
+#include "containers/FlatMap.h"
 #include "containers/Pair.h"
 #include "containers/containers_common.h"
 
@@ -123,11 +123,15 @@ class OverlappingPair {
         /// If two convex shapes overlap, we have a single collision data but if one shape is concave,
         /// we might have collision data for several overlapping triangles. The key in the map is the
         /// shape Ids of the two collision shapes.
-        Map<ShapeIdPair, LastFrameCollisionInfo*> mLastFrameCollisionInfos;
+        FlatMap<ShapeIdPair, LastFrameCollisionInfo*> mLastFrameCollisionInfos;
 
         /// World settings
         const WorldSettings& mWorldSettings;
 
+        /// Index of the pair in the list of active pairs of the collision detection
+        /// (-1 if the pair is not active because its two bodies are sleeping or static)
+        int mActivePairIndex;
+
     public:
 
         // -------------------- Methods -------------------- //
@@ -211,6 +215,7 @@ class OverlappingPair {
         // -------------------- Friendship -------------------- //
 
         friend class DynamicsWorld;
+        friend class CollisionDetection;
 };
 
 // Return the pointer to first body
@@ -230,7 +235,7 @@ inline void OverlappingPair::addContactManifold(const ContactManifoldInfo* conta
 
 // Return the last frame collision info for a given shape id or nullptr if none is found
 inline LastFrameCollisionInfo* OverlappingPair::getLastFrameCollisionInfo(ShapeIdPair& shapeIds) {
-    Map<ShapeIdPair, LastFrameCollisionInfo*>::Iterator it = mLastFrameCollisionInfos.find(shapeIds);
+    FlatMap<ShapeIdPair, LastFrameCollisionInfo*>::Iterator it = mLastFrameCollisionInfos.find(shapeIds);
     if (it != mLastFrameCollisionInfos.end()) {
         return it->second;
     }
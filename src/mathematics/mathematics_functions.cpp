@@ -221,14 +221,14 @@ decimal reactphysics3d::computePointToLineDistance(const Vector3& linePointA, co
 
 // Clip a segment against multiple planes and return the clipped segment vertices
 // This method implements the Sutherland–Hodgman clipping algorithm
-List<Vector3> reactphysics3d::clipSegmentWithPlanes(const Vector3& segA, const Vector3& segB,
-                                                           const List<Vector3>& planesPoints,
-                                                           const List<Vector3>& planesNormals,
-                                                           MemoryAllocator& allocator) {
+ClippingVertices reactphysics3d::clipSegmentWithPlanes(const Vector3& segA, const Vector3& segB,
+                                                      const ClippingVertices& planesPoints,
+                                                      const ClippingVertices& planesNormals,
+                                                      MemoryAllocator& allocator) {
     assert(planesPoints.size() == planesNormals.size());
 
-    List<Vector3> inputVertices(allocator, 2);
-    List<Vector3> outputVertices(allocator, 2);
+    ClippingVertices inputVertices(allocator, 2);
+    ClippingVertices outputVertices(allocator, 2);
 
     inputVertices.add(segA);
     inputVertices.add(segB);
@@ -296,14 +296,14 @@ List<Vector3> reactphysics3d::clipSegmentWithPlanes(const Vector3& segA, const V
 
 // Clip a polygon against multiple planes and return the clipped polygon vertices
 // This method implements the Sutherland–Hodgman clipping algorithm
-List<Vector3> reactphysics3d::clipPolygonWithPlanes(const List<Vector3>& polygonVertices, const List<Vector3>& planesPoints,
-                                                    const List<Vector3>& planesNormals, MemoryAllocator& allocator) {
+ClippingVertices reactphysics3d::clipPolygonWithPlanes(const ClippingVertices& polygonVertices, const ClippingVertices& planesPoints,
+                                                      const ClippingVertices& planesNormals, MemoryAllocator& allocator) {
 
     assert(planesPoints.size() == planesNormals.size());
 
         uint nbMaxElements = polygonVertices.size() + planesPoints.size();
-        List<Vector3> inputVertices(allocator, nbMaxElements);
-        List<Vector3> outputVertices(allocator, nbMaxElements);
+        ClippingVertices inputVertices(allocator, nbMaxElements);
+        ClippingVertices outputVertices(allocator, nbMaxElements);
 
         inputVertices.addRange(polygonVertices);
 
@@ -404,4 +404,20 @@ bool reactphysics3d::isPrimeNumber(int number) {
     return number == 2;
 }
 
+// Compute the single precision origin and inverse direction of a ray for the slab test
+/// The inverse of a null component of the direction (or of a very small one) is replaced by
+/// a large value with the same sign such that the slab test stays finite.
+void reactphysics3d::computeFloatRaySlabData(const Vector3& rayPoint1, const Vector3& rayPoint2,
+                                            float* outOrigin, float* outInvDirection) {
+
+    const Vector3 direction = rayPoint2 - rayPoint1;
+    const decimal largeValue = decimal(1e30);
+    for (int i=0; i < 3; i++) {
+        outOrigin[i] = static_cast<float>(rayPoint1[i]);
+        outInvDirection[i] = direction[i] != decimal(0.0) ?
+                    static_cast<float>(clamp(decimal(1.0) / direction[i], -largeValue, largeValue)) :
+                    static_cast<float>(largeValue);
+    }
+}
+
 
@@ -32,7 +32,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cfloat>
 #include "containers/List.h"
+#include "containers/SmallList.h"
 
 /// ReactPhysics3D namespace
 namespace reactphysics3d {
@@ -40,6 +42,11 @@ namespace reactphysics3d {
 struct Vector3;
 struct Vector2;
 
+/// List of vertices used by the clipping methods. Up to eight vertices (the clipping of
+/// a quad face of a box against the four side planes of another quad face) are stored
+/// without memory allocation.
+using ClippingVertices = SmallList<Vector3, 8>;
+
 // ---------- Mathematics functions ---------- //
 
 /// Function to test if two real numbers are (almost) equal
@@ -111,14 +118,14 @@ decimal computePlaneSegmentIntersection(const Vector3& segA, const Vector3& segB
 decimal computePointToLineDistance(const Vector3& linePointA, const Vector3& linePointB, const Vector3& point);
 
 /// Clip a segment against multiple planes and return the clipped segment vertices
-List<Vector3> clipSegmentWithPlanes(const Vector3& segA, const Vector3& segB,
-                                                           const List<Vector3>& planesPoints,
-                                                           const List<Vector3>& planesNormals,
-                                                           MemoryAllocator& allocator);
+ClippingVertices clipSegmentWithPlanes(const Vector3& segA, const Vector3& segB,
+                                       const ClippingVertices& planesPoints,
+                                       const ClippingVertices& planesNormals,
+                                       MemoryAllocator& allocator);
 
 /// Clip a polygon against multiple planes and return the clipped polygon vertices
-List<Vector3> clipPolygonWithPlanes(const List<Vector3>& polygonVertices, const List<Vector3>& planesPoints,
-                                    const List<Vector3>& planesNormals, MemoryAllocator& allocator);
+ClippingVertices clipPolygonWithPlanes(const ClippingVertices& polygonVertices, const ClippingVertices& planesPoints,
+                                       const ClippingVertices& planesNormals, MemoryAllocator& allocator);
 
 /// Project a point onto a plane that is given by a point and its unit length normal
 Vector3 projectPointOntoPlane(const Vector3& point, const Vector3& planeNormal, const Vector3& planePoint);
@@ -129,6 +136,36 @@ decimal computePointToPlaneDistance(const Vector3& point, const Vector3& planeNo
 /// Return true if the given number is prime
 bool isPrimeNumber(int number);
 
+/// Return the largest single precision value smaller or equal to a value
+/// (used to build conservative single precision AABBs)
+inline float roundDownToFloat(decimal value) {
+    float result = static_cast<float>(value);
+    if (static_cast<decimal>(result) > value) {
+        result = std::nextafter(result, -FLT_MAX);
+    }
+    return result;
+}
+
+/// Return the smallest single precision value larger or equal to a value
+/// (used to build conservative single precision AABBs)
+inline float roundUpToFloat(decimal value) {
+    float result = static_cast<float>(value);
+    if (static_cast<decimal>(result) < value) {
+        result = std::nextafter(result, FLT_MAX);
+    }
+    return result;
+}
+
+/// Compute the single precision origin and inverse direction of a ray for the slab test
+/// against single precision AABBs
+void computeFloatRaySlabData(const Vector3& rayPoint1, const Vector3& rayPoint2, float* outOrigin, float* outInvDirection);
+
+/// Return the single precision maximum fraction of a ray for the slab test against single
+/// precision AABBs (with a small margin for the rounding errors)
+inline float computeFloatRayMaxFraction(decimal maxFraction) {
+    return static_cast<float>(maxFraction) * 1.0001f + 1e-6f;
+}
+
 }
 
 
@@ -25,25 +25,24 @@
 
 // Libraries
 #include "DefaultPoolAllocator.h"
-#include "MemoryManager.h"
 #include <cstdlib>
 #include <cassert>
+#include <algorithm>
 
 using namespace reactphysics3d;
 
 // Initialization of static variables
-bool DefaultPoolAllocator::isMapSizeToHeadIndexInitialized = false;
 size_t DefaultPoolAllocator::mUnitSizes[NB_HEAPS];
 int DefaultPoolAllocator::mMapSizeToHeapIndex[MAX_UNIT_SIZE + 1];
 
 // Constructor
-DefaultPoolAllocator::DefaultPoolAllocator() {
+DefaultPoolAllocator::DefaultPoolAllocator(MemoryAllocator& baseAllocator) : mBaseAllocator(baseAllocator) {
 
     // Allocate some memory to manage the blocks
-    mNbAllocatedMemoryBlocks = 64;
+    mNbAllocatedMemoryBlocks = NB_MEMORY_BLOCKS_INCREMENT;
     mNbCurrentMemoryBlocks = 0;
     const size_t sizeToAllocate = mNbAllocatedMemoryBlocks * sizeof(MemoryBlock);
-    mMemoryBlocks = static_cast<MemoryBlock*>(MemoryManager::getBaseAllocator().allocate(sizeToAllocate));
+    mMemoryBlocks = static_cast<MemoryBlock*>(mBaseAllocator.allocate(sizeToAllocate));
     memset(mMemoryBlocks, 0, sizeToAllocate);
     memset(mFreeMemoryUnits, 0, sizeof(mFreeMemoryUnits));
 
@@ -51,31 +50,37 @@ DefaultPoolAllocator::DefaultPoolAllocator() {
         mNbTimesAllocateMethodCalled = 0;
 #endif
 
-    // If the mMapSizeToHeapIndex has not been initialized yet
-    if (!isMapSizeToHeadIndexInitialized) {
+    // Initialize the lookup tables the first time a pool allocator is created. A function
+    // local static is used so that this is thread-safe if several worlds (and therefore
+    // several pool allocators) are created concurrently
+    static const bool isMapSizeToHeapIndexInitialized = initMapSizeToHeapIndex();
+    (void) isMapSizeToHeapIndexInitialized;
+}
 
-        // Initialize the array that contains the sizes the memory units that will
-        // be allocated in each different heap
-        for (uint i=0; i < NB_HEAPS; i++) {
-            mUnitSizes[i] = (i+1) * 8;
-        }
+// Initialize the static lookup tables shared by all the pool allocators
+bool DefaultPoolAllocator::initMapSizeToHeapIndex() {
 
-        // Initialize the lookup table that maps the size to allocated to the
-        // corresponding heap we will use for the allocation
-        uint j = 0;
-        mMapSizeToHeapIndex[0] = -1;    // This element should not be used
-        for (uint i=1; i <= MAX_UNIT_SIZE; i++) {
-            if (i <= mUnitSizes[j]) {
-                mMapSizeToHeapIndex[i] = j;
-            }
-            else {
-                j++;
-                mMapSizeToHeapIndex[i] = j;
-            }
-        }
+    // Initialize the array that contains the sizes the memory units that will
+    // be allocated in each different heap
+    for (uint i=0; i < NB_HEAPS; i++) {
+        mUnitSizes[i] = (i+1) * 8;
+    }
 
-        isMapSizeToHeadIndexInitialized = true;
+    // Initialize the lookup table that maps the size to allocated to the
+    // corresponding heap we will use for the allocation
+    uint j = 0;
+    mMapSizeToHeapIndex[0] = -1;    // This element should not be used
+    for (uint i=1; i <= MAX_UNIT_SIZE; i++) {
+        if (i <= mUnitSizes[j]) {
+            mMapSizeToHeapIndex[i] = j;
+        }
+        else {
+            j++;
+            mMapSizeToHeapIndex[i] = j;
+        }
     }
+
+    return true;
 }
 
 // Destructor
@@ -83,10 +88,10 @@ DefaultPoolAllocator::~DefaultPoolAllocator() {
 
     // Release the memory allocated for each block
     for (uint i=0; i<mNbCurrentMemoryBlocks; i++) {
-        MemoryManager::getBaseAllocator().release(mMemoryBlocks[i].memoryUnits, BLOCK_SIZE);
+        mBaseAllocator.release(mMemoryBlocks[i].memoryUnits, BLOCK_SIZE);
     }
 
-    MemoryManager::getBaseAllocator().release(mMemoryBlocks, mNbAllocatedMemoryBlocks * sizeof(MemoryBlock));
+    mBaseAllocator.release(mMemoryBlocks, mNbAllocatedMemoryBlocks * sizeof(MemoryBlock));
 
 #ifndef NDEBUG
         // Check that the allocate() and release() methods have been called the same
@@ -111,7 +116,7 @@ void* DefaultPoolAllocator::allocate(size_t size) {
     if (size > MAX_UNIT_SIZE) {
 
         // Allocate memory using default allocation
-        return MemoryManager::getBaseAllocator().allocate(size);
+        return mBaseAllocator.allocate(size);
     }
 
     // Get the index of the heap that will take care of the allocation request
@@ -132,18 +137,14 @@ void* DefaultPoolAllocator::allocate(size_t size) {
         if (mNbCurrentMemoryBlocks == mNbAllocatedMemoryBlocks) {
 
             // Allocate more memory to contain the blocks
-            MemoryBlock* currentMemoryBlocks = mMemoryBlocks;
-            mNbAllocatedMemoryBlocks += 64;
-            mMemoryBlocks = static_cast<MemoryBlock*>(MemoryManager::getBaseAllocator().allocate(mNbAllocatedMemoryBlocks * sizeof(MemoryBlock)));
-            memcpy(mMemoryBlocks, currentMemoryBlocks, mNbCurrentMemoryBlocks * sizeof(MemoryBlock));
-            memset(mMemoryBlocks + mNbCurrentMemoryBlocks, 0, 64 * sizeof(MemoryBlock));
-            MemoryManager::getBaseAllocator().release(currentMemoryBlocks, mNbCurrentMemoryBlocks * sizeof(MemoryBlock));
+            resizeMemoryBlocks(mNbAllocatedMemoryBlocks + NB_MEMORY_BLOCKS_INCREMENT);
         }
 
         // Allocate a new memory blocks for the corresponding heap and divide it in many
         // memory units
         MemoryBlock* newBlock = mMemoryBlocks + mNbCurrentMemoryBlocks;
-        newBlock->memoryUnits = static_cast<MemoryUnit*>(MemoryManager::getBaseAllocator().allocate(BLOCK_SIZE));
+        newBlock->memoryUnits = static_cast<MemoryUnit*>(mBaseAllocator.allocate(BLOCK_SIZE));
+        newBlock->indexHeap = indexHeap;
         assert(newBlock->memoryUnits != nullptr);
         size_t unitSize = mUnitSizes[indexHeap];
         uint nbUnits = BLOCK_SIZE / unitSize;
@@ -184,7 +185,7 @@ void DefaultPoolAllocator::release(void* pointer, size_t size) {
     if (size > MAX_UNIT_SIZE) {
 
         // Release the memory using the default deallocation
-        MemoryManager::getBaseAllocator().release(pointer, size);
+        mBaseAllocator.release(pointer, size);
         return;
     }
 
@@ -198,3 +199,123 @@ void DefaultPoolAllocator::release(void* pointer, size_t size) {
     releasedUnit->nextUnit = mFreeMemoryUnits[indexHeap];
     mFreeMemoryUnits[indexHeap] = releasedUnit;
 }
+
+// Resize the array of memory blocks
+void DefaultPoolAllocator::resizeMemoryBlocks(uint nbAllocatedMemoryBlocks) {
+
+    assert(nbAllocatedMemoryBlocks >= mNbCurrentMemoryBlocks);
+
+    MemoryBlock* currentMemoryBlocks = mMemoryBlocks;
+    const uint currentNbAllocatedMemoryBlocks = mNbAllocatedMemoryBlocks;
+    mNbAllocatedMemoryBlocks = nbAllocatedMemoryBlocks;
+    mMemoryBlocks = static_cast<MemoryBlock*>(mBaseAllocator.allocate(mNbAllocatedMemoryBlocks * sizeof(MemoryBlock)));
+    memcpy(mMemoryBlocks, currentMemoryBlocks, mNbCurrentMemoryBlocks * sizeof(MemoryBlock));
+    memset(mMemoryBlocks + mNbCurrentMemoryBlocks, 0, (mNbAllocatedMemoryBlocks - mNbCurrentMemoryBlocks) * sizeof(MemoryBlock));
+    mBaseAllocator.release(currentMemoryBlocks, currentNbAllocatedMemoryBlocks * sizeof(MemoryBlock));
+}
+
+// Return the index of the memory block that contains a given memory unit
+/// The memory blocks must be sorted by address
+uint DefaultPoolAllocator::findMemoryBlock(const MemoryUnit* unit) const {
+
+    const char* unitAddress = reinterpret_cast<const char*>(unit);
+
+    // Binary search of the last block that starts before the memory unit
+    uint min = 0;
+    uint max = mNbCurrentMemoryBlocks;
+    while (max - min > 1) {
+        const uint middle = (min + max) / 2;
+        if (reinterpret_cast<const char*>(mMemoryBlocks[middle].memoryUnits) <= unitAddress) {
+            min = middle;
+        }
+        else {
+            max = middle;
+        }
+    }
+
+    assert(unitAddress >= reinterpret_cast<const char*>(mMemoryBlocks[min].memoryUnits));
+    assert(unitAddress < reinterpret_cast<const char*>(mMemoryBlocks[min].memoryUnits) + BLOCK_SIZE);
+
+    return min;
+}
+
+// Release the memory blocks that only contain free memory units
+/// The memory blocks where all the memory units are free are returned to the base
+/// allocator. This method returns the number of bytes that have been released. Its
+/// cost is proportional to the number of free memory units and therefore, it should
+/// not be called at each frame.
+size_t DefaultPoolAllocator::trim() {
+
+    if (mNbCurrentMemoryBlocks == 0) return 0;
+
+    // Sort the memory blocks by address so that we can find the block of a memory unit
+    std::sort(mMemoryBlocks, mMemoryBlocks + mNbCurrentMemoryBlocks, [](const MemoryBlock& block1, const MemoryBlock& block2) {
+        return block1.memoryUnits < block2.memoryUnits;
+    });
+
+    // Count the number of free memory units in each block
+    uint* nbFreeUnits = static_cast<uint*>(mBaseAllocator.allocate(mNbCurrentMemoryBlocks * sizeof(uint)));
+    memset(nbFreeUnits, 0, mNbCurrentMemoryBlocks * sizeof(uint));
+    for (int i=0; i < NB_HEAPS; i++) {
+        for (MemoryUnit* unit = mFreeMemoryUnits[i]; unit != nullptr; unit = unit->nextUnit) {
+            nbFreeUnits[findMemoryBlock(unit)]++;
+        }
+    }
+
+    // Find the blocks where all the memory units are free
+    uint nbFreeBlocks = 0;
+    for (uint b=0; b < mNbCurrentMemoryBlocks; b++) {
+        const uint nbUnits = static_cast<uint>(BLOCK_SIZE / mUnitSizes[mMemoryBlocks[b].indexHeap]);
+        assert(nbFreeUnits[b] <= nbUnits);
+        if (nbFreeUnits[b] == nbUnits) {
+            nbFreeBlocks++;
+        }
+        else {
+            nbFreeUnits[b] = 0;
+        }
+    }
+
+    size_t nbReleasedBytes = 0;
+
+    if (nbFreeBlocks > 0) {
+
+        // Remove the memory units of the free blocks from the lists of free memory units
+        for (int i=0; i < NB_HEAPS; i++) {
+            MemoryUnit** link = &mFreeMemoryUnits[i];
+            while (*link != nullptr) {
+                if (nbFreeUnits[findMemoryBlock(*link)] > 0) {
+                    *link = (*link)->nextUnit;
+                }
+                else {
+                    link = &(*link)->nextUnit;
+                }
+            }
+        }
+
+        // Release the free blocks and remove them from the array of blocks
+        uint nbRemainingBlocks = 0;
+        for (uint b=0; b < mNbCurrentMemoryBlocks; b++) {
+            if (nbFreeUnits[b] > 0) {
+                mBaseAllocator.release(mMemoryBlocks[b].memoryUnits, BLOCK_SIZE);
+                nbReleasedBytes += BLOCK_SIZE;
+            }
+            else {
+                mMemoryBlocks[nbRemainingBlocks] = mMemoryBlocks[b];
+                nbRemainingBlocks++;
+            }
+        }
+        memset(mMemoryBlocks + nbRemainingBlocks, 0, (mNbCurrentMemoryBlocks - nbRemainingBlocks) * sizeof(MemoryBlock));
+    }
+
+    mBaseAllocator.release(nbFreeUnits, mNbCurrentMemoryBlocks * sizeof(uint));
+    mNbCurrentMemoryBlocks -= nbFreeBlocks;
+
+    // Shrink the array of blocks if it is too large
+    uint nbAllocatedMemoryBlocks = (mNbCurrentMemoryBlocks / NB_MEMORY_BLOCKS_INCREMENT + 1) * NB_MEMORY_BLOCKS_INCREMENT;
+    if (nbAllocatedMemoryBlocks < mNbAllocatedMemoryBlocks) {
+        nbReleasedBytes += (mNbAllocatedMemoryBlocks - nbAllocatedMemoryBlocks) * sizeof(MemoryBlock);
+        resizeMemoryBlocks(nbAllocatedMemoryBlocks);
+    }
+
+    return nbReleasedBytes;
+}
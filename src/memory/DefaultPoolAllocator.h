@@ -73,6 +73,9 @@ class DefaultPoolAllocator : public MemoryAllocator {
 
                 /// Pointer to the first element of a linked-list of memory unity.
                 MemoryUnit* memoryUnits;
+
+                /// Index of the heap that uses the memory block
+                int indexHeap;
         };
 
         // -------------------- Constants -------------------- //
@@ -89,6 +92,9 @@ class DefaultPoolAllocator : public MemoryAllocator {
         /// Size a memory chunk
         static const size_t BLOCK_SIZE = 16 * MAX_UNIT_SIZE;
 
+        /// Number of memory blocks to add when the array of blocks is full
+        static const uint NB_MEMORY_BLOCKS_INCREMENT = 64;
+
         // -------------------- Attributes -------------------- //
 
         /// Size of the memory units that each heap is responsible to allocate
@@ -98,8 +104,8 @@ class DefaultPoolAllocator : public MemoryAllocator {
         /// corresponding heap we will use for the allocation.
         static int mMapSizeToHeapIndex[MAX_UNIT_SIZE + 1];
 
-        /// True if the mMapSizeToHeapIndex array has already been initialized
-        static bool isMapSizeToHeadIndexInitialized;
+        /// Base memory allocator used to allocate the memory blocks
+        MemoryAllocator& mBaseAllocator;
 
         /// Pointers to the first free memory unit for each heap
         MemoryUnit* mFreeMemoryUnits[NB_HEAPS];
@@ -121,12 +127,23 @@ class DefaultPoolAllocator : public MemoryAllocator {
         int mNbTimesAllocateMethodCalled;
 #endif
 
+        // -------------------- Methods -------------------- //
+
+        /// Initialize the static lookup tables shared by all the pool allocators
+        static bool initMapSizeToHeapIndex();
+
+        /// Return the index of the memory block that contains a given memory unit
+        uint findMemoryBlock(const MemoryUnit* unit) const;
+
+        /// Resize the array of memory blocks
+        void resizeMemoryBlocks(uint nbAllocatedMemoryBlocks);
+
     public :
 
         // -------------------- Methods -------------------- //
 
         /// Constructor
-        DefaultPoolAllocator();
+        DefaultPoolAllocator(MemoryAllocator& baseAllocator);
 
         /// Destructor
         virtual ~DefaultPoolAllocator() override;
@@ -140,8 +157,20 @@ class DefaultPoolAllocator : public MemoryAllocator {
 
         /// Release previously allocated memory.
         virtual void release(void* pointer, size_t size) override;
+
+        /// Release the memory blocks that only contain free memory units
+        virtual size_t trim() override;
+
+        /// Return the number of memory blocks that have been allocated
+        uint getNbMemoryBlocks() const;
 };
 
+// Return the number of memory blocks that have been allocated
+/// Each memory block has a size of BLOCK_SIZE bytes
+inline uint DefaultPoolAllocator::getNbMemoryBlocks() const {
+    return mNbCurrentMemoryBlocks;
+}
+
 }
 
 #endif
@@ -25,112 +25,195 @@
 
 // Libraries
 #include "DefaultSingleFrameAllocator.h"
-#include "MemoryManager.h"
 #include <cstdlib>
 #include <cassert>
 
 using namespace reactphysics3d;
 
 // Constructor
-DefaultSingleFrameAllocator::DefaultSingleFrameAllocator()
-    : mBaseMemoryAllocator(&MemoryManager::getBaseAllocator()),
-      mTotalSizeBytes(INIT_SINGLE_FRAME_ALLOCATOR_NB_BYTES),
-      mCurrentOffset(0), mNbFramesTooMuchAllocated(0), mNeedToAllocatedMore(false) {
-
-    // Allocate a whole block of memory at the beginning
-    mMemoryBufferStart = static_cast<char*>(mBaseMemoryAllocator->allocate(mTotalSizeBytes));
-    assert(mMemoryBufferStart != nullptr);
+DefaultSingleFrameAllocator::DefaultSingleFrameAllocator(MemoryAllocator& baseAllocator)
+    : mBaseMemoryAllocator(&baseAllocator), mTotalSizeBytes(0), mNbChunks(0),
+      mFirstChunk(nullptr), mLastChunk(nullptr), mCurrentOffset(0), mNbAllocatedBytes(0),
+      mNbUsedChunks(1), mMaxNbUsedChunks(0), mNbFramesTooMuchAllocated(0),
+      mNbOverflowAllocations(0), mNbOverflowBytes(0) {
+
+    // Allocate a first memory chunk at the beginning
+    mCurrentChunk = allocateChunk(INIT_SINGLE_FRAME_ALLOCATOR_NB_BYTES);
 }
 
 // Destructor
 DefaultSingleFrameAllocator::~DefaultSingleFrameAllocator() {
 
-    // Release the memory allocated at the beginning
-    mBaseMemoryAllocator->release(mMemoryBufferStart, mTotalSizeBytes);
+    // Release all the memory chunks
+    MemoryChunk* chunk = mFirstChunk;
+    while (chunk != nullptr) {
+        MemoryChunk* nextChunk = chunk->nextChunk;
+        mBaseMemoryAllocator->release(chunk, CHUNK_HEADER_SIZE + chunk->sizeBytes);
+        chunk = nextChunk;
+    }
+}
+
+// Allocate a new memory chunk at the end of the linked-list of chunks
+DefaultSingleFrameAllocator::MemoryChunk* DefaultSingleFrameAllocator::allocateChunk(size_t sizeBytes) {
+
+    static_assert(sizeof(MemoryChunk) <= CHUNK_HEADER_SIZE, "The header of a memory chunk is too large");
+
+    MemoryChunk* chunk = static_cast<MemoryChunk*>(mBaseMemoryAllocator->allocate(CHUNK_HEADER_SIZE + sizeBytes));
+    assert(chunk != nullptr);
+    chunk->nextChunk = nullptr;
+    chunk->sizeBytes = sizeBytes;
+    chunk->index = mNbChunks;
+
+    // Add the chunk at the end of the linked-list
+    if (mLastChunk != nullptr) {
+        mLastChunk->nextChunk = chunk;
+    }
+    else {
+        mFirstChunk = chunk;
+    }
+    mLastChunk = chunk;
+
+    mNbChunks++;
+    mTotalSizeBytes += sizeBytes;
+
+    return chunk;
 }
 
+// Find a memory chunk after the current one with enough memory for an allocation
+/// The chunks kept from the previous frames are used first. If none of them is
+/// large enough, a new chunk is allocated.
+DefaultSingleFrameAllocator::MemoryChunk* DefaultSingleFrameAllocator::findNextChunk(size_t size) {
+
+    // The chunks are ordered by increasing size
+    MemoryChunk* chunk = mCurrentChunk->nextChunk;
+    while (chunk != nullptr && chunk->sizeBytes < size) {
+        chunk = chunk->nextChunk;
+    }
+
+    if (chunk == nullptr) {
+
+        mNbOverflowAllocations++;
+        mNbOverflowBytes += size;
+
+        // Allocate a new chunk at least as large as all the previous ones together
+        // so that the number of chunks stays small
+        chunk = allocateChunk(size > mTotalSizeBytes ? size : mTotalSizeBytes);
+    }
+
+    return chunk;
+}
 
 // Allocate memory of a given size (in bytes) and return a pointer to the
 // allocated memory.
 void* DefaultSingleFrameAllocator::allocate(size_t size) {
 
-    // Check that there is enough remaining memory in the buffer
-    if (mCurrentOffset + size > mTotalSizeBytes) {
+    // If there is not enough remaining memory in the current chunk
+    if (mCurrentOffset + size > mCurrentChunk->sizeBytes) {
 
-        // We need to allocate more memory next time reset() is called
-        mNeedToAllocatedMore = true;
+        // Move to the next chunk with enough memory
+        mCurrentChunk = findNextChunk(size);
+        mCurrentOffset = 0;
 
-        // Return default memory allocation
-        return mBaseMemoryAllocator->allocate(size);
+        if (mCurrentChunk->index + 1 > mNbUsedChunks) {
+            mNbUsedChunks = mCurrentChunk->index + 1;
+        }
     }
 
     // Next available memory location
-    void* nextAvailableMemory = mMemoryBufferStart + mCurrentOffset;
+    void* nextAvailableMemory = mCurrentChunk->getMemory(mCurrentOffset);
 
     // Increment the offset
     mCurrentOffset += size;
+    mNbAllocatedBytes += size;
 
     // Return the next available memory location
     return nextAvailableMemory;
 }
 
-// Release previously allocated memory.
-void DefaultSingleFrameAllocator::release(void* pointer, size_t size) {
+// Release all the memory allocated since a given marker
+void DefaultSingleFrameAllocator::rollback(const Marker& marker) {
 
-    // If allocated memory is not within the single frame allocation range
-    char* p = static_cast<char*>(pointer);
-    if (p < mMemoryBufferStart || p > mMemoryBufferStart + mTotalSizeBytes) {
+    assert(marker.chunk != nullptr);
+    assert(marker.nbAllocatedBytes <= mNbAllocatedBytes);
 
-        // Use default deallocation
-        mBaseMemoryAllocator->release(pointer, size);
-    }
+    mCurrentChunk = static_cast<MemoryChunk*>(marker.chunk);
+    mCurrentOffset = marker.offset;
+    mNbAllocatedBytes = marker.nbAllocatedBytes;
 }
 
-// Reset the marker of the current allocated memory
-void DefaultSingleFrameAllocator::reset() {
+// Release the memory chunks after a given number of chunks
+/// This method returns the number of bytes that have been released
+size_t DefaultSingleFrameAllocator::releaseChunks(uint nbChunksToKeep) {
 
-    // If too much memory is allocated
-    if (mCurrentOffset < mTotalSizeBytes / 2) {
+    assert(nbChunksToKeep > 0);
 
-        mNbFramesTooMuchAllocated++;
+    MemoryChunk* lastKeptChunk = mFirstChunk;
+    while (lastKeptChunk->index + 1 < nbChunksToKeep) {
+        lastKeptChunk = lastKeptChunk->nextChunk;
+    }
 
-        if (mNbFramesTooMuchAllocated > NB_FRAMES_UNTIL_SHRINK) {
+    size_t nbReleasedBytes = 0;
+    MemoryChunk* chunk = lastKeptChunk->nextChunk;
+    while (chunk != nullptr) {
+        MemoryChunk* nextChunk = chunk->nextChunk;
+        mTotalSizeBytes -= chunk->sizeBytes;
+        mNbChunks--;
+        nbReleasedBytes += CHUNK_HEADER_SIZE + chunk->sizeBytes;
+        mBaseMemoryAllocator->release(chunk, CHUNK_HEADER_SIZE + chunk->sizeBytes);
+        chunk = nextChunk;
+    }
+    lastKeptChunk->nextChunk = nullptr;
+    mLastChunk = lastKeptChunk;
 
-            // Release the memory allocated at the beginning
-            mBaseMemoryAllocator->release(mMemoryBufferStart, mTotalSizeBytes);
+    return nbReleasedBytes;
+}
 
-            // Divide the total memory to allocate by two
-            mTotalSizeBytes /= 2;
-            if (mTotalSizeBytes == 0) mTotalSizeBytes = 1;
+// Release the memory chunks that have not been used during the last frames
+/// The chunks used during the current frame are always kept. The chunks used since
+/// the last frame that needed all the chunks are also kept. This method returns the
+/// number of bytes that have been released.
+size_t DefaultSingleFrameAllocator::trim() {
 
-            // Allocate a whole block of memory at the beginning
-            mMemoryBufferStart = static_cast<char*>(mBaseMemoryAllocator->allocate(mTotalSizeBytes));
-            assert(mMemoryBufferStart != nullptr);
+    // If the last frame has used all the chunks, we keep them
+    if (mNbFramesTooMuchAllocated == 0) return 0;
 
-            mNbFramesTooMuchAllocated = 0;
-        }
-    }
-    else {
+    const uint nbChunksToKeep = mNbUsedChunks > mMaxNbUsedChunks ? mNbUsedChunks : mMaxNbUsedChunks;
+    const size_t nbReleasedBytes = releaseChunks(nbChunksToKeep);
+
+    if (nbReleasedBytes > 0) {
         mNbFramesTooMuchAllocated = 0;
+        mMaxNbUsedChunks = 0;
     }
 
-    // If we need to allocate more memory
-    if (mNeedToAllocatedMore) {
+    return nbReleasedBytes;
+}
+
+// Reset the marker of the current allocated memory
+void DefaultSingleFrameAllocator::reset() {
 
-        // Release the memory allocated at the beginning
-        mBaseMemoryAllocator->release(mMemoryBufferStart, mTotalSizeBytes);
+    // If some chunks have not been used during this frame
+    if (mNbUsedChunks < mNbChunks) {
 
-        // Multiply the total memory to allocate by two
-        mTotalSizeBytes *= 2;
+        mNbFramesTooMuchAllocated++;
+        if (mNbUsedChunks > mMaxNbUsedChunks) mMaxNbUsedChunks = mNbUsedChunks;
 
-        // Allocate a whole block of memory at the beginning
-        mMemoryBufferStart = static_cast<char*>(mBaseMemoryAllocator->allocate(mTotalSizeBytes));
-        assert(mMemoryBufferStart != nullptr);
+        if (mNbFramesTooMuchAllocated > NB_FRAMES_UNTIL_SHRINK) {
 
-        mNeedToAllocatedMore = false;
+            // Release the chunks that have not been used during the last frames
+            releaseChunks(mMaxNbUsedChunks);
+
+            mNbFramesTooMuchAllocated = 0;
+            mMaxNbUsedChunks = 0;
+        }
+    }
+    else {
         mNbFramesTooMuchAllocated = 0;
+        mMaxNbUsedChunks = 0;
     }
 
-    // Reset the current offset at the beginning of the block
+    // Go back to the beginning of the first chunk
+    mCurrentChunk = mFirstChunk;
     mCurrentOffset = 0;
+    mNbAllocatedBytes = 0;
+    mNbUsedChunks = 1;
 }
@@ -36,7 +36,14 @@ namespace reactphysics3d {
 // Class DefaultSingleFrameAllocator
 /**
  * This class represent a memory allocator used to efficiently allocate
- * memory on the heap that is used during a single frame.
+ * memory on the heap that is used during a single frame. The memory is
+ * made of a linked-list of memory chunks. When there is not enough remaining
+ * memory in the chunks to handle an allocation request, a new chunk (at least
+ * as large as all the previous ones together) is allocated with the base allocator
+ * and added at the end of the list. The chunks are kept across frames and the
+ * chunks that have not been used during a large number of frames are released.
+ * The allocator can be rolled back to a marker to release all the memory allocated
+ * since that marker (see the SingleFrameAllocatorScope class).
  */
 class DefaultSingleFrameAllocator : public SingleFrameAllocator {
 
@@ -44,45 +51,110 @@ class DefaultSingleFrameAllocator : public SingleFrameAllocator {
 
         // -------------------- Constants -------------------- //
 
-        /// Number of frames to wait before shrinking the allocated
-        /// memory if too much is allocated
+        /// Number of frames to wait before releasing the memory
+        /// chunks that are not used
         static const int NB_FRAMES_UNTIL_SHRINK = 120;
 
         /// Initial size (in bytes) of the single frame allocator
         static const size_t INIT_SINGLE_FRAME_ALLOCATOR_NB_BYTES = 1048576; // 1Mb
 
+        /// Size (in bytes) of the header at the beginning of each memory chunk
+        static const size_t CHUNK_HEADER_SIZE = 32;
+
+        // -------------------- Internal Classes -------------------- //
+
+        // Structure MemoryChunk
+        /**
+         * Header at the beginning of a memory chunk. The memory used for
+         * the allocations follows the header.
+         */
+        struct MemoryChunk {
+
+            public :
+
+                /// Pointer to the next memory chunk
+                MemoryChunk* nextChunk;
+
+                /// Size (in bytes) of the memory of the chunk (without the header)
+                size_t sizeBytes;
+
+                /// Index of the chunk in the linked-list of chunks
+                uint index;
+
+                /// Return a pointer to the memory of the chunk at a given offset
+                char* getMemory(size_t offset) {
+                    return reinterpret_cast<char*>(this) + CHUNK_HEADER_SIZE + offset;
+                }
+        };
+
         // -------------------- Attributes -------------------- //
-		/// Cached memory allocator used on construction
-		MemoryAllocator* mBaseMemoryAllocator;
 
-        /// Total size (in bytes) of memory of the allocator
+        /// Base memory allocator used to allocate the memory chunks
+        MemoryAllocator* mBaseMemoryAllocator;
+
+        /// Total size (in bytes) of memory of the chunks
         size_t mTotalSizeBytes;
 
-        /// Pointer to the beginning of the allocated memory block
-        char* mMemoryBufferStart;
+        /// Number of memory chunks
+        uint mNbChunks;
+
+        /// Pointer to the first memory chunk
+        MemoryChunk* mFirstChunk;
+
+        /// Pointer to the last memory chunk
+        MemoryChunk* mLastChunk;
+
+        /// Memory chunk used for the next allocations
+        MemoryChunk* mCurrentChunk;
 
-        /// Pointer to the next available memory location in the buffer
+        /// Offset of the next available memory location in the current chunk
         size_t mCurrentOffset;
 
-        /// Current number of frames since we detected too much memory
-        /// is allocated
+        /// Number of bytes allocated since the last reset
+        size_t mNbAllocatedBytes;
+
+        /// Number of chunks used since the last reset
+        uint mNbUsedChunks;
+
+        /// Maximum number of chunks used in a frame since we detected that
+        /// some chunks are not used
+        uint mMaxNbUsedChunks;
+
+        /// Current number of frames since we detected that some chunks are not used
         size_t mNbFramesTooMuchAllocated;
 
-        /// True if we need to allocate more memory in the next reset() call
-        bool mNeedToAllocatedMore;
+        /// Total number of allocations that did not fit into the memory chunks
+        uint64 mNbOverflowAllocations;
+
+        /// Total number of bytes of the allocations that did not fit into the memory chunks
+        uint64 mNbOverflowBytes;
+
+        // -------------------- Methods -------------------- //
+
+        /// Allocate a new memory chunk at the end of the linked-list of chunks
+        MemoryChunk* allocateChunk(size_t sizeBytes);
+
+        /// Find a memory chunk after the current one with enough memory for an allocation
+        MemoryChunk* findNextChunk(size_t size);
+
+        /// Release the memory chunks after a given number of chunks
+        size_t releaseChunks(uint nbChunksToKeep);
 
     public :
 
         // -------------------- Methods -------------------- //
 
         /// Constructor
-        DefaultSingleFrameAllocator();
+        DefaultSingleFrameAllocator(MemoryAllocator& baseAllocator);
 
         /// Destructor
         virtual ~DefaultSingleFrameAllocator() override;
 
-        /// Assignment operator
-        DefaultSingleFrameAllocator& operator=(DefaultSingleFrameAllocator& allocator) = default;
+        /// Deleted copy-constructor
+        DefaultSingleFrameAllocator(const DefaultSingleFrameAllocator& allocator) = delete;
+
+        /// Deleted assignment operator
+        DefaultSingleFrameAllocator& operator=(const DefaultSingleFrameAllocator& allocator) = delete;
 
         /// Allocate memory of a given size (in bytes)
         virtual void* allocate(size_t size) override;
@@ -92,8 +164,69 @@ class DefaultSingleFrameAllocator : public SingleFrameAllocator {
 
         /// Reset the marker of the current allocated memory
         virtual void reset() override;
+
+        /// Release the memory chunks that have not been used during the last frames
+        virtual size_t trim() override;
+
+        /// Return true if the allocator can be rolled back to a marker
+        virtual bool isRollbackSupported() const override;
+
+        /// Return a marker of the current position of the allocator
+        virtual Marker getMarker() const override;
+
+        /// Release all the memory allocated since a given marker
+        virtual void rollback(const Marker& marker) override;
+
+        /// Return the number of memory chunks
+        uint getNbChunks() const;
+
+        /// Return the total size (in bytes) of the memory chunks
+        size_t getTotalSizeBytes() const;
+
+        /// Return the total number of allocations that did not fit into the memory chunks
+        uint64 getNbOverflowAllocations() const;
+
+        /// Return the total number of bytes of the allocations that did not fit into the memory chunks
+        uint64 getNbOverflowBytes() const;
 };
 
+// Release previously allocated memory.
+/// The memory is only released when the allocator is reset or rolled back
+inline void DefaultSingleFrameAllocator::release(void* pointer, size_t size) {
+
+}
+
+// Return true if the allocator can be rolled back to a marker
+inline bool DefaultSingleFrameAllocator::isRollbackSupported() const {
+    return true;
+}
+
+// Return a marker of the current position of the allocator
+inline SingleFrameAllocator::Marker DefaultSingleFrameAllocator::getMarker() const {
+    return Marker{mCurrentChunk, mCurrentOffset, mNbAllocatedBytes};
+}
+
+// Return the number of memory chunks
+inline uint DefaultSingleFrameAllocator::getNbChunks() const {
+    return mNbChunks;
+}
+
+// Return the total size (in bytes) of the memory chunks
+inline size_t DefaultSingleFrameAllocator::getTotalSizeBytes() const {
+    return mTotalSizeBytes;
+}
+
+// Return the total number of allocations that did not fit into the memory chunks
+/// A new memory chunk has been allocated for each of those allocations
+inline uint64 DefaultSingleFrameAllocator::getNbOverflowAllocations() const {
+    return mNbOverflowAllocations;
+}
+
+// Return the total number of bytes of the allocations that did not fit into the memory chunks
+inline uint64 DefaultSingleFrameAllocator::getNbOverflowBytes() const {
+    return mNbOverflowBytes;
+}
+
 }
 
 #endif
@@ -0,0 +1,127 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "HugePageAllocator.h"
+#include <cstdlib>
+#include <cstdint>
+#include <cassert>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #define RP3D_HUGE_PAGES_SUPPORTED
+#endif
+
+using namespace reactphysics3d;
+
+// Constructor
+HugePageAllocator::HugePageAllocator(size_t minHugePageAllocationSize)
+                  : mMinHugePageAllocationSize(minHugePageAllocationSize), mNbMappedBytes(0),
+                    mNbHugePageAllocations(0) {
+
+    assert(mMinHugePageAllocationSize > 0);
+}
+
+// Return true if huge pages can be used on this platform
+bool HugePageAllocator::isHugePageSupported() {
+
+#ifdef RP3D_HUGE_PAGES_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Allocate memory of a given size (in bytes) and return a pointer to the
+// allocated memory.
+void* HugePageAllocator::allocate(size_t size) {
+
+#ifdef RP3D_HUGE_PAGES_SUPPORTED
+
+    // If the allocation is large enough to use huge pages
+    if (size >= mMinHugePageAllocationSize) {
+
+        const size_t mappingSize = getMappingSize(size);
+
+        // Map more memory than necessary so that we can align the mapping on the huge page size
+        const size_t alignedMappingSize = mappingSize + HUGE_PAGE_SIZE;
+        void* mapping = mmap(nullptr, alignedMappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) return nullptr;
+
+        // Unmap the memory before and after the aligned part of the mapping
+        const uintptr_t mappingStart = reinterpret_cast<uintptr_t>(mapping);
+        const uintptr_t alignedStart = (mappingStart + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        const size_t headSize = alignedStart - mappingStart;
+        const size_t tailSize = alignedMappingSize - headSize - mappingSize;
+        if (headSize > 0) munmap(mapping, headSize);
+        if (tailSize > 0) munmap(reinterpret_cast<void*>(alignedStart + mappingSize), tailSize);
+
+        void* pointer = reinterpret_cast<void*>(alignedStart);
+
+#ifdef MADV_HUGEPAGE
+        // Ask the kernel to back the mapping with transparent huge pages. This is
+        // only an advice and the allocation is still valid if it fails.
+        madvise(pointer, mappingSize, MADV_HUGEPAGE);
+#endif
+
+        mNbMappedBytes.fetch_add(mappingSize, std::memory_order_relaxed);
+        mNbHugePageAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        return pointer;
+    }
+
+#endif
+
+    return malloc(size);
+}
+
+// Release previously allocated memory.
+/// The size must be the same as the size used to allocate the memory because
+/// it is used to know how the memory has been allocated.
+void HugePageAllocator::release(void* pointer, size_t size) {
+
+#ifdef RP3D_HUGE_PAGES_SUPPORTED
+
+    // If the memory has been allocated with huge pages
+    if (size >= mMinHugePageAllocationSize) {
+
+        if (pointer == nullptr) return;
+
+        assert(reinterpret_cast<uintptr_t>(pointer) % HUGE_PAGE_SIZE == 0);
+
+        const size_t mappingSize = getMappingSize(size);
+        munmap(pointer, mappingSize);
+
+        assert(mNbMappedBytes.load(std::memory_order_relaxed) >= mappingSize);
+        mNbMappedBytes.fetch_sub(mappingSize, std::memory_order_relaxed);
+        mNbHugePageAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+        return;
+    }
+
+#endif
+
+    free(pointer);
+}
@@ -0,0 +1,138 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_HUGE_PAGE_ALLOCATOR_H
+#define REACTPHYSICS3D_HUGE_PAGE_ALLOCATOR_H
+
+// Libraries
+#include "configuration.h"
+#include "MemoryAllocator.h"
+#include <atomic>
+
+/// ReactPhysics3D namespace
+namespace reactphysics3d {
+
+// Class HugePageAllocator
+/**
+ * This class is a base memory allocator that backs the large allocations (the nodes of
+ * the dynamic AABB trees, the buffer of potential pairs of the broad-phase, the chunks of
+ * the single frame allocator, ...) with transparent huge pages to reduce the number of TLB
+ * misses in large worlds. A large allocation is made with an anonymous memory mapping
+ * aligned on the huge page size and the kernel is advised to use huge pages for it
+ * (madvise() with MADV_HUGEPAGE). The smaller allocations use malloc/free. This allocator
+ * is only effective on Linux. On other platforms, all the allocations use malloc/free.
+ * It can be selected with the MemoryManager::setBaseAllocator() method or given to a
+ * world using the WorldSettings. This allocator is thread-safe.
+ */
+class HugePageAllocator : public MemoryAllocator {
+
+    public :
+
+        // -------------------- Constants -------------------- //
+
+        /// Size (in bytes) of a huge page
+        static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;   // 2Mb
+
+        /// Default minimum size (in bytes) of an allocation backed by huge pages
+        static const size_t DEFAULT_MIN_HUGE_PAGE_ALLOCATION_SIZE = HUGE_PAGE_SIZE / 2;
+
+    private :
+
+        // -------------------- Attributes -------------------- //
+
+        /// Minimum size (in bytes) of an allocation backed by huge pages
+        const size_t mMinHugePageAllocationSize;
+
+        /// Total number of bytes currently mapped for the large allocations
+        std::atomic<size_t> mNbMappedBytes;
+
+        /// Number of large allocations currently backed by huge pages
+        std::atomic<uint> mNbHugePageAllocations;
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the size (in bytes) of the memory mapping of a large allocation
+        static size_t getMappingSize(size_t size);
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        HugePageAllocator(size_t minHugePageAllocationSize = DEFAULT_MIN_HUGE_PAGE_ALLOCATION_SIZE);
+
+        /// Destructor
+        virtual ~HugePageAllocator() override = default;
+
+        /// Deleted copy-constructor
+        HugePageAllocator(const HugePageAllocator& allocator) = delete;
+
+        /// Deleted assignment operator
+        HugePageAllocator& operator=(const HugePageAllocator& allocator) = delete;
+
+        /// Allocate memory of a given size (in bytes) and return a pointer to the
+        /// allocated memory.
+        virtual void* allocate(size_t size) override;
+
+        /// Release previously allocated memory.
+        virtual void release(void* pointer, size_t size) override;
+
+        /// Return true if huge pages can be used on this platform
+        static bool isHugePageSupported();
+
+        /// Return the minimum size (in bytes) of an allocation backed by huge pages
+        size_t getMinHugePageAllocationSize() const;
+
+        /// Return the total number of bytes currently mapped for the large allocations
+        size_t getNbMappedBytes() const;
+
+        /// Return the number of large allocations currently backed by huge pages
+        uint getNbHugePageAllocations() const;
+};
+
+// Return the size (in bytes) of the memory mapping of a large allocation
+/// The size is rounded up to a multiple of the huge page size
+inline size_t HugePageAllocator::getMappingSize(size_t size) {
+    return (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+// Return the minimum size (in bytes) of an allocation backed by huge pages
+inline size_t HugePageAllocator::getMinHugePageAllocationSize() const {
+    return mMinHugePageAllocationSize;
+}
+
+// Return the total number of bytes currently mapped for the large allocations
+inline size_t HugePageAllocator::getNbMappedBytes() const {
+    return mNbMappedBytes.load(std::memory_order_relaxed);
+}
+
+// Return the number of large allocations currently backed by huge pages
+inline uint HugePageAllocator::getNbHugePageAllocations() const {
+    return mNbHugePageAllocations.load(std::memory_order_relaxed);
+}
+
+}
+
+#endif
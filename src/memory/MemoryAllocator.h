@@ -28,6 +28,7 @@
 
 // Libraries
 #include <cstring>
+#include <cassert>
 
 /// ReactPhysics3D namespace
 namespace reactphysics3d {
@@ -55,6 +56,9 @@ class MemoryAllocator {
 
         /// Release previously allocated memory.
         virtual void release(void* pointer, size_t size)=0;
+
+        /// Return the unused memory of the allocator to its base allocator
+        virtual size_t trim();
 };
 
 /**
@@ -64,6 +68,23 @@ class SingleFrameAllocator : public MemoryAllocator{
 	
     public:
 
+        // Structure Marker
+        /**
+         * Position in the memory of a single frame allocator. All the memory allocated
+         * after a marker can be released at once by rolling back the allocator to it.
+         */
+        struct Marker {
+
+            /// Memory chunk of the allocator that contains the position
+            void* chunk;
+
+            /// Offset (in bytes) of the position in the memory chunk
+            size_t offset;
+
+            /// Number of bytes allocated since the last reset of the allocator
+            size_t nbAllocatedBytes;
+        };
+
         /// Constructor
         SingleFrameAllocator() = default;
 
@@ -82,8 +103,92 @@ class SingleFrameAllocator : public MemoryAllocator{
 		
         /// Reset the marker of the current allocated memory
         virtual void reset()=0;
+
+        /// Return true if the allocator can be rolled back to a marker
+        virtual bool isRollbackSupported() const;
+
+        /// Return a marker of the current position of the allocator
+        virtual Marker getMarker() const;
+
+        /// Release all the memory allocated since a given marker
+        virtual void rollback(const Marker& marker);
+};
+
+// Class SingleFrameAllocatorScope
+/**
+ * This class sets a marker in a single frame allocator when it is created and rolls
+ * the allocator back to this marker when it is destroyed. Therefore, all the memory
+ * allocated in the single frame allocator during the lifetime of the scope is released
+ * at the end of the scope. Scopes can be nested. This allows one-shot queries to use the
+ * single frame allocator outside of the update of a world. Nothing happens if the
+ * allocator does not support rollback.
+ */
+class SingleFrameAllocatorScope {
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        /// Single frame allocator
+        SingleFrameAllocator& mAllocator;
+
+        /// Marker of the allocator at the beginning of the scope
+        SingleFrameAllocator::Marker mMarker;
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        SingleFrameAllocatorScope(SingleFrameAllocator& allocator)
+            : mAllocator(allocator), mMarker(allocator.getMarker()) {
+
+        }
+
+        /// Destructor
+        ~SingleFrameAllocatorScope() {
+            if (mAllocator.isRollbackSupported()) {
+                mAllocator.rollback(mMarker);
+            }
+        }
+
+        /// Deleted copy-constructor
+        SingleFrameAllocatorScope(const SingleFrameAllocatorScope& scope) = delete;
+
+        /// Deleted assignment operator
+        SingleFrameAllocatorScope& operator=(const SingleFrameAllocatorScope& scope) = delete;
 };
 
+// Return the unused memory of the allocator to its base allocator
+/// This method returns the number of bytes that have been released. By default,
+/// an allocator does not keep any unused memory and nothing is released.
+inline size_t MemoryAllocator::trim() {
+    return 0;
+}
+
+// Return true if the allocator can be rolled back to a marker
+/// By default, a single frame allocator only releases its memory when it is reset
+inline bool SingleFrameAllocator::isRollbackSupported() const {
+    return false;
+}
+
+// Return a marker of the current position of the allocator
+inline SingleFrameAllocator::Marker SingleFrameAllocator::getMarker() const {
+    return Marker{nullptr, 0, 0};
+}
+
+// Release all the memory allocated since a given marker
+/// The marker must have been created after the last call to reset(). The markers
+/// created after the given one cannot be used anymore. This method must only be called
+/// if isRollbackSupported() returns true.
+inline void SingleFrameAllocator::rollback(const Marker& marker) {
+
+    (void) marker;
+
+    // The allocators that support rollback must override this method
+    assert(false);
+}
+
 }
 
 #endif
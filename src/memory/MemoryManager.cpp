@@ -30,9 +30,83 @@ using namespace reactphysics3d;
 
 // Static variables
 DefaultAllocator MemoryManager::mDefaultAllocator;
-DefaultSingleFrameAllocator MemoryManager::mDefaultSingleFrameAllocator;
-DefaultPoolAllocator MemoryManager::mDefaultPoolAllocator;
-MemoryAllocator* MemoryManager::mBaseAllocator = &mDefaultAllocator;
-MemoryAllocator* MemoryManager::mPoolAllocator = &mDefaultPoolAllocator;
-SingleFrameAllocator* MemoryManager::mSingleFrameAllocator = &mDefaultSingleFrameAllocator;
+MemoryAllocator* MemoryManager::mGlobalBaseAllocator = &mDefaultAllocator;
 
+// Constructor
+/**
+ * @param baseAllocator Base memory allocator of this memory manager (the global
+ *                      base allocator is used if it is null)
+ * @param poolAllocator Pool memory allocator (a default pool allocator is used if it is null)
+ * @param singleFrameAllocator Single frame memory allocator (a default single frame
+ *                             allocator is used if it is null)
+ */
+MemoryManager::MemoryManager(MemoryAllocator* baseAllocator, MemoryAllocator* poolAllocator,
+                             SingleFrameAllocator* singleFrameAllocator)
+              : mBaseAllocator(baseAllocator != nullptr ? baseAllocator : mGlobalBaseAllocator),
+                mDefaultSingleFrameAllocator(*mBaseAllocator), mDefaultPoolAllocator(*mBaseAllocator),
+                mSingleFrameAllocator(singleFrameAllocator != nullptr ? singleFrameAllocator : &mDefaultSingleFrameAllocator),
+                mPoolAllocator(poolAllocator != nullptr ? poolAllocator : &mDefaultPoolAllocator),
+                mFrameMarkersStatistics(*mBaseAllocator) {
+
+    // Initialize the tagged allocators that are given to the other classes of the library
+    for (int i=0; i < NB_ALLOCATION_TAGS; i++) {
+        mTaggedPoolAllocators[i].init(this, AllocationType::Pool, static_cast<AllocationTag>(i));
+        mTaggedFrameAllocators[i].init(this, AllocationType::Frame, static_cast<AllocationTag>(i));
+    }
+}
+
+// Update the statistics with the allocations counted by a worker pool allocator
+/// The maximum number of live bytes is updated with the largest number of live bytes
+/// reached by the worker pool allocator since its last merge.
+void MemoryManager::addWorkerStatistics(AllocationTag allocationTag, uint64 nbAllocations, uint64 nbReleases,
+                                        int64 nbLiveBytesDelta, int64 maxNbLiveBytesDelta) {
+
+    AllocationStatistics* statistics[2] = {&mStatistics[static_cast<int>(AllocationType::Pool)],
+                                           &mTagStatistics[static_cast<int>(AllocationType::Pool)][static_cast<int>(allocationTag)]};
+
+    for (int i=0; i < 2; i++) {
+
+        statistics[i]->nbAllocations += nbAllocations;
+        statistics[i]->nbReleases += nbReleases;
+
+        const size_t maxNbLiveBytes = statistics[i]->nbLiveBytes + static_cast<size_t>(maxNbLiveBytesDelta);
+        if (maxNbLiveBytes > statistics[i]->maxNbLiveBytes) statistics[i]->maxNbLiveBytes = maxNbLiveBytes;
+
+        assert(static_cast<int64>(statistics[i]->nbLiveBytes) + nbLiveBytesDelta >= 0);
+        statistics[i]->nbLiveBytes = static_cast<size_t>(static_cast<int64>(statistics[i]->nbLiveBytes) + nbLiveBytesDelta);
+    }
+}
+
+// Constructor
+/**
+ * @param memoryManager Memory manager of the world whose base allocator is used for the
+ *                      memory blocks and whose statistics are updated by mergeStatistics()
+ * @param allocationTag Tag of the allocations in the statistics
+ */
+MemoryManager::WorkerPoolAllocator::WorkerPoolAllocator(MemoryManager& memoryManager, AllocationTag allocationTag)
+              : mMemoryManager(memoryManager), mAllocationTag(allocationTag),
+                mPoolAllocator(*memoryManager.mBaseAllocator), mNbAllocations(0), mNbReleases(0),
+                mNbLiveBytesDelta(0), mMaxNbLiveBytesDelta(0) {
+
+}
+
+// Destructor
+MemoryManager::WorkerPoolAllocator::~WorkerPoolAllocator() {
+
+    // The last releases must be counted in the statistics
+    mergeStatistics();
+}
+
+// Add the allocations counted since the last merge into the statistics of the memory manager
+void MemoryManager::WorkerPoolAllocator::mergeStatistics() {
+
+    if (mNbAllocations == 0 && mNbReleases == 0) return;
+
+    mMemoryManager.addWorkerStatistics(mAllocationTag, mNbAllocations, mNbReleases,
+                                       mNbLiveBytesDelta, mMaxNbLiveBytesDelta);
+
+    mNbAllocations = 0;
+    mNbReleases = 0;
+    mNbLiveBytesDelta = 0;
+    mMaxNbLiveBytesDelta = 0;
+}
@@ -31,6 +31,9 @@
 #include "memory/DefaultPoolAllocator.h"
 #include "memory/MemoryAllocator.h"
 #include "memory/DefaultSingleFrameAllocator.h"
+#include "containers/List.h"
+#include <cassert>
+#include <algorithm>
 
 /// Namespace ReactPhysics3D
 namespace reactphysics3d {
@@ -38,78 +41,323 @@ namespace reactphysics3d {
 // Declarations
 class MemoryAllocator;
 
+// Structure AllocationStatistics
+/**
+ * This structure contains statistics about the memory that has been allocated
+ * by a memory manager with a given allocation type (and tag).
+ */
+struct AllocationStatistics {
+
+    /// Number of allocation requests
+    uint64 nbAllocations = 0;
+
+    /// Number of release requests
+    uint64 nbReleases = 0;
+
+    /// Number of bytes currently allocated. For the single frame allocator, this is
+    /// the number of bytes allocated since the beginning of the current frame.
+    size_t nbLiveBytes = 0;
+
+    /// Maximum number of bytes that have been allocated at the same time
+    size_t maxNbLiveBytes = 0;
+};
+
 // Class MemoryManager
 /**
  * The memory manager is used to store the different memory allocators that are used
- * by the library.
+ * by the library. The base memory allocator is global and is used for the objects that
+ * can be shared between several worlds (collision shapes, meshes, ...). Each world owns
+ * its own memory manager with its own pool and single frame allocators. Therefore, two
+ * different worlds can be updated at the same time on two different threads.
  */
 class MemoryManager {
 
+    public:
+
+        /// Memory allocation types
+       enum class AllocationType {
+           Base, 	// Base memory allocator
+           Pool,	// Memory pool allocator
+           Frame,   // Single frame memory allocator
+       };
+
+       /// Memory allocation tags used to know which part of the library has allocated memory
+       enum class AllocationTag {
+           Default,             // Allocations that are not attributed to a given part
+           Bodies,              // Bodies and proxy shapes
+           BroadPhase,          // Broad-phase tree, moved shapes and potential pairs
+           OverlappingPairs,    // Overlapping pairs
+           ContactManifolds,    // Contact manifolds, contact points and last frame collision infos
+           NarrowPhase,         // Narrow-phase infos
+           Islands,             // Islands
+           Solver,              // Contact solver and constrained velocities/positions
+           Joints,              // Joints
+       };
+
+       /// Number of allocation types
+       static const int NB_ALLOCATION_TYPES = 3;
+
+       /// Number of allocation tags
+       static const int NB_ALLOCATION_TAGS = 9;
+
+       // Class WorkerPoolAllocator
+       /**
+        * Pool allocator used by a worker thread that helps to update a world. Its memory
+        * blocks are allocated with the base allocator of the memory manager of the world
+        * (that must therefore be thread-safe). The allocator is only used by one thread at
+        * a time and it counts its allocations without any synchronization. Those counts
+        * are added into the statistics of the memory manager (as pool allocations with
+        * the tag of the allocator) by mergeStatistics() that must be called by the thread
+        * that updates the world while the worker thread is not using the allocator.
+        */
+       class WorkerPoolAllocator : public MemoryAllocator {
+
+           private:
+
+               /// Reference to the memory manager
+               MemoryManager& mMemoryManager;
+
+               /// Allocation tag
+               AllocationTag mAllocationTag;
+
+               /// Pool allocator of the worker thread
+               DefaultPoolAllocator mPoolAllocator;
+
+               /// Number of allocation requests since the last merge of the statistics
+               uint64 mNbAllocations;
+
+               /// Number of release requests since the last merge of the statistics
+               uint64 mNbReleases;
+
+               /// Variation of the number of live bytes since the last merge of the statistics
+               int64 mNbLiveBytesDelta;
+
+               /// Maximum variation of the number of live bytes since the last merge of the statistics
+               int64 mMaxNbLiveBytesDelta;
+
+           public:
+
+               /// Constructor
+               WorkerPoolAllocator(MemoryManager& memoryManager, AllocationTag allocationTag);
+
+               /// Destructor
+               virtual ~WorkerPoolAllocator() override;
+
+               /// Deleted copy-constructor
+               WorkerPoolAllocator(const WorkerPoolAllocator& allocator) = delete;
+
+               /// Deleted assignment operator
+               WorkerPoolAllocator& operator=(const WorkerPoolAllocator& allocator) = delete;
+
+               /// Allocate memory of a given size (in bytes)
+               virtual void* allocate(size_t size) override;
+
+               /// Release previously allocated memory.
+               virtual void release(void* pointer, size_t size) override;
+
+               /// Return the unused memory blocks of the pool to the base allocator
+               virtual size_t trim() override;
+
+               /// Add the allocations counted since the last merge into the statistics of the memory manager
+               void mergeStatistics();
+       };
+
     private:
-		
+
+       // Class TaggedAllocator
+       /**
+        * Allocator given to the other classes of the library instead of the pool and
+        * single frame allocators. It forwards the allocation requests to the memory
+        * manager with a given allocation type and tag so that they are counted in
+        * the allocation statistics.
+        */
+       class TaggedAllocator : public SingleFrameAllocator {
+
+           private:
+
+               /// Pointer to the memory manager
+               MemoryManager* mMemoryManager;
+
+               /// Allocation type
+               AllocationType mAllocationType;
+
+               /// Allocation tag
+               AllocationTag mAllocationTag;
+
+           public:
+
+               /// Constructor
+               TaggedAllocator() : mMemoryManager(nullptr), mAllocationType(AllocationType::Pool),
+                                   mAllocationTag(AllocationTag::Default) {}
+
+               /// Initialize the allocator
+               void init(MemoryManager* memoryManager, AllocationType allocationType, AllocationTag allocationTag);
+
+               /// Allocate memory of a given size (in bytes)
+               virtual void* allocate(size_t size) override;
+
+               /// Release previously allocated memory.
+               virtual void release(void* pointer, size_t size) override;
+
+               /// Reset the single frame allocator (only for the Frame allocation type)
+               virtual void reset() override;
+
+               /// Return true if the single frame allocator can be rolled back (only for the Frame allocation type)
+               virtual bool isRollbackSupported() const override;
+
+               /// Return a marker of the single frame allocator (only for the Frame allocation type)
+               virtual Marker getMarker() const override;
+
+               /// Rollback the single frame allocator to a marker (only for the Frame allocation type)
+               virtual void rollback(const Marker& marker) override;
+       };
+
+       // Structure FrameMarkerStatistics
+       /**
+        * Number of live bytes of the single frame allocator for each tag at the position
+        * of a marker. It is used to restore the statistics of all the tags when the
+        * single frame allocator is rolled back to this marker.
+        */
+       struct FrameMarkerStatistics {
+
+           /// Number of bytes allocated by the single frame allocator at the position of the marker
+           size_t nbAllocatedBytes;
+
+           /// Number of live bytes of the single frame allocator
+           size_t nbLiveBytes;
+
+           /// Number of live bytes of the single frame allocator for each tag
+           size_t nbTagLiveBytes[NB_ALLOCATION_TAGS];
+       };
+
        /// Default malloc/free memory allocator
        static DefaultAllocator mDefaultAllocator;
+
+       /// Pointer to the global base memory allocator
+       static MemoryAllocator* mGlobalBaseAllocator;
+
+       /// Pointer to the base memory allocator used by this memory manager
+       MemoryAllocator* mBaseAllocator;
 	   
        /// Default single frame memory allocator
-       static DefaultSingleFrameAllocator mDefaultSingleFrameAllocator;
+       DefaultSingleFrameAllocator mDefaultSingleFrameAllocator;
 
        /// Default pool memory allocator
-       static DefaultPoolAllocator mDefaultPoolAllocator;
-
-       /// Pointer to the base memory allocator to use
-       static MemoryAllocator* mBaseAllocator;
+       DefaultPoolAllocator mDefaultPoolAllocator;
 
        /// Single frame stack allocator
-       static SingleFrameAllocator* mSingleFrameAllocator;
+       SingleFrameAllocator* mSingleFrameAllocator;
 
        /// Memory pool allocator
-       static MemoryAllocator* mPoolAllocator;
+       MemoryAllocator* mPoolAllocator;
 
-    public:
+       /// Tagged pool allocators given to the other classes of the library (one per tag)
+       TaggedAllocator mTaggedPoolAllocators[NB_ALLOCATION_TAGS];
 
-        /// Memory allocation types
-       enum class AllocationType {
-           Base, 	// Base memory allocator
-           Pool,	// Memory pool allocator
-           Frame,   // Single frame memory allocator
-       };
+       /// Tagged single frame allocators given to the other classes of the library (one per tag)
+       TaggedAllocator mTaggedFrameAllocators[NB_ALLOCATION_TAGS];
+
+       /// Allocation statistics for each allocation type
+       AllocationStatistics mStatistics[NB_ALLOCATION_TYPES];
+
+       /// Allocation statistics for each allocation type and tag
+       AllocationStatistics mTagStatistics[NB_ALLOCATION_TYPES][NB_ALLOCATION_TAGS];
+
+       /// Frame statistics at the position of the markers of the single frame allocator
+       /// (sorted by position)
+       mutable List<FrameMarkerStatistics> mFrameMarkersStatistics;
+
+       // -------------------- Methods -------------------- //
+
+       /// Update the statistics after an allocation
+       void addAllocationStatistics(AllocationType allocationType, AllocationTag allocationTag, size_t size);
+
+       /// Update the statistics after a release
+       void addReleaseStatistics(AllocationType allocationType, AllocationTag allocationTag, size_t size);
+
+       /// Update the statistics with the allocations counted by a worker pool allocator
+       void addWorkerStatistics(AllocationTag allocationTag, uint64 nbAllocations, uint64 nbReleases,
+                                int64 nbLiveBytesDelta, int64 maxNbLiveBytesDelta);
+
+    public:
 
        /// Constructor
-       MemoryManager() = default;
+       MemoryManager(MemoryAllocator* baseAllocator = nullptr, MemoryAllocator* poolAllocator = nullptr,
+                     SingleFrameAllocator* singleFrameAllocator = nullptr);
 
        /// Destructor
        ~MemoryManager() = default;
 
+       /// Deleted copy-constructor
+       MemoryManager(const MemoryManager& memoryManager) = delete;
+
+       /// Deleted assignment operator
+       MemoryManager& operator=(const MemoryManager& memoryManager) = delete;
+
         /// Allocate memory of a given type
-        void* allocate(AllocationType allocationType, size_t size);
+        void* allocate(AllocationType allocationType, size_t size,
+                       AllocationTag allocationTag = AllocationTag::Default);
 
         /// Release previously allocated memory.
-        void release(AllocationType allocationType, void* pointer, size_t size);
+        void release(AllocationType allocationType, void* pointer, size_t size,
+                     AllocationTag allocationTag = AllocationTag::Default);
 
         /// Return the pool allocator
-        MemoryAllocator& getPoolAllocator();
+        MemoryAllocator& getPoolAllocator(AllocationTag allocationTag = AllocationTag::Default);
 
         /// Return the single frame stack allocator
-        SingleFrameAllocator& getSingleFrameAllocator();
+        SingleFrameAllocator& getSingleFrameAllocator(AllocationTag allocationTag = AllocationTag::Default);
 
-        /// Return the base memory allocator
+        /// Return the global base memory allocator
         static MemoryAllocator& getBaseAllocator();
 		
-        /// Set the base memory allocator
+        /// Set the global base memory allocator
         static void setBaseAllocator(MemoryAllocator* memoryAllocator);
 
         /// Set the single frame memory allocator
-        static void setSingleFrameAllocator(SingleFrameAllocator* singleFrameAllocator);
+        void setSingleFrameAllocator(SingleFrameAllocator* singleFrameAllocator);
 
         /// Set the pool memory allocator
-        static void setPoolAllocator(MemoryAllocator* poolAllocator);
+        void setPoolAllocator(MemoryAllocator* poolAllocator);
 
         /// Reset the single frame allocator
         void resetFrameAllocator();
+
+        /// Return the unused memory of the pool and single frame allocators to their base allocator
+        size_t trim();
+
+        /// Return a marker of the current position of the single frame allocator
+        SingleFrameAllocator::Marker getFrameAllocatorMarker() const;
+
+        /// Release all the memory allocated with the single frame allocator since a given marker
+        void rollbackFrameAllocator(const SingleFrameAllocator::Marker& marker);
+
+        /// Return the allocation statistics of a given allocation type
+        const AllocationStatistics& getAllocationStatistics(AllocationType allocationType) const;
+
+        /// Return the allocation statistics of a given allocation type and tag
+        const AllocationStatistics& getAllocationStatistics(AllocationType allocationType,
+                                                            AllocationTag allocationTag) const;
+
+        /// Return the number of memory blocks allocated by the default pool allocator
+        uint getNbPoolMemoryBlocks() const;
+
+        /// Return the number of memory chunks of the default single frame allocator
+        uint getNbFrameAllocatorChunks() const;
+
+        /// Return the number of allocations that did not fit into the chunks of the default single frame allocator
+        uint64 getNbFrameAllocatorOverflows() const;
+
+        /// Return the number of bytes of the allocations that did not fit into the chunks of the default single frame allocator
+        uint64 getNbFrameAllocatorOverflowBytes() const;
 };
 
 // Allocate memory of a given type
-inline void* MemoryManager::allocate(AllocationType allocationType, size_t size) {
+/// The allocation tag is only used to know which part of the library has allocated the memory
+/// in the statistics. The same tag must be used to release the memory.
+inline void* MemoryManager::allocate(AllocationType allocationType, size_t size, AllocationTag allocationTag) {
+
+    addAllocationStatistics(allocationType, allocationTag, size);
 
     switch (allocationType) {
        case AllocationType::Base: return mBaseAllocator->allocate(size);
@@ -121,7 +369,9 @@ inline void* MemoryManager::allocate(AllocationType allocationType, size_t size)
 }
 
 // Release previously allocated memory.
-inline void MemoryManager::release(AllocationType allocationType, void* pointer, size_t size) {
+inline void MemoryManager::release(AllocationType allocationType, void* pointer, size_t size, AllocationTag allocationTag) {
+
+    addReleaseStatistics(allocationType, allocationTag, size);
 
     switch (allocationType) {
        case AllocationType::Base: mBaseAllocator->release(pointer, size); break;
@@ -130,39 +380,258 @@ inline void MemoryManager::release(AllocationType allocationType, void* pointer,
     }
 }
 
+// Update the statistics after an allocation
+inline void MemoryManager::addAllocationStatistics(AllocationType allocationType, AllocationTag allocationTag, size_t size) {
+
+    AllocationStatistics& statistics = mStatistics[static_cast<int>(allocationType)];
+    statistics.nbAllocations++;
+    statistics.nbLiveBytes += size;
+    if (statistics.nbLiveBytes > statistics.maxNbLiveBytes) statistics.maxNbLiveBytes = statistics.nbLiveBytes;
+
+    AllocationStatistics& tagStatistics = mTagStatistics[static_cast<int>(allocationType)][static_cast<int>(allocationTag)];
+    tagStatistics.nbAllocations++;
+    tagStatistics.nbLiveBytes += size;
+    if (tagStatistics.nbLiveBytes > tagStatistics.maxNbLiveBytes) tagStatistics.maxNbLiveBytes = tagStatistics.nbLiveBytes;
+}
+
+// Update the statistics after a release
+inline void MemoryManager::addReleaseStatistics(AllocationType allocationType, AllocationTag allocationTag, size_t size) {
+
+    AllocationStatistics& statistics = mStatistics[static_cast<int>(allocationType)];
+    assert(statistics.nbLiveBytes >= size);
+    statistics.nbReleases++;
+    statistics.nbLiveBytes -= size;
+
+    AllocationStatistics& tagStatistics = mTagStatistics[static_cast<int>(allocationType)][static_cast<int>(allocationTag)];
+    assert(tagStatistics.nbLiveBytes >= size);
+    tagStatistics.nbReleases++;
+    tagStatistics.nbLiveBytes -= size;
+}
+
 // Return the pool allocator
-inline MemoryAllocator& MemoryManager::getPoolAllocator() {
-   return *mPoolAllocator;
+/// The allocations requests made with the returned allocator are counted in the statistics
+/// of the given tag.
+inline MemoryAllocator& MemoryManager::getPoolAllocator(AllocationTag allocationTag) {
+   return mTaggedPoolAllocators[static_cast<int>(allocationTag)];
 }
 
 // Return the single frame stack allocator
-inline SingleFrameAllocator& MemoryManager::getSingleFrameAllocator() {
-   return *mSingleFrameAllocator;
+/// The allocations requests made with the returned allocator are counted in the statistics
+/// of the given tag.
+inline SingleFrameAllocator& MemoryManager::getSingleFrameAllocator(AllocationTag allocationTag) {
+   return mTaggedFrameAllocators[static_cast<int>(allocationTag)];
 }
 
-// Return the base memory allocator
+// Return the global base memory allocator
 inline MemoryAllocator& MemoryManager::getBaseAllocator() {
-    return *mBaseAllocator;
+    return *mGlobalBaseAllocator;
 }
 
-// Set the base memory allocator
+// Set the global base memory allocator
+/// This allocator is used by the objects that are not owned by a given world
+/// (collision shapes, meshes, ...) and by the worlds that do not provide their
+/// own base allocator. It should be set before any world is created.
 inline void MemoryManager::setBaseAllocator(MemoryAllocator* baseAllocator) {
-    mBaseAllocator = baseAllocator;
+    mGlobalBaseAllocator = baseAllocator;
 }
 
-// Set the base memory allocator
+// Set the single frame memory allocator
+/// This method must be called before any memory has been allocated with
+/// the single frame allocator of this memory manager.
 inline void MemoryManager::setSingleFrameAllocator(SingleFrameAllocator* singleFrameAllocator) {
     mSingleFrameAllocator = singleFrameAllocator;
 }
 
 // Set the pool memory allocator
+/// This method must be called before any memory has been allocated with
+/// the pool allocator of this memory manager.
 inline void MemoryManager::setPoolAllocator(MemoryAllocator* poolAllocator) {
     mPoolAllocator = poolAllocator;
 }
 
 // Reset the single frame allocator
 inline void MemoryManager::resetFrameAllocator() {
+
    mSingleFrameAllocator->reset();
+
+   // The memory of the single frame allocator is not used anymore
+   const int frameIndex = static_cast<int>(AllocationType::Frame);
+   mStatistics[frameIndex].nbLiveBytes = 0;
+   for (int i=0; i < NB_ALLOCATION_TAGS; i++) {
+       mTagStatistics[frameIndex][i].nbLiveBytes = 0;
+   }
+
+   // The markers cannot be used anymore
+   mFrameMarkersStatistics.clear();
+}
+
+// Return the unused memory of the pool and single frame allocators to their base allocator
+/// This method returns the number of bytes that have been released
+inline size_t MemoryManager::trim() {
+   return mPoolAllocator->trim() + mSingleFrameAllocator->trim();
+}
+
+// Return a marker of the current position of the single frame allocator
+/// The frame statistics of each tag are saved with the marker in order to restore
+/// them when the single frame allocator is rolled back to it.
+inline SingleFrameAllocator::Marker MemoryManager::getFrameAllocatorMarker() const {
+
+   const SingleFrameAllocator::Marker marker = mSingleFrameAllocator->getMarker();
+
+   if (mSingleFrameAllocator->isRollbackSupported()) {
+
+       const int frameIndex = static_cast<int>(AllocationType::Frame);
+       FrameMarkerStatistics markerStatistics;
+       markerStatistics.nbAllocatedBytes = marker.nbAllocatedBytes;
+       markerStatistics.nbLiveBytes = mStatistics[frameIndex].nbLiveBytes;
+       for (int i=0; i < NB_ALLOCATION_TAGS; i++) {
+           markerStatistics.nbTagLiveBytes[i] = mTagStatistics[frameIndex][i].nbLiveBytes;
+       }
+
+       // A marker at the same position as the last one replaces it
+       const uint nbMarkers = static_cast<uint>(mFrameMarkersStatistics.size());
+       assert(nbMarkers == 0 || mFrameMarkersStatistics[nbMarkers - 1].nbAllocatedBytes <= marker.nbAllocatedBytes);
+       if (nbMarkers > 0 && mFrameMarkersStatistics[nbMarkers - 1].nbAllocatedBytes == marker.nbAllocatedBytes) {
+           mFrameMarkersStatistics[nbMarkers - 1] = markerStatistics;
+       }
+       else {
+           mFrameMarkersStatistics.add(markerStatistics);
+       }
+   }
+
+   return marker;
+}
+
+// Release all the memory allocated with the single frame allocator since a given marker
+/// The live bytes of each tag in the frame statistics are restored to their value when
+/// the marker was created. Nothing is released if the single frame allocator does not
+/// support rollback.
+inline void MemoryManager::rollbackFrameAllocator(const SingleFrameAllocator::Marker& marker) {
+
+   if (!mSingleFrameAllocator->isRollbackSupported()) return;
+
+   mSingleFrameAllocator->rollback(marker);
+
+   // The markers created after the given one cannot be used anymore
+   while (mFrameMarkersStatistics.size() > 0 &&
+          mFrameMarkersStatistics[static_cast<uint>(mFrameMarkersStatistics.size()) - 1].nbAllocatedBytes > marker.nbAllocatedBytes) {
+       mFrameMarkersStatistics.removeAt(static_cast<uint>(mFrameMarkersStatistics.size()) - 1);
+   }
+
+   // The marker must have been created by this memory manager
+   assert(mFrameMarkersStatistics.size() > 0);
+   const FrameMarkerStatistics& markerStatistics = mFrameMarkersStatistics[static_cast<uint>(mFrameMarkersStatistics.size()) - 1];
+   assert(markerStatistics.nbAllocatedBytes == marker.nbAllocatedBytes);
+
+   // Some of the bytes allocated before the marker might have been removed from the
+   // statistics by a call to release() after the marker
+   const int frameIndex = static_cast<int>(AllocationType::Frame);
+   AllocationStatistics& statistics = mStatistics[frameIndex];
+   statistics.nbLiveBytes = std::min(statistics.nbLiveBytes, markerStatistics.nbLiveBytes);
+   for (int i=0; i < NB_ALLOCATION_TAGS; i++) {
+       AllocationStatistics& tagStatistics = mTagStatistics[frameIndex][i];
+       tagStatistics.nbLiveBytes = std::min(tagStatistics.nbLiveBytes, markerStatistics.nbTagLiveBytes[i]);
+   }
+}
+
+// Return the allocation statistics of a given allocation type
+inline const AllocationStatistics& MemoryManager::getAllocationStatistics(AllocationType allocationType) const {
+    return mStatistics[static_cast<int>(allocationType)];
+}
+
+// Return the allocation statistics of a given allocation type and tag
+inline const AllocationStatistics& MemoryManager::getAllocationStatistics(AllocationType allocationType,
+                                                                          AllocationTag allocationTag) const {
+    return mTagStatistics[static_cast<int>(allocationType)][static_cast<int>(allocationTag)];
+}
+
+// Return the number of memory blocks allocated by the default pool allocator
+/// This is always zero if a custom pool allocator is used.
+inline uint MemoryManager::getNbPoolMemoryBlocks() const {
+    return mDefaultPoolAllocator.getNbMemoryBlocks();
+}
+
+// Return the number of memory chunks of the default single frame allocator
+inline uint MemoryManager::getNbFrameAllocatorChunks() const {
+    return mDefaultSingleFrameAllocator.getNbChunks();
+}
+
+// Return the number of allocations that did not fit into the chunks of the default single frame allocator
+/// A new memory chunk has been allocated for each of those allocations. This is always
+/// zero if a custom single frame allocator is used.
+inline uint64 MemoryManager::getNbFrameAllocatorOverflows() const {
+    return mDefaultSingleFrameAllocator.getNbOverflowAllocations();
+}
+
+// Return the number of bytes of the allocations that did not fit into the chunks of the default single frame allocator
+/// This is always zero if a custom single frame allocator is used.
+inline uint64 MemoryManager::getNbFrameAllocatorOverflowBytes() const {
+    return mDefaultSingleFrameAllocator.getNbOverflowBytes();
+}
+
+// Initialize the allocator
+inline void MemoryManager::TaggedAllocator::init(MemoryManager* memoryManager, AllocationType allocationType,
+                                                 AllocationTag allocationTag) {
+    mMemoryManager = memoryManager;
+    mAllocationType = allocationType;
+    mAllocationTag = allocationTag;
+}
+
+// Allocate memory of a given size (in bytes)
+inline void* MemoryManager::TaggedAllocator::allocate(size_t size) {
+    return mMemoryManager->allocate(mAllocationType, size, mAllocationTag);
+}
+
+// Release previously allocated memory.
+inline void MemoryManager::TaggedAllocator::release(void* pointer, size_t size) {
+    mMemoryManager->release(mAllocationType, pointer, size, mAllocationTag);
+}
+
+// Reset the single frame allocator (only for the Frame allocation type)
+inline void MemoryManager::TaggedAllocator::reset() {
+    assert(mAllocationType == AllocationType::Frame);
+    mMemoryManager->resetFrameAllocator();
+}
+
+// Return true if the single frame allocator can be rolled back (only for the Frame allocation type)
+inline bool MemoryManager::TaggedAllocator::isRollbackSupported() const {
+    return mAllocationType == AllocationType::Frame && mMemoryManager->mSingleFrameAllocator->isRollbackSupported();
+}
+
+// Return a marker of the single frame allocator (only for the Frame allocation type)
+inline SingleFrameAllocator::Marker MemoryManager::TaggedAllocator::getMarker() const {
+    assert(mAllocationType == AllocationType::Frame);
+    return mMemoryManager->getFrameAllocatorMarker();
+}
+
+// Rollback the single frame allocator to a marker (only for the Frame allocation type)
+inline void MemoryManager::TaggedAllocator::rollback(const Marker& marker) {
+    assert(mAllocationType == AllocationType::Frame);
+    mMemoryManager->rollbackFrameAllocator(marker);
+}
+
+// Allocate memory of a given size (in bytes)
+inline void* MemoryManager::WorkerPoolAllocator::allocate(size_t size) {
+
+    mNbAllocations++;
+    mNbLiveBytesDelta += static_cast<int64>(size);
+    mMaxNbLiveBytesDelta = std::max(mMaxNbLiveBytesDelta, mNbLiveBytesDelta);
+
+    return mPoolAllocator.allocate(size);
+}
+
+// Release previously allocated memory.
+inline void MemoryManager::WorkerPoolAllocator::release(void* pointer, size_t size) {
+
+    mNbReleases++;
+    mNbLiveBytesDelta -= static_cast<int64>(size);
+
+    mPoolAllocator.release(pointer, size);
+}
+
+// Return the unused memory blocks of the pool to the base allocator
+inline size_t MemoryManager::WorkerPoolAllocator::trim() {
+    return mPoolAllocator.trim();
 }
 
 }
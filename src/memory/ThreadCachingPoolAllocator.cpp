@@ -0,0 +1,486 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "ThreadCachingPoolAllocator.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+using namespace reactphysics3d;
+
+// Initialization of static variables
+bool ThreadCachingPoolAllocator::mIsThreadCacheIndexUsed[MAX_NB_THREAD_CACHES] = {};
+std::mutex ThreadCachingPoolAllocator::mThreadCacheIndicesMutex;
+
+// Constructor of the thread cache slot
+ThreadCachingPoolAllocator::ThreadCacheSlot::ThreadCacheSlot() : index(MAX_NB_THREAD_CACHES) {
+
+    std::lock_guard<std::mutex> lock(mThreadCacheIndicesMutex);
+
+    // Find a thread cache index that is not used by another thread
+    for (uint i=0; i < MAX_NB_THREAD_CACHES; i++) {
+        if (!mIsThreadCacheIndexUsed[i]) {
+            mIsThreadCacheIndexUsed[i] = true;
+            index = i;
+            break;
+        }
+    }
+}
+
+// Destructor of the thread cache slot
+ThreadCachingPoolAllocator::ThreadCacheSlot::~ThreadCacheSlot() {
+
+    // Release the thread cache index so that it can be used by another thread. The
+    // memory units that are still in the caches with this index will be used by this
+    // other thread.
+    if (index < MAX_NB_THREAD_CACHES) {
+        std::lock_guard<std::mutex> lock(mThreadCacheIndicesMutex);
+        mIsThreadCacheIndexUsed[index] = false;
+    }
+}
+
+// Constructor
+ThreadCachingPoolAllocator::ThreadCachingPoolAllocator(MemoryAllocator& baseAllocator)
+                           : mBaseAllocator(baseAllocator), mMemoryBlocks(nullptr) {
+
+    static_assert(sizeof(MemoryBlock) <= BLOCK_HEADER_SIZE, "The header of a memory block is too large");
+
+    // Allocate the caches of the threads
+    const size_t sizeToAllocate = MAX_NB_THREAD_CACHES * sizeof(ThreadCache);
+    mThreadCaches = static_cast<ThreadCache*>(mBaseAllocator.allocate(sizeToAllocate));
+    memset(mThreadCaches, 0, sizeToAllocate);
+    memset(&mSharedCache, 0, sizeof(ThreadCache));
+
+    for (int i=0; i < NB_HEAPS; i++) {
+        mDepots[i].store(0);
+    }
+
+#ifndef NDEBUG
+        mNbTimesAllocateMethodCalled = 0;
+#endif
+}
+
+// Destructor
+ThreadCachingPoolAllocator::~ThreadCachingPoolAllocator() {
+
+    // Release the memory allocated for each block
+    MemoryBlock* block = mMemoryBlocks.load();
+    while (block != nullptr) {
+        MemoryBlock* nextBlock = block->nextBlock;
+        mBaseAllocator.release(block, BLOCK_SIZE);
+        block = nextBlock;
+    }
+
+    mBaseAllocator.release(mThreadCaches, MAX_NB_THREAD_CACHES * sizeof(ThreadCache));
+
+#ifndef NDEBUG
+        // Check that the allocate() and release() methods have been called the same
+        // number of times to avoid memory leaks.
+        assert(mNbTimesAllocateMethodCalled == 0);
+#endif
+}
+
+// Return the index of the thread cache of the calling thread
+uint ThreadCachingPoolAllocator::getThreadCacheIndex() {
+
+    // The index is acquired the first time the thread calls this method and
+    // is released when the thread exits
+    static thread_local ThreadCacheSlot threadCacheSlot;
+
+    return threadCacheSlot.index;
+}
+
+// Allocate memory of a given size (in bytes) and return a pointer to the
+// allocated memory.
+void* ThreadCachingPoolAllocator::allocate(size_t size) {
+
+    // We cannot allocate zero bytes
+    if (size == 0) return nullptr;
+
+#ifndef NDEBUG
+        mNbTimesAllocateMethodCalled++;
+#endif
+
+    // If we need to allocate more than the maximum memory unit size
+    if (size > MAX_UNIT_SIZE) {
+
+        // Allocate memory using the base allocator
+        return mBaseAllocator.allocate(size);
+    }
+
+    const int indexHeap = getHeapIndex(size);
+
+    // If the calling thread has its own cache
+    const uint threadCacheIndex = getThreadCacheIndex();
+    if (threadCacheIndex < MAX_NB_THREAD_CACHES) {
+        return allocateFromCache(mThreadCaches[threadCacheIndex], indexHeap);
+    }
+
+    // Otherwise, we use the shared cache
+    std::lock_guard<std::mutex> lock(mSharedCacheMutex);
+    return allocateFromCache(mSharedCache, indexHeap);
+}
+
+// Release previously allocated memory.
+void ThreadCachingPoolAllocator::release(void* pointer, size_t size) {
+
+    // Cannot release a 0-byte allocated memory
+    if (size == 0) return;
+
+#ifndef NDEBUG
+        mNbTimesAllocateMethodCalled--;
+#endif
+
+    // If the size is larger than the maximum memory unit size
+    if (size > MAX_UNIT_SIZE) {
+
+        // Release the memory using the base allocator
+        mBaseAllocator.release(pointer, size);
+        return;
+    }
+
+    const int indexHeap = getHeapIndex(size);
+
+    // If the calling thread has its own cache
+    const uint threadCacheIndex = getThreadCacheIndex();
+    if (threadCacheIndex < MAX_NB_THREAD_CACHES) {
+        releaseIntoCache(mThreadCaches[threadCacheIndex], indexHeap, pointer);
+        return;
+    }
+
+    // Otherwise, we use the shared cache
+    std::lock_guard<std::mutex> lock(mSharedCacheMutex);
+    releaseIntoCache(mSharedCache, indexHeap, pointer);
+}
+
+// Allocate a memory unit of a given heap using a thread cache
+void* ThreadCachingPoolAllocator::allocateFromCache(ThreadCache& cache, int indexHeap) {
+
+    // If there is no more free memory units in the cache
+    if (cache.freeUnits[indexHeap] == nullptr) {
+        refillCache(cache, indexHeap);
+    }
+
+    // Return a pointer to the first free memory unit of the cache
+    MemoryUnit* unit = cache.freeUnits[indexHeap];
+    assert(unit != nullptr);
+    cache.freeUnits[indexHeap] = unit->nextUnit;
+    cache.nbFreeUnits[indexHeap]--;
+
+    return unit;
+}
+
+// Release a memory unit of a given heap into a thread cache
+void ThreadCachingPoolAllocator::releaseIntoCache(ThreadCache& cache, int indexHeap, void* pointer) {
+
+    // Insert the released memory unit into the cache
+    MemoryUnit* releasedUnit = static_cast<MemoryUnit*>(pointer);
+    releasedUnit->nextUnit = cache.freeUnits[indexHeap];
+    cache.freeUnits[indexHeap] = releasedUnit;
+    cache.nbFreeUnits[indexHeap]++;
+
+    // If the cache contains too many free memory units, we give a batch
+    // back to the depot so that other threads can use it
+    const uint batchSize = getBatchSize(indexHeap);
+    if (cache.nbFreeUnits[indexHeap] >= 2 * batchSize) {
+
+        MemoryUnit* firstUnit = cache.freeUnits[indexHeap];
+        MemoryUnit* lastUnit = firstUnit;
+        for (uint i=1; i < batchSize; i++) {
+            lastUnit = lastUnit->nextUnit;
+        }
+
+        cache.freeUnits[indexHeap] = lastUnit->nextUnit;
+        cache.nbFreeUnits[indexHeap] -= batchSize;
+        lastUnit->nextUnit = nullptr;
+
+        pushBatch(indexHeap, firstUnit);
+    }
+}
+
+// Fill the empty cache of a given heap with a batch of the depot or with a new memory block
+void ThreadCachingPoolAllocator::refillCache(ThreadCache& cache, int indexHeap) {
+
+    assert(cache.freeUnits[indexHeap] == nullptr);
+    assert(cache.nbFreeUnits[indexHeap] == 0);
+
+    const uint batchSize = getBatchSize(indexHeap);
+
+    // If there is a batch of free memory units in the depot
+    MemoryUnit* batch = popBatch(indexHeap);
+    if (batch != nullptr) {
+
+        // Use the batch as the new cache
+        cache.freeUnits[indexHeap] = batch;
+        cache.nbFreeUnits[indexHeap] = batchSize;
+
+        return;
+    }
+
+    // Allocate a new memory block and add it into the list of blocks
+    void* blockMemory = mBaseAllocator.allocate(BLOCK_SIZE);
+    assert(blockMemory != nullptr);
+    MemoryBlock* newBlock = static_cast<MemoryBlock*>(blockMemory);
+    newBlock->indexHeap = indexHeap;
+    newBlock->nextBlock = mMemoryBlocks.load(std::memory_order_relaxed);
+    while (!mMemoryBlocks.compare_exchange_weak(newBlock->nextBlock, newBlock, std::memory_order_release,
+                                                std::memory_order_relaxed));
+
+    // Divide the block into memory units
+    const size_t unitSize = getUnitSize(indexHeap);
+    const uint nbUnits = static_cast<uint>((BLOCK_SIZE - BLOCK_HEADER_SIZE) / unitSize);
+    assert(nbUnits >= 2 * batchSize);
+    char* memoryUnitsStart = static_cast<char*>(blockMemory) + BLOCK_HEADER_SIZE;
+    for (uint i=0; i < nbUnits; i++) {
+        MemoryUnit* unit = reinterpret_cast<MemoryUnit*>(memoryUnitsStart + unitSize * i);
+        unit->nextUnit = (i + 1 < nbUnits) ? reinterpret_cast<MemoryUnit*>(memoryUnitsStart + unitSize * (i+1)) : nullptr;
+    }
+
+    // Give all the full batches except the first one to the depot and keep the
+    // remaining memory units in the cache of the thread
+    uint nbUnitsInCache = nbUnits;
+    MemoryUnit* firstUnit = reinterpret_cast<MemoryUnit*>(memoryUnitsStart);
+    while (nbUnitsInCache >= 2 * batchSize) {
+
+        MemoryUnit* lastUnit = reinterpret_cast<MemoryUnit*>(reinterpret_cast<char*>(firstUnit) + unitSize * (batchSize - 1));
+        MemoryUnit* nextFirstUnit = lastUnit->nextUnit;
+        lastUnit->nextUnit = nullptr;
+        pushBatch(indexHeap, firstUnit);
+
+        firstUnit = nextFirstUnit;
+        nbUnitsInCache -= batchSize;
+    }
+
+    cache.freeUnits[indexHeap] = firstUnit;
+    cache.nbFreeUnits[indexHeap] = nbUnitsInCache;
+}
+
+// Push a batch of free memory units into the depot of a given heap
+void ThreadCachingPoolAllocator::pushBatch(int indexHeap, MemoryUnit* firstUnit) {
+
+    uint64_t oldHead = mDepots[indexHeap].load(std::memory_order_relaxed);
+    uint64_t newHead;
+    do {
+        firstUnit->nextBatch = getDepotHeadUnit(oldHead);
+        newHead = packDepotHead(firstUnit, getDepotHeadTag(oldHead) + 1);
+    }
+    while (!mDepots[indexHeap].compare_exchange_weak(oldHead, newHead, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+}
+
+// Pop a batch of free memory units from the depot of a given heap
+ThreadCachingPoolAllocator::MemoryUnit* ThreadCachingPoolAllocator::popBatch(int indexHeap) {
+
+    uint64_t oldHead = mDepots[indexHeap].load(std::memory_order_acquire);
+    MemoryUnit* firstUnit;
+    uint64_t newHead;
+    do {
+        firstUnit = getDepotHeadUnit(oldHead);
+        if (firstUnit == nullptr) return nullptr;
+
+        // The memory of the batch is never returned to the base allocator while the allocator
+        // is alive. Therefore, reading the next batch is safe even if another thread pops
+        // this batch concurrently. In this case, the tag of the head will have changed and
+        // the compare-and-swap operation will fail.
+        newHead = packDepotHead(firstUnit->nextBatch, getDepotHeadTag(oldHead) + 1);
+    }
+    while (!mDepots[indexHeap].compare_exchange_weak(oldHead, newHead, std::memory_order_acquire,
+                                                     std::memory_order_acquire));
+
+    return firstUnit;
+}
+
+// Return the index of the memory block of a memory unit in an array of blocks sorted by address
+uint ThreadCachingPoolAllocator::findMemoryBlock(MemoryBlock* const* blocks, uint nbBlocks, const MemoryUnit* unit) {
+
+    const char* unitAddress = reinterpret_cast<const char*>(unit);
+
+    // Binary search of the last block that starts before the memory unit
+    uint min = 0;
+    uint max = nbBlocks;
+    while (max - min > 1) {
+        const uint middle = (min + max) / 2;
+        if (reinterpret_cast<const char*>(blocks[middle]) <= unitAddress) {
+            min = middle;
+        }
+        else {
+            max = middle;
+        }
+    }
+
+    assert(unitAddress >= reinterpret_cast<const char*>(blocks[min]) + BLOCK_HEADER_SIZE);
+    assert(unitAddress < reinterpret_cast<const char*>(blocks[min]) + BLOCK_SIZE);
+
+    return min;
+}
+
+// Return the memory blocks where all the memory units are free to the base allocator
+/// The free memory units of the depot and of the caches of all the threads are gathered,
+/// the blocks where all the memory units are free are released and the remaining free
+/// memory units are given back to the depot (and to the cache of the calling thread).
+/// This method returns the number of bytes that have been released. It must not be called
+/// while another thread uses the allocator (the other threads can pop a batch of the depot
+/// at any time and they would read the memory of a released block).
+size_t ThreadCachingPoolAllocator::trim() {
+
+    // Gather the memory blocks
+    uint nbBlocks = 0;
+    for (MemoryBlock* block = mMemoryBlocks.load(); block != nullptr; block = block->nextBlock) {
+        nbBlocks++;
+    }
+    if (nbBlocks == 0) return 0;
+
+    MemoryBlock** blocks = static_cast<MemoryBlock**>(mBaseAllocator.allocate(nbBlocks * sizeof(MemoryBlock*)));
+    uint blockIndex = 0;
+    for (MemoryBlock* block = mMemoryBlocks.load(); block != nullptr; block = block->nextBlock) {
+        blocks[blockIndex++] = block;
+    }
+
+    // Sort the memory blocks by address so that we can find the block of a memory unit
+    std::sort(blocks, blocks + nbBlocks);
+
+    // Gather the free memory units of each heap from the depot and from the caches
+    MemoryUnit* freeUnits[NB_HEAPS];
+    for (int i=0; i < NB_HEAPS; i++) {
+
+        freeUnits[i] = nullptr;
+
+        MemoryUnit* batch = getDepotHeadUnit(mDepots[i].load());
+        mDepots[i].store(0);
+        while (batch != nullptr) {
+            MemoryUnit* nextBatch = batch->nextBatch;
+            MemoryUnit* lastUnit = batch;
+            while (lastUnit->nextUnit != nullptr) lastUnit = lastUnit->nextUnit;
+            lastUnit->nextUnit = freeUnits[i];
+            freeUnits[i] = batch;
+            batch = nextBatch;
+        }
+
+        for (uint c=0; c <= MAX_NB_THREAD_CACHES; c++) {
+            ThreadCache& cache = c < MAX_NB_THREAD_CACHES ? mThreadCaches[c] : mSharedCache;
+            if (cache.freeUnits[i] != nullptr) {
+                MemoryUnit* lastUnit = cache.freeUnits[i];
+                while (lastUnit->nextUnit != nullptr) lastUnit = lastUnit->nextUnit;
+                lastUnit->nextUnit = freeUnits[i];
+                freeUnits[i] = cache.freeUnits[i];
+                cache.freeUnits[i] = nullptr;
+                cache.nbFreeUnits[i] = 0;
+            }
+        }
+    }
+
+    // Count the number of free memory units in each block
+    uint* nbFreeUnits = static_cast<uint*>(mBaseAllocator.allocate(nbBlocks * sizeof(uint)));
+    std::memset(nbFreeUnits, 0, nbBlocks * sizeof(uint));
+    for (int i=0; i < NB_HEAPS; i++) {
+        for (MemoryUnit* unit = freeUnits[i]; unit != nullptr; unit = unit->nextUnit) {
+            nbFreeUnits[findMemoryBlock(blocks, nbBlocks, unit)]++;
+        }
+    }
+
+    // Find the blocks where all the memory units are free
+    uint nbFreeBlocks = 0;
+    for (uint b=0; b < nbBlocks; b++) {
+        const uint nbUnits = static_cast<uint>((BLOCK_SIZE - BLOCK_HEADER_SIZE) / getUnitSize(blocks[b]->indexHeap));
+        assert(nbFreeUnits[b] <= nbUnits);
+        if (nbFreeUnits[b] == nbUnits) {
+            nbFreeBlocks++;
+        }
+        else {
+            nbFreeUnits[b] = 0;
+        }
+    }
+
+    size_t nbReleasedBytes = 0;
+
+    if (nbFreeBlocks > 0) {
+
+        // Remove the memory units of the free blocks from the lists of free memory units
+        for (int i=0; i < NB_HEAPS; i++) {
+            MemoryUnit** link = &freeUnits[i];
+            while (*link != nullptr) {
+                if (nbFreeUnits[findMemoryBlock(blocks, nbBlocks, *link)] > 0) {
+                    *link = (*link)->nextUnit;
+                }
+                else {
+                    link = &(*link)->nextUnit;
+                }
+            }
+        }
+
+        // Release the free blocks and rebuild the list of the remaining blocks
+        MemoryBlock* remainingBlocks = nullptr;
+        for (uint b=0; b < nbBlocks; b++) {
+            if (nbFreeUnits[b] > 0) {
+                mBaseAllocator.release(blocks[b], BLOCK_SIZE);
+                nbReleasedBytes += BLOCK_SIZE;
+            }
+            else {
+                blocks[b]->nextBlock = remainingBlocks;
+                remainingBlocks = blocks[b];
+            }
+        }
+        mMemoryBlocks.store(remainingBlocks);
+    }
+
+    mBaseAllocator.release(nbFreeUnits, nbBlocks * sizeof(uint));
+    mBaseAllocator.release(blocks, nbBlocks * sizeof(MemoryBlock*));
+
+    // Give the remaining free memory units back to the depot by batches and keep the
+    // last ones in the cache of the calling thread
+    const uint threadCacheIndex = getThreadCacheIndex();
+    ThreadCache& cache = threadCacheIndex < MAX_NB_THREAD_CACHES ? mThreadCaches[threadCacheIndex] : mSharedCache;
+    for (int i=0; i < NB_HEAPS; i++) {
+
+        const uint batchSize = getBatchSize(i);
+        MemoryUnit* firstUnit = freeUnits[i];
+        while (firstUnit != nullptr) {
+
+            // Find the last memory unit of the batch
+            MemoryUnit* lastUnit = firstUnit;
+            uint nbUnits = 1;
+            while (nbUnits < batchSize && lastUnit->nextUnit != nullptr) {
+                lastUnit = lastUnit->nextUnit;
+                nbUnits++;
+            }
+
+            MemoryUnit* nextFirstUnit = lastUnit->nextUnit;
+
+            if (nbUnits == batchSize) {
+                lastUnit->nextUnit = nullptr;
+                pushBatch(i, firstUnit);
+            }
+            else {
+                cache.freeUnits[i] = firstUnit;
+                cache.nbFreeUnits[i] = nbUnits;
+            }
+
+            firstUnit = nextFirstUnit;
+        }
+    }
+
+    return nbReleasedBytes;
+}
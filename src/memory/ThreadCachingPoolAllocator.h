@@ -0,0 +1,303 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_THREAD_CACHING_POOL_ALLOCATOR_H
+#define REACTPHYSICS3D_THREAD_CACHING_POOL_ALLOCATOR_H
+
+// Libraries
+#include "configuration.h"
+#include "MemoryAllocator.h"
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cassert>
+
+/// ReactPhysics3D namespace
+namespace reactphysics3d {
+
+// Class ThreadCachingPoolAllocator
+/**
+ * This class is a pool allocator that can be used concurrently by several threads.
+ * As the DefaultPoolAllocator, it allows us to allocate small blocks of memory
+ * (smaller or equal to 1024 bytes) efficiently. Each thread has a small cache of
+ * free memory units for each size class. Most allocation and release requests are
+ * handled using the cache of the calling thread only, without any synchronization.
+ * When the cache of a thread is empty (or too large), a whole batch of memory units
+ * is taken from (or given back to) a shared lock-free depot. The base allocator
+ * must be thread-safe because it is called concurrently to allocate new memory blocks
+ * and to handle the allocation requests larger than 1024 bytes.
+ * This allocator can be given to a world using the WorldSettings or to a memory
+ * manager using the MemoryManager::setPoolAllocator() method. Its unused memory blocks
+ * can be returned to the base allocator with trim() while no other thread uses it.
+ */
+class ThreadCachingPoolAllocator : public MemoryAllocator {
+
+    private :
+
+        // -------------------- Constants -------------------- //
+
+        /// Number of heaps
+        static const int NB_HEAPS = 64;
+
+        /// Granularity (in bytes) of the sizes of the memory units of the heaps
+        static const size_t UNIT_SIZE_GRANULARITY = 16;
+
+        /// Maximum memory unit size. An allocation request of a size smaller or equal to
+        /// this size will be handled using the pool allocator. However, for an
+        /// allocation request larger than the maximum unit size, the base allocator
+        /// will be used.
+        static const size_t MAX_UNIT_SIZE = NB_HEAPS * UNIT_SIZE_GRANULARITY;
+
+        /// Size a memory chunk
+        static const size_t BLOCK_SIZE = 16 * MAX_UNIT_SIZE;
+
+        /// Size of the header at the beginning of each memory block
+        static const size_t BLOCK_HEADER_SIZE = 16;
+
+        /// Maximum number of memory units in a batch
+        static const uint MAX_BATCH_SIZE = 32;
+
+        /// Maximum number of threads with their own cache. The threads above that
+        /// number share a single cache protected by a mutex.
+        static const uint MAX_NB_THREAD_CACHES = 64;
+
+        /// Number of bits used to store a pointer in a tagged depot head
+        static const int NB_POINTER_BITS = sizeof(void*) == 8 ? 48 : 32;
+
+        // -------------------- Internal Classes -------------------- //
+
+        // Structure MemoryUnit
+        /**
+         * Represent a memory unit that is used for a single memory allocation
+         * request.
+         */
+        struct MemoryUnit {
+
+            public :
+
+                // -------------------- Attributes -------------------- //
+
+                /// Pointer to the next memory unit of the cache or of the batch
+                MemoryUnit* nextUnit;
+
+                /// Pointer to the next batch in the depot (only used by the first
+                /// memory unit of a batch when the batch is in the depot)
+                MemoryUnit* nextBatch;
+        };
+
+        // Structure MemoryBlock
+        /**
+         * A memory block is a large piece of memory that is allocated once and that
+         * will contain multiple memory units.
+         */
+        struct MemoryBlock {
+
+            public :
+
+                /// Pointer to the next allocated memory block
+                MemoryBlock* nextBlock;
+
+                /// Index of the heap of the memory units of the block
+                int indexHeap;
+        };
+
+        // Structure ThreadCache
+        /**
+         * Cache of free memory units of a given thread for each heap
+         */
+        struct ThreadCache {
+
+            public :
+
+                /// Pointers to the first free memory unit for each heap
+                MemoryUnit* freeUnits[NB_HEAPS];
+
+                /// Number of free memory units for each heap
+                uint nbFreeUnits[NB_HEAPS];
+        };
+
+        // Structure ThreadCacheSlot
+        /**
+         * Index of the thread cache that is used by a given thread. The index
+         * is acquired when the thread uses a thread caching allocator for the
+         * first time and is released when the thread exits.
+         */
+        struct ThreadCacheSlot {
+
+            public :
+
+                /// Index of the thread cache
+                uint index;
+
+                /// Constructor
+                ThreadCacheSlot();
+
+                /// Destructor
+                ~ThreadCacheSlot();
+        };
+
+        // -------------------- Attributes -------------------- //
+
+        /// True if a thread cache index is currently used by a thread
+        static bool mIsThreadCacheIndexUsed[MAX_NB_THREAD_CACHES];
+
+        /// Mutex used to acquire and release the thread cache indices
+        static std::mutex mThreadCacheIndicesMutex;
+
+        /// Base memory allocator used to allocate the memory blocks
+        MemoryAllocator& mBaseAllocator;
+
+        /// Cache of each thread (indexed by thread cache index)
+        ThreadCache* mThreadCaches;
+
+        /// Cache shared by the threads without their own cache
+        ThreadCache mSharedCache;
+
+        /// Mutex used to protect the shared cache
+        std::mutex mSharedCacheMutex;
+
+        /// Lock-free stacks of batches of free memory units for each heap. The pointer to
+        /// the first memory unit of the top batch is stored together with a tag that
+        /// is incremented at each modification to avoid the ABA problem.
+        std::atomic<uint64_t> mDepots[NB_HEAPS];
+
+        /// Lock-free linked-list of all the allocated memory blocks
+        std::atomic<MemoryBlock*> mMemoryBlocks;
+
+#ifndef NDEBUG
+        /// This variable is incremented by one when the allocate() method has been
+        /// called and decreased by one when the release() method has been called.
+        /// This variable is used in debug mode to check that the allocate() and release()
+        /// methods are called the same number of times
+        std::atomic<int> mNbTimesAllocateMethodCalled;
+#endif
+
+        // -------------------- Methods -------------------- //
+
+        /// Return the index of the thread cache of the calling thread
+        static uint getThreadCacheIndex();
+
+        /// Return the index of the heap to use for a given allocation size
+        static int getHeapIndex(size_t size);
+
+        /// Return the size of the memory units of a given heap
+        static size_t getUnitSize(int indexHeap);
+
+        /// Return the number of memory units in a batch of a given heap
+        static uint getBatchSize(int indexHeap);
+
+        /// Return a tagged depot head from a pointer and a tag
+        static uint64_t packDepotHead(MemoryUnit* unit, uint64_t tag);
+
+        /// Return the pointer stored in a tagged depot head
+        static MemoryUnit* getDepotHeadUnit(uint64_t depotHead);
+
+        /// Return the tag stored in a tagged depot head
+        static uint64_t getDepotHeadTag(uint64_t depotHead);
+
+        /// Allocate a memory unit of a given heap using a thread cache
+        void* allocateFromCache(ThreadCache& cache, int indexHeap);
+
+        /// Release a memory unit of a given heap into a thread cache
+        void releaseIntoCache(ThreadCache& cache, int indexHeap, void* pointer);
+
+        /// Fill the empty cache of a given heap with a batch of the depot or with a new memory block
+        void refillCache(ThreadCache& cache, int indexHeap);
+
+        /// Push a batch of free memory units into the depot of a given heap
+        void pushBatch(int indexHeap, MemoryUnit* firstUnit);
+
+        /// Pop a batch of free memory units from the depot of a given heap
+        MemoryUnit* popBatch(int indexHeap);
+
+        /// Return the index of the memory block of a memory unit in an array of blocks sorted by address
+        static uint findMemoryBlock(MemoryBlock* const* blocks, uint nbBlocks, const MemoryUnit* unit);
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        ThreadCachingPoolAllocator(MemoryAllocator& baseAllocator);
+
+        /// Destructor
+        virtual ~ThreadCachingPoolAllocator() override;
+
+        /// Deleted copy-constructor
+        ThreadCachingPoolAllocator(const ThreadCachingPoolAllocator& allocator) = delete;
+
+        /// Deleted assignment operator
+        ThreadCachingPoolAllocator& operator=(const ThreadCachingPoolAllocator& allocator) = delete;
+
+        /// Allocate memory of a given size (in bytes) and return a pointer to the
+        /// allocated memory.
+        virtual void* allocate(size_t size) override;
+
+        /// Release previously allocated memory.
+        virtual void release(void* pointer, size_t size) override;
+
+        /// Return the memory blocks where all the memory units are free to the base allocator
+        virtual size_t trim() override;
+};
+
+// Return the index of the heap to use for a given allocation size
+inline int ThreadCachingPoolAllocator::getHeapIndex(size_t size) {
+    assert(size > 0 && size <= MAX_UNIT_SIZE);
+    return static_cast<int>((size - 1) / UNIT_SIZE_GRANULARITY);
+}
+
+// Return the size of the memory units of a given heap
+inline size_t ThreadCachingPoolAllocator::getUnitSize(int indexHeap) {
+    return (indexHeap + 1) * UNIT_SIZE_GRANULARITY;
+}
+
+// Return the number of memory units in a batch of a given heap
+inline uint ThreadCachingPoolAllocator::getBatchSize(int indexHeap) {
+    const uint nbUnitsPerBlock = static_cast<uint>((BLOCK_SIZE - BLOCK_HEADER_SIZE) / getUnitSize(indexHeap));
+    const uint batchSize = nbUnitsPerBlock / 2;
+    return batchSize > MAX_BATCH_SIZE ? MAX_BATCH_SIZE : batchSize;
+}
+
+// Return a tagged depot head from a pointer and a tag
+inline uint64_t ThreadCachingPoolAllocator::packDepotHead(MemoryUnit* unit, uint64_t tag) {
+    const uint64_t pointerBits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(unit));
+    assert((pointerBits >> NB_POINTER_BITS) == 0);
+    return pointerBits | (tag << NB_POINTER_BITS);
+}
+
+// Return the pointer stored in a tagged depot head
+inline ThreadCachingPoolAllocator::MemoryUnit* ThreadCachingPoolAllocator::getDepotHeadUnit(uint64_t depotHead) {
+    const uint64_t pointerMask = (uint64_t(1) << NB_POINTER_BITS) - 1;
+    return reinterpret_cast<MemoryUnit*>(static_cast<uintptr_t>(depotHead & pointerMask));
+}
+
+// Return the tag stored in a tagged depot head
+inline uint64_t ThreadCachingPoolAllocator::getDepotHeadTag(uint64_t depotHead) {
+    return depotHead >> NB_POINTER_BITS;
+}
+
+}
+
+#endif
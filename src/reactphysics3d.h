@@ -55,6 +55,7 @@
 #include "collision/ProxyShape.h"
 #include "collision/RaycastInfo.h"
 #include "collision/TriangleMesh.h"
+#include "collision/TriangleMeshBVH.h"
 #include "collision/PolyhedronMesh.h"
 #include "collision/TriangleVertexArray.h"
 #include "collision/PolygonVertexArray.h"
@@ -65,6 +66,8 @@
 #include "constraint/HingeJoint.h"
 #include "constraint/FixedJoint.h"
 #include "containers/List.h"
+#include "memory/ThreadCachingPoolAllocator.h"
+#include "memory/HugePageAllocator.h"
 
 /// Alias to the ReactPhysics3D namespace
 namespace rp3d = reactphysics3d;
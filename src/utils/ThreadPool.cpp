@@ -0,0 +1,146 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "ThreadPool.h"
+#include "memory/MemoryAllocator.h"
+#include <cassert>
+#include <new>
+
+using namespace reactphysics3d;
+
+// Constructor
+/**
+ * @param allocator Memory allocator used to allocate the array of threads
+ * @param nbWorkers Number of worker threads (without the thread that calls run())
+ */
+ThreadPool::ThreadPool(MemoryAllocator& allocator, uint nbWorkers)
+           : mAllocator(allocator), mNbWorkers(nbWorkers), mWorkers(nullptr), mTask(nullptr),
+             mNbTasks(0), mTaskNumber(0), mNbBusyWorkers(0), mIsStopping(false) {
+
+    if (mNbWorkers == 0) return;
+
+    // Create the worker threads
+    mWorkers = static_cast<std::thread*>(mAllocator.allocate(mNbWorkers * sizeof(std::thread)));
+    for (uint i=0; i < mNbWorkers; i++) {
+        new (mWorkers + i) std::thread(&ThreadPool::runWorker, this, i);
+    }
+}
+
+// Destructor
+ThreadPool::~ThreadPool() {
+
+    if (mNbWorkers == 0) return;
+
+    // Ask the workers to exit
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mTaskCondition.notify_all();
+
+    for (uint i=0; i < mNbWorkers; i++) {
+        mWorkers[i].join();
+        mWorkers[i].~thread();
+    }
+
+    mAllocator.release(mWorkers, mNbWorkers * sizeof(std::thread));
+}
+
+// Execute a task with a given number of task indices and wait until it is finished
+/// The task index 0 is executed by the calling thread and the task index i (with i > 0)
+/// by the worker thread i - 1. The number of task indices must not be larger than the
+/// number of workers plus one.
+/**
+ * @param task Task to execute
+ * @param nbTasks Number of task indices
+ */
+void ThreadPool::run(ThreadPoolTask& task, uint nbTasks) {
+
+    assert(nbTasks <= mNbWorkers + 1);
+
+    if (nbTasks == 0) return;
+
+    // Only the calling thread is needed
+    if (nbTasks == 1) {
+        task.execute(0);
+        return;
+    }
+
+    // Give the task to the workers that are needed
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mNbTasks = nbTasks;
+        mNbBusyWorkers = nbTasks - 1;
+        mTaskNumber++;
+    }
+    mTaskCondition.notify_all();
+
+    task.execute(0);
+
+    // Wait until the workers have finished
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [this] { return mNbBusyWorkers == 0; });
+    mTask = nullptr;
+}
+
+// Main loop of a worker thread
+void ThreadPool::runWorker(uint workerIndex) {
+
+    const uint taskIndex = workerIndex + 1;
+    uint64 lastTaskNumber = 0;
+
+    while (true) {
+
+        ThreadPoolTask* task;
+
+        // Wait for a new task that needs this worker
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskCondition.wait(lock, [this, taskIndex, &lastTaskNumber] {
+                return mIsStopping || (mTaskNumber != lastTaskNumber && taskIndex < mNbTasks);
+            });
+
+            if (mIsStopping) return;
+
+            lastTaskNumber = mTaskNumber;
+            task = mTask;
+        }
+
+        task->execute(taskIndex);
+
+        // Notify the calling thread if this is the last worker to finish
+        bool isLastWorker;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mNbBusyWorkers--;
+            isLastWorker = mNbBusyWorkers == 0;
+        }
+        if (isLastWorker) {
+            mDoneCondition.notify_one();
+        }
+    }
+}
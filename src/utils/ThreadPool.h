@@ -0,0 +1,141 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef REACTPHYSICS3D_THREAD_POOL_H
+#define REACTPHYSICS3D_THREAD_POOL_H
+
+// Libraries
+#include "configuration.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// ReactPhysics3D namespace
+namespace reactphysics3d {
+
+// Declarations
+class MemoryAllocator;
+
+// Class ThreadPoolTask
+/**
+ * This class represents a task that is executed concurrently by the threads of a
+ * ThreadPool. Each thread executes the task with a different task index.
+ */
+class ThreadPoolTask {
+
+    public:
+
+        /// Destructor
+        virtual ~ThreadPoolTask() = default;
+
+        /// Execute the task with a given index
+        virtual void execute(uint taskIndex)=0;
+};
+
+// Class ThreadPool
+/**
+ * This class represents a pool of worker threads that are created once and that wait
+ * until a task is given to them. The run() method executes a task with several task
+ * indices at the same time: the first index is executed by the calling thread and each
+ * other index by a worker thread. Therefore, no thread is created or destroyed when a
+ * task is run. The pool can only be used by one thread at a time.
+ */
+class ThreadPool {
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        /// Memory allocator used to allocate the array of threads
+        MemoryAllocator& mAllocator;
+
+        /// Number of worker threads
+        uint mNbWorkers;
+
+        /// Array with the worker threads
+        std::thread* mWorkers;
+
+        /// Mutex protecting the task and the state of the workers
+        std::mutex mMutex;
+
+        /// Condition variable used to wake up the workers when a task is run (or when
+        /// the pool is destroyed)
+        std::condition_variable mTaskCondition;
+
+        /// Condition variable used to notify the calling thread when all the workers
+        /// have finished the current task
+        std::condition_variable mDoneCondition;
+
+        /// Current task
+        ThreadPoolTask* mTask;
+
+        /// Number of task indices of the current task
+        uint mNbTasks;
+
+        /// Number of the current task (incremented each time a task is run)
+        uint64 mTaskNumber;
+
+        /// Number of workers that have not finished the current task yet
+        uint mNbBusyWorkers;
+
+        /// True if the workers must exit
+        bool mIsStopping;
+
+        // -------------------- Methods -------------------- //
+
+        /// Main loop of a worker thread
+        void runWorker(uint workerIndex);
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        /// Constructor
+        ThreadPool(MemoryAllocator& allocator, uint nbWorkers);
+
+        /// Destructor
+        ~ThreadPool();
+
+        /// Deleted copy-constructor
+        ThreadPool(const ThreadPool& threadPool) = delete;
+
+        /// Deleted assignment operator
+        ThreadPool& operator=(const ThreadPool& threadPool) = delete;
+
+        /// Return the number of worker threads
+        uint getNbWorkers() const;
+
+        /// Execute a task with a given number of task indices and wait until it is finished
+        void run(ThreadPoolTask& task, uint nbTasks);
+};
+
+// Return the number of worker threads
+inline uint ThreadPool::getNbWorkers() const {
+    return mNbWorkers;
+}
+
+}
+
+#endif
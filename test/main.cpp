@@ -36,12 +36,24 @@
 #include "tests/collision/TestRaycast.h"
 #include "tests/collision/TestCollisionWorld.h"
 #include "tests/collision/TestAABB.h"
+#include "tests/collision/TestBroadPhase.h"
 #include "tests/collision/TestDynamicAABBTree.h"
 #include "tests/collision/TestHalfEdgeStructure.h"
 #include "tests/collision/TestTriangleVertexArray.h"
+#include "tests/collision/TestTriangleMeshBVH.h"
+#include "tests/collision/TestConcaveMeshShape.h"
+#include "tests/collision/TestHeightFieldShape.h"
 #include "tests/containers/TestList.h"
+#include "tests/containers/TestSmallList.h"
 #include "tests/containers/TestMap.h"
 #include "tests/containers/TestSet.h"
+#include "tests/containers/TestDenseIntegerSet.h"
+#include "tests/memory/TestMemoryManager.h"
+#include "tests/memory/TestThreadCachingPoolAllocator.h"
+#include "tests/memory/TestSingleFrameAllocator.h"
+#include "tests/memory/TestDefaultPoolAllocator.h"
+#include "tests/memory/TestHugePageAllocator.h"
+#include "tests/utils/TestThreadPool.h"
 
 using namespace reactphysics3d;
 
@@ -52,8 +64,22 @@ int main() {
     // ---------- Containers tests ---------- //
 
     testSuite.addTest(new TestList("List"));
+    testSuite.addTest(new TestSmallList("SmallList"));
     testSuite.addTest(new TestMap("Map"));
     testSuite.addTest(new TestSet("Set"));
+    testSuite.addTest(new TestDenseIntegerSet("DenseIntegerSet"));
+
+    // ---------- Memory tests ---------- //
+
+    testSuite.addTest(new TestMemoryManager("MemoryManager"));
+    testSuite.addTest(new TestThreadCachingPoolAllocator("ThreadCachingPoolAllocator"));
+    testSuite.addTest(new TestSingleFrameAllocator("SingleFrameAllocator"));
+    testSuite.addTest(new TestDefaultPoolAllocator("DefaultPoolAllocator"));
+    testSuite.addTest(new TestHugePageAllocator("HugePageAllocator"));
+
+    // ---------- Utils tests ---------- //
+
+    testSuite.addTest(new TestThreadPool("ThreadPool"));
 
     // ---------- Mathematics tests ---------- //
 
@@ -70,9 +96,13 @@ int main() {
     testSuite.addTest(new TestAABB("AABB"));
     testSuite.addTest(new TestPointInside("IsPointInside"));
     testSuite.addTest(new TestTriangleVertexArray("TriangleVertexArray"));
+    testSuite.addTest(new TestTriangleMeshBVH("TriangleMeshBVH"));
+    testSuite.addTest(new TestConcaveMeshShape("ConcaveMeshShape"));
+    testSuite.addTest(new TestHeightFieldShape("HeightFieldShape"));
     testSuite.addTest(new TestRaycast("Raycasting"));
     testSuite.addTest(new TestCollisionWorld("CollisionWorld"));
     testSuite.addTest(new TestDynamicAABBTree("DynamicAABBTree"));
+    testSuite.addTest(new TestBroadPhase("BroadPhase"));
     testSuite.addTest(new TestHalfEdgeStructure("HalfEdgeStructure"));
 
     // Run the tests
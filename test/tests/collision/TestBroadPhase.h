@@ -0,0 +1,636 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_BROAD_PHASE_H
+#define TEST_BROAD_PHASE_H
+
+// Libraries
+#include "reactphysics3d.h"
+#include "Test.h"
+#include <vector>
+#include <algorithm>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class BodyPairsCallback
+/**
+ * Collision callback that records the pairs of bodies in the order of the reported contacts
+ */
+class BodyPairsCallback : public CollisionCallback {
+
+    public:
+
+        std::vector<std::pair<uint, uint>> bodyPairs;
+
+        virtual void notifyContact(const CollisionCallbackInfo& collisionCallbackInfo) override {
+
+            const std::pair<uint, uint> bodyPair(collisionCallbackInfo.body1->getId(), collisionCallbackInfo.body2->getId());
+            if (bodyPairs.empty() || bodyPairs.back() != bodyPair) {
+                bodyPairs.push_back(bodyPair);
+            }
+        }
+};
+
+// Class HitBodiesCallback
+/**
+ * Raycast and overlap callback that records the IDs of the hit bodies
+ */
+class HitBodiesCallback : public RaycastCallback, public OverlapCallback {
+
+    public:
+
+        std::vector<uint> bodyIds;
+
+        virtual decimal notifyRaycastHit(const RaycastInfo& raycastInfo) override {
+            bodyIds.push_back(raycastInfo.body->getId());
+            return decimal(1.0);
+        }
+
+        virtual void notifyOverlap(CollisionBody* collisionBody) override {
+            bodyIds.push_back(collisionBody->getId());
+        }
+};
+
+// Class TestBroadPhase
+/**
+ * Unit test for the broad-phase collision detection
+ */
+class TestBroadPhase : public Test {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of spheres along each axis of the grid of spheres
+        static const int NB_SPHERES_X = 13;
+        static const int NB_SPHERES_Y = 12;
+        static const int NB_SPHERES_Z = 13;
+
+        // ---------- Atributes ---------- //
+
+        /// Sphere shape of all the bodies
+        SphereShape* mSphereShape;
+
+        /// Box shape of the floor
+        BoxShape* mFloorShape;
+
+        /// Box shape of the static bodies
+        BoxShape* mBoxShape;
+
+        /// Positions of the spheres
+        std::vector<Vector3> mPositions;
+
+        // ---------- Methods ---------- //
+
+        /// Return the world settings with a given number of broad-phase threads
+        static WorldSettings createSettings(uint nbBroadPhaseThreads,
+                                            BroadPhaseType broadPhaseType = BroadPhaseType::DYNAMIC_AABB_TREE) {
+            WorldSettings settings;
+            settings.nbBroadPhaseThreads = nbBroadPhaseThreads;
+            settings.broadPhaseType = broadPhaseType;
+            return settings;
+        }
+
+        /// Return the number of overlapping pairs of spheres whose indices satisfy a predicate
+        template<typename Predicate>
+        uint computeNbOverlappingSpheres(Predicate canCollide) const {
+
+            uint nbPairs = 0;
+            for (uint i=0; i < mPositions.size(); i++) {
+                for (uint j=i+1; j < mPositions.size(); j++) {
+                    if ((mPositions[i] - mPositions[j]).lengthSquare() < decimal(1.0) && canCollide(i, j)) {
+                        nbPairs++;
+                    }
+                }
+            }
+
+            return nbPairs;
+        }
+
+        /// Add the spheres into a collision world
+        void createCollisionBodies(CollisionWorld& world, std::vector<CollisionBody*>* bodies = nullptr) {
+
+            for (uint i=0; i < mPositions.size(); i++) {
+                CollisionBody* body = world.createCollisionBody(Transform(mPositions[i], Quaternion::identity()));
+                body->addCollisionShape(mSphereShape, Transform::identity());
+                if (bodies != nullptr) bodies->push_back(body);
+            }
+        }
+
+        /// Add a row of overlapping static boxes and some spheres on top of them into a collision world
+        void createStaticRow(CollisionWorld& world, std::vector<CollisionBody*>& bodies) {
+
+            for (int i=0; i < 20; i++) {
+                CollisionBody* box = world.createCollisionBody(Transform(Vector3(decimal(i) * decimal(1.8), 0, 0),
+                                                                         Quaternion::identity()));
+                box->setType(BodyType::STATIC);
+                box->addCollisionShape(mBoxShape, Transform::identity());
+                bodies.push_back(box);
+            }
+            for (int i=0; i < 10; i++) {
+                CollisionBody* sphere = world.createCollisionBody(Transform(Vector3(decimal(i) * decimal(3.7), decimal(1.3), 0),
+                                                                            Quaternion::identity()));
+                sphere->addCollisionShape(mSphereShape, Transform::identity());
+                bodies.push_back(sphere);
+            }
+        }
+
+        /// Return the pairs of bodies in a list where at least one body is not static
+        static std::vector<std::pair<uint, uint>> removeStaticPairs(const std::vector<std::pair<uint, uint>>& pairs,
+                                                                    const std::vector<CollisionBody*>& bodies) {
+
+            std::vector<uint> staticBodyIds;
+            for (uint i=0; i < bodies.size(); i++) {
+                if (bodies[i]->getType() == BodyType::STATIC) staticBodyIds.push_back(bodies[i]->getId());
+            }
+
+            std::vector<std::pair<uint, uint>> nonStaticPairs;
+            for (uint i=0; i < pairs.size(); i++) {
+                if (std::find(staticBodyIds.begin(), staticBodyIds.end(), pairs[i].first) == staticBodyIds.end() ||
+                    std::find(staticBodyIds.begin(), staticBodyIds.end(), pairs[i].second) == staticBodyIds.end()) {
+                    nonStaticPairs.push_back(pairs[i]);
+                }
+            }
+
+            return nonStaticPairs;
+        }
+
+        /// Return the sorted pairs of bodies in contact in a collision world
+        static std::vector<std::pair<uint, uint>> computeSortedBodyPairs(CollisionWorld& world) {
+
+            BodyPairsCallback callback;
+            world.testCollision(&callback);
+            for (uint i=0; i < callback.bodyPairs.size(); i++) {
+                std::pair<uint, uint>& pair = callback.bodyPairs[i];
+                if (pair.first > pair.second) std::swap(pair.first, pair.second);
+            }
+            std::sort(callback.bodyPairs.begin(), callback.bodyPairs.end());
+            return callback.bodyPairs;
+        }
+
+        /// Add the spheres and the floor into a dynamics world
+        void createRigidBodies(DynamicsWorld& world, std::vector<RigidBody*>& bodies) {
+
+            for (uint i=0; i < mPositions.size(); i++) {
+                RigidBody* body = world.createRigidBody(Transform(mPositions[i], Quaternion::identity()));
+                body->addCollisionShape(mSphereShape, Transform::identity(), decimal(1.0));
+                bodies.push_back(body);
+            }
+
+            RigidBody* floor = world.createRigidBody(Transform(Vector3(0, -1, 0), Quaternion::identity()));
+            floor->setType(BodyType::STATIC);
+            floor->addCollisionShape(mFloorShape, Transform::identity(), decimal(1.0));
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestBroadPhase(const std::string& name) : Test(name) {
+
+            mSphereShape = new SphereShape(decimal(0.5));
+            mFloorShape = new BoxShape(Vector3(50, 0.5, 50));
+            mBoxShape = new BoxShape(Vector3(1, 1, 1));
+
+            // Grid of overlapping spheres (only the neighbors along the axes overlap)
+            uint random = 1;
+            for (int x=0; x < NB_SPHERES_X; x++) {
+                for (int y=0; y < NB_SPHERES_Y; y++) {
+                    for (int z=0; z < NB_SPHERES_Z; z++) {
+                        random = random * 1664525u + 1013904223u;
+                        const decimal jitter = decimal((random >> 16) % 100) * decimal(0.0002);
+                        mPositions.push_back(Vector3(x * decimal(0.9) + jitter, y * decimal(0.9) + jitter,
+                                                     z * decimal(0.9) - jitter));
+                    }
+                }
+            }
+        }
+
+        /// Destructor
+        virtual ~TestBroadPhase() {
+            delete mSphereShape;
+            delete mFloorShape;
+            delete mBoxShape;
+        }
+
+        /// Run the tests
+        void run() {
+
+            testOverlappingPairs();
+            testMultithreadedDeterminism();
+            testSweepAndPrune();
+            testStaticShapes();
+            testRefitUpdateMethod();
+            testCollisionFiltering();
+            testSleepingPairs();
+            testSleepingPairsOfMovedStaticBody();
+            testStatistics();
+        }
+
+        /// Test that the overlapping pairs are the same with one or several threads
+        void testOverlappingPairs() {
+
+            // Compute the pairs of overlapping spheres
+            uint nbExpectedPairs = 0;
+            for (uint i=0; i < mPositions.size(); i++) {
+                for (uint j=i+1; j < mPositions.size(); j++) {
+                    if ((mPositions[i] - mPositions[j]).lengthSquare() < decimal(1.0)) {
+                        nbExpectedPairs++;
+                    }
+                }
+            }
+
+            CollisionWorld world1(createSettings(1));
+            CollisionWorld world2(createSettings(4));
+            createCollisionBodies(world1);
+            createCollisionBodies(world2);
+
+            BodyPairsCallback callback1;
+            BodyPairsCallback callback2;
+            world1.testCollision(&callback1);
+            world2.testCollision(&callback2);
+
+            rp3d_test(callback1.bodyPairs.size() == nbExpectedPairs);
+            rp3d_test(callback2.bodyPairs == callback1.bodyPairs);
+        }
+
+        /// Test that a simulation gives the same results with one or several threads
+        void testMultithreadedDeterminism() {
+
+            DynamicsWorld world1(Vector3(0, decimal(-9.81), 0), createSettings(1));
+            DynamicsWorld world2(Vector3(0, decimal(-9.81), 0), createSettings(4));
+            std::vector<RigidBody*> bodies1;
+            std::vector<RigidBody*> bodies2;
+            createRigidBodies(world1, bodies1);
+            createRigidBodies(world2, bodies2);
+
+            for (int i=0; i < 20; i++) {
+                world1.update(decimal(1.0) / decimal(60.0));
+                world2.update(decimal(1.0) / decimal(60.0));
+            }
+
+            bool isSame = true;
+            for (uint i=0; i < bodies1.size(); i++) {
+                const Transform& transform1 = bodies1[i]->getTransform();
+                const Transform& transform2 = bodies2[i]->getTransform();
+                if (transform1.getPosition() != transform2.getPosition() ||
+                    !(transform1.getOrientation() == transform2.getOrientation())) {
+                    isSame = false;
+                }
+            }
+            rp3d_test(isSame);
+        }
+
+        /// Test that the sweep-and-prune broad-phase gives the same results as the dynamic AABB tree
+        void testSweepAndPrune() {
+
+            CollisionWorld treeWorld(createSettings(1));
+            CollisionWorld sapWorld(createSettings(1, BroadPhaseType::SWEEP_AND_PRUNE));
+            std::vector<CollisionBody*> treeBodies;
+            std::vector<CollisionBody*> sapBodies;
+            createCollisionBodies(treeWorld, &treeBodies);
+            createCollisionBodies(sapWorld, &sapBodies);
+
+            rp3d_test(computeSortedBodyPairs(sapWorld) == computeSortedBodyPairs(treeWorld));
+
+            // Move some bodies, remove some others and test again
+            for (uint i=0; i < treeBodies.size(); i += 7) {
+                const Transform transform(mPositions[(i * 31) % mPositions.size()] + Vector3(decimal(0.3), 0, 0),
+                                          Quaternion::identity());
+                treeBodies[i]->setTransform(transform);
+                sapBodies[i]->setTransform(transform);
+            }
+            for (uint i=3; i < treeBodies.size(); i += 11) {
+                treeWorld.destroyCollisionBody(treeBodies[i]);
+                sapWorld.destroyCollisionBody(sapBodies[i]);
+                treeBodies[i] = nullptr;
+                sapBodies[i] = nullptr;
+            }
+
+            const std::vector<std::pair<uint, uint>> sapPairs = computeSortedBodyPairs(sapWorld);
+            rp3d_test(sapPairs.size() > 0);
+            rp3d_test(sapPairs == computeSortedBodyPairs(treeWorld));
+
+            // Move a single body to the other side of the scene (only its box is swept)
+            const Transform farTransform(mPositions[mPositions.size() - 1], Quaternion::identity());
+            treeBodies[1]->setTransform(farTransform);
+            sapBodies[1]->setTransform(farTransform);
+            rp3d_test(computeSortedBodyPairs(sapWorld) == computeSortedBodyPairs(treeWorld));
+
+            // Raycast through a row of spheres
+            const Ray ray(Vector3(-5, decimal(0.9), decimal(1.8)), Vector3(20, decimal(0.9), decimal(1.8)));
+            HitBodiesCallback treeRaycastCallback;
+            HitBodiesCallback sapRaycastCallback;
+            treeWorld.raycast(ray, &treeRaycastCallback);
+            sapWorld.raycast(ray, &sapRaycastCallback);
+            std::sort(treeRaycastCallback.bodyIds.begin(), treeRaycastCallback.bodyIds.end());
+            std::sort(sapRaycastCallback.bodyIds.begin(), sapRaycastCallback.bodyIds.end());
+            rp3d_test(sapRaycastCallback.bodyIds.size() > 0);
+            rp3d_test(sapRaycastCallback.bodyIds == treeRaycastCallback.bodyIds);
+
+            // Test the overlaps of a body
+            HitBodiesCallback treeOverlapCallback;
+            HitBodiesCallback sapOverlapCallback;
+            treeWorld.testOverlap(treeBodies[100], &treeOverlapCallback);
+            sapWorld.testOverlap(sapBodies[100], &sapOverlapCallback);
+            std::sort(treeOverlapCallback.bodyIds.begin(), treeOverlapCallback.bodyIds.end());
+            std::sort(sapOverlapCallback.bodyIds.begin(), sapOverlapCallback.bodyIds.end());
+            rp3d_test(sapOverlapCallback.bodyIds.size() > 0);
+            rp3d_test(sapOverlapCallback.bodyIds == treeOverlapCallback.bodyIds);
+        }
+
+        /// Test the shapes of the static bodies (that are in a separate tree of the broad-phase)
+        void testStaticShapes() {
+
+            CollisionWorld treeWorld(createSettings(1));
+            CollisionWorld sapWorld(createSettings(1, BroadPhaseType::SWEEP_AND_PRUNE));
+            std::vector<CollisionBody*> treeBodies;
+            std::vector<CollisionBody*> sapBodies;
+            createStaticRow(treeWorld, treeBodies);
+            createStaticRow(sapWorld, sapBodies);
+
+            // The pairs of static bodies are never tested with the static tree
+            std::vector<std::pair<uint, uint>> treePairs = computeSortedBodyPairs(treeWorld);
+            rp3d_test(treePairs.size() >= 10);
+            rp3d_test(treePairs == removeStaticPairs(computeSortedBodyPairs(sapWorld), sapBodies));
+
+            // The static bodies must be found by the raycasts and the overlap queries
+            const Ray ray(Vector3(-5, 0, 0), Vector3(50, 0, 0));
+            HitBodiesCallback raycastCallback;
+            treeWorld.raycast(ray, &raycastCallback);
+            rp3d_test(raycastCallback.bodyIds.size() == 20);
+
+            HitBodiesCallback overlapCallback;
+            treeWorld.testOverlap(treeBodies[20], &overlapCallback);
+            rp3d_test(overlapCallback.bodyIds.size() > 0);
+            rp3d_test(treeWorld.testAABBOverlap(treeBodies[20], treeBodies[0]));
+
+            // A static body that becomes dynamic collides with the static bodies
+            treeBodies[5]->setType(BodyType::DYNAMIC);
+            sapBodies[5]->setType(BodyType::DYNAMIC);
+            treePairs = computeSortedBodyPairs(treeWorld);
+            rp3d_test(treePairs == removeStaticPairs(computeSortedBodyPairs(sapWorld), sapBodies));
+            const std::pair<uint, uint> pair(treeBodies[4]->getId(), treeBodies[5]->getId());
+            rp3d_test(std::find(treePairs.begin(), treePairs.end(), pair) != treePairs.end());
+
+            // A moved static body collides with the spheres
+            const Transform transform(Vector3(decimal(3.7), decimal(2.5), 0), Quaternion::identity());
+            treeBodies[0]->setTransform(transform);
+            sapBodies[0]->setTransform(transform);
+            treePairs = computeSortedBodyPairs(treeWorld);
+            rp3d_test(treePairs == removeStaticPairs(computeSortedBodyPairs(sapWorld), sapBodies));
+            const std::pair<uint, uint> movedPair(std::min(treeBodies[0]->getId(), treeBodies[21]->getId()),
+                                                  std::max(treeBodies[0]->getId(), treeBodies[21]->getId()));
+            rp3d_test(std::find(treePairs.begin(), treePairs.end(), movedPair) != treePairs.end());
+        }
+
+        /// Test that the refit update method of the trees gives the same pairs as the reinsertion
+        void testRefitUpdateMethod() {
+
+            WorldSettings refitSettings = createSettings(1);
+            refitSettings.dynamicTreeUpdateMethod = DynamicTreeUpdateMethod::REFIT;
+            CollisionWorld reinsertWorld(createSettings(1));
+            CollisionWorld refitWorld(refitSettings);
+            std::vector<CollisionBody*> reinsertBodies;
+            std::vector<CollisionBody*> refitBodies;
+            createCollisionBodies(reinsertWorld, &reinsertBodies);
+            createCollisionBodies(refitWorld, &refitBodies);
+            createStaticRow(reinsertWorld, reinsertBodies);
+            createStaticRow(refitWorld, refitBodies);
+
+            rp3d_test(computeSortedBodyPairs(refitWorld) == computeSortedBodyPairs(reinsertWorld));
+
+            // Move the bodies during several frames (small and large displacements)
+            for (int frame=0; frame < 5; frame++) {
+                for (uint i=frame; i < reinsertBodies.size(); i += 3) {
+                    const decimal offset = (i % 2 == 0) ? decimal(0.05) * (frame + 1) : decimal(4.0);
+                    const Vector3 position = reinsertBodies[i]->getTransform().getPosition() + Vector3(offset, 0, 0);
+                    const Transform transform(position, Quaternion::identity());
+                    reinsertBodies[i]->setTransform(transform);
+                    refitBodies[i]->setTransform(transform);
+                }
+
+                const std::vector<std::pair<uint, uint>> reinsertPairs = computeSortedBodyPairs(reinsertWorld);
+                rp3d_test(reinsertPairs.size() > 0);
+                rp3d_test(computeSortedBodyPairs(refitWorld) == reinsertPairs);
+            }
+
+            // Raycast through a row of spheres
+            const Ray ray(Vector3(-5, decimal(0.9), decimal(1.8)), Vector3(20, decimal(0.9), decimal(1.8)));
+            HitBodiesCallback reinsertCallback;
+            HitBodiesCallback refitCallback;
+            reinsertWorld.raycast(ray, &reinsertCallback);
+            refitWorld.raycast(ray, &refitCallback);
+            std::sort(reinsertCallback.bodyIds.begin(), reinsertCallback.bodyIds.end());
+            std::sort(refitCallback.bodyIds.begin(), refitCallback.bodyIds.end());
+            rp3d_test(refitCallback.bodyIds == reinsertCallback.bodyIds);
+        }
+
+        /// Test that the filtered pairs are never created in the broad-phase
+        void testCollisionFiltering() {
+
+            CollisionWorld world(createSettings(1));
+            std::vector<CollisionBody*> bodies;
+            createCollisionBodies(world, &bodies);
+
+            const uint nbAllPairs = computeNbOverlappingSpheres([](uint, uint) { return true; });
+
+            // Put all the spheres in a layer that does not collide with itself
+            const MemoryManager& memoryManager = world.getMemoryManager();
+            const uint64 nbPairsAllocationsBefore = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool,
+                                                                    MemoryManager::AllocationTag::OverlappingPairs).nbAllocations;
+            world.setAreCollisionLayersColliding(3, 3, false);
+            rp3d_test(!world.areCollisionLayersColliding(3, 3));
+            rp3d_test(world.areCollisionLayersColliding(3, 0));
+            for (uint i=0; i < bodies.size(); i++) {
+                bodies[i]->getProxyShapesList()->setCollisionLayer(3);
+            }
+            rp3d_test(computeSortedBodyPairs(world).size() == 0);
+
+            // No overlapping pair has been allocated
+            rp3d_test(memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool,
+                                                            MemoryManager::AllocationTag::OverlappingPairs).nbAllocations ==
+                      nbPairsAllocationsBefore);
+
+            // The pairs are found again when the layer collides with itself again
+            world.setAreCollisionLayersColliding(3, 3, true);
+            rp3d_test(computeSortedBodyPairs(world).size() == nbAllPairs);
+
+            // The existing pairs between two layers are destroyed when the layers cannot collide anymore
+            for (uint i=0; i < bodies.size(); i += 2) {
+                bodies[i]->getProxyShapesList()->setCollisionLayer(63);
+            }
+            world.setAreCollisionLayersColliding(3, 63, false);
+            rp3d_test(computeSortedBodyPairs(world).size() ==
+                      computeNbOverlappingSpheres([](uint i, uint j) { return (i % 2) == (j % 2); }));
+            world.setAreCollisionLayersColliding(3, 63, true);
+            rp3d_test(computeSortedBodyPairs(world).size() == nbAllPairs);
+
+            // Filter the pairs with the collision category bits
+            for (uint i=0; i < bodies.size(); i += 3) {
+                bodies[i]->getProxyShapesList()->setCollisionCategoryBits(0x0002);
+                bodies[i]->getProxyShapesList()->setCollideWithMaskBits(0x0001);
+            }
+            rp3d_test(computeSortedBodyPairs(world).size() ==
+                      computeNbOverlappingSpheres([](uint i, uint j) { return i % 3 != 0 || j % 3 != 0; }));
+
+            // The pairs filtered out previously are found when the category bits allow them
+            for (uint i=0; i < bodies.size(); i += 3) {
+                bodies[i]->getProxyShapesList()->setCollideWithMaskBits(0x0002);
+            }
+            rp3d_test(computeSortedBodyPairs(world).size() ==
+                      computeNbOverlappingSpheres([](uint i, uint j) { return (i % 3 == 0) == (j % 3 == 0); }));
+        }
+
+        /// Test that the overlapping pairs of the sleeping bodies become active again when they wake up
+        void testSleepingPairs() {
+
+            DynamicsWorld world(Vector3(0, decimal(-9.81), 0), createSettings(1));
+
+            RigidBody* floor = world.createRigidBody(Transform(Vector3(0, -1, 0), Quaternion::identity()));
+            floor->setType(BodyType::STATIC);
+            floor->addCollisionShape(mFloorShape, Transform::identity(), decimal(1.0));
+
+            // Boxes resting on the floor
+            std::vector<RigidBody*> boxes;
+            for (int i=0; i < 10; i++) {
+                RigidBody* box = world.createRigidBody(Transform(Vector3(decimal(i) * 3, decimal(0.5), 0),
+                                                                 Quaternion::identity()));
+                box->addCollisionShape(mBoxShape, Transform::identity(), decimal(1.0));
+                boxes.push_back(box);
+            }
+
+            // Wait until all the boxes are sleeping
+            for (int i=0; i < 300; i++) {
+                world.update(decimal(1.0) / decimal(60.0));
+            }
+            bool areAllSleeping = true;
+            for (uint i=0; i < boxes.size(); i++) {
+                if (!boxes[i]->isSleeping()) areAllSleeping = false;
+            }
+            rp3d_test(areAllSleeping);
+
+            // The pairs of the sleeping boxes do not have contacts anymore
+            world.update(decimal(1.0) / decimal(60.0));
+            rp3d_test(world.getContactsList().size() == 0);
+
+            // Wake up a box. Its pair with the floor becomes active again in the next frame
+            boxes[4]->setIsSleeping(false);
+            world.update(decimal(1.0) / decimal(60.0));
+            rp3d_test(world.getContactsList().size() > 0);
+
+            // The box must stay on the floor
+            for (int i=0; i < 30; i++) {
+                world.update(decimal(1.0) / decimal(60.0));
+            }
+            rp3d_test(boxes[4]->getTransform().getPosition().y > decimal(0.4));
+            rp3d_test(boxes[3]->isSleeping());
+        }
+
+        /// Test that the inactive pair of a sleeping body is destroyed when a static body moves away from it
+        void testSleepingPairsOfMovedStaticBody() {
+
+            DynamicsWorld world(Vector3(0, decimal(-9.81), 0), createSettings(1));
+
+            RigidBody* floor = world.createRigidBody(Transform(Vector3(0, -1, 0), Quaternion::identity()));
+            floor->setType(BodyType::STATIC);
+            floor->addCollisionShape(mFloorShape, Transform::identity(), decimal(1.0));
+
+            RigidBody* box = world.createRigidBody(Transform(Vector3(0, decimal(0.5), 0), Quaternion::identity()));
+            box->addCollisionShape(mBoxShape, Transform::identity(), decimal(1.0));
+
+            // Wait until the box is sleeping
+            for (int i=0; i < 300; i++) {
+                world.update(decimal(1.0) / decimal(60.0));
+            }
+            rp3d_test(box->isSleeping());
+            BroadPhaseStatistics statistics = world.getBroadPhaseStatistics();
+            rp3d_test(statistics.nbOverlappingPairs == 1);
+            rp3d_test(statistics.nbActiveOverlappingPairs == 0);
+
+            // Move the static floor far away from the sleeping box
+            floor->setTransform(Transform(Vector3(0, -100, 0), Quaternion::identity()));
+            world.update(decimal(1.0) / decimal(60.0));
+            statistics = world.getBroadPhaseStatistics();
+            rp3d_test(statistics.nbDestroyedPairs == 1);
+            rp3d_test(statistics.nbOverlappingPairs == 0);
+            rp3d_test(box->isSleeping());
+        }
+
+        /// Test the statistics of the broad-phase
+        void testStatistics() {
+
+            DynamicsWorld world(Vector3(0, 0, 0), createSettings(1));
+            std::vector<RigidBody*> bodies;
+            createRigidBodies(world, bodies);
+            for (uint i=0; i < bodies.size(); i++) {
+                bodies[i]->setType(BodyType::KINEMATIC);
+            }
+            const uint nbExpectedPairs = computeNbOverlappingSpheres([](uint, uint) { return true; });
+
+            // All the shapes are new in the first step
+            world.update(decimal(1.0) / decimal(60.0));
+            BroadPhaseStatistics statistics = world.getBroadPhaseStatistics();
+            const int nbShapes = static_cast<int>(bodies.size());
+            rp3d_test(statistics.nbMovedShapes == bodies.size() + 1);
+            rp3d_test(statistics.nbDynamicTreeNodes == 2 * nbShapes - 1);
+            rp3d_test(statistics.nbStaticTreeNodes == 1);
+            rp3d_test(statistics.dynamicTreeHeight >= 11);
+            rp3d_test(statistics.dynamicTreeHeight < nbShapes / 10);
+            rp3d_test(statistics.staticTreeHeight == 0);
+            rp3d_test(statistics.dynamicTreeSAHCost > decimal(1.0));
+            rp3d_test(statistics.nbPotentialPairs >= nbExpectedPairs);
+            rp3d_test(statistics.nbCreatedPairs == statistics.nbPotentialPairs);
+            rp3d_test(statistics.nbOverlappingPairs == statistics.nbCreatedPairs);
+            rp3d_test(statistics.nbActiveOverlappingPairs == statistics.nbOverlappingPairs);
+            rp3d_test(statistics.nbDestroyedPairs == 0);
+
+            // Nothing has moved in the second step
+            world.update(decimal(1.0) / decimal(60.0));
+            statistics = world.getBroadPhaseStatistics();
+            rp3d_test(statistics.nbMovedShapes == 0);
+            rp3d_test(statistics.nbReinsertedShapes == 0);
+            rp3d_test(statistics.nbPotentialPairs == 0);
+            rp3d_test(statistics.nbCreatedPairs == 0);
+            rp3d_test(statistics.nbDestroyedPairs == 0);
+
+            // Move a body far away
+            const uint nbPairsBefore = statistics.nbOverlappingPairs;
+            bodies[0]->setTransform(Transform(Vector3(-100, 0, 0), Quaternion::identity()));
+            world.update(decimal(1.0) / decimal(60.0));
+            statistics = world.getBroadPhaseStatistics();
+            rp3d_test(statistics.nbReinsertedShapes == 1);
+            rp3d_test(statistics.nbMovedShapes == 1);
+            rp3d_test(statistics.nbPotentialPairs == 0);
+            rp3d_test(statistics.nbDestroyedPairs > 0);
+            rp3d_test(statistics.nbOverlappingPairs == nbPairsBefore - statistics.nbDestroyedPairs);
+        }
+ };
+
+}
+
+#endif
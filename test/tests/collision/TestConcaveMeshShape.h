@@ -0,0 +1,258 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_CONCAVE_MESH_SHAPE_H
+#define TEST_CONCAVE_MESH_SHAPE_H
+
+// Libraries
+#include "reactphysics3d.h"
+#include <vector>
+#include <map>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Structure ReportedTriangle
+/**
+ * Vertices and vertices normals of a triangle reported by a concave shape
+ */
+struct ReportedTriangle {
+
+    Vector3 vertices[3];
+    Vector3 verticesNormals[3];
+};
+
+// Class ReportedTrianglesCallback
+/**
+ * Triangle callback that collects the reported triangles by shape ID
+ */
+class ReportedTrianglesCallback : public TriangleCallback {
+
+    public:
+
+        /// Reported triangles
+        std::map<uint, ReportedTriangle> triangles;
+
+        /// Report a triangle
+        virtual void testTriangle(const Vector3* trianglePoints, const Vector3* verticesNormals, uint shapeId) override {
+            ReportedTriangle& triangle = triangles[shapeId];
+            for (int i=0; i < 3; i++) {
+                triangle.vertices[i] = trianglePoints[i];
+                triangle.verticesNormals[i] = verticesNormals[i];
+            }
+        }
+};
+
+// Class TestConcaveMeshShape
+/**
+ * Unit test for the ConcaveMeshShape class
+ */
+class TestConcaveMeshShape : public Test {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of vertices of a sub-part of the mesh along each axis
+        static const int NB_VERTICES_PER_SIDE = 12;
+
+        // ---------- Atributes ---------- //
+
+        /// Vertices of the first sub-part (single precision and computed normals)
+        std::vector<float> mVertices1;
+        std::vector<uint> mIndices1;
+
+        /// Vertices of the second sub-part (double precision and user normals)
+        std::vector<double> mVertices2;
+        std::vector<float> mNormals2;
+        std::vector<short> mIndices2;
+
+        /// Triangle vertex arrays of the two sub-parts of the mesh
+        TriangleVertexArray* mTriangleVertexArray1;
+        TriangleVertexArray* mTriangleVertexArray2;
+
+        /// Triangle mesh
+        TriangleMesh mTriangleMesh;
+
+        /// Number of triangles of the mesh
+        uint mNbTriangles;
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestConcaveMeshShape(const std::string& name) : Test(name) {
+
+            // Create two bumpy grids of triangles next to each other
+            for (int i=0; i < NB_VERTICES_PER_SIDE; i++) {
+                for (int j=0; j < NB_VERTICES_PER_SIDE; j++) {
+                    mVertices1.push_back(float(i));
+                    mVertices1.push_back(float((i * 7 + j * 3) % 5));
+                    mVertices1.push_back(float(j));
+                    mVertices2.push_back(double(i + NB_VERTICES_PER_SIDE - 1));
+                    mVertices2.push_back(double((i * 3 + j * 5) % 4));
+                    mVertices2.push_back(double(j));
+                    Vector3 normal(decimal(i % 3) - 1, 4, decimal(j % 2));
+                    normal.normalize();
+                    mNormals2.push_back(float(normal.x));
+                    mNormals2.push_back(float(normal.y));
+                    mNormals2.push_back(float(normal.z));
+                }
+            }
+
+            for (int i=0; i < NB_VERTICES_PER_SIDE - 1; i++) {
+                for (int j=0; j < NB_VERTICES_PER_SIDE - 1; j++) {
+                    const uint v0 = i * NB_VERTICES_PER_SIDE + j;
+                    const uint v1 = v0 + 1;
+                    const uint v2 = v0 + NB_VERTICES_PER_SIDE;
+                    const uint v3 = v2 + 1;
+                    mIndices1.push_back(v0); mIndices1.push_back(v1); mIndices1.push_back(v2);
+                    mIndices1.push_back(v1); mIndices1.push_back(v3); mIndices1.push_back(v2);
+                    mIndices2.push_back(short(v0)); mIndices2.push_back(short(v1)); mIndices2.push_back(short(v2));
+                    mIndices2.push_back(short(v1)); mIndices2.push_back(short(v3)); mIndices2.push_back(short(v2));
+                }
+            }
+
+            const uint nbVertices = NB_VERTICES_PER_SIDE * NB_VERTICES_PER_SIDE;
+            const uint nbTrianglesPerSubpart = static_cast<uint>(mIndices1.size() / 3);
+
+            mTriangleVertexArray1 = new TriangleVertexArray(nbVertices, &(mVertices1[0]), 3 * sizeof(float),
+                                                            nbTrianglesPerSubpart, &(mIndices1[0]), 3 * sizeof(uint),
+                                                            TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
+                                                            TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+            mTriangleVertexArray2 = new TriangleVertexArray(nbVertices, &(mVertices2[0]), 3 * sizeof(double),
+                                                            &(mNormals2[0]), 3 * sizeof(float),
+                                                            nbTrianglesPerSubpart, &(mIndices2[0]), 3 * sizeof(short),
+                                                            TriangleVertexArray::VertexDataType::VERTEX_DOUBLE_TYPE,
+                                                            TriangleVertexArray::NormalDataType::NORMAL_FLOAT_TYPE,
+                                                            TriangleVertexArray::IndexDataType::INDEX_SHORT_TYPE);
+            mTriangleMesh.addSubpart(mTriangleVertexArray1);
+            mTriangleMesh.addSubpart(mTriangleVertexArray2);
+            mNbTriangles = 2 * nbTrianglesPerSubpart;
+        }
+
+        /// Destructor
+        virtual ~TestConcaveMeshShape() {
+            delete mTriangleVertexArray1;
+            delete mTriangleVertexArray2;
+        }
+
+        /// Run the tests
+        void run() {
+
+            testPrecomputedTriangles();
+        }
+
+        void testPrecomputedTriangles() {
+
+            TriangleMeshBVH bvh(MemoryManager::getBaseAllocator());
+            bvh.build(mTriangleMesh);
+
+            CollisionWorld world;
+
+            const Vector3 scalings[2] = {Vector3(1, 1, 1), Vector3(2, decimal(0.5), -3)};
+            for (int s=0; s < 2; s++) {
+
+                ConcaveMeshShape shape(&mTriangleMesh, scalings[s]);
+                ConcaveMeshShape precomputedShape(&mTriangleMesh, scalings[s]);
+                ConcaveMeshShape cookedPrecomputedShape(&mTriangleMesh, &bvh, scalings[s]);
+                rp3d_test(!precomputedShape.arePrecomputedTrianglesEnabled());
+                precomputedShape.enablePrecomputedTriangles(true);
+                cookedPrecomputedShape.enablePrecomputedTriangles(true);
+                rp3d_test(precomputedShape.arePrecomputedTrianglesEnabled());
+                rp3d_test(cookedPrecomputedShape.arePrecomputedTrianglesEnabled());
+
+                // The precomputed triangles are the decoded and scaled triangles of the mesh
+                Vector3 min, max;
+                shape.getLocalBounds(min, max);
+                const AABB meshAABB(min - Vector3(1, 1, 1), max + Vector3(1, 1, 1));
+                ReportedTrianglesCallback callback;
+                ReportedTrianglesCallback precomputedCallback;
+                ReportedTrianglesCallback cookedPrecomputedCallback;
+                shape.testAllTriangles(callback, meshAABB);
+                precomputedShape.testAllTriangles(precomputedCallback, meshAABB);
+                cookedPrecomputedShape.testAllTriangles(cookedPrecomputedCallback, meshAABB);
+                rp3d_test(callback.triangles.size() == mNbTriangles);
+                rp3d_test(precomputedCallback.triangles.size() == mNbTriangles);
+                rp3d_test(cookedPrecomputedCallback.triangles.size() == mNbTriangles);
+
+                bool areTrianglesEqual = true;
+                for (auto it = callback.triangles.begin(); it != callback.triangles.end(); ++it) {
+                    const ReportedTriangle& triangle = it->second;
+                    const ReportedTriangle& precomputedTriangle = precomputedCallback.triangles[it->first];
+                    const ReportedTriangle& cookedPrecomputedTriangle = cookedPrecomputedCallback.triangles[it->first];
+                    for (int i=0; i < 3; i++) {
+                        areTrianglesEqual &= triangle.vertices[i] == precomputedTriangle.vertices[i];
+                        areTrianglesEqual &= triangle.verticesNormals[i] == precomputedTriangle.verticesNormals[i];
+                        areTrianglesEqual &= triangle.vertices[i] == cookedPrecomputedTriangle.vertices[i];
+                        areTrianglesEqual &= triangle.verticesNormals[i] == cookedPrecomputedTriangle.verticesNormals[i];
+                    }
+                }
+                rp3d_test(areTrianglesEqual);
+
+                // Raycasts
+                CollisionBody* body = world.createCollisionBody(Transform::identity());
+                CollisionBody* precomputedBody = world.createCollisionBody(Transform::identity());
+                ProxyShape* proxyShape = body->addCollisionShape(&shape, Transform::identity());
+                ProxyShape* precomputedProxyShape = precomputedBody->addCollisionShape(&precomputedShape, Transform::identity());
+                shape.setRaycastTestType(TriangleRaycastSide::FRONT_AND_BACK);
+                precomputedShape.setRaycastTestType(TriangleRaycastSide::FRONT_AND_BACK);
+
+                uint nbHits = 0;
+                for (int i=0; i <= 20; i++) {
+
+                    const decimal x = min.x + (max.x - min.x) * decimal(i) / decimal(20);
+                    const Ray ray(Vector3(x, max.y + 10, min.z), Vector3(max.x - x, min.y - 10, max.z));
+
+                    RaycastInfo raycastInfo;
+                    RaycastInfo precomputedRaycastInfo;
+                    const bool isHit = proxyShape->raycast(ray, raycastInfo);
+                    rp3d_test(isHit == precomputedProxyShape->raycast(ray, precomputedRaycastInfo));
+                    if (isHit) {
+                        nbHits++;
+                        rp3d_test(raycastInfo.hitFraction == precomputedRaycastInfo.hitFraction);
+                        rp3d_test(raycastInfo.meshSubpart == precomputedRaycastInfo.meshSubpart);
+                        rp3d_test(raycastInfo.triangleIndex == precomputedRaycastInfo.triangleIndex);
+                    }
+                }
+                rp3d_test(nbHits > 0);
+
+                // Disable the precomputed triangles
+                precomputedShape.enablePrecomputedTriangles(false);
+                rp3d_test(!precomputedShape.arePrecomputedTrianglesEnabled());
+                ReportedTrianglesCallback disabledCallback;
+                precomputedShape.testAllTriangles(disabledCallback, meshAABB);
+                rp3d_test(disabledCallback.triangles.size() == mNbTriangles);
+
+                world.destroyCollisionBody(body);
+                world.destroyCollisionBody(precomputedBody);
+            }
+        }
+ };
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 // Libraries
 #include "Test.h"
 #include "collision/broadphase/DynamicAABBTree.h"
+#include "collision/broadphase/WideAABBTree.h"
 #include "memory/MemoryManager.h"
 #include "utils/Profiler.h"
 
@@ -56,6 +57,23 @@ class TestOverlapCallback : public DynamicAABBTreeOverlapCallback {
         }
 };
 
+class TestOverlapPairCallback : public DynamicAABBTreeOverlapPairCallback {
+
+    public :
+
+        std::vector<std::pair<int, int>> mOverlapPairs;
+
+        // Called when a pair of overlapping leaves has been found during the call to
+        // DynamicAABBTree:reportOverlappingPairs()
+        virtual void notifyOverlappingPair(int nodeId1, int nodeId2) override {
+            mOverlapPairs.push_back(std::make_pair(std::min(nodeId1, nodeId2), std::max(nodeId1, nodeId2)));
+        }
+
+        void reset() {
+            mOverlapPairs.clear();
+        }
+};
+
 class DynamicTreeRaycastCallback : public DynamicAABBTreeRaycastCallback {
 
     public:
@@ -88,6 +106,7 @@ class TestDynamicAABBTree : public Test {
         // ---------- Atributes ---------- //
 
         TestOverlapCallback mOverlapCallback;
+        TestOverlapPairCallback mOverlapPairCallback;
         DynamicTreeRaycastCallback mRaycastCallback;
 
     public :
@@ -105,7 +124,12 @@ class TestDynamicAABBTree : public Test {
 
             testBasicsMethods();
             testOverlapping();
+            testOverlappingPairs();
             testRaycast();
+            testBuildTree();
+            testRebuild();
+            testWideTree();
+            testRefit();
 
         }
 
@@ -364,6 +388,89 @@ class TestDynamicAABBTree : public Test {
 #endif
         }
 
+        void testOverlappingPairs() {
+
+            // ------------- Create tree ----------- //
+
+            // Dynamic AABB Tree
+            DynamicAABBTree tree(MemoryManager::getBaseAllocator());
+
+#ifdef IS_PROFILING_ACTIVE
+            /// Pointer to the profiler
+            Profiler* profiler = new Profiler();
+            tree.setProfiler(profiler);
+#endif
+
+            // Add boxes at pseudo-random positions
+            const int nbObjects = 300;
+            int objectIds[nbObjects];
+            uint32 seed = 12345;
+            for (int i=0; i < nbObjects; i++) {
+                decimal coordinates[4];
+                for (int c=0; c < 4; c++) {
+                    seed = seed * 1664525u + 1013904223u;
+                    coordinates[c] = decimal(seed >> 8) / decimal(1 << 24);
+                }
+                const Vector3 min(coordinates[0] * 20, coordinates[1] * 20, coordinates[2] * 20);
+                const decimal size = decimal(0.5) + coordinates[3] * 2;
+                objectIds[i] = tree.addObject(AABB(min, min + Vector3(size, size, size)), nullptr);
+            }
+
+            // Mark one object out of three
+            std::vector<bool> isObjectMarked(nbObjects);
+            bool* isNodeMarked = new bool[tree.getNbAllocatedNodes()];
+            std::fill(isNodeMarked, isNodeMarked + tree.getNbAllocatedNodes(), false);
+            for (int i=0; i < nbObjects; i++) {
+                isObjectMarked[i] = i % 3 == 0;
+                if (isObjectMarked[i]) {
+                    tree.markLeafAndAncestors(objectIds[i], isNodeMarked);
+                }
+            }
+
+            // Compute the expected overlapping pairs with a marked object
+            std::vector<std::pair<int, int>> expectedPairs;
+            for (int i=0; i < nbObjects; i++) {
+                for (int j=i+1; j < nbObjects; j++) {
+                    if ((isObjectMarked[i] || isObjectMarked[j]) &&
+                        tree.getFatAABB(objectIds[i]).testCollision(tree.getFatAABB(objectIds[j]))) {
+                        expectedPairs.push_back(std::make_pair(std::min(objectIds[i], objectIds[j]),
+                                                               std::max(objectIds[i], objectIds[j])));
+                    }
+                }
+            }
+            std::sort(expectedPairs.begin(), expectedPairs.end());
+            rp3d_test(expectedPairs.size() > 0);
+
+            // ------------- Test all the pairs in a single traversal ----------- //
+
+            mOverlapPairCallback.reset();
+            tree.reportAllOverlappingPairs(isNodeMarked, mOverlapPairCallback);
+            std::vector<std::pair<int, int>> reportedPairs = mOverlapPairCallback.mOverlapPairs;
+
+            // Each pair must be reported exactly once
+            std::sort(mOverlapPairCallback.mOverlapPairs.begin(), mOverlapPairCallback.mOverlapPairs.end());
+            rp3d_test(mOverlapPairCallback.mOverlapPairs == expectedPairs);
+
+            // ------------- Test the pairs of the traversal tasks ----------- //
+
+            List<TreeNodePair> tasks(MemoryManager::getBaseAllocator());
+            tree.computeOverlappingPairsTasks(isNodeMarked, 16, tasks);
+            rp3d_test(tasks.size() >= 16);
+
+            // The tasks must report the same pairs in the same order
+            mOverlapPairCallback.reset();
+            for (uint i=0; i < tasks.size(); i++) {
+                tree.reportOverlappingPairs(tasks[i], isNodeMarked, mOverlapPairCallback, MemoryManager::getBaseAllocator());
+            }
+            rp3d_test(mOverlapPairCallback.mOverlapPairs == reportedPairs);
+
+            delete[] isNodeMarked;
+
+#ifdef IS_PROFILING_ACTIVE
+            delete profiler;
+#endif
+        }
+
         void testRaycast() {
 
             // ------------- Create tree ----------- //
@@ -542,6 +649,320 @@ class TestDynamicAABBTree : public Test {
 
 #ifdef IS_PROFILING_ACTIVE
 			delete profiler;
+#endif
+        }
+        void testBuildTree() {
+
+            // ------------- Create tree ----------- //
+
+            // Dynamic AABB Tree
+            DynamicAABBTree tree(MemoryManager::getBaseAllocator());
+
+#ifdef IS_PROFILING_ACTIVE
+            /// Pointer to the profiler
+            Profiler* profiler = new Profiler();
+            tree.setProfiler(profiler);
+#endif
+
+            // Create boxes at pseudo-random positions
+            const int nbObjects = 300;
+            std::vector<AABB> aabbs;
+            std::vector<int32> data1(nbObjects);
+            std::vector<int32> data2(nbObjects);
+            uint32 seed = 6789;
+            for (int i=0; i < nbObjects; i++) {
+                decimal coordinates[4];
+                for (int c=0; c < 4; c++) {
+                    seed = seed * 1664525u + 1013904223u;
+                    coordinates[c] = decimal(seed >> 8) / decimal(1 << 24);
+                }
+                const Vector3 min(coordinates[0] * 20, coordinates[1] * 20, coordinates[2] * 20);
+                const decimal size = decimal(0.5) + coordinates[3] * 2;
+                aabbs.push_back(AABB(min, min + Vector3(size, size, size)));
+                data1[i] = i;
+                data2[i] = 2 * i;
+            }
+
+            // ------------- Build the tree ----------- //
+
+            int objectIds[nbObjects];
+            tree.buildTree(&(aabbs[0]), &(data1[0]), &(data2[0]), nbObjects, objectIds);
+
+            // The root is the first node and the other nodes follow it in the array
+            for (int i=0; i < nbObjects; i++) {
+                rp3d_test(tree.getNodeDataInt(objectIds[i])[0] == i);
+                rp3d_test(tree.getNodeDataInt(objectIds[i])[1] == 2 * i);
+                rp3d_test(objectIds[i] > 0 && objectIds[i] < 2 * nbObjects - 1);
+            }
+
+            // The queries must report the same objects as a brute-force test
+            const AABB queryAABB(Vector3(4, 4, 4), Vector3(12, 9, 15));
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(queryAABB, mOverlapCallback);
+            for (int i=0; i < nbObjects; i++) {
+                rp3d_test(mOverlapCallback.isOverlapping(objectIds[i]) == queryAABB.testCollision(aabbs[i]));
+            }
+
+            // The SAH build must give a better tree than the insertion of the objects one by one
+            DynamicAABBTree insertedTree(MemoryManager::getBaseAllocator());
+            for (int i=0; i < nbObjects; i++) {
+                insertedTree.addObject(aabbs[i], data1[i], data2[i]);
+            }
+            rp3d_test(tree.computeSAHCost() > decimal(0.0));
+            rp3d_test(tree.computeSAHCost() < insertedTree.computeSAHCost());
+
+            // Objects can still be added and removed after a build
+            int newObjectId = tree.addObject(AABB(Vector3(-5, -5, -5), Vector3(-4, -4, -4)), 7, 8);
+            tree.removeObject(objectIds[10]);
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(AABB(Vector3(-6, -6, -6), Vector3(-3, -3, -3)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 1);
+            rp3d_test(mOverlapCallback.isOverlapping(newObjectId));
+
+            // Building the tree with no object must give an empty tree
+            tree.buildTree(nullptr, nullptr, nullptr, 0);
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(queryAABB, mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 0);
+
+#ifdef IS_PROFILING_ACTIVE
+            delete profiler;
+#endif
+        }
+
+        void testRebuild() {
+
+            // ------------- Create tree ----------- //
+
+            // Dynamic AABB Tree
+            DynamicAABBTree tree(MemoryManager::getBaseAllocator());
+
+#ifdef IS_PROFILING_ACTIVE
+            /// Pointer to the profiler
+            Profiler* profiler = new Profiler();
+            tree.setProfiler(profiler);
+#endif
+
+            // Insert boxes sorted along the x axis (this gives a poor tree)
+            const int nbObjects = 200;
+            int objectIds[nbObjects];
+            for (int i=0; i < nbObjects; i++) {
+                const Vector3 min(decimal(i % 50), decimal(i / 50) * 3, decimal((i * 7) % 11));
+                objectIds[i] = tree.addObject(AABB(min, min + Vector3(1, 1, 1)), i, 0);
+            }
+            for (int i=0; i < nbObjects; i += 4) {
+                tree.removeObject(objectIds[i]);
+                objectIds[i] = -1;
+            }
+
+            const AABB queryAABB(Vector3(10, 2, 3), Vector3(30, 7, 6));
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(queryAABB, mOverlapCallback);
+            std::vector<int> overlapNodesBefore = mOverlapCallback.mOverlapNodes;
+            std::sort(overlapNodesBefore.begin(), overlapNodesBefore.end());
+            rp3d_test(overlapNodesBefore.size() > 0);
+
+            const decimal costBefore = tree.computeSAHCost();
+
+            // ------------- Rebuild the tree ----------- //
+
+            // A tree that has never been built is always rebuilt
+            rp3d_test(tree.rebuildIfDegraded(decimal(1.5)));
+            rp3d_test(tree.computeSAHCost() < costBefore);
+
+            // The leaves must keep their node IDs and data
+            for (int i=0; i < nbObjects; i++) {
+                if (objectIds[i] != -1) {
+                    rp3d_test(tree.getNodeDataInt(objectIds[i])[0] == i);
+                }
+            }
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(queryAABB, mOverlapCallback);
+            std::sort(mOverlapCallback.mOverlapNodes.begin(), mOverlapCallback.mOverlapNodes.end());
+            rp3d_test(mOverlapCallback.mOverlapNodes == overlapNodesBefore);
+
+            // The tree has not degraded since its last rebuild
+            rp3d_test(!tree.rebuildIfDegraded(decimal(1.5)));
+
+            // Objects can still be updated after a rebuild
+            tree.updateObject(objectIds[1], AABB(Vector3(-10, -10, -10), Vector3(-9, -9, -9)), Vector3::zero());
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(AABB(Vector3(-11, -11, -11), Vector3(-8, -8, -8)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 1);
+            rp3d_test(mOverlapCallback.isOverlapping(objectIds[1]));
+
+#ifdef IS_PROFILING_ACTIVE
+            delete profiler;
+#endif
+        }
+
+        void testWideTree() {
+
+            // ------------- Create trees ----------- //
+
+            // Dynamic AABB Tree
+            DynamicAABBTree tree(MemoryManager::getBaseAllocator());
+            WideAABBTree wideTree(MemoryManager::getBaseAllocator());
+
+#ifdef IS_PROFILING_ACTIVE
+            /// Pointer to the profiler
+            Profiler* profiler = new Profiler();
+            tree.setProfiler(profiler);
+            wideTree.setProfiler(profiler);
+#endif
+
+            // Queries in an empty wide tree
+            wideTree.build(tree);
+            rp3d_test(wideTree.getNbNodes() == 0);
+            mOverlapCallback.reset();
+            wideTree.reportAllShapesOverlappingWithAABB(AABB(Vector3(-1, -1, -1), Vector3(1, 1, 1)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 0);
+
+            // Queries in a wide tree with a single leaf
+            int objectId = tree.addObject(AABB(Vector3(0, 0, 0), Vector3(1, 1, 1)), nullptr);
+            wideTree.build(tree);
+            rp3d_test(wideTree.getNbNodes() == 1);
+            mOverlapCallback.reset();
+            wideTree.reportAllShapesOverlappingWithAABB(AABB(Vector3(-1, -1, -1), Vector3(0.5, 0.5, 0.5)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 1);
+            rp3d_test(mOverlapCallback.isOverlapping(objectId));
+            mRaycastCallback.reset();
+            wideTree.raycast(Ray(Vector3(-5, 0.5, 0.5), Vector3(5, 0.5, 0.5)), mRaycastCallback);
+            rp3d_test(mRaycastCallback.isHit(objectId));
+            tree.removeObject(objectId);
+
+            // Add boxes at pseudo-random positions
+            const int nbObjects = 500;
+            uint32 seed = 2468;
+            for (int i=0; i < nbObjects; i++) {
+                decimal coordinates[4];
+                for (int c=0; c < 4; c++) {
+                    seed = seed * 1664525u + 1013904223u;
+                    coordinates[c] = decimal(seed >> 8) / decimal(1 << 24);
+                }
+                const Vector3 min(coordinates[0] * 30, coordinates[1] * 30, coordinates[2] * 30);
+                const decimal size = decimal(0.5) + coordinates[3] * 2;
+                tree.addObject(AABB(min, min + Vector3(size, size, size)), nullptr);
+            }
+            wideTree.build(tree);
+            rp3d_test(wideTree.getNbNodes() > 0);
+            rp3d_test(wideTree.getNbNodes() < nbObjects / 2);
+
+            // ------------- Test the AABB queries ----------- //
+
+            for (int q=0; q < 20; q++) {
+
+                const decimal offset = decimal(q) * decimal(1.5);
+                const AABB queryAABB(Vector3(offset, 2, offset / 2), Vector3(offset + 6, 12, offset / 2 + 8));
+
+                mOverlapCallback.reset();
+                tree.reportAllShapesOverlappingWithAABB(queryAABB, mOverlapCallback);
+                std::vector<int> expectedNodes = mOverlapCallback.mOverlapNodes;
+                std::sort(expectedNodes.begin(), expectedNodes.end());
+
+                mOverlapCallback.reset();
+                wideTree.reportAllShapesOverlappingWithAABB(queryAABB, mOverlapCallback);
+                std::sort(mOverlapCallback.mOverlapNodes.begin(), mOverlapCallback.mOverlapNodes.end());
+                rp3d_test(mOverlapCallback.mOverlapNodes == expectedNodes);
+            }
+
+            // ------------- Test the raycasts ----------- //
+
+            for (int r=0; r < 20; r++) {
+
+                const decimal offset = decimal(r) * decimal(1.5);
+                const Ray ray(Vector3(-10, offset, 30 - offset), Vector3(40, 30 - offset, offset), decimal(0.8));
+
+                mRaycastCallback.reset();
+                tree.raycast(ray, mRaycastCallback);
+                std::vector<int> expectedNodes = mRaycastCallback.mHitNodes;
+                std::sort(expectedNodes.begin(), expectedNodes.end());
+
+                mRaycastCallback.reset();
+                wideTree.raycast(ray, mRaycastCallback);
+                std::sort(mRaycastCallback.mHitNodes.begin(), mRaycastCallback.mHitNodes.end());
+                rp3d_test(mRaycastCallback.mHitNodes == expectedNodes);
+            }
+
+            // Axis-aligned rays
+            for (int r=0; r < 10; r++) {
+
+                const decimal offset = decimal(r) * decimal(3.1);
+                const Ray ray(Vector3(offset, offset, -5), Vector3(offset, offset, 40));
+
+                mRaycastCallback.reset();
+                tree.raycast(ray, mRaycastCallback);
+                std::vector<int> expectedNodes = mRaycastCallback.mHitNodes;
+                std::sort(expectedNodes.begin(), expectedNodes.end());
+
+                mRaycastCallback.reset();
+                wideTree.raycast(ray, mRaycastCallback);
+                std::sort(mRaycastCallback.mHitNodes.begin(), mRaycastCallback.mHitNodes.end());
+                rp3d_test(mRaycastCallback.mHitNodes == expectedNodes);
+            }
+
+#ifdef IS_PROFILING_ACTIVE
+            delete profiler;
+#endif
+        }
+
+        void testRefit() {
+
+            // ------------- Create tree ----------- //
+
+            // Dynamic AABB Tree
+            DynamicAABBTree tree(MemoryManager::getBaseAllocator());
+
+#ifdef IS_PROFILING_ACTIVE
+            /// Pointer to the profiler
+            Profiler* profiler = new Profiler();
+            tree.setProfiler(profiler);
+#endif
+
+            const int nbObjects = 100;
+            int objectIds[nbObjects];
+            for (int i=0; i < nbObjects; i++) {
+                const Vector3 min(decimal(i % 10) * 2, decimal(i / 10) * 2, 0);
+                objectIds[i] = tree.addObject(AABB(min, min + Vector3(1, 1, 1)), i, 0);
+            }
+
+            // ------------- Refit objects ----------- //
+
+            // An object that stays inside its fat AABB is not refitted
+            rp3d_test(!tree.refitObject(objectIds[0], AABB(Vector3(0, 0, 0), Vector3(1, 1, 1)), Vector3::zero()));
+
+            // Move an object far away (the ancestors are enlarged right away)
+            const AABB farAABB(Vector3(100, 100, 100), Vector3(101, 101, 101));
+            rp3d_test(tree.refitObject(objectIds[5], farAABB, Vector3::zero()));
+            rp3d_test(tree.getRootAABB().contains(farAABB));
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(AABB(Vector3(99, 99, 99), Vector3(102, 102, 102)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 1);
+            rp3d_test(mOverlapCallback.isOverlapping(objectIds[5]));
+
+            // Move it back and refit the tree (the root AABB must shrink again)
+            const AABB backAABB(Vector3(10, 0, 0), Vector3(11, 1, 1));
+            rp3d_test(tree.refitObject(objectIds[5], backAABB, Vector3::zero(), true));
+            rp3d_test(tree.getRootAABB().contains(farAABB));
+            tree.refitTree();
+            rp3d_test(!tree.getRootAABB().contains(farAABB));
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(AABB(Vector3(9, -1, -1), Vector3(12, 2, 2)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.isOverlapping(objectIds[5]));
+
+            // Objects removed after a refit are ignored by the next refit of the tree
+            rp3d_test(tree.refitObject(objectIds[7], farAABB, Vector3::zero()));
+            rp3d_test(tree.refitObject(objectIds[8], AABB(Vector3(50, 0, 0), Vector3(51, 1, 1)), Vector3::zero()));
+            tree.removeObject(objectIds[7]);
+            tree.refitTree();
+            rp3d_test(!tree.getRootAABB().contains(farAABB));
+            mOverlapCallback.reset();
+            tree.reportAllShapesOverlappingWithAABB(AABB(Vector3(49, -1, -1), Vector3(52, 2, 2)), mOverlapCallback);
+            rp3d_test(mOverlapCallback.mOverlapNodes.size() == 1);
+            rp3d_test(mOverlapCallback.isOverlapping(objectIds[8]));
+
+#ifdef IS_PROFILING_ACTIVE
+            delete profiler;
 #endif
         }
  };
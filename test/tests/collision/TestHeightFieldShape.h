@@ -0,0 +1,317 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_HEIGHT_FIELD_SHAPE_H
+#define TEST_HEIGHT_FIELD_SHAPE_H
+
+// Libraries
+#include "reactphysics3d.h"
+#include <vector>
+#include <map>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class HeightFieldTrianglesCallback
+/**
+ * Triangle callback that collects the AABBs of the reported triangles of a height field
+ */
+class HeightFieldTrianglesCallback : public TriangleCallback {
+
+    public:
+
+        /// AABBs of the reported triangles for each shape ID
+        std::map<uint, AABB> triangles;
+
+        /// Report a triangle
+        virtual void testTriangle(const Vector3* trianglePoints, const Vector3* verticesNormals, uint shapeId) override {
+            triangles[shapeId] = AABB::createAABBForTriangle(trianglePoints);
+        }
+};
+
+// Class TestHeightFieldShape
+/**
+ * Unit test for the HeightFieldShape class
+ */
+class TestHeightFieldShape : public Test {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of columns of the grid
+        static const int NB_COLUMNS = 35;
+
+        /// Number of rows of the grid
+        static const int NB_ROWS = 19;
+
+        /// Number of random rays for each height field
+        static const int NB_RAYS = 400;
+
+        // ---------- Atributes ---------- //
+
+        /// Height values of the grid
+        std::vector<float> mHeights;
+
+        /// Seed of the pseudo-random numbers
+        uint32 mSeed;
+
+        // ---------- Methods ---------- //
+
+        /// Return a pseudo-random number between zero and one
+        decimal random() {
+            mSeed = mSeed * 1664525u + 1013904223u;
+            return decimal(mSeed >> 8) / decimal(1 << 24);
+        }
+
+        /// Return a pseudo-random point between two points
+        Vector3 randomPoint(const Vector3& min, const Vector3& max) {
+            const Vector3 extent = max - min;
+            return min + Vector3(random() * extent.x, random() * extent.y, random() * extent.z);
+        }
+
+        /// Raycast the triangles of a height field whose grid coordinates overlap the AABB of the ray
+        static bool raycastAllTriangles(const HeightFieldShape& shape, ProxyShape* proxyShape,
+                                        const Ray& ray, RaycastInfo& raycastInfo) {
+
+            TriangleOverlapCallback callback(ray, proxyShape, raycastInfo, shape, MemoryManager::getBaseAllocator());
+            const Vector3 rayEnd = ray.point1 + ray.maxFraction * (ray.point2 - ray.point1);
+            shape.testAllTriangles(callback, AABB(Vector3::min(ray.point1, rayEnd), Vector3::max(ray.point1, rayEnd)));
+
+            return callback.getIsHit();
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestHeightFieldShape(const std::string& name) : Test(name), mSeed(2468) {
+
+            // Create a bumpy terrain
+            for (int j=0; j < NB_ROWS; j++) {
+                for (int i=0; i < NB_COLUMNS; i++) {
+                    mHeights.push_back(float((i * 7 + j * 3) % 5) + 0.3f * float((i * j) % 3) + (i > 20 ? 6.0f : 0.0f));
+                }
+            }
+        }
+
+        /// Run the tests
+        void run() {
+
+            testRaycast();
+            testMinMaxHeightHierarchy();
+        }
+
+        void testRaycast() {
+
+            CollisionWorld world;
+
+            const Vector3 scalings[3] = {Vector3(1, 1, 1), Vector3(2, 0.5, 3), Vector3(0.25, 4, 1.5)};
+
+            for (int upAxis=0; upAxis < 3; upAxis++) {
+                for (int s=0; s < 3; s++) {
+
+                    HeightFieldShape shape(NB_COLUMNS, NB_ROWS, 0, 11, &(mHeights[0]),
+                                           HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE, upAxis, 1, scalings[s]);
+                    CollisionBody* body = world.createCollisionBody(Transform::identity());
+                    ProxyShape* proxyShape = body->addCollisionShape(&shape, Transform::identity());
+
+                    // Same height field with the min/max height hierarchy
+                    HeightFieldShape hierarchyShape(NB_COLUMNS, NB_ROWS, 0, 11, &(mHeights[0]),
+                                                    HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE, upAxis, 1, scalings[s]);
+                    hierarchyShape.enableMinMaxHeightHierarchy(true);
+                    CollisionBody* hierarchyBody = world.createCollisionBody(Transform::identity());
+                    ProxyShape* hierarchyProxyShape = hierarchyBody->addCollisionShape(&hierarchyShape, Transform::identity());
+
+                    Vector3 min, max;
+                    shape.getLocalBounds(min, max);
+                    const Vector3 extent = max - min;
+
+                    int nbHits = 0;
+                    int nbSameResults = 0;
+                    int nbSameHierarchyResults = 0;
+                    for (int r=0; r < NB_RAYS; r++) {
+
+                        // Ray from a point outside the height field or from a point above the terrain
+                        Vector3 point1 = randomPoint(min - extent, max + extent);
+                        if (r % 4 == 0) {
+                            point1 = randomPoint(min, max);
+                            point1[upAxis] = max[upAxis];
+                        }
+                        else {
+                            while (min.x <= point1.x && point1.x <= max.x && min.y <= point1.y && point1.y <= max.y &&
+                                   min.z <= point1.z && point1.z <= max.z) {
+                                point1 = randomPoint(min - extent, max + extent);
+                            }
+                        }
+                        Vector3 point2 = randomPoint(min, max);
+
+                        // Rays parallel to the axes of the grid
+                        if (r % 10 == 1) point2[(upAxis + 1) % 3] = point1[(upAxis + 1) % 3];
+                        if (r % 10 == 2) point2[(upAxis + 2) % 3] = point1[(upAxis + 2) % 3];
+                        if (r % 10 == 3) {
+                            point2[(upAxis + 1) % 3] = point1[(upAxis + 1) % 3];
+                            point2[(upAxis + 2) % 3] = point1[(upAxis + 2) % 3];
+                        }
+
+                        const Ray ray(point1, point2, r % 3 == 0 ? decimal(0.6) : decimal(1.0));
+
+                        RaycastInfo raycastInfo;
+                        RaycastInfo expectedRaycastInfo;
+                        const bool isHit = proxyShape->raycast(ray, raycastInfo);
+                        const bool isExpectedHit = raycastAllTriangles(shape, proxyShape, ray, expectedRaycastInfo);
+
+                        RaycastInfo hierarchyRaycastInfo;
+                        const bool isHierarchyHit = hierarchyProxyShape->raycast(ray, hierarchyRaycastInfo);
+                        if (isHierarchyHit == isHit && (!isHit ||
+                            approxEqual(raycastInfo.hitFraction, hierarchyRaycastInfo.hitFraction, decimal(0.0001)))) {
+                            nbSameHierarchyResults++;
+                        }
+
+                        if (isHit == isExpectedHit && (!isHit ||
+                            (approxEqual(raycastInfo.hitFraction, expectedRaycastInfo.hitFraction, decimal(0.0001)) &&
+                             approxEqual(raycastInfo.worldPoint, expectedRaycastInfo.worldPoint, decimal(0.001)) &&
+                             raycastInfo.proxyShape == proxyShape))) {
+                            nbSameResults++;
+                        }
+                        if (isHit) nbHits++;
+                    }
+
+                    rp3d_test(nbSameResults == NB_RAYS);
+                    rp3d_test(nbSameHierarchyResults == NB_RAYS);
+                    rp3d_test(nbHits > NB_RAYS / 5);
+
+                    world.destroyCollisionBody(body);
+                    world.destroyCollisionBody(hierarchyBody);
+                }
+            }
+
+            // Long diagonal ray above a flat terrain that hits a single bump at its end (without and with the hierarchy)
+            for (int r=0; r < 2; r++) {
+                std::vector<float> flatHeights(NB_COLUMNS * NB_ROWS, 1.0f);
+                flatHeights[(NB_ROWS - 2) * NB_COLUMNS + NB_COLUMNS - 2] = 5.0f;
+                HeightFieldShape flatShape(NB_COLUMNS, NB_ROWS, 0, 5, &(flatHeights[0]),
+                                           HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE);
+                flatShape.enableMinMaxHeightHierarchy(r == 1);
+                CollisionBody* body = world.createCollisionBody(Transform::identity());
+                ProxyShape* proxyShape = body->addCollisionShape(&flatShape, Transform::identity());
+
+                const decimal halfWidth = decimal(NB_COLUMNS - 1) * decimal(0.5);
+                const decimal halfLength = decimal(NB_ROWS - 1) * decimal(0.5);
+                Ray ray(Vector3(-halfWidth - 1, decimal(-0.5), -halfLength - 1), Vector3(halfWidth + 1, decimal(-0.5), halfLength + 1));
+                RaycastInfo raycastInfo;
+                rp3d_test(proxyShape->raycast(ray, raycastInfo));
+                rp3d_test(raycastInfo.worldPoint.x > halfWidth - 2 && raycastInfo.worldPoint.z > halfLength - 2);
+
+                // The ray stops before the bump
+                ray.maxFraction = decimal(0.8);
+                rp3d_test(!proxyShape->raycast(ray, raycastInfo));
+
+                // Vertical ray
+                rp3d_test(proxyShape->raycast(Ray(Vector3(decimal(0.3), 10, decimal(0.7)), Vector3(decimal(0.3), -10, decimal(0.7))), raycastInfo));
+                rp3d_test(approxEqual(raycastInfo.worldPoint, Vector3(decimal(0.3), decimal(-1.5), decimal(0.7))));
+                rp3d_test(approxEqual(raycastInfo.worldNormal, Vector3(0, 1, 0)));
+
+                world.destroyCollisionBody(body);
+            }
+        }
+
+        void testMinMaxHeightHierarchy() {
+
+            HeightFieldShape shape(NB_COLUMNS, NB_ROWS, 0, 11, &(mHeights[0]),
+                                   HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE, 1, 1, Vector3(2, decimal(0.5), 3));
+            HeightFieldShape hierarchyShape(NB_COLUMNS, NB_ROWS, 0, 11, &(mHeights[0]),
+                                            HeightFieldShape::HeightDataType::HEIGHT_FLOAT_TYPE, 1, 1, Vector3(2, decimal(0.5), 3));
+
+            rp3d_test(!hierarchyShape.isMinMaxHeightHierarchyEnabled());
+            hierarchyShape.enableMinMaxHeightHierarchy(true);
+            rp3d_test(hierarchyShape.isMinMaxHeightHierarchyEnabled());
+            hierarchyShape.enableMinMaxHeightHierarchy(false);
+            rp3d_test(!hierarchyShape.isMinMaxHeightHierarchyEnabled());
+            hierarchyShape.enableMinMaxHeightHierarchy(true);
+
+            Vector3 min, max;
+            shape.getLocalBounds(min, max);
+            const Vector3 extent = max - min;
+
+            // The triangles reported with the hierarchy are the triangles that overlap the AABB
+            bool areTrianglesCorrect = true;
+            int nbRejectedTriangles = 0;
+            for (int q=0; q < 300; q++) {
+
+                const Vector3 aabbMin = randomPoint(min - extent * decimal(0.1), max);
+                const Vector3 aabbSize = Vector3(random() * extent.x, random() * extent.y, random() * extent.z) * decimal(0.3);
+                const AABB aabb(aabbMin, aabbMin + aabbSize);
+
+                HeightFieldTrianglesCallback callback;
+                HeightFieldTrianglesCallback hierarchyCallback;
+                shape.testAllTriangles(callback, aabb);
+                hierarchyShape.testAllTriangles(hierarchyCallback, aabb);
+
+                for (auto it = callback.triangles.begin(); it != callback.triangles.end(); ++it) {
+                    const bool isReported = hierarchyCallback.triangles.find(it->first) != hierarchyCallback.triangles.end();
+                    if (!isReported) nbRejectedTriangles++;
+                    if (it->second.testCollision(aabb) && !isReported) areTrianglesCorrect = false;
+                }
+                for (auto it = hierarchyCallback.triangles.begin(); it != hierarchyCallback.triangles.end(); ++it) {
+                    if (callback.triangles.find(it->first) == callback.triangles.end()) areTrianglesCorrect = false;
+                }
+            }
+            rp3d_test(areTrianglesCorrect);
+            rp3d_test(nbRejectedTriangles > 0);
+
+            // The bounds of the regions of the grid contain all their vertices
+            bool areBoundsCorrect = true;
+            for (int r=0; r < 200; r++) {
+
+                const int minColumn = static_cast<int>(random() * (NB_COLUMNS - 1));
+                const int minRow = static_cast<int>(random() * (NB_ROWS - 1));
+                const int maxColumn = minColumn + 1 + static_cast<int>(random() * (NB_COLUMNS - 1 - minColumn));
+                const int maxRow = minRow + 1 + static_cast<int>(random() * (NB_ROWS - 1 - minRow));
+
+                Vector3 expectedMin = shape.getVertexAt(minColumn, minRow);
+                Vector3 expectedMax = expectedMin;
+                for (int i = minColumn; i <= maxColumn; i++) {
+                    for (int j = minRow; j <= maxRow; j++) {
+                        expectedMin = Vector3::min(expectedMin, shape.getVertexAt(i, j));
+                        expectedMax = Vector3::max(expectedMax, shape.getVertexAt(i, j));
+                    }
+                }
+
+                Vector3 regionMin, regionMax, hierarchyRegionMin, hierarchyRegionMax;
+                shape.getRegionLocalBounds(minColumn, minRow, maxColumn, maxRow, regionMin, regionMax);
+                hierarchyShape.getRegionLocalBounds(minColumn, minRow, maxColumn, maxRow, hierarchyRegionMin, hierarchyRegionMax);
+
+                areBoundsCorrect &= approxEqual(regionMin, expectedMin) && approxEqual(regionMax, expectedMax);
+                areBoundsCorrect &= approxEqual(hierarchyRegionMin, expectedMin) && approxEqual(hierarchyRegionMax, expectedMax);
+            }
+            rp3d_test(areBoundsCorrect);
+        }
+};
+
+}
+
+#endif
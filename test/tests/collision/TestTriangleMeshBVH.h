@@ -0,0 +1,382 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2019 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_TRIANGLE_MESH_BVH_H
+#define TEST_TRIANGLE_MESH_BVH_H
+
+// Libraries
+#include "reactphysics3d.h"
+#include <vector>
+#include <set>
+#include <cstring>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TriangleShapeIdsCallback
+/**
+ * Triangle callback that collects the shape IDs of the reported triangles
+ */
+class TriangleShapeIdsCallback : public TriangleCallback {
+
+    public:
+
+        /// Shape IDs of the reported triangles
+        std::set<uint> shapeIds;
+
+        /// Report a triangle
+        virtual void testTriangle(const Vector3* trianglePoints, const Vector3* verticesNormals, uint shapeId) override {
+            shapeIds.insert(shapeId);
+        }
+};
+
+// Class TestTriangleMeshBVH
+/**
+ * Unit test for the TriangleMeshBVH class
+ */
+class TestTriangleMeshBVH : public Test {
+
+    private :
+
+        // ---------- Constants ---------- //
+
+        /// Number of vertices of a sub-part of the mesh along each axis
+        static const int NB_VERTICES_PER_SIDE = 16;
+
+        // ---------- Atributes ---------- //
+
+        /// Vertices of the two sub-parts of the mesh
+        std::vector<Vector3> mVertices[2];
+
+        /// Indices of the two sub-parts of the mesh
+        std::vector<uint> mIndices[2];
+
+        /// Triangle vertex arrays of the two sub-parts of the mesh
+        TriangleVertexArray* mTriangleVertexArrays[2];
+
+        /// Triangle mesh
+        TriangleMesh mTriangleMesh;
+
+        /// Number of triangles of the mesh
+        uint mNbTriangles;
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestTriangleMeshBVH(const std::string& name) : Test(name) {
+
+            TriangleVertexArray::VertexDataType vertexType = sizeof(decimal) == 4 ? TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE :
+                                                                                    TriangleVertexArray::VertexDataType::VERTEX_DOUBLE_TYPE;
+
+            // Create two bumpy grids of triangles next to each other
+            mNbTriangles = 0;
+            for (int p=0; p < 2; p++) {
+
+                for (int i=0; i < NB_VERTICES_PER_SIDE; i++) {
+                    for (int j=0; j < NB_VERTICES_PER_SIDE; j++) {
+                        const decimal height = decimal((i * 7 + j * 3 + p) % 5);
+                        mVertices[p].push_back(Vector3(decimal(i + p * (NB_VERTICES_PER_SIDE - 1)), height, decimal(j)));
+                    }
+                }
+
+                for (int i=0; i < NB_VERTICES_PER_SIDE - 1; i++) {
+                    for (int j=0; j < NB_VERTICES_PER_SIDE - 1; j++) {
+                        const uint v0 = i * NB_VERTICES_PER_SIDE + j;
+                        const uint v1 = v0 + 1;
+                        const uint v2 = v0 + NB_VERTICES_PER_SIDE;
+                        const uint v3 = v2 + 1;
+                        mIndices[p].push_back(v0); mIndices[p].push_back(v1); mIndices[p].push_back(v2);
+                        mIndices[p].push_back(v1); mIndices[p].push_back(v3); mIndices[p].push_back(v2);
+                    }
+                }
+
+                const uint nbTriangles = static_cast<uint>(mIndices[p].size() / 3);
+                mTriangleVertexArrays[p] = new TriangleVertexArray(static_cast<uint>(mVertices[p].size()), &(mVertices[p][0]), sizeof(Vector3),
+                                                                   nbTriangles, &(mIndices[p][0]), 3 * sizeof(uint), vertexType,
+                                                                   TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+                mTriangleMesh.addSubpart(mTriangleVertexArrays[p]);
+                mNbTriangles += nbTriangles;
+            }
+        }
+
+        /// Destructor
+        virtual ~TestTriangleMeshBVH() {
+            delete mTriangleVertexArrays[0];
+            delete mTriangleVertexArrays[1];
+        }
+
+        /// Run the tests
+        void run() {
+
+            testBuild();
+            testSerialization();
+            testShapeQueries();
+        }
+
+        void testBuild() {
+
+            TriangleMeshBVH bvh(MemoryManager::getBaseAllocator());
+            rp3d_test(!bvh.isValid());
+            rp3d_test(bvh.getNbNodes() == 0);
+
+            bvh.build(mTriangleMesh);
+
+            rp3d_test(bvh.isValid());
+            rp3d_test(bvh.getNbTriangles() == mNbTriangles);
+            rp3d_test(bvh.getNbSubparts() == 2);
+            rp3d_test(bvh.getNbNodes() == 2 * mNbTriangles - 1);
+            rp3d_test(bvh.getSerializedSize() == sizeof(TriangleMeshBVHHeader) + 2 * sizeof(uint32) +
+                                                 bvh.getNbNodes() * sizeof(TriangleMeshBVHNode));
+            rp3d_test(bvh.getNbSubpartTriangles(0) + bvh.getNbSubpartTriangles(1) == mNbTriangles);
+            rp3d_test(bvh.isBuiltForMesh(mTriangleMesh));
+
+            // The bounds of the BVH are the bounds of the mesh
+            const AABB bounds = bvh.getBounds();
+            rp3d_test(approxEqual(bounds.getMin(), Vector3(0, 0, 0)));
+            rp3d_test(approxEqual(bounds.getMax(), Vector3(2 * (NB_VERTICES_PER_SIDE - 1), 4, NB_VERTICES_PER_SIDE - 1)));
+
+            // An AABB around the whole mesh reports each triangle once
+            ConcaveMeshShape shape(&mTriangleMesh, &bvh);
+            TriangleShapeIdsCallback callback;
+            shape.testAllTriangles(callback, AABB(Vector3(-1, -1, -1), Vector3(100, 100, 100)));
+            rp3d_test(callback.shapeIds.size() == mNbTriangles);
+
+            // Building a BVH for an empty mesh
+            TriangleMesh emptyMesh;
+            TriangleMeshBVH emptyBVH(MemoryManager::getBaseAllocator());
+            emptyBVH.build(emptyMesh);
+            rp3d_test(emptyBVH.isValid());
+            rp3d_test(emptyBVH.getNbNodes() == 0);
+            rp3d_test(emptyBVH.getNbTriangles() == 0);
+
+            // A BVH built for another mesh is not used by the shape
+            rp3d_test(!emptyBVH.isBuiltForMesh(mTriangleMesh));
+            ConcaveMeshShape otherMeshShape(&mTriangleMesh, &emptyBVH);
+            rp3d_test(otherMeshShape.getCookedBVH() == nullptr);
+            TriangleShapeIdsCallback otherMeshCallback;
+            otherMeshShape.testAllTriangles(otherMeshCallback, AABB(Vector3(-1, -1, -1), Vector3(100, 100, 100)));
+            rp3d_test(otherMeshCallback.shapeIds.size() == mNbTriangles);
+        }
+
+        void testSerialization() {
+
+            TriangleMeshBVH bvh(MemoryManager::getBaseAllocator());
+            bvh.build(mTriangleMesh);
+
+            // Copy the serialized data (as if it was saved into a file and mapped in memory)
+            const size_t size = bvh.getSerializedSize();
+            std::vector<uint32> buffer(size / sizeof(uint32) + 1);
+            std::memcpy(&(buffer[0]), bvh.getSerializedData(), size);
+
+            // Load the data without copying it
+            TriangleMeshBVH loadedBVH(MemoryManager::getBaseAllocator());
+            rp3d_test(loadedBVH.load(&(buffer[0]), size));
+            rp3d_test(loadedBVH.isValid());
+            rp3d_test(loadedBVH.getSerializedData() == &(buffer[0]));
+            rp3d_test(loadedBVH.getSerializedSize() == size);
+            rp3d_test(loadedBVH.getNbNodes() == bvh.getNbNodes());
+            rp3d_test(loadedBVH.getNbTriangles() == mNbTriangles);
+            rp3d_test(loadedBVH.getNbSubparts() == 2);
+            rp3d_test(approxEqual(loadedBVH.getBounds().getMin(), bvh.getBounds().getMin()));
+            rp3d_test(approxEqual(loadedBVH.getBounds().getMax(), bvh.getBounds().getMax()));
+
+            // Invalid data cannot be loaded
+            rp3d_test(!loadedBVH.load(nullptr, size));
+            rp3d_test(!loadedBVH.isValid());
+            rp3d_test(!loadedBVH.load(&(buffer[0]), size - 1));
+            rp3d_test(!loadedBVH.load(&(buffer[0]), sizeof(TriangleMeshBVHHeader) - 1));
+            rp3d_test(!loadedBVH.load(reinterpret_cast<const char*>(&(buffer[0])) + 1, size));
+
+            std::vector<uint32> corruptedBuffer(buffer);
+            corruptedBuffer[0] = 0;
+            rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+
+            corruptedBuffer = buffer;
+            corruptedBuffer[1]++;
+            rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+
+            // The number of triangles of the sub-parts must match the number of triangles
+            const size_t nodesOffset = (sizeof(TriangleMeshBVHHeader) + 2 * sizeof(uint32)) / sizeof(uint32);
+            const size_t nodeSize = sizeof(TriangleMeshBVHNode) / sizeof(uint32);
+            corruptedBuffer = buffer;
+            corruptedBuffer[nodesOffset - 1]++;
+            rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+
+            // Find the first internal node (the root) and a leaf of the tree
+            const TriangleMeshBVHNode* nodes = reinterpret_cast<const TriangleMeshBVHNode*>(&(buffer[nodesOffset]));
+            uint leafIndex = 0;
+            while (!nodes[leafIndex].isLeaf()) leafIndex++;
+            rp3d_test(!nodes[0].isLeaf());
+
+            // The children of an internal node must be valid nodes after it
+            const int32 invalidRightChildren[] = {0, 1, static_cast<int32>(bvh.getNbNodes()), -5};
+            for (int32 rightChild : invalidRightChildren) {
+                corruptedBuffer = buffer;
+                reinterpret_cast<TriangleMeshBVHNode*>(&(corruptedBuffer[nodesOffset]))[0].data[1] = rightChild;
+                rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+                rp3d_test(!loadedBVH.isValid());
+            }
+
+            // The right child of a node cannot be in the subtree of its left child
+            if (!nodes[1].isLeaf()) {
+                corruptedBuffer = buffer;
+                reinterpret_cast<TriangleMeshBVHNode*>(&(corruptedBuffer[nodesOffset]))[0].data[1] = 2;
+                rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+            }
+
+            // A leaf must reference an existing triangle of an existing sub-part
+            corruptedBuffer = buffer;
+            reinterpret_cast<TriangleMeshBVHNode*>(&(corruptedBuffer[nodesOffset + leafIndex * nodeSize]))->data[0] = 2;
+            rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+            corruptedBuffer = buffer;
+            reinterpret_cast<TriangleMeshBVHNode*>(&(corruptedBuffer[nodesOffset + leafIndex * nodeSize]))->data[1] =
+                    static_cast<int32>(mNbTriangles);
+            rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+            corruptedBuffer = buffer;
+            reinterpret_cast<TriangleMeshBVHNode*>(&(corruptedBuffer[nodesOffset + leafIndex * nodeSize]))->data[1] = -1;
+            rp3d_test(!loadedBVH.load(&(corruptedBuffer[0]), size));
+
+            rp3d_test(loadedBVH.load(&(buffer[0]), size));
+            rp3d_test(loadedBVH.isValid());
+
+            // Create the data of a tree where each internal node has a leaf as left child
+            // (the depth of the last leaf is the number of leaves minus one)
+            auto createChainData = [&buffer](uint32 nbLeaves) {
+                const uint32 nbNodes = 2 * nbLeaves - 1;
+                std::vector<uint32> data((sizeof(TriangleMeshBVHHeader) + sizeof(uint32) +
+                                          nbNodes * sizeof(TriangleMeshBVHNode)) / sizeof(uint32));
+                TriangleMeshBVHHeader* header = reinterpret_cast<TriangleMeshBVHHeader*>(&(data[0]));
+                *header = *reinterpret_cast<const TriangleMeshBVHHeader*>(&(buffer[0]));
+                header->nbNodes = nbNodes;
+                header->nbTriangles = nbLeaves;
+                header->nbSubparts = 1;
+                reinterpret_cast<uint32*>(header + 1)[0] = nbLeaves;
+                TriangleMeshBVHNode* chainNodes = reinterpret_cast<TriangleMeshBVHNode*>(reinterpret_cast<uint32*>(header + 1) + 1);
+                for (uint32 i=0; i < nbNodes; i++) {
+                    const bool isLeaf = i % 2 == 1 || i == nbNodes - 1;
+                    chainNodes[i].data[0] = isLeaf ? 0 : -1;
+                    chainNodes[i].data[1] = isLeaf ? static_cast<int32>(i / 2) : static_cast<int32>(i + 2);
+                }
+                return data;
+            };
+
+            // A tree deeper than the maximum depth cannot be loaded
+            std::vector<uint32> chainBuffer = createChainData(65);
+            rp3d_test(loadedBVH.load(&(chainBuffer[0]), chainBuffer.size() * sizeof(uint32)));
+            chainBuffer = createChainData(66);
+            rp3d_test(!loadedBVH.load(&(chainBuffer[0]), chainBuffer.size() * sizeof(uint32)));
+        }
+
+        void testShapeQueries() {
+
+            TriangleMeshBVH bvh(MemoryManager::getBaseAllocator());
+            bvh.build(mTriangleMesh);
+
+            const size_t size = bvh.getSerializedSize();
+            std::vector<uint32> buffer(size / sizeof(uint32) + 1);
+            std::memcpy(&(buffer[0]), bvh.getSerializedData(), size);
+            TriangleMeshBVH loadedBVH(MemoryManager::getBaseAllocator());
+            rp3d_test(loadedBVH.load(&(buffer[0]), size));
+
+            CollisionWorld world;
+
+            // Compare the shapes with their own tree and the shapes sharing the loaded BVH
+            const Vector3 scalings[3] = {Vector3(1, 1, 1), Vector3(2, decimal(0.5), 4), Vector3(decimal(-0.5), 2, 1)};
+            for (int s=0; s < 3; s++) {
+
+                ConcaveMeshShape shape(&mTriangleMesh, scalings[s]);
+                ConcaveMeshShape cookedShape(&mTriangleMesh, &loadedBVH, scalings[s]);
+                rp3d_test(shape.getCookedBVH() == nullptr);
+                rp3d_test(cookedShape.getCookedBVH() == &loadedBVH);
+
+                // Local bounds
+                Vector3 min, max, cookedMin, cookedMax;
+                shape.getLocalBounds(min, max);
+                cookedShape.getLocalBounds(cookedMin, cookedMax);
+                rp3d_test(approxEqual(min, cookedMin));
+                rp3d_test(approxEqual(max, cookedMax));
+
+                // AABB queries
+                uint32 seed = 42;
+                for (int i=0; i < 50; i++) {
+
+                    const Vector3 queryMin = randomPoint(min, max, seed);
+                    const AABB queryAABB(queryMin, queryMin + Vector3(3, 1, 2));
+
+                    TriangleShapeIdsCallback callback;
+                    TriangleShapeIdsCallback cookedCallback;
+                    shape.testAllTriangles(callback, queryAABB);
+                    cookedShape.testAllTriangles(cookedCallback, queryAABB);
+                    rp3d_test(callback.shapeIds == cookedCallback.shapeIds);
+                }
+
+                // Raycasts
+                CollisionBody* body = world.createCollisionBody(Transform::identity());
+                CollisionBody* cookedBody = world.createCollisionBody(Transform::identity());
+                ProxyShape* proxyShape = body->addCollisionShape(&shape, Transform::identity());
+                ProxyShape* cookedProxyShape = cookedBody->addCollisionShape(&cookedShape, Transform::identity());
+                shape.setRaycastTestType(TriangleRaycastSide::FRONT_AND_BACK);
+                cookedShape.setRaycastTestType(TriangleRaycastSide::FRONT_AND_BACK);
+
+                uint nbHits = 0;
+                for (int i=0; i < 50; i++) {
+
+                    const Ray ray(randomPoint(min, max, seed) + Vector3(0, 20, 0), randomPoint(min, max, seed) - Vector3(0, 20, 0));
+
+                    RaycastInfo raycastInfo;
+                    RaycastInfo cookedRaycastInfo;
+                    const bool isHit = proxyShape->raycast(ray, raycastInfo);
+                    rp3d_test(isHit == cookedProxyShape->raycast(ray, cookedRaycastInfo));
+                    if (isHit) {
+                        nbHits++;
+                        rp3d_test(approxEqual(raycastInfo.hitFraction, cookedRaycastInfo.hitFraction));
+                        rp3d_test(approxEqual(raycastInfo.worldPoint, cookedRaycastInfo.worldPoint));
+                        rp3d_test(raycastInfo.meshSubpart == cookedRaycastInfo.meshSubpart);
+                        rp3d_test(raycastInfo.triangleIndex == cookedRaycastInfo.triangleIndex);
+                    }
+                }
+                rp3d_test(nbHits > 0);
+
+                world.destroyCollisionBody(body);
+                world.destroyCollisionBody(cookedBody);
+            }
+        }
+
+        /// Return a pseudo-random point between two points
+        static Vector3 randomPoint(const Vector3& min, const Vector3& max, uint32& seed) {
+            Vector3 point;
+            for (int i=0; i < 3; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                point[i] = min[i] + (max[i] - min[i]) * decimal(seed >> 8) / decimal(1 << 24);
+            }
+            return point;
+        }
+ };
+
+}
+
+#endif
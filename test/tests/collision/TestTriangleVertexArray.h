@@ -28,6 +28,7 @@
 
 // Libraries
 #include "reactphysics3d.h"
+#include <vector>
 
 /// Reactphysics3D namespace
 namespace reactphysics3d {
@@ -251,6 +252,147 @@ class TestTriangleVertexArray : public Test {
             rp3d_test(approxEqual(triangle1Normals[0], mNormal0, decimal(0.000001)));
             rp3d_test(approxEqual(triangle1Normals[1], mNormal3, decimal(0.000001)));
             rp3d_test(approxEqual(triangle1Normals[2], mNormal1, decimal(0.000001)));
+
+            testCompression();
+        }
+
+        void testCompression() {
+
+            // Create the same arrays as the two arrays of the test
+            TriangleVertexArray array1(4, static_cast<const void*>(mVertices1), 3 * sizeof(float),
+                                       2, static_cast<const void*>(mIndices1), 3 * sizeof(uint),
+                                       TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
+                                       TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+            TriangleVertexArray array2(4, static_cast<const void*>(mVertices2), 3 * sizeof(double),
+                                       static_cast<const void*>(mNormals2), 3 * sizeof(float),
+                                       2, static_cast<const void*>(mIndices2), 3 * sizeof(short),
+                                       TriangleVertexArray::VertexDataType::VERTEX_DOUBLE_TYPE,
+                                       TriangleVertexArray::NormalDataType::NORMAL_FLOAT_TYPE,
+                                       TriangleVertexArray::IndexDataType::INDEX_SHORT_TYPE);
+
+            TriangleVertexArray* arrays[2] = {&array1, &array2};
+            TriangleVertexArray* originalArrays[2] = {mTriangleVertexArray1, mTriangleVertexArray2};
+
+            rp3d_test(array1.getDataSize() == 4 * 6 * sizeof(float) + 6 * sizeof(uint));
+            rp3d_test(array2.getDataSize() == 4 * (3 * sizeof(double) + 3 * sizeof(float)) + 6 * sizeof(short));
+            rp3d_test(!array1.isCompressed());
+            rp3d_test(array1.getQuantizationStep() == Vector3::zero());
+
+            for (int a=0; a < 2; a++) {
+
+                const size_t dataSize = arrays[a]->getDataSize();
+                arrays[a]->compress();
+
+                // The data of the user is not used anymore
+                rp3d_test(arrays[a]->isCompressed());
+                rp3d_test(arrays[a]->getVertexDataType() == TriangleVertexArray::VertexDataType::VERTEX_QUANTIZED_SHORT_TYPE);
+                rp3d_test(arrays[a]->getVertexNormalDataType() == TriangleVertexArray::NormalDataType::NORMAL_OCTAHEDRAL_SHORT_TYPE);
+                rp3d_test(arrays[a]->getIndexDataType() == TriangleVertexArray::IndexDataType::INDEX_SHORT_TYPE);
+                rp3d_test(arrays[a]->getVerticesStart() != originalArrays[a]->getVerticesStart());
+                rp3d_test(arrays[a]->getIndicesStart() != originalArrays[a]->getIndicesStart());
+                rp3d_test(arrays[a]->getDataSize() == 4 * (3 * sizeof(uint16) + 2 * sizeof(int16)) + 6 * sizeof(ushort));
+                rp3d_test(arrays[a]->getDataSize() < dataSize);
+
+                // The decoded triangles are close to the original ones
+                const Vector3 quantizationStep = arrays[a]->getQuantizationStep();
+                rp3d_test(quantizationStep.x > decimal(0.0) && quantizationStep.x < decimal(0.001));
+                const decimal maxError = quantizationStep.length() * decimal(0.5) + decimal(0.000001);
+                for (uint t=0; t < 2; t++) {
+
+                    uint indices[3], compressedIndices[3];
+                    Vector3 vertices[3], compressedVertices[3];
+                    Vector3 normals[3], compressedNormals[3];
+                    originalArrays[a]->getTriangleVerticesIndices(t, indices);
+                    originalArrays[a]->getTriangleVertices(t, vertices);
+                    originalArrays[a]->getTriangleVerticesNormals(t, normals);
+                    arrays[a]->getTriangleVerticesIndices(t, compressedIndices);
+                    arrays[a]->getTriangleVertices(t, compressedVertices);
+                    arrays[a]->getTriangleVerticesNormals(t, compressedNormals);
+
+                    for (int i=0; i < 3; i++) {
+                        rp3d_test(indices[i] == compressedIndices[i]);
+                        rp3d_test((vertices[i] - compressedVertices[i]).length() <= maxError);
+                        rp3d_test(approxEqual(compressedNormals[i].length(), decimal(1.0), decimal(0.00001)));
+                        rp3d_test(approxEqual(normals[i], compressedNormals[i], decimal(0.0002)));
+                    }
+                }
+
+                // Compressing again does not change anything
+                arrays[a]->compress();
+                rp3d_test(arrays[a]->getQuantizationStep() == quantizationStep);
+            }
+
+            // Normals of all the octants are encoded with a small error
+            std::vector<float> vertices;
+            std::vector<float> normals;
+            std::vector<uint> indices;
+            for (int i=0; i < 27; i++) {
+                Vector3 normal(decimal(i % 3) - 1, decimal((i / 3) % 3) - 1, decimal(i / 9) - 1);
+                if (normal.lengthSquare() < decimal(0.5)) normal.setAllValues(decimal(0.1), decimal(-0.3), decimal(-0.9));
+                normal.normalize();
+                vertices.push_back(float(i)); vertices.push_back(float(i % 5)); vertices.push_back(float(-i));
+                normals.push_back(float(normal.x)); normals.push_back(float(normal.y)); normals.push_back(float(normal.z));
+                indices.push_back(uint(i)); indices.push_back(uint((i + 1) % 27)); indices.push_back(uint((i + 2) % 27));
+            }
+            TriangleVertexArray array3(27, &(vertices[0]), 3 * sizeof(float), &(normals[0]), 3 * sizeof(float),
+                                       27, &(indices[0]), 3 * sizeof(uint),
+                                       TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
+                                       TriangleVertexArray::NormalDataType::NORMAL_FLOAT_TYPE,
+                                       TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+            array3.compress();
+            bool areNormalsClose = true;
+            for (uint v=0; v < 27; v++) {
+                Vector3 normal;
+                array3.getNormal(v, &normal);
+                const Vector3 originalNormal(normals[v * 3], normals[v * 3 + 1], normals[v * 3 + 2]);
+                areNormalsClose &= approxEqual(normal, originalNormal, decimal(0.0002));
+            }
+            rp3d_test(areNormalsClose);
+
+            testMeshCompression();
+        }
+
+        void testMeshCompression() {
+
+            // Two sub-parts with different bounds that share the vertex (0.3, 0.7, 0.1)
+            const float vertices1[] = {0.3f, 0.7f, 0.1f,  -1, 0, 0,  0, 0, -2};
+            const float vertices2[] = {0.3f, 0.7f, 0.1f,  5, 3, 0,  1, 0, 7};
+            const uint indices[] = {0, 1, 2};
+            TriangleVertexArray* arrays[4];
+            for (int a=0; a < 4; a++) {
+                arrays[a] = new TriangleVertexArray(3, a % 2 == 0 ? vertices1 : vertices2, 3 * sizeof(float),
+                                                    1, indices, 3 * sizeof(uint),
+                                                    TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
+                                                    TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE);
+            }
+
+            // Compressed separately, each sub-part is quantized in its own bounds
+            arrays[0]->compress();
+            arrays[1]->compress();
+            rp3d_test(!(arrays[0]->getQuantizationOrigin() == arrays[1]->getQuantizationOrigin()));
+
+            // Compressed with the mesh, the sub-parts are quantized in the bounds of the mesh
+            TriangleMesh mesh;
+            mesh.addSubpart(arrays[2]);
+            mesh.addSubpart(arrays[3]);
+            mesh.compress();
+            rp3d_test(arrays[2]->isCompressed());
+            rp3d_test(arrays[3]->isCompressed());
+            rp3d_test(arrays[2]->getQuantizationOrigin() == Vector3(-1, 0, -2));
+            rp3d_test(arrays[3]->getQuantizationOrigin() == Vector3(-1, 0, -2));
+            rp3d_test(arrays[2]->getQuantizationStep() == arrays[3]->getQuantizationStep());
+
+            // The shared vertex is decoded at the same position in the two sub-parts
+            Vector3 sharedVertex1, sharedVertex2;
+            arrays[2]->getVertex(0, &sharedVertex1);
+            arrays[3]->getVertex(0, &sharedVertex2);
+            rp3d_test(sharedVertex1 == sharedVertex2);
+            const decimal maxError = arrays[2]->getQuantizationStep().length() * decimal(0.5) + decimal(0.000001);
+            rp3d_test((sharedVertex1 - Vector3(decimal(0.3f), decimal(0.7f), decimal(0.1f))).length() <= maxError);
+
+            for (int a=0; a < 4; a++) {
+                delete arrays[a];
+            }
         }
 
 };
@@ -0,0 +1,280 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_DENSE_INTEGER_SET_H
+#define TEST_DENSE_INTEGER_SET_H
+
+// Libraries
+#include "Test.h"
+#include "containers/DenseIntegerSet.h"
+#include "memory/DefaultAllocator.h"
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TestDenseIntegerSet
+/**
+ * Unit test for the DenseIntegerSet class
+ */
+class TestDenseIntegerSet : public Test {
+
+    private :
+
+        // ---------- Atributes ---------- //
+
+        DefaultAllocator mAllocator;
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestDenseIntegerSet(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testConstructors();
+            testAddRemoveClear();
+            testFind();
+            testEquality();
+            testAssignment();
+            testIterators();
+        }
+
+        void testConstructors() {
+
+            // ----- Constructors ----- //
+
+            DenseIntegerSet set1(mAllocator);
+            rp3d_test(set1.capacity() == 0);
+            rp3d_test(set1.size() == 0);
+
+            DenseIntegerSet set2(mAllocator, 100);
+            rp3d_test(set2.capacity() >= 100);
+            rp3d_test(set2.size() == 0);
+
+            // ----- Copy Constructors ----- //
+
+            DenseIntegerSet set3(set1);
+            rp3d_test(set3.capacity() == set1.capacity());
+            rp3d_test(set3.size() == 0);
+
+            DenseIntegerSet set4(mAllocator);
+            set4.add(10);
+            set4.add(200);
+            set4.add(30);
+            set4.add(30);
+            rp3d_test(set4.capacity() > 200);
+            rp3d_test(set4.size() == 3);
+
+            DenseIntegerSet set5(set4);
+            rp3d_test(set5.size() == 3);
+            rp3d_test(set5.contains(10));
+            rp3d_test(set5.contains(200));
+            rp3d_test(set5.contains(30));
+            rp3d_test(!set5.contains(20));
+        }
+
+        void testAddRemoveClear() {
+
+            // ----- Test add() ----- //
+
+            DenseIntegerSet set1(mAllocator);
+            set1.add(10);
+            set1.add(80);
+            set1.add(130);
+            rp3d_test(set1.contains(10));
+            rp3d_test(set1.contains(80));
+            rp3d_test(set1.contains(130));
+            rp3d_test(!set1.contains(1000));
+            rp3d_test(set1.size() == 3);
+
+            DenseIntegerSet set2(mAllocator);
+            for (int i = 0; i < 100000; i++) {
+                set2.add(i);
+            }
+            bool isValid = true;
+            for (int i = 0; i < 100000; i++) {
+                if (!set2.contains(i)) isValid = false;
+            }
+            rp3d_test(isValid);
+            rp3d_test(set2.size() == 100000);
+
+            // ----- Test remove() ----- //
+
+            set1.remove(10);
+            rp3d_test(!set1.contains(10));
+            rp3d_test(set1.contains(80));
+            rp3d_test(set1.contains(130));
+            rp3d_test(set1.size() == 2);
+
+            set1.remove(130);
+            rp3d_test(!set1.contains(130));
+            rp3d_test(set1.contains(80));
+            rp3d_test(set1.size() == 1);
+
+            auto it = set1.remove(5);
+            rp3d_test(it == set1.end());
+            rp3d_test(set1.size() == 1);
+
+            it = set1.remove(80);
+            rp3d_test(it == set1.end());
+            rp3d_test(set1.size() == 0);
+
+            isValid = true;
+            for (int i = 0; i < 100000; i += 2) {
+                set2.remove(i);
+            }
+            for (int i = 0; i < 100000; i++) {
+                if (set2.contains(i) != (i % 2 == 1)) isValid = false;
+            }
+            rp3d_test(isValid);
+            rp3d_test(set2.size() == 50000);
+
+            DenseIntegerSet set3(mAllocator);
+            for (int i = 0; i < 10; i++) {
+                set3.add(i);
+            }
+            for (it = set3.begin(); it != set3.end();) {
+                if (*it % 3 == 0) {
+                    it = set3.remove(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            rp3d_test(set3.size() == 6);
+            rp3d_test(!set3.contains(0));
+            rp3d_test(!set3.contains(3));
+            rp3d_test(!set3.contains(6));
+            rp3d_test(!set3.contains(9));
+            rp3d_test(set3.contains(1));
+            rp3d_test(set3.contains(8));
+
+            // ----- Test clear() ----- //
+
+            const int capacity = set2.capacity();
+            set2.clear();
+            rp3d_test(set2.size() == 0);
+            rp3d_test(set2.capacity() == capacity);
+            isValid = true;
+            for (int i = 0; i < 100000; i++) {
+                if (set2.contains(i)) isValid = false;
+            }
+            rp3d_test(isValid);
+            set2.add(77);
+            rp3d_test(set2.size() == 1);
+            rp3d_test(set2.contains(77));
+
+            DenseIntegerSet set4(mAllocator);
+            set4.clear();
+            rp3d_test(set4.size() == 0);
+        }
+
+        void testFind() {
+
+            DenseIntegerSet set1(mAllocator);
+            set1.add(2);
+            set1.add(4);
+            set1.add(6);
+            rp3d_test(*set1.find(2) == 2);
+            rp3d_test(*set1.find(4) == 4);
+            rp3d_test(*set1.find(6) == 6);
+            rp3d_test(set1.find(8) == set1.end());
+            rp3d_test(set1.find(1000) == set1.end());
+        }
+
+        void testEquality() {
+
+            DenseIntegerSet set1(mAllocator);
+            DenseIntegerSet set2(mAllocator, 500);
+
+            rp3d_test(set1 == set2);
+
+            set1.add(1);
+            set1.add(300);
+            set1.add(3);
+
+            set2.add(3);
+            set2.add(1);
+            set2.add(4);
+
+            rp3d_test(set1 == set1);
+            rp3d_test(set2 == set2);
+            rp3d_test(set1 != set2);
+
+            set2.remove(4);
+            set2.add(300);
+
+            rp3d_test(set1 == set2);
+        }
+
+        void testAssignment() {
+
+            DenseIntegerSet set1(mAllocator);
+            set1.add(1);
+            set1.add(2);
+            set1.add(1000);
+
+            DenseIntegerSet set2(mAllocator);
+            set2 = set1;
+            rp3d_test(set2.size() == set1.size());
+            rp3d_test(set1 == set2);
+            rp3d_test(set2.contains(1000));
+
+            DenseIntegerSet set3(mAllocator);
+            set2 = set3;
+            rp3d_test(set2.size() == 0);
+            rp3d_test(set2 == set3);
+        }
+
+        void testIterators() {
+
+            DenseIntegerSet set1(mAllocator);
+
+            rp3d_test(set1.begin() == set1.end());
+
+            // The integers are iterated in the order of insertion
+            set1.add(500);
+            set1.add(2);
+            set1.add(40);
+            set1.add(1);
+
+            const int values[] = {500, 2, 40, 1};
+            int size = 0;
+            for (auto it = set1.begin(); it != set1.end(); ++it) {
+                rp3d_test(*it == values[size]);
+                size++;
+            }
+            rp3d_test(set1.size() == size);
+        }
+ };
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 // Libraries
 #include "Test.h"
 #include "containers/Map.h"
+#include "containers/FlatMap.h"
 #include "memory/DefaultAllocator.h"
 
 // Key to test map with always same hash values
@@ -60,7 +61,7 @@ namespace reactphysics3d {
 
 // Class TestMap
 /**
- * Unit test for the Map class
+ * Unit test for the Map and FlatMap classes
  */
 class TestMap : public Test {
 
@@ -82,42 +83,56 @@ class TestMap : public Test {
         /// Run the tests
         void run() {
 
-            testConstructors();
-            testReserve();
-            testAddRemoveClear();
-            testContainsKey();
-            testFind();
-            testIndexing();
-            testEquality();
-            testAssignment();
-            testIterators();
+            // Run the tests with the node-based map and with the open-addressing map
+            testConstructors<Map>();
+            testReserve<Map>();
+            testAddRemoveClear<Map>();
+            testContainsKey<Map>();
+            testFind<Map>();
+            testIndexing<Map>();
+            testEquality<Map>();
+            testAssignment<Map>();
+            testIterators<Map>();
+
+            testConstructors<FlatMap>();
+            testReserve<FlatMap>();
+            testAddRemoveClear<FlatMap>();
+            testContainsKey<FlatMap>();
+            testFind<FlatMap>();
+            testIndexing<FlatMap>();
+            testEquality<FlatMap>();
+            testAssignment<FlatMap>();
+            testIterators<FlatMap>();
+            testFlatMapDeletedSlots();
+            testFlatMapIncrementalRehashing();
         }
 
+        template<template<typename, typename> class MapType>
         void testConstructors() {
 
             // ----- Constructors ----- //
 
-            Map<int, std::string> map1(mAllocator);
+            MapType<int, std::string> map1(mAllocator);
             rp3d_test(map1.capacity() == 0);
             rp3d_test(map1.size() == 0);
 
-            Map<int, std::string> map2(mAllocator, 100);
+            MapType<int, std::string> map2(mAllocator, 100);
             rp3d_test(map2.capacity() >= 100);
             rp3d_test(map2.size() == 0);
 
             // ----- Copy Constructors ----- //
-            Map<int, std::string> map3(map1);
+            MapType<int, std::string> map3(map1);
             rp3d_test(map3.capacity() == map1.capacity());
             rp3d_test(map3.size() == map1.size());
 
-            Map<int, int> map4(mAllocator);
+            MapType<int, int> map4(mAllocator);
             map4.add(Pair<int, int>(1, 10));
             map4.add(Pair<int, int>(2, 20));
             map4.add(Pair<int, int>(3, 30));
             rp3d_test(map4.capacity() >= 3);
             rp3d_test(map4.size() == 3);
 
-            Map<int, int> map5(map4);
+            MapType<int, int> map5(map4);
             rp3d_test(map5.capacity() == map4.capacity());
             rp3d_test(map5.size() == map4.size());
             rp3d_test(map5[1] == 10);
@@ -125,9 +140,10 @@ class TestMap : public Test {
             rp3d_test(map5[3] == 30);
         }
 
+        template<template<typename, typename> class MapType>
         void testReserve() {
 
-            Map<int, std::string> map1(mAllocator);
+            MapType<int, std::string> map1(mAllocator);
             map1.reserve(15);
             rp3d_test(map1.capacity() >= 15);
             map1.add(Pair<int, std::string>(1, "test1"));
@@ -143,11 +159,12 @@ class TestMap : public Test {
             rp3d_test(map1[2] == "test2");
         }
 
+        template<template<typename, typename> class MapType>
         void testAddRemoveClear() {
 
             // ----- Test add() ----- //
 
-            Map<int, int> map1(mAllocator);
+            MapType<int, int> map1(mAllocator);
             map1.add(Pair<int, int>(1, 10));
             map1.add(Pair<int, int>(8, 80));
             map1.add(Pair<int, int>(13, 130));
@@ -156,7 +173,7 @@ class TestMap : public Test {
             rp3d_test(map1[13] == 130);
             rp3d_test(map1.size() == 3);
 
-            Map<int, int> map2(mAllocator, 15);
+            MapType<int, int> map2(mAllocator, 15);
             for (int i = 0; i < 1000000; i++) {
                 map2.add(Pair<int, int>(i, i * 100));
             }
@@ -210,7 +227,7 @@ class TestMap : public Test {
             rp3d_test(isValid);
             rp3d_test(map2.size() == 0);
 
-            Map<int, int> map3(mAllocator);
+            MapType<int, int> map3(mAllocator);
             for (int i=0; i < 1000000; i++) {
                 map3.add(Pair<int, int>(i, i * 10));
                 map3.remove(i);
@@ -221,10 +238,15 @@ class TestMap : public Test {
             map3.add(Pair<int, int>(3, 30));
             rp3d_test(map3.size() == 3);
             it = map3.begin();
+            auto itNext = map3.begin();
+            ++itNext;
+            const int removedKey = it->first;
+            const int nextKey = itNext->first;
             map3.remove(it++);
-            rp3d_test(!map3.containsKey(1));
+            rp3d_test(!map3.containsKey(removedKey));
             rp3d_test(map3.size() == 2);
-            rp3d_test(it->second == 20);
+            rp3d_test(it->first == nextKey);
+            rp3d_test(it->second == nextKey * 10);
 
             map3.add(Pair<int, int>(56, 32));
             map3.add(Pair<int, int>(23, 89));
@@ -235,7 +257,7 @@ class TestMap : public Test {
 
             // ----- Test clear() ----- //
 
-            Map<int, int> map4(mAllocator);
+            MapType<int, int> map4(mAllocator);
             map4.add(Pair<int, int>(2, 20));
             map4.add(Pair<int, int>(4, 40));
             map4.add(Pair<int, int>(6, 60));
@@ -247,13 +269,13 @@ class TestMap : public Test {
             map4.clear();
             rp3d_test(map4.size() == 0);
 
-            Map<int, int> map5(mAllocator);
+            MapType<int, int> map5(mAllocator);
             map5.clear();
             rp3d_test(map5.size() == 0);
 
             // ----- Test map with always same hash value for keys ----- //
 
-            Map<TestKey, int> map6(mAllocator);
+            MapType<TestKey, int> map6(mAllocator);
             for (int i=0; i < 1000; i++) {
                 map6.add(Pair<TestKey, int>(TestKey(i), i));
             }
@@ -270,9 +292,10 @@ class TestMap : public Test {
             rp3d_test(map6.size() == 0);
         }
 
+        template<template<typename, typename> class MapType>
         void testContainsKey() {
 
-            Map<int, int> map1(mAllocator);
+            MapType<int, int> map1(mAllocator);
 
             rp3d_test(!map1.containsKey(2));
             rp3d_test(!map1.containsKey(4));
@@ -296,9 +319,10 @@ class TestMap : public Test {
             rp3d_test(!map1.containsKey(6));
         }
 
+        template<template<typename, typename> class MapType>
         void testIndexing() {
 
-            Map<int, int> map1(mAllocator);
+            MapType<int, int> map1(mAllocator);
             map1.add(Pair<int, int>(2, 20));
             map1.add(Pair<int, int>(4, 40));
             map1.add(Pair<int, int>(6, 60));
@@ -315,9 +339,10 @@ class TestMap : public Test {
             rp3d_test(map1[6] == 30);
         }
 
+        template<template<typename, typename> class MapType>
         void testFind() {
 
-            Map<int, int> map1(mAllocator);
+            MapType<int, int> map1(mAllocator);
             map1.add(Pair<int, int>(2, 20));
             map1.add(Pair<int, int>(4, 40));
             map1.add(Pair<int, int>(6, 60));
@@ -335,10 +360,11 @@ class TestMap : public Test {
             rp3d_test(map1.find(6)->second == 30);
         }
 
+        template<template<typename, typename> class MapType>
         void testEquality() {
 
-            Map<std::string, int> map1(mAllocator, 10);
-            Map<std::string, int> map2(mAllocator, 2);
+            MapType<std::string, int> map1(mAllocator, 10);
+            MapType<std::string, int> map2(mAllocator, 2);
 
             rp3d_test(map1 == map2);
 
@@ -358,21 +384,22 @@ class TestMap : public Test {
 
             rp3d_test(map1 == map2);
 
-            Map<std::string, int> map3(mAllocator);
+            MapType<std::string, int> map3(mAllocator);
             map3.add(Pair<std::string, int>("a", 1));
 
             rp3d_test(map1 != map3);
             rp3d_test(map2 != map3);
         }
 
+        template<template<typename, typename> class MapType>
         void testAssignment() {
 
-           Map<int, int> map1(mAllocator);
+           MapType<int, int> map1(mAllocator);
            map1.add(Pair<int, int>(1, 3));
            map1.add(Pair<int, int>(2, 6));
            map1.add(Pair<int, int>(10, 30));
 
-           Map<int, int> map2(mAllocator);
+           MapType<int, int> map2(mAllocator);
            map2 = map1;
            rp3d_test(map2.size() == map1.size());
            rp3d_test(map1 == map2);
@@ -380,7 +407,7 @@ class TestMap : public Test {
            rp3d_test(map2[2] == 6);
            rp3d_test(map2[10] == 30);
 
-           Map<int, int> map3(mAllocator, 100);
+           MapType<int, int> map3(mAllocator, 100);
            map3 = map1;
            rp3d_test(map3.size() == map1.size());
            rp3d_test(map3 == map1);
@@ -388,12 +415,12 @@ class TestMap : public Test {
            rp3d_test(map3[2] == 6);
            rp3d_test(map3[10] == 30);
 
-           Map<int, int> map4(mAllocator);
+           MapType<int, int> map4(mAllocator);
            map3 = map4;
            rp3d_test(map3.size() == 0);
            rp3d_test(map3 == map4);
 
-           Map<int, int> map5(mAllocator);
+           MapType<int, int> map5(mAllocator);
            map5.add(Pair<int, int>(7, 8));
            map5.add(Pair<int, int>(19, 70));
            map1 = map5;
@@ -403,9 +430,217 @@ class TestMap : public Test {
            rp3d_test(map1[19] == 70);
         }
 
+        void testFlatMapDeletedSlots() {
+
+            // The slots of the removed elements must be reused and must not make the map grow
+            FlatMap<int, int> map1(mAllocator);
+            for (int i=0; i < 10; i++) {
+                map1.add(Pair<int, int>(i, i));
+            }
+            const int capacity = map1.capacity();
+            for (int i=10; i < 100000; i++) {
+                map1.remove(i - 10);
+                map1.add(Pair<int, int>(i, i));
+            }
+            rp3d_test(map1.size() == 10);
+            rp3d_test(map1.capacity() == capacity);
+            bool isValid = true;
+            for (int i=99990; i < 100000; i++) {
+                if (map1[i] != i) isValid = false;
+            }
+            rp3d_test(isValid);
+
+            // Removing elements while iterating must visit each remaining element once
+            FlatMap<int, int> map2(mAllocator);
+            for (int i=0; i < 1000; i++) {
+                map2.add(Pair<int, int>(i, i));
+            }
+            int nbVisited = 0;
+            int sum = 0;
+            for (auto it = map2.begin(); it != map2.end();) {
+                nbVisited++;
+                if (it->first % 2 == 0) {
+                    it = map2.remove(it);
+                }
+                else {
+                    sum += it->second;
+                    ++it;
+                }
+            }
+            rp3d_test(nbVisited == 1000);
+            rp3d_test(map2.size() == 500);
+            rp3d_test(sum == 500 * 500);
+            rp3d_test(!map2.containsKey(0));
+            rp3d_test(map2.containsKey(999));
+
+            // Find an element after many collisions with deleted slots
+            FlatMap<TestKey, int> map3(mAllocator);
+            for (int i=0; i < 100; i++) {
+                map3.add(Pair<TestKey, int>(TestKey(i), i));
+            }
+            for (int i=0; i < 100; i += 2) {
+                map3.remove(TestKey(i));
+            }
+            rp3d_test(map3.size() == 50);
+            rp3d_test(!map3.containsKey(TestKey(50)));
+            rp3d_test(map3[TestKey(51)] == 51);
+            map3.add(Pair<TestKey, int>(TestKey(50), 500));
+            rp3d_test(map3[TestKey(50)] == 500);
+            rp3d_test(map3.size() == 51);
+        }
+
+        void testFlatMapIncrementalRehashing() {
+
+            FlatMap<int, int> map1(mAllocator, 0, true);
+            rp3d_test(map1.isIncrementalRehashingEnabled());
+
+            // Add elements until the map is being rehashed
+            int nbElements = 0;
+            while (!map1.isRehashing() || nbElements < 100) {
+                map1.add(Pair<int, int>(nbElements, nbElements));
+                nbElements++;
+            }
+            rp3d_test(map1.size() == nbElements);
+            rp3d_test(map1.isRehashing());
+
+            // The elements of the previous and of the new table must be found
+            bool isValid = true;
+            for (int i=0; i < nbElements; i++) {
+                if (!map1.containsKey(i) || map1[i] != i || map1.find(i)->second != i) isValid = false;
+            }
+            rp3d_test(isValid);
+            rp3d_test(!map1.containsKey(nbElements));
+            rp3d_test(map1.find(nbElements) == map1.end());
+
+            // Each element must be iterated once
+            int nbVisited = 0;
+            int sum = 0;
+            for (auto it = map1.begin(); it != map1.end(); ++it) {
+                nbVisited++;
+                sum += it->second;
+            }
+            rp3d_test(nbVisited == nbElements);
+            rp3d_test(sum == nbElements * (nbElements - 1) / 2);
+
+            // A key that is already in the previous table cannot be added again
+            bool isExceptionThrown = false;
+            try {
+                map1.add(Pair<int, int>(0, 0));
+            }
+            catch (std::runtime_error&) {
+                isExceptionThrown = true;
+            }
+            rp3d_test(isExceptionThrown);
+            map1.add(Pair<int, int>(0, 10), true);
+            rp3d_test(map1[0] == 10);
+            rp3d_test(map1.size() == nbElements);
+            map1[0] = 0;
+
+            // Copy and assignment of a map that is being rehashed
+            FlatMap<int, int> map2(map1);
+            rp3d_test(map2.size() == nbElements);
+            rp3d_test(map2 == map1);
+            FlatMap<int, int> map3(mAllocator);
+            map3.add(Pair<int, int>(-1, -1));
+            map3 = map1;
+            rp3d_test(map3 == map1);
+            rp3d_test(!map3.containsKey(-1));
+
+            // Remove elements while iterating
+            nbVisited = 0;
+            for (auto it = map1.begin(); it != map1.end();) {
+                nbVisited++;
+                if (it->first % 2 == 0) {
+                    it = map1.remove(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            rp3d_test(nbVisited == nbElements);
+            rp3d_test(map1.size() == nbElements / 2);
+            isValid = true;
+            for (int i=0; i < nbElements; i++) {
+                if (map1.containsKey(i) != (i % 2 == 1)) isValid = false;
+            }
+            rp3d_test(isValid);
+
+            // Remove elements with their key
+            for (int i=1; i < nbElements; i += 4) {
+                map1.remove(i);
+            }
+            isValid = true;
+            for (int i=0; i < nbElements; i++) {
+                if (map1.containsKey(i) != (i % 4 == 3)) isValid = false;
+            }
+            rp3d_test(isValid);
+
+            // The rehashing must be complete after enough additions
+            const int nbRemainingElements = map1.size();
+            for (int i=0; i < 10000 && map1.isRehashing(); i++) {
+                map1.add(Pair<int, int>(-i - 1, 0));
+            }
+            rp3d_test(!map1.isRehashing());
+            isValid = true;
+            for (int i=3; i < nbElements; i += 4) {
+                if (map1[i] != i) isValid = false;
+            }
+            rp3d_test(isValid);
+            rp3d_test(map1.size() > nbRemainingElements);
+
+            // Add many elements with the incremental rehashing
+            FlatMap<int, int> map4(mAllocator, 0, true);
+            for (int i=0; i < 100000; i++) {
+                map4.add(Pair<int, int>(i, 2 * i));
+            }
+            rp3d_test(map4.size() == 100000);
+            isValid = true;
+            for (int i=0; i < 100000; i++) {
+                if (map4[i] != 2 * i) isValid = false;
+            }
+            rp3d_test(isValid);
+            nbVisited = 0;
+            for (auto it = map4.begin(); it != map4.end(); ++it) {
+                nbVisited++;
+            }
+            rp3d_test(nbVisited == 100000);
+
+            // Clear and reserve while the map is being rehashed
+            nbElements = 0;
+            while (!map4.isRehashing()) {
+                map4.add(Pair<int, int>(100000 + nbElements, 0));
+                nbElements++;
+            }
+            FlatMap<int, int> map5(map4);
+            map4.clear();
+            rp3d_test(map4.size() == 0);
+            rp3d_test(!map4.isRehashing());
+            rp3d_test(map4.begin() == map4.end());
+            map4.add(Pair<int, int>(1, 1));
+            rp3d_test(map4[1] == 1);
+            map5.reserve(map5.size() + 1);
+            rp3d_test(!map5.isRehashing());
+            rp3d_test(map5.size() == 100000 + nbElements);
+            rp3d_test(map5[99999] == 2 * 99999);
+
+            // Disabling the incremental rehashing completes the current one
+            FlatMap<int, int> map6(mAllocator, 0, true);
+            for (int i=0; !map6.isRehashing(); i++) {
+                map6.add(Pair<int, int>(i, i));
+            }
+            map6.setIsIncrementalRehashingEnabled(false);
+            rp3d_test(!map6.isRehashing());
+            for (int i=0; i < 1000; i++) {
+                map6.add(Pair<int, int>(-i - 1, i));
+                if (map6.isRehashing()) isValid = false;
+            }
+            rp3d_test(isValid);
+        }
+
+        template<template<typename, typename> class MapType>
         void testIterators() {
 
-            Map<int, int> map1(mAllocator);
+            MapType<int, int> map1(mAllocator);
 
             rp3d_test(map1.begin() == map1.end());
 
@@ -414,8 +649,8 @@ class TestMap : public Test {
             map1.add(Pair<int, int>(3, 8));
             map1.add(Pair<int, int>(4, -1));
 
-            Map<int, int>::Iterator itBegin = map1.begin();
-            Map<int, int>::Iterator it = map1.begin();
+            typename MapType<int, int>::Iterator itBegin = map1.begin();
+            typename MapType<int, int>::Iterator it = map1.begin();
 
             rp3d_test(itBegin == it);
 
@@ -29,6 +29,7 @@
 // Libraries
 #include "Test.h"
 #include "containers/Set.h"
+#include "containers/FlatSet.h"
 #include "memory/DefaultAllocator.h"
 
 // Key to test map with always same hash values
@@ -60,7 +61,7 @@ namespace reactphysics3d {
 
 // Class TestSet
 /**
- * Unit test for the Set class
+ * Unit test for the Set and FlatSet classes
  */
 class TestSet : public Test {
 
@@ -82,34 +83,184 @@ class TestSet : public Test {
         /// Run the tests
         void run() {
 
-            testConstructors();
-            testReserve();
-            testAddRemoveClear();
-            testContains();
-            testFind();
-            testEquality();
-            testAssignment();
-            testIterators();
+            // Run the tests with the node-based set and with the open-addressing set
+            testConstructors<Set>();
+            testReserve<Set>();
+            testAddRemoveClear<Set>();
+            testContains<Set>();
+            testFind<Set>();
+            testEquality<Set>();
+            testAssignment<Set>();
+            testIterators<Set>();
+
+            testConstructors<FlatSet>();
+            testReserve<FlatSet>();
+            testAddRemoveClear<FlatSet>();
+            testContains<FlatSet>();
+            testFind<FlatSet>();
+            testEquality<FlatSet>();
+            testAssignment<FlatSet>();
+            testIterators<FlatSet>();
+            testFlatSetIncrementalRehashing();
         }
 
+        void testFlatSetIncrementalRehashing() {
+
+            FlatSet<int> set1(mAllocator, 0, true);
+            rp3d_test(set1.isIncrementalRehashingEnabled());
+
+            // Add elements until the set is being rehashed
+            int nbElements = 0;
+            while (!set1.isRehashing() || nbElements < 100) {
+                set1.add(nbElements);
+                nbElements++;
+            }
+            rp3d_test(set1.size() == nbElements);
+            rp3d_test(set1.isRehashing());
+
+            // The elements of the previous and of the new table must be found
+            bool isValid = true;
+            for (int i=0; i < nbElements; i++) {
+                if (!set1.contains(i) || *set1.find(i) != i) isValid = false;
+            }
+            rp3d_test(isValid);
+            rp3d_test(!set1.contains(nbElements));
+            rp3d_test(set1.find(nbElements) == set1.end());
+
+            // Each element must be iterated once
+            int nbVisited = 0;
+            int sum = 0;
+            for (auto it = set1.begin(); it != set1.end(); ++it) {
+                nbVisited++;
+                sum += *it;
+            }
+            rp3d_test(nbVisited == nbElements);
+            rp3d_test(sum == nbElements * (nbElements - 1) / 2);
+
+            // A value that is already in the previous table is not added again
+            set1.add(0);
+            rp3d_test(set1.size() == nbElements);
+
+            // Copy and assignment of a set that is being rehashed
+            FlatSet<int> set2(set1);
+            rp3d_test(set2.size() == nbElements);
+            rp3d_test(set2 == set1);
+            FlatSet<int> set3(mAllocator);
+            set3.add(-1);
+            set3 = set1;
+            rp3d_test(set3 == set1);
+            rp3d_test(!set3.contains(-1));
+
+            // Remove elements while iterating
+            nbVisited = 0;
+            for (auto it = set1.begin(); it != set1.end();) {
+                nbVisited++;
+                if (*it % 2 == 0) {
+                    it = set1.remove(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            rp3d_test(nbVisited == nbElements);
+            rp3d_test(set1.size() == nbElements / 2);
+            isValid = true;
+            for (int i=0; i < nbElements; i++) {
+                if (set1.contains(i) != (i % 2 == 1)) isValid = false;
+            }
+            rp3d_test(isValid);
+
+            // Remove elements with their value
+            for (int i=1; i < nbElements; i += 4) {
+                set1.remove(i);
+            }
+            isValid = true;
+            for (int i=0; i < nbElements; i++) {
+                if (set1.contains(i) != (i % 4 == 3)) isValid = false;
+            }
+            rp3d_test(isValid);
+
+            // The rehashing must be complete after enough additions
+            const int nbRemainingElements = set1.size();
+            for (int i=0; i < 10000 && set1.isRehashing(); i++) {
+                set1.add(-i - 1);
+            }
+            rp3d_test(!set1.isRehashing());
+            isValid = true;
+            for (int i=3; i < nbElements; i += 4) {
+                if (!set1.contains(i)) isValid = false;
+            }
+            rp3d_test(isValid);
+            rp3d_test(set1.size() > nbRemainingElements);
+
+            // Add many elements with the incremental rehashing
+            FlatSet<int> set4(mAllocator, 0, true);
+            for (int i=0; i < 100000; i++) {
+                set4.add(i);
+            }
+            rp3d_test(set4.size() == 100000);
+            isValid = true;
+            for (int i=0; i < 100000; i++) {
+                if (!set4.contains(i)) isValid = false;
+            }
+            rp3d_test(isValid);
+            nbVisited = 0;
+            for (auto it = set4.begin(); it != set4.end(); ++it) {
+                nbVisited++;
+            }
+            rp3d_test(nbVisited == 100000);
+
+            // Clear and reserve while the set is being rehashed
+            nbElements = 0;
+            while (!set4.isRehashing()) {
+                set4.add(100000 + nbElements);
+                nbElements++;
+            }
+            FlatSet<int> set5(set4);
+            set4.clear();
+            rp3d_test(set4.size() == 0);
+            rp3d_test(!set4.isRehashing());
+            rp3d_test(set4.begin() == set4.end());
+            set4.add(1);
+            rp3d_test(set4.contains(1));
+            set5.reserve(set5.size() + 1);
+            rp3d_test(!set5.isRehashing());
+            rp3d_test(set5.size() == 100000 + nbElements);
+            rp3d_test(set5.contains(99999));
+
+            // Disabling the incremental rehashing completes the current one
+            FlatSet<int> set6(mAllocator, 0, true);
+            for (int i=0; !set6.isRehashing(); i++) {
+                set6.add(i);
+            }
+            set6.setIsIncrementalRehashingEnabled(false);
+            rp3d_test(!set6.isRehashing());
+            for (int i=0; i < 1000; i++) {
+                set6.add(-i - 1);
+                if (set6.isRehashing()) isValid = false;
+            }
+            rp3d_test(isValid);
+        }
+
+        template<template<typename> class SetType>
         void testConstructors() {
 
             // ----- Constructors ----- //
 
-            Set<std::string> set1(mAllocator);
+            SetType<std::string> set1(mAllocator);
             rp3d_test(set1.capacity() == 0);
             rp3d_test(set1.size() == 0);
 
-            Set<std::string> set2(mAllocator, 100);
+            SetType<std::string> set2(mAllocator, 100);
             rp3d_test(set2.capacity() >= 100);
             rp3d_test(set2.size() == 0);
 
             // ----- Copy Constructors ----- //
-            Set<std::string> set3(set1);
+            SetType<std::string> set3(set1);
             rp3d_test(set3.capacity() == set1.capacity());
             rp3d_test(set3.size() == set1.size());
 
-            Set<int> set4(mAllocator);
+            SetType<int> set4(mAllocator);
             set4.add(10);
             set4.add(20);
             set4.add(30);
@@ -118,7 +269,7 @@ class TestSet : public Test {
             set4.add(30);
             rp3d_test(set4.size() == 3);
 
-            Set<int> set5(set4);
+            SetType<int> set5(set4);
             rp3d_test(set5.capacity() == set4.capacity());
             rp3d_test(set5.size() == set4.size());
             rp3d_test(set5.contains(10));
@@ -126,9 +277,10 @@ class TestSet : public Test {
             rp3d_test(set5.contains(30));
         }
 
+        template<template<typename> class SetType>
         void testReserve() {
 
-            Set<std::string> set1(mAllocator);
+            SetType<std::string> set1(mAllocator);
             set1.reserve(15);
             rp3d_test(set1.capacity() >= 15);
             set1.add("test1");
@@ -144,11 +296,12 @@ class TestSet : public Test {
             rp3d_test(set1.contains("test2"));
         }
 
+        template<template<typename> class SetType>
         void testAddRemoveClear() {
 
             // ----- Test add() ----- //
 
-            Set<int> set1(mAllocator);
+            SetType<int> set1(mAllocator);
             set1.add(10);
             set1.add(80);
             set1.add(130);
@@ -157,7 +310,7 @@ class TestSet : public Test {
             rp3d_test(set1.contains(130));
             rp3d_test(set1.size() == 3);
 
-            Set<int> set2(mAllocator, 15);
+            SetType<int> set2(mAllocator, 15);
             for (int i = 0; i < 1000000; i++) {
                 set2.add(i);
             }
@@ -210,7 +363,7 @@ class TestSet : public Test {
             rp3d_test(isValid);
             rp3d_test(set2.size() == 0);
 
-            Set<int> set3(mAllocator);
+            SetType<int> set3(mAllocator);
             for (int i=0; i < 1000000; i++) {
                 set3.add(i);
                 set3.remove(i);
@@ -221,10 +374,14 @@ class TestSet : public Test {
             set3.add(3);
             rp3d_test(set3.size() == 3);
             auto it = set3.begin();
+            auto itNext = set3.begin();
+            ++itNext;
+            const int removedValue = *it;
+            const int nextValue = *itNext;
             set3.remove(it++);
-            rp3d_test(!set3.contains(1));
+            rp3d_test(!set3.contains(removedValue));
             rp3d_test(set3.size() == 2);
-            rp3d_test(*it == 2);
+            rp3d_test(*it == nextValue);
 
             set3.add(6);
             set3.add(7);
@@ -236,7 +393,7 @@ class TestSet : public Test {
 
             // ----- Test clear() ----- //
 
-            Set<int> set4(mAllocator);
+            SetType<int> set4(mAllocator);
             set4.add(2);
             set4.add(4);
             set4.add(6);
@@ -248,13 +405,13 @@ class TestSet : public Test {
             set4.clear();
             rp3d_test(set4.size() == 0);
 
-            Set<int> set5(mAllocator);
+            SetType<int> set5(mAllocator);
             set5.clear();
             rp3d_test(set5.size() == 0);
 
             // ----- Test map with always same hash value for keys ----- //
 
-            Set<TestValueSet> set6(mAllocator);
+            SetType<TestValueSet> set6(mAllocator);
             for (int i=0; i < 1000; i++) {
                 set6.add(TestValueSet(i));
             }
@@ -271,9 +428,10 @@ class TestSet : public Test {
             rp3d_test(set6.size() == 0);
         }
 
+        template<template<typename> class SetType>
         void testContains() {
 
-            Set<int> set1(mAllocator);
+            SetType<int> set1(mAllocator);
 
             rp3d_test(!set1.contains(2));
             rp3d_test(!set1.contains(4));
@@ -297,9 +455,10 @@ class TestSet : public Test {
             rp3d_test(!set1.contains(6));
         }
 
+        template<template<typename> class SetType>
         void testFind() {
 
-            Set<int> set1(mAllocator);
+            SetType<int> set1(mAllocator);
             set1.add(2);
             set1.add(4);
             set1.add(6);
@@ -313,10 +472,11 @@ class TestSet : public Test {
             rp3d_test(set1.find(2) == set1.end());
         }
 
+        template<template<typename> class SetType>
         void testEquality() {
 
-            Set<std::string> set1(mAllocator, 10);
-            Set<std::string> set2(mAllocator, 2);
+            SetType<std::string> set1(mAllocator, 10);
+            SetType<std::string> set2(mAllocator, 2);
 
             rp3d_test(set1 == set2);
 
@@ -340,7 +500,7 @@ class TestSet : public Test {
             rp3d_test(set1 == set2);
             rp3d_test(set2 == set1);
 
-            Set<std::string> set3(mAllocator);
+            SetType<std::string> set3(mAllocator);
             set3.add("a");
 
             rp3d_test(set1 != set3);
@@ -349,14 +509,15 @@ class TestSet : public Test {
             rp3d_test(set3 != set2);
         }
 
+        template<template<typename> class SetType>
         void testAssignment() {
 
-           Set<int> set1(mAllocator);
+           SetType<int> set1(mAllocator);
            set1.add(1);
            set1.add(2);
            set1.add(10);
 
-           Set<int> set2(mAllocator);
+           SetType<int> set2(mAllocator);
            set2 = set1;
            rp3d_test(set2.size() == set1.size());
            rp3d_test(set2.contains(1));
@@ -364,7 +525,7 @@ class TestSet : public Test {
            rp3d_test(set2.contains(10));
            rp3d_test(set1 == set2);
 
-           Set<int> set3(mAllocator, 100);
+           SetType<int> set3(mAllocator, 100);
            set3 = set1;
            rp3d_test(set3.size() == set1.size());
            rp3d_test(set3 == set1);
@@ -372,12 +533,12 @@ class TestSet : public Test {
            rp3d_test(set3.contains(2));
            rp3d_test(set3.contains(10));
 
-           Set<int> set4(mAllocator);
+           SetType<int> set4(mAllocator);
            set3 = set4;
            rp3d_test(set3.size() == 0);
            rp3d_test(set3 == set4);
 
-           Set<int> set5(mAllocator);
+           SetType<int> set5(mAllocator);
            set5.add(7);
            set5.add(19);
            set1 = set5;
@@ -387,9 +548,10 @@ class TestSet : public Test {
            rp3d_test(set1.contains(19));
         }
 
+        template<template<typename> class SetType>
         void testIterators() {
 
-            Set<int> set1(mAllocator);
+            SetType<int> set1(mAllocator);
 
             rp3d_test(set1.begin() == set1.end());
 
@@ -398,8 +560,8 @@ class TestSet : public Test {
             set1.add(3);
             set1.add(4);
 
-            Set<int>::Iterator itBegin = set1.begin();
-            Set<int>::Iterator it = set1.begin();
+            typename SetType<int>::Iterator itBegin = set1.begin();
+            typename SetType<int>::Iterator it = set1.begin();
 
             rp3d_test(itBegin == it);
 
@@ -0,0 +1,487 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_SMALL_LIST_H
+#define TEST_SMALL_LIST_H
+
+// Libraries
+#include "Test.h"
+#include "containers/SmallList.h"
+#include "memory/DefaultAllocator.h"
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TestSmallList
+/**
+ * Unit test for the SmallList class
+ */
+class TestSmallList : public Test {
+
+    private :
+
+        // Class AllocationCounter
+        /**
+         * Default allocator that counts its allocations
+         */
+        class AllocationCounter : public DefaultAllocator {
+
+            public :
+
+                uint nbAllocations = 0;
+
+                virtual void* allocate(size_t size) override {
+                    nbAllocations++;
+                    return DefaultAllocator::allocate(size);
+                }
+        };
+
+        // ---------- Atributes ---------- //
+
+        DefaultAllocator mAllocator;
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestSmallList(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testConstructors();
+            testInlineStorage();
+            testAddRemoveClear();
+            testAssignment();
+            testIndexing();
+            testFind();
+            testEquality();
+            testReserve();
+            testIterators();
+        }
+
+        void testConstructors() {
+
+            // ----- Constructors ----- //
+
+            SmallList<int, 4> list1(mAllocator);
+            rp3d_test(list1.capacity() == 4);
+            rp3d_test(list1.size() == 0);
+            rp3d_test(list1.isInline());
+
+            SmallList<int, 4> list2(mAllocator, 100);
+            rp3d_test(list2.capacity() == 100);
+            rp3d_test(list2.size() == 0);
+            rp3d_test(!list2.isInline());
+
+            SmallList<int, 4> list3(mAllocator, 2);
+            list3.add(1);
+            list3.add(2);
+            list3.add(3);
+            rp3d_test(list3.capacity() == 4);
+            rp3d_test(list3.size() == 3);
+            rp3d_test(list3.isInline());
+
+            // ----- Copy Constructors ----- //
+
+            SmallList<int, 4> list4(list1);
+            rp3d_test(list4.capacity() == 4);
+            rp3d_test(list4.size() == 0);
+
+            SmallList<int, 4> list5(list3);
+            rp3d_test(list5.size() == list3.size());
+            rp3d_test(list5.isInline());
+            for (uint i=0; i<list3.size(); i++) {
+                rp3d_test(list5[i] == list3[i]);
+            }
+
+            SmallList<std::string, 2> list6(mAllocator);
+            list6.add("test1");
+            list6.add("test2");
+            list6.add("test3");
+            SmallList<std::string, 2> list7(list6);
+            rp3d_test(list7.size() == 3);
+            rp3d_test(list7[0] == "test1");
+            rp3d_test(list7[1] == "test2");
+            rp3d_test(list7[2] == "test3");
+
+            // ----- Test capacity grow ----- //
+
+            SmallList<std::string, 20> list8(mAllocator);
+            rp3d_test(list8.capacity() == 20);
+            for (uint i=0; i<20; i++) {
+                list8.add("test");
+            }
+            rp3d_test(list8.capacity() == 20);
+            rp3d_test(list8.isInline());
+            list8.add("test");
+            rp3d_test(list8.capacity() == 40);
+            rp3d_test(!list8.isInline());
+            for (uint i=0; i<21; i++) {
+                rp3d_test(list8[i] == "test");
+            }
+        }
+
+        void testInlineStorage() {
+
+            AllocationCounter allocator;
+
+            // No allocation while the elements fit in the inline buffer
+            SmallList<int, 4> list1(allocator);
+            list1.add(1);
+            list1.add(2);
+            list1.add(3);
+            list1.add(4);
+            list1.removeAt(0);
+            list1.add(5);
+            list1.clear();
+            list1.add(6);
+            SmallList<int, 4> list2(list1);
+            list2 = list1;
+            rp3d_test(allocator.nbAllocations == 0);
+
+            // A single allocation when the inline buffer overflows
+            for (int i=0; i<4; i++) {
+                list1.add(i);
+            }
+            rp3d_test(allocator.nbAllocations == 1);
+            rp3d_test(!list1.isInline());
+            rp3d_test(list1.capacity() == 8);
+            rp3d_test(list1.size() == 5);
+            rp3d_test(list1[0] == 6);
+            for (int i=0; i<4; i++) {
+                rp3d_test(list1[i + 1] == i);
+            }
+
+            // Copying a small list that is not inline anymore into an inline one
+            SmallList<int, 8> list3(allocator);
+            list3.add(1);
+            SmallList<int, 8> list4(allocator);
+            for (int i=0; i<9; i++) {
+                list4.add(i);
+            }
+            rp3d_test(!list4.isInline());
+            list4.clear();
+            list4.add(7);
+            list3 = list4;
+            rp3d_test(list3.isInline());
+            rp3d_test(list3.size() == 1);
+            rp3d_test(list3[0] == 7);
+        }
+
+        void testAddRemoveClear() {
+
+            // ----- Test add() ----- //
+
+            SmallList<int, 4> list1(mAllocator);
+            list1.add(4);
+            rp3d_test(list1.size() == 1);
+            rp3d_test(list1[0] == 4);
+            list1.add(9);
+            rp3d_test(list1.size() == 2);
+            rp3d_test(list1[0] == 4);
+            rp3d_test(list1[1] == 9);
+
+            const int arraySize = 15;
+            int arrayTest[arraySize] = {3, 145, -182, 34, 12, 95, -1834, 4143, -111, -111, 4343, 234, 22983, -3432, 753};
+            SmallList<int, 4> list2(mAllocator);
+            for (uint i=0; i<arraySize; i++) {
+               list2.add(arrayTest[i]);
+            }
+            rp3d_test(list2.size() == arraySize);
+            for (uint i=0; i<arraySize; i++) {
+                rp3d_test(list2[i] == arrayTest[i]);
+            }
+
+            // ----- Test remove() ----- //
+
+            SmallList<int, 4> list3(mAllocator);
+            list3.add(1);
+            list3.add(2);
+            list3.add(3);
+            list3.add(4);
+
+            auto it = list3.removeAt(3);
+            rp3d_test(list3.size() == 3);
+            rp3d_test(list3.capacity() == 4);
+            rp3d_test(it == list3.end());
+            rp3d_test(list3[0] == 1);
+            rp3d_test(list3[1] == 2);
+            rp3d_test(list3[2] == 3);
+
+            it = list3.removeAt(1);
+            rp3d_test(list3.size() == 2);
+            rp3d_test(list3[0] == 1);
+            rp3d_test(list3[1] == 3);
+            rp3d_test(*it == 3);
+
+            list3.removeAt(0);
+            rp3d_test(list3.size() == 1);
+            rp3d_test(list3[0] == 3);
+
+            it = list3.removeAt(0);
+            rp3d_test(list3.size() == 0);
+            rp3d_test(it == list3.end());
+
+            list3.add(1);
+            list3.add(2);
+            list3.add(3);
+            it = list3.begin();
+            list3.remove(it);
+            rp3d_test(list3.size() == 2);
+            rp3d_test(list3[0] == 2);
+            rp3d_test(list3[1] == 3);
+            it = list3.find(3);
+            list3.remove(it);
+            rp3d_test(list3.size() == 1);
+            rp3d_test(list3[0] == 2);
+
+            list3.add(5);
+            list3.add(6);
+            list3.add(7);
+            it = list3.remove(7);
+            rp3d_test(it == list3.end());
+            rp3d_test(list3.size() == 3);
+            it = list3.remove(5);
+            rp3d_test((*it) == 6);
+
+            // ----- Test addRange() ----- //
+
+            SmallList<int, 4> list4(mAllocator);
+            list4.add(1);
+            list4.add(2);
+            list4.add(3);
+
+            SmallList<int, 4> list5(mAllocator);
+            list5.add(4);
+            list5.add(5);
+
+            list4.addRange(list5);
+            rp3d_test(list4.size() == 3 + list5.size());
+            rp3d_test(!list4.isInline());
+            rp3d_test(list4[0] == 1);
+            rp3d_test(list4[1] == 2);
+            rp3d_test(list4[2] == 3);
+            rp3d_test(list4[3] == 4);
+            rp3d_test(list4[4] == 5);
+
+            // ----- Test clear() ----- //
+
+            SmallList<std::string, 2> list6(mAllocator);
+            list6.add("test1");
+            list6.add("test2");
+            list6.add("test3");
+            list6.clear();
+            rp3d_test(list6.size() == 0);
+            list6.add("new");
+            rp3d_test(list6.size() == 1);
+            rp3d_test(list6[0] == "new");
+        }
+
+        void testAssignment() {
+
+            SmallList<int, 2> list1(mAllocator);
+            list1.add(1);
+            list1.add(2);
+            list1.add(3);
+
+            SmallList<int, 2> list2(mAllocator);
+            list2.add(5);
+            list2.add(6);
+
+            SmallList<int, 2> list3(mAllocator);
+            SmallList<int, 2> list4(mAllocator);
+            list4.add(1);
+            list4.add(2);
+
+            SmallList<int, 2> list5(mAllocator);
+            list5.add(1);
+            list5.add(2);
+            list5.add(3);
+
+            list3 = list2;
+            rp3d_test(list2.size() == list3.size());
+            rp3d_test(list2[0] == list3[0]);
+            rp3d_test(list2[1] == list3[1]);
+
+            list4 = list1;
+            rp3d_test(list4.size() == list1.size())
+            rp3d_test(list4[0] == list1[0]);
+            rp3d_test(list4[1] == list1[1]);
+            rp3d_test(list4[2] == list1[2]);
+
+            list5 = list2;
+            rp3d_test(list5.size() == list2.size());
+            rp3d_test(list5[0] == list2[0]);
+            rp3d_test(list5[1] == list2[1]);
+        }
+
+        void testIndexing() {
+
+            SmallList<int, 4> list1(mAllocator);
+            list1.add(1);
+            list1.add(2);
+            list1.add(3);
+
+            rp3d_test(list1[0] == 1);
+            rp3d_test(list1[1] == 2);
+            rp3d_test(list1[2] == 3);
+
+            list1[0] = 6;
+            list1[1] = 7;
+            list1[2] = 8;
+
+            rp3d_test(list1[0] == 6);
+            rp3d_test(list1[1] == 7);
+            rp3d_test(list1[2] == 8);
+
+            const int a = list1[0];
+            const int b = list1[1];
+            rp3d_test(a == 6);
+            rp3d_test(b == 7);
+
+            list1[0]++;
+            list1[1]++;
+            rp3d_test(list1[0] == 7);
+            rp3d_test(list1[1] == 8);
+        }
+
+        void testFind() {
+
+            SmallList<int, 4> list1(mAllocator);
+            list1.add(1);
+            list1.add(2);
+            list1.add(3);
+            list1.add(4);
+            list1.add(5);
+
+            rp3d_test(list1.find(1) == list1.begin());
+            rp3d_test(*(list1.find(2)) == 2);
+            rp3d_test(*(list1.find(5)) == 5);
+            rp3d_test(list1.find(6) == list1.end());
+        }
+
+        void testEquality() {
+
+            SmallList<int, 2> list1(mAllocator);
+            list1.add(1);
+            list1.add(2);
+            list1.add(3);
+
+            SmallList<int, 2> list2(mAllocator);
+            list2.add(1);
+            list2.add(2);
+
+            SmallList<int, 2> list3(mAllocator);
+            list3.add(1);
+            list3.add(2);
+            list3.add(3);
+
+            SmallList<int, 2> list4(mAllocator);
+            list4.add(1);
+            list4.add(5);
+            list4.add(3);
+
+            rp3d_test(list1 == list1);
+            rp3d_test(list1 != list2);
+            rp3d_test(list1 == list3);
+            rp3d_test(list1 != list4);
+            rp3d_test(list2 != list4);
+        }
+
+        void testReserve() {
+
+            SmallList<int, 4> list1(mAllocator);
+            list1.reserve(2);
+            rp3d_test(list1.capacity() == 4);
+            rp3d_test(list1.isInline());
+            list1.reserve(10);
+            rp3d_test(list1.size() == 0);
+            rp3d_test(list1.capacity() == 10);
+            list1.add(1);
+            list1.add(2);
+            rp3d_test(list1.capacity() == 10);
+            rp3d_test(list1.size() == 2);
+            rp3d_test(list1[0] == 1);
+            rp3d_test(list1[1] == 2);
+
+            list1.reserve(1);
+            rp3d_test(list1.capacity() == 10);
+
+            list1.reserve(100);
+            rp3d_test(list1.capacity() == 100);
+            rp3d_test(list1[0] == 1);
+            rp3d_test(list1[1] == 2);
+        }
+
+        void testIterators() {
+
+            SmallList<int, 4> list1(mAllocator);
+
+            rp3d_test(list1.begin() == list1.end());
+
+            list1.add(5);
+            list1.add(6);
+            list1.add(8);
+            list1.add(-1);
+
+            SmallList<int, 4>::Iterator itBegin = list1.begin();
+            SmallList<int, 4>::Iterator itEnd = list1.end();
+            SmallList<int, 4>::Iterator it = list1.begin();
+
+            rp3d_test(itBegin == it);
+            rp3d_test(*it == 5);
+            rp3d_test(*(it++) == 5);
+            rp3d_test(*it == 6);
+            rp3d_test(*(it--) == 6);
+            rp3d_test(*it == 5);
+            rp3d_test(*(++it) == 6);
+            rp3d_test(*it == 6);
+            rp3d_test(*(--it) == 5);
+            rp3d_test(*it == 5);
+            rp3d_test(it == itBegin);
+
+            it = list1.end();
+            rp3d_test(it == itEnd);
+            it--;
+            rp3d_test(*it == -1);
+            it++;
+            rp3d_test(it == itEnd);
+
+            SmallList<int, 4> list2(mAllocator);
+            for (auto it = list1.begin(); it != list1.end(); ++it) {
+                list2.add(*it);
+            }
+            rp3d_test(list1 == list2);
+        }
+
+ };
+
+}
+
+#endif
@@ -186,12 +186,12 @@ class TestMathematicsFunctions : public Test {
             segmentVertices.push_back(Vector3(-6, 3, 0));
             segmentVertices.push_back(Vector3(8, 3, 0));
 
-            List<Vector3> planesNormals(mAllocator, 2);
-            List<Vector3> planesPoints(mAllocator, 2);
+            ClippingVertices planesNormals(mAllocator, 2);
+            ClippingVertices planesPoints(mAllocator, 2);
             planesNormals.add(Vector3(-1, 0, 0));
             planesPoints.add(Vector3(4, 0, 0));
 
-            List<Vector3> clipSegmentVertices = clipSegmentWithPlanes(segmentVertices[0], segmentVertices[1],
+            ClippingVertices clipSegmentVertices = clipSegmentWithPlanes(segmentVertices[0], segmentVertices[1],
                                                                              planesPoints, planesNormals, mAllocator);
             rp3d_test(clipSegmentVertices.size() == 2);
             rp3d_test(approxEqual(clipSegmentVertices[0].x, -6, 0.000001));
@@ -235,14 +235,14 @@ class TestMathematicsFunctions : public Test {
             rp3d_test(clipSegmentVertices.size() == 0);
 
             // Test clipPolygonWithPlanes()
-            List<Vector3> polygonVertices(mAllocator);
+            ClippingVertices polygonVertices(mAllocator);
             polygonVertices.add(Vector3(-4, 2, 0));
             polygonVertices.add(Vector3(7, 2, 0));
             polygonVertices.add(Vector3(7, 4, 0));
             polygonVertices.add(Vector3(-4, 4, 0));
 
-            List<Vector3> polygonPlanesNormals(mAllocator);
-            List<Vector3> polygonPlanesPoints(mAllocator);
+            ClippingVertices polygonPlanesNormals(mAllocator);
+            ClippingVertices polygonPlanesPoints(mAllocator);
             polygonPlanesNormals.add(Vector3(1, 0, 0));
             polygonPlanesPoints.add(Vector3(0, 0, 0));
             polygonPlanesNormals.add(Vector3(0, 1, 0));
@@ -252,8 +252,9 @@ class TestMathematicsFunctions : public Test {
             polygonPlanesNormals.add(Vector3(0, -1, 0));
             polygonPlanesPoints.add(Vector3(10, 5, 0));
 
-            List<Vector3> clipPolygonVertices = clipPolygonWithPlanes(polygonVertices, polygonPlanesPoints, polygonPlanesNormals, mAllocator);
+            ClippingVertices clipPolygonVertices = clipPolygonWithPlanes(polygonVertices, polygonPlanesPoints, polygonPlanesNormals, mAllocator);
             rp3d_test(clipPolygonVertices.size() == 4);
+            rp3d_test(clipPolygonVertices.isInline());
             rp3d_test(approxEqual(clipPolygonVertices[0].x, 0, 0.000001));
             rp3d_test(approxEqual(clipPolygonVertices[0].y, 2, 0.000001));
             rp3d_test(approxEqual(clipPolygonVertices[0].z, 0, 0.000001));
@@ -267,6 +268,26 @@ class TestMathematicsFunctions : public Test {
             rp3d_test(approxEqual(clipPolygonVertices[3].y, 4, 0.000001));
             rp3d_test(approxEqual(clipPolygonVertices[3].z, 0, 0.000001));
 
+            // Test roundDownToFloat() and roundUpToFloat()
+            rp3d_test(roundDownToFloat(decimal(2.5)) == 2.5f);
+            rp3d_test(roundUpToFloat(decimal(-2.5)) == -2.5f);
+            const decimal values[] = {decimal(0.1), decimal(-0.1), decimal(1.0) / decimal(3.0), decimal(12345.6789)};
+            for (decimal value : values) {
+                rp3d_test(static_cast<decimal>(roundDownToFloat(value)) <= value);
+                rp3d_test(static_cast<decimal>(roundUpToFloat(value)) >= value);
+                rp3d_test(std::nextafter(roundDownToFloat(value), FLT_MAX) >= roundUpToFloat(value));
+            }
+
+            // Test computeFloatRaySlabData()
+            float origin[3];
+            float invDirection[3];
+            computeFloatRaySlabData(Vector3(1, 2, 3), Vector3(5, 2, 1), origin, invDirection);
+            rp3d_test(origin[0] == 1.0f && origin[1] == 2.0f && origin[2] == 3.0f);
+            rp3d_test(invDirection[0] == 0.25f);
+            rp3d_test(invDirection[1] > 1e29f);
+            rp3d_test(invDirection[2] == -0.5f);
+            rp3d_test(computeFloatRayMaxFraction(decimal(0.5)) > 0.5f);
+
         }
 
  };
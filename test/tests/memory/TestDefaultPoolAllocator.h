@@ -0,0 +1,154 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_DEFAULT_POOL_ALLOCATOR_H
+#define TEST_DEFAULT_POOL_ALLOCATOR_H
+
+// Libraries
+#include "Test.h"
+#include "memory/DefaultPoolAllocator.h"
+#include "memory/DefaultAllocator.h"
+#include "memory/MemoryManager.h"
+#include <vector>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TestDefaultPoolAllocator
+/**
+ * Unit test for the DefaultPoolAllocator class
+ */
+class TestDefaultPoolAllocator : public Test {
+
+    private :
+
+        // ---------- Atributes ---------- //
+
+        DefaultAllocator mAllocator;
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestDefaultPoolAllocator(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testTrim();
+            testMemoryManagerTrim();
+        }
+
+        void testTrim() {
+
+            DefaultPoolAllocator allocator(mAllocator);
+
+            // Nothing to release
+            rp3d_test(allocator.trim() == 0);
+
+            // Allocate memory units of two different sizes
+            std::vector<int*> smallUnits;
+            std::vector<int*> largeUnits;
+            for (int i=0; i < 2000; i++) {
+                smallUnits.push_back(static_cast<int*>(allocator.allocate(16)));
+                largeUnits.push_back(static_cast<int*>(allocator.allocate(800)));
+                *smallUnits[i] = i;
+                *largeUnits[i] = -i;
+            }
+            const uint nbBlocks = allocator.getNbMemoryBlocks();
+            rp3d_test(nbBlocks > 64);
+
+            // The blocks with allocated memory units are not released
+            rp3d_test(allocator.trim() == 0);
+            rp3d_test(allocator.getNbMemoryBlocks() == nbBlocks);
+
+            // Release all the large memory units
+            for (int i=0; i < 2000; i++) {
+                allocator.release(largeUnits[i], 800);
+            }
+            const size_t nbReleasedBytes = allocator.trim();
+            rp3d_test(nbReleasedBytes >= 100 * 16384);
+            rp3d_test(allocator.getNbMemoryBlocks() < nbBlocks - 99);
+
+            // The small memory units are still valid
+            bool isValid = true;
+            for (int i=0; i < 2000; i++) {
+                isValid &= *smallUnits[i] == i;
+            }
+            rp3d_test(isValid);
+
+            // Release half of the small memory units
+            for (int i=0; i < 2000; i += 2) {
+                allocator.release(smallUnits[i], 16);
+            }
+            allocator.trim();
+
+            // The free small memory units can be allocated again
+            for (int i=0; i < 2000; i += 2) {
+                smallUnits[i] = static_cast<int*>(allocator.allocate(16));
+                *smallUnits[i] = i;
+            }
+            isValid = true;
+            for (int i=0; i < 2000; i++) {
+                isValid &= *smallUnits[i] == i;
+                allocator.release(smallUnits[i], 16);
+            }
+            rp3d_test(isValid);
+
+            // Everything is released
+            rp3d_test(allocator.trim() > 0);
+            rp3d_test(allocator.getNbMemoryBlocks() == 0);
+
+            // The allocator can be used after it has been trimmed
+            void* pointer = allocator.allocate(100);
+            rp3d_test(allocator.getNbMemoryBlocks() == 1);
+            allocator.release(pointer, 100);
+        }
+
+        void testMemoryManagerTrim() {
+
+            MemoryManager memoryManager;
+
+            std::vector<void*> pointers;
+            for (int i=0; i < 1000; i++) {
+                pointers.push_back(memoryManager.allocate(MemoryManager::AllocationType::Pool, 64));
+            }
+            for (int i=0; i < 1000; i++) {
+                memoryManager.release(MemoryManager::AllocationType::Pool, pointers[i], 64);
+            }
+            rp3d_test(memoryManager.getNbPoolMemoryBlocks() > 0);
+
+            rp3d_test(memoryManager.trim() >= 16384);
+            rp3d_test(memoryManager.getNbPoolMemoryBlocks() == 0);
+            rp3d_test(memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool).nbLiveBytes == 0);
+        }
+ };
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_HUGE_PAGE_ALLOCATOR_H
+#define TEST_HUGE_PAGE_ALLOCATOR_H
+
+// Libraries
+#include "Test.h"
+#include "memory/HugePageAllocator.h"
+#include "memory/MemoryManager.h"
+#include <cstdint>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TestHugePageAllocator
+/**
+ * Unit test for the HugePageAllocator class
+ */
+class TestHugePageAllocator : public Test {
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestHugePageAllocator(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testAllocations();
+            testMemoryManager();
+        }
+
+        void testAllocations() {
+
+            HugePageAllocator allocator;
+
+            // Small allocation
+            char* small = static_cast<char*>(allocator.allocate(100));
+            rp3d_test(small != nullptr);
+            memset(small, 1, 100);
+            rp3d_test(allocator.getNbHugePageAllocations() == 0);
+
+            // Large allocations
+            const size_t size1 = 3 * HugePageAllocator::HUGE_PAGE_SIZE + 10;
+            const size_t size2 = allocator.getMinHugePageAllocationSize();
+            char* large1 = static_cast<char*>(allocator.allocate(size1));
+            char* large2 = static_cast<char*>(allocator.allocate(size2));
+            rp3d_test(large1 != nullptr);
+            rp3d_test(large2 != nullptr);
+            memset(large1, 2, size1);
+            memset(large2, 3, size2);
+            rp3d_test(large1[size1 - 1] == 2);
+            rp3d_test(large2[0] == 3);
+
+            if (HugePageAllocator::isHugePageSupported()) {
+                rp3d_test(reinterpret_cast<uintptr_t>(large1) % HugePageAllocator::HUGE_PAGE_SIZE == 0);
+                rp3d_test(reinterpret_cast<uintptr_t>(large2) % HugePageAllocator::HUGE_PAGE_SIZE == 0);
+                rp3d_test(allocator.getNbHugePageAllocations() == 2);
+                rp3d_test(allocator.getNbMappedBytes() == 5 * HugePageAllocator::HUGE_PAGE_SIZE);
+            }
+
+            allocator.release(large1, size1);
+            allocator.release(large2, size2);
+            allocator.release(small, 100);
+            rp3d_test(allocator.getNbHugePageAllocations() == 0);
+            rp3d_test(allocator.getNbMappedBytes() == 0);
+        }
+
+        void testMemoryManager() {
+
+            HugePageAllocator allocator(64 * 1024);
+            MemoryManager memoryManager(&allocator);
+
+            // The first chunk of the single frame allocator uses huge pages
+            const uint nbHugePageAllocations = allocator.getNbHugePageAllocations();
+            if (HugePageAllocator::isHugePageSupported()) {
+                rp3d_test(nbHugePageAllocations == 1);
+            }
+
+            // Large allocation of the pool allocator
+            const size_t size = 100 * 1024;
+            void* pointer = memoryManager.allocate(MemoryManager::AllocationType::Pool, size);
+            if (HugePageAllocator::isHugePageSupported()) {
+                rp3d_test(allocator.getNbHugePageAllocations() == nbHugePageAllocations + 1);
+            }
+            memoryManager.release(MemoryManager::AllocationType::Pool, pointer, size);
+            rp3d_test(allocator.getNbHugePageAllocations() == nbHugePageAllocations);
+        }
+ };
+
+}
+
+#endif
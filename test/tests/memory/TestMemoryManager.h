@@ -0,0 +1,191 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_MEMORY_MANAGER_H
+#define TEST_MEMORY_MANAGER_H
+
+// Libraries
+#include "Test.h"
+#include "memory/MemoryManager.h"
+#include <thread>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TestMemoryManager
+/**
+ * Unit test for the MemoryManager class
+ */
+class TestMemoryManager : public Test {
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestMemoryManager(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testAllocationStatistics();
+            testFrameAllocationStatistics();
+            testWorkerPoolAllocator();
+        }
+
+        void testAllocationStatistics() {
+
+            MemoryManager memoryManager;
+
+            const AllocationStatistics& poolStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool);
+            const AllocationStatistics& bodiesStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool,
+                                                                                                MemoryManager::AllocationTag::Bodies);
+            rp3d_test(poolStatistics.nbAllocations == 0);
+            rp3d_test(poolStatistics.nbLiveBytes == 0);
+
+            void* pointer1 = memoryManager.allocate(MemoryManager::AllocationType::Pool, 100, MemoryManager::AllocationTag::Bodies);
+            void* pointer2 = memoryManager.allocate(MemoryManager::AllocationType::Pool, 50);
+            rp3d_test(poolStatistics.nbAllocations == 2);
+            rp3d_test(poolStatistics.nbLiveBytes == 150);
+            rp3d_test(bodiesStatistics.nbAllocations == 1);
+            rp3d_test(bodiesStatistics.nbLiveBytes == 100);
+            rp3d_test(memoryManager.getNbPoolMemoryBlocks() == 2);
+
+            memoryManager.release(MemoryManager::AllocationType::Pool, pointer1, 100, MemoryManager::AllocationTag::Bodies);
+            rp3d_test(poolStatistics.nbReleases == 1);
+            rp3d_test(poolStatistics.nbLiveBytes == 50);
+            rp3d_test(poolStatistics.maxNbLiveBytes == 150);
+            rp3d_test(bodiesStatistics.nbLiveBytes == 0);
+            rp3d_test(bodiesStatistics.maxNbLiveBytes == 100);
+
+            // Allocations made with a tagged allocator are counted in the statistics
+            MemoryAllocator& jointsAllocator = memoryManager.getPoolAllocator(MemoryManager::AllocationTag::Joints);
+            void* pointer3 = jointsAllocator.allocate(20);
+            rp3d_test(memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool,
+                                                            MemoryManager::AllocationTag::Joints).nbLiveBytes == 20);
+            rp3d_test(poolStatistics.nbLiveBytes == 70);
+            jointsAllocator.release(pointer3, 20);
+
+            memoryManager.release(MemoryManager::AllocationType::Pool, pointer2, 50);
+            rp3d_test(poolStatistics.nbLiveBytes == 0);
+            rp3d_test(poolStatistics.nbAllocations == 3);
+            rp3d_test(poolStatistics.nbReleases == 3);
+        }
+
+        void testFrameAllocationStatistics() {
+
+            MemoryManager memoryManager;
+
+            const AllocationStatistics& frameStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame);
+
+            memoryManager.allocate(MemoryManager::AllocationType::Frame, 1000, MemoryManager::AllocationTag::Islands);
+            memoryManager.allocate(MemoryManager::AllocationType::Frame, 24);
+            rp3d_test(frameStatistics.nbLiveBytes == 1024);
+            rp3d_test(memoryManager.getNbFrameAllocatorOverflows() == 0);
+
+            // Allocation larger than the buffer of the single frame allocator
+            void* pointer = memoryManager.allocate(MemoryManager::AllocationType::Frame, 2000000);
+            rp3d_test(memoryManager.getNbFrameAllocatorOverflows() == 1);
+            rp3d_test(memoryManager.getNbFrameAllocatorOverflowBytes() == 2000000);
+            memoryManager.release(MemoryManager::AllocationType::Frame, pointer, 2000000);
+
+            memoryManager.resetFrameAllocator();
+            rp3d_test(frameStatistics.nbLiveBytes == 0);
+            rp3d_test(frameStatistics.maxNbLiveBytes == 2001024);
+            rp3d_test(memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame,
+                                                            MemoryManager::AllocationTag::Islands).nbLiveBytes == 0);
+            rp3d_test(memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame,
+                                                            MemoryManager::AllocationTag::Islands).maxNbLiveBytes == 1000);
+        }
+
+        void testWorkerPoolAllocator() {
+
+            // Base allocator that counts its allocations
+            class CountingAllocator : public DefaultAllocator {
+
+                public:
+
+                    int nbAllocations = 0;
+
+                    virtual void* allocate(size_t size) override {
+                        nbAllocations++;
+                        return DefaultAllocator::allocate(size);
+                    }
+            };
+
+            CountingAllocator baseAllocator;
+            MemoryManager memoryManager(&baseAllocator);
+
+            const AllocationStatistics& poolStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool);
+            const AllocationStatistics& broadPhaseStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Pool,
+                                                                                                    MemoryManager::AllocationTag::BroadPhase);
+
+            void* pointer1 = memoryManager.allocate(MemoryManager::AllocationType::Pool, 100, MemoryManager::AllocationTag::BroadPhase);
+
+            {
+                MemoryManager::WorkerPoolAllocator workerAllocator(memoryManager, MemoryManager::AllocationTag::BroadPhase);
+                const int nbBaseAllocations = baseAllocator.nbAllocations;
+
+                // Allocate with the worker allocator on another thread
+                void* pointers[3];
+                std::thread worker([&workerAllocator, &pointers]() {
+                    pointers[0] = workerAllocator.allocate(200);
+                    pointers[1] = workerAllocator.allocate(300);
+                    workerAllocator.release(pointers[1], 300);
+                    pointers[2] = workerAllocator.allocate(2000);
+                });
+                worker.join();
+
+                // The memory comes from the base allocator of the memory manager
+                rp3d_test(baseAllocator.nbAllocations > nbBaseAllocations);
+
+                // The statistics are only updated when they are merged
+                rp3d_test(broadPhaseStatistics.nbAllocations == 1);
+                workerAllocator.mergeStatistics();
+                rp3d_test(broadPhaseStatistics.nbAllocations == 4);
+                rp3d_test(broadPhaseStatistics.nbReleases == 1);
+                rp3d_test(broadPhaseStatistics.nbLiveBytes == 2300);
+                rp3d_test(broadPhaseStatistics.maxNbLiveBytes == 2300);
+                rp3d_test(poolStatistics.nbLiveBytes == 2300);
+
+                // The releases made before the destruction of the allocator are counted
+                workerAllocator.release(pointers[0], 200);
+                workerAllocator.release(pointers[2], 2000);
+            }
+
+            rp3d_test(broadPhaseStatistics.nbReleases == 3);
+            rp3d_test(broadPhaseStatistics.nbLiveBytes == 100);
+            rp3d_test(poolStatistics.nbLiveBytes == 100);
+
+            memoryManager.release(MemoryManager::AllocationType::Pool, pointer1, 100, MemoryManager::AllocationTag::BroadPhase);
+            rp3d_test(broadPhaseStatistics.nbLiveBytes == 0);
+        }
+ };
+
+}
+
+#endif
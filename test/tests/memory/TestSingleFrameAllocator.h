@@ -0,0 +1,269 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_SINGLE_FRAME_ALLOCATOR_H
+#define TEST_SINGLE_FRAME_ALLOCATOR_H
+
+// Libraries
+#include "Test.h"
+#include "memory/DefaultSingleFrameAllocator.h"
+#include "memory/DefaultAllocator.h"
+#include "memory/MemoryManager.h"
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class CountingAllocator
+/**
+ * Base allocator that counts the number of allocations
+ */
+class CountingAllocator : public DefaultAllocator {
+
+    public :
+
+        uint nbAllocations = 0;
+        uint nbReleases = 0;
+
+        virtual void* allocate(size_t size) override {
+            nbAllocations++;
+            return DefaultAllocator::allocate(size);
+        }
+
+        virtual void release(void* pointer, size_t size) override {
+            nbReleases++;
+            DefaultAllocator::release(pointer, size);
+        }
+};
+
+// Class TestSingleFrameAllocator
+/**
+ * Unit test for the DefaultSingleFrameAllocator class
+ */
+class TestSingleFrameAllocator : public Test {
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestSingleFrameAllocator(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testChunks();
+            testShrink();
+            testTrim();
+            testRollback();
+            testMemoryManagerRollback();
+        }
+
+        void testChunks() {
+
+            CountingAllocator baseAllocator;
+            DefaultSingleFrameAllocator allocator(baseAllocator);
+
+            rp3d_test(baseAllocator.nbAllocations == 1);
+            rp3d_test(allocator.getNbChunks() == 1);
+
+            // Fill the first chunk and allocate much more memory in the same frame
+            const size_t initSize = allocator.getTotalSizeBytes();
+            char* first = static_cast<char*>(allocator.allocate(1000));
+            char* second = static_cast<char*>(allocator.allocate(1000));
+            rp3d_test(second == first + 1000);
+            for (int i=0; i < 3000; i++) {
+                allocator.allocate(1000);
+            }
+
+            // Only a few chunks have been allocated
+            rp3d_test(allocator.getNbChunks() == 3);
+            rp3d_test(baseAllocator.nbAllocations == 3);
+            rp3d_test(allocator.getNbOverflowAllocations() == 2);
+            rp3d_test(allocator.getTotalSizeBytes() == 4 * initSize);
+
+            // The chunks are kept across frames
+            allocator.reset();
+            for (int i=0; i < 3000; i++) {
+                allocator.allocate(1000);
+            }
+            rp3d_test(allocator.getNbChunks() == 3);
+            rp3d_test(baseAllocator.nbAllocations == 3);
+            rp3d_test(baseAllocator.nbReleases == 0);
+
+            // Allocation larger than all the chunks
+            allocator.allocate(10 * initSize);
+            rp3d_test(allocator.getNbChunks() == 4);
+            rp3d_test(allocator.getNbOverflowBytes() == 2000 + 10 * initSize);
+            allocator.reset();
+        }
+
+        void testShrink() {
+
+            CountingAllocator baseAllocator;
+            DefaultSingleFrameAllocator allocator(baseAllocator);
+
+            const size_t initSize = allocator.getTotalSizeBytes();
+            allocator.allocate(initSize);
+            allocator.allocate(initSize);
+            allocator.reset();
+            rp3d_test(allocator.getNbChunks() == 2);
+
+            // The chunk that is not used anymore is released after some frames
+            for (int i=0; i < 200; i++) {
+                allocator.allocate(100);
+                allocator.reset();
+            }
+            rp3d_test(allocator.getNbChunks() == 1);
+            rp3d_test(allocator.getTotalSizeBytes() == initSize);
+            rp3d_test(baseAllocator.nbReleases == 1);
+
+            // The memory can grow again
+            allocator.allocate(initSize);
+            allocator.allocate(initSize);
+            rp3d_test(allocator.getNbChunks() == 2);
+            allocator.reset();
+        }
+
+        void testTrim() {
+
+            CountingAllocator baseAllocator;
+            DefaultSingleFrameAllocator allocator(baseAllocator);
+
+            const size_t initSize = allocator.getTotalSizeBytes();
+            allocator.allocate(initSize);
+            allocator.allocate(initSize);
+
+            // The chunks used during the last frame are kept
+            allocator.reset();
+            rp3d_test(allocator.trim() == 0);
+            rp3d_test(allocator.getNbChunks() == 2);
+
+            // The chunk that has not been used during the last frame is released
+            allocator.allocate(100);
+            allocator.reset();
+            rp3d_test(allocator.trim() > initSize);
+            rp3d_test(allocator.getNbChunks() == 1);
+            rp3d_test(baseAllocator.nbReleases == 1);
+        }
+
+        void testRollback() {
+
+            CountingAllocator baseAllocator;
+            DefaultSingleFrameAllocator allocator(baseAllocator);
+
+            rp3d_test(allocator.isRollbackSupported());
+
+            char* pointer1 = static_cast<char*>(allocator.allocate(100));
+
+            char* pointer2;
+            {
+                SingleFrameAllocatorScope scope1(allocator);
+                pointer2 = static_cast<char*>(allocator.allocate(100));
+                rp3d_test(pointer2 == pointer1 + 100);
+
+                {
+                    // Nested scope that needs a new chunk
+                    SingleFrameAllocatorScope scope2(allocator);
+                    allocator.allocate(allocator.getTotalSizeBytes());
+                    rp3d_test(allocator.getNbChunks() == 2);
+                }
+
+                // The memory of the nested scope has been released
+                char* pointer3 = static_cast<char*>(allocator.allocate(100));
+                rp3d_test(pointer3 == pointer2 + 100);
+            }
+
+            // The memory of the first scope has been released
+            char* pointer4 = static_cast<char*>(allocator.allocate(100));
+            rp3d_test(pointer4 == pointer2);
+            rp3d_test(allocator.getMarker().nbAllocatedBytes == 200);
+
+            allocator.reset();
+            rp3d_test(allocator.allocate(100) == pointer1);
+            allocator.reset();
+        }
+
+        void testMemoryManagerRollback() {
+
+            MemoryManager memoryManager;
+
+            const AllocationStatistics& frameStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame);
+            SingleFrameAllocator& narrowPhaseAllocator = memoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::NarrowPhase);
+            rp3d_test(narrowPhaseAllocator.isRollbackSupported());
+            rp3d_test(memoryManager.getNbFrameAllocatorChunks() == 1);
+
+            memoryManager.allocate(MemoryManager::AllocationType::Frame, 40);
+            {
+                SingleFrameAllocatorScope scope(narrowPhaseAllocator);
+                narrowPhaseAllocator.allocate(60);
+                rp3d_test(frameStatistics.nbLiveBytes == 100);
+            }
+
+            // The memory of the scope is not live anymore
+            rp3d_test(frameStatistics.nbLiveBytes == 40);
+            rp3d_test(frameStatistics.maxNbLiveBytes == 100);
+            rp3d_test(memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame,
+                                                            MemoryManager::AllocationTag::NarrowPhase).nbLiveBytes == 0);
+
+            // Allocations with several tags between the marker and the rollback
+            const AllocationStatistics& narrowPhaseStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame,
+                                                                                                     MemoryManager::AllocationTag::NarrowPhase);
+            const AllocationStatistics& manifoldsStatistics = memoryManager.getAllocationStatistics(MemoryManager::AllocationType::Frame,
+                                                                                                   MemoryManager::AllocationTag::ContactManifolds);
+            SingleFrameAllocator& manifoldsAllocator = memoryManager.getSingleFrameAllocator(MemoryManager::AllocationTag::ContactManifolds);
+            manifoldsAllocator.allocate(30);
+            {
+                SingleFrameAllocatorScope scope1(narrowPhaseAllocator);
+                narrowPhaseAllocator.allocate(20);
+                manifoldsAllocator.allocate(50);
+                {
+                    SingleFrameAllocatorScope scope2(manifoldsAllocator);
+                    manifoldsAllocator.allocate(10);
+                    narrowPhaseAllocator.allocate(70);
+                    rp3d_test(narrowPhaseStatistics.nbLiveBytes == 90);
+                    rp3d_test(manifoldsStatistics.nbLiveBytes == 90);
+                }
+
+                rp3d_test(narrowPhaseStatistics.nbLiveBytes == 20);
+                rp3d_test(manifoldsStatistics.nbLiveBytes == 80);
+                rp3d_test(frameStatistics.nbLiveBytes == 140);
+            }
+
+            // Each tag has the live bytes it had before the first scope
+            rp3d_test(narrowPhaseStatistics.nbLiveBytes == 0);
+            rp3d_test(manifoldsStatistics.nbLiveBytes == 30);
+            rp3d_test(frameStatistics.nbLiveBytes == 70);
+
+            memoryManager.resetFrameAllocator();
+            rp3d_test(frameStatistics.nbLiveBytes == 0);
+            rp3d_test(manifoldsStatistics.nbLiveBytes == 0);
+        }
+ };
+
+}
+
+#endif
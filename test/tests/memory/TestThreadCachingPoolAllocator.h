@@ -0,0 +1,183 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_THREAD_CACHING_POOL_ALLOCATOR_H
+#define TEST_THREAD_CACHING_POOL_ALLOCATOR_H
+
+// Libraries
+#include "Test.h"
+#include "memory/ThreadCachingPoolAllocator.h"
+#include "memory/DefaultAllocator.h"
+#include <thread>
+#include <vector>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class TestThreadCachingPoolAllocator
+/**
+ * Unit test for the ThreadCachingPoolAllocator class
+ */
+class TestThreadCachingPoolAllocator : public Test {
+
+    private :
+
+        // ---------- Atributes ---------- //
+
+        DefaultAllocator mAllocator;
+
+        // ---------- Methods ---------- //
+
+        /// Allocate memory units, fill them and return true if no memory unit has
+        /// been overwritten by another one
+        static bool allocateFillAndCheck(MemoryAllocator& allocator, int nbAllocations, uint seed) {
+
+            std::vector<uint*> pointers(nbAllocations);
+            std::vector<size_t> sizes(nbAllocations);
+
+            for (int i=0; i < nbAllocations; i++) {
+                sizes[i] = sizeof(uint) * (1 + (seed + i * 7) % 300);
+                pointers[i] = static_cast<uint*>(allocator.allocate(sizes[i]));
+                for (size_t j=0; j < sizes[i] / sizeof(uint); j++) {
+                    pointers[i][j] = seed + i;
+                }
+            }
+
+            bool isValid = true;
+            for (int i=0; i < nbAllocations; i++) {
+                for (size_t j=0; j < sizes[i] / sizeof(uint); j++) {
+                    isValid &= pointers[i][j] == seed + i;
+                }
+                allocator.release(pointers[i], sizes[i]);
+            }
+
+            return isValid;
+        }
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestThreadCachingPoolAllocator(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testAllocateRelease();
+            testConcurrentAllocateRelease();
+            testTrim();
+        }
+
+        void testAllocateRelease() {
+
+            ThreadCachingPoolAllocator allocator(mAllocator);
+
+            rp3d_test(allocator.allocate(0) == nullptr);
+
+            // Small and large allocations
+            void* pointer1 = allocator.allocate(8);
+            void* pointer2 = allocator.allocate(8);
+            void* pointer3 = allocator.allocate(5000);
+            rp3d_test(pointer1 != nullptr);
+            rp3d_test(pointer2 != nullptr);
+            rp3d_test(pointer3 != nullptr);
+            rp3d_test(pointer1 != pointer2);
+            allocator.release(pointer1, 8);
+            allocator.release(pointer2, 8);
+            allocator.release(pointer3, 5000);
+
+            // Released memory units are reused
+            void* pointer4 = allocator.allocate(8);
+            rp3d_test(pointer4 == pointer2);
+            allocator.release(pointer4, 8);
+
+            rp3d_test(allocateFillAndCheck(allocator, 10000, 1));
+            rp3d_test(allocateFillAndCheck(allocator, 10000, 2));
+        }
+
+        void testConcurrentAllocateRelease() {
+
+            ThreadCachingPoolAllocator allocator(mAllocator);
+
+            const uint nbThreads = 8;
+            bool isValid[nbThreads];
+            std::vector<std::thread> threads;
+            for (uint t=0; t < nbThreads; t++) {
+                threads.push_back(std::thread([&allocator, &isValid, t]() {
+                    isValid[t] = true;
+                    for (uint r=0; r < 20; r++) {
+                        isValid[t] &= allocateFillAndCheck(allocator, 2000, t * 1000 + r);
+                    }
+                }));
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            for (uint t=0; t < nbThreads; t++) {
+                rp3d_test(isValid[t]);
+            }
+        }
+
+        void testTrim() {
+
+            ThreadCachingPoolAllocator allocator(mAllocator);
+            rp3d_test(allocator.trim() == 0);
+
+            // Keep a memory unit allocated
+            uint* livePointer = static_cast<uint*>(allocator.allocate(sizeof(uint)));
+            *livePointer = 42;
+
+            // Memory units released into the depot and into the caches of several threads
+            rp3d_test(allocateFillAndCheck(allocator, 5000, 1));
+            std::thread thread([&allocator]() {
+                allocateFillAndCheck(allocator, 5000, 2);
+            });
+            thread.join();
+
+            // The blocks where all the memory units are free are released
+            const size_t nbReleasedBytes = allocator.trim();
+            rp3d_test(nbReleasedBytes > 0);
+            rp3d_test(allocator.trim() == 0);
+            rp3d_test(*livePointer == 42);
+
+            // The allocator can still be used after the trim
+            rp3d_test(allocateFillAndCheck(allocator, 5000, 3));
+            rp3d_test(*livePointer == 42);
+            allocator.release(livePointer, sizeof(uint));
+
+            // Now, all the memory units are free
+            rp3d_test(allocator.trim() > 0);
+            rp3d_test(allocator.trim() == 0);
+            rp3d_test(allocateFillAndCheck(allocator, 1000, 4));
+        }
+ };
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+/********************************************************************************
+* ReactPhysics3D physics library, http://www.reactphysics3d.com                 *
+* Copyright (c) 2010-2016 Daniel Chappuis                                       *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef TEST_THREAD_POOL_H
+#define TEST_THREAD_POOL_H
+
+// Libraries
+#include "Test.h"
+#include "utils/ThreadPool.h"
+#include "memory/DefaultAllocator.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// Reactphysics3D namespace
+namespace reactphysics3d {
+
+// Class CountingTask
+/**
+ * Task that counts the number of times each task index has been executed
+ * and the threads that have executed it
+ */
+class CountingTask : public ThreadPoolTask {
+
+    public:
+
+        std::vector<int> nbExecutions;
+        std::vector<std::thread::id> threadIds;
+        std::atomic<int> nbConcurrentTasks;
+        std::atomic<int> maxNbConcurrentTasks;
+
+        CountingTask(uint nbTasks) : nbExecutions(nbTasks, 0), threadIds(nbTasks),
+                                     nbConcurrentTasks(0), maxNbConcurrentTasks(0) {
+
+        }
+
+        virtual void execute(uint taskIndex) override {
+
+            const int nbConcurrent = ++nbConcurrentTasks;
+            int maxNbConcurrent = maxNbConcurrentTasks;
+            while (nbConcurrent > maxNbConcurrent &&
+                   !maxNbConcurrentTasks.compare_exchange_weak(maxNbConcurrent, nbConcurrent)) {}
+
+            nbExecutions[taskIndex]++;
+            threadIds[taskIndex] = std::this_thread::get_id();
+
+            --nbConcurrentTasks;
+        }
+};
+
+// Class TestThreadPool
+/**
+ * Unit test for the ThreadPool class
+ */
+class TestThreadPool : public Test {
+
+    private :
+
+        // ---------- Atributes ---------- //
+
+        DefaultAllocator mAllocator;
+
+    public :
+
+        // ---------- Methods ---------- //
+
+        /// Constructor
+        TestThreadPool(const std::string& name) : Test(name) {
+
+        }
+
+        /// Run the tests
+        void run() {
+
+            testRun();
+            testWithoutWorkers();
+        }
+
+        void testRun() {
+
+            ThreadPool threadPool(mAllocator, 3);
+            rp3d_test(threadPool.getNbWorkers() == 3);
+
+            // Run many tasks with all the workers and with only some of them
+            bool isValid = true;
+            for (uint i=0; i < 1000; i++) {
+
+                const uint nbTasks = 1 + i % 4;
+                CountingTask task(nbTasks);
+                threadPool.run(task, nbTasks);
+
+                for (uint t=0; t < nbTasks; t++) {
+                    if (task.nbExecutions[t] != 1) isValid = false;
+                }
+
+                // The first task index is executed by the calling thread and the
+                // other ones by different worker threads
+                if (task.threadIds[0] != std::this_thread::get_id()) isValid = false;
+                for (uint t=1; t < nbTasks; t++) {
+                    if (task.threadIds[t] == std::this_thread::get_id()) isValid = false;
+                    for (uint u=1; u < t; u++) {
+                        if (task.threadIds[t] == task.threadIds[u]) isValid = false;
+                    }
+                }
+            }
+            rp3d_test(isValid);
+
+            // Nothing is executed without task index
+            CountingTask emptyTask(1);
+            threadPool.run(emptyTask, 0);
+            rp3d_test(emptyTask.nbExecutions[0] == 0);
+        }
+
+        void testWithoutWorkers() {
+
+            ThreadPool threadPool(mAllocator, 0);
+            rp3d_test(threadPool.getNbWorkers() == 0);
+
+            CountingTask task(1);
+            threadPool.run(task, 1);
+            rp3d_test(task.nbExecutions[0] == 1);
+            rp3d_test(task.threadIds[0] == std::this_thread::get_id());
+            rp3d_test(task.maxNbConcurrentTasks == 1);
+        }
+};
+
+}
+
+#endif